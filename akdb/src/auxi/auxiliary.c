@@ -117,8 +117,9 @@ char *AK_convert_type(char *arg_type) {
 }
 
 /**
- * @author Miroslav Policki
- * @brief Function returns the size in bytes for the provided database type
+ * @author Miroslav Policki, updated by Karlo Vuković (overflow values)
+ * @brief Function returns the size in bytes for the provided database type. A value stored in overflow pages takes
+ * the size of the address of its first page.
  * @param iDB_type database data type (defined in constants.h)
  * @param szVarchar if iDB_type == TYPE_VARCHAR, pointer to the string,
  * otherwise unused
@@ -164,6 +165,9 @@ size_t AK_type_size(int iDB_type, char *szVarchar) {
   case TYPE_BOOL:
     AK_EPI;
     return (size_t)1;
+  case TYPE_OVERFLOW:
+    AK_EPI;
+    return sizeof(int);
   default:
     AK_EPI;
     return (size_t)0;
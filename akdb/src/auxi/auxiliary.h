@@ -166,8 +166,9 @@ void AK_define_tarjan_graph();
 int AK_chars_num_from_number(int number, int base);
 
 /**
- * @author Miroslav Policki
- * @brief Function returns the size in bytes for the provided database type
+ * @author Miroslav Policki, updated by Karlo Vuković (overflow values)
+ * @brief Function returns the size in bytes for the provided database type. A value stored in overflow pages takes
+ * the size of the address of its first page.
  * @param iDB_type database data type (defined in constants.h)
  * @param szVarchar if iDB_type == TYPE_VARCHAR, pointer to the string, otherwise unused
  * @return size of provided data type in bytes if the provided data type is valid, else return 0
@@ -0,0 +1,604 @@
+/**
+@file compare.c Provides functions for typed comparison and hashing of values
+ */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#include "compare.h"
+#include "../file/table.h"
+#include "../file/bulk.h"
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that returns the size of a varchar value without '\0' characters at its end
+ * @param data value
+ * @param size size of the value
+ * @return size of the value without the terminator
+ */
+static int AK_compare_varchar_size(const char *data, int size) {
+    while (size > 0 && data[size - 1] == '\0')
+        size--;
+    return size;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that continues FNV-1a hash over the bytes
+ * @param hash hash of the previous bytes
+ * @param data bytes
+ * @param size number of bytes
+ * @return hash
+ */
+static unsigned int AK_compare_fnv(unsigned int hash, const void *data, int size) {
+    const unsigned char *bytes = (const unsigned char *) data;
+    int i;
+
+    for (i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that compares two values of the same type as they are stored in blocks
+ * @param type type of the values
+ * @param left first value
+ * @param left_size size of the first value
+ * @param right second value
+ * @param right_size size of the second value
+ * @return negative number if the first value is smaller, 0 if the values are equal, otherwise positive number
+ */
+int AK_compare_values(int type, const char *left, int left_size, const char *right, int right_size) {
+    int left_int, right_int, result;
+    float left_float, right_float;
+    double left_double, right_double;
+
+    if (left_size <= 0 || right_size <= 0)
+        return (left_size > 0) - (right_size > 0);
+
+    switch (type) {
+        case TYPE_INT:
+        case TYPE_DATE:
+        case TYPE_DATETIME:
+        case TYPE_TIME:
+        case TYPE_INTERVAL:
+        case TYPE_PERIOD:
+            memcpy(&left_int, left, sizeof (int));
+            memcpy(&right_int, right, sizeof (int));
+            return (left_int > right_int) - (left_int < right_int);
+        case TYPE_FLOAT:
+            //float entries are as large as a double, only the first bytes hold the value
+            memcpy(&left_float, left, sizeof (float));
+            memcpy(&right_float, right, sizeof (float));
+            return (left_float > right_float) - (left_float < right_float);
+        case TYPE_NUMBER:
+            memcpy(&left_double, left, sizeof (double));
+            memcpy(&right_double, right, sizeof (double));
+            return (left_double > right_double) - (left_double < right_double);
+        case TYPE_BOOL:
+            return (left[0] != 0) - (right[0] != 0);
+        case TYPE_VARCHAR:
+            left_size = AK_compare_varchar_size(left, left_size);
+            right_size = AK_compare_varchar_size(right, right_size);
+            //no break is intentional
+        default:
+            result = memcmp(left, right, left_size < right_size ? left_size : right_size);
+            if (result != 0)
+                return result;
+            return (left_size > right_size) - (left_size < right_size);
+    }
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that returns the bytes of a value that are hashed, so that equal values have equal bytes
+ * @param type type of the value
+ * @param data value
+ * @param size size of the value, larger than 0
+ * @param buffer space for a value that has to be changed, at least as large as a double
+ * @param length number of bytes to hash
+ * @return bytes to hash
+ */
+static const char *AK_compare_hash_bytes(int type, const char *data, int size, char *buffer, int *length) {
+    float float_value;
+    double double_value;
+
+    switch (type) {
+        case TYPE_INT:
+        case TYPE_DATE:
+        case TYPE_DATETIME:
+        case TYPE_TIME:
+        case TYPE_INTERVAL:
+        case TYPE_PERIOD:
+            *length = sizeof (int);
+            return data;
+        case TYPE_FLOAT:
+            //0.0 and -0.0 are equal, so they need the same bytes
+            memcpy(&float_value, data, sizeof (float));
+            if (float_value == 0)
+                float_value = 0;
+            memcpy(buffer, &float_value, sizeof (float));
+            *length = sizeof (float);
+            return buffer;
+        case TYPE_NUMBER:
+            memcpy(&double_value, data, sizeof (double));
+            if (double_value == 0)
+                double_value = 0;
+            memcpy(buffer, &double_value, sizeof (double));
+            *length = sizeof (double);
+            return buffer;
+        case TYPE_BOOL:
+            buffer[0] = data[0] != 0;
+            *length = 1;
+            return buffer;
+        case TYPE_VARCHAR:
+            *length = AK_compare_varchar_size(data, size);
+            return data;
+        default:
+            *length = size;
+            return data;
+    }
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that returns the hash of a value as it is stored in a block
+ * @param type type of the value
+ * @param data value
+ * @param size size of the value
+ * @return hash of the value
+ */
+unsigned int AK_hash_value(int type, const char *data, int size) {
+    char buffer[sizeof (double)];
+    const char *bytes;
+    int length;
+
+    if (size <= 0)
+        return 2166136261u;
+    bytes = AK_compare_hash_bytes(type, data, size, buffer, &length);
+    return AK_compare_fnv(2166136261u, bytes, length);
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that multiplies two 64-bit numbers into a 128-bit product, split into its two halves
+ * @param a first number, it gets the lower half
+ * @param b second number, it gets the upper half
+ * @return No return value
+ */
+static void AK_compare_mum(unsigned long long *a, unsigned long long *b) {
+    unsigned long long ha = *a >> 32, la = *a & 0xffffffffull, hb = *b >> 32, lb = *b & 0xffffffffull;
+    unsigned long long high = ha * hb, middle0 = ha * lb, middle1 = hb * la, low = la * lb;
+    unsigned long long t = low + (middle0 << 32), carry = t < low;
+
+    low = t + (middle1 << 32);
+    carry += low < t;
+    *a = low;
+    *b = high + (middle0 >> 32) + (middle1 >> 32) + carry;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that mixes two 64-bit numbers by folding the halves of their product
+ * @param a first number
+ * @param b second number
+ * @return mixed number
+ */
+static unsigned long long AK_compare_mix(unsigned long long a, unsigned long long b) {
+    AK_compare_mum(&a, &b);
+    return a ^ b;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that reads 8 bytes as a number
+ * @param data bytes
+ * @return number
+ */
+static unsigned long long AK_compare_read64(const unsigned char *data) {
+    unsigned long long value;
+
+    memcpy(&value, data, sizeof (value));
+    return value;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that reads 4 bytes as a number
+ * @param data bytes
+ * @return number
+ */
+static unsigned long long AK_compare_read32(const unsigned char *data) {
+    unsigned int value;
+
+    memcpy(&value, data, sizeof (value));
+    return value;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that hashes bytes in the way of wyhash. Up to 16 bytes are read as two overlapping numbers, longer
+ *        inputs 16 or 48 bytes at a time, and every step multiplies the input with constants into a 128-bit product
+ *        whose halves are folded together.
+ * @param data bytes
+ * @param size number of bytes
+ * @param seed seed of the hash
+ * @return hash
+ */
+static unsigned long long AK_compare_wyhash(const void *data, int size, unsigned long long seed) {
+    static const unsigned long long secret[4] = {0xa0761d6478bd642full, 0xe7037ed1a0b428dbull,
+                                                 0x8ebc6af09c88c6e3ull, 0x589965cc75374cc3ull};
+    const unsigned char *bytes = (const unsigned char *) data;
+    unsigned long long a, b, see1, see2;
+    int left = size;
+
+    seed ^= AK_compare_mix(seed ^ secret[0], secret[1]);
+    if (size <= 16) {
+        if (size >= 4) {
+            a = (AK_compare_read32(bytes) << 32) | AK_compare_read32(bytes + ((size >> 3) << 2));
+            b = (AK_compare_read32(bytes + size - 4) << 32) | AK_compare_read32(bytes + size - 4 - ((size >> 3) << 2));
+        } else if (size > 0) {
+            a = ((unsigned long long) bytes[0] << 16) | ((unsigned long long) bytes[size >> 1] << 8) | bytes[size - 1];
+            b = 0;
+        } else
+            a = b = 0;
+    } else {
+        if (left > 48) {
+            see1 = see2 = seed;
+            do {
+                seed = AK_compare_mix(AK_compare_read64(bytes) ^ secret[1], AK_compare_read64(bytes + 8) ^ seed);
+                see1 = AK_compare_mix(AK_compare_read64(bytes + 16) ^ secret[2], AK_compare_read64(bytes + 24) ^ see1);
+                see2 = AK_compare_mix(AK_compare_read64(bytes + 32) ^ secret[3], AK_compare_read64(bytes + 40) ^ see2);
+                bytes += 48;
+                left -= 48;
+            } while (left > 48);
+            seed ^= see1 ^ see2;
+        }
+        while (left > 16) {
+            seed = AK_compare_mix(AK_compare_read64(bytes) ^ secret[1], AK_compare_read64(bytes + 8) ^ seed);
+            bytes += 16;
+            left -= 16;
+        }
+        a = AK_compare_read64(bytes + left - 16);
+        b = AK_compare_read64(bytes + left - 8);
+    }
+    a ^= secret[1];
+    b ^= seed;
+    AK_compare_mum(&a, &b);
+    return AK_compare_mix(a ^ secret[0] ^ (unsigned long long) size, b ^ secret[1]);
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that returns a 64-bit hash of a value as it is stored in a block
+ * @param type type of the value
+ * @param data value
+ * @param size size of the value
+ * @param seed seed of the hash, the hash of the previous value when several values are hashed together
+ * @return hash of the value
+ */
+unsigned long long AK_hash_value64(int type, const char *data, int size, unsigned long long seed) {
+    char buffer[sizeof (double)];
+    const char *bytes;
+    int length;
+
+    if (size <= 0)
+        return AK_compare_wyhash(NULL, 0, seed);
+    bytes = AK_compare_hash_bytes(type, data, size, buffer, &length);
+    return AK_compare_wyhash(bytes, length, seed);
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that compares two values in blocks by the type of the first one
+ * @param left_block block that holds the first value
+ * @param left entry of the first value in the tuple dictionary
+ * @param right_block block that holds the second value
+ * @param right entry of the second value in the tuple dictionary
+ * @return negative number if the first value is smaller, 0 if the values are equal, otherwise positive number
+ */
+int AK_compare_entries(AK_block *left_block, AK_tuple_dict *left, AK_block *right_block, AK_tuple_dict *right) {
+    return AK_compare_values(left->type, (char *) left_block->data + left->address, left->size,
+                             (char *) right_block->data + right->address, right->size);
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that compares two rows attribute by attribute
+ * @param left_block block that holds the first row
+ * @param left_tuple first entry of the first row in the tuple dictionary
+ * @param right_block block that holds the second row
+ * @param right_tuple first entry of the second row in the tuple dictionary
+ * @param num_attr number of attributes
+ * @return result of the comparison of the first attributes that are not equal, 0 if the rows are equal
+ */
+int AK_compare_rows(AK_block *left_block, int left_tuple, AK_block *right_block, int right_tuple, int num_attr) {
+    int i, result;
+
+    for (i = 0; i < num_attr; i++) {
+        result = AK_compare_entries(left_block, &left_block->tuple_dict[left_tuple + i],
+                                    right_block, &right_block->tuple_dict[right_tuple + i]);
+        if (result != 0)
+            return result;
+    }
+    return 0;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that returns the hash of a row
+ * @param block block that holds the row
+ * @param tuple first entry of the row in the tuple dictionary
+ * @param num_attr number of attributes
+ * @return hash of the row
+ */
+unsigned int AK_hash_row(AK_block *block, int tuple, int num_attr) {
+    unsigned int hash = 2166136261u, value;
+    AK_tuple_dict *entry;
+    int i;
+
+    for (i = 0; i < num_attr; i++) {
+        entry = &block->tuple_dict[tuple + i];
+        value = AK_hash_value(entry->type, (char *) block->data + entry->address, entry->size);
+        hash = AK_compare_fnv(hash, &value, sizeof (unsigned int));
+    }
+    return hash;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that puts all rows of the table into a new row set
+ * @param tblName table name
+ * @param num_attr number of attributes of the table
+ * @return row set that has to be freed with AK_row_set_free
+ */
+AK_row_set *AK_row_set_build(char *tblName, int num_attr) {
+    table_addresses *addresses;
+    AK_row_set *set;
+    AK_block *block;
+    int i, j, k, row;
+    AK_PRO;
+
+    set = (AK_row_set *) AK_calloc(1, sizeof (AK_row_set));
+    set->num_attr = num_attr;
+    set->capacity = 64;
+    set->hash = (unsigned int *) AK_malloc(set->capacity * sizeof (unsigned int));
+    set->block = (int *) AK_malloc(set->capacity * sizeof (int));
+    set->tuple = (int *) AK_malloc(set->capacity * sizeof (int));
+
+    addresses = AK_get_table_addresses(tblName);
+    for (i = 0; num_attr > 0 && i < MAX_EXTENTS_IN_SEGMENT && addresses->address_from[i] != 0; i++) {
+        for (j = addresses->address_from[i]; j < addresses->address_to[i]; j++) {
+            block = AK_get_block(j)->block;
+            if (block->last_tuple_dict_id == 0)
+                break;
+            for (k = 0; k + num_attr <= DATA_BLOCK_SIZE; k += num_attr) {
+                if (block->tuple_dict[k].type == FREE_INT)
+                    break;
+                //deleted rows
+                if (block->tuple_dict[k].size <= 0)
+                    continue;
+                if (set->num_rows == set->capacity) {
+                    set->capacity *= 2;
+                    set->hash = (unsigned int *) AK_realloc(set->hash, set->capacity * sizeof (unsigned int));
+                    set->block = (int *) AK_realloc(set->block, set->capacity * sizeof (int));
+                    set->tuple = (int *) AK_realloc(set->tuple, set->capacity * sizeof (int));
+                }
+                set->hash[set->num_rows] = AK_hash_row(block, k, num_attr);
+                set->block[set->num_rows] = j;
+                set->tuple[set->num_rows] = k;
+                set->num_rows++;
+            }
+        }
+    }
+    AK_free(addresses);
+
+    set->num_buckets = 16;
+    while (set->num_buckets < 2 * set->num_rows)
+        set->num_buckets *= 2;
+    set->buckets = (int *) AK_malloc(set->num_buckets * sizeof (int));
+    set->next = (int *) AK_malloc((set->num_rows + 1) * sizeof (int));
+    for (i = 0; i < set->num_buckets; i++)
+        set->buckets[i] = -1;
+    //rows are linked from the last one, so each bucket keeps the order of the table
+    for (row = set->num_rows - 1; row >= 0; row--) {
+        i = set->hash[row] & (set->num_buckets - 1);
+        set->next[row] = set->buckets[i];
+        set->buckets[i] = row;
+    }
+
+    AK_EPI;
+    return set;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that finds rows of the set that are equal to the given row
+ * @param set row set
+ * @param block block that holds the row
+ * @param tuple first entry of the row in the tuple dictionary
+ * @param from -1 to find the first equal row, otherwise the previously found row
+ * @return position of the next equal row in the set, -1 if there are no more equal rows
+ */
+int AK_row_set_find(AK_row_set *set, AK_block *block, int tuple, int from) {
+    unsigned int hash;
+    int row;
+    AK_PRO;
+
+    if (from < 0) {
+        hash = AK_hash_row(block, tuple, set->num_attr);
+        row = set->buckets[hash & (set->num_buckets - 1)];
+    } else {
+        hash = set->hash[from];
+        row = set->next[from];
+    }
+
+    for (; row != -1; row = set->next[row]) {
+        if (set->hash[row] == hash &&
+            AK_compare_rows(block, tuple, AK_get_block(set->block[row])->block, set->tuple[row], set->num_attr) == 0) {
+            AK_EPI;
+            return row;
+        }
+    }
+    AK_EPI;
+    return -1;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that frees the row set
+ * @param set row set
+ * @return No return value
+ */
+void AK_row_set_free(AK_row_set *set) {
+    AK_PRO;
+    if (set != NULL) {
+        AK_free(set->buckets);
+        AK_free(set->next);
+        AK_free(set->hash);
+        AK_free(set->block);
+        AK_free(set->tuple);
+        AK_free(set);
+    }
+    AK_EPI;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function for testing typed comparison and hashing
+ * @return TestResult
+ */
+TestResult AK_compare_test() {
+    char *tblName = "compare_test";
+    int ok = 0, fail = 0;
+    int i, id, matches, row, first_row;
+    int small = 256, large = 512, negative = -1;
+    float float_value, float_zero = 0, float_negative_zero = -0.0f;
+    double number_small = 1.5, number_large = 2.25;
+    char float_left[sizeof (double)], float_right[sizeof (double)];
+    char name[MAX_VARCHAR_LENGTH], name_long[100];
+    int counts[64];
+    struct list_node **rows;
+    table_addresses *addresses;
+    AK_block *block;
+    AK_row_set *set;
+    AK_PRO;
+
+    memset(name_long, 'x', sizeof (name_long));
+
+    printf("\n********** COMPARE TEST **********\n\n");
+
+    //ints are compared as numbers, not as strings of bytes
+    if (AK_compare_values(TYPE_INT, (char *) &small, sizeof (int), (char *) &large, sizeof (int)) < 0 &&
+        AK_compare_values(TYPE_INT, (char *) &negative, sizeof (int), (char *) &small, sizeof (int)) < 0 &&
+        AK_compare_values(TYPE_DATE, (char *) &large, sizeof (int), (char *) &small, sizeof (int)) > 0 &&
+        AK_compare_values(TYPE_INT, (char *) &small, sizeof (int), (char *) &small, sizeof (int)) == 0)
+        ok++;
+    else
+        fail++;
+
+    //float entries carry bytes that are not a part of the value
+    float_value = 3.75f;
+    memset(float_left, 1, sizeof (double));
+    memset(float_right, 2, sizeof (double));
+    memcpy(float_left, &float_value, sizeof (float));
+    memcpy(float_right, &float_value, sizeof (float));
+    if (AK_compare_values(TYPE_FLOAT, float_left, sizeof (double), float_right, sizeof (double)) == 0 &&
+        AK_hash_value(TYPE_FLOAT, float_left, sizeof (double)) == AK_hash_value(TYPE_FLOAT, float_right, sizeof (double)) &&
+        AK_compare_values(TYPE_FLOAT, (char *) &float_zero, sizeof (float), (char *) &float_negative_zero, sizeof (float)) == 0 &&
+        AK_hash_value(TYPE_FLOAT, (char *) &float_zero, sizeof (float)) == AK_hash_value(TYPE_FLOAT, (char *) &float_negative_zero, sizeof (float)) &&
+        AK_compare_values(TYPE_NUMBER, (char *) &number_small, sizeof (double), (char *) &number_large, sizeof (double)) < 0)
+        ok++;
+    else
+        fail++;
+
+    //varchars are compared by bytes, a shorter prefix comes first and nulls come before everything
+    if (AK_compare_values(TYPE_VARCHAR, "abc", 3, "abd", 3) < 0 &&
+        AK_compare_values(TYPE_VARCHAR, "ab", 2, "abc", 3) < 0 &&
+        AK_compare_values(TYPE_VARCHAR, "abc", 4, "abc", 3) == 0 &&
+        AK_hash_value(TYPE_VARCHAR, "abc", 4) == AK_hash_value(TYPE_VARCHAR, "abc", 3) &&
+        AK_hash_value(TYPE_VARCHAR, "abc", 3) != AK_hash_value(TYPE_VARCHAR, "abd", 3) &&
+        AK_compare_values(TYPE_VARCHAR, "", 0, "a", 1) < 0 &&
+        AK_compare_values(TYPE_INT, NULL, 0, NULL, 0) == 0)
+        ok++;
+    else
+        fail++;
+
+    //64-bit hashes spread consecutive ints evenly, equal values share them and the seed changes them
+    memset(counts, 0, sizeof (counts));
+    for (i = 0; i < 6400; i++)
+        counts[AK_hash_value64(TYPE_INT, (char *) &i, sizeof (int), 0) & 63]++;
+    for (i = 0, matches = 0; i < 64; i++)
+        if (counts[i] < 50 || counts[i] > 150)
+            matches++;
+    if (matches == 0 &&
+        AK_hash_value64(TYPE_VARCHAR, "abc", 4, 0) == AK_hash_value64(TYPE_VARCHAR, "abc", 3, 0) &&
+        AK_hash_value64(TYPE_VARCHAR, "abc", 3, 0) != AK_hash_value64(TYPE_VARCHAR, "abc", 3, 1) &&
+        AK_hash_value64(TYPE_VARCHAR, name_long, 100, 0) != AK_hash_value64(TYPE_VARCHAR, name_long, 99, 0) &&
+        AK_hash_value64(TYPE_FLOAT, (char *) &float_zero, sizeof (float), 0) ==
+        AK_hash_value64(TYPE_FLOAT, (char *) &float_negative_zero, sizeof (float), 0))
+        ok++;
+    else
+        fail++;
+
+    //row set: every row of the table has the given number of equal rows
+    AK_header t_header[4] = {
+        {TYPE_INT, "id", {0}, {{'\0'}}, {{'\0'}}},
+        {TYPE_VARCHAR, "name", {0}, {{'\0'}}, {{'\0'}}},
+        {TYPE_FLOAT, "score", {0}, {{'\0'}}, {{'\0'}}},
+        {0, {'\0'}, {0}, {{'\0'}}, {{'\0'}}}};
+    if (AK_num_attr(tblName) > 0)
+        AK_delete_segment(tblName, SEGMENT_TYPE_TABLE);
+    AK_initialize_new_segment(tblName, SEGMENT_TYPE_TABLE, t_header);
+
+    rows = (struct list_node **) AK_calloc(300, sizeof (struct list_node *));
+    for (i = 0; i < 300; i++) {
+        id = i % 100;
+        float_value = id * 0.5f;
+        sprintf(name, "name %d", id);
+        rows[i] = (struct list_node *) AK_malloc(sizeof (struct list_node));
+        AK_Init_L3(&rows[i]);
+        AK_Insert_New_Element(TYPE_INT, &id, tblName, "id", rows[i]);
+        AK_Insert_New_Element(TYPE_VARCHAR, name, tblName, "name", rows[i]);
+        AK_Insert_New_Element(TYPE_FLOAT, &float_value, tblName, "score", rows[i]);
+    }
+    AK_bulk_insert(tblName, rows, 300);
+    for (i = 0; i < 300; i++) {
+        AK_DeleteAll_L3(&rows[i]);
+        AK_free(rows[i]);
+    }
+    AK_free(rows);
+
+    set = AK_row_set_build(tblName, 3);
+    addresses = AK_get_table_addresses(tblName);
+    block = AK_get_block(addresses->address_from[0])->block;
+    matches = 0;
+    first_row = AK_row_set_find(set, block, 0, -1);
+    for (row = first_row; row != -1; row = AK_row_set_find(set, block, 0, row))
+        matches++;
+    printf("Row set has %d rows, the first row is equal to %d rows\n", set->num_rows, matches);
+    if (set->num_rows == 300 && matches == 3 && first_row == 0 && set->tuple[first_row] == 0)
+        ok++;
+    else
+        fail++;
+    AK_free(addresses);
+    AK_row_set_free(set);
+
+    AK_EPI;
+    return TEST_result(ok, fail);
+}
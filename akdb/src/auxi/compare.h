@@ -0,0 +1,163 @@
+/**
+@file compare.h Header file that provides functions and defines for typed comparison and hashing of values
+ */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#ifndef COMPARE
+#define COMPARE
+
+#include "test.h"
+#include "constants.h"
+#include "mempro.h"
+#include "../mm/memoman.h"
+
+/**
+ * @author Karlo Vuković
+ * @struct AK_row_set
+ * @brief Structure that holds the rows of a table in a hash table, so equal rows can be found without comparing
+ *        every pair of rows. Only addresses of the rows are kept, values stay in the blocks.
+ */
+typedef struct {
+    /// number of attributes of the table
+    int num_attr;
+    /// number of rows in the set
+    int num_rows;
+    /// size of the arrays of rows
+    int capacity;
+    /// number of buckets, a power of two
+    int num_buckets;
+    /// first row in each bucket, -1 if the bucket is empty
+    int *buckets;
+    /// next row in the same bucket, -1 after the last one
+    int *next;
+    /// hash of each row
+    unsigned int *hash;
+    /// address of the block that holds each row
+    int *block;
+    /// first entry of each row in the tuple dictionary of its block
+    int *tuple;
+} AK_row_set;
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that compares two values of the same type as they are stored in blocks, without copying them.
+ *        Int, date and time values are compared as int, float values as float, number values as double and
+ *        varchar values byte by byte, where a shorter value that is the beginning of a longer one comes first.
+ *        Values with size 0 or less are nulls, they are equal to each other and come before other values.
+ * @param type type of the values
+ * @param left first value
+ * @param left_size size of the first value
+ * @param right second value
+ * @param right_size size of the second value
+ * @return negative number if the first value is smaller, 0 if the values are equal, otherwise positive number
+ */
+int AK_compare_values(int type, const char *left, int left_size, const char *right, int right_size);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that returns the hash of a value as it is stored in a block. Values that are equal by
+ *        AK_compare_values have the same hash.
+ * @param type type of the value
+ * @param data value
+ * @param size size of the value
+ * @return hash of the value
+ */
+unsigned int AK_hash_value(int type, const char *data, int size);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that returns a 64-bit hash of a value as it is stored in a block, with a hash function in the
+ *        way of wyhash that is built from 128-bit multiplications. Values that are equal by AK_compare_values have
+ *        the same hash, and values are hashed together by giving each one the hash of the previous one as its seed.
+ * @param type type of the value
+ * @param data value
+ * @param size size of the value
+ * @param seed seed of the hash, the hash of the previous value when several values are hashed together
+ * @return hash of the value
+ */
+unsigned long long AK_hash_value64(int type, const char *data, int size, unsigned long long seed);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that compares two values in blocks by the type of the first one
+ * @param left_block block that holds the first value
+ * @param left entry of the first value in the tuple dictionary
+ * @param right_block block that holds the second value
+ * @param right entry of the second value in the tuple dictionary
+ * @return negative number if the first value is smaller, 0 if the values are equal, otherwise positive number
+ */
+int AK_compare_entries(AK_block *left_block, AK_tuple_dict *left, AK_block *right_block, AK_tuple_dict *right);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that compares two rows attribute by attribute
+ * @param left_block block that holds the first row
+ * @param left_tuple first entry of the first row in the tuple dictionary
+ * @param right_block block that holds the second row
+ * @param right_tuple first entry of the second row in the tuple dictionary
+ * @param num_attr number of attributes
+ * @return result of the comparison of the first attributes that are not equal, 0 if the rows are equal
+ */
+int AK_compare_rows(AK_block *left_block, int left_tuple, AK_block *right_block, int right_tuple, int num_attr);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that returns the hash of a row, combined from hashes of its values
+ * @param block block that holds the row
+ * @param tuple first entry of the row in the tuple dictionary
+ * @param num_attr number of attributes
+ * @return hash of the row
+ */
+unsigned int AK_hash_row(AK_block *block, int tuple, int num_attr);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that puts all rows of the table into a new row set
+ * @param tblName table name
+ * @param num_attr number of attributes of the table
+ * @return row set that has to be freed with AK_row_set_free
+ */
+AK_row_set *AK_row_set_build(char *tblName, int num_attr);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that finds rows of the set that are equal to the given row. Rows are returned in the order of
+ *        the table.
+ * @param set row set
+ * @param block block that holds the row
+ * @param tuple first entry of the row in the tuple dictionary
+ * @param from -1 to find the first equal row, otherwise the previously found row
+ * @return position of the next equal row in the set, -1 if there are no more equal rows
+ */
+int AK_row_set_find(AK_row_set *set, AK_block *block, int tuple, int from);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that frees the row set
+ * @param set row set
+ * @return No return value
+ */
+void AK_row_set_free(AK_row_set *set);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function for testing typed comparison and hashing
+ * @return TestResult
+ */
+TestResult AK_compare_test();
+
+#endif
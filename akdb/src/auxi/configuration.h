@@ -92,6 +92,32 @@
  * @brief Constant declaring maximum number of threads that an application can acquire
 */
 #define NUMBER_OF_THREADS (iniparser_getint(AK_config,"general:number_of_threads",42))
+/**
+  * @def BULK_BATCH_SIZE
+  * @brief Constant declaring how many rows the bulk loader validates, logs and packs as one batch
+ */
+#define BULK_BATCH_SIZE (iniparser_getint(AK_config,"bulk:batch_size",1000))
+/**
+  * @def SORT_MEMORY_BLOCKS
+  * @brief Constant declaring how many blocks of a table the sort holds in memory, larger tables are sorted in runs
+ */
+#define SORT_MEMORY_BLOCKS (iniparser_getint(AK_config,"sort:memory_blocks",32))
+/**
+  * @def SORT_THREADS
+  * @brief Constant declaring how many threads sort rows held in memory, 0 uses all cores
+ */
+#define SORT_THREADS (iniparser_getint(AK_config,"sort:threads",0))
+/**
+  * @def BTREE_FILL_FACTOR
+  * @brief Constant declaring how full in percent a bulk build packs the pages of a B+tree index, from 10 to 90
+ */
+#define BTREE_FILL_FACTOR (iniparser_getint(AK_config,"index:btree_fill_factor",90))
+/**
+  * @def INDEX_SCAN_SELECTIVITY
+  * @brief Constant declaring the largest share of the rows of a table, from 0 to 1, that a selection reads through an
+  * index, selections that find more rows scan the table
+ */
+#define INDEX_SCAN_SELECTIVITY (iniparser_getdouble(AK_config,"index:scan_selectivity",0.1))
 /**
   * @def MAX_EXTENTS
   * @brief Constant declaring maximum number of extents for a given segment
@@ -103,21 +103,6 @@
  * relation equivalence function
  */
 #define MAX_TOKENS 255
-/**
- * @def MAX_MAIN_BUCKETS
- * @brief Constant declaring the maximum number of main buckets
- */
-#define MAX_MAIN_BUCKETS 512
-/**
- * @def MAIN_BUCKET_SIZE
- * @brief Constant declaring the size of main buckets
- */
-#define MAIN_BUCKET_SIZE 4
-/**
- * @def HASH_BUCKET_SIZE
- * @brief Constant declaring the size of hash buckets
- */
-#define HASH_BUCKET_SIZE 4
 /**
  * @def NUMBER_OF_KEYS
  * @brief Constant declaring the number of buckets in hash table
@@ -157,6 +142,218 @@
  * chained with another (used in AK_block->type)
  */
 #define BLOCK_TYPE_CHAINED 1
+/**
+ * @def BLOCK_TYPE_PAX
+ * @brief Constant declaring block of a table with PAX layout, where values in the data area are grouped into
+ * one minipage per attribute (used in AK_block->type)
+ */
+#define BLOCK_TYPE_PAX 2
+/**
+ * @def PAX_VARCHAR_WIDTH
+ * @brief Constant declaring expected width of a varchar value, used to decide how many rows fit into a PAX block
+ */
+#define PAX_VARCHAR_WIDTH 16
+/**
+ * @def BLOCK_TYPE_WIDE
+ * @brief Constant declaring block of a table with more than MAX_ATTRIBUTES attributes. Whole rows are stored in the
+ * block, while the table header continues in chained blocks (used in AK_block->type)
+ */
+#define BLOCK_TYPE_WIDE 3
+/**
+ * @def BLOCK_TYPE_OVERFLOW
+ * @brief Constant declaring overflow page that holds a part of a long value, chained with the page holding the next
+ * part (used in AK_block->type)
+ */
+#define BLOCK_TYPE_OVERFLOW 4
+/**
+ * @def OVERFLOW_PAGE_SIZE
+ * @brief Constant declaring how many bytes of a long value are stored in one overflow page, the first bytes of the
+ * data area hold the length of the part
+ */
+#define OVERFLOW_PAGE_SIZE (DATA_BLOCK_SIZE * DATA_ENTRY_SIZE - (int) sizeof (int))
+/**
+ * @def OVERFLOW_ROW_SIZE
+ * @brief Constant declaring the size of a row of a wide table above which its longest varchar values are moved to
+ * overflow pages, so that every block holds several rows
+ */
+#define OVERFLOW_ROW_SIZE (DATA_BLOCK_SIZE * DATA_ENTRY_SIZE / 4)
+/**
+ * @def BLOCK_TYPE_BLOOM
+ * @brief Constant declaring block that holds the Bloom filter of one extent of a table, the data area starts with
+ * AK_bloom_filter_info and continues with the bits of the filter (used in AK_block->type)
+ */
+#define BLOCK_TYPE_BLOOM 5
+/**
+ * @def BLOOM_FILTER_BYTES
+ * @brief Constant declaring size of the bits of one Bloom filter, a power of two that fits into the data area of a
+ * block after AK_bloom_filter_info
+ */
+#define BLOOM_FILTER_BYTES 4096
+/**
+ * @def BLOOM_FILTER_HASHES
+ * @brief Constant declaring how many bits of a Bloom filter are set for one value
+ */
+#define BLOOM_FILTER_HASHES 4
+/**
+ * @def BLOCK_TYPE_BTREE
+ * @brief Constant declaring block that holds one page of a B+tree index, the data area starts with AK_btree_meta in
+ * the first block of the index and with AK_btree_page in the other blocks (used in AK_block->type)
+ */
+#define BLOCK_TYPE_BTREE 6
+/**
+ * @def BTREE_MAX_HEIGHT
+ * @brief Constant declaring how many levels a B+tree index can have
+ */
+#define BTREE_MAX_HEIGHT 16
+/**
+ * @def BTREE_MERGE_PERCENT
+ * @brief Constant declaring how full a B+tree page has to stay after a delete, in percents of the data area, before
+ * it is merged with its sibling
+ */
+#define BTREE_MERGE_PERCENT 25
+/**
+ * @def BTREE_KNOWN_INDEXES
+ * @brief Constant declaring how many B+tree indices remember the address of their first block, so that they are
+ * opened without searching the system catalog
+ */
+#define BTREE_KNOWN_INDEXES 16
+/**
+ * @def BTREE_MAX_INCLUDED
+ * @brief Constant declaring how many attributes besides the key a B+tree index can carry in the entries of its leaves
+ */
+#define BTREE_MAX_INCLUDED 4
+/**
+ * @def BTREE_MAX_KEYS
+ * @brief Constant declaring how many attributes the key of a B+tree index can have
+ */
+#define BTREE_MAX_KEYS 4
+/**
+ * @def BTREE_TYPE_COMPOSITE
+ * @brief Constant declaring the type of keys of a B+tree index on several attributes. Such a key holds the type, the
+ * size and the value of each attribute, one after another, and keys are ordered by the first attribute, then by the
+ * second one and so on.
+ */
+#define BTREE_TYPE_COMPOSITE 100
+/**
+ * @def BLOCK_TYPE_HASH
+ * @brief Constant declaring block that belongs to a hash index, the data area starts with hash_info in the first
+ * block of the index, with hash_bucket in bucket pages and holds bucket addresses in directory pages (used in
+ * AK_block->type)
+ */
+#define BLOCK_TYPE_HASH 7
+/**
+ * @def HASH_INITIAL_BUCKETS
+ * @brief Constant declaring how many buckets a new hash index has, a power of two
+ */
+#define HASH_INITIAL_BUCKETS 4
+/**
+ * @def HASH_SPLIT_PERCENT
+ * @brief Constant declaring how full the buckets of a hash index can get on average, in percents of a page, before
+ * the next bucket is split
+ */
+#define HASH_SPLIT_PERCENT 80
+/**
+ * @def HASH_DIRECTORY_ENTRIES
+ * @brief Constant declaring how many bucket addresses one directory page of a hash index holds
+ */
+#define HASH_DIRECTORY_ENTRIES (DATA_BLOCK_SIZE * DATA_ENTRY_SIZE / (int) sizeof (int))
+/**
+ * @def HASH_DIRECTORY_PAGES
+ * @brief Constant declaring how many directory pages a hash index can have, which limits it to
+ * HASH_DIRECTORY_PAGES * HASH_DIRECTORY_ENTRIES buckets
+ */
+#define HASH_DIRECTORY_PAGES 1000
+/**
+ * @def HASH_KNOWN_INDEXES
+ * @brief Constant declaring how many hash indices keep their description in memory, so that they are opened
+ * without searching the system catalog
+ */
+#define HASH_KNOWN_INDEXES 16
+/**
+ * @def BLOCK_TYPE_BITMAP
+ * @brief Constant declaring block that belongs to a bitmap index, the data area starts with AK_bitmap_info in the
+ * first block of the index and with AK_bitmap_page in pages of bitmaps (used in AK_block->type)
+ */
+#define BLOCK_TYPE_BITMAP 8
+/**
+ * @def BLOCK_TYPE_TRIGRAM
+ * @brief Constant declaring block that belongs to a trigram index, the data area starts with AK_trigram_info and the
+ * posting lists in the first block of the index and with AK_bitmap_page in pages of the lists (used in
+ * AK_block->type)
+ */
+#define BLOCK_TYPE_TRIGRAM 9
+/**
+ * @def TRIGRAM_LISTS
+ * @brief Constant declaring how many posting lists a trigram index has, trigrams are hashed to them and their
+ * descriptions fit into the first block of the index after AK_trigram_info
+ */
+#define TRIGRAM_LISTS 256
+/**
+ * @def INDEX_MAX_PER_TABLE
+ * @brief Constant declaring how many B+tree, hash, bitmap and trigram indices of a table are kept up to date by DML
+ * and considered by the selection
+ */
+#define INDEX_MAX_PER_TABLE 32
+/**
+ * @def VACUUM_QUEUE_SIZE
+ * @brief Constant declaring how many tables can wait for the vacuum at the same time
+ */
+#define VACUUM_QUEUE_SIZE 32
+/**
+ * @def OUTPUT_FORMAT_TABLE
+ * @brief Constant declaring output of a table in boxes, like in AK_print_table
+ */
+#define OUTPUT_FORMAT_TABLE 0
+/**
+ * @def OUTPUT_FORMAT_CSV
+ * @brief Constant declaring output of a table as comma separated values
+ */
+#define OUTPUT_FORMAT_CSV 1
+/**
+ * @def OUTPUT_FORMAT_BINARY
+ * @brief Constant declaring output of a table in the binary format described in AK_output_table
+ */
+#define OUTPUT_FORMAT_BINARY 2
+/**
+ * @def OUTPUT_BUFFER_SIZE
+ * @brief Constant declaring how many bytes of table output are collected before they are written
+ */
+#define OUTPUT_BUFFER_SIZE 65536
+/**
+ * @def OUTPUT_BINARY_MAGIC
+ * @brief Constant declaring the bytes that begin binary output of a table
+ */
+#define OUTPUT_BINARY_MAGIC "AKDB"
+/**
+ * @def OUTPUT_BINARY_END
+ * @brief Constant declaring the value written in place of the size of a value after the last row of binary output
+ */
+#define OUTPUT_BINARY_END -1
+/**
+ * @def SORT_KEY_PREFIX
+ * @brief Constant declaring how many bytes of the normalized sort key are kept with each row held in memory
+ */
+#define SORT_KEY_PREFIX 24
+/**
+ * @def SORT_INSERTION_SIZE
+ * @brief Constant declaring the number of rows below which the sort in memory uses insertion sort
+ */
+#define SORT_INSERTION_SIZE 16
+/**
+ * @def SORT_PARALLEL_MIN_ROWS
+ * @brief Constant declaring the smallest number of rows a thread of the sort gets, fewer rows are sorted by one thread
+ */
+#define SORT_PARALLEL_MIN_ROWS 2048
+/**
+ * @def SORT_ASC
+ * @brief Constant declaring the list element that follows a sort attribute to sort it in ascending order
+ */
+#define SORT_ASC "ASC"
+/**
+ * @def SORT_DESC
+ * @brief Constant declaring the list element that follows a sort attribute to sort it in descending order
+ */
+#define SORT_DESC "DESC"
 /**
  * @def NOT_CHAINED
  * @brief Constant used in AK_block->chained_with if the block isn't chained
@@ -291,6 +488,12 @@
  * @brief Constant indicating aggregator (for HAVING) in AK_list
  */
 #define TYPE_AGGREGATOR 16
+/**
+ * @def TYPE_OVERFLOW
+ * @brief Constant declaring a value that is stored in overflow pages, the entry holds the address of the first page
+ * (used in AK_tuple_dict->type and AK_list)
+ */
+#define TYPE_OVERFLOW 17
 /**
  * @def BLOCK_CLEAN
  * @brief Constant indicating block cleaning (not changed since read from disk)
@@ -358,29 +561,16 @@
  * @brief Constant indicating 'select' operation
  */
 #define SELECT 3
+/**
+ * @def BULK_INSERT
+ * @brief Constant indicating a batch of rows loaded by the bulk loader
+ */
+#define BULK_INSERT 4
 /**
  * @def FIND
  * @brief Constant indicating that the operation to be performed is 'search'
  */
 #define FIND 2
-/**
- * @def INFO_BUCKET
- * @brief Constant declaring the type of bucket as "info bucket" when inserting
- * bucket to block
- */
-#define INFO_BUCKET 0
-/**
- * @def MAIN_BUCKET
- * @brief Constant declaring the type of bucket as "main bucket" when inserting
- * bucket to block
- */
-#define MAIN_BUCKET 1
-/**
- * @def HASH_BUCKET
- * @brief Constant declaring the type of bucket as "hash bucket" when inserting
- * bucket to block
- */
-#define HASH_BUCKET 2
 /**
  * @def SHARED_LOCK
  * @brief Constant declaring the type of lock as SHARED LOCK
@@ -25,6 +25,7 @@
 //      header
 #include "dbman.h"
 #include "../mm/memoman.h"
+#include "../file/zonemap.h"
 pthread_mutex_t fileLockMutex = PTHREAD_MUTEX_INITIALIZER;
 
 PtrContainer db;
@@ -918,9 +919,9 @@ AK_print_block(AK_block * block, int num, char* gg, FILE *fpp)
 }
 
 /**
-* @author Markus Schatten , rearranged by dv
+* @author Markus Schatten , rearranged by dv, updated by Karlo Vuković (zone maps)
 * @brief  Function that allocates new blocks by placing them to appropriate place
-* and then updates the last initialized index
+* and then updates the last initialized index. Zone maps of the overwritten blocks are forgotten.
 * @return EXIT_SUCCESS if the file has been written to disk, EXIT_ERROR otherwise
 */
 int
@@ -956,6 +957,7 @@ AK_allocate_blocks(FILE* db, AK_block * block, int FromWhere, int HowMany)
 	    AK_EPI;
 	    return EXIT_ERROR;
 	  }
+	AK_zone_map_invalidate(i);
       }
     pthread_mutex_unlock(&fileLockMutex);
 
@@ -1107,9 +1109,9 @@ AK_read_block(int address)
 }
 
 /**
-* @author Markus Schatten, updated by Domagoj Šitum (thread-safe enabled)
+* @author Markus Schatten, updated by Domagoj Šitum (thread-safe enabled), updated by Karlo Vuković (zone maps)
 * @brief  Function that writes a block to the DB file. Database file is opened. Position is set to provided address block. Block is
-  written to provided address. Completely thread-safe.
+  written to provided address and the zone map of the block is refreshed. Completely thread-safe.
 * @param block poiner to block allocated in memory to write
 * @return EXIT_SUCCESS if successful, EXIT_ERROR otherwise
 */
@@ -1191,6 +1193,8 @@ AK_write_block(AK_block * block)
       AK_EPI;
       exit(EXIT_ERROR);
     }
+  // inserts, updates and deletes reach the zone map of the block here
+  AK_zone_map_update(block);
         
   // after writing is done, we unlock this block for reading and/or writing
   activityInfo[address].locked_for_writing = false;
@@ -1214,8 +1218,9 @@ AK_write_block(AK_block * block)
 
 
 /**
- * @author Nikola Bakoš, updated by Dino Laktašić (fixed header BUG), refurbished by dv, updated by Josip Šušnjara (chained blocks support)
- * @brief Function copy header to blocks. Completely thread-safe
+ * @author Nikola Bakoš, updated by Dino Laktašić (fixed header BUG), refurbished by dv, updated by Josip Šušnjara (chained blocks support), updated by Karlo Vuković (wide blocks, unterminated headers)
+ * @brief Function copy header to blocks. Completely thread-safe. If the header has more than MAX_ATTRIBUTES
+ * attributes, it is split over groups of chained blocks and the blocks get the type BLOCK_TYPE_WIDE
  * @param header Pointer to header which will be copied into each block in blockSet
  * @param blockSet Pointer to array of block addresses into which to copy header
  * @param blockSetSize Number of blocks in blockSet
@@ -1237,7 +1242,8 @@ AK_copy_header(AK_header *header, int* blockSet, int blockSetSize)
   
   AK_PRO;
   
-  while(header[atts].type != TYPE_INTERNAL){
+  //headers read from blocks are not terminated, their unused attributes keep FREE_INT
+  while(header[atts].type != TYPE_INTERNAL && header[atts].type != FREE_INT){
   		atts++;
   }
   blocks_per_row = 1 + (atts - 1) / MAX_ATTRIBUTES;
@@ -1252,8 +1258,7 @@ AK_copy_header(AK_header *header, int* blockSet, int blockSetSize)
 			memcpy(t_header[i] + k, temp, sizeof ( AK_header));
 			cur_attr++;
 	  	}
-	  	temp = (AK_header*) AK_create_header("test", TYPE_INTERNAL, FREE_INT, FREE_CHAR, FREE_CHAR);
-	  	memset(t_header[i] + k, 0, MAX_ATTRIBUTES - k);
+	  	memset(t_header[i] + k, 0, sizeof(AK_header) * (MAX_ATTRIBUTES - k));
 	  	
   }
 		
@@ -1266,13 +1271,14 @@ AK_copy_header(AK_header *header, int* blockSet, int blockSetSize)
       }
 
       //@TODO the check fails second time around if the table has MAX_ATTRIBUTES
-      for(header_att_id = 0; (header_att_id < MAX_ATTRIBUTES) && (header[header_att_id].type != 0); header_att_id++)
+      for(header_att_id = 0; (header_att_id < MAX_ATTRIBUTES) && (header_att_id < atts); header_att_id++)
 	{
 	  //memcpy(&block->header[header_att_id], &header[header_att_id], sizeof(*header));
 	  memcpy(&block->header[header_att_id], &t_header[j % blocks_per_row][header_att_id], sizeof(*header));
 	}
       
-      block->type = BLOCK_TYPE_NORMAL;
+      //blocks of wide tables hold whole rows, chained blocks only carry the rest of the header
+      block->type = blocks_per_row > 1 ? BLOCK_TYPE_WIDE : BLOCK_TYPE_NORMAL;
       block->AK_free_space = 0;
       block->last_tuple_dict_id = 0;
       if(j % blocks_per_row != (blocks_per_row - 1) && blocks_per_row > 1){
@@ -0,0 +1,831 @@
+/**
+@file bulk.c Provides functions for bulk loading of rows
+ */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#include "bulk.h"
+#include "idx/bloom.h"
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that checks a batch of rows before anything is written. Every value has to be a new value of an
+ *        existing attribute with the type from the table header. AK_reference is scanned once per batch, and
+ *        referential integrity is checked only if the table has foreign keys, with AK_reference_check_entries, which
+ *        looks up each distinct value of a foreign key once.
+ * @param tblName table name
+ * @param header table header
+ * @param num_attr number of attributes in the header
+ * @param rows array of rows, each one a list of elements
+ * @param num_rows number of rows in the array
+ * @return EXIT_SUCCESS if every row of the batch can be loaded, otherwise EXIT_ERROR
+ */
+int AK_bulk_check_rows(char *tblName, AK_header *header, int num_attr, struct list_node **rows, int num_rows) {
+    struct list_node *el, *ref_row;
+    int i, j, has_references = 0;
+    AK_PRO;
+
+    for (i = 0; i < num_rows; i++) {
+        for (el = rows[i]->next; el != NULL; el = el->next) {
+            if (el->constraint != NEW_VALUE || strcmp(el->table, tblName) != 0) {
+                printf("AK_bulk_insert: Row %d is not a new row of table %s.\n", i, tblName);
+                AK_EPI;
+                return EXIT_ERROR;
+            }
+            for (j = 0; j < num_attr; j++) {
+                if (strcmp(header[j].att_name, el->attribute_name) == 0)
+                    break;
+            }
+            if (j == num_attr) {
+                printf("AK_bulk_insert: Row %d: table %s has no attribute %s.\n", i, tblName, el->attribute_name);
+                AK_EPI;
+                return EXIT_ERROR;
+            }
+            if (el->type != header[j].type) {
+                printf("AK_bulk_insert: Row %d: value of %s has type %d, expected %d.\n", i, el->attribute_name, el->type, header[j].type);
+                AK_EPI;
+                return EXIT_ERROR;
+            }
+        }
+    }
+
+    i = 0;
+    while (!has_references && (ref_row = AK_get_row(i, "AK_reference")) != NULL) {
+        if (strcmp(ref_row->next->data, tblName) == 0)
+            has_references = 1;
+        AK_DeleteAll_L3(&ref_row);
+        AK_free(ref_row);
+        i++;
+    }
+
+    if (has_references && AK_reference_check_entries(rows, num_rows, &i) == EXIT_ERROR) {
+        printf("AK_bulk_insert: Row %d violates reference integrity.\n", i);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+
+    AK_EPI;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that packs one row at the end of the block. Values are written in header order, missing values
+ *        are written as "null" just like in AK_insert_row_to_block. It is called once for every loaded row, so it
+ *        walks the row list directly and takes sizes of fixed size types from the caller.
+ * @param block block to write to
+ * @param header table header
+ * @param type_sizes size of each attribute type, -1 for types whose size depends on the value
+ * @param num_attr number of attributes in the header
+ * @param row list of elements of the row
+ * @return EXIT_SUCCESS if the row was written, EXIT_ERROR if it does not fit into the block
+ */
+static inline int AK_bulk_pack_row(AK_block *block, AK_header *header, int *type_sizes, int num_attr, struct list_node *row) {
+    struct list_node *values[MAX_ATTRIBUTES];
+    struct list_node *el;
+    int sizes[MAX_ATTRIBUTES];
+    int i, id, row_size = 0;
+
+    for (i = 0; i < num_attr; i++) {
+        values[i] = NULL;
+        for (el = row->next; el != NULL; el = el->next) {
+            if (strcmp(el->attribute_name, header[i].att_name) == 0) {
+                values[i] = el;
+                break;
+            }
+        }
+        if (values[i] == NULL)
+            sizes[i] = strlen("null");
+        else if (type_sizes[i] == -1)
+            sizes[i] = strlen(values[i]->data);
+        else
+            sizes[i] = type_sizes[i];
+        row_size += sizes[i];
+    }
+
+    id = block->last_tuple_dict_id;
+    while (id < DATA_BLOCK_SIZE && block->tuple_dict[id].size != FREE_INT)
+        id++;
+
+    if (id + num_attr > DATA_BLOCK_SIZE || block->AK_free_space + row_size > DATA_BLOCK_SIZE * DATA_ENTRY_SIZE)
+        return EXIT_ERROR;
+
+    for (i = 0; i < num_attr; i++, id++) {
+        memcpy(block->data + block->AK_free_space, values[i] != NULL ? values[i]->data : "null", sizes[i]);
+        block->tuple_dict[id].address = block->AK_free_space;
+        block->tuple_dict[id].type = values[i] != NULL ? values[i]->type : TYPE_VARCHAR;
+        block->tuple_dict[id].size = sizes[i];
+        block->AK_free_space += sizes[i];
+    }
+    block->last_tuple_dict_id = id - 1;
+
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that brings indexes and Bloom filters of the table up to date after a bulk load. Each index is
+ *        updated once for the whole load instead of once per row, with the rows collected in the batch.
+ * @param tblName table name
+ * @param batch rows written by the load
+ * @return No return value
+ */
+void AK_bulk_refresh_indexes(char *tblName, AK_index_batch *batch) {
+    AK_PRO;
+    AK_bloom_filter_rebuild(tblName);
+    AK_index_batch_apply(batch);
+    AK_EPI;
+}
+
+/**
+ * @author Karlo Vuković
+ * @struct AK_bulk_undo
+ * @brief Structure that records how a block looked before a bulk load packed its first row into it
+ */
+typedef struct {
+    /// address of the block
+    int address;
+    /// first tuple_dict entry written by the load
+    int first_id;
+    /// last_tuple_dict_id of the block before the load
+    int last_tuple_dict_id;
+    /// AK_free_space of the block before the load
+    int free_space;
+} AK_bulk_undo;
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that takes the rows of a failed bulk load out of the blocks again. Blocks are restored in reverse
+ *        order, their entries written by the load are freed together with the bytes they point to.
+ * @param undo records of the blocks the load wrote to
+ * @param num_undo number of records
+ * @return No return value
+ */
+static void AK_bulk_undo_blocks(AK_bulk_undo *undo, int num_undo) {
+    AK_mem_block *mem_block;
+    AK_block *block;
+    int i, id;
+
+    for (i = num_undo - 1; i >= 0; i--) {
+        mem_block = AK_get_block(undo[i].address);
+        block = mem_block->block;
+        for (id = undo[i].first_id; id <= block->last_tuple_dict_id && id < DATA_BLOCK_SIZE; id++) {
+            if (block->tuple_dict[id].size > 0)
+                memset(block->data + block->tuple_dict[id].address, FREE_CHAR, block->tuple_dict[id].size);
+            block->tuple_dict[id].type = FREE_INT;
+            block->tuple_dict[id].address = FREE_INT;
+            block->tuple_dict[id].size = FREE_INT;
+        }
+        block->last_tuple_dict_id = undo[i].last_tuple_dict_id;
+        block->AK_free_space = undo[i].free_space;
+        AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+    }
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that loads a batch of rows into the table. The batch is validated as a whole, one redolog entry
+ *        is written for it and the rows are packed directly into consecutive blocks of the table, starting from
+ *        the first block with free space. When the table runs out of blocks new extents are allocated with
+ *        AK_init_new_extent. Rows of tables with PAX layout are packed into minipages with AK_pax_pack_row.
+ *        Rows written are collected and indexes are updated with them once at the end. Rows of tables with more
+ *        than MAX_ATTRIBUTES attributes are loaded through AK_insert_row. If the table runs out of room in the
+ *        middle of the batch, the rows already packed are taken out again, its redolog entry is removed and indexes
+ *        are left as they were, so only the new empty extents remain.
+ * @param tblName table name
+ * @param rows array of rows, each one a list of elements like the one given to AK_insert_row
+ * @param num_rows number of rows in the array
+ * @return EXIT_SUCCESS if all rows were loaded, EXIT_ERROR if the batch was rejected or could not be written
+ */
+int AK_bulk_insert(char *tblName, struct list_node **rows, int num_rows) {
+    AK_header *header;
+    table_addresses *addresses;
+    AK_mem_block *mem_block = NULL;
+    int num_attr, i = 0, ext = 0, adr, adr_in_cache = -1;
+    int max_free_space, max_tuple_dict, packed, modified = 0;
+    int last_tuple_dict_id = 0, free_space = 0, num_undo = 0, max_undo = 0;
+    int type_sizes[MAX_ATTRIBUTES];
+    AK_bulk_undo *undo = NULL;
+    AK_pax_layout layout;
+    AK_index_batch batch;
+    AK_PRO;
+
+    if (num_rows <= 0) {
+        AK_EPI;
+        return EXIT_SUCCESS;
+    }
+
+    addresses = AK_get_table_addresses(tblName);
+    if (addresses->address_from[0] == 0) {
+        printf("AK_bulk_insert: Table %s does not exist!\n", tblName);
+        AK_free(addresses);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+
+    num_attr = AK_num_attr(tblName);
+    if (num_attr > MAX_ATTRIBUTES) {
+        AK_free(addresses);
+        for (i = 0; i < num_rows; i++) {
+            if (AK_insert_row(rows[i]) == EXIT_ERROR) {
+                AK_EPI;
+                return EXIT_ERROR;
+            }
+        }
+        AK_EPI;
+        return EXIT_SUCCESS;
+    }
+
+    header = AK_get_header(tblName);
+    if (AK_bulk_check_rows(tblName, header, num_attr, rows, num_rows) == EXIT_ERROR) {
+        printf("AK_bulk_insert: Batch of %d rows rejected, nothing was written to %s.\n", num_rows, tblName);
+        AK_free(header);
+        AK_free(addresses);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+
+    AK_add_to_redolog_bulk(tblName, num_rows);
+    AK_index_batch_begin(&batch, tblName);
+
+    for (i = 0; i < num_attr; i++)
+        type_sizes[i] = header[i].type == TYPE_VARCHAR ? -1 : AK_type_size(header[i].type, NULL);
+    i = 0;
+
+    //rows of PAX tables are packed into minipages
+    layout.rows = 0;
+    if (AK_get_block(addresses->address_from[0])->block->type == BLOCK_TYPE_PAX)
+        AK_pax_get_layout(header, &layout);
+
+    max_free_space = MAX_FREE_SPACE_SIZE;
+    max_tuple_dict = MAX_LAST_TUPLE_DICT_SIZE_TO_USE;
+    adr = addresses->address_from[0];
+
+    while (i < num_rows) {
+        if (adr >= addresses->address_to[ext]) {
+            ext++;
+            if (ext == MAX_EXTENTS_IN_SEGMENT) {
+                printf("AK_bulk_insert: Table %s has no more room for extents.\n", tblName);
+                break;
+            }
+            if (addresses->address_from[ext] == 0) {
+                if (AK_init_new_extent(tblName, SEGMENT_TYPE_TABLE) == EXIT_ERROR)
+                    break;
+                AK_free(addresses);
+                addresses = AK_get_table_addresses(tblName);
+                if (addresses->address_from[ext] == 0)
+                    break;
+            }
+            adr = addresses->address_from[ext];
+            continue;
+        }
+
+        if (adr != adr_in_cache) {
+            mem_block = AK_get_block(adr);
+            adr_in_cache = adr;
+            modified = 0;
+            last_tuple_dict_id = mem_block->block->last_tuple_dict_id;
+            free_space = mem_block->block->AK_free_space;
+        }
+
+        packed = EXIT_ERROR;
+        if (mem_block->block->AK_free_space < max_free_space && mem_block->block->last_tuple_dict_id < max_tuple_dict) {
+            if (layout.rows > 0) {
+                packed = AK_pax_pack_row(mem_block->block, &layout, rows[i]);
+                //a PAX block the row does not fit into is marked as full, which has to reach the disk as well
+                if (packed == EXIT_ERROR && mem_block->block->AK_free_space >= max_free_space)
+                    AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+            } else
+                packed = AK_bulk_pack_row(mem_block->block, header, type_sizes, num_attr, rows[i]);
+        }
+
+        if (packed == EXIT_SUCCESS) {
+            //the first row of the batch in a block marks it as changed even if it is dirty, so its zone map is dropped
+            if (!modified) {
+                AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+                if (num_undo == max_undo) {
+                    max_undo = max_undo == 0 ? 16 : 2 * max_undo;
+                    undo = AK_realloc(undo, max_undo * sizeof(AK_bulk_undo));
+                }
+                undo[num_undo].address = adr;
+                undo[num_undo].first_id = mem_block->block->last_tuple_dict_id + 1 - num_attr;
+                undo[num_undo].last_tuple_dict_id = last_tuple_dict_id;
+                undo[num_undo].free_space = free_space;
+                num_undo++;
+            }
+            modified = 1;
+            //PAX tables have no indices
+            if (layout.rows == 0)
+                AK_index_batch_add(&batch, mem_block->block, adr, mem_block->block->last_tuple_dict_id + 1 - num_attr, 1);
+            i++;
+        } else if (layout.rows > 0 && mem_block->block->AK_free_space < max_free_space &&
+                   mem_block->block->last_tuple_dict_id < max_tuple_dict) {
+            //row does not fit even into an empty PAX block
+            break;
+        } else {
+            adr++;
+        }
+    }
+
+    AK_free(addresses);
+
+    if (i < num_rows) {
+        printf("AK_bulk_insert: Only %d of %d rows fit into %s, the batch was undone.\n", i, num_rows, tblName);
+        AK_bulk_undo_blocks(undo, num_undo);
+        //new extents stay, so only the entry of the batch is removed from the redolog
+        AK_redolog_remove_bulk(tblName);
+        AK_redolog_commit();
+        batch.num_deltas = 0;
+        AK_index_batch_apply(&batch);
+        if (undo != NULL)
+            AK_free(undo);
+        AK_free(header);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+
+    AK_redolog_commit();
+    AK_bulk_refresh_indexes(tblName, &batch);
+    if (undo != NULL)
+        AK_free(undo);
+    AK_free(header);
+    AK_EPI;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that prepares a writer that packs rows at the end of the table, starting from its first block
+ *        with free space
+ * @param writer writer to prepare
+ * @param tblName table name
+ * @return EXIT_SUCCESS, EXIT_ERROR if the table does not exist
+ */
+int AK_bulk_writer_open(AK_bulk_writer *writer, char *tblName) {
+    AK_PRO;
+    writer->tblName = tblName;
+    writer->addresses = AK_get_table_addresses(tblName);
+    writer->extent = 0;
+    writer->address = writer->addresses->address_from[0];
+    writer->mem_block = NULL;
+    writer->max_free_space = MAX_FREE_SPACE_SIZE;
+    writer->max_tuple_dict = MAX_LAST_TUPLE_DICT_SIZE_TO_USE;
+    writer->num_rows = 0;
+
+    if (writer->address == 0) {
+        printf("AK_bulk_writer_open: Table %s does not exist!\n", tblName);
+        AK_free(writer->addresses);
+        writer->addresses = NULL;
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    AK_EPI;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that copies a row given by its entries and the bytes they point to into the table. Entries are
+ *        copied as they are, without checks and without a redolog entry. New extents are allocated when needed.
+ *        Tables with PAX layout are not supported.
+ * @param writer writer
+ * @param entries entries of the row
+ * @param data bytes the addresses of the entries point into
+ * @param num_attr number of attributes
+ * @return EXIT_SUCCESS if the row was written, otherwise EXIT_ERROR
+ */
+int AK_bulk_write_entries(AK_bulk_writer *writer, AK_tuple_dict *entries, char *data, int num_attr) {
+    AK_mem_block *mem_block;
+    AK_block *dest;
+    AK_tuple_dict *entry;
+    int i, id, row_size = 0;
+    AK_PRO;
+
+    for (i = 0; i < num_attr; i++)
+        row_size += entries[i].size;
+
+    while (writer->addresses != NULL) {
+        if (writer->address >= writer->addresses->address_to[writer->extent]) {
+            writer->extent++;
+            if (writer->extent == MAX_EXTENTS_IN_SEGMENT)
+                break;
+            if (writer->addresses->address_from[writer->extent] == 0) {
+                if (AK_init_new_extent(writer->tblName, SEGMENT_TYPE_TABLE) == EXIT_ERROR)
+                    break;
+                AK_free(writer->addresses);
+                writer->addresses = AK_get_table_addresses(writer->tblName);
+                if (writer->addresses->address_from[writer->extent] == 0)
+                    break;
+            }
+            writer->address = writer->addresses->address_from[writer->extent];
+            continue;
+        }
+
+        //reading other blocks between two rows can put another block into the same place in the cache
+        if (writer->mem_block == NULL || writer->mem_block->block->address != writer->address)
+            writer->mem_block = AK_get_block(writer->address);
+        mem_block = writer->mem_block;
+        dest = mem_block->block;
+        if (dest->type == BLOCK_TYPE_PAX) {
+            printf("AK_bulk_write_entries: Rows can not be copied into PAX table %s.\n", writer->tblName);
+            AK_EPI;
+            return EXIT_ERROR;
+        }
+        id = dest->last_tuple_dict_id;
+        while (id < DATA_BLOCK_SIZE && dest->tuple_dict[id].size != FREE_INT)
+            id++;
+
+        if (dest->AK_free_space >= writer->max_free_space || dest->last_tuple_dict_id >= writer->max_tuple_dict ||
+            id + num_attr > DATA_BLOCK_SIZE || dest->AK_free_space + row_size > DATA_BLOCK_SIZE * DATA_ENTRY_SIZE) {
+            writer->address++;
+            continue;
+        }
+
+        for (i = 0; i < num_attr; i++, id++) {
+            entry = &entries[i];
+            memcpy(dest->data + dest->AK_free_space, data + entry->address, entry->size);
+            dest->tuple_dict[id].address = dest->AK_free_space;
+            dest->tuple_dict[id].type = entry->type;
+            dest->tuple_dict[id].size = entry->size;
+            dest->AK_free_space += entry->size;
+        }
+        dest->last_tuple_dict_id = id - 1;
+        if (mem_block->dirty != BLOCK_DIRTY)
+            AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+        writer->num_rows++;
+        AK_EPI;
+        return EXIT_SUCCESS;
+    }
+
+    printf("AK_bulk_write_entries: Table %s has no more room for rows.\n", writer->tblName);
+    AK_EPI;
+    return EXIT_ERROR;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that copies a row from a block into the table with AK_bulk_write_entries
+ * @param writer writer
+ * @param block block that holds the row
+ * @param tuple first entry of the row in the tuple dictionary of the block
+ * @param num_attr number of attributes
+ * @return EXIT_SUCCESS if the row was written, otherwise EXIT_ERROR
+ */
+int AK_bulk_write_row(AK_bulk_writer *writer, AK_block *block, int tuple, int num_attr) {
+    return AK_bulk_write_entries(writer, &block->tuple_dict[tuple], (char *)block->data, num_attr);
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that frees the memory held by the writer
+ * @param writer writer
+ * @return No return value
+ */
+void AK_bulk_writer_close(AK_bulk_writer *writer) {
+    AK_PRO;
+    if (writer->addresses != NULL)
+        AK_free(writer->addresses);
+    writer->addresses = NULL;
+    AK_EPI;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that splits one line of a CSV file into values. Values can be enclosed in double quotes, in
+ *        which case they can contain the delimiter and a double quote is written as two double quotes.
+ * @param line line without the line terminator
+ * @param delimiter character that separates values
+ * @param fields array the values are copied to
+ * @param quoted array of flags set for values that were enclosed in double quotes
+ * @param max_fields size of the fields and quoted arrays
+ * @return number of values in the line
+ */
+int AK_bulk_split_csv(char *line, char delimiter, char (*fields)[MAX_VARCHAR_LENGTH], int *quoted, int max_fields) {
+    char value[MAX_VARCHAR_LENGTH];
+    char *p = line;
+    int num_fields = 0, len, in_quotes;
+    AK_PRO;
+
+    while (1) {
+        len = 0;
+        in_quotes = 0;
+        if (*p == '"') {
+            in_quotes = 1;
+            p++;
+        }
+        while (*p != '\0') {
+            if (in_quotes && *p == '"') {
+                if (*(p + 1) == '"') {
+                    p++;
+                } else {
+                    p++;
+                    while (*p != '\0' && *p != delimiter)
+                        p++;
+                    break;
+                }
+            } else if (!in_quotes && *p == delimiter) {
+                break;
+            }
+            if (len < MAX_VARCHAR_LENGTH - 1)
+                value[len++] = *p;
+            p++;
+        }
+        value[len] = '\0';
+
+        if (num_fields < max_fields) {
+            memcpy(fields[num_fields], value, len + 1);
+            quoted[num_fields] = in_quotes;
+        }
+        num_fields++;
+
+        if (*p != delimiter)
+            break;
+        p++;
+    }
+
+    AK_EPI;
+    return num_fields;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that loads the contents of a CSV file into the table, like COPY ... FROM in SQL. Each line holds
+ *        the values of one row in the order of the table header. Empty values that are not quoted are loaded as
+ *        null. Rows are loaded with AK_bulk_insert in batches of BULK_BATCH_SIZE rows.
+ * @param tblName table name
+ * @param fileName path to the CSV file
+ * @param delimiter character that separates values
+ * @param has_header 1 if the first line holds attribute names and should be skipped, otherwise 0
+ * @return EXIT_SUCCESS if the whole file was loaded, otherwise EXIT_ERROR
+ */
+int AK_copy_from_csv(char *tblName, char *fileName, char delimiter, int has_header) {
+    FILE *fp;
+    AK_header *header;
+    struct list_node **rows;
+    char (*fields)[MAX_VARCHAR_LENGTH];
+    char *line, *end;
+    int *quoted;
+    int num_attr, batch_size, line_size, num_fields, i;
+    int num_rows = 0, line_num = 0, loaded = 0, result = EXIT_SUCCESS;
+    int int_value;
+    float float_value;
+    double number_value;
+    AK_PRO;
+
+    num_attr = AK_num_attr(tblName);
+    if (num_attr <= 0 || (header = AK_get_header(tblName)) == NULL) {
+        printf("AK_copy_from_csv: Table %s does not exist!\n", tblName);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+
+    if ((fp = fopen(fileName, "r")) == NULL) {
+        printf("AK_copy_from_csv: Could not open file %s\n", fileName);
+        AK_free(header);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+
+    batch_size = BULK_BATCH_SIZE;
+    if (batch_size <= 0)
+        batch_size = 1;
+    line_size = num_attr * (2 * MAX_VARCHAR_LENGTH + 3) + 2;
+    line = (char *) AK_malloc(line_size);
+    fields = AK_calloc(num_attr, MAX_VARCHAR_LENGTH);
+    quoted = (int *) AK_calloc(num_attr, sizeof(int));
+    rows = (struct list_node **) AK_calloc(batch_size, sizeof(struct list_node *));
+
+    while (result == EXIT_SUCCESS && fgets(line, line_size, fp) != NULL) {
+        line_num++;
+        line[strcspn(line, "\r\n")] = '\0';
+        if (line[0] == '\0' || (line_num == 1 && has_header))
+            continue;
+
+        num_fields = AK_bulk_split_csv(line, delimiter, fields, quoted, num_attr);
+        if (num_fields != num_attr) {
+            printf("AK_copy_from_csv: Line %d has %d values, table %s has %d attributes.\n", line_num, num_fields, tblName, num_attr);
+            result = EXIT_ERROR;
+            break;
+        }
+
+        rows[num_rows] = (struct list_node *) AK_malloc(sizeof(struct list_node));
+        AK_Init_L3(&rows[num_rows]);
+        for (i = 0; i < num_attr && result == EXIT_SUCCESS; i++) {
+            if (fields[i][0] == '\0' && !quoted[i])
+                continue;
+
+            errno = 0;
+            switch (header[i].type) {
+                case TYPE_INT:
+                case TYPE_DATE:
+                case TYPE_DATETIME:
+                case TYPE_TIME:
+                case TYPE_INTERVAL:
+                case TYPE_PERIOD:
+                    int_value = (int) strtol(fields[i], &end, 10);
+                    if (*end != '\0' || errno != 0)
+                        result = EXIT_ERROR;
+                    else
+                        AK_Insert_New_Element(header[i].type, &int_value, tblName, header[i].att_name, rows[num_rows]);
+                    break;
+                case TYPE_FLOAT:
+                    float_value = strtof(fields[i], &end);
+                    if (*end != '\0' || errno != 0)
+                        result = EXIT_ERROR;
+                    else
+                        AK_Insert_New_Element(header[i].type, &float_value, tblName, header[i].att_name, rows[num_rows]);
+                    break;
+                case TYPE_NUMBER:
+                    number_value = strtod(fields[i], &end);
+                    if (*end != '\0' || errno != 0)
+                        result = EXIT_ERROR;
+                    else
+                        AK_Insert_New_Element(header[i].type, &number_value, tblName, header[i].att_name, rows[num_rows]);
+                    break;
+                default:
+                    AK_Insert_New_Element(header[i].type, fields[i], tblName, header[i].att_name, rows[num_rows]);
+                    break;
+            }
+            if (result == EXIT_ERROR)
+                printf("AK_copy_from_csv: Line %d: '%s' is not a valid value of %s.\n", line_num, fields[i], header[i].att_name);
+        }
+        num_rows++;
+
+        if (result == EXIT_SUCCESS && num_rows == batch_size) {
+            result = AK_bulk_insert(tblName, rows, num_rows);
+            if (result == EXIT_SUCCESS)
+                loaded += num_rows;
+            for (i = 0; i < num_rows; i++) {
+                AK_DeleteAll_L3(&rows[i]);
+                AK_free(rows[i]);
+            }
+            num_rows = 0;
+        }
+    }
+
+    if (result == EXIT_SUCCESS && num_rows > 0) {
+        result = AK_bulk_insert(tblName, rows, num_rows);
+        if (result == EXIT_SUCCESS)
+            loaded += num_rows;
+    }
+    for (i = 0; i < num_rows; i++) {
+        AK_DeleteAll_L3(&rows[i]);
+        AK_free(rows[i]);
+    }
+
+    printf("AK_copy_from_csv: %d rows loaded into %s from %s\n", loaded, tblName, fileName);
+
+    fclose(fp);
+    AK_free(rows);
+    AK_free(quoted);
+    AK_free(fields);
+    AK_free(line);
+    AK_free(header);
+    AK_EPI;
+    return result;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function for testing the bulk loader
+ * @return TestResult
+ */
+TestResult AK_bulk_test() {
+    char *tblName = "bulk_test";
+    char *csvName = "bulk_test.csv";
+    int num_rows = 5000, num_single = 200;
+    int ok = 0, fail = 0;
+    int i, id, num_records;
+    float weight;
+    char name[MAX_VARCHAR_LENGTH];
+    struct list_node **rows;
+    struct list_node *el;
+    clock_t t;
+    double single_time, bulk_time;
+    FILE *fp;
+    AK_PRO;
+
+    printf("\n********** BULK LOADER TEST **********\n\n");
+
+    AK_header t_header[4] = {
+        {TYPE_INT, "id", {0}, {{'\0'}}, {{'\0'}}},
+        {TYPE_VARCHAR, "name", {0}, {{'\0'}}, {{'\0'}}},
+        {TYPE_FLOAT, "weight", {0}, {{'\0'}}, {{'\0'}}},
+        {0, {'\0'}, {0}, {{'\0'}}, {{'\0'}}}};
+
+    if (AK_num_attr(tblName) > 0)
+        AK_delete_segment(tblName, SEGMENT_TYPE_TABLE);
+
+    if (AK_initialize_new_segment(tblName, SEGMENT_TYPE_TABLE, t_header) == EXIT_ERROR) {
+        printf("Could not create table %s\n", tblName);
+        AK_EPI;
+        return TEST_result(ok, fail + 1);
+    }
+
+    rows = (struct list_node **) AK_calloc(num_rows, sizeof(struct list_node *));
+    for (i = 0; i < num_rows; i++) {
+        id = i;
+        weight = 50 + i % 40;
+        sprintf(name, "name%d", i);
+        rows[i] = (struct list_node *) AK_malloc(sizeof(struct list_node));
+        AK_Init_L3(&rows[i]);
+        AK_Insert_New_Element(TYPE_INT, &id, tblName, "id", rows[i]);
+        AK_Insert_New_Element(TYPE_VARCHAR, name, tblName, "name", rows[i]);
+        AK_Insert_New_Element(TYPE_FLOAT, &weight, tblName, "weight", rows[i]);
+    }
+
+    //the same rows loaded one by one, to compare the rates
+    t = clock();
+    for (i = 0; i < num_single; i++)
+        AK_insert_row(rows[i]);
+    single_time = (double) (clock() - t) / CLOCKS_PER_SEC;
+
+    t = clock();
+    if (AK_bulk_insert(tblName, rows + num_single, num_rows - num_single) == EXIT_SUCCESS)
+        ok++;
+    else
+        fail++;
+    bulk_time = (double) (clock() - t) / CLOCKS_PER_SEC;
+
+    printf("\nAK_insert_row: %d rows in %.3f s\n", num_single, single_time);
+    printf("AK_bulk_insert: %d rows in %.3f s\n", num_rows - num_single, bulk_time);
+    if (single_time > 0 && bulk_time > 0)
+        printf("Bulk loader is %.0f times faster per row\n",
+               (single_time / num_single) / (bulk_time / (num_rows - num_single)));
+    //a loose bound, a row of the bulk loader must not take longer than a row inserted alone
+    if (bulk_time / (num_rows - num_single) <= single_time / num_single)
+        ok++;
+    else
+        fail++;
+
+    num_records = AK_get_num_records(tblName);
+    printf("Table %s has %d rows, expected %d\n", tblName, num_records, num_rows);
+    if (num_records == num_rows)
+        ok++;
+    else
+        fail++;
+
+    el = AK_get_tuple(num_rows - 1, 0, tblName);
+    if (el != NULL && *((int *) el->data) == num_rows - 1)
+        ok++;
+    else
+        fail++;
+
+    //batch with a value of wrong type is rejected as a whole
+    AK_DeleteAll_L3(&rows[num_rows - 1]);
+    AK_Insert_New_Element(TYPE_VARCHAR, "not a number", tblName, "id", rows[num_rows - 1]);
+    if (AK_bulk_insert(tblName, rows + num_rows - 10, 10) == EXIT_ERROR && AK_get_num_records(tblName) == num_rows)
+        ok++;
+    else
+        fail++;
+
+    for (i = 0; i < num_rows; i++) {
+        AK_DeleteAll_L3(&rows[i]);
+        AK_free(rows[i]);
+    }
+    AK_free(rows);
+
+    fp = fopen(csvName, "w");
+    fprintf(fp, "id;name;weight\n");
+    fprintf(fp, "%d;\"Doe; John\";81.5\n", num_rows);
+    fprintf(fp, "%d;\"Says \"\"hi\"\"\";\n", num_rows + 1);
+    fprintf(fp, "%d;Ana;60.25\r\n", num_rows + 2);
+    fclose(fp);
+
+    if (AK_copy_from_csv(tblName, csvName, ';', 1) == EXIT_SUCCESS && AK_get_num_records(tblName) == num_rows + 3)
+        ok++;
+    else
+        fail++;
+
+    el = AK_get_tuple(num_rows, 1, tblName);
+    if (el != NULL && el->size == strlen("Doe; John") && memcmp(el->data, "Doe; John", el->size) == 0)
+        ok++;
+    else
+        fail++;
+
+    fp = fopen(csvName, "w");
+    fprintf(fp, "%d;Bad;abc\n", num_rows + 3);
+    fclose(fp);
+
+    if (AK_copy_from_csv(tblName, csvName, ';', 0) == EXIT_ERROR && AK_get_num_records(tblName) == num_rows + 3)
+        ok++;
+    else
+        fail++;
+    remove(csvName);
+
+    AK_EPI;
+    return TEST_result(ok, fail);
+}
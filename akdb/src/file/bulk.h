@@ -0,0 +1,181 @@
+/**
+@file bulk.h Header file that provides functions and defines for bulk loading of rows
+ */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#ifndef BULK
+#define BULK
+
+#include "../auxi/test.h"
+#include "../auxi/constants.h"
+#include "../auxi/configuration.h"
+#include "../mm/memoman.h"
+#include "../rec/redo_log.h"
+#include "../sql/cs/reference.h"
+#include "table.h"
+#include "files.h"
+#include "fileio.h"
+#include "pax.h"
+#include "idx/bitmap.h"
+#include "../auxi/mempro.h"
+#include <time.h>
+#include <errno.h>
+
+/**
+ * @author Karlo Vuković
+ * @struct AK_bulk_writer
+ * @brief Structure that holds the position where the next row is packed into the blocks of a table
+ */
+typedef struct {
+    /// name of the table
+    char *tblName;
+    /// addresses of the table extents
+    table_addresses *addresses;
+    /// current extent
+    int extent;
+    /// address of the block the next row is packed into
+    int address;
+    /// cached block the last row was packed into
+    AK_mem_block *mem_block;
+    /// MAX_FREE_SPACE_SIZE, read once
+    int max_free_space;
+    /// MAX_LAST_TUPLE_DICT_SIZE_TO_USE, read once
+    int max_tuple_dict;
+    /// number of rows written so far
+    int num_rows;
+} AK_bulk_writer;
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that checks a batch of rows before anything is written. Every value has to be a new value of an
+ *        existing attribute with the type from the table header. AK_reference is scanned once per batch, and
+ *        referential integrity is checked only if the table has foreign keys, with AK_reference_check_entries, which
+ *        looks up each distinct value of a foreign key once.
+ * @param tblName table name
+ * @param header table header
+ * @param num_attr number of attributes in the header
+ * @param rows array of rows, each one a list of elements
+ * @param num_rows number of rows in the array
+ * @return EXIT_SUCCESS if every row of the batch can be loaded, otherwise EXIT_ERROR
+ */
+int AK_bulk_check_rows(char *tblName, AK_header *header, int num_attr, struct list_node **rows, int num_rows);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that brings indexes and Bloom filters of the table up to date after a bulk load. Each index is
+ *        updated once for the whole load instead of once per row, with the rows collected in the batch.
+ * @param tblName table name
+ * @param batch rows written by the load
+ * @return No return value
+ */
+void AK_bulk_refresh_indexes(char *tblName, AK_index_batch *batch);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that loads a batch of rows into the table. The batch is validated as a whole, one redolog entry
+ *        is written for it and the rows are packed directly into consecutive blocks of the table, starting from
+ *        the first block with free space. When the table runs out of blocks new extents are allocated with
+ *        AK_init_new_extent. Rows of tables with PAX layout are packed into minipages with AK_pax_pack_row.
+ *        Rows written are collected and indexes are updated with them once at the end. Rows of tables with more
+ *        than MAX_ATTRIBUTES attributes are loaded through AK_insert_row. If the table runs out of room in the
+ *        middle of the batch, the rows already packed are taken out again, its redolog entry is removed and indexes
+ *        are left as they were, so only the new empty extents remain.
+ * @param tblName table name
+ * @param rows array of rows, each one a list of elements like the one given to AK_insert_row
+ * @param num_rows number of rows in the array
+ * @return EXIT_SUCCESS if all rows were loaded, EXIT_ERROR if the batch was rejected or could not be written
+ */
+int AK_bulk_insert(char *tblName, struct list_node **rows, int num_rows);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that prepares a writer that packs rows at the end of the table, starting from its first block
+ *        with free space
+ * @param writer writer to prepare
+ * @param tblName table name
+ * @return EXIT_SUCCESS, EXIT_ERROR if the table does not exist
+ */
+int AK_bulk_writer_open(AK_bulk_writer *writer, char *tblName);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that copies a row given by its entries and the bytes they point to into the table, like
+ *        AK_bulk_write_row. It is meant for rows that are kept outside of blocks.
+ * @param writer writer
+ * @param entries entries of the row
+ * @param data bytes the addresses of the entries point into
+ * @param num_attr number of attributes
+ * @return EXIT_SUCCESS if the row was written, otherwise EXIT_ERROR
+ */
+int AK_bulk_write_entries(AK_bulk_writer *writer, AK_tuple_dict *entries, char *data, int num_attr);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that copies a row from a block into the table. Entries are copied as they are, without checks
+ *        and without a redolog entry, so it is meant for rows that already belong to a table with the same header,
+ *        like rows that are sorted or moved to a temporary table. New extents are allocated when needed. Tables
+ *        with PAX layout are not supported.
+ * @param writer writer
+ * @param block block that holds the row
+ * @param tuple first entry of the row in the tuple dictionary of the block
+ * @param num_attr number of attributes
+ * @return EXIT_SUCCESS if the row was written, otherwise EXIT_ERROR
+ */
+int AK_bulk_write_row(AK_bulk_writer *writer, AK_block *block, int tuple, int num_attr);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that frees the memory held by the writer
+ * @param writer writer
+ * @return No return value
+ */
+void AK_bulk_writer_close(AK_bulk_writer *writer);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that splits one line of a CSV file into values. Values can be enclosed in double quotes, in
+ *        which case they can contain the delimiter and a double quote is written as two double quotes.
+ * @param line line without the line terminator
+ * @param delimiter character that separates values
+ * @param fields array the values are copied to
+ * @param quoted array of flags set for values that were enclosed in double quotes
+ * @param max_fields size of the fields and quoted arrays
+ * @return number of values in the line
+ */
+int AK_bulk_split_csv(char *line, char delimiter, char (*fields)[MAX_VARCHAR_LENGTH], int *quoted, int max_fields);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that loads the contents of a CSV file into the table, like COPY ... FROM in SQL. Each line holds
+ *        the values of one row in the order of the table header. Empty values that are not quoted are loaded as
+ *        null. Rows are loaded with AK_bulk_insert in batches of BULK_BATCH_SIZE rows.
+ * @param tblName table name
+ * @param fileName path to the CSV file
+ * @param delimiter character that separates values
+ * @param has_header 1 if the first line holds attribute names and should be skipped, otherwise 0
+ * @return EXIT_SUCCESS if the whole file was loaded, otherwise EXIT_ERROR
+ */
+int AK_copy_from_csv(char *tblName, char *fileName, char delimiter, int has_header);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function for testing the bulk loader
+ * @return TestResult
+ */
+TestResult AK_bulk_test();
+
+#endif
@@ -17,6 +17,10 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
  17 */
 #include "fileio.h"
+#include "idx/bloom.h"
+#include "idx/index.h"
+#include "idx/btree.h"
+#include "../sql/cs/unique.h"
 
 //START SPECIAL FUNCTIONS FOR WORK WITH row_element_structure
 
@@ -97,80 +101,149 @@ void AK_Insert_New_Element(int newtype, void *data, char *table, char *attribute
 
 //END SPECIAL FUNCTIONS row_element_structure
 
-/** @author Matija Novak, updated by Dino Laktašić
+/**
+ * @author Karlo Vuković
+ * @brief Function that returns the header describing rows of the block. Blocks of tables with more than
+ *        MAX_ATTRIBUTES attributes hold only a part of the header, so for them the header of the whole table is
+ *        fetched and terminated with an empty attribute.
+ * @param temp_block block
+ * @param table name of the table the block belongs to
+ * @return header of the rows, it has to be freed with AK_free if it is not the header of the block
+ */
+AK_header *AK_get_row_header(AK_block *temp_block, char *table)
+{
+    AK_header *header, *table_header;
+    int num_attr;
+    AK_PRO;
+
+    if (temp_block->type != BLOCK_TYPE_WIDE)
+    {
+        AK_EPI;
+        return temp_block->header;
+    }
+
+    num_attr = AK_num_attr(table);
+    table_header = AK_get_header(table);
+    header = (AK_header *)AK_calloc(num_attr + 1, sizeof(AK_header));
+    memcpy(header, table_header, sizeof(AK_header) * num_attr);
+    AK_free(table_header);
+    AK_EPI;
+    return header;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that finds the new value of the attribute in the row and copies it to entry_data. If the row has
+ *        no value for the attribute, "null" is copied.
+ * @param row_root list of elements of the row
+ * @param att_name attribute name
+ * @param entry_data buffer of MAX_VARCHAR_LENGTH characters the value is copied to
+ * @param type type of the value
+ * @return size of the value
+ */
+static int AK_get_row_value(struct list_node *row_root, char *att_name, char *entry_data, int *type)
+{
+    struct list_node *some_element = (struct list_node *)AK_First_L2(row_root);
+
+    memset(entry_data, '\0', MAX_VARCHAR_LENGTH);
+    while (some_element != 0)
+    { //found correct element
+        if ((strcmp(some_element->attribute_name, att_name) == 0) && (some_element->constraint == 0))
+        {
+            *type = some_element->type;
+            memcpy(entry_data, some_element->data, AK_type_size(*type, some_element->data));
+            return AK_type_size(*type, entry_data);
+        }
+        some_element = (struct list_node *)AK_Next_L2(some_element);
+    }
+    //no data exist for this header write null
+    memcpy(entry_data, "null", strlen("null"));
+    *type = TYPE_VARCHAR;
+    return AK_type_size(*type, entry_data);
+}
+
+/** @author Matija Novak, updated by Dino Laktašić, updated by Karlo Vuković (wide blocks)
         @brief Function inserts one row into some block.  Firstly it checks wether block contain attributes from the list. Then
-               data, type, size and last_tuple_id are put in temp_block.
+               data, type, size and last_tuple_id are put in temp_block. Rows of PAX blocks are written by AK_pax_insert_row_to_block.
+               Blocks of wide tables hold whole rows, so the row is written only if all of its values fit into the block.
+               Otherwise the block is marked as full and EXIT_ERROR is returned.
         @param row_root list of elements to insert
         @param temp_block block in which we insert data
         @return EXIT SUCCES if success
  */
 int AK_insert_row_to_block(struct list_node *row_root, AK_block *temp_block)
 {
-    struct list_node *some_element;
+    AK_header *header;
     int type;        //type od entry data
+    int size;        //size of entry data
     int id = 0;      //id tuple dict in which is inserted next data
     int head = 0;    //index of header which is curently inserted
-    int search_elem; //serch for tuple dict id and searc for data in list
     char entry_data[MAX_VARCHAR_LENGTH];
     AK_PRO;
 
-    while (strcmp(temp_block->header[head].att_name, "\0") != 0)
+    if (temp_block->type == BLOCK_TYPE_PAX)
+    { //values of PAX blocks go into minipages of their attributes
+        AK_EPI;
+        return AK_pax_insert_row_to_block(row_root, temp_block);
+    }
+
+    header = AK_get_row_header(temp_block, ((struct list_node *)AK_First_L2(row_root))->table);
+    if (temp_block->type == BLOCK_TYPE_WIDE)
+    { //checks if the whole row fits into the block
+        while (id < DATA_BLOCK_SIZE && temp_block->tuple_dict[id].size != FREE_INT)
+            id++;
+        size = 0;
+        for (head = 0; strcmp(header[head].att_name, "\0") != 0; head++)
+            size += AK_get_row_value(row_root, header[head].att_name, entry_data, &type);
+
+        if (id + head > DATA_BLOCK_SIZE || temp_block->AK_free_space + size > DATA_BLOCK_SIZE * DATA_ENTRY_SIZE)
+        {
+            if (temp_block->last_tuple_dict_id > 0 && temp_block->AK_free_space < MAX_FREE_SPACE_SIZE)
+                temp_block->AK_free_space = MAX_FREE_SPACE_SIZE;
+            AK_free(header);
+            AK_EPI;
+            return EXIT_ERROR;
+        }
+        id = 0;
+        head = 0;
+    }
+
+    while (strcmp(header[head].att_name, "\0") != 0)
     { //inserting values of the list one by one
         while (temp_block->tuple_dict[id].size != FREE_INT)
         { //searches for AK_free tuple dict, maybe it can be last_tuple_dict_id
             id++;
         }
-        //printf("insert_row_to_block: Position to write (tuple_dict_index) %d, header_att_name %s\n", id, temp_block->header[head].att_name);
+        //printf("insert_row_to_block: Position to write (tuple_dict_index) %d, header_att_name %s\n", id, header[head].att_name);
 
-        AK_dbg_messg(HIGH, FILE_MAN, "insert_row_to_block: Position to write (tuple_dict_index) %d, header_att_name %s\n", id, temp_block->header[head].att_name);
-
-        search_elem = 1;
-        some_element = (struct list_node *)AK_First_L2(row_root);
-        while (search_elem)
-        {
-            if ((strcmp(some_element->attribute_name, temp_block->header[head].att_name) == 0) && (some_element->constraint == 0))
-            { //found correct element
-                type = some_element->type;
+        AK_dbg_messg(HIGH, FILE_MAN, "insert_row_to_block: Position to write (tuple_dict_index) %d, header_att_name %s\n", id, header[head].att_name);
 
-                memset(entry_data, '\0', MAX_VARCHAR_LENGTH);
-                memcpy(entry_data, some_element->data, AK_type_size(type, some_element->data));
+        size = AK_get_row_value(row_root, header[head].att_name, entry_data, &type);
 
-                search_elem = 0;
-            }
-            else
-            {
-                some_element = (struct list_node *)AK_Next_L2(some_element);
-                if (some_element == 0)
-                { //no data exist for this header write null
-                    some_element = 1;
-                    memcpy(entry_data, "null", strlen("null"));
-                    type = TYPE_VARCHAR;
-                    search_elem = 0;
-                }
-            }
-        }
-
-        memcpy(temp_block->data + temp_block->AK_free_space, entry_data, (int)AK_type_size(type, entry_data));
+        memcpy(temp_block->data + temp_block->AK_free_space, entry_data, size);
         temp_block->tuple_dict[id].address = temp_block->AK_free_space;
-        temp_block->AK_free_space += AK_type_size(type, entry_data);
+        temp_block->AK_free_space += size;
         temp_block->tuple_dict[id].type = type;
-        temp_block->tuple_dict[id].size = AK_type_size(type, entry_data);
+        temp_block->tuple_dict[id].size = size;
 
-        memcpy(entry_data, temp_block->data + temp_block->tuple_dict[id].address, temp_block->tuple_dict[id].size);
-
-        AK_dbg_messg(HIGH, FILE_MAN, "insert_row_to_block: Insert: data: %s, size: %d\n", entry_data, AK_type_size(type, entry_data));
+        AK_dbg_messg(HIGH, FILE_MAN, "insert_row_to_block: Insert: data: %s, size: %d\n", entry_data, size);
         head++; //go to next header
     }
     //writes the last used tuple dict id
 
     temp_block->last_tuple_dict_id = id;
+    if (header != temp_block->header)
+        AK_free(header);
     AK_EPI;
     return EXIT_SUCCESS;
 }
 
-/** @author Matija Novak, updated by Matija Šestak (function now uses caching), updated by Dejan Frankovic (added reference check), updated by Dino         Laktašić (removed variable AK_free, variable table initialized using memset), updated by Josip Šušnjara (chained blocks support)
-        @brief Function inserts a one row into table. Firstly it is checked whether inserted row would violite reference integrity.
+/** @author Matija Novak, updated by Matija Šestak (function now uses caching), updated by Dejan Frankovic (added reference check), updated by Dino         Laktašić (removed variable AK_free, variable table initialized using memset), updated by Josip Šušnjara (chained blocks support), updated by Karlo Vuković (wide blocks, Bloom filters, indices, overflow pages, UNIQUE constraints)
+        @brief Function inserts a one row into table. Firstly it is checked whether inserted row would violite reference integrity
+        or a UNIQUE constraint of the table.
         Then it is checked in which table should row be inserted. If there is no AK_free space for new table, new extent is allocated. New block is            allocated on given address. Row is inserted in this block and dirty flag is set to BLOCK_DIRTY.
+        Long values of rows of wide tables are moved to overflow pages by AK_overflow_store_row before the block is fetched.
+        Values of the row are added to Bloom filters of the extent that got the row and the row is added to indices of the table.
         @param row_root list of elements which contain data of one row
         @return EXIT_SUCCESS if success else EXIT_ERROR
 
@@ -190,6 +263,13 @@ int AK_insert_row(struct list_node *row_root)
         return EXIT_ERROR;
     }
 
+    if (AK_unique_check_entry(row_root) == EXIT_ERROR)
+    {
+        printf("Could not insert row. UNIQUE constraint violation.\n");
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+
     AK_dbg_messg(HIGH, FILE_MAN, "insert_row: Start inserting data\n");
     struct list_node *some_element = (struct list_node *)AK_First_L2(row_root);
     char table[MAX_ATT_NAME];
@@ -199,8 +279,15 @@ int AK_insert_row(struct list_node *row_root)
     memcpy(&table, some_element->table, strlen(some_element->table));
     AK_dbg_messg(HIGH, FILE_MAN, "insert_row: Insert into table: %s\n", table);
     int adr_to_write;
+    int block_type = BLOCK_TYPE_NORMAL;
     table_addresses_return = AK_get_table_addresses(table);
-    adr_to_write = (int)AK_find_AK_free_space(table_addresses_return);
+    if (table_addresses_return->address_from[0] != 0)
+        block_type = ((AK_mem_block *)AK_get_block(table_addresses_return->address_from[0]))->block->type;
+    //blocks of tables with PAX layout or many attributes are searched only in extents of the table
+    if (block_type == BLOCK_TYPE_PAX || block_type == BLOCK_TYPE_WIDE)
+        adr_to_write = AK_find_table_free_block(table);
+    else
+        adr_to_write = (int)AK_find_AK_free_space(table_addresses_return);
     AK_free(table_addresses_return);
 
     if (adr_to_write == -1)
@@ -218,37 +305,103 @@ int AK_insert_row(struct list_node *row_root)
         return EXIT_ERROR;
     }
 
-    table_addresses *addresses = (table_addresses *)AK_get_table_addresses(table);
-    
-    /*for(int i = 0; i < blocks_per_row; i++){
-    	AK_dbg_messg(HIGH, FILE_MAN, "insert_row: Insert into block on adress: %d\n", adr_to_write);
-    	AK_mem_block *mem_block = (AK_mem_block *)AK_get_block(adr_to_write);
-    	int end = (int)AK_insert_row_to_block(row_root, mem_block->block);
-    }*/
+    //long values go to overflow pages first, so writing them can not evict the block that gets the row
+    struct list_node *stored_row = row_root;
+    if (block_type == BLOCK_TYPE_WIDE)
+    {
+        stored_row = (struct list_node *)AK_malloc(sizeof(struct list_node));
+        AK_Init_L3(&stored_row);
+        if (AK_overflow_store_row(row_root, stored_row) == EXIT_ERROR)
+        {
+            AK_DeleteAll_L3(&stored_row);
+            AK_free(stored_row);
+            AK_EPI;
+            return EXIT_ERROR;
+        }
+    }
+
     AK_dbg_messg(HIGH, FILE_MAN, "insert_row: Insert into block on adress: %d\n", adr_to_write);
-    
-    int end;
-    AK_mem_block *mem_block;
-    int l = 0;
-    do{
-    	mem_block = (AK_mem_block *)AK_get_block(adr_to_write);
-    	end = (int)AK_insert_row_to_block(row_root, mem_block->block);
-    	AK_mem_block_modify(mem_block, BLOCK_DIRTY);
-    	adr_to_write = mem_block->block->chained_with;
+
+    //indices are found before the block is fetched, so finding them can not evict it
+    AK_index_batch batch;
+    AK_index_batch_begin(&batch, table);
+    AK_mem_block *mem_block = (AK_mem_block *)AK_get_block(adr_to_write);
+    int end = (int)AK_insert_row_to_block(stored_row, mem_block->block);
+    AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+    if (end == EXIT_SUCCESS)
+        AK_index_batch_add(&batch, mem_block->block, adr_to_write, mem_block->block->last_tuple_dict_id + 1 - batch.num_attr, 1);
+
+    while (end == EXIT_ERROR && (mem_block->block->type == BLOCK_TYPE_PAX || mem_block->block->type == BLOCK_TYPE_WIDE) && mem_block->block->AK_free_space >= MAX_FREE_SPACE_SIZE)
+    { //block ran out of room for this row, so it goes to the next block with free space, tables with these layouts have no indices
+        adr_to_write = AK_find_table_free_block(table);
+        if (adr_to_write == EXIT_ERROR)
+            break;
+        mem_block = (AK_mem_block *)AK_get_block(adr_to_write);
+        end = (int)AK_insert_row_to_block(stored_row, mem_block->block);
+        AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+    }
+
+    if (stored_row != row_root)
+    {
+        if (end != EXIT_SUCCESS)
+            AK_overflow_discard_row(row_root, stored_row);
+        AK_DeleteAll_L3(&stored_row);
+        AK_free(stored_row);
     }
-    while(mem_block->block->chained_with != NOT_CHAINED);
 
     if (end == EXIT_SUCCESS)
+    {
         AK_redolog_commit();
-        
+        AK_bloom_filter_add_row(row_root, adr_to_write);
+    }
+    AK_index_batch_apply(&batch);
 
     AK_EPI;
     return end;
 }
 
 /**
-   * @author Matija Novak, updated by Dino Laktašić, updated by Mario Peroković - separated from deletion, updated by Antun Tkalčec (fixed SIGSEGV)
+ * @author Karlo Vuković
+ * @brief Function that finds the first block of the table with free space. Unlike AK_find_AK_free_space it only
+ *        looks at extents of the table, and when they are full it allocates a new extent that is registered in
+ *        AK_relation, so the new extent gets the header and the layout of the table.
+ * @param tblName table name
+ * @return address of the block, EXIT_ERROR if there is no room for the table
+ */
+int AK_find_table_free_block(char *tblName)
+{
+    table_addresses *addresses;
+    AK_mem_block *mem_block;
+    int i, j, max_free_space, max_tuple_dict;
+    AK_PRO;
+
+    max_free_space = MAX_FREE_SPACE_SIZE;
+    max_tuple_dict = MAX_LAST_TUPLE_DICT_SIZE_TO_USE;
+    addresses = AK_get_table_addresses(tblName);
+    for (i = 0; i < MAX_EXTENTS_IN_SEGMENT && addresses->address_from[i] != 0; i++)
+    {
+        for (j = addresses->address_from[i]; j < addresses->address_to[i]; j++)
+        {
+            mem_block = AK_get_block(j);
+            if (mem_block->block->AK_free_space < max_free_space && mem_block->block->last_tuple_dict_id < max_tuple_dict)
+            {
+                AK_free(addresses);
+                AK_EPI;
+                return j;
+            }
+        }
+    }
+    AK_free(addresses);
+
+    j = AK_init_new_extent(tblName, SEGMENT_TYPE_TABLE);
+    AK_EPI;
+    return j > 0 ? j : EXIT_ERROR;
+}
+
+/**
+   * @author Matija Novak, updated by Dino Laktašić, updated by Mario Peroković - separated from deletion, updated by Antun Tkalčec (fixed SIGSEGV), updated by Karlo Vuković (wide blocks, list head is not an element, overflow values)
    * @brief Function updates row from table in given block if the data in the table is equal to data in attribute used for search. 
+            A value stored in overflow pages is always updated by inserting the row again.
    * @param temp_block block to work with
    * @param row_list list of elements which contain data for delete or update
    * @return Returns an "EXIT_SUCCESS"
@@ -261,12 +414,13 @@ int AK_update_row_from_block(AK_block *temp_block, struct list_node *row_root)
     int exists_equal_attrib = 0;         //if we found at least one header in the list
     char entry_data[MAX_VARCHAR_LENGTH]; //entry data when haeader is found in list which is copied to compare with data in block
     AK_PRO;
+    AK_header *header = AK_get_row_header(temp_block, ((struct list_node *)AK_First_L2(row_root))->table);
     struct list_node *new_data = (struct list_node *)AK_malloc(sizeof(struct list_node));
     AK_Init_L3(&new_data);
 
     struct list_node *some_element = (struct list_node *)AK_First_L2(row_root);
 
-    int i, overflow, address, size;
+    int i, overflow, address, size, type;
 
     for (i = 0; i < DATA_BLOCK_SIZE; i++)
     {
@@ -277,21 +431,20 @@ int AK_update_row_from_block(AK_block *temp_block, struct list_node *row_root)
         size = temp_block->tuple_dict[i].size;
         overflow = address + size;
 
-        while (strcmp(temp_block->header[head].att_name, "\0") != 0)
+        while (strcmp(header[head].att_name, "\0") != 0)
         { //going through headers
 
-            some_element = row_root;
+            some_element = row_root->next;
             while (some_element)
             {
-                if ((strcmp(some_element->attribute_name, temp_block->header[head].att_name) == 0) && (some_element->constraint == SEARCH_CONSTRAINT))
+                if ((strcmp(some_element->attribute_name, header[head].att_name) == 0) && (some_element->constraint == SEARCH_CONSTRAINT))
                 {
                     exists_equal_attrib = 1;
                     attPlace = head;
 
                     if (overflow < (temp_block->AK_free_space + 1) && overflow > -1)
                     {
-                        memset(entry_data, '\0', MAX_VARCHAR_LENGTH);
-                        memcpy(entry_data, temp_block->data + address, size);
+                        AK_overflow_entry_value(temp_block, i, entry_data, &type);
 
                         // if the data in table isn't equal to data in attribute which is used for search, it won't be updated
                         if (strcmp(entry_data, some_element->data) != 0)
@@ -313,20 +466,22 @@ int AK_update_row_from_block(AK_block *temp_block, struct list_node *row_root)
                 AK_DeleteAll_L3(&new_data);
                 int a = temp_block->tuple_dict[j].address;
                 int s = temp_block->tuple_dict[j].size;
+                //new values are given as varchars, the old value of an overflow entry is only its address
+                type = temp_block->tuple_dict[j].type == TYPE_OVERFLOW ? TYPE_VARCHAR : temp_block->tuple_dict[j].type;
                 if (a > 0 && s > 0)
                 {
                     memset(entry_data, '\0', MAX_VARCHAR_LENGTH);
                     memcpy(entry_data, temp_block->data + a, s);
                 }
-                some_element = row_root;
+                some_element = row_root->next;
                 while (some_element)
                 {
                     // save data from roow_root in a list new_data where whole row is being inserted
-                    AK_Insert_New_Element(temp_block->tuple_dict[j].type, some_element->data, some_element->table, some_element->attribute_name, new_data);
-                    if (strcmp(some_element->attribute_name, temp_block->header[j % head].att_name) == 0 && some_element->constraint == NEW_VALUE)
+                    AK_Insert_New_Element(type, some_element->data, some_element->table, some_element->attribute_name, new_data);
+                    if (strcmp(some_element->attribute_name, header[j % head].att_name) == 0 && some_element->constraint == NEW_VALUE)
                     {
-                        // we need to delete and insert row, because size of new data is larger than size of old data
-                        if (strlen(some_element->data) > s)
+                        // we need to delete and insert row, because size of new data is larger than size of old data or old data is in overflow pages
+                        if (strlen(some_element->data) > s || temp_block->tuple_dict[j].type == TYPE_OVERFLOW)
                         {
                             for (int k = i - attPlace; k < i + head - attPlace; k++)
                             {
@@ -335,10 +490,13 @@ int AK_update_row_from_block(AK_block *temp_block, struct list_node *row_root)
                                 memset(entry_data, '\0', MAX_VARCHAR_LENGTH);
                                 memcpy(entry_data, temp_block->data + o, p);
                                 // if att_names are different, this is old data, and we need to insert it again
-                                if (strcmp(some_element->attribute_name, temp_block->header[k % head].att_name) != 0)
-                                    AK_Insert_New_Element(temp_block->tuple_dict[k].type, entry_data, some_element->table, temp_block->header[k % head].att_name, new_data);
+                                if (strcmp(some_element->attribute_name, header[k % head].att_name) != 0)
+                                    AK_Insert_New_Element(temp_block->tuple_dict[k].type, entry_data, some_element->table, header[k % head].att_name, new_data);
 
                                 temp_block->tuple_dict[k].size = 0;
+                                //overflow pages of the old value are freed by the vacuum, other values keep theirs in the new row
+                                if (temp_block->tuple_dict[k].type == TYPE_OVERFLOW && strcmp(some_element->attribute_name, header[k % head].att_name) == 0)
+                                    continue;
                                 temp_block->tuple_dict[k].type = 0;
                                 temp_block->tuple_dict[k].address = 0;
                             }
@@ -367,13 +525,18 @@ int AK_update_row_from_block(AK_block *temp_block, struct list_node *row_root)
     // everything from new data has been copied so we can deallocate all in list - corr. Elvis Popovic
     AK_DeleteAll_L3(&new_data);
     AK_free(new_data);
+    if (header != temp_block->header)
+        AK_free(header);
     AK_EPI;
     return EXIT_SUCCESS;
 }
 
 /**
-   * @author Matija Novak, updated by Dino Laktašić, changed by Davorin Vukelic, updated by Mario Peroković
-   * @brief Function deletes row from table in given block. Given list of elements is firstly back-upped.
+   * @author Matija Novak, updated by Dino Laktašić, changed by Davorin Vukelic, updated by Mario Peroković, updated by Karlo Vuković (wide blocks, tombstones, matching by attribute, list head is not an element, overflow values)
+   * @brief Function deletes row from table in given block. Given list of elements is firstly back-upped. Entries of the row in
+            the tuple dictionary become tombstones with size 0, and the space is reclaimed later by AK_vacuum_table.
+            Values stored in overflow pages are compared by their whole value, and their tombstones keep the type and the
+            address, so the vacuum can free the pages.
    * @param temp_block block to work with
    * @param row_list list of elements which contain data for delete or update
    * @return No return value
@@ -381,11 +544,11 @@ int AK_update_row_from_block(AK_block *temp_block, struct list_node *row_root)
 void AK_delete_row_from_block(AK_block *temp_block, struct list_node *row_root)
 {
     int head = 0;                        //counting headers
-    int attPlace = 0;                    //place of attribute which are same
     int del = 1;                         //if can delete gorup of tuple dicts which are in the same row of table
     int exists_equal_attrib = 0;         //if we found at least one header in the list
     char entry_data[MAX_VARCHAR_LENGTH]; //entry data when haeader is found in list which is copied to compare with data in block
     AK_PRO;
+    AK_header *header = AK_get_row_header(temp_block, ((struct list_node *)AK_First_L2(row_root))->table);
     struct list_node *row_root_backup = (struct list_node *)AK_malloc(sizeof(struct list_node));
     AK_Init_L3(&row_root_backup);
 
@@ -398,34 +561,34 @@ void AK_delete_row_from_block(AK_block *temp_block, struct list_node *row_root)
         some_element = some_element->next;
     }
 
-    int i, overflow, address, size;
+    int i, overflow, address, size, type, num_attr = 0;
 
-    for (i = 0; i < DATA_BLOCK_SIZE; i++)
+    while (strcmp(header[num_attr].att_name, "\0") != 0)
+        num_attr++;
+
+    //rows start at every num_attr-th entry, so values are only compared with entries of their own attribute
+    for (i = 0; num_attr > 0 && i + num_attr <= DATA_BLOCK_SIZE; i += num_attr)
     { //AK_freeze point, if there is no i++
         head = 0;
-        attPlace = 0;
-        address = temp_block->tuple_dict[i].address;
-        size = temp_block->tuple_dict[i].size;
-        overflow = address + size;
 
-        while (strcmp(temp_block->header[head].att_name, "\0") != 0)
+        while (strcmp(header[head].att_name, "\0") != 0)
         { //going through headers
-            some_element = row_root;
+            address = temp_block->tuple_dict[i + head].address;
+            size = temp_block->tuple_dict[i + head].size;
+            overflow = address + size;
+            some_element = row_root->next;
 
             while (some_element)
             {
                 //if we found header that is constraint in list
-                if ((strcmp(some_element->attribute_name, temp_block->header[head].att_name) == 0) && (some_element->constraint == SEARCH_CONSTRAINT))
+                if ((strcmp(some_element->attribute_name, header[head].att_name) == 0) && (some_element->constraint == SEARCH_CONSTRAINT))
                 {
 
                     exists_equal_attrib = 1;
-                    attPlace = head;
 
                     if ((overflow < (temp_block->AK_free_space + 1)) && (overflow > -1))
                     {
-                        //before there was for loop to clear (check if memset works correct)
-                        memset(entry_data, '\0', MAX_VARCHAR_LENGTH);
-                        memcpy(entry_data, temp_block->data + address, size);
+                        AK_overflow_entry_value(temp_block, i + head, entry_data, &type);
 
                         if (strcmp(entry_data, some_element->data) != 0)
                             del = 0; //if one constraint doesn't metch we dont delete or update
@@ -440,31 +603,109 @@ void AK_delete_row_from_block(AK_block *temp_block, struct list_node *row_root)
 
         if ((exists_equal_attrib == 1) && (del == 1))
         {
-            for (int j = i - attPlace; j < i + head - attPlace; j++)
+            for (int j = i; j < i + head; j++)
             { //delete one row
 
                 int k = temp_block->tuple_dict[j].address;
                 int l = temp_block->tuple_dict[j].size;
-                memset(temp_block->data + k, '\0', l);
-                AK_dbg_messg(HIGH, FILE_MAN, "update_delete_row_from_block: from: %d, to: %d\n", k, l + k);
+                AK_dbg_messg(HIGH, FILE_MAN, "update_delete_row_from_block: tombstone from: %d, to: %d\n", k, l + k);
 
-                //clean tuple dict
+                //tombstone, data stays in the block until the vacuum compacts it and frees overflow pages of its values
                 temp_block->tuple_dict[j].size = 0;
-                temp_block->tuple_dict[j].type = 0;
-                temp_block->tuple_dict[j].address = 0;
+                if (temp_block->tuple_dict[j].type != TYPE_OVERFLOW)
+                    temp_block->tuple_dict[j].type = 0;
             }
         }
         del = 1;
         exists_equal_attrib = 0;
     }
     AK_free(row_root_backup);
+    if (header != temp_block->header)
+        AK_free(header);
     AK_EPI;
 }
 
 /**
-      * @author Matija Novak, updated by Matija Šestak (function now uses caching)
+ * @author Karlo Vuković
+ * @brief Function that compares two addresses of blocks
+ * @param left first address
+ * @param right second address
+ * @return negative number if the first address is smaller, 0 if they are equal, otherwise positive number
+ */
+static int AK_compare_addresses(const void *left, const void *right)
+{
+    int a = *(const int *)left, b = *(const int *)right;
+
+    return a < b ? -1 : a > b;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that finds the blocks with rows an update or a delete is looking for in a B+tree index on the
+ *        attributes of its search constraints, so the other blocks of the table are not read. A cascading update or
+ *        delete of a reference finds child rows this way.
+ * @param table name of the table
+ * @param row_root elements of one row
+ * @param addresses extents of the table
+ * @param blocks array for the addresses of the blocks, sorted and without repetitions, it has to be freed with AK_free
+ * @return number of blocks, EXIT_ERROR if the table has no such index and all of its blocks have to be searched
+ */
+static int AK_delete_update_blocks(char *table, struct list_node *row_root, table_addresses *addresses, int **blocks)
+{
+    struct list_node *el, *values;
+    AK_btree_rid *rids;
+    int positions[BTREE_MAX_KEYS];
+    int i, num_values = 0, num_rids = EXIT_ERROR, num_blocks = 0;
+
+    *blocks = NULL;
+    //rows of other kinds of blocks do not start in the block the index points to
+    if (addresses->address_from[0] == 0 ||
+        ((AK_mem_block *)AK_get_block(addresses->address_from[0]))->block->type != BLOCK_TYPE_NORMAL)
+        return EXIT_ERROR;
+    values = (struct list_node *)AK_malloc(sizeof(struct list_node));
+    AK_Init_L3(&values);
+    for (el = row_root->next; el != NULL && num_values >= 0; el = el->next)
+    {
+        if (el->constraint != SEARCH_CONSTRAINT)
+            continue;
+        positions[num_values < BTREE_MAX_KEYS ? num_values : 0] = AK_get_attr_index(table, el->attribute_name);
+        if (num_values == BTREE_MAX_KEYS || positions[num_values] < 0)
+            num_values = -1;
+        else
+        {
+            AK_InsertAtEnd_L3(el->type, el->data, AK_type_size(el->type, el->data), values);
+            num_values++;
+        }
+    }
+    if (num_values > 0)
+        num_rids = AK_btree_lookup(table, positions, values, num_values, NULL, 0);
+    if (num_rids > 0)
+    {
+        rids = (AK_btree_rid *)AK_malloc(num_rids * sizeof(AK_btree_rid));
+        *blocks = (int *)AK_malloc(num_rids * sizeof(int));
+        num_rids = AK_btree_lookup(table, positions, values, num_values, rids, num_rids);
+        for (i = 0; i < num_rids; i++)
+            (*blocks)[i] = rids[i].block;
+        qsort(*blocks, num_rids, sizeof(int), AK_compare_addresses);
+        for (i = 0; i < num_rids; i++)
+        {
+            if (num_blocks == 0 || (*blocks)[num_blocks - 1] != (*blocks)[i])
+                (*blocks)[num_blocks++] = (*blocks)[i];
+        }
+        AK_free(rids);
+    }
+    AK_DeleteAll_L3(&values);
+    AK_free(values);
+    return num_rids == EXIT_ERROR ? EXIT_ERROR : num_blocks;
+}
+
+/**
+      * @author Matija Novak, updated by Matija Šestak (function now uses caching), updated by Karlo Vuković (vacuum queue, Bloom filters, indices, blocks found by an index)
       * @brief Function updates or deletes the whole segment of an table. Addresses for given table atr fetched. For each block
-        in extent row is updated or deleted according to operator del.
+        in extent row is updated or deleted according to operator del. The table is then put into the vacuum queue.
+        If a B+tree index of the table has the attributes of the search constraints, only blocks with rows it finds are read.
+        New values of an update are added to Bloom filters of all extents of the table. Rows that were deleted or changed
+        are collected from every block and indices of the table are updated with all of them at the end.
       * @param row_root elements of one row
       * @param del - DELETE or UPDATE
       * @return EXIT_SUCCESS if success
@@ -479,7 +720,14 @@ int AK_delete_update_segment(struct list_node *row_root, int del)
     table[strlen(some_element->table)] = '\0';
     AK_dbg_messg(HIGH, FILE_MAN, "delete_update_segment: table to delete_update from: %s, source %s\n", table, some_element->table);
 
+    AK_index_batch batch;
+    AK_block *before = NULL;
+    if (AK_index_batch_begin(&batch, table) > 0)
+        before = (AK_block *)AK_malloc(sizeof(AK_block));
+
     table_addresses *addresses = (table_addresses *)AK_get_table_addresses(table);
+    int *blocks;
+    int num_blocks = AK_delete_update_blocks(table, row_root, addresses, &blocks);
 
     AK_mem_block *mem_block;
     int startAddress, j, i;
@@ -491,22 +739,40 @@ int AK_delete_update_segment(struct list_node *row_root, int del)
         {
             AK_dbg_messg(HIGH, FILE_MAN, "delete_update_segment: delete_update extent: %d\n", j);
 
-            for (i = startAddress; i <= addresses->address_to[j]; i++)
+            for (i = startAddress; i < addresses->address_to[j]; i++)
             { //going through blocks
+                //blocks without rows the index found are not read
+                if (num_blocks != EXIT_ERROR &&
+                    (num_blocks == 0 || bsearch(&i, blocks, num_blocks, sizeof(int), AK_compare_addresses) == NULL))
+                    continue;
                 AK_dbg_messg(HIGH, FILE_MAN, "delete_update_segment: delete_update block: %d\n", i);
                 mem_block = (AK_mem_block *)AK_get_block(i);
+                if (before != NULL)
+                    memcpy(before, mem_block->block, sizeof(AK_block));
 
                 if (del == DELETE)
                     AK_delete_row_from_block(mem_block->block, row_root);
                 else
                     AK_update_row_from_block(mem_block->block, row_root);
                 AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+                //an update that moves a row inserts it elsewhere, which can evict the block
+                if (before != NULL)
+                    AK_index_batch_add_changes(&batch, before, ((AK_mem_block *)AK_get_block(i))->block);
             }
         }
         else
             break;
     }
     AK_free(addresses);
+    if (blocks != NULL)
+        AK_free(blocks);
+    if (before != NULL)
+        AK_free(before);
+    AK_index_batch_apply(&batch);
+    if (del == UPDATE)
+        AK_bloom_filter_add_row(row_root, -1);
+    //deleted rows and rows moved by the update are left as tombstones
+    AK_vacuum_request(table);
     AK_EPI;
     return EXIT_SUCCESS;
 }
@@ -565,8 +831,8 @@ void AK_delete_row_by_id(int id, char *tableName)
     AK_EPI;
 }
 
-/** @author Matija Novak, Dejan Frankovic (added referential integrity)
-        @brief Function updates rows of some table
+/** @author Matija Novak, Dejan Frankovic (added referential integrity), updated by Karlo Vuković (UNIQUE constraints)
+        @brief Function updates rows of some table. New values are checked against UNIQUE constraints of the table first.
         @param row_root elements of one row
         @return EXIT_SUCCESS if success
 */
@@ -580,6 +846,13 @@ int AK_update_row(struct list_node *row_root)
         return EXIT_ERROR;
     }
 
+    if (AK_unique_check_entry(row_root) == EXIT_ERROR)
+    {
+        printf("Could not update row. UNIQUE constraint violation.\n");
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+
     // recovery checkpoint
 
     if (AK_reference_check_if_update_needed(row_root, UPDATE) == EXIT_SUCCESS)
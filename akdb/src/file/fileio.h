@@ -27,6 +27,10 @@
 #include "../rec/archive_log.h"
 #include "../rec/redo_log.h"
 #include "files.h"
+#include "table.h"
+#include "pax.h"
+#include "vacuum.h"
+#include "overflow.h"
 #include "../auxi/mempro.h"
 
 /**
@@ -59,15 +63,37 @@ void AK_Insert_New_Element_For_Update(int newtype, void * data, char * table, ch
  */
 void AK_Insert_New_Element(int newtype, void * data, char * table, char * attribute_name, struct list_node * ElementBefore);
 
-/** @author Matija Novak, updated by Dino Laktašić
+/**
+ * @author Karlo Vuković
+ * @brief Function that returns the header describing rows of the block. Blocks of tables with more than
+ *        MAX_ATTRIBUTES attributes hold only a part of the header, so for them the header of the whole table is
+ *        fetched and terminated with an empty attribute.
+ * @param temp_block block
+ * @param table name of the table the block belongs to
+ * @return header of the rows, it has to be freed with AK_free if it is not the header of the block
+ */
+AK_header *AK_get_row_header(AK_block *temp_block, char *table);
+
+/** @author Matija Novak, updated by Dino Laktašić, updated by Karlo Vuković (wide blocks)
         @brief Function inserts one row into some block.  Firstly it checks wether block contain attributes from the list. Then
-               data, type, size and last_tuple_id are put in temp_block.
+               data, type, size and last_tuple_id are put in temp_block. Blocks of wide tables hold whole rows, so the
+               row is written only if all of its values fit into the block.
         @param row_root list of elements to insert
         @param temp_block block in which we insert data
-        @return EXIT SUCCES if success
+        @return EXIT SUCCES if success, EXIT_ERROR if the row does not fit into the block
  */
 int AK_insert_row_to_block(struct list_node *row_root, AK_block *temp_block);
 
+/**
+ * @author Karlo Vuković
+ * @brief Function that finds the first block of the table with free space. Unlike AK_find_AK_free_space it only
+ *        looks at extents of the table, and when they are full it allocates a new extent that is registered in
+ *        AK_relation, so the new extent gets the header and the layout of the table.
+ * @param tblName table name
+ * @return address of the block, EXIT_ERROR if there is no room for the table
+ */
+int AK_find_table_free_block(char *tblName);
+
 /** @author Matija Novak, updated by Matija Šestak (function now uses caching), updated by Dejan Frankovic (added reference check), updated by Dino         Laktašić (removed variable AK_free, variable table initialized using memset)
         @brief Function inserts a one row into table. Firstly it is checked whether inserted row would violite reference integrity.
         Then it is checked in which table should row be inserted. If there is no AK_free space for new table, new extent is allocated. New block is            allocated on given address. Row is inserted in this block and dirty flag is set to BLOCK_DIRTY.
@@ -87,8 +113,10 @@ int AK_insert_row(struct list_node *row_root);
 int AK_update_row_from_block(AK_block *temp_block, struct list_node *row_root);
 
 /**
-   * @author Matija Novak, updated by Dino Laktašić, changed by Davorin Vukelic, updated by Mario Peroković
-   * @brief Function deletes row from table in given block. Given list of elements is firstly back-upped.
+   * @author Matija Novak, updated by Dino Laktašić, changed by Davorin Vukelic, updated by Mario Peroković, updated by Karlo Vuković (wide blocks, tombstones, overflow values)
+   * @brief Function deletes row from table in given block. Given list of elements is firstly back-upped. Entries of the row in
+            the tuple dictionary become tombstones with size 0, and the space is reclaimed later by AK_vacuum_table.
+            Tombstones of values stored in overflow pages keep the type and the address, so the vacuum can free the pages.
    * @param temp_block block to work with
    * @param row_list list of elements which contain data for delete or update
    * @return No return value
@@ -96,9 +124,12 @@ int AK_update_row_from_block(AK_block *temp_block, struct list_node *row_root);
 void AK_delete_row_from_block(AK_block *temp_block, struct list_node *row_root);
 
 /**
-      * @author Matija Novak, updated by Matija Šestak (function now uses caching)
+      * @author Matija Novak, updated by Matija Šestak (function now uses caching), updated by Karlo Vuković (vacuum queue, Bloom filters, indices, blocks found by an index)
       * @brief Function updates or deletes the whole segment of an table. Addresses for given table atr fetched. For each block
-        in extent row is updated or deleted according to operator del.
+        in extent row is updated or deleted according to operator del. The table is then put into the vacuum queue.
+        If a B+tree index of the table has the attributes of the search constraints, only blocks with rows it finds are read.
+        New values of an update are added to Bloom filters of all extents of the table. Rows that were deleted or changed
+        are collected from every block and indices of the table are updated with all of them at the end.
       * @param row_root elements of one row
       * @param del - DELETE or UPDATE
       * @return EXIT_SUCCESS if success
@@ -112,8 +143,8 @@ int AK_delete_update_segment(struct list_node *row_root, int del);
  */
 int AK_delete_row(struct list_node *row_root) ;
 
-/** @author Matija Novak, Dejan Frankovic (added referential integrity)
-        @brief Function updates rows of some table
+/** @author Matija Novak, Dejan Frankovic (added referential integrity), updated by Karlo Vuković (UNIQUE constraints)
+        @brief Function updates rows of some table. New values are checked against UNIQUE constraints of the table first.
         @param row_root elements of one row
         @return EXIT_SUCCESS if success
 */
@@ -17,9 +17,412 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
  */
 #include "filesearch.h"
+#include "zonemap.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define AK_SEARCH_X86 1
+#include <immintrin.h>
+#endif
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that returns the best vector instruction set the processor
+ * supports for evaluating search predicates. The answer is found once and kept.
+ * @return SEARCH_SIMD_AVX2, SEARCH_SIMD_SSE2 or SEARCH_SIMD_SCALAR
+ */
+int AK_search_simd_support() {
+  static int level = -1;
+
+  if (level < 0) {
+#ifdef AK_SEARCH_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+      level = SEARCH_SIMD_AVX2;
+    else if (__builtin_cpu_supports("sse2"))
+      level = SEARCH_SIMD_SSE2;
+    else
+      level = SEARCH_SIMD_SCALAR;
+#else
+    level = SEARCH_SIMD_SCALAR;
+#endif
+  }
+  return level;
+}
+
+/// clears the bits of rejected values, mask holds one bit per value starting
+/// at value i, and never crosses a word since the step divides 64
+#define AK_SEARCH_REJECT(selection, i, mask)                                   \
+  ((selection)[(i) >> 6] &= ~((unsigned long long)(mask) << ((i) & 63)))
+
+#ifdef AK_SEARCH_X86
+/**
+ * @author Karlo Vuković
+ * @brief Function that filters int values four at a time with SSE2
+ * @return number of values that were filtered
+ */
+__attribute__((target("sse2"))) static int
+AK_search_filter_int_sse2(const int *values, int num_values, int lower,
+                          int upper, unsigned long long *selection) {
+  __m128i low = _mm_set1_epi32(lower), high = _mm_set1_epi32(upper);
+  int i;
+
+  for (i = 0; i + 4 <= num_values; i += 4) {
+    __m128i value = _mm_loadu_si128((const __m128i *)(values + i));
+    __m128i reject = _mm_or_si128(_mm_cmplt_epi32(value, low),
+                                  _mm_cmpgt_epi32(value, high));
+    AK_SEARCH_REJECT(selection, i, _mm_movemask_ps(_mm_castsi128_ps(reject)));
+  }
+  return i;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that filters int values eight at a time with AVX2
+ * @return number of values that were filtered
+ */
+__attribute__((target("avx2"))) static int
+AK_search_filter_int_avx2(const int *values, int num_values, int lower,
+                          int upper, unsigned long long *selection) {
+  __m256i low = _mm256_set1_epi32(lower), high = _mm256_set1_epi32(upper);
+  int i;
+
+  for (i = 0; i + 8 <= num_values; i += 8) {
+    __m256i value = _mm256_loadu_si256((const __m256i *)(values + i));
+    __m256i reject = _mm256_or_si256(_mm256_cmpgt_epi32(low, value),
+                                     _mm256_cmpgt_epi32(value, high));
+    AK_SEARCH_REJECT(selection, i,
+                     _mm256_movemask_ps(_mm256_castsi256_ps(reject)));
+  }
+  return i;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that filters float values four at a time with SSE2, each
+ * half is widened to doubles before the comparison
+ * @return number of values that were filtered
+ */
+__attribute__((target("sse2"))) static int
+AK_search_filter_float_sse2(const float *values, int num_values, double lower,
+                            double upper, unsigned long long *selection) {
+  __m128d low = _mm_set1_pd(lower), high = _mm_set1_pd(upper);
+  int i;
+
+  for (i = 0; i + 4 <= num_values; i += 4) {
+    __m128 value = _mm_loadu_ps(values + i);
+    __m128d first = _mm_cvtps_pd(value);
+    __m128d second = _mm_cvtps_pd(_mm_movehl_ps(value, value));
+    int reject =
+        _mm_movemask_pd(_mm_or_pd(_mm_cmplt_pd(first, low),
+                                  _mm_cmpgt_pd(first, high))) |
+        _mm_movemask_pd(_mm_or_pd(_mm_cmplt_pd(second, low),
+                                  _mm_cmpgt_pd(second, high)))
+            << 2;
+    AK_SEARCH_REJECT(selection, i, reject);
+  }
+  return i;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that filters float values eight at a time with AVX2, each
+ * half is widened to doubles before the comparison
+ * @return number of values that were filtered
+ */
+__attribute__((target("avx2"))) static int
+AK_search_filter_float_avx2(const float *values, int num_values, double lower,
+                            double upper, unsigned long long *selection) {
+  __m256d low = _mm256_set1_pd(lower), high = _mm256_set1_pd(upper);
+  int i;
+
+  for (i = 0; i + 8 <= num_values; i += 8) {
+    __m256d first = _mm256_cvtps_pd(_mm_loadu_ps(values + i));
+    __m256d second = _mm256_cvtps_pd(_mm_loadu_ps(values + i + 4));
+    int reject =
+        _mm256_movemask_pd(_mm256_or_pd(_mm256_cmp_pd(first, low, _CMP_LT_OQ),
+                                        _mm256_cmp_pd(first, high, _CMP_GT_OQ))) |
+        _mm256_movemask_pd(
+            _mm256_or_pd(_mm256_cmp_pd(second, low, _CMP_LT_OQ),
+                         _mm256_cmp_pd(second, high, _CMP_GT_OQ)))
+            << 4;
+    AK_SEARCH_REJECT(selection, i, reject);
+  }
+  return i;
+}
+#endif
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that clears the bits of the selection bitmap for int values
+ * outside the inclusive range [lower, upper]. Equality is a range where lower
+ * equals upper. Values the vector loop leaves over are checked one by one.
+ * @param values contiguous array of values
+ * @param num_values number of values
+ * @param lower lower bound
+ * @param upper upper bound
+ * @param selection bitmap with one bit per value
+ * @param level instruction set to use, lowered to the one the processor
+ * supports
+ * @return No return value
+ */
+void AK_search_filter_int(const int *values, int num_values, int lower,
+                          int upper, unsigned long long *selection,
+                          int level) {
+  int i = 0;
+
+  if (level > AK_search_simd_support())
+    level = AK_search_simd_support();
+#ifdef AK_SEARCH_X86
+  if (level == SEARCH_SIMD_AVX2)
+    i = AK_search_filter_int_avx2(values, num_values, lower, upper, selection);
+  else if (level == SEARCH_SIMD_SSE2)
+    i = AK_search_filter_int_sse2(values, num_values, lower, upper, selection);
+#endif
+  for (; i < num_values; i++)
+    if (values[i] < lower || values[i] > upper)
+      AK_SEARCH_REJECT(selection, i, 1);
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that clears the bits of the selection bitmap for float
+ * values outside the inclusive range [lower, upper]. Values are compared as
+ * doubles, like in the scalar search, so a NaN value is never rejected.
+ * @param values contiguous array of values
+ * @param num_values number of values
+ * @param lower lower bound
+ * @param upper upper bound
+ * @param selection bitmap with one bit per value
+ * @param level instruction set to use, lowered to the one the processor
+ * supports
+ * @return No return value
+ */
+void AK_search_filter_float(const float *values, int num_values, double lower,
+                            double upper, unsigned long long *selection,
+                            int level) {
+  int i = 0;
+
+  if (level > AK_search_simd_support())
+    level = AK_search_simd_support();
+#ifdef AK_SEARCH_X86
+  if (level == SEARCH_SIMD_AVX2)
+    i = AK_search_filter_float_avx2(values, num_values, lower, upper,
+                                    selection);
+  else if (level == SEARCH_SIMD_SSE2)
+    i = AK_search_filter_float_sse2(values, num_values, lower, upper,
+                                    selection);
+#endif
+  for (; i < num_values; i++)
+    if (values[i] < lower || values[i] > upper)
+      AK_SEARCH_REJECT(selection, i, 1);
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that checks one value of a tuple against one search
+ * parameter, the way AK_search_unsorted always did for every tuple
+ * @param block block that holds the value
+ * @param entry entry of the value in the tuple dictionary
+ * @param type type of the attribute in the header
+ * @param param search parameter
+ * @return 1 if the value matches, otherwise 0
+ */
+static int AK_search_match_value(AK_block *block, int entry, int type,
+                                 search_params *param) {
+  AK_tuple_dict *dict = &block->tuple_dict[entry];
+  char *value = block->data + dict->address;
+
+  switch (param->iSearchType) {
+  case SEARCH_PARTICULAR:
+    /// values are compared by type, so padding bytes of a float entry do not
+    /// matter
+    return AK_compare_values(type, value, dict->size,
+                             (char *)param->pData_lower,
+                             AK_type_size(type, (char *)param->pData_lower)) ==
+           0;
+
+  case SEARCH_RANGE:
+    switch (dict->type) {
+    case TYPE_INT:
+    case TYPE_DATE:
+    case TYPE_DATETIME:
+    case TYPE_INTERVAL:
+    case TYPE_PERIOD:
+    case TYPE_TIME: {
+      int iAttributeValue;
+      memcpy(&iAttributeValue, value, sizeof(int));
+      return !(iAttributeValue < *((int *)param->pData_lower) ||
+               iAttributeValue > *((int *)param->pData_upper));
+    }
+
+    case TYPE_FLOAT: {
+      /// float entries hold a float, the rest of the entry is padding
+      float fAttributeValue;
+      memcpy(&fAttributeValue, value, sizeof(float));
+      return !(fAttributeValue < *((double *)param->pData_lower) ||
+               fAttributeValue > *((double *)param->pData_upper));
+    }
+
+    case TYPE_NUMBER: {
+      double dAttributeValue;
+      memcpy(&dAttributeValue, value, sizeof(double));
+      return !(dAttributeValue < *((double *)param->pData_lower) ||
+               dAttributeValue > *((double *)param->pData_upper));
+    }
+
+    default: // other types unsupported
+      return 0;
+    }
+
+  case SEARCH_ALL:
+    return 1;
+
+  case SEARCH_NULL:
+    return dict->type == TYPE_VARCHAR &&
+           AK_type_size(type, (char *)param->pData_lower) == strlen("NULL") &&
+           !memcmp(value, "NULL", strlen("NULL"));
+
+  default:
+    return 0;
+  }
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that filters one attribute of all rows of a block with the
+ * vector kernels. Values are gathered into a contiguous array first, values
+ * with size 0 or less are nulls and never match.
+ * @param block block to filter
+ * @param attribute index of the attribute
+ * @param num_attr number of attributes
+ * @param num_rows number of rows in the block
+ * @param param search parameter, SEARCH_PARTICULAR or SEARCH_RANGE
+ * @param selection bitmap with one bit per row
+ * @return 1 if the parameter was evaluated, 0 if the type has no vector
+ * kernel and rows have to be checked one by one
+ */
+static int AK_search_filter_block(AK_block *block, int attribute, int num_attr,
+                                  int num_rows, search_params *param,
+                                  unsigned long long *selection) {
+  int values[DATA_BLOCK_SIZE];
+  float float_values[DATA_BLOCK_SIZE];
+  int type = block->header[attribute].type;
+  int row;
+
+  if (param->iSearchType != SEARCH_PARTICULAR &&
+      param->iSearchType != SEARCH_RANGE)
+    return 0;
+
+  switch (type) {
+  case TYPE_INT:
+  case TYPE_DATE:
+  case TYPE_DATETIME:
+  case TYPE_INTERVAL:
+  case TYPE_PERIOD:
+  case TYPE_TIME: {
+    int lower = *((int *)param->pData_lower);
+    int upper = param->iSearchType == SEARCH_RANGE
+                    ? *((int *)param->pData_upper)
+                    : lower;
+
+    for (row = 0; row < num_rows; row++) {
+      AK_tuple_dict *dict = &block->tuple_dict[row * num_attr + attribute];
+      if (dict->size <= 0 || dict->type != type)
+        AK_SEARCH_REJECT(selection, row, 1);
+      memcpy(&values[row], block->data + dict->address, sizeof(int));
+    }
+    AK_search_filter_int(values, num_rows, lower, upper, selection,
+                         AK_search_simd_support());
+  } break;
+
+  case TYPE_FLOAT: {
+    /// equality compares floats, range bounds are doubles
+    double lower = param->iSearchType == SEARCH_RANGE
+                       ? *((double *)param->pData_lower)
+                       : *((float *)param->pData_lower);
+    double upper = param->iSearchType == SEARCH_RANGE
+                       ? *((double *)param->pData_upper)
+                       : lower;
+
+    for (row = 0; row < num_rows; row++) {
+      AK_tuple_dict *dict = &block->tuple_dict[row * num_attr + attribute];
+      if (dict->size <= 0 || dict->type != type)
+        AK_SEARCH_REJECT(selection, row, 1);
+      memcpy(&float_values[row], block->data + dict->address, sizeof(float));
+    }
+    AK_search_filter_float(float_values, num_rows, lower, upper, selection,
+                           AK_search_simd_support());
+  } break;
+
+  default:
+    return 0;
+  }
+  return 1;
+}
 
 /**
-  * @author Miroslav Policki
+ * @author Karlo Vuković
+ * @brief Function that checks the zone map of a block against equality and
+ * range parameters on int, float and number attributes
+ * @param address block address
+ * @param aspParams array of search parameters
+ * @param iNum_search_params number of search parameters
+ * @param aiAttributes index of the attribute of each parameter
+ * @param header header of the relation
+ * @return 0 if the block can not hold a matching tuple, otherwise 1
+ */
+static int AK_search_zone_map_may_match(int address, search_params *aspParams,
+                                        int iNum_search_params,
+                                        int *aiAttributes, AK_header *header) {
+  int j, type;
+  double lower, upper;
+
+  for (j = 0; j < iNum_search_params; j++) {
+    type = header[aiAttributes[j]].type;
+    if (aspParams[j].iSearchType != SEARCH_PARTICULAR &&
+        aspParams[j].iSearchType != SEARCH_RANGE)
+      continue;
+
+    switch (type) {
+    case TYPE_INT:
+    case TYPE_DATE:
+    case TYPE_DATETIME:
+    case TYPE_INTERVAL:
+    case TYPE_PERIOD:
+    case TYPE_TIME:
+      lower = *((int *)aspParams[j].pData_lower);
+      upper = aspParams[j].iSearchType == SEARCH_RANGE
+                  ? *((int *)aspParams[j].pData_upper)
+                  : lower;
+      break;
+    case TYPE_FLOAT:
+      /// equality compares floats, range bounds are doubles
+      lower = aspParams[j].iSearchType == SEARCH_RANGE
+                  ? *((double *)aspParams[j].pData_lower)
+                  : *((float *)aspParams[j].pData_lower);
+      upper = aspParams[j].iSearchType == SEARCH_RANGE
+                  ? *((double *)aspParams[j].pData_upper)
+                  : lower;
+      break;
+    case TYPE_NUMBER:
+      lower = *((double *)aspParams[j].pData_lower);
+      upper = aspParams[j].iSearchType == SEARCH_RANGE
+                  ? *((double *)aspParams[j].pData_upper)
+                  : lower;
+      break;
+    default:
+      continue;
+    }
+
+    if (!AK_zone_map_may_match(address, aiAttributes[j], lower, upper, 0))
+      return 0;
+  }
+  return 1;
+}
+
+/**
+  * @author Miroslav Policki, updated by Karlo Vuković (typed comparison,
+  vectorized predicates, zone maps)
 
   * @brief Function that searches through unsorted values of multiple attributes
   in a segment. Only tuples that are equal on all given attribute values are
@@ -30,6 +433,11 @@
            Do not provide the wrong data types in the array of search
   parameters. There is no way to test for that and it could cause a memory
   access  	violation.
+           Each block keeps a selection bitmap with one bit per row. Equality
+  and range parameters on int and float attributes are evaluated on a whole
+  column of the block with SSE2 or AVX2 and ANDed into the bitmap, the other
+  parameters are checked only for rows that are still selected. Blocks
+  whose zone maps show that they can not hold a matching tuple are not read.
   * @param szRelation relation name
   * @param aspParams array of search parameters
   * @param iNum_search_params number of search parameters
@@ -44,13 +452,18 @@ search_result AK_search_unsorted(char *szRelation, search_params *aspParams,
   int iBlock;
   AK_mem_block *mem_block = NULL, tmp;
   int i, j, k;
-  int iTupleMatches;
+  int iNum_rows, iNum_matches, iRow;
+  int aiVectorized[MAX_ATTRIBUTES];
+  unsigned long long aSelection[SEARCH_BITMAP_WORDS];
+  AK_header aHeader[MAX_ATTRIBUTES];
   search_result srResult;
   table_addresses *taAddresses;
 
   srResult.aiTuple_addresses = NULL;
   srResult.iNum_tuple_addresses = 0;
   srResult.aiSearch_attributes = NULL;
+  srResult.iNum_search_attributes = 0;
+  srResult.iNum_tuple_attributes = 0;
   srResult.aiBlocks = NULL;
 
   if (aspParams == NULL || iNum_search_params == 0) {
@@ -58,6 +471,15 @@ search_result AK_search_unsorted(char *szRelation, search_params *aspParams,
     return srResult;
   }
 
+  srResult.aiSearch_attributes =
+      (int *)AK_malloc(iNum_search_params * sizeof(int));
+  if (srResult.aiSearch_attributes == NULL) {
+    printf("AK_search_unsorted: ERROR. Cannot allocate "
+           "srResult.aiAttributes_searched.\n");
+    AK_EPI;
+    exit(EXIT_ERROR);
+  }
+
   taAddresses = AK_get_table_addresses(szRelation);
 
   /// iterate through all the blocks
@@ -65,179 +487,129 @@ search_result AK_search_unsorted(char *szRelation, search_params *aspParams,
        k++) { // 200 == Novak's magic number :)
     for (iBlock = taAddresses->address_from[k];
          iBlock <= taAddresses->address_to[k]; iBlock++) {
+      /// once the attributes are known, zone maps tell which blocks to skip
+      if (srResult.iNum_tuple_attributes > 0 &&
+          !AK_search_zone_map_may_match(iBlock, aspParams, iNum_search_params,
+                                        srResult.aiSearch_attributes, aHeader))
+        continue;
+
       // mem_block = AK_get_block(iBlock);
       mem_block = &tmp;
       mem_block->block = AK_read_block(iBlock);
 
-      /// count number of attributes in segment/relation
-      srResult.iNum_tuple_attributes = 0;
-      for (i = 0; i < MAX_ATTRIBUTES; i++) {
-        if (mem_block->block->header[i].att_name[0] == FREE_CHAR)
-          break;
-        srResult.iNum_tuple_attributes++;
-      }
-
-      srResult.aiSearch_attributes =
-          (int *)AK_malloc(iNum_search_params * sizeof(int));
-      if (srResult.aiSearch_attributes == NULL) {
-        printf("AK_search_unsorted: ERROR. Cannot allocate "
-               "srResult.aiAttributes_searched.\n");
-        AK_EPI;
-        exit(EXIT_ERROR);
-      }
-      srResult.iNum_search_attributes = 0;
-
-      /// determine index of attributes on which search will be performed
-      for (j = 0; j < iNum_search_params; j++) {
+      /// all blocks of the relation share the header, so attributes are
+      /// found in the first one
+      if (srResult.iNum_tuple_attributes == 0) {
+        /// count number of attributes in segment/relation
         for (i = 0; i < MAX_ATTRIBUTES; i++) {
-          if (!strcmp(mem_block->block->header[i].att_name,
-                      aspParams[j].szAttribute)) {
-            srResult.aiSearch_attributes[j] = i;
-            srResult.iNum_search_attributes++;
+          if (mem_block->block->header[i].att_name[0] == FREE_CHAR)
             break;
+          srResult.iNum_tuple_attributes++;
+        }
+
+        /// determine index of attributes on which search will be performed
+        for (j = 0; j < iNum_search_params; j++) {
+          for (i = 0; i < srResult.iNum_tuple_attributes; i++) {
+            if (!strcmp(mem_block->block->header[i].att_name,
+                        aspParams[j].szAttribute)) {
+              srResult.aiSearch_attributes[j] = i;
+              srResult.iNum_search_attributes++;
+              break;
+            }
           }
         }
-      }
 
-      /// if any of the provided attributes are not found in the relation,
-      /// return empty result
-      if (srResult.iNum_search_attributes != iNum_search_params)
-        return srResult;
+        /// if any of the provided attributes are not found in the relation,
+        /// return empty result
+        if (srResult.iNum_tuple_attributes == 0 ||
+            srResult.iNum_search_attributes != iNum_search_params) {
+          AK_free(mem_block->block);
+          AK_free(taAddresses);
+          AK_EPI;
+          return srResult;
+        }
+        memcpy(aHeader, mem_block->block->header, sizeof(aHeader));
+      }
 
-      /// in every tuple, for all required attributes, compare attribute value
-      /// with searched-for value and store matched tuple addresses
+      /// count the rows of the block and select all of them
+      iNum_rows = 0;
       for (i = 0; i < DATA_BLOCK_SIZE &&
                   mem_block->block->tuple_dict[i].type != FREE_INT;
-           i += srResult.iNum_tuple_attributes) {
-        iTupleMatches = 1;
-
-        for (j = 0; j < iNum_search_params && iTupleMatches; j++) {
-          switch (aspParams[j].iSearchType) {
-          case SEARCH_PARTICULAR: {
-            size_t iSearchAttributeValueSize = AK_type_size(
-                mem_block->block->header[srResult.aiSearch_attributes[j]].type,
-                (char *)aspParams[j].pData_lower);
-
-            if (mem_block->block
-                        ->tuple_dict[i + srResult.aiSearch_attributes[j]]
-                        .size != iSearchAttributeValueSize ||
-                memcmp(mem_block->block->data +
-                           mem_block->block
-                               ->tuple_dict[i + srResult.aiSearch_attributes[j]]
-                               .address,
-                       aspParams[j].pData_lower, iSearchAttributeValueSize)) {
-              iTupleMatches = 0;
-            }
-          } break;
-
-          case SEARCH_RANGE: {
-
-            switch (mem_block->block
-                        ->tuple_dict[i + srResult.aiSearch_attributes[j]]
-                        .type) {
-            case TYPE_INT:
-            case TYPE_DATE:
-            case TYPE_DATETIME:
-            case TYPE_INTERVAL:
-            case TYPE_PERIOD:
-            case TYPE_TIME: {
-              int iAttributeValue = *(
-                  (int *)(mem_block->block->data +
-                          mem_block->block
-                              ->tuple_dict[i + srResult.aiSearch_attributes[j]]
-                              .address));
-              if (iAttributeValue < *((int *)aspParams[j].pData_lower) ||
-                  iAttributeValue > *((int *)aspParams[j].pData_upper)) {
-                iTupleMatches = 0;
-              }
-            } break;
-
-            case TYPE_FLOAT:
-            case TYPE_NUMBER:
-              if (*((double *)(mem_block->block->data +
-                               mem_block->block
-                                   ->tuple_dict[i +
-                                                srResult.aiSearch_attributes[j]]
-                                   .address)) <
-                      *((double *)aspParams[j].pData_lower) ||
-                  *((double *)(mem_block->block->data +
-                               mem_block->block
-                                   ->tuple_dict[i +
-                                                srResult.aiSearch_attributes[j]]
-                                   .address)) >
-                      *((double *)aspParams[j].pData_upper)) {
-                iTupleMatches = 0;
-              }
-              break;
-
-            default: // other types unsupported
-              iTupleMatches = 0;
-            }
-          } break;
-
-          case SEARCH_ALL: // iTupleMatches is already == 1, no action needed
+           i += srResult.iNum_tuple_attributes)
+        iNum_rows++;
+
+      memset(aSelection, 0, sizeof(aSelection));
+      for (iRow = 0; iRow < iNum_rows; iRow++)
+        aSelection[iRow >> 6] |= 1ULL << (iRow & 63);
+
+      /// parameters with a vector kernel clear the bits of whole columns
+      for (j = 0; j < iNum_search_params; j++)
+        aiVectorized[j] = AK_search_filter_block(
+            mem_block->block, srResult.aiSearch_attributes[j],
+            srResult.iNum_tuple_attributes, iNum_rows, &aspParams[j],
+            aSelection);
+
+      /// in every selected tuple, compare the remaining attribute values with
+      /// searched-for values and count matched tuples
+      iNum_matches = 0;
+      for (iRow = 0; iRow < iNum_rows; iRow++) {
+        if (!(aSelection[iRow >> 6] >> (iRow & 63) & 1))
+          continue;
+
+        i = iRow * srResult.iNum_tuple_attributes;
+        for (j = 0; j < iNum_search_params; j++) {
+          if (aiVectorized[j])
+            continue;
+          if (!AK_search_match_value(
+                  mem_block->block, i + srResult.aiSearch_attributes[j],
+                  mem_block->block->header[srResult.aiSearch_attributes[j]]
+                      .type,
+                  &aspParams[j])) {
+            AK_SEARCH_REJECT(aSelection, iRow, 1);
             break;
-
-          case SEARCH_NULL: {
-            size_t iSearchAttributeValueSize = AK_type_size(
-                mem_block->block->header[srResult.aiSearch_attributes[j]].type,
-                (char *)aspParams[j].pData_lower);
-
-            if (mem_block->block
-                        ->tuple_dict[i + srResult.aiSearch_attributes[j]]
-                        .type != TYPE_VARCHAR ||
-                iSearchAttributeValueSize != strlen("NULL") ||
-                memcmp(mem_block->block->data +
-                           mem_block->block
-                               ->tuple_dict[i + srResult.aiSearch_attributes[j]]
-                               .address,
-                       "NULL", strlen("NULL")))
-              iTupleMatches = 0;
-          } break;
-
-          default:
-            iTupleMatches = 0;
           }
         }
+        if (j == iNum_search_params)
+          iNum_matches++;
+      }
 
-        if (iTupleMatches) {
-          /*if(DEBUG) {
-              printf("AK_realloc(srResult.aiTuple_addresses = %p,
-          srResult.iNum_tuple_addresses++ * sizeof(int) = %d)\n",
-          srResult.aiTuple_addresses, (srResult.iNum_tuple_addresses + 1) *
-          sizeof(int)); if(srResult.iNum_tuple_addresses == 7) puts("8");
-          }*/
-          srResult.iNum_tuple_addresses++;
-          srResult.aiTuple_addresses =
-              (int *)AK_realloc(srResult.aiTuple_addresses,
-                                srResult.iNum_tuple_addresses * sizeof(int));
-
-          if (srResult.aiTuple_addresses == NULL) {
-            printf("AK_search_unsorted: ERROR. Cannot AK_reallocate "
-                   "srResult.aiTuple_addresses, iteration %d.\n",
-                   i);
-            AK_EPI;
-            exit(EXIT_ERROR);
-          }
+      /// store matched tuple addresses, the arrays grow once per block
+      if (iNum_matches > 0) {
+        srResult.aiTuple_addresses = (int *)AK_realloc(
+            srResult.aiTuple_addresses,
+            (srResult.iNum_tuple_addresses + iNum_matches) * sizeof(int));
+        if (srResult.aiTuple_addresses == NULL) {
+          printf("AK_search_unsorted: ERROR. Cannot AK_reallocate "
+                 "srResult.aiTuple_addresses, block %d.\n",
+                 iBlock);
+          AK_EPI;
+          exit(EXIT_ERROR);
+        }
 
-          /*if(DEBUG)
-              puts("AK_realloc srResult.aiBlocks");*/
-          srResult.aiBlocks = (int *)AK_realloc(
-              srResult.aiBlocks, srResult.iNum_tuple_addresses * sizeof(int));
-          if (srResult.aiBlocks == NULL) {
-            printf("AK_search_unsorted: ERROR. Cannot AK_reallocate "
-                   "srResult.aiBlocks, iteration %d.\n",
-                   i);
-            AK_EPI;
-            exit(EXIT_ERROR);
-          }
+        srResult.aiBlocks = (int *)AK_realloc(
+            srResult.aiBlocks,
+            (srResult.iNum_tuple_addresses + iNum_matches) * sizeof(int));
+        if (srResult.aiBlocks == NULL) {
+          printf("AK_search_unsorted: ERROR. Cannot AK_reallocate "
+                 "srResult.aiBlocks, block %d.\n",
+                 iBlock);
+          AK_EPI;
+          exit(EXIT_ERROR);
+        }
 
-          srResult.aiTuple_addresses[srResult.iNum_tuple_addresses - 1] = i;
-          srResult.aiBlocks[srResult.iNum_tuple_addresses - 1] = iBlock;
+        for (iRow = 0; iRow < iNum_rows; iRow++) {
+          if (!(aSelection[iRow >> 6] >> (iRow & 63) & 1))
+            continue;
+          srResult.aiTuple_addresses[srResult.iNum_tuple_addresses] =
+              iRow * srResult.iNum_tuple_attributes;
+          srResult.aiBlocks[srResult.iNum_tuple_addresses] = iBlock;
+          srResult.iNum_tuple_addresses++;
         }
       }
+      AK_free(mem_block->block);
     }
   }
+  AK_free(taAddresses);
   AK_EPI;
   return srResult;
 }
@@ -258,13 +630,15 @@ void AK_deallocate_search_result(search_result srResult) {
   AK_EPI;
 }
 /**
- * @author Miroslav Policki
+ * @author Miroslav Policki, updated by Karlo Vuković (vector kernels and
+ * combined searches)
  * @brief Function that tests file search
  * @return No return value
  */
 TestResult AK_filesearch_test() {
   int i;
-  double f;
+  int passed = 1, failed = 0;
+  float f;
   AK_mem_block *mem_block, tmp;
   AK_header hBroj_int[4], *hTmp;
   struct list_node *row_root;
@@ -320,7 +694,7 @@ TestResult AK_filesearch_test() {
     search_params sp[3];
     search_result sr;
     int iLower, iUpper;
-    double dTmp;
+    float fTmp;
 
     sp[0].szAttribute = "Varchar column";
     sp[0].iSearchType = SEARCH_ALL;
@@ -334,8 +708,8 @@ TestResult AK_filesearch_test() {
 
     sp[2].szAttribute = "Number float";
     sp[2].iSearchType = SEARCH_PARTICULAR;
-    dTmp = 2;
-    sp[2].pData_lower = &dTmp;
+    fTmp = 2;
+    sp[2].pData_lower = &fTmp;
 
     AK_dbg_messg(LOW, FILE_MAN, "Calling AK_search_unsorted");
     sr = AK_search_unsorted("filesearch test table", sp, 3);
@@ -352,9 +726,9 @@ TestResult AK_filesearch_test() {
                            .address)));
       printf(
           "Found:%f\n",
-          *((double *)(mem_block->block->data +
-                       mem_block->block->tuple_dict[sr.aiTuple_addresses[i] + 1]
-                           .address)));
+          *((float *)(mem_block->block->data +
+                      mem_block->block->tuple_dict[sr.aiTuple_addresses[i] + 1]
+                          .address)));
 
       szTmp = AK_malloc(
           mem_block->block->tuple_dict[sr.aiTuple_addresses[i] + 2].size + 1);
@@ -371,6 +745,145 @@ TestResult AK_filesearch_test() {
 
     AK_deallocate_search_result(sr);
   }
+
+  // every vector kernel has to select the same values as the scalar one
+  {
+    int aiValues[DATA_BLOCK_SIZE];
+    float afValues[DATA_BLOCK_SIZE];
+    unsigned long long aScalar[SEARCH_BITMAP_WORDS],
+        aVector[SEARCH_BITMAP_WORDS];
+    int aiBounds[][2] = {{-5, 5}, {0, 0}, {7, 7}, {-1000, -999},
+                         {INT_MIN, INT_MAX}, {3, -3}};
+    int iLevel, iBound, iCount, iExpected, iSame = 1;
+    float fNan = NAN;
+
+    srand(36);
+    for (i = 0; i < DATA_BLOCK_SIZE; i++) {
+      aiValues[i] = rand() % 41 - 20;
+      afValues[i] = (rand() % 81 - 40) * 0.25f;
+    }
+    aiValues[3] = INT_MIN;
+    aiValues[4] = INT_MAX;
+    afValues[5] = fNan;
+
+    for (iLevel = SEARCH_SIMD_SSE2; iLevel <= AK_search_simd_support();
+         iLevel++) {
+      for (iBound = 0; iBound < sizeof(aiBounds) / sizeof(aiBounds[0]);
+           iBound++) {
+        // odd lengths leave values for the scalar tail
+        int iNum_values = DATA_BLOCK_SIZE - iBound;
+
+        memset(aScalar, 0xff, sizeof(aScalar));
+        memset(aVector, 0xff, sizeof(aVector));
+        AK_search_filter_int(aiValues, iNum_values, aiBounds[iBound][0],
+                             aiBounds[iBound][1], aScalar,
+                             SEARCH_SIMD_SCALAR);
+        AK_search_filter_int(aiValues, iNum_values, aiBounds[iBound][0],
+                             aiBounds[iBound][1], aVector, iLevel);
+        if (memcmp(aScalar, aVector, sizeof(aScalar)))
+          iSame = 0;
+
+        memset(aScalar, 0xff, sizeof(aScalar));
+        memset(aVector, 0xff, sizeof(aVector));
+        AK_search_filter_float(afValues, iNum_values,
+                               aiBounds[iBound][0] * 0.25,
+                               aiBounds[iBound][1] * 0.25, aScalar,
+                               SEARCH_SIMD_SCALAR);
+        AK_search_filter_float(afValues, iNum_values,
+                               aiBounds[iBound][0] * 0.25,
+                               aiBounds[iBound][1] * 0.25, aVector, iLevel);
+        if (memcmp(aScalar, aVector, sizeof(aScalar)))
+          iSame = 0;
+      }
+    }
+
+    // the scalar kernel has to select what a plain loop selects
+    memset(aScalar, 0xff, sizeof(aScalar));
+    AK_search_filter_int(aiValues, DATA_BLOCK_SIZE, -5, 5, aScalar,
+                         SEARCH_SIMD_SCALAR);
+    for (i = 0, iCount = 0, iExpected = 0; i < DATA_BLOCK_SIZE; i++) {
+      iCount += aScalar[i >> 6] >> (i & 63) & 1;
+      iExpected += aiValues[i] >= -5 && aiValues[i] <= 5;
+    }
+
+    printf("filesearch_test: vector kernels up to level %d %s the scalar "
+           "kernel\n",
+           AK_search_simd_support(), iSame ? "match" : "DO NOT match");
+    if (iSame && iCount == iExpected)
+      passed++;
+    else
+      failed++;
+  }
+
+  // searches that combine several parameters, every insert of the test rows
+  // adds one row per value of i
+  {
+    search_params sp[3];
+    search_result sr;
+    int iLower, iUpper, iValue;
+    double dLower, dUpper;
+    float fValue;
+    int iNum_batches = AK_get_num_records("filesearch test table") / 20;
+    int iMatches;
+
+    // Number int in [-5, 5] and Number float in [0.5, 3], which is i in
+    // {-3, -2, -1}
+    sp[0].szAttribute = "Number int";
+    sp[0].iSearchType = SEARCH_RANGE;
+    iLower = -5;
+    iUpper = 5;
+    sp[0].pData_lower = &iLower;
+    sp[0].pData_upper = &iUpper;
+    sp[1].szAttribute = "Number float";
+    sp[1].iSearchType = SEARCH_RANGE;
+    dLower = 0.5;
+    dUpper = 3;
+    sp[1].pData_lower = &dLower;
+    sp[1].pData_upper = &dUpper;
+    sp[2].szAttribute = "Varchar column";
+    sp[2].iSearchType = SEARCH_PARTICULAR;
+    sp[2].pData_lower = "test text";
+
+    sr = AK_search_unsorted("filesearch test table", sp, 3);
+    iMatches = sr.iNum_tuple_addresses == 3 * iNum_batches;
+    for (i = 0; i < sr.iNum_tuple_addresses; i++) {
+      AK_block *block = AK_read_block(sr.aiBlocks[i]);
+      memcpy(&iValue,
+             block->data +
+                 block->tuple_dict[sr.aiTuple_addresses[i]].address,
+             sizeof(int));
+      if (iValue < -3 || iValue > -1)
+        iMatches = 0;
+      AK_free(block);
+    }
+    AK_deallocate_search_result(sr);
+
+    // Number int equal to 7 and Number float equal to -7
+    sp[0].iSearchType = SEARCH_PARTICULAR;
+    iValue = 7;
+    sp[0].pData_lower = &iValue;
+    sp[1].iSearchType = SEARCH_PARTICULAR;
+    fValue = -7;
+    sp[1].pData_lower = &fValue;
+    sr = AK_search_unsorted("filesearch test table", sp, 2);
+    if (sr.iNum_tuple_addresses != iNum_batches)
+      iMatches = 0;
+    AK_deallocate_search_result(sr);
+
+    // Number int equal to 7 and Number float equal to 7 match nothing
+    fValue = 7;
+    sr = AK_search_unsorted("filesearch test table", sp, 2);
+    if (sr.iNum_tuple_addresses != 0)
+      iMatches = 0;
+    AK_deallocate_search_result(sr);
+
+    printf("filesearch_test: combined searches over %d inserts %s\n",
+           iNum_batches, iMatches ? "match" : "DO NOT match");
+    if (iNum_batches > 0 && iMatches)
+      passed++;
+    else
+      failed++;
+  }
   AK_EPI;
-  return TEST_result(1, 0);
+  return TEST_result(passed, failed);
 }
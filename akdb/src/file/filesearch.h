@@ -24,12 +24,22 @@
 #include "../mm/memoman.h"
 #include "files.h"
 #include "../auxi/mempro.h"
+#include "../auxi/compare.h"
+#include <limits.h>
+#include <math.h>
 
 #define SEARCH_NULL       0
 #define SEARCH_ALL        1
 #define SEARCH_PARTICULAR 2
 #define SEARCH_RANGE      3
 
+#define SEARCH_SIMD_SCALAR 0
+#define SEARCH_SIMD_SSE2   1
+#define SEARCH_SIMD_AVX2   2
+
+/// number of 64 bit words in the selection bitmap of a block, one bit per row
+#define SEARCH_BITMAP_WORDS ((DATA_BLOCK_SIZE + 63) / 64)
+
 /**
  * @author Unknown
  * @struct search_params
@@ -91,6 +101,42 @@ search_result AK_search_unsorted(char *szRelation, search_params *aspParams, int
  */
 
 void AK_deallocate_search_result(search_result srResult);
+
+/**
+  * @author Karlo Vuković
+  * @brief Function that returns the best vector instruction set the processor supports for evaluating search predicates
+  * @return SEARCH_SIMD_AVX2, SEARCH_SIMD_SSE2 or SEARCH_SIMD_SCALAR
+ */
+int AK_search_simd_support();
+
+/**
+  * @author Karlo Vuković
+  * @brief Function that clears the bits of the selection bitmap for int values outside the inclusive range
+           [lower, upper]. Equality is a range where lower equals upper.
+  * @param values contiguous array of values
+  * @param num_values number of values
+  * @param lower lower bound
+  * @param upper upper bound
+  * @param selection bitmap with one bit per value, bits of values that match are left as they were
+  * @param level instruction set to use, lowered to the one AK_search_simd_support returns
+  * @return No return value
+ */
+void AK_search_filter_int(const int *values, int num_values, int lower, int upper, unsigned long long *selection, int level);
+
+/**
+  * @author Karlo Vuković
+  * @brief Function that clears the bits of the selection bitmap for float values outside the inclusive range
+           [lower, upper]. Values are compared as doubles, like in the scalar search.
+  * @param values contiguous array of values
+  * @param num_values number of values
+  * @param lower lower bound
+  * @param upper upper bound
+  * @param selection bitmap with one bit per value, bits of values that match are left as they were
+  * @param level instruction set to use, lowered to the one AK_search_simd_support returns
+  * @return No return value
+ */
+void AK_search_filter_float(const float *values, int num_values, double lower, double upper, unsigned long long *selection, int level);
+
 TestResult AK_filesearch_test();
 
 #endif
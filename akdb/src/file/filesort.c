@@ -17,6 +17,7 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
  */
 #include "filesort.h"
+#include "idx/btree.h"
 
 /**
  * @author Unknown
@@ -86,91 +87,1332 @@ int AK_get_num_of_tuples(AK_block *iBlock) {
 }
 
 /**
- * @author Tomislav Bobinac, updated by Filip Žmuk
- * @todo Make it to suport multiple sort atributes and ASC|DESC ordering
- * @brief Function that sorts a segment
- * @return No return value.
+ * @author Karlo Vuković
+ * @struct AK_sort_row
+ * @brief Structure that points to a row held in the memory of the sort
  */
-int AK_sort_segment(char *srcTable, char *destTable, struct list_node* attributes) {
-	//initialize variables
-	register int i, j;
-	int blocks_addr[MAX_NUM_OF_BLOCKS];	//array with block addresses
-	int num_blocks = 0;	//number of blocks in segment
+typedef struct {
+    /// beginning of the normalized key of the row
+    unsigned char key[SORT_KEY_PREFIX];
+    /// position of the block in the memory of the sort
+    int block;
+    /// first entry of the row in the tuple dictionary of the block
+    int tuple;
+} AK_sort_row;
 
-	AK_PRO;
+/**
+ * @author Karlo Vuković
+ * @struct AK_sort_cursor
+ * @brief Structure that reads the rows of a sorted run one block at a time
+ */
+typedef struct {
+    /// addresses of the run extents
+    table_addresses *addresses;
+    /// current extent
+    int extent;
+    /// address of the current block
+    int address;
+    /// first entry of the current row in the tuple dictionary
+    int tuple;
+    /// copy of the current block
+    AK_block *block;
+    /// 1 after the last row of the run
+    int done;
+} AK_sort_cursor;
 
-	//Get number of blocks for given table
-	table_addresses *addresses = (table_addresses *) AK_get_table_addresses(srcTable);
-	for (i = 0; addresses->address_from[i] != 0; i++) {
-		for (j = addresses->address_from[i]; j <= addresses->address_to[i]; j++) {
-			blocks_addr[num_blocks] = j;
-			num_blocks++;
-		}
-	}
+/**
+ * @author Karlo Vuković
+ * @brief Function that returns the header of a table that ends with an empty attribute, as a new segment needs it
+ * @param tblName table name
+ * @param num_attr number of attributes of the table
+ * @return header that has to be freed
+ */
+static AK_header *AK_sort_get_header(char *tblName, int num_attr) {
+    AK_header *header, *table_header;
+
+    table_header = AK_get_header(tblName);
+    header = (AK_header *) AK_calloc(num_attr + 1, sizeof (AK_header));
+    memcpy(header, table_header, num_attr * sizeof (AK_header));
+    AK_free(table_header);
+    return header;
+}
 
-	AK_header *head = AK_get_header(srcTable);
-	AK_initialize_new_segment(destTable, SEGMENT_TYPE_TABLE, head);
+/**
+ * @author Karlo Vuković
+ * @brief Function that returns the length of the normalized value of a type with fixed width
+ * @param type type of the attribute
+ * @return length of the value together with the byte for null values, 0 if values of the type have no fixed width
+ */
+static int AK_sort_key_width(int type) {
+    switch (type) {
+        case TYPE_INT:
+        case TYPE_DATE:
+        case TYPE_DATETIME:
+        case TYPE_TIME:
+        case TYPE_INTERVAL:
+        case TYPE_PERIOD:
+        case TYPE_FLOAT:
+            return 1 + 4;
+        case TYPE_NUMBER:
+            return 1 + 8;
+        case TYPE_BOOL:
+            return 1 + 1;
+        default:
+            return 0;
+    }
+}
 
-	//SORTING ...
-	char x[DATA_ROW_SIZE]; 		//needed data
-	char y[DATA_ROW_SIZE]; 		//data needed for comparison
-	char data[DATA_TUPLE_SIZE]; //data to be copied
+/**
+ * @author Karlo Vuković
+ * @brief Function that checks if an entry holds a null value of a sort attribute. Nulls are stored as the varchar
+ *        "null", so an entry whose type is not the type of the attribute is null, as is an empty entry.
+ * @param keys sort attributes
+ * @param key index of the sort attribute
+ * @param entry entry of the attribute
+ * @return 1 if the value is null, otherwise 0
+ */
+static int AK_sort_entry_null(AK_sort_keys *keys, int key, AK_tuple_dict *entry) {
+    return entry->size <= 0 || entry->type != keys->type[key];
+}
 
-	AK_mem_block * real_table = (AK_mem_block*) AK_get_block(blocks_addr[0]);
+/**
+ * @author Karlo Vuković
+ * @brief Function that reads the sort attributes from a list
+ * @param keys sort attributes
+ * @param header header of the table, it has to end with an empty attribute
+ * @param attributes list of attributes
+ * @return EXIT_SUCCESS, EXIT_ERROR if there are no attributes, too many of them or an attribute does not exist
+ */
+int AK_sort_keys_init(AK_sort_keys *keys, AK_header *header, struct list_node *attributes) {
+    struct list_node *element;
+    int attribute, width;
+    AK_PRO;
+
+    memset(keys, 0, sizeof (AK_sort_keys));
+    for (element = attributes == NULL ? NULL : AK_First_L2(attributes); element != NULL; element = AK_Next_L2(element)) {
+        if (element->type == TYPE_OPERATOR && keys->num_keys > 0) {
+            if (strcmp(element->data, SORT_DESC) == 0)
+                keys->descending[keys->num_keys - 1] = 1;
+            else if (strcmp(element->data, SORT_ASC) == 0)
+                keys->descending[keys->num_keys - 1] = 0;
+            continue;
+        }
+        if (element->type != TYPE_ATTRIBS)
+            continue;
+        for (attribute = 0; header[attribute].type != TYPE_INTERNAL; attribute++) {
+            if (strcmp(header[attribute].att_name, element->data) == 0)
+                break;
+        }
+        if (header[attribute].type == TYPE_INTERNAL || keys->num_keys == MAX_ATTRIBUTES) {
+            printf("AK_sort_keys_init: Can not sort by attribute %s!\n", element->data);
+            AK_EPI;
+            return EXIT_ERROR;
+        }
+        keys->attribute[keys->num_keys] = attribute;
+        keys->type[keys->num_keys] = header[attribute].type;
+        keys->num_keys++;
+    }
+    if (keys->num_keys == 0) {
+        AK_EPI;
+        return EXIT_ERROR;
+    }
 
-	//get total number of headers and the number of header used to sort segment
-	int num_headers = AK_get_total_headers(real_table->block);
-	int num_sort_header = AK_get_header_number(real_table->block, AK_First_L2(attributes)->data);
-	int num_records = AK_get_num_records(srcTable);
+    for (attribute = 0; attribute < keys->num_keys; attribute++) {
+        width = AK_sort_key_width(keys->type[attribute]);
+        if (width == 0 || keys->fixed_width + width > SORT_KEY_PREFIX) {
+            keys->fixed_width = 0;
+            break;
+        }
+        keys->fixed_width += width;
+    }
+    AK_EPI;
+    return EXIT_SUCCESS;
+}
 
-	int type, temp, address, size, temp_field[num_records];
-	for (i = 0; i<num_records; i++) {
-		temp_field[i]=i;
-	}
+/**
+ * @author Karlo Vuković
+ * @brief Function that writes the sort attributes of a row as a normalized key, a string of bytes that compares with
+ *        memcmp like the row compares by the attributes. Each value starts with a byte that is 0 for null values and
+ *        1 for others, so nulls come first. A value is null if its entry is empty or its type is not the type of the
+ *        attribute, as "null" is stored as a varchar, and the rest of a null value of fixed width is zeros.
+ *        Int, date and time values are written as big-endian numbers with the sign bit flipped, float and number
+ *        values as their bits with the sign bit flipped for positive values and all bits flipped for negative ones,
+ *        and varchar values as their bytes followed by a zero byte. All bytes of a descending attribute are flipped.
+ *        A key longer than size is cut and the rest of the buffer is filled with zeros.
+ * @param keys sort attributes
+ * @param block block that holds the row
+ * @param tuple first entry of the row in the tuple dictionary
+ * @param key buffer for the key
+ * @param size size of the buffer
+ * @return No return value
+ */
+void AK_sort_key_normalize(AK_sort_keys *keys, AK_block *block, int tuple, unsigned char *key, int size) {
+    unsigned char value[MAX_VARCHAR_LENGTH + 2];
+    unsigned int bits;
+    unsigned long long bits64;
+    float value_float;
+    double value_double;
+    unsigned char *data;
+    int i, j, length, value_size, written = 0;
+
+    for (i = 0; i < keys->num_keys && written < size; i++) {
+        data = block->data + block->tuple_dict[tuple + keys->attribute[i]].address;
+        value_size = block->tuple_dict[tuple + keys->attribute[i]].size;
+        length = 1;
+        value[0] = AK_sort_entry_null(keys, i, &block->tuple_dict[tuple + keys->attribute[i]]) ? 0 : 1;
+        if (value[0] == 0) {
+            //the null value keeps the width of the attribute, so the values after it stay in their places
+            length = AK_sort_key_width(keys->type[i]) > 0 ? AK_sort_key_width(keys->type[i]) : 1;
+            memset(value + 1, 0, length - 1);
+        } else {
+            switch (keys->type[i]) {
+                case TYPE_INT:
+                case TYPE_DATE:
+                case TYPE_DATETIME:
+                case TYPE_TIME:
+                case TYPE_INTERVAL:
+                case TYPE_PERIOD:
+                    memcpy(&bits, data, sizeof (int));
+                    bits ^= 0x80000000u;
+                    for (j = 0; j < 4; j++)
+                        value[length++] = bits >> (24 - 8 * j);
+                    break;
+                case TYPE_FLOAT:
+                    memcpy(&value_float, data, sizeof (float));
+                    //-0 and 0 are equal values
+                    if (value_float == 0)
+                        value_float = 0;
+                    memcpy(&bits, &value_float, sizeof (float));
+                    bits = bits & 0x80000000u ? ~bits : bits ^ 0x80000000u;
+                    for (j = 0; j < 4; j++)
+                        value[length++] = bits >> (24 - 8 * j);
+                    break;
+                case TYPE_NUMBER:
+                    memcpy(&value_double, data, sizeof (double));
+                    if (value_double == 0)
+                        value_double = 0;
+                    memcpy(&bits64, &value_double, sizeof (double));
+                    bits64 = bits64 & 0x8000000000000000ull ? ~bits64 : bits64 ^ 0x8000000000000000ull;
+                    for (j = 0; j < 8; j++)
+                        value[length++] = bits64 >> (56 - 8 * j);
+                    break;
+                case TYPE_BOOL:
+                    value[length++] = data[0] != 0;
+                    break;
+                default:
+                    //trailing zero bytes are not a part of a varchar value
+                    while (value_size > 0 && data[value_size - 1] == '\0')
+                        value_size--;
+                    if (value_size > MAX_VARCHAR_LENGTH)
+                        value_size = MAX_VARCHAR_LENGTH;
+                    memcpy(value + length, data, value_size);
+                    length += value_size;
+                    value[length++] = 0;
+                    break;
+            }
+        }
+        if (keys->descending[i])
+            for (j = 0; j < length; j++)
+                value[j] = ~value[j];
+        if (length > size - written)
+            length = size - written;
+        memcpy(key + written, value, length);
+        written += length;
+    }
+    memset(key + written, 0, size - written);
+}
 
-	for (i = 0; i < num_records - 1; i++) {
-		for (j = i + 1; j < num_records; j++) {
-			//first data -> x
-			address = real_table->block->tuple_dict[(temp_field[i] * num_headers) + num_sort_header].address;
-			size = real_table->block->tuple_dict[(temp_field[i] * num_headers) + num_sort_header].size;
-			memset(x, '\0', MAX_VARCHAR_LENGTH);
-			memcpy(x, real_table->block->data + address, size);
-			//second data -> y
-			address = real_table->block->tuple_dict[(temp_field[j] * num_headers) + num_sort_header].address;
-			size = real_table->block->tuple_dict[(temp_field[j] * num_headers) + num_sort_header].size;
-			memset(y, '\0', MAX_VARCHAR_LENGTH);
-			memcpy(y, real_table->block->data + address, size);
-
-			//comparison (x > y) ASC
-			if (strcmp(x, y) >= 0) {
-				temp=temp_field[i];
-				temp_field[i]=temp_field[j];
-				temp_field[j]=temp;
-			}//end: if(strcmp(x,y) >= 0)
-		}
-	}
+/**
+ * @author Karlo Vuković
+ * @brief Function that compares two rows given by their entries by the sort attributes
+ * @param keys sort attributes
+ * @param left entries of the first row
+ * @param left_data bytes the addresses of the first entries point into
+ * @param right entries of the second row
+ * @param right_data bytes the addresses of the second entries point into
+ * @return negative number if the first row comes first, 0 if the rows are equal, otherwise positive number
+ */
+static int AK_sort_compare_entries(AK_sort_keys *keys, AK_tuple_dict *left, char *left_data, AK_tuple_dict *right,
+                                   char *right_data) {
+    AK_tuple_dict *left_entry, *right_entry;
+    int i, result, left_null, right_null;
+
+    for (i = 0; i < keys->num_keys; i++) {
+        left_entry = &left[keys->attribute[i]];
+        right_entry = &right[keys->attribute[i]];
+        //nulls come first, as in the normalized key
+        left_null = AK_sort_entry_null(keys, i, left_entry);
+        right_null = AK_sort_entry_null(keys, i, right_entry);
+        if (left_null || right_null)
+            result = right_null - left_null;
+        else
+            result = AK_compare_values(keys->type[i], left_data + left_entry->address, left_entry->size,
+                                       right_data + right_entry->address, right_entry->size);
+        if (result != 0)
+            return keys->descending[i] ? -result : result;
+    }
+    return 0;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that compares two rows by the sort attributes
+ * @param keys sort attributes
+ * @param left_block block that holds the first row
+ * @param left first entry of the first row in the tuple dictionary
+ * @param right_block block that holds the second row
+ * @param right first entry of the second row in the tuple dictionary
+ * @return negative number if the first row comes first, 0 if the rows are equal, otherwise positive number
+ */
+int AK_sort_compare_keys(AK_sort_keys *keys, AK_block *left_block, int left, AK_block *right_block, int right) {
+    return AK_sort_compare_entries(keys, &left_block->tuple_dict[left], (char *) left_block->data,
+                                   &right_block->tuple_dict[right], (char *) right_block->data);
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that compares two rows held in memory. Prefixes of the normalized keys are compared first and
+ *        the attributes only if the prefixes are equal. Rows with equal attributes are compared by their place in
+ *        memory, which is the order they were read in, so the sort is stable.
+ * @param left first row
+ * @param right second row
+ * @param blocks blocks that hold the rows
+ * @param keys sort attributes
+ * @return negative number if the first row comes first, otherwise positive number
+ */
+static int AK_sort_row_compare(AK_sort_row *left, AK_sort_row *right, AK_block *blocks, AK_sort_keys *keys) {
+    int result = memcmp(left->key, right->key, SORT_KEY_PREFIX);
+
+    if (result == 0)
+        result = AK_sort_compare_keys(keys, &blocks[left->block], left->tuple, &blocks[right->block], right->tuple);
+    if (result == 0)
+        result = left->block != right->block ? left->block - right->block : left->tuple - right->tuple;
+    return result;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that sorts rows whose whole normalized key is held in memory with an LSD radix sort, one byte of
+ *        the key at a time from the last one. Bytes that are equal in all rows are skipped.
+ * @param rows rows to sort
+ * @param temp array of the same size used while sorting
+ * @param num_rows number of rows
+ * @param width length of the normalized key
+ * @return No return value
+ */
+static void AK_sort_radix(AK_sort_row *rows, AK_sort_row *temp, int num_rows, int width) {
+    AK_sort_row *from = rows, *to = temp, *swap;
+    int count[256], position, i, byte;
+
+    for (byte = width - 1; byte >= 0; byte--) {
+        memset(count, 0, sizeof (count));
+        for (i = 0; i < num_rows; i++)
+            count[from[i].key[byte]]++;
+        if (count[from[0].key[byte]] == num_rows)
+            continue;
+        for (i = 0, position = 0; i < 256; i++) {
+            position += count[i];
+            count[i] = position - count[i];
+        }
+        for (i = 0; i < num_rows; i++)
+            to[count[from[i].key[byte]]++] = from[i];
+        swap = from;
+        from = to;
+        to = swap;
+    }
+    if (from != rows)
+        memcpy(rows, from, num_rows * sizeof (AK_sort_row));
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that moves a row down the heap until it is larger than its children
+ * @param rows heap
+ * @param num_rows number of rows in the heap
+ * @param node row that moves down
+ * @param blocks blocks that hold the rows
+ * @param keys sort attributes
+ * @return No return value
+ */
+static void AK_sort_heap_down(AK_sort_row *rows, int num_rows, int node, AK_block *blocks, AK_sort_keys *keys) {
+    AK_sort_row row = rows[node];
+    int child;
+
+    while ((child = 2 * node + 1) < num_rows) {
+        if (child + 1 < num_rows && AK_sort_row_compare(&rows[child + 1], &rows[child], blocks, keys) > 0)
+            child++;
+        if (AK_sort_row_compare(&rows[child], &row, blocks, keys) <= 0)
+            break;
+        rows[node] = rows[child];
+        node = child;
+    }
+    rows[node] = row;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that sorts rows with introsort. Quicksort with the median of three rows is used until depth
+ *        reaches 0, then heapsort, and parts smaller than SORT_INSERTION_SIZE rows are sorted with insertion sort.
+ * @param rows rows to sort
+ * @param num_rows number of rows
+ * @param depth number of partitions left before the sort turns to heapsort
+ * @param blocks blocks that hold the rows
+ * @param keys sort attributes
+ * @return No return value
+ */
+static void AK_sort_introsort(AK_sort_row *rows, int num_rows, int depth, AK_block *blocks, AK_sort_keys *keys) {
+    AK_sort_row pivot, swap;
+    int i, j, middle;
+
+    while (num_rows > SORT_INSERTION_SIZE) {
+        if (depth-- == 0) {
+            for (i = num_rows / 2 - 1; i >= 0; i--)
+                AK_sort_heap_down(rows, num_rows, i, blocks, keys);
+            for (i = num_rows - 1; i > 0; i--) {
+                swap = rows[0];
+                rows[0] = rows[i];
+                rows[i] = swap;
+                AK_sort_heap_down(rows, i, 0, blocks, keys);
+            }
+            return;
+        }
+
+        //the median of the first, the middle and the last row becomes the pivot in rows[0]
+        middle = num_rows / 2;
+        if (AK_sort_row_compare(&rows[middle], &rows[0], blocks, keys) < 0) {
+            swap = rows[middle]; rows[middle] = rows[0]; rows[0] = swap;
+        }
+        if (AK_sort_row_compare(&rows[num_rows - 1], &rows[middle], blocks, keys) < 0) {
+            swap = rows[num_rows - 1]; rows[num_rows - 1] = rows[middle]; rows[middle] = swap;
+            if (AK_sort_row_compare(&rows[middle], &rows[0], blocks, keys) < 0) {
+                swap = rows[middle]; rows[middle] = rows[0]; rows[0] = swap;
+            }
+        }
+        swap = rows[middle]; rows[middle] = rows[0]; rows[0] = swap;
+        pivot = rows[0];
+
+        i = 0;
+        j = num_rows;
+        for (;;) {
+            do i++; while (i < num_rows && AK_sort_row_compare(&rows[i], &pivot, blocks, keys) < 0);
+            do j--; while (AK_sort_row_compare(&rows[j], &pivot, blocks, keys) > 0);
+            if (i >= j)
+                break;
+            swap = rows[i]; rows[i] = rows[j]; rows[j] = swap;
+        }
+        rows[0] = rows[j];
+        rows[j] = pivot;
+
+        //the smaller part is sorted first, so the recursion stays shallow
+        if (j < num_rows - j - 1) {
+            AK_sort_introsort(rows, j, depth, blocks, keys);
+            rows += j + 1;
+            num_rows -= j + 1;
+        } else {
+            AK_sort_introsort(rows + j + 1, num_rows - j - 1, depth, blocks, keys);
+            num_rows = j;
+        }
+    }
+
+    for (i = 1; i < num_rows; i++) {
+        swap = rows[i];
+        for (j = i; j > 0 && AK_sort_row_compare(&rows[j - 1], &swap, blocks, keys) > 0; j--)
+            rows[j] = rows[j - 1];
+        rows[j] = swap;
+    }
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that sorts rows held in memory. Rows are sorted with AK_sort_radix if their whole normalized key
+ *        fits into the prefix, otherwise with AK_sort_introsort. Rows with equal values keep the order they were
+ *        read in.
+ * @param rows rows to sort
+ * @param temp array of the same size used while sorting
+ * @param num_rows number of rows
+ * @param blocks blocks that hold the rows
+ * @param keys sort attributes
+ * @return No return value
+ */
+static void AK_sort_rows(AK_sort_row *rows, AK_sort_row *temp, int num_rows, AK_block *blocks, AK_sort_keys *keys) {
+    int depth = 0, i;
+
+    if (num_rows < 2)
+        return;
+    if (keys->fixed_width > 0) {
+        AK_sort_radix(rows, temp, num_rows, keys->fixed_width);
+        return;
+    }
+    for (i = num_rows; i > 1; i /= 2)
+        depth += 2;
+    AK_sort_introsort(rows, num_rows, depth, blocks, keys);
+}
+
+/**
+ * @author Karlo Vuković
+ * @struct AK_sort_task
+ * @brief Structure that holds the work of one thread of the sort. A thread sorts a part of the rows, or writes
+ *        the rows from begin to end of the merge of two sorted parts.
+ */
+typedef struct {
+    /// rows to sort, or the first sorted part
+    AK_sort_row *rows;
+    /// array used while sorting, or the second sorted part
+    AK_sort_row *temp;
+    /// merged rows
+    AK_sort_row *to;
+    /// number of rows to sort, or rows in the first part
+    int num_rows;
+    /// number of rows in the second part
+    int num_second;
+    /// first merged row the thread writes
+    int begin;
+    /// row after the last merged row the thread writes
+    int end;
+    /// blocks that hold the rows
+    AK_block *blocks;
+    /// sort attributes
+    AK_sort_keys *keys;
+} AK_sort_task;
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that sorts the part of the rows given to a thread
+ * @param task work of the thread
+ * @return NULL
+ */
+static void *AK_sort_task_sort(void *task) {
+    AK_sort_task *part = (AK_sort_task *) task;
+
+    AK_sort_rows(part->rows, part->temp, part->num_rows, part->blocks, part->keys);
+    return NULL;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that finds how many of the first k merged rows come from the first part
+ * @param k number of merged rows
+ * @param first first sorted part
+ * @param num_first number of rows in the first part
+ * @param second second sorted part
+ * @param num_second number of rows in the second part
+ * @param blocks blocks that hold the rows
+ * @param keys sort attributes
+ * @return number of rows from the first part
+ */
+static int AK_sort_co_rank(int k, AK_sort_row *first, int num_first, AK_sort_row *second, int num_second,
+                           AK_block *blocks, AK_sort_keys *keys) {
+    int low = k > num_second ? k - num_second : 0, high = k < num_first ? k : num_first, middle;
+
+    while (low < high) {
+        middle = (low + high) / 2;
+        if (AK_sort_row_compare(&first[middle], &second[k - middle - 1], blocks, keys) < 0)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    return low;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that writes the rows from begin to end of the merge of two sorted parts. Rows are never equal,
+ *        so threads that merge other rows of the same parts agree on where their rows start.
+ * @param task work of the thread
+ * @return NULL
+ */
+static void *AK_sort_task_merge(void *task) {
+    AK_sort_task *part = (AK_sort_task *) task;
+    int i, j, k, i_end, j_end;
+
+    i = AK_sort_co_rank(part->begin, part->rows, part->num_rows, part->temp, part->num_second, part->blocks, part->keys);
+    i_end = AK_sort_co_rank(part->end, part->rows, part->num_rows, part->temp, part->num_second, part->blocks, part->keys);
+    j = part->begin - i;
+    j_end = part->end - i_end;
+    for (k = part->begin; k < part->end; k++) {
+        if (i < i_end && (j >= j_end || AK_sort_row_compare(&part->rows[i], &part->temp[j], part->blocks, part->keys) < 0))
+            part->to[k] = part->rows[i++];
+        else
+            part->to[k] = part->temp[j++];
+    }
+    return NULL;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that runs the work of the threads and waits until all of it is done. Work of a thread that can
+ *        not be started is done by the calling thread.
+ * @param work function each thread runs
+ * @param tasks work of the threads
+ * @param num_tasks number of threads
+ * @return No return value
+ */
+static void AK_sort_run_tasks(void *(*work)(void *), AK_sort_task *tasks, int num_tasks) {
+    pthread_t *threads;
+    int *started;
+    int i;
+
+    threads = (pthread_t *) AK_malloc(num_tasks * sizeof (pthread_t));
+    started = (int *) AK_calloc(num_tasks, sizeof (int));
+    //the calling thread does the first part itself
+    for (i = 1; i < num_tasks; i++)
+        started[i] = pthread_create(&threads[i], NULL, work, &tasks[i]) == 0;
+    work(&tasks[0]);
+    for (i = 1; i < num_tasks; i++) {
+        if (started[i])
+            pthread_join(threads[i], NULL);
+        else
+            work(&tasks[i]);
+    }
+    AK_free(threads);
+    AK_free(started);
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that sorts rows held in memory with more threads. Rows are split into equal parts that are sorted
+ *        at the same time with AK_sort_rows. Sorted parts are then merged in pairs until one is left, and each merge
+ *        is split among the threads by positions in the merged rows, so all threads work in every round. Rows come
+ *        out in the same order as with one thread.
+ * @param rows rows to sort
+ * @param temp array of the same size used while sorting
+ * @param num_rows number of rows
+ * @param blocks blocks that hold the rows
+ * @param keys sort attributes
+ * @param threads number of threads, each gets at least SORT_PARALLEL_MIN_ROWS rows
+ * @return No return value
+ */
+static void AK_sort_rows_parallel(AK_sort_row *rows, AK_sort_row *temp, int num_rows, AK_block *blocks,
+                                  AK_sort_keys *keys, int threads) {
+    AK_sort_task *tasks;
+    AK_sort_row *from = rows, *to = temp, *swap;
+    int *bounds;
+    int parts, width, pairs, pieces, num_tasks, left, middle, right, i, j;
+
+    parts = threads < num_rows / SORT_PARALLEL_MIN_ROWS ? threads : num_rows / SORT_PARALLEL_MIN_ROWS;
+    if (parts < 2) {
+        AK_sort_rows(rows, temp, num_rows, blocks, keys);
+        return;
+    }
+
+    tasks = (AK_sort_task *) AK_calloc(threads, sizeof (AK_sort_task));
+    bounds = (int *) AK_malloc((parts + 1) * sizeof (int));
+    for (i = 0; i <= parts; i++)
+        bounds[i] = (int) ((long long) num_rows * i / parts);
+    for (i = 0; i < parts; i++) {
+        tasks[i].rows = rows + bounds[i];
+        tasks[i].temp = temp + bounds[i];
+        tasks[i].num_rows = bounds[i + 1] - bounds[i];
+        tasks[i].blocks = blocks;
+        tasks[i].keys = keys;
+    }
+    AK_sort_run_tasks(AK_sort_task_sort, tasks, parts);
+
+    for (width = 1; width < parts; width *= 2) {
+        pairs = (parts + 2 * width - 1) / (2 * width);
+        pieces = threads / pairs > 1 ? threads / pairs : 1;
+        num_tasks = 0;
+        for (i = 0; i < parts; i += 2 * width) {
+            left = bounds[i];
+            middle = bounds[i + width < parts ? i + width : parts];
+            right = bounds[i + 2 * width < parts ? i + 2 * width : parts];
+            if (middle == right) {
+                //the last part has no pair in this round
+                memcpy(to + left, from + left, (right - left) * sizeof (AK_sort_row));
+                continue;
+            }
+            for (j = 0; j < pieces; j++) {
+                tasks[num_tasks].rows = from + left;
+                tasks[num_tasks].num_rows = middle - left;
+                tasks[num_tasks].temp = from + middle;
+                tasks[num_tasks].num_second = right - middle;
+                tasks[num_tasks].to = to + left;
+                tasks[num_tasks].begin = (int) ((long long) (right - left) * j / pieces);
+                tasks[num_tasks].end = (int) ((long long) (right - left) * (j + 1) / pieces);
+                tasks[num_tasks].blocks = blocks;
+                tasks[num_tasks].keys = keys;
+                num_tasks++;
+            }
+        }
+        AK_sort_run_tasks(AK_sort_task_merge, tasks, num_tasks);
+        swap = from;
+        from = to;
+        to = swap;
+    }
+    if (from != rows)
+        memcpy(rows, from, num_rows * sizeof (AK_sort_row));
+
+    AK_free(tasks);
+    AK_free(bounds);
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that moves the cursor to the next row of the run. The current block is copied, so it stays valid
+ *        while blocks of other runs are read.
+ * @param cursor cursor
+ * @param num_attr number of attributes
+ * @return No return value
+ */
+static void AK_sort_cursor_next(AK_sort_cursor *cursor, int num_attr) {
+    while (cursor->extent < MAX_EXTENTS_IN_SEGMENT && cursor->addresses->address_from[cursor->extent] != 0) {
+        if (cursor->tuple < 0) {
+            if (cursor->address >= cursor->addresses->address_to[cursor->extent]) {
+                cursor->extent++;
+                if (cursor->extent < MAX_EXTENTS_IN_SEGMENT)
+                    cursor->address = cursor->addresses->address_from[cursor->extent];
+                continue;
+            }
+            memcpy(cursor->block, AK_get_block(cursor->address)->block, sizeof (AK_block));
+            //rows of a run are kept at the beginning of each extent
+            if (cursor->block->last_tuple_dict_id == 0) {
+                cursor->address = cursor->addresses->address_to[cursor->extent];
+                continue;
+            }
+            cursor->tuple = 0;
+        } else {
+            cursor->tuple += num_attr;
+        }
+        for (; cursor->tuple + num_attr <= DATA_BLOCK_SIZE; cursor->tuple += num_attr) {
+            if (cursor->block->tuple_dict[cursor->tuple].size > 0)
+                return;
+        }
+        cursor->tuple = -1;
+        cursor->address++;
+    }
+    cursor->done = 1;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that checks if the row of the first run has to be written before the row of the second run.
+ *        A finished run comes after all others and k stands for a run that comes before all others, it is used
+ *        while the loser tree is built.
+ * @param cursors cursors of the runs
+ * @param k number of runs
+ * @param first first run
+ * @param second second run
+ * @param keys sort attributes
+ * @return 1 if the row of the first run comes first, otherwise 0
+ */
+static int AK_sort_merge_before(AK_sort_cursor *cursors, int k, int first, int second, AK_sort_keys *keys) {
+    int result;
+
+    if (first == k || second == k)
+        return first == k;
+    if (cursors[first].done || cursors[second].done)
+        return cursors[second].done && !cursors[first].done;
+    result = AK_sort_compare_keys(keys, cursors[first].block, cursors[first].tuple, cursors[second].block, cursors[second].tuple);
+    //runs are numbered in the order of the table, which keeps the merge stable
+    return result < 0 || (result == 0 && first < second);
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that plays the run again up the loser tree after its row changed
+ * @param tree loser tree, tree[0] is the run with the next row and other nodes hold runs that lost there
+ * @param cursors cursors of the runs
+ * @param k number of runs
+ * @param run run whose row changed
+ * @param keys sort attributes
+ * @return No return value
+ */
+static void AK_sort_merge_adjust(int *tree, AK_sort_cursor *cursors, int k, int run, AK_sort_keys *keys) {
+    int node, swap;
+
+    for (node = (run + k) / 2; node > 0; node /= 2) {
+        if (AK_sort_merge_before(cursors, k, tree[node], run, keys)) {
+            swap = tree[node];
+            tree[node] = run;
+            run = swap;
+        }
+    }
+    tree[0] = run;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that merges sorted runs into the table with a loser tree. Each run needs one block of memory.
+ *        Merged runs are deleted.
+ * @param runs names of the runs
+ * @param k number of runs
+ * @param tblName table the rows are written to
+ * @param num_attr number of attributes
+ * @param keys sort attributes
+ * @return number of written rows, EXIT_ERROR if a row could not be written
+ */
+static int AK_sort_merge_runs(char (*runs)[MAX_ATT_NAME], int k, char *tblName, int num_attr, AK_sort_keys *keys) {
+    AK_sort_cursor *cursors;
+    AK_bulk_writer writer;
+    int *tree;
+    int i, run, result = EXIT_SUCCESS;
+
+    cursors = (AK_sort_cursor *) AK_calloc(k, sizeof (AK_sort_cursor));
+    tree = (int *) AK_malloc(k * sizeof (int));
+    for (i = 0; i < k; i++) {
+        cursors[i].addresses = AK_get_table_addresses(runs[i]);
+        cursors[i].address = cursors[i].addresses->address_from[0];
+        cursors[i].tuple = -1;
+        cursors[i].block = (AK_block *) AK_malloc(sizeof (AK_block));
+        AK_sort_cursor_next(&cursors[i], num_attr);
+        tree[i] = k;
+    }
+    for (i = k - 1; i >= 0; i--)
+        AK_sort_merge_adjust(tree, cursors, k, i, keys);
+
+    AK_bulk_writer_open(&writer, tblName);
+    while (!cursors[tree[0]].done) {
+        run = tree[0];
+        if (AK_bulk_write_row(&writer, cursors[run].block, cursors[run].tuple, num_attr) == EXIT_ERROR) {
+            result = EXIT_ERROR;
+            break;
+        }
+        AK_sort_cursor_next(&cursors[run], num_attr);
+        AK_sort_merge_adjust(tree, cursors, k, run, keys);
+    }
+    if (result != EXIT_ERROR)
+        result = writer.num_rows;
+    AK_bulk_writer_close(&writer);
+
+    for (i = 0; i < k; i++) {
+        AK_free(cursors[i].addresses);
+        AK_free(cursors[i].block);
+        AK_delete_segment(runs[i], SEGMENT_TYPE_TABLE);
+    }
+    AK_free(cursors);
+    AK_free(tree);
+    return result;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that sorts the rows held in memory and writes them as one run
+ * @param rows rows held in memory
+ * @param temp array of the same size used while sorting
+ * @param num_rows number of rows
+ * @param blocks blocks that hold the rows
+ * @param tblName table the run is written to
+ * @param num_attr number of attributes
+ * @param keys sort attributes
+ * @param threads number of threads that sort the rows
+ * @return number of written rows, EXIT_ERROR if a row could not be written
+ */
+static int AK_sort_write_run(AK_sort_row *rows, AK_sort_row *temp, int num_rows, AK_block *blocks, char *tblName,
+                             int num_attr, AK_sort_keys *keys, int threads) {
+    AK_bulk_writer writer;
+    int i, result;
+
+    AK_sort_rows_parallel(rows, temp, num_rows, blocks, keys, threads);
+    AK_bulk_writer_open(&writer, tblName);
+    for (i = 0; i < num_rows; i++) {
+        if (AK_bulk_write_row(&writer, &blocks[rows[i].block], rows[i].tuple, num_attr) == EXIT_ERROR)
+            break;
+    }
+    result = i < num_rows ? EXIT_ERROR : writer.num_rows;
+    AK_bulk_writer_close(&writer);
+    return result;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that sorts a table that does not have to fit into memory. Blocks of the table are read into
+ *        memory_blocks blocks of memory, rows in memory are sorted and written as a run into a temporary table.
+ *        Runs are then merged with a loser tree, memory_blocks - 1 runs at a time, until one is left. A table that
+ *        fits into memory is written to destTable directly. Rows are packed into blocks of destTable with
+ *        AK_bulk_write_row and the sort is stable.
+ * @param srcTable name of the table to sort
+ * @param destTable name of the new sorted table
+ * @param attributes list of sort attributes, as in AK_sort_keys_init
+ * @param memory_blocks number of blocks the sort can hold in memory, at least 3
+ * @param threads number of threads that sort rows in memory, 0 or less for all cores
+ * @return EXIT_SUCCESS, EXIT_ERROR if the table or an attribute does not exist or rows could not be written
+ */
+int AK_external_sort(char *srcTable, char *destTable, struct list_node *attributes, int memory_blocks, int threads) {
+    table_addresses *addresses;
+    AK_header *header;
+    AK_block *blocks, *block;
+    AK_sort_row *rows, *temp;
+    char (*runs)[MAX_ATT_NAME] = NULL;
+    AK_sort_keys keys;
+    int num_attr, rows_per_block, num_rows = 0, num_blocks = 0, num_runs = 0, run_id = 0;
+    int i, j, k, first, written = 0, result = EXIT_SUCCESS;
+    AK_PRO;
+
+    addresses = AK_get_table_addresses(srcTable);
+    num_attr = AK_num_attr(srcTable);
+    if (addresses->address_from[0] == 0 || num_attr <= 0 || attributes == NULL || AK_First_L2(attributes) == NULL) {
+        printf("AK_external_sort: Table %s does not exist!\n", srcTable);
+        AK_free(addresses);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+
+    header = AK_sort_get_header(srcTable, num_attr);
+    if (AK_sort_keys_init(&keys, header, attributes) == EXIT_ERROR) {
+        printf("AK_external_sort: Table %s can not be sorted by the given attributes!\n", srcTable);
+        AK_free(header);
+        AK_free(addresses);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+
+    AK_initialize_new_segment(destTable, SEGMENT_TYPE_TABLE, header);
+
+    if (memory_blocks < 3)
+        memory_blocks = 3;
+    if (threads < 1)
+        threads = sysconf(_SC_NPROCESSORS_ONLN) > 0 ? (int) sysconf(_SC_NPROCESSORS_ONLN) : 1;
+    rows_per_block = DATA_BLOCK_SIZE / num_attr;
+    blocks = (AK_block *) AK_malloc(memory_blocks * sizeof (AK_block));
+    rows = (AK_sort_row *) AK_malloc(memory_blocks * rows_per_block * sizeof (AK_sort_row));
+    temp = (AK_sort_row *) AK_malloc(memory_blocks * rows_per_block * sizeof (AK_sort_row));
+
+    //RUNS: blocks are read until the memory is full, then the rows in memory are sorted and written as a run
+    for (i = 0; i < MAX_EXTENTS_IN_SEGMENT && addresses->address_from[i] != 0 && result != EXIT_ERROR; i++) {
+        for (j = addresses->address_from[i]; j < addresses->address_to[i]; j++) {
+            block = AK_get_block(j)->block;
+            if (block->last_tuple_dict_id == 0)
+                break;
+            memcpy(&blocks[num_blocks], block, sizeof (AK_block));
+            for (k = 0; k + num_attr <= DATA_BLOCK_SIZE; k += num_attr) {
+                if (blocks[num_blocks].tuple_dict[k].size > 0) {
+                    rows[num_rows].block = num_blocks;
+                    rows[num_rows].tuple = k;
+                    AK_sort_key_normalize(&keys, &blocks[num_blocks], k, rows[num_rows].key, SORT_KEY_PREFIX);
+                    num_rows++;
+                }
+            }
+            num_blocks++;
+
+            if (num_blocks == memory_blocks) {
+                runs = AK_realloc(runs, (num_runs + 1) * sizeof (*runs));
+                snprintf(runs[num_runs], MAX_ATT_NAME, "%s__run%d", destTable, run_id++);
+                AK_initialize_new_segment(runs[num_runs], SEGMENT_TYPE_TABLE, header);
+                if (AK_sort_write_run(rows, temp, num_rows, blocks, runs[num_runs], num_attr, &keys, threads) == EXIT_ERROR)
+                    result = EXIT_ERROR;
+                num_runs++;
+                num_rows = num_blocks = 0;
+                if (result == EXIT_ERROR)
+                    break;
+            }
+        }
+    }
+
+    if (result != EXIT_ERROR && num_runs == 0) {
+        //the whole table fits into memory
+        written = AK_sort_write_run(rows, temp, num_rows, blocks, destTable, num_attr, &keys, threads);
+    } else if (result != EXIT_ERROR) {
+        if (num_rows > 0) {
+            runs = AK_realloc(runs, (num_runs + 1) * sizeof (*runs));
+            snprintf(runs[num_runs], MAX_ATT_NAME, "%s__run%d", destTable, run_id++);
+            AK_initialize_new_segment(runs[num_runs], SEGMENT_TYPE_TABLE, header);
+            if (AK_sort_write_run(rows, temp, num_rows, blocks, runs[num_runs], num_attr, &keys, threads) == EXIT_ERROR)
+                result = EXIT_ERROR;
+            num_runs++;
+        }
 
-	for (i = 0; i<num_records; i++) {
-		//initialize a new row
-		struct list_node *row_root = (struct list_node *) AK_malloc(sizeof (struct list_node));
-		AK_Init_L3(&row_root);
-		for (j = 0; j < num_headers; j++) {
-			//get data from column 'j' orginal table -> data
-			address = real_table->block->tuple_dict[j + (temp_field[i] * num_headers)].address;
-			size = real_table->block->tuple_dict[j + (temp_field[i] * num_headers)].size;
-			type = real_table->block->tuple_dict[j + (temp_field[i] * num_headers)].type;
-			memset(data, '\0', MAX_VARCHAR_LENGTH);
-			memcpy(data, real_table->block->data + address, size);
-			//add column 'j' data into struct row_root
-			AK_Insert_New_Element(type, data, destTable, real_table->block->header[j].att_name, row_root);
+        //MERGE: groups of runs are merged into longer runs while there are more runs than blocks of memory
+        first = 0;
+        while (result != EXIT_ERROR && num_runs - first > memory_blocks - 1) {
+            k = memory_blocks - 1;
+            runs = AK_realloc(runs, (num_runs + 1) * sizeof (*runs));
+            snprintf(runs[num_runs], MAX_ATT_NAME, "%s__run%d", destTable, run_id++);
+            AK_initialize_new_segment(runs[num_runs], SEGMENT_TYPE_TABLE, header);
+            if (AK_sort_merge_runs(runs + first, k, runs[num_runs], num_attr, &keys) == EXIT_ERROR)
+                result = EXIT_ERROR;
+            num_runs++;
+            first += k;
+        }
+        if (result != EXIT_ERROR)
+            written = AK_sort_merge_runs(runs + first, num_runs - first, destTable, num_attr, &keys);
+        else
+            for (; first < num_runs; first++)
+                AK_delete_segment(runs[first], SEGMENT_TYPE_TABLE);
+    }
+    if (written == EXIT_ERROR)
+        result = EXIT_ERROR;
+
+    if (result != EXIT_ERROR && written > 0) {
+        AK_add_to_redolog_bulk(destTable, written);
+        AK_redolog_commit();
+    }
+
+    AK_free(runs);
+    AK_free(blocks);
+    AK_free(rows);
+    AK_free(temp);
+    AK_free(header);
+    AK_free(addresses);
+    AK_EPI;
+    return result;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that writes the rows of a table into a new table in the order of a B+tree index, without sorting
+ *        them. The index has to have exactly the sort attributes as its key, all of them ascending, and it has to
+ *        hold every row of the table, so a table with nulls in the key is sorted in the usual way. Rows with equal
+ *        keys come in the order of the table, as after a stable sort.
+ * @param srcTable name of the table to sort
+ * @param destTable name of the new sorted table
+ * @param attributes list of sort attributes, as in AK_sort_keys_init
+ * @return number of written rows, EXIT_ERROR if rows could not be written, -2 if there is no such index and the
+ *         table has to be sorted
+ */
+static int AK_sort_by_index(char *srcTable, char *destTable, struct list_node *attributes) {
+    AK_index_description indexes[INDEX_MAX_PER_TABLE];
+    AK_btree_meta meta;
+    AK_btree_cursor cursor;
+    AK_btree_rid rid;
+    AK_bulk_writer writer;
+    AK_header *header;
+    AK_block *block;
+    AK_sort_keys keys;
+    int num_attr, num_indexes, i, j, address = 0, result = EXIT_SUCCESS;
+
+    num_attr = AK_num_attr(srcTable);
+    if (num_attr <= 0 || attributes == NULL)
+        return -2;
+    header = AK_sort_get_header(srcTable, num_attr);
+    if (AK_sort_keys_init(&keys, header, attributes) == EXIT_ERROR) {
+        AK_free(header);
+        return -2;
+    }
+    for (i = 0; i < keys.num_keys && !keys.descending[i]; i++)
+        ;
+    num_indexes = i < keys.num_keys ? 0 : AK_index_get_descriptions(srcTable, indexes, INDEX_MAX_PER_TABLE);
+    for (i = 0; i < num_indexes; i++) {
+        if (indexes[i].kind != BLOCK_TYPE_BTREE || indexes[i].num_attr != keys.num_keys)
+            continue;
+        for (j = 0; j < keys.num_keys && indexes[i].attribute[j] == keys.attribute[j]; j++)
+            ;
+        //values that are not indexed, like nulls, would be missing from the result
+        if (j == keys.num_keys && AK_btree_get_meta(indexes[i].name, &meta) == EXIT_SUCCESS &&
+            meta.num_entries == AK_get_num_records(srcTable))
+            break;
+    }
+    if (i >= num_indexes || AK_btree_cursor_open(&cursor, indexes[i].name) == EXIT_ERROR) {
+        AK_free(header);
+        return -2;
+    }
+
+    AK_initialize_new_segment(destTable, SEGMENT_TYPE_TABLE, header);
+    //the block of the row is copied, as the writer may push it out of the cache
+    block = (AK_block *) AK_malloc(sizeof (AK_block));
+    AK_bulk_writer_open(&writer, destTable);
+    while (AK_btree_cursor_next(&cursor, &rid) == EXIT_SUCCESS) {
+        if (rid.block != address) {
+            memcpy(block, AK_get_block(rid.block)->block, sizeof (AK_block));
+            address = rid.block;
+        }
+        if (AK_bulk_write_row(&writer, block, rid.tuple, num_attr) == EXIT_ERROR) {
+            result = EXIT_ERROR;
+            break;
+        }
+    }
+    if (result != EXIT_ERROR)
+        result = writer.num_rows;
+    AK_bulk_writer_close(&writer);
+    AK_btree_cursor_close(&cursor);
+    AK_free(block);
+    AK_free(header);
+    return result;
+}
+
+/**
+ * @author Tomislav Bobinac, updated by Filip Žmuk, updated by Karlo Vuković (external merge sort, multiple
+ *         attributes with ASC|DESC ordering, order of B+tree indexes)
+ * @brief Function that sorts a segment. If a B+tree index of the table has the sort attributes as its key, rows are
+ *        read in its order with AK_sort_by_index, otherwise they are sorted with AK_external_sort, holding at most
+ *        SORT_MEMORY_BLOCKS blocks in memory and sorting them with SORT_THREADS threads
+ * @param srcTable name of the table to sort
+ * @param destTable name of the new sorted table
+ * @param attributes list of sort attributes, as in AK_sort_keys_init
+ * @return EXIT_SUCCESS, EXIT_ERROR if the table could not be sorted
+ */
+int AK_sort_segment(char *srcTable, char *destTable, struct list_node* attributes) {
+	int result;
+	AK_PRO;
+	result = AK_sort_by_index(srcTable, destTable, attributes);
+	if (result == -2) {
+		result = AK_external_sort(srcTable, destTable, attributes, SORT_MEMORY_BLOCKS, SORT_THREADS);
+	} else if (result != EXIT_ERROR) {
+		if (result > 0) {
+			AK_add_to_redolog_bulk(destTable, result);
+			AK_redolog_commit();
 		}
-		//add row to new sorted table
-		AK_insert_row(row_root);
-		AK_DeleteAll_L3(&row_root);
+		result = EXIT_SUCCESS;
 	}
-
 	AK_EPI;
-	return EXIT_SUCCESS;
+	return result;
+}
+
+/**
+ * @author Karlo Vuković
+ * @struct AK_top_n_row
+ * @brief Structure that holds a row kept by AK_top_n. A row of a block can be used in its place without a copy, by
+ *        pointing entries to the tuple dictionary and data to the data of the block.
+ */
+typedef struct {
+    /// beginning of the normalized key of the row
+    unsigned char key[SORT_KEY_PREFIX];
+    /// position of the row in the table
+    int sequence;
+    /// entries of the row, their addresses point into data
+    AK_tuple_dict *entries;
+    /// values of the row
+    char *data;
+    /// size of data
+    int capacity;
+} AK_top_n_row;
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that compares two rows kept by AK_top_n. Rows with equal values are compared by their position
+ *        in the table, so the rows that are kept are the first rows a stable sort would return.
+ * @param keys sort attributes
+ * @param left first row
+ * @param right second row
+ * @return negative number if the first row comes first, otherwise positive number
+ */
+static int AK_top_n_compare(AK_sort_keys *keys, AK_top_n_row *left, AK_top_n_row *right) {
+    int result = memcmp(left->key, right->key, SORT_KEY_PREFIX);
+
+    if (result == 0)
+        result = AK_sort_compare_entries(keys, left->entries, left->data, right->entries, right->data);
+    if (result == 0)
+        result = left->sequence - right->sequence;
+    return result;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that copies a row into a place of the heap
+ * @param row place in the heap
+ * @param source row that is copied
+ * @param num_attr number of attributes
+ * @return No return value
+ */
+static void AK_top_n_copy(AK_top_n_row *row, AK_top_n_row *source, int num_attr) {
+    int i, size = 0;
+
+    for (i = 0; i < num_attr; i++)
+        size += source->entries[i].size > 0 ? source->entries[i].size : 0;
+    if (size > row->capacity) {
+        row->data = AK_realloc(row->data, size);
+        row->capacity = size;
+    }
+    memcpy(row->key, source->key, SORT_KEY_PREFIX);
+    row->sequence = source->sequence;
+    for (i = 0, size = 0; i < num_attr; i++) {
+        row->entries[i] = source->entries[i];
+        row->entries[i].address = size;
+        if (source->entries[i].size > 0) {
+            memcpy(row->data + size, source->data + source->entries[i].address, source->entries[i].size);
+            size += source->entries[i].size;
+        }
+    }
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that moves a row of the heap down until it comes after both of its children, so the row that
+ *        comes last stays on top
+ * @param heap rows of the heap
+ * @param num_rows number of rows in the heap
+ * @param node row that moves down
+ * @param keys sort attributes
+ * @return No return value
+ */
+static void AK_top_n_down(AK_top_n_row *heap, int num_rows, int node, AK_sort_keys *keys) {
+    AK_top_n_row row = heap[node];
+    int child;
+
+    while ((child = 2 * node + 1) < num_rows) {
+        if (child + 1 < num_rows && AK_top_n_compare(keys, &heap[child + 1], &heap[child]) > 0)
+            child++;
+        if (AK_top_n_compare(keys, &heap[child], &row) <= 0)
+            break;
+        heap[node] = heap[child];
+        node = child;
+    }
+    heap[node] = row;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that moves a new row of the heap up while it comes after its parent
+ * @param heap rows of the heap
+ * @param node row that moves up
+ * @param keys sort attributes
+ * @return No return value
+ */
+static void AK_top_n_up(AK_top_n_row *heap, int node, AK_sort_keys *keys) {
+    AK_top_n_row row = heap[node];
+
+    while (node > 0 && AK_top_n_compare(keys, &heap[(node - 1) / 2], &row) < 0) {
+        heap[node] = heap[(node - 1) / 2];
+        node = (node - 1) / 2;
+    }
+    heap[node] = row;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that writes the rows from offset to offset + limit of a sorted table into a new table
+ * @param srcTable sorted table
+ * @param destTable table the rows are written to, it has to exist
+ * @param num_attr number of attributes
+ * @param limit number of rows
+ * @param offset number of rows that are skipped
+ * @return number of written rows, EXIT_ERROR if a row could not be written
+ */
+static int AK_top_n_copy_rows(char *srcTable, char *destTable, int num_attr, int limit, int offset) {
+    AK_sort_cursor cursor;
+    AK_bulk_writer writer;
+    int position = 0, result = EXIT_SUCCESS;
+
+    memset(&cursor, 0, sizeof (AK_sort_cursor));
+    cursor.addresses = AK_get_table_addresses(srcTable);
+    cursor.address = cursor.addresses->address_from[0];
+    cursor.tuple = -1;
+    cursor.block = (AK_block *) AK_malloc(sizeof (AK_block));
+    AK_bulk_writer_open(&writer, destTable);
+    for (AK_sort_cursor_next(&cursor, num_attr); !cursor.done && position < offset + limit;
+         AK_sort_cursor_next(&cursor, num_attr), position++) {
+        if (position >= offset && AK_bulk_write_row(&writer, cursor.block, cursor.tuple, num_attr) == EXIT_ERROR) {
+            result = EXIT_ERROR;
+            break;
+        }
+    }
+    if (result != EXIT_ERROR)
+        result = writer.num_rows;
+    AK_bulk_writer_close(&writer);
+    AK_free(cursor.addresses);
+    AK_free(cursor.block);
+    return result;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that writes the first rows of a table in sorted order into a new table, like ORDER BY ... LIMIT
+ *        ... OFFSET .... The table is read once and only the best offset + limit rows are kept, in a heap whose top
+ *        is the row that comes last. A row is compared with the top by the prefix of its normalized key first and
+ *        copied only if it comes before it. Rows with equal values keep their order. If offset + limit rows do not
+ *        fit into SORT_MEMORY_BLOCKS blocks, the table is sorted with AK_external_sort instead.
+ * @param srcTable name of the table
+ * @param destTable name of the new table
+ * @param attributes list of sort attributes, as in AK_sort_keys_init, NULL to keep the order of the table
+ * @param limit largest number of rows in the new table
+ * @param offset number of rows that are skipped
+ * @return number of written rows, EXIT_ERROR if the table or an attribute does not exist or rows could not be
+ *         written
+ */
+int AK_top_n(char *srcTable, char *destTable, struct list_node *attributes, int limit, int offset) {
+    table_addresses *addresses;
+    AK_header *header;
+    AK_block *block;
+    AK_sort_keys keys;
+    AK_top_n_row *heap, candidate, swap;
+    AK_bulk_writer writer;
+    char temp_table[MAX_ATT_NAME];
+    int num_attr, size, num_rows = 0, sequence = 0, i, j, k, written = 0;
+    AK_PRO;
+
+    addresses = AK_get_table_addresses(srcTable);
+    num_attr = AK_num_attr(srcTable);
+    if (addresses->address_from[0] == 0 || num_attr <= 0 || limit < 0 || offset < 0) {
+        printf("AK_top_n: Table %s does not exist!\n", srcTable);
+        AK_free(addresses);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    header = AK_sort_get_header(srcTable, num_attr);
+    memset(&keys, 0, sizeof (AK_sort_keys));
+    if (attributes != NULL && AK_sort_keys_init(&keys, header, attributes) == EXIT_ERROR) {
+        printf("AK_top_n: Table %s can not be sorted by the given attributes!\n", srcTable);
+        AK_free(header);
+        AK_free(addresses);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+
+    size = limit + offset;
+    if (keys.num_keys > 0 && size > SORT_MEMORY_BLOCKS * (DATA_BLOCK_SIZE / num_attr)) {
+        //too many rows for the heap, the whole table is sorted
+        snprintf(temp_table, MAX_ATT_NAME, "%s__topn", destTable);
+        written = AK_external_sort(srcTable, temp_table, attributes, SORT_MEMORY_BLOCKS, SORT_THREADS);
+        if (written != EXIT_ERROR) {
+            AK_initialize_new_segment(destTable, SEGMENT_TYPE_TABLE, header);
+            written = AK_top_n_copy_rows(temp_table, destTable, num_attr, limit, offset);
+            AK_delete_segment(temp_table, SEGMENT_TYPE_TABLE);
+        }
+    } else {
+        AK_initialize_new_segment(destTable, SEGMENT_TYPE_TABLE, header);
+        heap = (AK_top_n_row *) AK_calloc(size > 0 ? size : 1, sizeof (AK_top_n_row));
+        for (i = 0; i < size; i++)
+            heap[i].entries = (AK_tuple_dict *) AK_calloc(num_attr, sizeof (AK_tuple_dict));
+
+        for (i = 0; i < MAX_EXTENTS_IN_SEGMENT && addresses->address_from[i] != 0 && size > 0; i++) {
+            for (j = addresses->address_from[i]; j < addresses->address_to[i]; j++) {
+                block = AK_get_block(j)->block;
+                if (block->last_tuple_dict_id == 0)
+                    break;
+                for (k = 0; k + num_attr <= DATA_BLOCK_SIZE; k += num_attr) {
+                    if (block->tuple_dict[k].size <= 0)
+                        continue;
+                    //the row is compared in its block and copied only if it is kept
+                    candidate.entries = &block->tuple_dict[k];
+                    candidate.data = block->data;
+                    candidate.sequence = sequence++;
+                    AK_sort_key_normalize(&keys, block, k, candidate.key, SORT_KEY_PREFIX);
+                    if (num_rows < size) {
+                        AK_top_n_copy(&heap[num_rows], &candidate, num_attr);
+                        AK_top_n_up(heap, num_rows++, &keys);
+                    } else if (AK_top_n_compare(&keys, &candidate, &heap[0]) < 0) {
+                        AK_top_n_copy(&heap[0], &candidate, num_attr);
+                        AK_top_n_down(heap, num_rows, 0, &keys);
+                    }
+                }
+                //without sort attributes the first rows of the table are the result
+                if (keys.num_keys == 0 && num_rows == size)
+                    break;
+            }
+            if (keys.num_keys == 0 && num_rows == size)
+                break;
+        }
+
+        //the heap is sorted by moving the last row from the top to the end
+        for (i = num_rows - 1; i > 0; i--) {
+            swap = heap[0];
+            heap[0] = heap[i];
+            heap[i] = swap;
+            AK_top_n_down(heap, i, 0, &keys);
+        }
+
+        AK_bulk_writer_open(&writer, destTable);
+        for (i = offset; i < num_rows; i++) {
+            if (AK_bulk_write_entries(&writer, heap[i].entries, heap[i].data, num_attr) == EXIT_ERROR)
+                break;
+        }
+        written = i < num_rows ? EXIT_ERROR : writer.num_rows;
+        AK_bulk_writer_close(&writer);
+
+        for (i = 0; i < limit + offset; i++) {
+            AK_free(heap[i].entries);
+            AK_free(heap[i].data);
+        }
+        AK_free(heap);
+    }
+
+    if (written > 0) {
+        AK_add_to_redolog_bulk(destTable, written);
+        AK_redolog_commit();
+    }
+    AK_free(header);
+    AK_free(addresses);
+    AK_EPI;
+    return written;
 }
 
 /**
@@ -342,8 +1584,9 @@ void AK_block_sort(AK_block * iBlock, char* attribute_name) {
 
                 AK_dbg_messg(HIGH, FILE_MAN, "slogovi: %s , %s   , head: %i \n", x, y, num_sort_header);
 
-                //comparison
-                if (strcmp(x, y) <= 0) {
+                //comparison by the type of the attribute
+                if (AK_compare_entries(cTemp1, &cTemp1->tuple_dict[br1 * max_header_num + num_sort_header],
+                                       cTemp2, &cTemp2->tuple_dict[br2 * max_header_num + num_sort_header]) <= 0) {
                     AK_dbg_messg(HIGH, FILE_MAN, "manji je: %s\n", x);
 
                     //insert data
@@ -484,6 +1727,281 @@ void AK_block_sort(AK_block * iBlock, char* attribute_name) {
     AK_EPI;
 }
 
+/**
+ * @author Karlo Vuković
+ * @brief Function that measures how the sort of rows held in memory scales with the number of threads. Blocks with
+ *        num_rows rows of an int and a varchar attribute are made in memory, and the rows are sorted by the int
+ *        attribute, which uses the radix sort, and by the varchar attribute and the int attribute in descending
+ *        order, which uses the introsort. Each sort is done with 1, 2, 4, ... up to max_threads threads and the wall
+ *        clock time and the speedup against one thread are printed.
+ * @param num_rows number of rows
+ * @param max_threads largest number of threads
+ * @return EXIT_SUCCESS if all numbers of threads sort the rows in the same order, otherwise EXIT_ERROR
+ */
+int AK_sort_benchmark(int num_rows, int max_threads) {
+    AK_header header[3] = {
+        {TYPE_INT, "id", {0}, {{'\0'}}, {{'\0'}}},
+        {TYPE_VARCHAR, "name", {0}, {{'\0'}}, {{'\0'}}},
+        {0, {'\0'}, {0}, {{'\0'}}, {{'\0'}}}};
+    char *orders[2][4] = {{"id"}, {"name", "id", SORT_DESC}};
+    AK_sort_keys keys;
+    AK_block *blocks;
+    AK_sort_row *rows, *temp, *reference;
+    struct list_node *attributes;
+    struct timespec start, end;
+    char name[MAX_VARCHAR_LENGTH];
+    unsigned int seed = 12345;
+    int rows_per_block = DATA_BLOCK_SIZE / 2, num_blocks, order, threads, i, j, id, result = EXIT_SUCCESS;
+    double elapsed, single = 0;
+    AK_PRO;
+
+    num_blocks = (num_rows + rows_per_block - 1) / rows_per_block;
+    blocks = (AK_block *) AK_calloc(num_blocks, sizeof (AK_block));
+    rows = (AK_sort_row *) AK_malloc(num_rows * sizeof (AK_sort_row));
+    temp = (AK_sort_row *) AK_malloc(num_rows * sizeof (AK_sort_row));
+    reference = (AK_sort_row *) AK_malloc(num_rows * sizeof (AK_sort_row));
+
+    //values are written straight into the blocks, like AK_bulk_write_row does
+    for (i = 0; i < num_rows; i++) {
+        AK_block *block = &blocks[i / rows_per_block];
+        AK_tuple_dict *entry = &block->tuple_dict[(i % rows_per_block) * 2];
+
+        seed = seed * 1103515245 + 12345;
+        id = (int) (seed >> 8) % 1000000 - 500000;
+        sprintf(name, "n%d", (seed >> 4) % 5000);
+        entry[0].type = TYPE_INT;
+        entry[0].address = block->AK_free_space;
+        entry[0].size = sizeof (int);
+        memcpy(block->data + block->AK_free_space, &id, sizeof (int));
+        block->AK_free_space += sizeof (int);
+        entry[1].type = TYPE_VARCHAR;
+        entry[1].address = block->AK_free_space;
+        entry[1].size = strlen(name);
+        memcpy(block->data + block->AK_free_space, name, strlen(name));
+        block->AK_free_space += strlen(name);
+    }
+
+    attributes = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    printf("AK_sort_benchmark: %d rows, %ld cores\n", num_rows, sysconf(_SC_NPROCESSORS_ONLN));
+    for (order = 0; order < 2; order++) {
+        AK_Init_L3(&attributes);
+        for (j = 0; j < 4 && orders[order][j] != NULL; j++) {
+            memset(name, 0, MAX_VARCHAR_LENGTH);
+            strcpy(name, orders[order][j]);
+            AK_InsertAtEnd_L3(strcmp(name, SORT_DESC) == 0 ? TYPE_OPERATOR : TYPE_ATTRIBS, name, strlen(name) + 1, attributes);
+        }
+        AK_sort_keys_init(&keys, header, attributes);
+        AK_DeleteAll_L3(&attributes);
+        printf("%s sort by %s%s\n", keys.fixed_width > 0 ? "Radix" : "Intro", orders[order][0],
+               order == 1 ? ", id DESC" : "");
+        printf("%10s %12s %10s\n", "threads", "time (ms)", "speedup");
+
+        for (threads = 1; threads <= max_threads; threads *= 2) {
+            for (i = 0; i < num_rows; i++) {
+                rows[i].block = i / rows_per_block;
+                rows[i].tuple = (i % rows_per_block) * 2;
+                AK_sort_key_normalize(&keys, &blocks[rows[i].block], rows[i].tuple, rows[i].key, SORT_KEY_PREFIX);
+            }
+            clock_gettime(CLOCK_MONOTONIC, &start);
+            AK_sort_rows_parallel(rows, temp, num_rows, blocks, &keys, threads);
+            clock_gettime(CLOCK_MONOTONIC, &end);
+            elapsed = (end.tv_sec - start.tv_sec) * 1000.0 + (end.tv_nsec - start.tv_nsec) / 1000000.0;
+            if (threads == 1) {
+                single = elapsed;
+                memcpy(reference, rows, num_rows * sizeof (AK_sort_row));
+            }
+            for (i = 0; i < num_rows; i++) {
+                if (rows[i].block != reference[i].block || rows[i].tuple != reference[i].tuple) {
+                    result = EXIT_ERROR;
+                    break;
+                }
+            }
+            printf("%10d %12.2f %9.2fx%s\n", threads, elapsed, elapsed > 0 ? single / elapsed : 0.0,
+                   i < num_rows ? " (wrong order)" : "");
+        }
+    }
+
+    AK_free(attributes);
+    AK_free(blocks);
+    AK_free(rows);
+    AK_free(temp);
+    AK_free(reference);
+    AK_EPI;
+    return result;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that checks the order of rows in a sorted table, used by the test. Normalized keys of the rows
+ *        have to be in the same order as the rows.
+ * @param tblName table name
+ * @param attributes list of sort attributes
+ * @param pos_attribute position of an int attribute that has to grow among rows with equal values, -1 to skip
+ * @return number of rows, -1 if the rows are not in order
+ */
+static int AK_filesort_test_check(char *tblName, struct list_node *attributes, int pos_attribute) {
+    AK_sort_cursor cursor;
+    AK_sort_keys keys;
+    AK_header *header;
+    AK_block *previous;
+    unsigned char key[2][SORT_KEY_PREFIX * 4];
+    int previous_tuple = -1, num_rows = 0, ordered = 1, num_attr, result, pos, previous_pos;
+
+    num_attr = AK_num_attr(tblName);
+    header = AK_sort_get_header(tblName, num_attr);
+    AK_sort_keys_init(&keys, header, attributes);
+
+    memset(&cursor, 0, sizeof (AK_sort_cursor));
+    cursor.addresses = AK_get_table_addresses(tblName);
+    cursor.address = cursor.addresses->address_from[0];
+    cursor.tuple = -1;
+    cursor.block = (AK_block *) AK_malloc(sizeof (AK_block));
+    previous = (AK_block *) AK_malloc(sizeof (AK_block));
+
+    for (AK_sort_cursor_next(&cursor, num_attr); !cursor.done; AK_sort_cursor_next(&cursor, num_attr)) {
+        AK_sort_key_normalize(&keys, cursor.block, cursor.tuple, key[num_rows % 2], sizeof (key[0]));
+        if (previous_tuple >= 0) {
+            result = AK_sort_compare_keys(&keys, previous, previous_tuple, cursor.block, cursor.tuple);
+            if ((result == 0) != (memcmp(key[(num_rows + 1) % 2], key[num_rows % 2], sizeof (key[0])) == 0))
+                ordered = 0;
+            if (result == 0 && pos_attribute >= 0) {
+                memcpy(&previous_pos, previous->data + previous->tuple_dict[previous_tuple + pos_attribute].address, sizeof (int));
+                memcpy(&pos, cursor.block->data + cursor.block->tuple_dict[cursor.tuple + pos_attribute].address, sizeof (int));
+                result = previous_pos > pos;
+            }
+            if (result > 0 || memcmp(key[(num_rows + 1) % 2], key[num_rows % 2], sizeof (key[0])) > 0)
+                ordered = 0;
+        }
+        memcpy(previous, cursor.block, sizeof (AK_block));
+        previous_tuple = cursor.tuple;
+        num_rows++;
+    }
+
+    AK_free(header);
+    AK_free(cursor.addresses);
+    AK_free(cursor.block);
+    AK_free(previous);
+    return ordered ? num_rows : -1;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that checks if a table holds the same rows as a part of another table, used by the test
+ * @param tblName table name
+ * @param other table with the expected rows
+ * @param offset first expected row of the other table
+ * @param num_rows number of expected rows
+ * @return 1 if the rows are the same and in the same order, otherwise 0
+ */
+static int AK_filesort_test_same(char *tblName, char *other, int offset, int num_rows) {
+    AK_sort_cursor cursor[2];
+    int num_attr = AK_num_attr(tblName), position, same = 1, i;
+
+    for (i = 0; i < 2; i++) {
+        memset(&cursor[i], 0, sizeof (AK_sort_cursor));
+        cursor[i].addresses = AK_get_table_addresses(i == 0 ? tblName : other);
+        cursor[i].address = cursor[i].addresses->address_from[0];
+        cursor[i].tuple = -1;
+        cursor[i].block = (AK_block *) AK_malloc(sizeof (AK_block));
+        AK_sort_cursor_next(&cursor[i], num_attr);
+    }
+    for (position = 0; position < offset && !cursor[1].done; position++)
+        AK_sort_cursor_next(&cursor[1], num_attr);
+    for (position = 0; position < num_rows && same; position++) {
+        if (cursor[0].done || cursor[1].done ||
+            AK_compare_rows(cursor[0].block, cursor[0].tuple, cursor[1].block, cursor[1].tuple, num_attr) != 0)
+            same = 0;
+        AK_sort_cursor_next(&cursor[0], num_attr);
+        AK_sort_cursor_next(&cursor[1], num_attr);
+    }
+    if (!cursor[0].done)
+        same = 0;
+
+    for (i = 0; i < 2; i++) {
+        AK_free(cursor[i].addresses);
+        AK_free(cursor[i].block);
+    }
+    return same;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that sorts a table with null values, used by the test. Every third score and every fifth name are
+ *        null, as the rows have no value for them.
+ * @return EXIT_SUCCESS if the rows are in order and the rows with null scores come first, otherwise EXIT_ERROR
+ */
+static int AK_filesort_test_nulls() {
+    char *tblName = "sort_test_null";
+    char *sorted[2] = {"sort_test_null_score", "sort_test_null_name"};
+    char name[MAX_VARCHAR_LENGTH];
+    struct list_node *rows[30], *key[2];
+    AK_sort_cursor cursor;
+    AK_header t_header[4] = {
+        {TYPE_INT, "id", {0}, {{'\0'}}, {{'\0'}}},
+        {TYPE_VARCHAR, "name", {0}, {{'\0'}}, {{'\0'}}},
+        {TYPE_FLOAT, "score", {0}, {{'\0'}}, {{'\0'}}},
+        {0, {'\0'}, {0}, {{'\0'}}, {{'\0'}}}};
+    float score;
+    int num_rows = 30, pos, i, result = EXIT_SUCCESS;
+
+    if (AK_num_attr(tblName) > 0)
+        AK_delete_segment(tblName, SEGMENT_TYPE_TABLE);
+    for (i = 0; i < 2; i++)
+        if (AK_num_attr(sorted[i]) > 0)
+            AK_delete_segment(sorted[i], SEGMENT_TYPE_TABLE);
+    AK_initialize_new_segment(tblName, SEGMENT_TYPE_TABLE, t_header);
+    for (pos = 0; pos < num_rows; pos++) {
+        score = (pos % 7) - 3.5f;
+        sprintf(name, "n%d", pos % 4);
+        rows[pos] = (struct list_node *) AK_malloc(sizeof (struct list_node));
+        AK_Init_L3(&rows[pos]);
+        AK_Insert_New_Element(TYPE_INT, &pos, tblName, "id", rows[pos]);
+        if (pos % 5 != 0)
+            AK_Insert_New_Element(TYPE_VARCHAR, name, tblName, "name", rows[pos]);
+        if (pos % 3 != 0)
+            AK_Insert_New_Element(TYPE_FLOAT, &score, tblName, "score", rows[pos]);
+    }
+    AK_bulk_insert(tblName, rows, num_rows);
+    for (pos = 0; pos < num_rows; pos++) {
+        AK_DeleteAll_L3(&rows[pos]);
+        AK_free(rows[pos]);
+    }
+
+    for (i = 0; i < 2; i++) {
+        key[i] = (struct list_node *) AK_malloc(sizeof (struct list_node));
+        AK_Init_L3(&key[i]);
+    }
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "score", sizeof ("score"), key[0]);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "name", sizeof ("name"), key[1]);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "score", sizeof ("score"), key[1]);
+
+    for (i = 0; i < 2; i++) {
+        if (AK_external_sort(tblName, sorted[i], key[i], 3, 1) == EXIT_ERROR ||
+            AK_filesort_test_check(sorted[i], key[i], 0) != num_rows)
+            result = EXIT_ERROR;
+        AK_DeleteAll_L3(&key[i]);
+        AK_free(key[i]);
+    }
+
+    //the ten rows with null scores come first, in the order of the table
+    memset(&cursor, 0, sizeof (AK_sort_cursor));
+    cursor.addresses = AK_get_table_addresses(sorted[0]);
+    cursor.address = cursor.addresses->address_from[0];
+    cursor.tuple = -1;
+    cursor.block = (AK_block *) AK_malloc(sizeof (AK_block));
+    for (AK_sort_cursor_next(&cursor, 3), pos = 0; !cursor.done; AK_sort_cursor_next(&cursor, 3), pos++)
+        if ((cursor.block->tuple_dict[cursor.tuple + 2].type != TYPE_FLOAT) != (pos < num_rows / 3))
+            result = EXIT_ERROR;
+    AK_free(cursor.addresses);
+    AK_free(cursor.block);
+    printf("Sorted with null values: %s\n", result == EXIT_SUCCESS ? "in order" : "not in order");
+
+    for (i = 0; i < 2; i++)
+        AK_delete_segment(sorted[i], SEGMENT_TYPE_TABLE);
+    AK_delete_segment(tblName, SEGMENT_TYPE_TABLE);
+    return result;
+}
+
 //extern int address_of_tempBlock = 0;
 /*
  * @author Unknown, updated Tomislav Bobinac, Filip Žmuk
@@ -513,6 +2031,180 @@ TestResult AK_filesort_test() {
         failed++;
     }    
 
+    //external sort of a table larger than the memory of the sort
+    char *tblName = "sort_test";
+    char *sorted[5] = {"sort_test_id", "sort_test_name", "sort_test_score", "sort_test_multi", "sort_test_desc"};
+    //attributes of each sort, an attribute followed by DESC is sorted in descending order
+    char *keys[6][6] = {{"id"}, {"name"}, {"score"}, {"name", SORT_DESC, "score", SORT_ASC, "id", SORT_DESC},
+                        {"score", SORT_DESC, "id"}, {"missing"}};
+    char name[MAX_VARCHAR_LENGTH];
+    int num_rows = 1200, i, j, id, pos, checked;
+    float score;
+    struct list_node **rows;
+    struct list_node *key[6];
+    table_addresses *run;
+    AK_header t_header[5] = {
+        {TYPE_INT, "id", {0}, {{'\0'}}, {{'\0'}}},
+        {TYPE_VARCHAR, "name", {0}, {{'\0'}}, {{'\0'}}},
+        {TYPE_FLOAT, "score", {0}, {{'\0'}}, {{'\0'}}},
+        {TYPE_INT, "pos", {0}, {{'\0'}}, {{'\0'}}},
+        {0, {'\0'}, {0}, {{'\0'}}, {{'\0'}}}};
+
+    if (AK_num_attr(tblName) > 0)
+        AK_delete_segment(tblName, SEGMENT_TYPE_TABLE);
+    for (i = 0; i < 5; i++)
+        if (AK_num_attr(sorted[i]) > 0)
+            AK_delete_segment(sorted[i], SEGMENT_TYPE_TABLE);
+    AK_initialize_new_segment(tblName, SEGMENT_TYPE_TABLE, t_header);
+
+    //ids are a permutation of 0..num_rows-1, pos keeps the order of insertion
+    rows = (struct list_node **) AK_calloc(num_rows, sizeof (struct list_node *));
+    for (pos = 0; pos < num_rows; pos++) {
+        id = (pos * 7919) % num_rows;
+        score = (id % 37) * 0.5f - 9.0f;
+        sprintf(name, "n%d", id % 50);
+        rows[pos] = (struct list_node *) AK_malloc(sizeof (struct list_node));
+        AK_Init_L3(&rows[pos]);
+        AK_Insert_New_Element(TYPE_INT, &id, tblName, "id", rows[pos]);
+        AK_Insert_New_Element(TYPE_VARCHAR, name, tblName, "name", rows[pos]);
+        AK_Insert_New_Element(TYPE_FLOAT, &score, tblName, "score", rows[pos]);
+        AK_Insert_New_Element(TYPE_INT, &pos, tblName, "pos", rows[pos]);
+    }
+    AK_bulk_insert(tblName, rows, num_rows);
+    for (pos = 0; pos < num_rows; pos++) {
+        AK_DeleteAll_L3(&rows[pos]);
+        AK_free(rows[pos]);
+    }
+    AK_free(rows);
+
+    for (i = 0; i < 6; i++) {
+        key[i] = (struct list_node *) AK_malloc(sizeof (struct list_node));
+        AK_Init_L3(&key[i]);
+        for (j = 0; j < 6 && keys[i][j] != NULL; j++) {
+            memset(name, 0, MAX_VARCHAR_LENGTH);
+            strcpy(name, keys[i][j]);
+            if (strcmp(name, SORT_ASC) == 0 || strcmp(name, SORT_DESC) == 0)
+                AK_InsertAtEnd_L3(TYPE_OPERATOR, name, strlen(name) + 1, key[i]);
+            else
+                AK_InsertAtEnd_L3(TYPE_ATTRIBS, name, strlen(name) + 1, key[i]);
+        }
+    }
+
+    //three blocks of memory give several runs and more than one merge pass, int keys are sorted with radix sort
+    checked = AK_external_sort(tblName, sorted[0], key[0], 3, 1) == EXIT_SUCCESS ? AK_filesort_test_check(sorted[0], key[0], -1) : -1;
+    run = AK_get_table_addresses("sort_test_id__run0");
+    printf("Sorted by id in runs: %d rows in order\n", checked);
+    if (checked == num_rows && run->address_from[0] == 0)
+        success++;
+    else
+        failed++;
+    AK_free(run);
+
+    //rows with equal names keep the order of insertion
+    checked = AK_external_sort(tblName, sorted[1], key[1], 3, 1) == EXIT_SUCCESS ? AK_filesort_test_check(sorted[1], key[1], 3) : -1;
+    printf("Sorted by name in runs: %d rows in order\n", checked);
+    if (checked == num_rows)
+        success++;
+    else
+        failed++;
+
+    //the whole table fits into the default memory, negative and positive floats
+    checked = AK_sort_segment(tblName, sorted[2], key[2]) == EXIT_SUCCESS ? AK_filesort_test_check(sorted[2], key[2], 3) : -1;
+    printf("Sorted by score in memory: %d rows in order\n", checked);
+    if (checked == num_rows)
+        success++;
+    else
+        failed++;
+
+    //a varchar key is sorted by prefixes of the normalized keys
+    checked = AK_external_sort(tblName, sorted[3], key[3], 3, 1) == EXIT_SUCCESS ? AK_filesort_test_check(sorted[3], key[3], -1) : -1;
+    printf("Sorted by name DESC, score ASC, id DESC in runs: %d rows in order\n", checked);
+    if (checked == num_rows)
+        success++;
+    else
+        failed++;
+
+    checked = AK_external_sort(tblName, sorted[4], key[4], 3, 1) == EXIT_SUCCESS ? AK_filesort_test_check(sorted[4], key[4], -1) : -1;
+    printf("Sorted by score DESC, id in runs: %d rows in order\n", checked);
+    if (checked == num_rows)
+        success++;
+    else
+        failed++;
+
+    if (AK_external_sort(tblName, "sort_test_missing", key[5], 3, 1) == EXIT_ERROR)
+        success++;
+    else
+        failed++;
+
+    //ORDER BY ... LIMIT gives the first rows of the full sort, also for a page further down and for rows with
+    //equal names, which keep the order of the table
+    for (i = 0; i < 4; i++) {
+        int limits[4][3] = {{3, 25, 0}, {3, 10, 30}, {3, 10, num_rows - 5}, {1, 40, 0}};
+        if (AK_num_attr("sort_test_top") > 0)
+            AK_delete_segment("sort_test_top", SEGMENT_TYPE_TABLE);
+        checked = AK_top_n(tblName, "sort_test_top", key[limits[i][0]], limits[i][1], limits[i][2]);
+        printf("Top %d rows after %d: %d rows\n", limits[i][1], limits[i][2], checked);
+        if (checked == (i != 2 ? limits[i][1] : 5) &&
+            AK_filesort_test_same("sort_test_top", sorted[limits[i][0]], limits[i][2], checked))
+            success++;
+        else
+            failed++;
+    }
+
+    //without sort attributes the first rows of the table are kept
+    AK_delete_segment("sort_test_top", SEGMENT_TYPE_TABLE);
+    checked = AK_top_n(tblName, "sort_test_top", NULL, 5, 0);
+    if (checked == 5 && AK_filesort_test_same("sort_test_top", tblName, 0, 5))
+        success++;
+    else
+        failed++;
+
+    //a page too deep for the heap is taken from the whole sorted table
+    AK_delete_segment("sort_test_top", SEGMENT_TYPE_TABLE);
+    checked = AK_top_n(tblName, "sort_test_top", key[3], 10, SORT_MEMORY_BLOCKS * (DATA_BLOCK_SIZE / 4));
+    run = AK_get_table_addresses("sort_test_top__topn");
+    if (checked == 0 && run->address_from[0] == 0)
+        success++;
+    else
+        failed++;
+    AK_free(run);
+    AK_delete_segment("sort_test_top", SEGMENT_TYPE_TABLE);
+
+    //with a B+tree index on the sort attribute rows are read in the order of the index, equal names keep the order
+    //of the table, and a descending sort can not use it
+    AK_btree_delete("sort_test_name_btree");
+    if (AK_num_attr("sort_test_index") > 0)
+        AK_delete_segment("sort_test_index", SEGMENT_TYPE_TABLE);
+    checked = AK_btree_create(tblName, key[1], "sort_test_name_btree") == EXIT_SUCCESS ?
+              AK_sort_by_index(tblName, "sort_test_index", key[1]) : -1;
+    printf("Sorted by name through the index: %d rows\n", checked);
+    if (checked == num_rows && AK_filesort_test_check("sort_test_index", key[1], 3) == num_rows &&
+        AK_filesort_test_same("sort_test_index", sorted[1], 0, num_rows) &&
+        AK_sort_by_index(tblName, "sort_test_index_desc", key[3]) == -2)
+        success++;
+    else
+        failed++;
+    AK_btree_delete("sort_test_name_btree");
+    AK_delete_segment("sort_test_index", SEGMENT_TYPE_TABLE);
+
+    //nulls come first in ascending order, both in the normalized keys and when attributes are compared, and float
+    //keys are sorted with radix sort, keys with a varchar with introsort
+    if (AK_filesort_test_nulls() == EXIT_SUCCESS)
+        success++;
+    else
+        failed++;
+
+    //rows in memory are sorted in the same order with any number of threads
+    if (AK_sort_benchmark(65536, 16) == EXIT_SUCCESS)
+        success++;
+    else
+        failed++;
+
+    for (i = 0; i < 6; i++) {
+        AK_DeleteAll_L3(&key[i]);
+        AK_free(key[i]);
+    }
+
 	AK_EPI;
     return TEST_result(success,failed);
 }
@@ -26,6 +26,11 @@
 #include "files.h"
 #include "fileio.h"
 #include "../auxi/mempro.h"
+#include "../auxi/compare.h"
+#include "bulk.h"
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
 /**
   * @def DATA_ROW_SIZE
   * @brief Constatnt declaring size of data to be compared
@@ -62,13 +67,129 @@ int AK_get_header_number(AK_block *iBlock, char *attribute_name);
 int AK_get_num_of_tuples(AK_block *iBlock);
 
 /**
- * @author Tomislav Bobinac, updated by Filip Žmuk
- * @todo Make it to suport multiple sort atributes and ASC|DESC ordering
- * @brief Function that sorts a segment
- * @return No return value.
+ * @author Karlo Vuković
+ * @struct AK_sort_keys
+ * @brief Structure that holds the attributes rows are sorted by, in the order they were given
+ */
+typedef struct {
+    /// number of sort attributes
+    int num_keys;
+    /// position of each sort attribute in the header
+    int attribute[MAX_ATTRIBUTES];
+    /// type of each sort attribute
+    int type[MAX_ATTRIBUTES];
+    /// 1 if the attribute is sorted in descending order, otherwise 0
+    int descending[MAX_ATTRIBUTES];
+    /// length of the normalized key if all attributes have fixed width and the key fits into SORT_KEY_PREFIX bytes,
+    /// otherwise 0
+    int fixed_width;
+} AK_sort_keys;
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that reads the sort attributes from a list. Each attribute is an element of type TYPE_ATTRIBS
+ *        and can be followed by an element of type TYPE_OPERATOR with SORT_ASC or SORT_DESC, attributes without one
+ *        are sorted in ascending order.
+ * @param keys sort attributes
+ * @param header header of the table, it has to end with an empty attribute
+ * @param attributes list of attributes
+ * @return EXIT_SUCCESS, EXIT_ERROR if there are no attributes, too many of them or an attribute does not exist
+ */
+int AK_sort_keys_init(AK_sort_keys *keys, AK_header *header, struct list_node *attributes);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that writes the sort attributes of a row as a normalized key, a string of bytes that compares with
+ *        memcmp like the row compares by the attributes. Each value starts with a byte that is 0 for null values and
+ *        1 for others, so nulls come first. A value is null if its entry is empty or its type is not the type of the
+ *        attribute, as "null" is stored as a varchar, and the rest of a null value of fixed width is zeros.
+ *        Int, date and time values are written as big-endian numbers with the sign bit flipped, float and number
+ *        values as their bits with the sign bit flipped for positive values and all bits flipped for negative ones,
+ *        and varchar values as their bytes followed by a zero byte. All bytes of a descending attribute are flipped.
+ *        A key longer than size is cut and the rest of the buffer is filled with zeros.
+ * @param keys sort attributes
+ * @param block block that holds the row
+ * @param tuple first entry of the row in the tuple dictionary
+ * @param key buffer for the key
+ * @param size size of the buffer
+ * @return No return value
+ */
+void AK_sort_key_normalize(AK_sort_keys *keys, AK_block *block, int tuple, unsigned char *key, int size);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that compares two rows by the sort attributes
+ * @param keys sort attributes
+ * @param left_block block that holds the first row
+ * @param left first entry of the first row in the tuple dictionary
+ * @param right_block block that holds the second row
+ * @param right first entry of the second row in the tuple dictionary
+ * @return negative number if the first row comes first, 0 if the rows are equal, otherwise positive number
+ */
+int AK_sort_compare_keys(AK_sort_keys *keys, AK_block *left_block, int left, AK_block *right_block, int right);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that sorts a table that does not have to fit into memory. Blocks of the table are read into
+ *        memory_blocks blocks of memory, rows in memory are sorted and written as a run into a temporary table.
+ *        Runs are then merged with a loser tree, memory_blocks - 1 runs at a time, until one is left. A table that
+ *        fits into memory is written to destTable directly. Rows are packed into blocks of destTable with
+ *        AK_bulk_write_row and the sort is stable. Rows in memory carry the first SORT_KEY_PREFIX bytes of their
+ *        normalized key. They are sorted with an LSD radix sort if the whole key fits there, otherwise with an
+ *        introsort that compares the attributes only when the prefixes are equal. With more threads, rows in memory
+ *        are split into parts that are sorted at the same time and then merged by all threads together.
+ * @param srcTable name of the table to sort
+ * @param destTable name of the new sorted table
+ * @param attributes list of sort attributes, as in AK_sort_keys_init
+ * @param memory_blocks number of blocks the sort can hold in memory, at least 3
+ * @param threads number of threads that sort rows in memory, 0 or less for all cores
+ * @return EXIT_SUCCESS, EXIT_ERROR if the table or an attribute does not exist or rows could not be written
+ */
+int AK_external_sort(char *srcTable, char *destTable, struct list_node *attributes, int memory_blocks, int threads);
+
+/**
+ * @author Tomislav Bobinac, updated by Filip Žmuk, updated by Karlo Vuković (external merge sort, multiple
+ *         attributes with ASC|DESC ordering, order of B+tree indexes)
+ * @brief Function that sorts a segment. If a B+tree index of the table has the sort attributes as its key, rows are
+ *        read in its order with AK_sort_by_index, otherwise they are sorted with AK_external_sort, holding at most
+ *        SORT_MEMORY_BLOCKS blocks in memory and sorting them with SORT_THREADS threads
+ * @param srcTable name of the table to sort
+ * @param destTable name of the new sorted table
+ * @param attributes list of sort attributes, as in AK_sort_keys_init
+ * @return EXIT_SUCCESS, EXIT_ERROR if the table could not be sorted
  */
 int AK_sort_segment(char *srcTable, char *destTable, struct list_node* attributes);
 
+/**
+ * @author Karlo Vuković
+ * @brief Function that writes the first rows of a table in sorted order into a new table, like ORDER BY ... LIMIT
+ *        ... OFFSET .... The table is read once and only the best offset + limit rows are kept, in a heap whose top
+ *        is the row that comes last. A row is compared with the top by the prefix of its normalized key first and
+ *        copied only if it comes before it. Rows with equal values keep their order. If offset + limit rows do not
+ *        fit into SORT_MEMORY_BLOCKS blocks, the table is sorted with AK_external_sort instead.
+ * @param srcTable name of the table
+ * @param destTable name of the new table
+ * @param attributes list of sort attributes, as in AK_sort_keys_init, NULL to keep the order of the table
+ * @param limit largest number of rows in the new table
+ * @param offset number of rows that are skipped
+ * @return number of written rows, EXIT_ERROR if the table or an attribute does not exist or rows could not be
+ *         written
+ */
+int AK_top_n(char *srcTable, char *destTable, struct list_node *attributes, int limit, int offset);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that measures how the sort of rows held in memory scales with the number of threads. Blocks with
+ *        num_rows rows of an int and a varchar attribute are made in memory, and the rows are sorted by the int
+ *        attribute, which uses the radix sort, and by the varchar attribute and the int attribute in descending
+ *        order, which uses the introsort. Each sort is done with 1, 2, 4, ... up to max_threads threads and the wall
+ *        clock time and the speedup against one thread are printed.
+ * @param num_rows number of rows
+ * @param max_threads largest number of threads
+ * @return EXIT_SUCCESS if all numbers of threads sort the rows in the same order, otherwise EXIT_ERROR
+ */
+int AK_sort_benchmark(int num_rows, int max_threads);
+
 /**
  * @author Unknown
  * @brief Function that resets block
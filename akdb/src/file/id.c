@@ -20,13 +20,13 @@
 #include "id.h"
 
 /**
- * @author Saša Vukšić, updated by Mislav Čakarić, changed by Mario Peroković, now uses AK_update_row, updated by Nenad Makar
+ * @author Saša Vukšić, updated by Mislav Čakarić, changed by Mario Peroković, now uses AK_update_row, updated by Nenad Makar, updated by Karlo Vuković (name of the sequence)
  * @brief Function that fetches unique ID for any object, stored in a sequence
  * @return objectID
  */
 int AK_get_id() {
     int obj_id = 0;
-    char name = "objectID";
+    char *name = "objectID";
     int current_value;
     AK_PRO;
     struct list_node *row_root = (struct list_node *) AK_malloc(sizeof (struct list_node));
@@ -48,8 +48,8 @@ int AK_get_id() {
         current_value++;
         
         //TODO: this is a temporary solution that should be fixed after the memory management is fixed
-		AK_Update_Existing_Element(TYPE_VARCHAR, &name, "AK_sequence", "name", row_root);
-        AK_Insert_New_Element(TYPE_VARCHAR, &name, "AK_sequence", "name", row_root);
+		AK_Update_Existing_Element(TYPE_VARCHAR, name, "AK_sequence", "name", row_root);
+        AK_Insert_New_Element(TYPE_VARCHAR, name, "AK_sequence", "name", row_root);
         AK_Insert_New_Element(TYPE_INT, &current_value, "AK_sequence", "current_value", row_root);
         int result = AK_update_row(row_root);
         AK_DeleteAll_L3(&row_root);
@@ -63,7 +63,7 @@ int AK_get_id() {
     } else {
 	    // No existing rows found for AK_sequence table, creating new row
         AK_Insert_New_Element(TYPE_INT, &obj_id, "AK_sequence", "obj_id", row_root);
-        AK_Insert_New_Element(TYPE_VARCHAR, &name, "AK_sequence", "name", row_root);
+        AK_Insert_New_Element(TYPE_VARCHAR, name, "AK_sequence", "name", row_root);
         current_value = ID_START_VALUE;
         AK_Insert_New_Element(TYPE_INT, &current_value, "AK_sequence", "current_value", row_root);
         int increment = 1;
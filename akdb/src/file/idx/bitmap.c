@@ -21,6 +21,862 @@
 #include "../../auxi/iniparser.h"
 #include "../../auxi/constants.h"
 
+#include "../bulk.h"
+#include <limits.h>
+
+/// pages of bitmap indices are copied from and to the cache by one thread at a time
+static pthread_mutex_t AK_bitmap_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * @author Karlo Vuković
+ * @struct AK_bitmap_index
+ * @brief Structure that holds an open bitmap index while it is read or changed
+ */
+typedef struct {
+    /// name of the index
+    char *name;
+    /// address of the first block of the index
+    int address;
+    /// extents of the index segment, NULL until a page is added
+    table_addresses *addresses;
+    /// copy of the first block with the description and the values of the index
+    AK_block *first;
+    /// description of the index in the copy of the first block
+    AK_bitmap_info *info;
+    /// 1 if the first block has to be written back
+    int dirty;
+} AK_bitmap_index;
+
+/**
+ * @author Karlo Vuković
+ * @struct AK_bitmap_reader
+ * @brief Structure that reads a bitmap run by run, where a run is a fill word or a single literal word
+ */
+typedef struct {
+    /// bitmap
+    AK_bitmap *bitmap;
+    /// next word
+    int word;
+    /// groups left in the current run
+    int groups;
+    /// value of every group of the current run
+    unsigned int literal;
+} AK_bitmap_reader;
+
+/**
+ * @author Karlo Vuković
+ * @struct AK_bitmap_change
+ * @brief Structure that describes a bit to be set or cleared in the bitmap of a value of a bitmap index
+ */
+typedef struct {
+    /// number of the value, -1 for a null, which only changes the bitmap of all rows
+    int value;
+    /// bit of the row
+    int position;
+    /// 1 if the bit is set, 0 if it is cleared
+    int insert;
+} AK_bitmap_change;
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that adds a word to the end of a bitmap
+ * @param bitmap bitmap
+ * @param word word
+ * @return No return value
+ */
+static void AK_bitmap_push(AK_bitmap *bitmap, unsigned int word) {
+    if (bitmap->num_words == bitmap->max_words) {
+        bitmap->max_words = bitmap->max_words > 0 ? 2 * bitmap->max_words : 16;
+        bitmap->words = (unsigned int *) AK_realloc(bitmap->words, bitmap->max_words * sizeof (unsigned int));
+    }
+    bitmap->words[bitmap->num_words++] = word;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that adds groups of bits to the end of a bitmap. Groups of all zeros or all ones become a fill word
+ *        or make the last fill word longer, other groups become literal words.
+ * @param bitmap bitmap
+ * @param literal bits of each group
+ * @param groups number of groups, 1 unless the groups are all zeros or all ones
+ * @return No return value
+ */
+static void AK_bitmap_add_groups(AK_bitmap *bitmap, unsigned int literal, int groups) {
+    unsigned int fill, *last;
+    int count;
+
+    if (groups <= 0)
+        return;
+    bitmap->num_bits += groups * BITMAP_GROUP_BITS;
+    if (literal != 0 && literal != BITMAP_LITERAL) {
+        AK_bitmap_push(bitmap, literal);
+        return;
+    }
+    fill = BITMAP_FILL | (literal != 0 ? BITMAP_FILL_ONES : 0);
+    last = bitmap->num_words > 0 ? &bitmap->words[bitmap->num_words - 1] : NULL;
+    if (last != NULL && (*last & ~BITMAP_FILL_GROUPS) == fill) {
+        count = (int) (BITMAP_FILL_GROUPS - (*last & BITMAP_FILL_GROUPS));
+        count = count < groups ? count : groups;
+        *last += count;
+        groups -= count;
+    }
+    while (groups > 0) {
+        count = groups < (int) BITMAP_FILL_GROUPS ? groups : (int) BITMAP_FILL_GROUPS;
+        AK_bitmap_push(bitmap, fill | count);
+        groups -= count;
+    }
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that sets a bit of a bitmap without the profiler, for loops over many rows
+ * @param bitmap bitmap
+ * @param position bit
+ * @return EXIT_SUCCESS, EXIT_ERROR if the bit comes before the last word of the bitmap
+ */
+static int AK_bitmap_set_bit(AK_bitmap *bitmap, int position) {
+    int group = position / BITMAP_GROUP_BITS, groups = bitmap->num_bits / BITMAP_GROUP_BITS;
+    unsigned int bit = 1u << (position % BITMAP_GROUP_BITS), *last;
+
+    if (group < groups - 1)
+        return EXIT_ERROR;
+    if (group == groups - 1) {
+        last = &bitmap->words[bitmap->num_words - 1];
+        if (!(*last & BITMAP_FILL)) {
+            *last |= bit;
+            return EXIT_SUCCESS;
+        }
+        if (*last & BITMAP_FILL_ONES)
+            return EXIT_SUCCESS;
+        //the last group of a fill of zeros becomes a literal
+        if (--*last == BITMAP_FILL)
+            bitmap->num_words--;
+        bitmap->num_bits -= BITMAP_GROUP_BITS;
+        groups--;
+    } else if (bitmap->num_words > 0 && bitmap->words[bitmap->num_words - 1] == BITMAP_LITERAL) {
+        //the last literal is full, so it becomes a fill before the next group starts
+        bitmap->num_words--;
+        bitmap->num_bits -= BITMAP_GROUP_BITS;
+        AK_bitmap_add_groups(bitmap, BITMAP_LITERAL, 1);
+    }
+    AK_bitmap_add_groups(bitmap, 0, group - groups);
+    AK_bitmap_add_groups(bitmap, bit, 1);
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that initializes an empty bitmap
+ * @param bitmap bitmap
+ * @return No return value
+ */
+void AK_bitmap_init(AK_bitmap *bitmap) {
+    AK_PRO;
+    bitmap->words = NULL;
+    bitmap->num_words = 0;
+    bitmap->max_words = 0;
+    bitmap->num_bits = 0;
+    AK_EPI;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that frees the words of a bitmap, it is empty afterwards
+ * @param bitmap bitmap
+ * @return No return value
+ */
+void AK_bitmap_free(AK_bitmap *bitmap) {
+    AK_PRO;
+    if (bitmap->words != NULL)
+        AK_free(bitmap->words);
+    bitmap->words = NULL;
+    bitmap->num_words = 0;
+    bitmap->max_words = 0;
+    bitmap->num_bits = 0;
+    AK_EPI;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that sets a bit after the bits the bitmap already covers, or in its last literal word
+ * @param bitmap bitmap
+ * @param position bit
+ * @return EXIT_SUCCESS, EXIT_ERROR if the bit comes before the last word of the bitmap
+ */
+int AK_bitmap_set(AK_bitmap *bitmap, int position) {
+    int result;
+    AK_PRO;
+    result = AK_bitmap_set_bit(bitmap, position);
+    AK_EPI;
+    return result;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that tells if a bit of a bitmap is set
+ * @param bitmap bitmap
+ * @param position bit
+ * @return 1 if the bit is set, 0 otherwise
+ */
+int AK_bitmap_is_set(AK_bitmap *bitmap, int position) {
+    unsigned int word;
+    int i, groups, group = position / BITMAP_GROUP_BITS, result = 0;
+    AK_PRO;
+    for (i = 0; i < bitmap->num_words && group >= 0; i++) {
+        word = bitmap->words[i];
+        groups = word & BITMAP_FILL ? (int) (word & BITMAP_FILL_GROUPS) : 1;
+        if (group < groups) {
+            if (word & BITMAP_FILL)
+                result = (word & BITMAP_FILL_ONES) != 0;
+            else
+                result = (word >> (position % BITMAP_GROUP_BITS)) & 1;
+        }
+        group -= groups;
+    }
+    AK_EPI;
+    return result;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that moves a reader to the next run of a bitmap if the current one is used up. After the last word
+ *        the bitmap continues with zeros.
+ * @param reader reader
+ * @return No return value
+ */
+static void AK_bitmap_reader_load(AK_bitmap_reader *reader) {
+    unsigned int word;
+
+    if (reader->groups > 0)
+        return;
+    if (reader->word >= reader->bitmap->num_words) {
+        reader->groups = INT_MAX;
+        reader->literal = 0;
+        return;
+    }
+    word = reader->bitmap->words[reader->word++];
+    if (word & BITMAP_FILL) {
+        reader->groups = word & BITMAP_FILL_GROUPS;
+        reader->literal = word & BITMAP_FILL_ONES ? BITMAP_LITERAL : 0;
+    } else {
+        reader->groups = 1;
+        reader->literal = word;
+    }
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that combines two bitmaps run by run. When both readers are in fills the whole overlap is combined
+ *        at once, otherwise one group is. Zeros at the end of the result are dropped.
+ * @param left first bitmap
+ * @param right second bitmap
+ * @param result combined bitmap, it is initialized by the function
+ * @param operation 0 for AND, 1 for OR and 2 for AND NOT
+ * @return No return value
+ */
+static void AK_bitmap_combine(AK_bitmap *left, AK_bitmap *right, AK_bitmap *result, int operation) {
+    AK_bitmap_reader a = {left, 0, 0, 0}, b = {right, 0, 0, 0};
+    unsigned int literal;
+    int groups, done = 0, total = (left->num_bits > right->num_bits ? left->num_bits : right->num_bits) / BITMAP_GROUP_BITS;
+
+    result->words = NULL;
+    result->num_words = 0;
+    result->max_words = 0;
+    result->num_bits = 0;
+    while (done < total) {
+        AK_bitmap_reader_load(&a);
+        AK_bitmap_reader_load(&b);
+        groups = a.groups < b.groups ? a.groups : b.groups;
+        groups = groups < total - done ? groups : total - done;
+        if (operation == 0)
+            literal = a.literal & b.literal;
+        else if (operation == 1)
+            literal = a.literal | b.literal;
+        else
+            literal = a.literal & ~b.literal & BITMAP_LITERAL;
+        AK_bitmap_add_groups(result, literal, groups);
+        a.groups -= groups;
+        b.groups -= groups;
+        done += groups;
+    }
+    if (result->num_words > 0 && result->words[result->num_words - 1] & BITMAP_FILL &&
+        !(result->words[result->num_words - 1] & BITMAP_FILL_ONES)) {
+        result->num_bits -= (result->words[result->num_words - 1] & BITMAP_FILL_GROUPS) * BITMAP_GROUP_BITS;
+        result->num_words--;
+    }
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that computes the intersection of two bitmaps without decompressing them, runs of both are
+ *        combined at once
+ * @param left first bitmap
+ * @param right second bitmap
+ * @param result bitmap with the bits set in both, it is initialized by the function
+ * @return No return value
+ */
+void AK_bitmap_and(AK_bitmap *left, AK_bitmap *right, AK_bitmap *result) {
+    AK_PRO;
+    AK_bitmap_combine(left, right, result, 0);
+    AK_EPI;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that computes the union of two bitmaps without decompressing them
+ * @param left first bitmap
+ * @param right second bitmap
+ * @param result bitmap with the bits set in either, it is initialized by the function
+ * @return No return value
+ */
+void AK_bitmap_or(AK_bitmap *left, AK_bitmap *right, AK_bitmap *result) {
+    AK_PRO;
+    AK_bitmap_combine(left, right, result, 1);
+    AK_EPI;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that computes the difference of two bitmaps without decompressing them
+ * @param left first bitmap
+ * @param right second bitmap
+ * @param result bitmap with the bits set in the first one and not in the second, it is initialized by the function
+ * @return No return value
+ */
+void AK_bitmap_and_not(AK_bitmap *left, AK_bitmap *right, AK_bitmap *result) {
+    AK_PRO;
+    AK_bitmap_combine(left, right, result, 2);
+    AK_EPI;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that computes the complement of a bitmap among the rows of a table
+ * @param bitmap bitmap
+ * @param rows bitmap of all rows of the table, from AK_bitmap_get_rows
+ * @param result bitmap with the rows that are not set in the bitmap, it is initialized by the function
+ * @return No return value
+ */
+void AK_bitmap_not(AK_bitmap *bitmap, AK_bitmap *rows, AK_bitmap *result) {
+    AK_PRO;
+    AK_bitmap_combine(rows, bitmap, result, 2);
+    AK_EPI;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that counts the set bits of a word
+ * @param word word
+ * @return number of set bits
+ */
+static int AK_bitmap_popcount(unsigned int word) {
+    word = word - ((word >> 1) & 0x55555555u);
+    word = (word & 0x33333333u) + ((word >> 2) & 0x33333333u);
+    word = (word + (word >> 4)) & 0x0f0f0f0fu;
+    return (int) ((word * 0x01010101u) >> 24);
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that counts the set bits of a bitmap, a fill of ones counts all of its bits at once
+ * @param bitmap bitmap
+ * @return number of set bits
+ */
+int AK_bitmap_count(AK_bitmap *bitmap) {
+    unsigned int word;
+    int i, count = 0;
+    AK_PRO;
+    for (i = 0; i < bitmap->num_words; i++) {
+        word = bitmap->words[i];
+        if (!(word & BITMAP_FILL))
+            count += AK_bitmap_popcount(word);
+        else if (word & BITMAP_FILL_ONES)
+            count += (word & BITMAP_FILL_GROUPS) * BITMAP_GROUP_BITS;
+    }
+    AK_EPI;
+    return count;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that starts going through the set bits of a bitmap
+ * @param cursor cursor
+ * @param bitmap bitmap, it has to stay the same while the cursor is used
+ * @return No return value
+ */
+void AK_bitmap_cursor_open(AK_bitmap_cursor *cursor, AK_bitmap *bitmap) {
+    AK_PRO;
+    cursor->bitmap = bitmap;
+    cursor->word = 0;
+    cursor->position = 0;
+    cursor->bit = 0;
+    AK_EPI;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that moves a cursor to the next set bit without the profiler
+ * @param cursor cursor
+ * @param position next set bit
+ * @return 1 if there was one more set bit, 0 otherwise
+ */
+static int AK_bitmap_cursor_step(AK_bitmap_cursor *cursor, int *position) {
+    unsigned int word, rest;
+    int length;
+
+    while (cursor->word < cursor->bitmap->num_words) {
+        word = cursor->bitmap->words[cursor->word];
+        if (word & BITMAP_FILL) {
+            length = (word & BITMAP_FILL_GROUPS) * BITMAP_GROUP_BITS;
+            if ((word & BITMAP_FILL_ONES) && cursor->bit < length) {
+                *position = cursor->position + cursor->bit++;
+                return 1;
+            }
+        } else {
+            length = BITMAP_GROUP_BITS;
+            rest = cursor->bit < length ? word >> cursor->bit : 0;
+            if (rest != 0) {
+                while (!(rest & 1)) {
+                    rest >>= 1;
+                    cursor->bit++;
+                }
+                *position = cursor->position + cursor->bit++;
+                return 1;
+            }
+        }
+        cursor->position += length;
+        cursor->word++;
+        cursor->bit = 0;
+    }
+    return 0;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that returns the next set bit of a bitmap, fills of zeros are skipped at once
+ * @param cursor cursor
+ * @param position next set bit
+ * @return 1 if there was one more set bit, 0 otherwise
+ */
+int AK_bitmap_cursor_next(AK_bitmap_cursor *cursor, int *position) {
+    int result;
+    AK_PRO;
+    result = AK_bitmap_cursor_step(cursor, position);
+    AK_EPI;
+    return result;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that copies a page from the cache, so that it stays the same while it is used
+ * @param address address of the page
+ * @return copy of the page
+ */
+static AK_block *AK_bitmap_read(int address) {
+    AK_block *block = (AK_block *) AK_malloc(sizeof (AK_block));
+
+    memcpy(block, ((AK_mem_block *) AK_get_block(address))->block, sizeof (AK_block));
+    return block;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that copies a changed page to the cache, which writes it to the disk later
+ * @param block page
+ * @return No return value
+ */
+static void AK_bitmap_write(AK_block *block) {
+    AK_mem_block *mem_block = (AK_mem_block *) AK_get_block(block->address);
+
+    memcpy(mem_block->block, block, sizeof (AK_block));
+    AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that finds the block of a segment with a number
+ * @param addresses extents of the segment
+ * @param number number of the block in the order of the extents
+ * @return block address, -1 if the segment has no such block
+ */
+static int AK_bitmap_block(table_addresses *addresses, int number) {
+    int i, blocks;
+
+    for (i = 0; i < MAX_EXTENTS_IN_SEGMENT && addresses->address_from[i] != 0; i++) {
+        blocks = addresses->address_to[i] - addresses->address_from[i];
+        if (number < blocks)
+            return addresses->address_from[i] + number;
+        number -= blocks;
+    }
+    return -1;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that finds the number of a block of a segment in the order of the extents
+ * @param addresses extents of the segment
+ * @param address block address
+ * @return number of the block, -1 if it does not belong to the segment
+ */
+static int AK_bitmap_block_number(table_addresses *addresses, int address) {
+    int i, number = 0;
+
+    for (i = 0; i < MAX_EXTENTS_IN_SEGMENT && addresses->address_from[i] != 0; i++) {
+        if (address >= addresses->address_from[i] && address < addresses->address_to[i])
+            return number + address - addresses->address_from[i];
+        number += addresses->address_to[i] - addresses->address_from[i];
+    }
+    return -1;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that opens a bitmap index
+ * @param indexName name of the index
+ * @param index open index
+ * @return EXIT_SUCCESS if there is such index, EXIT_ERROR otherwise
+ */
+static int AK_bitmap_open(char *indexName, AK_bitmap_index *index) {
+    table_addresses *addresses = AK_get_table_addresses(indexName);
+
+    index->name = indexName;
+    index->address = addresses->address_from[0];
+    index->addresses = NULL;
+    index->dirty = 0;
+    AK_free(addresses);
+    if (index->address == 0)
+        return EXIT_ERROR;
+    index->first = AK_bitmap_read(index->address);
+    index->info = (AK_bitmap_info *) index->first->data;
+    if (index->first->type != BLOCK_TYPE_BITMAP || strcmp(index->info->name, indexName) != 0) {
+        AK_free(index->first);
+        return EXIT_ERROR;
+    }
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that closes a bitmap index and writes its first block if it was changed
+ * @param index open index
+ * @return No return value
+ */
+static void AK_bitmap_close(AK_bitmap_index *index) {
+    if (index->dirty)
+        AK_bitmap_write(index->first);
+    AK_free(index->first);
+    if (index->addresses != NULL)
+        AK_free(index->addresses);
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that takes an empty page for the index, from the pages that are no longer used or from the next
+ *        block of the segment. The segment gets a new extent when all of its blocks are used.
+ * @param index open index
+ * @return empty page, NULL if there is no space
+ */
+static AK_block *AK_bitmap_new_page(AK_bitmap_index *index) {
+    AK_block *block;
+    int address;
+
+    if (index->info->free_list != 0) {
+        block = AK_bitmap_read(index->info->free_list);
+        index->info->free_list = ((AK_bitmap_page *) block->data)->next;
+    } else {
+        if (index->addresses == NULL)
+            index->addresses = AK_get_table_addresses(index->name);
+        address = AK_bitmap_block(index->addresses, index->info->num_pages);
+        if (address < 0) {
+            if (AK_init_new_extent(index->name, SEGMENT_TYPE_TABLE) == EXIT_ERROR) {
+                printf("AK_bitmap_new_page: Could not extend index %s!\n", index->name);
+                return NULL;
+            }
+            AK_free(index->addresses);
+            index->addresses = AK_get_table_addresses(index->name);
+            address = AK_bitmap_block(index->addresses, index->info->num_pages);
+            if (address < 0)
+                return NULL;
+        }
+        index->info->num_pages++;
+        block = AK_bitmap_read(address);
+    }
+    index->dirty = 1;
+    block->type = BLOCK_TYPE_BITMAP;
+    memset(block->data, 0, sizeof (block->data));
+    return block;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that writes the pages of a bitmap to the list of pages that are no longer used
+ * @param index open index
+ * @param page first page of the bitmap, 0 if it has none
+ * @return No return value
+ */
+static void AK_bitmap_free_pages(AK_bitmap_index *index, int page) {
+    AK_block *block;
+
+    while (page != 0) {
+        block = AK_bitmap_read(page);
+        page = ((AK_bitmap_page *) block->data)->next;
+        memset(block->data, 0, sizeof (block->data));
+        ((AK_bitmap_page *) block->data)->next = index->info->free_list;
+        index->info->free_list = block->address;
+        AK_bitmap_write(block);
+        AK_free(block);
+    }
+    index->dirty = 1;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that writes the words of a bitmap into a chain of new pages
+ * @param index open index
+ * @param bitmap bitmap
+ * @return first page, 0 if the bitmap has no words, EXIT_ERROR if the index could not be extended
+ */
+static int AK_bitmap_store(AK_bitmap_index *index, AK_bitmap *bitmap) {
+    AK_block *block, *next;
+    AK_bitmap_page *page;
+    int count, first, per_page = (DATA_BLOCK_SIZE * DATA_ENTRY_SIZE - (int) sizeof (AK_bitmap_page)) / (int) sizeof (unsigned int);
+    int done = 0;
+
+    if (bitmap->num_words == 0)
+        return 0;
+    block = AK_bitmap_new_page(index);
+    if (block == NULL)
+        return EXIT_ERROR;
+    first = block->address;
+    for (;;) {
+        page = (AK_bitmap_page *) block->data;
+        count = bitmap->num_words - done < per_page ? bitmap->num_words - done : per_page;
+        memcpy(block->data + sizeof (AK_bitmap_page), bitmap->words + done, count * sizeof (unsigned int));
+        page->num_words = count;
+        done += count;
+        next = done < bitmap->num_words ? AK_bitmap_new_page(index) : NULL;
+        page->next = next != NULL ? next->address : 0;
+        AK_bitmap_write(block);
+        AK_free(block);
+        if (next == NULL)
+            return done < bitmap->num_words ? EXIT_ERROR : first;
+        block = next;
+    }
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that reads the words of a bitmap from its chain of pages
+ * @param page first page of the bitmap, 0 if it has none
+ * @param num_bits number of bits of the bitmap
+ * @param bitmap bitmap, it is initialized by the function
+ * @return No return value
+ */
+static void AK_bitmap_load(int page, int num_bits, AK_bitmap *bitmap) {
+    AK_block *block;
+    AK_bitmap_page *header;
+
+    bitmap->words = NULL;
+    bitmap->num_words = 0;
+    bitmap->max_words = 0;
+    bitmap->num_bits = num_bits;
+    while (page != 0) {
+        block = ((AK_mem_block *) AK_get_block(page))->block;
+        header = (AK_bitmap_page *) block->data;
+        bitmap->max_words += header->num_words;
+        bitmap->words = (unsigned int *) AK_realloc(bitmap->words, bitmap->max_words * sizeof (unsigned int));
+        memcpy(bitmap->words + bitmap->num_words, block->data + sizeof (AK_bitmap_page), header->num_words * sizeof (unsigned int));
+        bitmap->num_words += header->num_words;
+        page = header->next;
+    }
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that returns the description of a value of the index
+ * @param index open index
+ * @param value number of the value
+ * @return description of the value in the copy of the first block
+ */
+static AK_bitmap_value *AK_bitmap_value_of(AK_bitmap_index *index, int value) {
+    return (AK_bitmap_value *) (index->first->data + index->first->tuple_dict[value].address);
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that finds a value among the values of the index
+ * @param index open index
+ * @param type type of the value
+ * @param value value
+ * @param size size of the value
+ * @return number of the value, -1 if the index does not have it
+ */
+static int AK_bitmap_find_value(AK_bitmap_index *index, int type, char *value, int size) {
+    AK_tuple_dict *dict;
+    int i;
+
+    for (i = 0; i < index->info->num_values; i++) {
+        dict = &index->first->tuple_dict[i];
+        if (dict->type == type &&
+            AK_compare_values(type, (char *) index->first->data + dict->address + sizeof (AK_bitmap_value),
+                              dict->size - (int) sizeof (AK_bitmap_value), value, size) == 0)
+            return i;
+    }
+    return -1;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that adds a value with an empty bitmap to the values of the index
+ * @param index open index
+ * @param type type of the value
+ * @param value value
+ * @param size size of the value
+ * @return number of the value, -1 if there is no space for it in the first block
+ */
+static int AK_bitmap_add_value(AK_bitmap_index *index, int type, char *value, int size) {
+    AK_block *first = index->first;
+    AK_tuple_dict *dict;
+    int needed = ((int) sizeof (AK_bitmap_value) + size + 3) / 4 * 4, i = index->info->num_values;
+
+    if (i >= DATA_BLOCK_SIZE || first->AK_free_space + needed > DATA_BLOCK_SIZE * DATA_ENTRY_SIZE)
+        return -1;
+    dict = &first->tuple_dict[i];
+    dict->type = type;
+    dict->size = sizeof (AK_bitmap_value) + size;
+    dict->address = first->AK_free_space;
+    memset(first->data + dict->address, 0, needed);
+    memcpy(first->data + dict->address + sizeof (AK_bitmap_value), value, size);
+    first->AK_free_space += needed;
+    index->info->num_values++;
+    index->dirty = 1;
+    return i;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that replaces the bitmap of a value of the index, the pages of the old bitmap are freed
+ * @param index open index
+ * @param value number of the value
+ * @param bitmap new bitmap
+ * @return EXIT_SUCCESS, EXIT_ERROR if the index could not be extended
+ */
+static int AK_bitmap_replace(AK_bitmap_index *index, int value, AK_bitmap *bitmap) {
+    AK_bitmap_value *description = AK_bitmap_value_of(index, value);
+    int page;
+
+    AK_bitmap_free_pages(index, description->page);
+    description->page = 0;
+    description->num_words = 0;
+    description->num_bits = 0;
+    page = AK_bitmap_store(index, bitmap);
+    if (page == EXIT_ERROR)
+        return EXIT_ERROR;
+    description->page = page;
+    description->num_words = bitmap->num_words;
+    description->num_bits = bitmap->num_bits;
+    index->dirty = 1;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that checks if any entry of a row is still there, deleted rows have none
+ * @param block block of the table
+ * @param row first entry of the row in the tuple dictionary
+ * @param num_attr number of attributes of the table
+ * @return 1 if the row is not deleted, 0 otherwise
+ */
+static int AK_bitmap_row_exists(AK_block *block, int row, int num_attr) {
+    int i;
+
+    for (i = 0; i < num_attr; i++) {
+        if (block->tuple_dict[row + i].size > 0 || block->tuple_dict[row + i].type != TYPE_INTERNAL)
+            return 1;
+    }
+    return 0;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that fills a new bitmap index from the rows of the table. Blocks are copied from the cache, where
+ *        the latest versions of them are, bitmaps of all values are built in memory while the table is read once and
+ *        written to pages at the end.
+ * @param index open index
+ * @param tblName name of the table
+ * @return EXIT_SUCCESS, EXIT_ERROR if the attribute has too many distinct values or the index could not be extended
+ */
+static int AK_bitmap_build(AK_bitmap_index *index, char *tblName) {
+    AK_bitmap_info *info = index->info;
+    table_addresses *addresses = AK_get_table_addresses(tblName);
+    AK_block *block = (AK_block *) AK_malloc(sizeof (AK_block));
+    AK_bitmap *bitmaps = NULL, rows = {NULL, 0, 0, 0};
+    AK_tuple_dict *dict;
+    int i, j, address, page, value = -1, max_values = 0, number = 0, result = EXIT_SUCCESS;
+    int num_attr = info->table_num_attr, per_block = DATA_BLOCK_SIZE / info->table_num_attr;
+
+    for (i = 0; i < MAX_EXTENTS_IN_SEGMENT && addresses->address_from[i] != 0 && result == EXIT_SUCCESS; i++) {
+        for (address = addresses->address_from[i]; address < addresses->address_to[i] && result == EXIT_SUCCESS;
+             address++, number++) {
+            memcpy(block, ((AK_mem_block *) AK_get_block(address))->block, sizeof (AK_block));
+            if (block->type != BLOCK_TYPE_NORMAL && block->type != BLOCK_TYPE_CHAINED)
+                continue;
+            for (j = 0; j + num_attr <= DATA_BLOCK_SIZE && block->tuple_dict[j].type != FREE_INT && result == EXIT_SUCCESS;
+                 j += num_attr) {
+                if (!AK_bitmap_row_exists(block, j, num_attr))
+                    continue;
+                AK_bitmap_set_bit(&rows, number * per_block + j / num_attr);
+                info->num_rows++;
+                dict = &block->tuple_dict[j + info->position];
+                if (dict->type != info->type || dict->size <= 0 || dict->size > MAX_VARCHAR_LENGTH)
+                    continue;
+                //rows with the same value as the row before them are common, the value is not searched for then
+                if (value < 0 || AK_compare_values(info->type, (char *) block->data + dict->address, dict->size,
+                        (char *) index->first->data + index->first->tuple_dict[value].address + sizeof (AK_bitmap_value),
+                        index->first->tuple_dict[value].size - (int) sizeof (AK_bitmap_value)) != 0)
+                    value = AK_bitmap_find_value(index, info->type, (char *) block->data + dict->address, dict->size);
+                if (value < 0) {
+                    value = AK_bitmap_add_value(index, info->type, (char *) block->data + dict->address, dict->size);
+                    if (value < 0) {
+                        printf("AK_create_bitmap_index: Attribute %s of table %s has too many distinct values for a bitmap index!\n",
+                               info->attribute, tblName);
+                        result = EXIT_ERROR;
+                        break;
+                    }
+                    if (value == max_values) {
+                        max_values = max_values > 0 ? 2 * max_values : 16;
+                        bitmaps = (AK_bitmap *) AK_realloc(bitmaps, max_values * sizeof (AK_bitmap));
+                    }
+                    memset(&bitmaps[value], 0, sizeof (AK_bitmap));
+                }
+                AK_bitmap_set_bit(&bitmaps[value], number * per_block + j / num_attr);
+                AK_bitmap_value_of(index, value)->num_set++;
+            }
+        }
+    }
+
+    for (i = 0; i < info->num_values; i++) {
+        if (result == EXIT_SUCCESS)
+            result = AK_bitmap_replace(index, i, &bitmaps[i]);
+        if (bitmaps[i].words != NULL)
+            AK_free(bitmaps[i].words);
+    }
+    if (result == EXIT_SUCCESS) {
+        page = AK_bitmap_store(index, &rows);
+        if (page == EXIT_ERROR)
+            result = EXIT_ERROR;
+        info->rows_page = page;
+        info->rows_words = rows.num_words;
+        info->rows_bits = rows.num_bits;
+    }
+    if (rows.words != NULL)
+        AK_free(rows.words);
+    if (bitmaps != NULL)
+        AK_free(bitmaps);
+    AK_free(block);
+    AK_free(addresses);
+    return result;
+}
 /**
   @author Saša Vukšić
   @brief Function that examines whether list L contains operator ele
@@ -46,411 +902,577 @@
     return 0;
 }
 
+
 /**
- * @author Saša Vukšić, Lovro Predovan
- * @brief Function that reads table on which we create index and call functions for creating index
-           Elements that will be in index are put in list indexLista and headerAttributes. According to those elements new indexes
-           are created.
+ * @author Karlo Vuković
+ * @brief Function that converts a value given as text to the type of an attribute
+ * @param type type of the attribute
+ * @param text value as text
+ * @param value converted value
+ * @return size of the converted value
+ */
+static int AK_bitmap_parse(int type, char *text, char *value) {
+    int integer;
+    float real;
+    double number;
+
+    switch (type) {
+        case TYPE_INT:
+            integer = atoi(text);
+            memcpy(value, &integer, sizeof (int));
+            return sizeof (int);
+        case TYPE_FLOAT:
+            real = (float) atof(text);
+            memcpy(value, &real, sizeof (float));
+            return sizeof (float);
+        case TYPE_NUMBER:
+            number = atof(text);
+            memcpy(value, &number, sizeof (double));
+            return sizeof (double);
+        default:
+            strncpy(value, text, MAX_VARCHAR_LENGTH - 1);
+            value[MAX_VARCHAR_LENGTH - 1] = '\0';
+            return strlen(value);
+    }
+}
 
+/**
+ * @author Saša Vukšić, Lovro Predovan, updated by Karlo Vuković (compressed bitmaps)
+ * @brief Function that creates a bitmap index named <table><attribute>_bmapIndex on each attribute of the list
  * @param tblName name of table
- * @param attributes list of attributes on which we will create indexes
+ * @param attributes list of attributes on which we will create indexes, by attribute_name of the elements
  * @return No return value
  * */
- void AK_create_Index_Table(char *tblName, struct list_node *attributes)
- {
-    int num_attr;
-    int i, j, k;
+void AK_create_Index_Table(char *tblName, struct list_node *attributes) {
+    struct list_node *attribute;
+    AK_PRO;
+    for (attribute = AK_First_L2(attributes); attribute != NULL; attribute = attribute->next)
+        AK_create_bitmap_index(tblName, attribute->attribute_name);
+    AK_EPI;
+}
 
+/**
+ * @author Karlo Vuković
+ * @brief Function that creates a bitmap index on an attribute of a table. Every distinct value of the attribute gets
+ *        a compressed bitmap of the rows with it, and the index keeps one more bitmap of all rows of the table.
+ *        Bitmap indices are meant for attributes with few distinct values, they have to fit into the first block.
+ *        Tables with the PAX layout can not be indexed.
+ * @param tblName name of table
+ * @param attribute name of the attribute
+ * @return EXIT_SUCCESS if the index was created, EXIT_ERROR otherwise
+ */
+int AK_create_bitmap_index(char *tblName, char *attribute) {
+    AK_header *table_header;
+    AK_header i_header[MAX_ATTRIBUTES];
+    AK_bitmap_index index;
     table_addresses *addresses;
-    AK_header *temp_head;
-    int temp_int;
-    char temp_char[ MAX_VARCHAR_LENGTH ];
-
-    struct list_node *some_element;
-    struct list_node *e, *ee;
-    struct list_node *headerAtributes;
-    int br;
-    char * indexName;
-    int indexed_attr_position;
-
-
-    AK_header t_header[ MAX_ATTRIBUTES ];
-    AK_header t_headerr[ MAX_ATTRIBUTES ];
-    AK_header* tempHeader;
-
+    char indexName[MAX_ATT_NAME];
+    int i, num_attr, address, result;
     AK_PRO;
 
-    addresses = (table_addresses*) AK_get_table_addresses(tblName);
+    snprintf(indexName, MAX_ATT_NAME, "%s%s_bmapIndex", tblName, attribute);
     num_attr = AK_num_attr(tblName);
-    temp_head = (AK_header *) AK_get_header(tblName);
-    headerAtributes = (struct list_node *) AK_malloc(sizeof (struct list_node));
-
-
-    for (i = 0; i < num_attr; i++)
-    {
-        some_element = AK_First_L2(attributes);
-        while (some_element != 0)
-        {
-            if (strcmp((temp_head + i)->att_name, some_element->attribute_name) == 0)
-            {
-                indexed_attr_position = i;
-                AK_Init_L3(&headerAtributes);
-                br = 0;
-
-                while (addresses->address_from[ br ] != 0)
-                {
-                    for (j = addresses->address_from[ br ]; j < addresses->address_to[ br ]; j++)
-                    {
-                        AK_block *temp = (AK_block*) AK_read_block(j);
-                        for (k = i; k < DATA_BLOCK_SIZE; k = k + num_attr)
-                        {
-                            if (temp->tuple_dict[ k ].size > 0)
-                            {
-                                switch (temp->tuple_dict[ k ].type)
-                                {
-
-
-                                    case TYPE_INT:
-                                    memcpy(&temp_int, &(temp->data[ temp->tuple_dict[ k ].address]),
-                                     temp->tuple_dict[k].size);
-                                    temp_int = sprintf(temp_char, "%d", temp_int);
-
-                                    ee = (struct list_node *) AK_First_L2(headerAtributes);
-                                    if (ee == 0)
-                                    {
-                                        AK_Insert_New_Element(TYPE_VARCHAR, temp_char, "indexLista", temp_char, headerAtributes);
-                                    }
-                                    else
-                                    {
-                                        if (AK_If_ExistOp(headerAtributes, temp_char) == 0)
-                                        {
-                                            ee = (struct list_node *) AK_End_L2(headerAtributes);
-                                            AK_Insert_New_Element(TYPE_VARCHAR, temp_char, "indexLista", temp_char, ee);
-                                        }
-                                    }
-                                    //printf("TEMP %-10s \n", temp_char);
-                                    break;
-
-                                //FLOAT VALUES ARE USUALLY NOT BEING INDEXED
-                                    case TYPE_FLOAT:
-                                    break;
-
-
-                                    case TYPE_VARCHAR:
-                                    memcpy(temp_char, &(temp->data[ temp->tuple_dict[ k ].address]),
-                                     temp->tuple_dict[k].size);
-                                    temp_char[ temp->tuple_dict[k].size ] = '\0';
-
-                                    ee = (struct list_node *) AK_First_L2(headerAtributes);
-                                    if (ee == 0)
-                                    {
-                                        AK_Insert_New_Element(TYPE_VARCHAR, temp_char, "indexLista", temp_char, headerAtributes);
-                                    }
-                                    else
-                                    {
-                                        if (AK_If_ExistOp(headerAtributes, temp_char) == 0)
-                                        {
-                                            ee = (struct list_node *) AK_End_L2(headerAtributes);
-                                            AK_Insert_New_Element(TYPE_VARCHAR, temp_char, "indexLista", temp_char, ee);
-                                        }
-                                    }
-                                    break;
-                                }
-
-                            }
-                        }
-                    }
-                    br++;
-                }
-
-
-                //PART WHERE WE CHECK EVERY ATTRIBUTE
-                int brr;
-                int z;
-                char inde[50];
-                int startAddress;
-                switch ((temp_head + i)->type)
-                {
-                    case TYPE_VARCHAR:
-                    brr = 2; //3 First two places are reserved for block and row pointers
-                    e = (struct list_node *) AK_First_L2(headerAtributes);
-                    while (e != 0)
-                    {
-                        tempHeader = (AK_header*) AK_create_header(e->attribute_name, TYPE_VARCHAR, FREE_INT, FREE_CHAR, FREE_CHAR);
-                        memcpy(t_header + brr, tempHeader, sizeof ( AK_header));
-                        e = (struct list_node *) AK_Next_L2(e);
-                        brr++;
-                    }
-                    //ADDITIONAL ATTRIBTE IS PRESENT FOR BLOCK ADDRESS
-                    tempHeader = (AK_header*) AK_create_header("addBlock", TYPE_INT, FREE_INT, FREE_CHAR, FREE_CHAR);
-                    memcpy(t_header, tempHeader, sizeof ( AK_header));
-                    tempHeader = (AK_header*) AK_create_header("indexTd", TYPE_INT, FREE_INT, FREE_CHAR, FREE_CHAR);
-                    memcpy(t_header + 1, tempHeader, sizeof ( AK_header));
-
-                    for (z = brr; z < MAX_ATTRIBUTES; z++)
-                    {
-                        memcpy(t_header + z, "\0", sizeof ( "\0"));
-                    }
-
-                    //INITIALIZATION OF NEW HEADER FILE
-                    strcpy(inde, tblName);
-                    indexName = strcat(inde, (temp_head + i)->att_name);
-                    indexName = strcat(indexName, "_bmapIndex");
-                //Error: argument of type "char" is incompatible with parameter of type "char *"
-                    startAddress = AK_initialize_new_index_segment(indexName,AK_get_table_id(tblName),indexed_attr_position, t_header);
-
-
-                    if (startAddress != EXIT_ERROR)
-                    {
-                        printf("\nINDEX %s CREATED!\n", indexName);
-                        //funtion that fills index with attribute values
-                        AK_create_Index(tblName, indexName, (temp_head + i)->att_name, i, num_attr, t_header);
-                    }
-
-                    break;
-
-                    case TYPE_INT:
-                    brr = 2; //3 First two places are reserved for block and row pointers
-
-                    tempHeader = (AK_header*) AK_create_header("addBlock", TYPE_INT, FREE_INT, FREE_CHAR, FREE_CHAR);
-                    memcpy(t_headerr, tempHeader, sizeof ( AK_header));
-
-                    tempHeader = (AK_header*) AK_create_header("indexTd", TYPE_INT, FREE_INT, FREE_CHAR, FREE_CHAR);
-                    memcpy(t_headerr + 1, tempHeader, sizeof ( AK_header));
+    table_header = (AK_header *) AK_get_header(tblName);
+    if (table_header == NULL || num_attr <= 0 || num_attr > MAX_ATTRIBUTES) {
+        printf("AK_create_bitmap_index: Table %s does not exist or has too many attributes!\n", tblName);
+        AK_free(table_header);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    if (AK_get_storage_layout(tblName) != BLOCK_TYPE_NORMAL) {
+        printf("AK_create_bitmap_index: Table %s has the PAX layout, it can not be indexed!\n", tblName);
+        AK_free(table_header);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    for (i = 0; i < num_attr && strcmp(table_header[i].att_name, attribute) != 0; i++)
+        ;
+    addresses = AK_get_table_addresses(indexName);
+    address = addresses->address_from[0];
+    AK_free(addresses);
+    if (i == num_attr || address != 0) {
+        printf("AK_create_bitmap_index: %s %s!\n", i == num_attr ? "There is no attribute" : "Index already exists on",
+               attribute);
+        AK_free(table_header);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    memset(i_header, 0, sizeof (i_header));
+    memcpy(&i_header[0], &table_header[i], sizeof (AK_header));
+    if (AK_initialize_new_segment(indexName, SEGMENT_TYPE_INDEX, i_header) == EXIT_ERROR) {
+        AK_free(table_header);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
 
-                    e = (struct list_node *) AK_First_L2(headerAtributes);
-                    while (e != 0)
-                    {
-                        tempHeader = (AK_header*) AK_create_header(e->attribute_name, TYPE_INT, FREE_INT, FREE_CHAR, FREE_CHAR);
-                        memcpy(t_headerr + brr, tempHeader, sizeof ( AK_header));
-                        e = (struct list_node *) AK_Next_L2(e);
-                        brr++;
-                    }
+    pthread_mutex_lock(&AK_bitmap_mutex);
+    addresses = AK_get_table_addresses(indexName);
+    index.name = indexName;
+    index.address = addresses->address_from[0];
+    index.addresses = addresses;
+    index.first = AK_bitmap_read(index.address);
+    index.first->type = BLOCK_TYPE_BITMAP;
+    index.first->AK_free_space = ((int) sizeof (AK_bitmap_info) + 3) / 4 * 4;
+    memset(index.first->data, 0, sizeof (index.first->data));
+    index.info = (AK_bitmap_info *) index.first->data;
+    strncpy(index.info->name, indexName, MAX_ATT_NAME - 1);
+    strncpy(index.info->table, tblName, MAX_ATT_NAME - 1);
+    strncpy(index.info->attribute, attribute, MAX_ATT_NAME - 1);
+    index.info->position = i;
+    index.info->type = table_header[i].type;
+    index.info->table_num_attr = num_attr;
+    index.info->num_pages = 1;
+    index.dirty = 1;
+    result = AK_bitmap_build(&index, tblName);
+    AK_bitmap_close(&index);
+    pthread_mutex_unlock(&AK_bitmap_mutex);
+    AK_free(table_header);
+
+    if (result == EXIT_ERROR)
+        AK_delete_segment(indexName, SEGMENT_TYPE_TABLE);
+    AK_index_catalog_changed();
+    AK_EPI;
+    return result;
+}
 
+/**
+ * @author Saša Vukšić, updated by Karlo Vuković (compressed bitmaps)
+ * @brief Function that fetches the values from the bitmap index if there is one for a given table.
+ * It should be started when we are making selection on the table with bitmap index.
+ * @param tableName name of table
+ * @param attributeName name of attribute
+ * @param attributeValue value of attribute as text, converted to the type of the attribute
+ * @return list of adresses of rows with the value, in the order of the table
+ **/
+list_ad* AK_get_Attribute(char *tableName, char *attributeName, char *attributeValue) {
+    list_ad *list = (list_ad *) AK_malloc(sizeof (list_ad));
+    element_ad last = list;
+    AK_bitmap_info info;
+    AK_bitmap bitmap;
+    struct_add *adds;
+    char indexName[MAX_ATT_NAME], value[MAX_VARCHAR_LENGTH];
+    int i, size, count;
+    AK_PRO;
 
-                    for (z = brr; z < MAX_ATTRIBUTES; z++)
-                    {
-                        memcpy(t_headerr + z, "\0", sizeof ( "\0"));
-                    }
+    AK_InitializelistAd(list);
+    snprintf(indexName, MAX_ATT_NAME, "%s%s_bmapIndex", tableName, attributeName);
+    if (AK_bitmap_get_info(indexName, &info) == EXIT_ERROR) {
+        printf("There is no index for table: %s on attribute: %s\n", tableName, attributeName);
+        AK_EPI;
+        return list;
+    }
+    size = AK_bitmap_parse(info.type, attributeValue, value);
+    AK_bitmap_get(indexName, info.type, value, size, &bitmap);
+    count = AK_bitmap_to_rids(tableName, &bitmap, NULL, 0);
+    adds = (struct_add *) AK_malloc((count > 0 ? count : 1) * sizeof (struct_add));
+    count = AK_bitmap_to_rids(tableName, &bitmap, adds, count);
+    for (i = 0; i < count; i++) {
+        AK_Insert_NewelementAd(adds[i].addBlock, adds[i].indexTd, attributeName, last);
+        last = last->next;
+    }
+    AK_free(adds);
+    AK_bitmap_free(&bitmap);
+    AK_EPI;
+    return list;
+}
 
-                    strcpy(inde, tblName);
-                    indexName = strcat(inde, (temp_head + i)->att_name);
-                    indexName = strcat(indexName, "_bmapIndex");
-                //Error: argument of type "char" is incompatible with parameter of type "char *"
-                    startAddress = AK_initialize_new_index_segment(indexName,AK_get_table_id(tblName),indexed_attr_position, t_headerr);
-                    if (startAddress != EXIT_ERROR)
-                    {
-                        printf("\nINDEX %s CREATED!\n", indexName);
-                        AK_create_Index(tblName, indexName, (temp_head + i)->att_name, i, num_attr, t_header);
-                    }
-                    break;
-                }
+/**
+ * @author Saša Vukšić, updated by Karlo Vuković (compressed bitmaps)
+ * @brief Function that updates the index after the value of a row was changed. The row is removed from the bitmap
+ * of the old value and added to the bitmap of the new one, which is added to the index if it is not there yet.
+ * @param addBlock adress of block
+ * @param addTD adress of tuple dict
+ * @param tableName name of table
+ * @param attributeName name of attribute
+ * @param attributeValue value of atribute
+ * @param newAttributeValue new value of updated attribute
+ * @return No return value
+ **/
+void AK_update(int addBlock, int addTd, char *tableName, char *attributeName, char *attributeValue, char *newAttributeValue) {
+    AK_bitmap_index index;
+    AK_bitmap_value *description;
+    AK_bitmap row = {NULL, 0, 0, 0}, bitmap, changed;
+    table_addresses *addresses;
+    char indexName[MAX_ATT_NAME], value[MAX_VARCHAR_LENGTH];
+    int size, number, position;
+    AK_PRO;
 
-            }
-            some_element = (struct list_node *) AK_Next_L2(some_element);
+    snprintf(indexName, MAX_ATT_NAME, "%s%s_bmapIndex", tableName, attributeName);
+    pthread_mutex_lock(&AK_bitmap_mutex);
+    if (AK_bitmap_open(indexName, &index) == EXIT_ERROR) {
+        pthread_mutex_unlock(&AK_bitmap_mutex);
+        printf("There is no index for table : %s on attribute: %s\n", tableName, attributeName);
+        AK_EPI;
+        return;
+    }
+    addresses = AK_get_table_addresses(tableName);
+    number = AK_bitmap_block_number(addresses, addBlock);
+    AK_free(addresses);
+    if (number < 0) {
+        AK_bitmap_close(&index);
+        pthread_mutex_unlock(&AK_bitmap_mutex);
+        printf("AK_update: Block %d is not a block of table %s!\n", addBlock, tableName);
+        AK_EPI;
+        return;
+    }
+    position = number * (DATA_BLOCK_SIZE / index.info->table_num_attr) + addTd / index.info->table_num_attr;
+    AK_bitmap_set_bit(&row, position);
+
+    size = AK_bitmap_parse(index.info->type, attributeValue, value);
+    number = AK_bitmap_find_value(&index, index.info->type, value, size);
+    if (number >= 0) {
+        description = AK_bitmap_value_of(&index, number);
+        AK_bitmap_load(description->page, description->num_bits, &bitmap);
+        if (AK_bitmap_is_set(&bitmap, position)) {
+            AK_bitmap_combine(&bitmap, &row, &changed, 2);
+            if (AK_bitmap_replace(&index, number, &changed) == EXIT_SUCCESS)
+                AK_bitmap_value_of(&index, number)->num_set--;
+            AK_bitmap_free(&changed);
         }
+        AK_bitmap_free(&bitmap);
     }
 
-    AK_DeleteAll_L3(&headerAtributes);
-    AK_free(headerAtributes);
-    AK_free(tempHeader);
-    AK_free(temp_head);
+    size = AK_bitmap_parse(index.info->type, newAttributeValue, value);
+    number = AK_bitmap_find_value(&index, index.info->type, value, size);
+    if (number < 0)
+        number = AK_bitmap_add_value(&index, index.info->type, value, size);
+    if (number < 0)
+        printf("AK_update: There is no space for value %s in index %s!\n", newAttributeValue, indexName);
+    else {
+        description = AK_bitmap_value_of(&index, number);
+        AK_bitmap_load(description->page, description->num_bits, &bitmap);
+        if (!AK_bitmap_is_set(&bitmap, position)) {
+            AK_bitmap_combine(&bitmap, &row, &changed, 1);
+            if (AK_bitmap_replace(&index, number, &changed) == EXIT_SUCCESS)
+                AK_bitmap_value_of(&index, number)->num_set++;
+            AK_bitmap_free(&changed);
+        }
+        AK_bitmap_free(&bitmap);
+    }
+    AK_bitmap_close(&index);
+    pthread_mutex_unlock(&AK_bitmap_mutex);
+    AK_bitmap_free(&row);
     AK_EPI;
-
 }
 
+/**
+ * @author Karlo Vuković
+ * @brief Function that orders changes of a bitmap index by value and bit
+ * @param left first change
+ * @param right second change
+ * @return negative number if the first change comes first, 0 if they are equal, otherwise positive number
+ */
+static int AK_bitmap_change_compare(const void *left, const void *right) {
+    const AK_bitmap_change *a = (const AK_bitmap_change *) left, *b = (const AK_bitmap_change *) right;
+
+    if (a->value != b->value)
+        return a->value < b->value ? -1 : 1;
+    if (a->position != b->position)
+        return a->position < b->position ? -1 : 1;
+    return a->insert - b->insert;
+}
 
 /**
- * @author Saša Vukšić, Lovro Predovan
- * @brief Function that loads index table with the value of particulary atribute
- * @param tblName source table
- * @param tblNameIndex new name of index table
- * @param attributeName attribute on which we make index
- * @param positionTbl position of attribute in header of table
- * @param numAtributes number of attributes in table
- * @param headerIndex header of index table
+ * @author Karlo Vuković
+ * @brief Function that clears and sets bits of a stored bitmap. The bits are combined with the bitmap in two passes
+ *        over its runs, so the bitmap is decompressed nowhere and written once.
+ * @param page first page of the bitmap, 0 if it has none
+ * @param num_bits number of bits of the bitmap
+ * @param changes changes of the bitmap, in the order of their bits
+ * @param num_changes number of changes
+ * @param result changed bitmap, it is initialized by the function
  * @return No return value
  */
- void AK_create_Index(char *tblName, char *tblNameIndex, char *attributeName, int positionTbl, int numAtributes, AK_header *headerIndex)
- {
-
-    table_addresses *addresses;
-    AK_block *temp;
+static void AK_bitmap_change_bits(int page, int num_bits, AK_bitmap_change *changes, int num_changes,
+                                  AK_bitmap *result) {
+    AK_bitmap bitmap, cleared = {NULL, 0, 0, 0}, set = {NULL, 0, 0, 0}, rest;
+    int i;
 
-    int i, j, k;
-    int temp_int;
-    int temp_indexTd;
-    char temp_char[ MAX_VARCHAR_LENGTH ];
-    i = 0;
-    struct list_node *row_root;
+    for (i = 0; i < num_changes; i++)
+        AK_bitmap_set_bit(changes[i].insert ? &set : &cleared, changes[i].position);
+    AK_bitmap_load(page, num_bits, &bitmap);
+    AK_bitmap_combine(&bitmap, &cleared, &rest, 2);
+    AK_bitmap_combine(&rest, &set, result, 1);
+    AK_bitmap_free(&bitmap);
+    AK_bitmap_free(&cleared);
+    AK_bitmap_free(&set);
+    AK_bitmap_free(&rest);
+}
 
+/**
+ * @author Karlo Vuković
+ * @brief Function that applies changes of rows of the indexed table to a bitmap index. Changes are grouped by value
+ *        and sorted by row, so the bitmap of every value that changed is combined with the changed bits and written
+ *        once, however many of its rows changed. Bits of the rows follow their place in the table, so rows that were
+ *        added do not move the others and the index is not rebuilt.
+ * @param indexName name of the index
+ * @param deltas changes of rows of the table
+ * @param num_deltas number of changes
+ * @return EXIT_SUCCESS, EXIT_ERROR if there is no such index, a value does not fit into it or it could not be
+ *         extended
+ */
+int AK_bitmap_apply(char *indexName, AK_index_delta *deltas, int num_deltas) {
+    AK_bitmap_index index;
+    AK_bitmap_change *changes, *change;
+    AK_bitmap_value *description;
+    AK_bitmap bitmap;
+    AK_tuple_dict *dict;
+    table_addresses *addresses;
+    int i, last, number, count, per_block, page, num_changes = 0, result = EXIT_SUCCESS;
     AK_PRO;
-
-    addresses = (table_addresses*) AK_get_table_addresses(tblName);
-    temp = (AK_block*) AK_read_block(addresses->address_from[0]);
-
-    while (addresses->address_from[ i ] != 0)
-    {
-        for (j = addresses->address_from[ i ]; j < addresses->address_to[ i ]; j++)
-        {
-            AK_block *temp = (AK_block*) AK_read_block(j);
-            for (k = positionTbl; k < DATA_BLOCK_SIZE; k = k + numAtributes)
-            {
-
-                if (temp->tuple_dict[ k ].size > 0)
-                {
-                    switch (temp->tuple_dict[ k ].type)
-                    {
-
-                        case TYPE_INT:
-                            memcpy(&temp_int, &(temp->data[ temp->tuple_dict[ k ].address]),
-                             temp->tuple_dict[k].size);
-                            temp_int = sprintf(temp_char, "%d", temp_int);
-                            row_root = (struct list_node *) AK_malloc(sizeof (struct list_node));
-                            AK_Init_L3(&row_root);
-                            temp_indexTd = k - positionTbl;
-
-                            AK_Insert_New_Element(TYPE_INT, &(temp->address), tblNameIndex, "addBlock", row_root);
-                            AK_Insert_New_Element(TYPE_INT, &temp_indexTd, tblNameIndex, "indexTd", row_root);
-                            //Error: argument of type "const char *" is incompatible with parameter of type "void *"
-                            AK_Insert_New_Element(TYPE_VARCHAR, "1", tblNameIndex, temp_char, row_root);
-
-                            AK_insert_row(row_root);
-                            AK_DeleteAll_L3(&row_root);
-                            AK_free(row_root);
-                        break;
-
-
-                        case TYPE_FLOAT:
-                        break;
-
-                        case TYPE_VARCHAR:
-                            memcpy(temp_char, &(temp->data[ temp->tuple_dict[ k ].address]),
-                             temp->tuple_dict[k].size);
-                            temp_char[ temp->tuple_dict[k].size ] = '\0';
-                            row_root = (struct list_node *) AK_malloc(sizeof (struct list_node));
-                            AK_Init_L3(&row_root);
-                            temp_indexTd = k - positionTbl;
-
-                            AK_Insert_New_Element(TYPE_INT, &(temp->address), tblNameIndex, "addBlock", row_root);
-                            AK_Insert_New_Element(TYPE_INT, &temp_indexTd, tblNameIndex, "indexTd", row_root);
-                            AK_Insert_New_Element(TYPE_VARCHAR, "1", tblNameIndex, temp_char, row_root);
-
-                            AK_insert_row(row_root);
-
-
-                            AK_DeleteAll_L3(&row_root);
-                            AK_free(row_root);
-                        break;
-                    }
-                }
+    pthread_mutex_lock(&AK_bitmap_mutex);
+    if (AK_bitmap_open(indexName, &index) == EXIT_ERROR) {
+        pthread_mutex_unlock(&AK_bitmap_mutex);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    changes = (AK_bitmap_change *) AK_malloc((num_deltas > 0 ? num_deltas : 1) * sizeof (AK_bitmap_change));
+    addresses = AK_get_table_addresses(index.info->table);
+    per_block = DATA_BLOCK_SIZE / index.info->table_num_attr;
+    for (i = 0; i < num_deltas; i++) {
+        number = AK_bitmap_block_number(addresses, deltas[i].add.addBlock);
+        if (number < 0)
+            continue;
+        change = &changes[num_changes++];
+        change->position = number * per_block + deltas[i].add.indexTd / index.info->table_num_attr;
+        change->insert = deltas[i].insert;
+        change->value = -1;
+        dict = &deltas[i].entries[index.info->position];
+        if (dict->type != index.info->type || dict->size <= 0 || dict->size > MAX_VARCHAR_LENGTH)
+            continue;
+        change->value = AK_bitmap_find_value(&index, index.info->type, deltas[i].data + dict->address, dict->size);
+        if (change->value < 0 && change->insert) {
+            change->value = AK_bitmap_add_value(&index, index.info->type, deltas[i].data + dict->address, dict->size);
+            if (change->value < 0) {
+                printf("AK_bitmap_apply: Attribute %s of table %s has too many distinct values for a bitmap index!\n",
+                       index.info->attribute, index.info->table);
+                result = EXIT_ERROR;
             }
         }
-        i++;
     }
-
     AK_free(addresses);
-    AK_free(temp);
-    // AK_free(t_header);
+
+    //changes of every value follow each other in the order of their bits
+    qsort(changes, num_changes, sizeof (AK_bitmap_change), AK_bitmap_change_compare);
+    for (i = 0; i < num_changes && result == EXIT_SUCCESS; i = last) {
+        for (last = i; last < num_changes && changes[last].value == changes[i].value; last++)
+            ;
+        if (changes[i].value < 0)
+            continue;
+        description = AK_bitmap_value_of(&index, changes[i].value);
+        AK_bitmap_change_bits(description->page, description->num_bits, changes + i, last - i, &bitmap);
+        count = AK_bitmap_count(&bitmap);
+        if (AK_bitmap_replace(&index, changes[i].value, &bitmap) == EXIT_SUCCESS)
+            AK_bitmap_value_of(&index, changes[i].value)->num_set = count;
+        else
+            result = EXIT_ERROR;
+        AK_bitmap_free(&bitmap);
+    }
+
+    //bitmap of all rows, nulls included
+    for (i = 0; i < num_changes; i++)
+        changes[i].value = 0;
+    qsort(changes, num_changes, sizeof (AK_bitmap_change), AK_bitmap_change_compare);
+    AK_bitmap_change_bits(index.info->rows_page, index.info->rows_bits, changes, num_changes, &bitmap);
+    index.info->num_rows = AK_bitmap_count(&bitmap);
+    AK_bitmap_free_pages(&index, index.info->rows_page);
+    page = AK_bitmap_store(&index, &bitmap);
+    if (page == EXIT_ERROR) {
+        result = EXIT_ERROR;
+        page = 0;
+        bitmap.num_words = 0;
+        bitmap.num_bits = 0;
+    }
+    index.info->rows_page = page;
+    index.info->rows_words = bitmap.num_words;
+    index.info->rows_bits = bitmap.num_bits;
+    AK_bitmap_free(&bitmap);
+    AK_free(changes);
+    AK_bitmap_close(&index);
+    pthread_mutex_unlock(&AK_bitmap_mutex);
     AK_EPI;
+    return result;
 }
 
 /**
- * @author Saša Vukšić, Lovro Predovan
- * @brief Function that gets adresses of the particuliar attribute from bitmap index. It fetches addresses of indexes and header
-          of index table.  Using while loop it goes through index and gets necessary data. That data is put in a list called
-          add_root.
- * @param indexName name of index
- * @param attribute name of attribute
- * @return list of adresses
+ * @author Lovro Predovan, updated by Karlo Vuković (compressed bitmaps)
+ * @brief Function that deletes bitmap index based on the name of index
+ * @param indexName bitmap index name
+ * @return EXIT_SUCCESS if the index was deleted, EXIT_ERROR if there is no such index
  **/
- list_ad* AK_get_attribute(char *indexName, char *attribute)
- {
-    int num_attr;
-    int i, j, k;
-
-    //start and end addresses of segment's
-    table_addresses *addresses;
-    AK_header *temp_head;
-    int temp_int;
-    char temp_char[ MAX_VARCHAR_LENGTH ];
-    float temp_float;
-    int b, br = 0;
-    int addBlock, indexTd;
-    list_ad *add_root;
+int AK_delete_bitmap_index(char *indexName) {
+    AK_bitmap_index index;
+    int result;
     AK_PRO;
+    pthread_mutex_lock(&AK_bitmap_mutex);
+    result = AK_bitmap_open(indexName, &index);
+    if (result == EXIT_SUCCESS) {
+        AK_bitmap_close(&index);
+        AK_delete_segment(indexName, SEGMENT_TYPE_TABLE);
+    }
+    pthread_mutex_unlock(&AK_bitmap_mutex);
+    AK_index_catalog_changed();
+    AK_EPI;
+    return result;
+}
 
-    addresses = (table_addresses*) AK_get_index_addresses(indexName);
-    num_attr = AK_num_index_attr(indexName);
-    temp_head = (AK_header *) AK_get_index_header(indexName);
+/**
+ * @author Lovro Predovan, updated by Karlo Vuković (compressed bitmaps)
+ * @brief Function that updates the index. Function deletes and recreates the index if the number of rows of the
+ * table changed since it was built
+ * @param tableName name of table
+ * @param attributeName name of attribute
+ * @return No return value
+ **/
+void AK_add_to_bitmap_index(char *tableName, char *attributeName) {
+    AK_bitmap_info info;
+    char indexName[MAX_ATT_NAME];
+    AK_PRO;
+    snprintf(indexName, MAX_ATT_NAME, "%s%s_bmapIndex", tableName, attributeName);
+    if (AK_bitmap_get_info(indexName, &info) == EXIT_SUCCESS && info.num_rows != AK_get_num_records(tableName)) {
+        AK_delete_bitmap_index(indexName);
+        AK_create_bitmap_index(tableName, attributeName);
+    }
+    AK_EPI;
+}
 
-    add_root = (list_ad *) AK_malloc(sizeof (list_ad));
-    AK_InitializelistAd(add_root);
+/**
+ * @author Karlo Vuković
+ * @brief Function that reads the description of a bitmap index
+ * @param indexName name of the index
+ * @param info description of the index
+ * @return EXIT_SUCCESS if the index exists, EXIT_ERROR otherwise
+ */
+int AK_bitmap_get_info(char *indexName, AK_bitmap_info *info) {
+    AK_bitmap_index index;
+    int result;
+    AK_PRO;
+    pthread_mutex_lock(&AK_bitmap_mutex);
+    result = AK_bitmap_open(indexName, &index);
+    if (result == EXIT_SUCCESS) {
+        memcpy(info, index.info, sizeof (AK_bitmap_info));
+        AK_bitmap_close(&index);
+    }
+    pthread_mutex_unlock(&AK_bitmap_mutex);
+    AK_EPI;
+    return result;
+}
 
-    for (b = 0; b < num_attr; b++)
-    {
-        if (strcmp((temp_head + b)->att_name, attribute) == 0)
-        {
-            br = b;
+/**
+ * @author Karlo Vuković
+ * @brief Function that reads the bitmap of the rows with a value from a bitmap index
+ * @param indexName name of the index
+ * @param type type of the value
+ * @param value value
+ * @param size size of the value
+ * @param bitmap bitmap, empty if no row has the value, it is initialized by the function
+ * @return EXIT_SUCCESS, EXIT_ERROR if there is no such index
+ */
+int AK_bitmap_get(char *indexName, int type, char *value, int size, AK_bitmap *bitmap) {
+    AK_bitmap_index index;
+    AK_bitmap_value *description;
+    int number, result;
+    AK_PRO;
+    AK_bitmap_load(0, 0, bitmap);
+    pthread_mutex_lock(&AK_bitmap_mutex);
+    result = AK_bitmap_open(indexName, &index);
+    if (result == EXIT_SUCCESS) {
+        number = AK_bitmap_find_value(&index, type, value, size);
+        if (number >= 0) {
+            description = AK_bitmap_value_of(&index, number);
+            AK_bitmap_load(description->page, description->num_bits, bitmap);
         }
+        AK_bitmap_close(&index);
     }
-    AK_free(temp_head);
-    i = 0;
-
-    while (addresses->address_from[ i ] != 0)
-    {
-
-        for (j = addresses->address_from[ i ]; j < addresses->address_to[ i ]; j++)
-        {
-
-            AK_block *temp = (AK_block*) AK_read_block(j);
-            for (k = br; k < DATA_BLOCK_SIZE; k = k + num_attr)
-            {
-                if (temp->tuple_dict[ k ].size > 0)
-                {
-
-                    switch (temp->tuple_dict[ k ].type)
-                    {
-                        case TYPE_INT:
-                        memcpy(&temp_int, &(temp->data[ temp->tuple_dict[ k ].address]),
-                         temp->tuple_dict[k].size);
-                        break;
-                        case TYPE_FLOAT:
-                        memcpy(&temp_float, &(temp->data[ temp->tuple_dict[ k ].address]),
-                         temp->tuple_dict[k].size);
-                        printf("float: %-10.2f", temp_float);
-                        break;
-
-                        case TYPE_VARCHAR:
-                        memcpy(temp_char, &(temp->data[ temp->tuple_dict[ k ].address]),
-                         temp->tuple_dict[k].size);
-
-                        memcpy(&addBlock, &(temp->data[ temp->tuple_dict[ k - br ].address]),
-                         temp->tuple_dict[0].size);
-
-                        memcpy(&indexTd, &(temp->data[ temp->tuple_dict[ k - (br - 1) ].address]),
-                         temp->tuple_dict[1].size);
+    pthread_mutex_unlock(&AK_bitmap_mutex);
+    AK_EPI;
+    return result;
+}
 
-                        temp_char[ temp->tuple_dict[k].size ] = '\0';
+/**
+ * @author Karlo Vuković
+ * @brief Function that reads the bitmap of all rows of the table from a bitmap index
+ * @param indexName name of the index
+ * @param bitmap bitmap, it is initialized by the function
+ * @return EXIT_SUCCESS, EXIT_ERROR if there is no such index
+ */
+int AK_bitmap_get_rows(char *indexName, AK_bitmap *bitmap) {
+    AK_bitmap_index index;
+    int result;
+    AK_PRO;
+    AK_bitmap_load(0, 0, bitmap);
+    pthread_mutex_lock(&AK_bitmap_mutex);
+    result = AK_bitmap_open(indexName, &index);
+    if (result == EXIT_SUCCESS) {
+        AK_bitmap_load(index.info->rows_page, index.info->rows_bits, bitmap);
+        AK_bitmap_close(&index);
+    }
+    pthread_mutex_unlock(&AK_bitmap_mutex);
+    AK_EPI;
+    return result;
+}
 
-                        if (strcmp(temp_char, "1") == 0)
-                        {             
-                            AK_Insert_NewelementAd(addBlock, indexTd, attribute, add_root);
-                        }
-                        break;
-                    }
-                    if ((k + 1) % num_attr == 0)
-                        printf("\n");
-                }
-            }
+/**
+ * @author Karlo Vuković
+ * @brief Function that turns the set bits of a bitmap into addresses of rows of a table
+ * @param tblName name of the table
+ * @param bitmap bitmap of rows of the table
+ * @param adds array for the addresses in the order of the table, may be NULL
+ * @param max_adds size of the array
+ * @return number of set bits that are rows of the table, it can be larger than max_adds
+ */
+int AK_bitmap_to_rids(char *tblName, AK_bitmap *bitmap, struct_add *adds, int max_adds) {
+    table_addresses *addresses;
+    AK_bitmap_cursor cursor;
+    int num_attr, per_block, position, address, count = 0;
+    AK_PRO;
+    num_attr = AK_num_attr(tblName);
+    if (num_attr <= 0) {
+        AK_EPI;
+        return 0;
+    }
+    per_block = DATA_BLOCK_SIZE / num_attr;
+    addresses = AK_get_table_addresses(tblName);
+    cursor.bitmap = bitmap;
+    cursor.word = 0;
+    cursor.position = 0;
+    cursor.bit = 0;
+    while (AK_bitmap_cursor_step(&cursor, &position)) {
+        address = AK_bitmap_block(addresses, position / per_block);
+        if (address < 0)
+            break;
+        if (adds != NULL && count < max_adds) {
+            adds[count].addBlock = address;
+            adds[count].indexTd = position % per_block * num_attr;
         }
-        i++;
+        count++;
     }
+    AK_free(addresses);
+    AK_EPI;
+    return count;
+}
+/**
+ * @author Saša Vukšić
+ * @brief Function that tests printing header of table
+ * @param tblName name of table who's header we are printing
+   @return No return value
+ **/
+   void AK_print_Header_Test(char* tblName)
+   {
+    AK_header *temp_head;
+    int i;
+    int num_attr;
+    AK_PRO;
+    temp_head = AK_get_header(tblName);
+    num_attr = AK_num_attr(tblName);
+    printf("Number of attributes in header: %d", num_attr);
+    printf("\n");
+    for (i = 0; i < num_attr; i++)
+        printf("%-10s", (temp_head + i)->att_name);
+    printf("\n----------------------------------------------\n");
+    AK_free(temp_head);
     AK_EPI;
-    return add_root;
-    AK_free(add_root);
 }
-
 
 /**
  * @author Saša Vukšić, Lovro Predovan
@@ -472,145 +1494,6 @@
     AK_EPI;
 }
 
-/**
- * @author Saša Vukšić
- * @brief Function that fetches the values from the bitmap index if there is one for a given table.
- * It should be started when we are making selection on the table with bitmap index.
- * @param tableName name of table
- * @param attributeValue value of attribute
- * @return list of adresses
- **/
- list_ad* AK_get_Attribute(char *tableName, char *attributeName, char *attributeValue)
- {
-    list_ad *list;
-    char inde[50];
-    char *indexName;
-    AK_PRO;
-
-    list = (list_ad *) AK_malloc(sizeof (list_ad));
-    AK_InitializelistAd(list);
-    strcpy(inde, tableName);
-    indexName = strcat(inde, attributeName);
-    indexName = strcat(indexName, "_bmapIndex");
-
-    table_addresses *addresses = (table_addresses*) AK_get_index_addresses(indexName);
-    if (addresses->address_from[ 0 ] == 0)
-    {
-        printf("There is no index for table: %s on attribute: %s", tableName, attributeName);
-    }
-    else
-    {
-        list = AK_get_attribute(indexName, attributeValue);
-    }
-    AK_EPI;
-    return list;
-}
-
-/**
- * @author Saša Vukšić
- * @brief Function that updates the index, only on values that alredy exist. 
- * If there is no value in bitmap index or bitmap index on this value, warning is showed to the user. Otherwise, bitmap index is updated with new attribute value.
- * @param addBlock adress of block
- * @param addTD adress of tuple dict
- * @param tableName name of table
- * @param attributeName name of attribute
- * @param attributeValue value of atribute
- * @param newAttributeValue new value of updated attribute
- * @return No return value
- **/
- void AK_update(int addBlock, int addTd, char *tableName, char *attributeName, char *attributeValue, char *newAttributeValue)
- {
-    char inde[50];
-    char *indexName;
-    int b, num_attr, k, j;
-    int i = 0;
-    int temp_adr_block;
-    int temp_adr_Td;
-    int pos;
-    int posNew = -1;
-    AK_PRO;
-    strcpy(inde, tableName);
-    indexName = strcat(inde, attributeName);
-    indexName = strcat(indexName, "_bmapIndex");
-
-    AK_header *temp_head = AK_get_index_header(indexName);
-    num_attr = AK_num_index_attr(indexName);
-
-    for (i = 0; i < num_attr; i++)
-    {
-        if (strcmp((temp_head + i)->att_name, attributeValue) == 0)
-        {
-            pos = i;
-        }
-    }
-
-    i = 0;
-    for (i = 0; i < num_attr; i++)
-    {
-            if (strcmp((temp_head + i)->att_name, attributeValue) == 0)
-            {
-                posNew = i;
-            }
-        }
-
-        if (posNew == -1)
-        {
-            printf("Update is posible ONLY for existing values! \n");
-            AK_EPI;
-            exit(1);
-        }
-
-        table_addresses *addresses = (table_addresses*) AK_get_index_addresses(indexName);
-        if (addresses->address_from[ 0 ] == 0)
-        {
-            printf("There is no index for table : %s on attribute: %s", tableName, attributeName);
-        }
-        else
-        {
-            for (b = 0; b < num_attr; b++)
-            {
-                if (strcmp((temp_head + b)->att_name, attributeValue) == 0)
-                {
-                    i = 0;
-                    while (addresses->address_from[ i ] != 0)
-                    {
-                        for (j = addresses->address_from[ i ]; j < addresses->address_to[ i ]; j++)
-                        {
-                            AK_block *temp = (AK_block*) AK_read_block(j);
-
-                            for (k = 0; k < DATA_BLOCK_SIZE; k = k + num_attr)
-                            {
-                                if (temp->tuple_dict[ k ].size > 0)
-                                {
-                                    memcpy(&temp_adr_block, &(temp->data[ temp->tuple_dict[ k ].address]), temp->tuple_dict[k].size);
-                                    memcpy(&temp_adr_Td, &(temp->data[ temp->tuple_dict[ k + 1 ].address]), temp->tuple_dict[k + 1].size);
-                                    printf("%i vs.%i, %i vs %i\n",temp_adr_block,addBlock,temp_adr_Td,addTd);
-
-                                    if ((temp_adr_block == addBlock) && (temp_adr_Td == addTd))
-                                    {
-                                        printf( "Block address: %d, Td address: %d segment:%i \n", temp_adr_block, temp_adr_Td, temp->address );
-
-                                        memcpy(&(temp->data[ temp->tuple_dict[ k + pos ].address]), "n", 1);
-                                        memset(&(temp->data[ temp->tuple_dict[ k + posNew ].address]), 0, 4);
-                                        memcpy(&(temp->data[ temp->tuple_dict[ k + posNew ].address]), "1", 1);                                
-                                        
-					AK_PRO;
-
-                                        AK_write_block(temp);
-                                    }
-                                }
-                            }
-
-                        }
-                        i++;
-                    }
-                }
-            }
-        }
-        printf("Index %s updated for %s table\n",indexName,tableName);
-        AK_EPI;
-    }
-
 /**
  * @author Saša Vukšić
  * @brief Function that writes the new value in block when index is updated
@@ -654,163 +1537,269 @@
     }*/
 
 
-/**
- * @author Lovro Predovan
- * @brief Function that updates the index. Function deletes and recreates the index values again if different number of params is detected 
- * @param tableName name of table
- * @param attributeName name of attribute
- * @param newAttributeValue new value of updated attribute
- * @return No return value
- **/
- void AK_add_to_bitmap_index(char *tableName, char *attributeName)
- {
-    char inde[50];
-    char *tblNameIndex;
-    int tbl_num_rows, idx_num_rows;
-
-    AK_PRO;
-    strcpy(inde, tableName);
-    tblNameIndex = strcat(inde, attributeName);
-    tblNameIndex = strcat(tblNameIndex, "_bmapIndex");
-
-    idx_num_rows = AK_get_index_num_records(tblNameIndex);
-    tbl_num_rows = AK_get_num_records(tableName);
-
-    //This may not be the best method but it's damn effective one
-    if(tbl_num_rows > idx_num_rows){
-        AK_delete_bitmap_index(tblNameIndex);
-        struct list_node *att_root = (struct list_node *) AK_malloc(sizeof (struct list_node));
-        AK_Init_L3(&att_root);
-        AK_Insert_New_Element(TYPE_VARCHAR, attributeName, tableName, attributeName, att_root);
-        AK_create_Index_Table(tableName, att_root);
-    }
-    printf("Index %s updated for %s table\n",tblNameIndex,tableName);
-    AK_EPI;
-}
-
 
 /**
- * @author Saša Vukšić
- * @brief Function that tests printing header of table
- * @param tblName name of table who's header we are printing
-   @return No return value
- **/
-   void AK_print_Header_Test(char* tblName)
-   {
-    AK_header *temp_head;
-    int i;
-    int num_attr;
-    AK_PRO;
-    temp_head = AK_get_header(tblName);
-    num_attr = AK_num_attr(tblName);
-    printf("Number of attributes in header: %d", num_attr);
-    printf("\n");
-    for (i = 0; i < num_attr; i++)
-        printf("%-10s", (temp_head + i)->att_name);
-    printf("\n----------------------------------------------\n");
-    AK_free(temp_head);
-    AK_EPI;
+ * @author Karlo Vuković
+ * @brief Function that compares a varchar value of a row of the bitmap index test table with a text
+ * @param add address of the row
+ * @param attribute position of the attribute
+ * @param text text
+ * @return 1 if the row has the value, 0 otherwise
+ */
+static int AK_bitmap_test_value(struct_add *add, int attribute, char *text) {
+    AK_block *block = ((AK_mem_block *) AK_get_block(add->addBlock))->block;
+    AK_tuple_dict *dict = &block->tuple_dict[add->indexTd + attribute];
+
+    return dict->size == (int) strlen(text) && memcmp(block->data + dict->address, text, dict->size) == 0;
 }
 
 /**
- * @author Lovro Predovan
- * @brief Function that deletes bitmap index based on the name of index
- * @param Bitmap index table name
-   @return No return value
- **/
-   void AK_delete_bitmap_index(char *indexName) {
-    AK_PRO;
-    AK_delete_segment(indexName, SEGMENT_TYPE_INDEX);
-    printf("INDEX %s DELETED!\n", indexName);
-    AK_EPI;
+ * @author Karlo Vuković
+ * @brief Function that counts the rows with a value in a bitmap index of the test table
+ * @param indexName name of the index
+ * @param text value
+ * @return number of rows with the value
+ */
+static int AK_bitmap_test_count(char *indexName, char *text) {
+    AK_bitmap bitmap;
+    int count;
+
+    AK_bitmap_get(indexName, TYPE_VARCHAR, text, strlen(text), &bitmap);
+    count = AK_bitmap_count(&bitmap);
+    AK_bitmap_free(&bitmap);
+    return count;
 }
 
-
-
 /**
- * @author Saša Vukšić updated by Lovro Predovan
- * @brief Function that creates test table and makes index on test table,
-    also prints original tables indexes tables and indexes, tests updating into tables
- * @return No return value
+ * @author Saša Vukšić updated by Lovro Predovan, updated by Karlo Vuković (compressed bitmaps)
+ * @brief Function for testing bitmap indices
+ * @return TestResult
  * */
- TestResult AK_bitmap_test()
- {
-    int id_prof;
-    struct list_node *row_root = (struct list_node *) AK_malloc(sizeof (struct list_node));
-
-
+TestResult AK_bitmap_test() {
+    char *tblName = "bitmap_test";
+    char *statuses[4] = {"new", "open", "closed", "late"};
+    char *indexes[2] = {"bitmap_teststatus_bmapIndex", "bitmap_testregion_bmapIndex"};
+    int num_rows = 3000, num_regions = 5, added = 300;
+    int passed_tests = 0, failed_tests = 0;
+    int i, id, position, count, expected, wrong, num_words;
+    char region[MAX_VARCHAR_LENGTH];
+    AK_bitmap bitmap, other, result, rows;
+    AK_bitmap_cursor cursor;
+    AK_bitmap_info info;
+    struct list_node *att_root, *attribute, *row, **new_rows;
+    list_ad *list;
+    element_ad element;
+    struct_add *adds;
     AK_PRO;
+
     printf("\n********** BITMAP INDEX TEST **********\n\n");
 
-    //INDEXED TABLE
-    char *tblName = "assistant";
+    //a bitmap with a run, single bits and a gap is compressed and gives its bits back in order
+    AK_bitmap_init(&bitmap);
+    AK_bitmap_set(&bitmap, 3);
+    for (i = 40; i < 1000; i++)
+        AK_bitmap_set(&bitmap, i);
+    AK_bitmap_set(&bitmap, 100000);
+    AK_bitmap_cursor_open(&cursor, &bitmap);
+    wrong = 0;
+    expected = 3;
+    count = 0;
+    while (AK_bitmap_cursor_next(&cursor, &position)) {
+        if (position != expected)
+            wrong++;
+        expected = expected == 3 ? 40 : expected == 999 ? 100000 : expected + 1;
+        count++;
+    }
+    if (wrong == 0 && count == 962 && AK_bitmap_count(&bitmap) == 962 && bitmap.num_words <= 8 &&
+        AK_bitmap_is_set(&bitmap, 500) && !AK_bitmap_is_set(&bitmap, 39) && !AK_bitmap_is_set(&bitmap, 50000)) {
+        printf("Bitmap of %d bits is kept in %d words\n", count, bitmap.num_words);
+        passed_tests++;
+    } else {
+        printf("Bitmap of %d bits in %d words gives %d wrong bits back\n", count, bitmap.num_words, wrong);
+        failed_tests++;
+    }
+    AK_bitmap_free(&bitmap);
 
-    //CREATING BITMAP INDEXES ON ATTRIBUTES FIRSTNAME AND TEL
-    struct list_node *att_root = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    //indices on firstname and tel of the assistant table find the rows with a value
+    att_root = (struct list_node *) AK_malloc(sizeof (struct list_node));
     AK_Init_L3(&att_root);
-    //Error: argument of type "const char *" is incompatible with parameter of type "void *"
-    AK_Insert_New_Element(TYPE_VARCHAR, "firstname", tblName, "firstname", att_root);
-    
-
-    struct list_node *some_element;
-    some_element = (struct list_node *) AK_First_L2(att_root);
-    //Error: argument of type "const char *" is incompatible with parameter of type "void *"
-    AK_Insert_New_Element(TYPE_VARCHAR, "tel", tblName, "tel", some_element);
-    AK_create_Index_Table(tblName, att_root);
-
-
-    AK_print_table(tblName);
-    AK_print_table("AK_index");
-
-    printf("\n************Index tables******************\n\n");
-    AK_print_index_table("assistantfirstname_bmapIndex");
-    AK_print_index_table("assistanttel_bmapIndex");
-
-    printf("Bitmap index tables should be now visible\n");
-
-
-    //Test value that doesn't passes
-    printf("\n\n************Printing non existing index table******************\n\n");
-    AK_print_index_table("assistanrandom_bmapIndex");
-    printf("\n\n***************************************\n\n");
-
-
-    printf("\n\n************Updating table indexes******************\n\n");
-    AK_Init_L3(&row_root);
-    id_prof = 35890;
-    AK_DeleteAll_L3(&row_root);
-    AK_Insert_New_Element(TYPE_INT, &id_prof, tblName, "id_prof", row_root);
-    //Error: argument of type "const char *" is incompatible with parameter of type "void *"
-    AK_Insert_New_Element(TYPE_VARCHAR, "Miran", tblName, "firstname", row_root);
-        //Error: argument of type "const char *" is incompatible with parameter of type "void *"
-    AK_Insert_New_Element(TYPE_VARCHAR, "Zlatović", tblName, "lastname", row_root);
-        //Error: argument of type "const char *" is incompatible with parameter of type "void *"
-    AK_Insert_New_Element(TYPE_INT, "042390858", tblName, "tel", row_root);
-        //Error: argument of type "const char *" is incompatible with parameter of type "void *"
-    AK_Insert_New_Element(TYPE_VARCHAR, "miran.zlatovic@foi.hr", tblName, "email", row_root);
-        //Error: argument of type "const char *" is incompatible with parameter of type "void *"
-    AK_Insert_New_Element(TYPE_VARCHAR, "www.foi.hr/nastavnici/zlatovic.miran/index.html", tblName, "web_page", row_root);
-    AK_insert_row(row_root);
-    AK_DeleteAll_L3(&row_root);
-    AK_free(row_root);
-
-    AK_add_to_bitmap_index(tblName, "firstname");
-
-    AK_print_table(tblName);
-    AK_print_index_table("assistantfirstname_bmapIndex");
-    
-    printf("\n\n************Searching index locations******************\n\n");
-    AK_print_Att_Test(AK_get_Attribute(tblName,"firstname","Markus"));
-    AK_print_Att_Test(AK_get_Attribute(tblName,"tel","858928176"));
-    
-     printf("\n\n************Deleting bitmap index******************\n\n");
+    AK_Insert_New_Element(TYPE_VARCHAR, "firstname", "assistant", "firstname", att_root);
+    AK_Insert_New_Element(TYPE_VARCHAR, "tel", "assistant", "tel", AK_First_L2(att_root));
     AK_delete_bitmap_index("assistantfirstname_bmapIndex");
+    AK_delete_bitmap_index("assistanttel_bmapIndex");
+    AK_create_Index_Table("assistant", att_root);
+    AK_DeleteAll_L3(&att_root);
+    AK_free(att_root);
+    position = AK_get_attr_index("assistant", "firstname");
+    expected = 0;
+    for (i = 0; (row = (struct list_node *) AK_get_row(i, "assistant")) != NULL; i++) {
+        for (attribute = AK_First_L2(row), id = 0; attribute != NULL && id < position; attribute = attribute->next, id++)
+            ;
+        if (attribute != NULL && strcmp(attribute->data, "Markus") == 0)
+            expected++;
+        AK_DeleteAll_L3(&row);
+        AK_free(row);
+    }
+    list = AK_get_Attribute("assistant", "firstname", "Markus");
+    AK_print_Att_Test(list);
+    wrong = 0;
+    count = 0;
+    for (element = list->next; element != NULL; element = element->next) {
+        if (!AK_bitmap_test_value(&element->add, position, "Markus"))
+            wrong++;
+        count++;
+    }
+    AK_Delete_All_elementsAd(list);
+    AK_free(list);
+    if (count == expected && count > 0 && wrong == 0 &&
+        AK_bitmap_get_info("assistanttel_bmapIndex", &info) == EXIT_SUCCESS) {
+        printf("Index on assistant firstname finds %d rows with Markus\n", count);
+        passed_tests++;
+    } else {
+        printf("Index on assistant firstname finds %d rows with Markus instead of %d, %d of them wrong\n", count,
+               expected, wrong);
+        failed_tests++;
+    }
+    AK_delete_bitmap_index("assistanttel_bmapIndex");
+
+    AK_header t_header[4] = {
+        {TYPE_INT, "id", {0}, {{'\0'}}, {{'\0'}}},
+        {TYPE_VARCHAR, "status", {0}, {{'\0'}}, {{'\0'}}},
+        {TYPE_VARCHAR, "region", {0}, {{'\0'}}, {{'\0'}}},
+        {0, {'\0'}, {0}, {{'\0'}}, {{'\0'}}}};
+
+    for (i = 0; i < 2; i++)
+        AK_delete_bitmap_index(indexes[i]);
+    if (AK_num_attr(tblName) > 0)
+        AK_delete_segment(tblName, SEGMENT_TYPE_TABLE);
+    if (AK_initialize_new_segment(tblName, SEGMENT_TYPE_TABLE, t_header) == EXIT_ERROR) {
+        printf("Could not create table %s\n", tblName);
+        AK_EPI;
+        return TEST_result(passed_tests, failed_tests + 1);
+    }
+    new_rows = (struct list_node **) AK_calloc(num_rows + added, sizeof (struct list_node *));
+    for (i = 0; i < num_rows + added; i++) {
+        id = i;
+        snprintf(region, MAX_VARCHAR_LENGTH, "r%d", i / (num_rows / num_regions));
+        new_rows[i] = (struct list_node *) AK_malloc(sizeof (struct list_node));
+        AK_Init_L3(&new_rows[i]);
+        AK_Insert_New_Element(TYPE_INT, &id, tblName, "id", new_rows[i]);
+        AK_Insert_New_Element(TYPE_VARCHAR, statuses[i % 4], tblName, "status", new_rows[i]);
+        AK_Insert_New_Element(TYPE_VARCHAR, region, tblName, "region", new_rows[i]);
+    }
+    AK_bulk_insert(tblName, new_rows, num_rows);
+
+    //every value gets a bitmap with its rows, and regions, which come in runs, take fewer words than groups of bits
+    AK_create_bitmap_index(tblName, "status");
+    AK_create_bitmap_index(tblName, "region");
+    AK_bitmap_get(indexes[1], TYPE_VARCHAR, "r2", 2, &bitmap);
+    num_words = bitmap.num_words;
+    count = AK_bitmap_count(&bitmap);
+    AK_bitmap_free(&bitmap);
+    if (AK_bitmap_get_info(indexes[0], &info) == EXIT_SUCCESS && info.num_values == 4 && info.num_rows == num_rows &&
+        AK_bitmap_test_count(indexes[0], "open") == num_rows / 4 && count == num_rows / num_regions &&
+        num_words < count / BITMAP_GROUP_BITS && AK_bitmap_test_count(indexes[0], "none") == 0) {
+        printf("Indices on status and region count %d and %d rows, the region in %d words\n", num_rows / 4, count,
+               num_words);
+        passed_tests++;
+    } else {
+        printf("Indices on status and region count wrong, the region has %d rows in %d words\n", count, num_words);
+        failed_tests++;
+    }
 
-    AK_print_table("AK_index");
+    //bitmaps are combined without going through the table
+    AK_bitmap_get(indexes[0], TYPE_VARCHAR, "open", 4, &bitmap);
+    AK_bitmap_get(indexes[1], TYPE_VARCHAR, "r1", 2, &other);
+    AK_bitmap_get_rows(indexes[0], &rows);
+    wrong = 0;
+    AK_bitmap_and(&bitmap, &other, &result);
+    if (AK_bitmap_count(&result) != num_rows / num_regions / 4)
+        wrong++;
+    AK_bitmap_free(&result);
+    AK_bitmap_or(&bitmap, &other, &result);
+    if (AK_bitmap_count(&result) != num_rows / 4 + num_rows / num_regions - num_rows / num_regions / 4)
+        wrong++;
+    AK_bitmap_free(&result);
+    AK_bitmap_and_not(&other, &bitmap, &result);
+    if (AK_bitmap_count(&result) != num_rows / num_regions - num_rows / num_regions / 4)
+        wrong++;
+    AK_bitmap_free(&result);
+    AK_bitmap_not(&bitmap, &rows, &result);
+    if (AK_bitmap_count(&result) != num_rows - num_rows / 4 || AK_bitmap_count(&rows) != num_rows)
+        wrong++;
+    AK_bitmap_free(&result);
+    if (wrong == 0) {
+        printf("AND, OR, AND NOT and NOT of status and region bitmaps count the right rows\n");
+        passed_tests++;
+    } else {
+        printf("%d of 4 combinations of status and region bitmaps count wrong\n", wrong);
+        failed_tests++;
+    }
+
+    //set bits of a combination are the rows of the table with both values
+    AK_bitmap_and(&bitmap, &other, &result);
+    count = AK_bitmap_to_rids(tblName, &result, NULL, 0);
+    adds = (struct_add *) AK_malloc((count > 0 ? count : 1) * sizeof (struct_add));
+    AK_bitmap_to_rids(tblName, &result, adds, count);
+    wrong = 0;
+    for (i = 0; i < count; i++) {
+        if (!AK_bitmap_test_value(&adds[i], 1, "open") || !AK_bitmap_test_value(&adds[i], 2, "r1"))
+            wrong++;
+    }
+    if (count == num_rows / num_regions / 4 && wrong == 0) {
+        printf("Rows with status open in region r1 are found through %d addresses\n", count);
+        passed_tests++;
+    } else {
+        printf("%d of %d addresses of rows with status open in region r1 are wrong\n", wrong, count);
+        failed_tests++;
+    }
+    AK_bitmap_free(&result);
+    AK_bitmap_free(&bitmap);
+    AK_bitmap_free(&other);
+    AK_bitmap_free(&rows);
+
+    //a changed value moves its row to a new bitmap
+    AK_update(adds[0].addBlock, adds[0].indexTd, tblName, "region", "r1", "r9");
+    AK_free(adds);
+    if (AK_bitmap_test_count(indexes[1], "r9") == 1 && AK_bitmap_test_count(indexes[1], "r1") == num_rows / num_regions - 1 &&
+        AK_bitmap_get_info(indexes[1], &info) == EXIT_SUCCESS && info.num_values == num_regions + 1) {
+        printf("Updated row moves from region r1 to r9\n");
+        passed_tests++;
+    } else {
+        printf("Updated row does not move from region r1 to r9\n");
+        failed_tests++;
+    }
 
+    //indices follow rows that are added in bulk, without being rebuilt
+    AK_bulk_insert(tblName, new_rows + num_rows, added);
+    expected = 0;
+    for (i = 0; i < num_rows + added; i++)
+        expected += i % 4 == 1;
+    if (AK_bitmap_test_count(indexes[0], "open") == expected && AK_bitmap_test_count(indexes[1], "r9") == 1 &&
+        AK_bitmap_test_count(indexes[1], "r5") == added) {
+        printf("Indices count %d rows with status open after %d rows were added\n", expected, added);
+        passed_tests++;
+    } else {
+        printf("Indices do not count the %d rows that were added\n", added);
+        failed_tests++;
+    }
+    for (i = 0; i < num_rows + added; i++) {
+        AK_DeleteAll_L3(&new_rows[i]);
+        AK_free(new_rows[i]);
+    }
+    AK_free(new_rows);
+
+    //deleted indices are gone
+    if (AK_delete_bitmap_index(indexes[0]) == EXIT_SUCCESS && AK_delete_bitmap_index(indexes[1]) == EXIT_SUCCESS &&
+        AK_bitmap_get_info(indexes[0], &info) == EXIT_ERROR && AK_delete_bitmap_index(indexes[1]) == EXIT_ERROR) {
+        printf("Deleted indices are gone\n");
+        passed_tests++;
+    } else {
+        printf("Deleted indices are still there\n");
+        failed_tests++;
+    }
+    AK_delete_segment(tblName, SEGMENT_TYPE_TABLE);
 
-    printf("\n\n********** BITMAP INDEX TEST END**********\n\n");
-    printf("\n\n BITMAP INDEX TEST PASSED\n\n");
     AK_EPI;
-    return TEST_result(0,0);
+    return TEST_result(passed_tests, failed_tests);
 }
@@ -28,7 +28,133 @@
 #include "../../file/files.h"
 #include "../../auxi/mempro.h"
 #include "../../auxi/constants.h"
+#include "../../auxi/compare.h"
+#include <pthread.h>
 
+/**
+ * @def BITMAP_GROUP_BITS
+ * @brief Constant declaring how many bits of a bitmap one literal word holds
+ */
+#define BITMAP_GROUP_BITS 31
+/**
+ * @def BITMAP_FILL
+ * @brief Constant declaring the bit that marks a fill word of a bitmap
+ */
+#define BITMAP_FILL 0x80000000u
+/**
+ * @def BITMAP_FILL_ONES
+ * @brief Constant declaring the bit of a fill word that tells if its groups are all ones
+ */
+#define BITMAP_FILL_ONES 0x40000000u
+/**
+ * @def BITMAP_FILL_GROUPS
+ * @brief Constant declaring the bits of a fill word with its number of groups
+ */
+#define BITMAP_FILL_GROUPS 0x3fffffffu
+/**
+ * @def BITMAP_LITERAL
+ * @brief Constant declaring the bits of a literal word that hold bits of the bitmap
+ */
+#define BITMAP_LITERAL 0x7fffffffu
+
+/**
+ * @author Karlo Vuković
+ * @struct AK_bitmap
+ * @brief Structure that holds a bitmap compressed with word-aligned hybrid (WAH) encoding. Each word covers groups of
+ *        BITMAP_GROUP_BITS bits: a literal word holds one group in its lower bits, a fill word stands for a run of
+ *        groups that are all zeros or all ones. Bit i of a bitmap of an index stands for row slot i of the table,
+ *        slots are numbered by blocks of the table in the order of the extents.
+ */
+typedef struct {
+    /// words of the bitmap
+    unsigned int *words;
+    /// number of words
+    int num_words;
+    /// number of words there is space for
+    int max_words;
+    /// number of bits the words cover, bits after them are zeros
+    int num_bits;
+} AK_bitmap;
+
+/**
+ * @author Karlo Vuković
+ * @struct AK_bitmap_cursor
+ * @brief Structure that goes through the set bits of a bitmap in order
+ */
+typedef struct {
+    /// bitmap
+    AK_bitmap *bitmap;
+    /// current word
+    int word;
+    /// first bit of the current word
+    int position;
+    /// next bit of the current word to look at
+    int bit;
+} AK_bitmap_cursor;
+
+/**
+ * @author Karlo Vuković
+ * @struct AK_bitmap_info
+ * @brief Structure at the start of the first block of a bitmap index. Entries of the tuple dictionary of the block
+ *        are the distinct values of the attribute, each one points to AK_bitmap_value in the data area, followed by
+ *        the value. Bitmaps are kept in the other blocks of the index segment as chains of pages.
+ */
+typedef struct {
+    /// name of the index
+    char name[MAX_ATT_NAME];
+    /// name of the indexed table
+    char table[MAX_ATT_NAME];
+    /// name of the indexed attribute
+    char attribute[MAX_ATT_NAME];
+    /// position of the attribute in the table
+    int position;
+    /// type of the attribute
+    int type;
+    /// number of attributes of the table
+    int table_num_attr;
+    /// number of distinct values
+    int num_values;
+    /// number of rows of the table when the index was built
+    int num_rows;
+    /// first page of the bitmap of all rows, nulls included
+    int rows_page;
+    /// number of words of the bitmap of all rows
+    int rows_words;
+    /// number of bits of the bitmap of all rows
+    int rows_bits;
+    /// number of blocks of the segment in use, together with this one
+    int num_pages;
+    /// first page that is no longer used, free pages are chained through AK_bitmap_page.next, 0 if there are none
+    int free_list;
+} AK_bitmap_info;
+
+/**
+ * @author Karlo Vuković
+ * @struct AK_bitmap_value
+ * @brief Structure that describes the bitmap of one value of a bitmap index
+ */
+typedef struct {
+    /// first page of the bitmap, 0 if it has no words
+    int page;
+    /// number of words of the bitmap
+    int num_words;
+    /// number of bits of the bitmap
+    int num_bits;
+    /// number of rows with the value
+    int num_set;
+} AK_bitmap_value;
+
+/**
+ * @author Karlo Vuković
+ * @struct AK_bitmap_page
+ * @brief Structure at the start of the data area of a page of a bitmap, the words of the bitmap follow it
+ */
+typedef struct {
+    /// next page of the bitmap, 0 for the last one
+    int next;
+    /// number of words in the page
+    int num_words;
+} AK_bitmap_page;
 
 /**
   @author Saša Vukšić
@@ -40,17 +166,26 @@
 int AK_If_ExistOp(struct list_node *L, char *ele);
 
 /**
- * @author Saša Vukšić, Lovro Predovan
- * @brief Function that reads table on which we create index and call functions for creating index
-           Elements that will be in index are put in list indexLista and headerAttributes. According to those elements new indexes
-           are created.
-
+ * @author Saša Vukšić, Lovro Predovan, updated by Karlo Vuković (compressed bitmaps)
+ * @brief Function that creates a bitmap index named <table><attribute>_bmapIndex on each attribute of the list
  * @param tblName name of table
- * @param attributes list of attributes on which we will create indexes
+ * @param attributes list of attributes on which we will create indexes, by attribute_name of the elements
  * @return No return value
  * */
 void AK_create_Index_Table(char *tblName, struct list_node *attributes);
 
+/**
+ * @author Karlo Vuković
+ * @brief Function that creates a bitmap index on an attribute of a table. Every distinct value of the attribute gets
+ *        a compressed bitmap of the rows with it, and the index keeps one more bitmap of all rows of the table.
+ *        Bitmap indices are meant for attributes with few distinct values, they have to fit into the first block.
+ *        Tables with the PAX layout can not be indexed.
+ * @param tblName name of table
+ * @param attribute name of the attribute
+ * @return EXIT_SUCCESS if the index was created, EXIT_ERROR otherwise
+ */
+int AK_create_bitmap_index(char *tblName, char *attribute);
+
 /**
  * @author Saša Vukšić
  * @brief Function that tests printing header of table
@@ -59,30 +194,6 @@ void AK_create_Index_Table(char *tblName, struct list_node *attributes);
  **/
 void AK_print_Header_Test(char* tblName);
 
-/**
- * @author Saša Vukšić, Lovro Predovan
- * @brief Function that loads index table with the value of particulary atribute
- * @param tblName source table
- * @param tblNameIndex new name of index table
- * @param attributeName attribute on which we make index
- * @param positionTbl position of attribute in header of table
- * @param numAtributes number of attributes in table
- * @param headerIndex header of index table
- * @return No return value
- */
-void AK_create_Index(char *tblName, char *tblNameIndex, char *attributeName, int positionTbl, int numAtributes, AK_header *headerIndex);
-
-/**
- * @author Saša Vukšić, Lovro Predovan
- * @brief Function that gets adresses of the particuliar attribute from bitmap index. It fetches addresses of indexes and header
-          of index table.  Using while loop it goes through index and gets necessary data. That data is put in a list called
-          add_root.
- * @param indexName name of index
- * @param attribute name of attribute
- * @return list of adresses
- **/
-list_ad* AK_get_attribute(char *indexName, char *attribute);
-
 
 void AK_create_List_Address_Test();
 
@@ -95,19 +206,20 @@ void AK_create_List_Address_Test();
 void AK_print_Att_Test(list_ad *list);
 
 /**
- * @author Saša Vukšić
+ * @author Saša Vukšić, updated by Karlo Vuković (compressed bitmaps)
  * @brief Function that fetches the values from the bitmap index if there is one for a given table.
  * It should be started when we are making selection on the table with bitmap index.
  * @param tableName name of table
- * @param attributeValue value of attribute
- * @return list of adresses
+ * @param attributeName name of attribute
+ * @param attributeValue value of attribute as text, converted to the type of the attribute
+ * @return list of adresses of rows with the value, in the order of the table
  **/
 list_ad* AK_get_Attribute(char *tableName, char *attributeName, char *attributeValue);
 
 /**
- * @author Saša Vukšić
- * @brief Function that updates the index, only on values that alredy exist. 
- * If there is no value in bitmap index or bitmap index on this value, warning is showed to the user. Otherwise, bitmap index is updated with new attribute value.
+ * @author Saša Vukšić, updated by Karlo Vuković (compressed bitmaps)
+ * @brief Function that updates the index after the value of a row was changed. The row is removed from the bitmap
+ * of the old value and added to the bitmap of the new one, which is added to the index if it is not there yet.
  * @param addBlock adress of block
  * @param addTD adress of tuple dict
  * @param tableName name of table
@@ -127,29 +239,184 @@ void AK_update(int addBlock, int addTd, char *tableName, char *attributeName, ch
 int AK_write_block(AK_block * block);
 
 /**
- * @author Saša Vukšić updated by Lovro Predovan
- * @brief Function that creates test table and makes index on test table,
-    also prints original tables indexes tables and indexes, tests updating into tables
- * @return No return value
+ * @author Saša Vukšić updated by Lovro Predovan, updated by Karlo Vuković (compressed bitmaps)
+ * @brief Function for testing bitmap indices
+ * @return TestResult
  * */
 TestResult AK_bitmap_test();
 
 /**
- * @author Lovro Predovan
+ * @author Lovro Predovan, updated by Karlo Vuković (compressed bitmaps)
  * @brief Function that deletes bitmap index based on the name of index
- * @param Bitmap index table name
-   @return No return value
+ * @param indexName bitmap index name
+ * @return EXIT_SUCCESS if the index was deleted, EXIT_ERROR if there is no such index
  **/
-void AK_delete_bitmap_index(char *indexName);
+int AK_delete_bitmap_index(char *indexName);
 
 /**
- * @author Lovro Predovan
- * @brief Function that updates the index. Function deletes and recreates the index values again if different number of params is detected 
+ * @author Lovro Predovan, updated by Karlo Vuković (compressed bitmaps)
+ * @brief Function that updates the index. Function deletes and recreates the index if the number of rows of the
+ * table changed since it was built
  * @param tableName name of table
  * @param attributeName name of attribute
- * @param newAttributeValue new value of updated attribute
  * @return No return value
  **/
 void AK_add_to_bitmap_index(char *tableName, char *attributeName);
 
+/**
+ * @author Karlo Vuković
+ * @brief Function that applies changes of rows of the indexed table to a bitmap index. Changes are grouped by value
+ *        and sorted by row, so the bitmap of every value that changed is combined with the changed bits and written
+ *        once, however many of its rows changed. Bits of the rows follow their place in the table, so rows that were
+ *        added do not move the others and the index is not rebuilt.
+ * @param indexName name of the index
+ * @param deltas changes of rows of the table
+ * @param num_deltas number of changes
+ * @return EXIT_SUCCESS, EXIT_ERROR if there is no such index, a value does not fit into it or it could not be
+ *         extended
+ */
+int AK_bitmap_apply(char *indexName, AK_index_delta *deltas, int num_deltas);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that initializes an empty bitmap
+ * @param bitmap bitmap
+ * @return No return value
+ */
+void AK_bitmap_init(AK_bitmap *bitmap);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that frees the words of a bitmap, it is empty afterwards
+ * @param bitmap bitmap
+ * @return No return value
+ */
+void AK_bitmap_free(AK_bitmap *bitmap);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that sets a bit after the bits the bitmap already covers, or in its last literal word
+ * @param bitmap bitmap
+ * @param position bit
+ * @return EXIT_SUCCESS, EXIT_ERROR if the bit comes before the last word of the bitmap
+ */
+int AK_bitmap_set(AK_bitmap *bitmap, int position);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that tells if a bit of a bitmap is set
+ * @param bitmap bitmap
+ * @param position bit
+ * @return 1 if the bit is set, 0 otherwise
+ */
+int AK_bitmap_is_set(AK_bitmap *bitmap, int position);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that computes the intersection of two bitmaps without decompressing them, runs of both are
+ *        combined at once
+ * @param left first bitmap
+ * @param right second bitmap
+ * @param result bitmap with the bits set in both, it is initialized by the function
+ * @return No return value
+ */
+void AK_bitmap_and(AK_bitmap *left, AK_bitmap *right, AK_bitmap *result);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that computes the union of two bitmaps without decompressing them
+ * @param left first bitmap
+ * @param right second bitmap
+ * @param result bitmap with the bits set in either, it is initialized by the function
+ * @return No return value
+ */
+void AK_bitmap_or(AK_bitmap *left, AK_bitmap *right, AK_bitmap *result);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that computes the difference of two bitmaps without decompressing them
+ * @param left first bitmap
+ * @param right second bitmap
+ * @param result bitmap with the bits set in the first one and not in the second, it is initialized by the function
+ * @return No return value
+ */
+void AK_bitmap_and_not(AK_bitmap *left, AK_bitmap *right, AK_bitmap *result);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that computes the complement of a bitmap among the rows of a table
+ * @param bitmap bitmap
+ * @param rows bitmap of all rows of the table, from AK_bitmap_get_rows
+ * @param result bitmap with the rows that are not set in the bitmap, it is initialized by the function
+ * @return No return value
+ */
+void AK_bitmap_not(AK_bitmap *bitmap, AK_bitmap *rows, AK_bitmap *result);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that counts the set bits of a bitmap, a fill of ones counts all of its bits at once
+ * @param bitmap bitmap
+ * @return number of set bits
+ */
+int AK_bitmap_count(AK_bitmap *bitmap);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that starts going through the set bits of a bitmap
+ * @param cursor cursor
+ * @param bitmap bitmap, it has to stay the same while the cursor is used
+ * @return No return value
+ */
+void AK_bitmap_cursor_open(AK_bitmap_cursor *cursor, AK_bitmap *bitmap);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that returns the next set bit of a bitmap, fills of zeros are skipped at once
+ * @param cursor cursor
+ * @param position next set bit
+ * @return 1 if there was one more set bit, 0 otherwise
+ */
+int AK_bitmap_cursor_next(AK_bitmap_cursor *cursor, int *position);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that reads the description of a bitmap index
+ * @param indexName name of the index
+ * @param info description of the index
+ * @return EXIT_SUCCESS if the index exists, EXIT_ERROR otherwise
+ */
+int AK_bitmap_get_info(char *indexName, AK_bitmap_info *info);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that reads the bitmap of the rows with a value from a bitmap index
+ * @param indexName name of the index
+ * @param type type of the value
+ * @param value value
+ * @param size size of the value
+ * @param bitmap bitmap, empty if no row has the value, it is initialized by the function
+ * @return EXIT_SUCCESS, EXIT_ERROR if there is no such index
+ */
+int AK_bitmap_get(char *indexName, int type, char *value, int size, AK_bitmap *bitmap);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that reads the bitmap of all rows of the table from a bitmap index
+ * @param indexName name of the index
+ * @param bitmap bitmap, it is initialized by the function
+ * @return EXIT_SUCCESS, EXIT_ERROR if there is no such index
+ */
+int AK_bitmap_get_rows(char *indexName, AK_bitmap *bitmap);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that turns the set bits of a bitmap into addresses of rows of a table
+ * @param tblName name of the table
+ * @param bitmap bitmap of rows of the table
+ * @param adds array for the addresses in the order of the table, may be NULL
+ * @param max_adds size of the array
+ * @return number of set bits that are rows of the table, it can be larger than max_adds
+ */
+int AK_bitmap_to_rids(char *tblName, AK_bitmap *bitmap, struct_add *adds, int max_adds);
+
 #endif
@@ -0,0 +1,884 @@
+/**
+@file bloom.c Provides functions for per-extent Bloom filters
+ */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#include "bloom.h"
+#include "../bulk.h"
+#include "../../rel/selection.h"
+#include "../../rel/expression_check.h"
+#include <errno.h>
+#include <limits.h>
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that checks if values of the type can be kept in a Bloom filter
+ * @param type data type
+ * @return 1 for int and varchar, otherwise 0
+ */
+int AK_bloom_filter_supported(int type) {
+    return type == TYPE_INT || type == TYPE_VARCHAR;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that returns the name of the segment with Bloom filters of an attribute
+ * @param tblName table name
+ * @param attName attribute name
+ * @param name buffer of MAX_VARCHAR_LENGTH characters for the name
+ * @return No return value
+ */
+static void AK_bloom_filter_name(char *tblName, char *attName, char *name) {
+    snprintf(name, MAX_VARCHAR_LENGTH, "%s%s_bloom", tblName, attName);
+}
+
+/// number of segments with Bloom filters in AK_relation, -1 until they are counted again
+static int AK_bloom_filter_segments = -1;
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that checks if the database has any Bloom filters, so that tables without them do not look
+ *        their segments up on every insert. Segments are counted in AK_relation the first time and again after a
+ *        filter was created or dropped.
+ * @return 1 if there may be Bloom filters, otherwise 0
+ */
+static int AK_bloom_filter_any() {
+    struct list_node *row, *name;
+    int i = 0, length;
+
+    if (AK_bloom_filter_segments >= 0)
+        return AK_bloom_filter_segments > 0;
+    AK_bloom_filter_segments = 0;
+    while ((row = (struct list_node *) AK_get_row(i++, "AK_relation")) != NULL) {
+        name = AK_GetNth_L2(2, row);
+        length = name != NULL ? strlen(name->data) : 0;
+        if (length > 6 && strcmp(name->data + length - 6, "_bloom") == 0)
+            AK_bloom_filter_segments++;
+        AK_DeleteAll_L3(&row);
+        AK_free(row);
+    }
+    return AK_bloom_filter_segments > 0;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that finds the block with the filter of an extent of the table
+ * @param bloom addresses of the segment with the filters
+ * @param extent index of the extent in the table addresses
+ * @return block address, -1 if the segment has no block for the extent
+ */
+static int AK_bloom_filter_slot(table_addresses *bloom, int extent) {
+    int i, blocks;
+
+    for (i = 0; i < MAX_EXTENTS_IN_SEGMENT && bloom->address_from[i] != 0; i++) {
+        blocks = bloom->address_to[i] - bloom->address_from[i];
+        if (extent < blocks)
+            return bloom->address_from[i] + extent;
+        extent -= blocks;
+    }
+    return -1;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that checks if a value is stored the way values of the attribute are
+ * @param type type of the attribute
+ * @param value_type type of the value
+ * @param size size of the value
+ * @return 1 if the value can be added to the filter, 0 if it counts as a null
+ */
+static int AK_bloom_filter_key(int type, int value_type, int size) {
+    if (value_type != type || size <= 0)
+        return 0;
+    return type != TYPE_INT || size >= (int) sizeof (int);
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that computes two hashes of a value, bits of the filter are taken from their combinations.
+ *        Varchars are hashed up to the first null character, so values that compare equal as strings get the
+ *        same bits.
+ * @param type type of the value
+ * @param value value
+ * @param size size of the value
+ * @param first first hash
+ * @param second second hash, always odd
+ * @return No return value
+ */
+static void AK_bloom_filter_hash(int type, char *value, int size, unsigned int *first, unsigned int *second) {
+    unsigned int hash;
+
+    if (type == TYPE_VARCHAR)
+        size = strnlen(value, size);
+    hash = AK_hash_value(type, value, size);
+    *first = hash;
+    //finalizer of MurmurHash3 gives the second hash
+    hash ^= hash >> 16;
+    hash *= 0x85ebca6bu;
+    hash ^= hash >> 13;
+    hash *= 0xc2b2ae35u;
+    hash ^= hash >> 16;
+    *second = hash | 1;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that sets bits of a value in the filter
+ * @param bits bits of the filter
+ * @param type type of the value
+ * @param value value
+ * @param size size of the value
+ * @return No return value
+ */
+static void AK_bloom_filter_set(unsigned char *bits, int type, char *value, int size) {
+    unsigned int first, second, bit;
+    int i;
+
+    AK_bloom_filter_hash(type, value, size, &first, &second);
+    for (i = 0; i < BLOOM_FILTER_HASHES; i++) {
+        bit = (first + i * second) & (BLOOM_FILTER_BYTES * 8 - 1);
+        bits[bit >> 3] |= 1 << (bit & 7);
+    }
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that checks bits of a value in the filter
+ * @param bits bits of the filter
+ * @param type type of the value
+ * @param value value
+ * @param size size of the value
+ * @return 1 if all bits of the value are set, otherwise 0
+ */
+static int AK_bloom_filter_get(unsigned char *bits, int type, char *value, int size) {
+    unsigned int first, second, bit;
+    int i;
+
+    AK_bloom_filter_hash(type, value, size, &first, &second);
+    for (i = 0; i < BLOOM_FILTER_HASHES; i++) {
+        bit = (first + i * second) & (BLOOM_FILTER_BYTES * 8 - 1);
+        if (!(bits[bit >> 3] & (1 << (bit & 7))))
+            return 0;
+    }
+    return 1;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that builds the filter of one extent from the values of the attribute in its blocks. Blocks that
+ *        belong to another segment are recognized by their header and left out, and blocks with another layout
+ *        make the filter inexact.
+ * @param filter block that gets the filter
+ * @param header table header
+ * @param attribute index of the attribute in the header
+ * @param num_attr number of attributes
+ * @param address_from first block of the extent
+ * @param address_to last block of the extent
+ * @return No return value
+ */
+static void AK_bloom_filter_build_extent(AK_block *filter, AK_header *header, int attribute, int num_attr,
+                                         int address_from, int address_to) {
+    AK_bloom_filter_info info;
+    unsigned char *bits = (unsigned char *) filter->data + sizeof (AK_bloom_filter_info);
+    AK_block *block;
+    AK_tuple_dict *dict;
+    int i, j;
+
+    memset(&info, 0, sizeof (AK_bloom_filter_info));
+    info.address_from = address_from;
+    info.address_to = address_to;
+    info.type = header[attribute].type;
+    info.exact = 1;
+    memset(bits, 0, BLOOM_FILTER_BYTES);
+
+    for (i = address_from; i <= address_to; i++) {
+        block = ((AK_mem_block *) AK_get_block(i))->block;
+        if (block->tuple_dict[0].type == FREE_INT)
+            continue;
+        if (strcmp(block->header[attribute].att_name, header[attribute].att_name) != 0 ||
+            block->header[attribute].type != info.type)
+            continue;
+        if (block->type != BLOCK_TYPE_NORMAL) {
+            info.exact = 0;
+            continue;
+        }
+        for (j = 0; j + attribute < DATA_BLOCK_SIZE && block->tuple_dict[j].type != FREE_INT; j += num_attr) {
+            dict = &block->tuple_dict[j + attribute];
+            //deleted rows
+            if (dict->size <= 0)
+                continue;
+            if (!AK_bloom_filter_key(info.type, dict->type, dict->size)) {
+                info.num_nulls++;
+                continue;
+            }
+            AK_bloom_filter_set(bits, info.type, (char *) block->data + dict->address, dict->size);
+            info.num_keys++;
+        }
+    }
+
+    filter->type = BLOCK_TYPE_BLOOM;
+    memcpy(filter->data, &info, sizeof (AK_bloom_filter_info));
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that builds filters of all extents of the table
+ * @param tblName table name
+ * @param name name of the segment with the filters
+ * @param header table header
+ * @param attribute index of the attribute in the header
+ * @param num_attr number of attributes
+ * @return No return value
+ */
+static void AK_bloom_filter_build(char *tblName, char *name, AK_header *header, int attribute, int num_attr) {
+    table_addresses *addresses = AK_get_table_addresses(tblName);
+    table_addresses *bloom = AK_get_table_addresses(name);
+    AK_mem_block *mem_block;
+    int i, slot;
+
+    //extents without a block for their filter are always read
+    for (i = 0; i < MAX_EXTENTS_IN_SEGMENT && addresses->address_from[i] != 0; i++) {
+        slot = AK_bloom_filter_slot(bloom, i);
+        if (slot < 0)
+            break;
+        mem_block = (AK_mem_block *) AK_get_block(slot);
+        AK_bloom_filter_build_extent(mem_block->block, header, attribute, num_attr, addresses->address_from[i],
+                                     addresses->address_to[i]);
+        AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+    }
+    AK_free(addresses);
+    AK_free(bloom);
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that finds an attribute in the header
+ * @param header table header
+ * @param num_attr number of attributes
+ * @param attName attribute name
+ * @return index of the attribute, -1 if there is no such attribute
+ */
+static int AK_bloom_filter_attribute(AK_header *header, int num_attr, char *attName) {
+    int i;
+
+    for (i = 0; i < num_attr; i++) {
+        if (strcmp(header[i].att_name, attName) == 0)
+            return i;
+    }
+    return -1;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that checks if the attribute of the table has Bloom filters
+ * @param tblName table name
+ * @param attName attribute name
+ * @return 1 if there are Bloom filters, otherwise 0
+ */
+int AK_bloom_filter_exists(char *tblName, char *attName) {
+    char name[MAX_VARCHAR_LENGTH];
+    table_addresses *bloom;
+    int exists;
+
+    if (!AK_bloom_filter_any())
+        return 0;
+    AK_bloom_filter_name(tblName, attName, name);
+    bloom = AK_get_table_addresses(name);
+    exists = bloom->address_from[0] != 0;
+    AK_free(bloom);
+    return exists;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that builds Bloom filters of an attribute, one for each extent of the table. Filters are kept in
+ *        the segment <table><attribute>_bloom, registered in AK_relation, where the n-th block holds the filter of
+ *        the n-th extent of the table. A filter that already exists is built again.
+ * @param tblName table name
+ * @param attName attribute name, it has to be an int or a varchar
+ * @return EXIT_SUCCESS if the filters were built, EXIT_ERROR otherwise
+ */
+int AK_bloom_filter_create(char *tblName, char *attName) {
+    char name[MAX_VARCHAR_LENGTH];
+    AK_header *header;
+    AK_header b_header[MAX_ATTRIBUTES];
+    int num_attr, attribute, result;
+    AK_PRO;
+
+    num_attr = AK_num_attr(tblName);
+    header = (AK_header *) AK_get_header(tblName);
+    if (header == NULL || num_attr <= 0) {
+        printf("AK_bloom_filter_create: Table %s does not exist!\n", tblName);
+        AK_free(header);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    attribute = AK_bloom_filter_attribute(header, num_attr, attName);
+    if (attribute < 0 || !AK_bloom_filter_supported(header[attribute].type)) {
+        printf("AK_bloom_filter_create: Attribute %s of table %s does not exist or is not an int or a varchar!\n",
+               attName, tblName);
+        AK_free(header);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+
+    AK_bloom_filter_name(tblName, attName, name);
+    if (AK_bloom_filter_exists(tblName, attName))
+        AK_delete_segment(name, SEGMENT_TYPE_TABLE);
+
+    //the segment is registered in AK_relation, so it is created and deleted as a table
+    memset(b_header, 0, sizeof (b_header));
+    memcpy(&b_header[0], &header[attribute], sizeof (AK_header));
+    result = AK_initialize_new_segment(name, SEGMENT_TYPE_TABLE, b_header);
+    AK_bloom_filter_segments = -1;
+    if (result == EXIT_ERROR) {
+        AK_free(header);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    AK_bloom_filter_build(tblName, name, header, attribute, num_attr);
+
+    AK_free(header);
+    AK_EPI;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that deletes Bloom filters of an attribute
+ * @param tblName table name
+ * @param attName attribute name
+ * @return EXIT_SUCCESS if the filters were deleted, EXIT_ERROR if there were none
+ */
+int AK_bloom_filter_drop(char *tblName, char *attName) {
+    char name[MAX_VARCHAR_LENGTH];
+    int result;
+    AK_PRO;
+
+    if (!AK_bloom_filter_exists(tblName, attName)) {
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    AK_bloom_filter_name(tblName, attName, name);
+    result = AK_delete_segment(name, SEGMENT_TYPE_TABLE);
+    AK_bloom_filter_segments = -1;
+    AK_EPI;
+    return result;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that deletes Bloom filters of all attributes of the table, used when the table is dropped
+ * @param tblName table name
+ * @return No return value
+ */
+void AK_bloom_filter_drop_table(char *tblName) {
+    AK_header *header;
+    int num_attr, i;
+    AK_PRO;
+
+    num_attr = AK_num_attr(tblName);
+    header = (AK_header *) AK_get_header(tblName);
+    for (i = 0; header != NULL && i < num_attr; i++) {
+        if (AK_bloom_filter_supported(header[i].type))
+            AK_bloom_filter_drop(tblName, header[i].att_name);
+    }
+    AK_free(header);
+    AK_EPI;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that builds all Bloom filters of the table again, used after rows were loaded or moved without
+ *        AK_insert_row
+ * @param tblName table name
+ * @return No return value
+ */
+void AK_bloom_filter_rebuild(char *tblName) {
+    char name[MAX_VARCHAR_LENGTH];
+    AK_header *header;
+    int num_attr, i;
+    AK_PRO;
+
+    num_attr = AK_num_attr(tblName);
+    header = (AK_header *) AK_get_header(tblName);
+    for (i = 0; header != NULL && i < num_attr; i++) {
+        if (!AK_bloom_filter_supported(header[i].type) || !AK_bloom_filter_exists(tblName, header[i].att_name))
+            continue;
+        AK_bloom_filter_name(tblName, header[i].att_name, name);
+        AK_bloom_filter_build(tblName, name, header, i, num_attr);
+    }
+    AK_free(header);
+    AK_EPI;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that adds new values of a row to Bloom filters of its table. It is called by AK_insert_row with
+ *        the block the row was written to, and by updates, which do not tell where the rows are, with -1.
+ * @param row_root elements of the row, only the ones with NEW_VALUE are added
+ * @param address address of the block with the row, -1 to add the values to filters of all extents
+ * @return No return value
+ */
+void AK_bloom_filter_add_row(struct list_node *row_root, int address) {
+    char name[MAX_VARCHAR_LENGTH];
+    struct list_node *el = (struct list_node *) AK_First_L2(row_root);
+    table_addresses *addresses = NULL, *bloom;
+    AK_header *header = NULL;
+    AK_mem_block *mem_block;
+    AK_bloom_filter_info info;
+    int num_attr = 0, attribute, i, slot;
+    AK_PRO;
+
+    if (!AK_bloom_filter_any()) {
+        AK_EPI;
+        return;
+    }
+    for (; el != NULL; el = el->next) {
+        if (el->constraint != NEW_VALUE)
+            continue;
+        AK_bloom_filter_name(el->table, el->attribute_name, name);
+        bloom = AK_get_table_addresses(name);
+        if (bloom->address_from[0] == 0) {
+            AK_free(bloom);
+            continue;
+        }
+        if (addresses == NULL) {
+            addresses = AK_get_table_addresses(el->table);
+            num_attr = AK_num_attr(el->table);
+            header = (AK_header *) AK_get_header(el->table);
+        }
+        attribute = header != NULL ? AK_bloom_filter_attribute(header, num_attr, el->attribute_name) : -1;
+
+        for (i = 0; attribute >= 0 && i < MAX_EXTENTS_IN_SEGMENT && addresses->address_from[i] != 0; i++) {
+            if (address >= 0 && (address < addresses->address_from[i] || address > addresses->address_to[i]))
+                continue;
+            slot = AK_bloom_filter_slot(bloom, i);
+            if (slot < 0)
+                continue;
+            mem_block = (AK_mem_block *) AK_get_block(slot);
+            memcpy(&info, mem_block->block->data, sizeof (AK_bloom_filter_info));
+            if (mem_block->block->type != BLOCK_TYPE_BLOOM || info.address_from != addresses->address_from[i] ||
+                info.address_to != addresses->address_to[i]) {
+                //a new extent, its rows are already in the blocks
+                AK_bloom_filter_build_extent(mem_block->block, header, attribute, num_attr,
+                                             addresses->address_from[i], addresses->address_to[i]);
+            } else {
+                if (AK_bloom_filter_key(info.type, el->type, el->size)) {
+                    AK_bloom_filter_set((unsigned char *) mem_block->block->data + sizeof (AK_bloom_filter_info),
+                                        info.type, el->data, el->size);
+                    info.num_keys++;
+                } else
+                    info.num_nulls++;
+                memcpy(mem_block->block->data, &info, sizeof (AK_bloom_filter_info));
+            }
+            AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+        }
+        AK_free(bloom);
+    }
+
+    AK_free(addresses);
+    AK_free(header);
+    AK_EPI;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that checks the filter of one extent
+ * @param bloom addresses of the segment with the filters
+ * @param extent index of the extent in the table addresses
+ * @param address_from first block of the extent
+ * @param address_to last block of the extent
+ * @param type type of the value
+ * @param value value
+ * @param size size of the value
+ * @return 0 if the value is surely not in the extent, otherwise 1
+ */
+static int AK_bloom_filter_extent_may_contain(table_addresses *bloom, int extent, int address_from, int address_to,
+                                              int type, char *value, int size) {
+    AK_bloom_filter_info info;
+    AK_block *block;
+    int slot = AK_bloom_filter_slot(bloom, extent);
+
+    if (slot < 0)
+        return 1;
+    block = ((AK_mem_block *) AK_get_block(slot))->block;
+    if (block->type != BLOCK_TYPE_BLOOM)
+        return 1;
+    memcpy(&info, block->data, sizeof (AK_bloom_filter_info));
+    //values of another type may compare equal in ways a hash does not see
+    if (info.address_from != address_from || info.address_to != address_to || !info.exact || info.num_nulls > 0 ||
+        !AK_bloom_filter_key(info.type, type, size))
+        return 1;
+    return AK_bloom_filter_get((unsigned char *) block->data + sizeof (AK_bloom_filter_info), type, value, size);
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that checks if an extent of the table can hold a value of the attribute. Extents without a
+ *        filter, with blocks the filter can not describe or with values of another type always can.
+ * @param tblName table name
+ * @param attName attribute name
+ * @param extent index of the extent in the table addresses, -1 for any extent of the table
+ * @param type type of the value
+ * @param value value
+ * @param size size of the value
+ * @return 0 if the value is surely not in the extent, otherwise 1
+ */
+int AK_bloom_filter_may_contain(char *tblName, char *attName, int extent, int type, char *value, int size) {
+    char name[MAX_VARCHAR_LENGTH];
+    table_addresses *addresses, *bloom;
+    int i, result = 0;
+
+    if (!AK_bloom_filter_supported(type) || !AK_bloom_filter_any())
+        return 1;
+    AK_bloom_filter_name(tblName, attName, name);
+    bloom = AK_get_table_addresses(name);
+    if (bloom->address_from[0] == 0) {
+        AK_free(bloom);
+        return 1;
+    }
+
+    addresses = AK_get_table_addresses(tblName);
+    for (i = 0; i < MAX_EXTENTS_IN_SEGMENT && addresses->address_from[i] != 0 && !result; i++) {
+        if (extent >= 0 && i != extent)
+            continue;
+        result = AK_bloom_filter_extent_may_contain(bloom, i, addresses->address_from[i], addresses->address_to[i],
+                                                    type, value, size);
+    }
+    AK_free(addresses);
+    AK_free(bloom);
+    return result;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that checks if the table can hold a value that is given as text, the way unique constraints get
+ *        their values. Text of an int attribute is used only if it is a whole number.
+ * @param tblName table name
+ * @param attName attribute name
+ * @param text value as text
+ * @return 0 if the value is surely not in the table, otherwise 1
+ */
+int AK_bloom_filter_may_contain_text(char *tblName, char *attName, char *text) {
+    char name[MAX_VARCHAR_LENGTH];
+    AK_header *header;
+    char *end;
+    long number;
+    int type, value;
+
+    if (!AK_bloom_filter_exists(tblName, attName))
+        return 1;
+    AK_bloom_filter_name(tblName, attName, name);
+    header = (AK_header *) AK_get_header(name);
+    if (header == NULL)
+        return 1;
+    type = header[0].type;
+    AK_free(header);
+
+    if (type == TYPE_VARCHAR)
+        return AK_bloom_filter_may_contain(tblName, attName, -1, TYPE_VARCHAR, text, strlen(text));
+    errno = 0;
+    number = strtol(text, &end, 10);
+    if (end == text || *end != '\0' || errno != 0 || number < INT_MIN || number > INT_MAX)
+        return 1;
+    value = (int) number;
+    return AK_bloom_filter_may_contain(tblName, attName, -1, TYPE_INT, (char *) &value, sizeof (int));
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that gives constants of attributes implied by AND of two results for AK_bloom_filter_expr_keys
+ * @param result constants of the AND
+ * @param first constants of the first operand
+ * @param second constants of the second operand
+ * @return No return value
+ */
+static void AK_bloom_filter_expr_and(void *result, void *first, void *second) {
+    struct list_node **keys = (struct list_node **) result;
+    struct list_node **left = (struct list_node **) first, **right = (struct list_node **) second;
+    int i;
+
+    for (i = 0; i < MAX_ATTRIBUTES; i++)
+        keys[i] = left[i] != NULL ? left[i] : right[i];
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that gives the constant of an attribute implied by an operator for AK_bloom_filter_expr_keys.
+ *        Only an equality of an attribute with a constant of the same type gives one.
+ * @param op operator
+ * @param operands operands read so far
+ * @param num_operands number of operands
+ * @param header table header
+ * @param result constants of the operator
+ * @return No return value
+ */
+static void AK_bloom_filter_expr_equal(char *op, AK_expression_operand *operands, int num_operands, AK_header *header,
+                                       void *result) {
+    struct list_node **keys = (struct list_node **) result;
+    AK_expression_operand *attribute, *constant;
+
+    if (strcmp(op, "=") != 0 || num_operands < 2)
+        return;
+    attribute = &operands[num_operands - 2];
+    constant = &operands[num_operands - 1];
+    if (attribute->attribute < 0) {
+        attribute = &operands[num_operands - 1];
+        constant = &operands[num_operands - 2];
+    }
+    if (attribute->attribute >= 0 && constant->el->type != TYPE_ATTRIBS &&
+        AK_bloom_filter_supported(constant->el->type) && constant->el->type == header[attribute->attribute].type)
+        keys[attribute->attribute] = constant->el;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that finds constants that attributes have to be equal to in every row satisfying the postfix
+ *        expression. The expression is followed with AK_expression_walk, and only an equality of an attribute with a
+ *        constant of the same type and AND give constants.
+ * @param expr postfix expression, may be NULL
+ * @param header table header
+ * @param num_attr number of attributes
+ * @param keys constant of each attribute, NULL if there is none
+ * @return number of attributes with a constant
+ */
+int AK_bloom_filter_expr_keys(struct list_node *expr, AK_header *header, int num_attr, struct list_node **keys) {
+    struct list_node *facts[MAX_ATTRIBUTES];
+    AK_expression_walker walker = {sizeof (facts), NULL, AK_bloom_filter_expr_and, AK_bloom_filter_expr_equal};
+    int i, found = 0;
+    AK_PRO;
+
+    memset(facts, 0, sizeof (facts));
+    AK_expression_walk(expr, header, num_attr, &walker, facts);
+    for (i = 0; i < num_attr; i++) {
+        keys[i] = facts[i];
+        if (keys[i] != NULL)
+            found++;
+    }
+    AK_EPI;
+    return found;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that counts extents of the table whose filters can hold an id
+ * @param tblName table name
+ * @param id id
+ * @return number of extents
+ */
+static int AK_bloom_filter_test_extents(char *tblName, int id) {
+    table_addresses *addresses = AK_get_table_addresses(tblName);
+    int i, count = 0;
+
+    for (i = 0; i < MAX_EXTENTS_IN_SEGMENT && addresses->address_from[i] != 0; i++)
+        count += AK_bloom_filter_may_contain(tblName, "id", i, TYPE_INT, (char *) &id, sizeof (int));
+    AK_free(addresses);
+    return count;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function for testing Bloom filters
+ * @return TestResult
+ */
+TestResult AK_bloom_filter_test() {
+    char *tblName = "bloom_filter_test";
+    char *dstTable = "bloom_filter_test_selection";
+    int num_rows = 6000;
+    int ok = 0, fail = 0;
+    int i, id, num_extents, missing, positives, extents;
+    float score;
+    char name[MAX_VARCHAR_LENGTH];
+    struct list_node **rows;
+    struct list_node *row_root, *expr;
+    struct list_node *keys[MAX_ATTRIBUTES];
+    table_addresses *addresses;
+    AK_PRO;
+
+    printf("\n********** BLOOM FILTER TEST **********\n\n");
+
+    AK_header t_header[4] = {
+        {TYPE_INT, "id", {0}, {{'\0'}}, {{'\0'}}},
+        {TYPE_VARCHAR, "name", {0}, {{'\0'}}, {{'\0'}}},
+        {TYPE_FLOAT, "score", {0}, {{'\0'}}, {{'\0'}}},
+        {0, {'\0'}, {0}, {{'\0'}}, {{'\0'}}}};
+
+    if (AK_num_attr(tblName) > 0) {
+        AK_bloom_filter_drop_table(tblName);
+        AK_delete_segment(tblName, SEGMENT_TYPE_TABLE);
+    }
+    if (AK_num_attr(dstTable) > 0)
+        AK_delete_segment(dstTable, SEGMENT_TYPE_TABLE);
+    if (AK_initialize_new_segment(tblName, SEGMENT_TYPE_TABLE, t_header) == EXIT_ERROR) {
+        printf("Could not create table %s\n", tblName);
+        AK_EPI;
+        return TEST_result(0, 1);
+    }
+
+    rows = (struct list_node **) AK_calloc(num_rows, sizeof (struct list_node *));
+    for (i = 0; i < num_rows; i++) {
+        score = (i % 10) * 0.5f;
+        id = i;
+        sprintf(name, "name %d", i);
+        rows[i] = (struct list_node *) AK_malloc(sizeof (struct list_node));
+        AK_Init_L3(&rows[i]);
+        AK_Insert_New_Element(TYPE_INT, &id, tblName, "id", rows[i]);
+        AK_Insert_New_Element(TYPE_VARCHAR, name, tblName, "name", rows[i]);
+        AK_Insert_New_Element(TYPE_FLOAT, &score, tblName, "score", rows[i]);
+    }
+    AK_bulk_insert(tblName, rows, num_rows);
+    for (i = 0; i < num_rows; i++) {
+        AK_DeleteAll_L3(&rows[i]);
+        AK_free(rows[i]);
+    }
+    AK_free(rows);
+
+    addresses = AK_get_table_addresses(tblName);
+    for (num_extents = 0; num_extents < MAX_EXTENTS_IN_SEGMENT && addresses->address_from[num_extents] != 0;)
+        num_extents++;
+    AK_free(addresses);
+
+    //filters are built for int and varchar attributes only
+    if (AK_bloom_filter_create(tblName, "id") == EXIT_SUCCESS &&
+        AK_bloom_filter_create(tblName, "name") == EXIT_SUCCESS &&
+        AK_bloom_filter_create(tblName, "score") == EXIT_ERROR && AK_bloom_filter_exists(tblName, "id") &&
+        !AK_bloom_filter_exists(tblName, "score"))
+        ok++;
+    else {
+        printf("Bloom filters were not created as expected\n");
+        fail++;
+    }
+
+    //a filter never loses a value of its extent
+    missing = 0;
+    for (i = 0; i < num_rows; i++) {
+        id = i;
+        sprintf(name, "name %d", i);
+        if (!AK_bloom_filter_may_contain(tblName, "id", -1, TYPE_INT, (char *) &id, sizeof (int)) ||
+            !AK_bloom_filter_may_contain(tblName, "name", -1, TYPE_VARCHAR, name, strlen(name)))
+            missing++;
+    }
+    if (missing == 0)
+        ok++;
+    else {
+        printf("%d values are missing from Bloom filters\n", missing);
+        fail++;
+    }
+
+    //values that are not in the table rule out almost all extents
+    positives = 0;
+    for (i = 0; i < 1000; i++) {
+        id = num_rows + 1000 + i * 7;
+        positives += AK_bloom_filter_test_extents(tblName, id);
+    }
+    extents = AK_bloom_filter_test_extents(tblName, 4000);
+    printf("Table has %d extents, 1000 missing ids pass %d extent filters, id 4000 passes %d\n", num_extents,
+           positives, extents);
+    if (num_extents > 1 && positives < 1000 * num_extents / 20 && extents >= 1 && extents < num_extents)
+        ok++;
+    else {
+        printf("Bloom filters do not rule out extents\n");
+        fail++;
+    }
+
+    //text values of unique checks are converted to the type of the attribute
+    if (AK_bloom_filter_may_contain_text(tblName, "id", "4000") && AK_bloom_filter_may_contain_text(tblName, "id", "x") &&
+        AK_bloom_filter_may_contain_text(tblName, "name", "name 4000") &&
+        AK_bloom_filter_may_contain_text(tblName, "score", "1.5"))
+        ok++;
+    else {
+        printf("Text values are not checked correctly\n");
+        fail++;
+    }
+
+    //AK_insert_row adds new values to the filter of the extent that got the row
+    id = 1000000;
+    row_root = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    AK_Init_L3(&row_root);
+    AK_Insert_New_Element(TYPE_INT, &id, tblName, "id", row_root);
+    AK_Insert_New_Element(TYPE_VARCHAR, "inserted", tblName, "name", row_root);
+    score = 1.5f;
+    AK_Insert_New_Element(TYPE_FLOAT, &score, tblName, "score", row_root);
+    AK_insert_row(row_root);
+    AK_DeleteAll_L3(&row_root);
+    if (AK_bloom_filter_may_contain(tblName, "id", -1, TYPE_INT, (char *) &id, sizeof (int)) &&
+        AK_bloom_filter_may_contain_text(tblName, "name", "inserted"))
+        ok++;
+    else {
+        printf("Inserted row is missing from Bloom filters\n");
+        fail++;
+    }
+
+    //equality keys of the expression, OR gives none
+    expr = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    AK_Init_L3(&expr);
+    id = 4000;
+    //constants come first, so equality compares only their size
+    AK_InsertAtEnd_L3(TYPE_INT, (char *) &id, sizeof (int), expr);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "id", sizeof ("id"), expr);
+    AK_InsertAtEnd_L3(TYPE_OPERATOR, "=", sizeof ("="), expr);
+    AK_InsertAtEnd_L3(TYPE_VARCHAR, "name 4000", sizeof ("name 4000"), expr);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "name", sizeof ("name"), expr);
+    AK_InsertAtEnd_L3(TYPE_OPERATOR, "=", sizeof ("="), expr);
+    AK_InsertAtEnd_L3(TYPE_OPERATOR, "AND", sizeof ("AND"), expr);
+    if (AK_bloom_filter_expr_keys(expr, t_header, 3, keys) == 2 && keys[0] != NULL && keys[1] != NULL &&
+        keys[2] == NULL && *(int *) keys[0]->data == 4000 && strcmp(keys[1]->data, "name 4000") == 0)
+        ok++;
+    else {
+        printf("Equality keys of the AND expression are wrong\n");
+        fail++;
+    }
+
+    //selection reads only extents whose filters can hold the id and finds the row
+    if (AK_selection(tblName, dstTable, expr) == EXIT_SUCCESS && AK_get_num_records(dstTable) == 1)
+        ok++;
+    else {
+        printf("Selection with Bloom filters returned %d rows instead of 1\n", AK_get_num_records(dstTable));
+        fail++;
+    }
+
+    AK_DeleteAll_L3(&expr);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "id", sizeof ("id"), expr);
+    AK_InsertAtEnd_L3(TYPE_INT, (char *) &id, sizeof (int), expr);
+    AK_InsertAtEnd_L3(TYPE_OPERATOR, "=", sizeof ("="), expr);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "name", sizeof ("name"), expr);
+    AK_InsertAtEnd_L3(TYPE_VARCHAR, "name 1", sizeof ("name 1"), expr);
+    AK_InsertAtEnd_L3(TYPE_OPERATOR, "=", sizeof ("="), expr);
+    AK_InsertAtEnd_L3(TYPE_OPERATOR, "OR", sizeof ("OR"), expr);
+    if (AK_bloom_filter_expr_keys(expr, t_header, 3, keys) == 0)
+        ok++;
+    else {
+        printf("OR expression gave equality keys\n");
+        fail++;
+    }
+    AK_DeleteAll_L3(&expr);
+    AK_free(expr);
+
+    //deleted filters are not used any more
+    if (AK_bloom_filter_drop(tblName, "name") == EXIT_SUCCESS && !AK_bloom_filter_exists(tblName, "name") &&
+        AK_bloom_filter_may_contain_text(tblName, "name", "no such name"))
+        ok++;
+    else {
+        printf("Bloom filter was not dropped\n");
+        fail++;
+    }
+
+    AK_free(row_root);
+    AK_EPI;
+    return TEST_result(ok, fail);
+}
@@ -0,0 +1,160 @@
+/**
+@file bloom.h Header file that provides data structures and functions for per-extent Bloom filters
+ */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#ifndef BLOOM
+#define BLOOM
+
+#include "../../auxi/test.h"
+#include "../../auxi/constants.h"
+#include "../../auxi/configuration.h"
+#include "../../auxi/compare.h"
+#include "../../file/table.h"
+#include "../files.h"
+#include "../../auxi/mempro.h"
+
+/**
+ * @author Karlo Vuković
+ * @struct AK_bloom_filter_info
+ * @brief Structure at the start of a Bloom filter block, it tells which extent of the table the filter describes
+ */
+typedef struct {
+    /// first block of the extent of the table
+    int address_from;
+    /// last block of the extent of the table
+    int address_to;
+    /// type of the attribute
+    int type;
+    /// 1 if every value of the extent is in the filter, 0 if the extent has blocks the filter can not describe
+    int exact;
+    /// number of values that were added to the filter
+    int num_keys;
+    /// number of values that are stored with another type than the attribute
+    int num_nulls;
+} AK_bloom_filter_info;
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that checks if values of the type can be kept in a Bloom filter
+ * @param type data type
+ * @return 1 for int and varchar, otherwise 0
+ */
+int AK_bloom_filter_supported(int type);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that checks if the attribute of the table has Bloom filters
+ * @param tblName table name
+ * @param attName attribute name
+ * @return 1 if there are Bloom filters, otherwise 0
+ */
+int AK_bloom_filter_exists(char *tblName, char *attName);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that builds Bloom filters of an attribute, one for each extent of the table. Filters are kept in
+ *        the segment <table><attribute>_bloom, registered in AK_relation, where the n-th block holds the filter of
+ *        the n-th extent of the table. A filter that already exists is built again.
+ * @param tblName table name
+ * @param attName attribute name, it has to be an int or a varchar
+ * @return EXIT_SUCCESS if the filters were built, EXIT_ERROR otherwise
+ */
+int AK_bloom_filter_create(char *tblName, char *attName);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that deletes Bloom filters of an attribute
+ * @param tblName table name
+ * @param attName attribute name
+ * @return EXIT_SUCCESS if the filters were deleted, EXIT_ERROR if there were none
+ */
+int AK_bloom_filter_drop(char *tblName, char *attName);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that deletes Bloom filters of all attributes of the table, used when the table is dropped
+ * @param tblName table name
+ * @return No return value
+ */
+void AK_bloom_filter_drop_table(char *tblName);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that builds all Bloom filters of the table again, used after rows were loaded or moved without
+ *        AK_insert_row
+ * @param tblName table name
+ * @return No return value
+ */
+void AK_bloom_filter_rebuild(char *tblName);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that adds new values of a row to Bloom filters of its table. It is called by AK_insert_row with
+ *        the block the row was written to, and by updates, which do not tell where the rows are, with -1.
+ * @param row_root elements of the row, only the ones with NEW_VALUE are added
+ * @param address address of the block with the row, -1 to add the values to filters of all extents
+ * @return No return value
+ */
+void AK_bloom_filter_add_row(struct list_node *row_root, int address);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that checks if an extent of the table can hold a value of the attribute. Extents without a
+ *        filter, with blocks the filter can not describe or with values of another type always can.
+ * @param tblName table name
+ * @param attName attribute name
+ * @param extent index of the extent in the table addresses, -1 for any extent of the table
+ * @param type type of the value
+ * @param value value
+ * @param size size of the value
+ * @return 0 if the value is surely not in the extent, otherwise 1
+ */
+int AK_bloom_filter_may_contain(char *tblName, char *attName, int extent, int type, char *value, int size);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that checks if the table can hold a value that is given as text, the way unique constraints get
+ *        their values. Text of an int attribute is used only if it is a whole number.
+ * @param tblName table name
+ * @param attName attribute name
+ * @param text value as text
+ * @return 0 if the value is surely not in the table, otherwise 1
+ */
+int AK_bloom_filter_may_contain_text(char *tblName, char *attName, char *text);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that finds constants that attributes have to be equal to in every row satisfying the postfix
+ *        expression. The expression is followed with AK_expression_walk, and only an equality of an attribute with a
+ *        constant of the same type and AND give constants.
+ * @param expr postfix expression, may be NULL
+ * @param header table header
+ * @param num_attr number of attributes
+ * @param keys constant of each attribute, NULL if there is none
+ * @return number of attributes with a constant
+ */
+int AK_bloom_filter_expr_keys(struct list_node *expr, AK_header *header, int num_attr, struct list_node **keys);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function for testing Bloom filters
+ * @return TestResult
+ */
+TestResult AK_bloom_filter_test();
+
+#endif
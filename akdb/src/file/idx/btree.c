@@ -6,873 +6,3076 @@
  * it under the terms of the GNU General Public License as published by
  * the Free Software Foundation; either version 2 of the License, or
  * (at your option) any later version.
- * 
+ *
  * This program is distributed in the hope that it will be useful,
  * but WITHOUT ANY WARRANTY; without even the implied warranty of
  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
  * GNU Library General Public License for more details.
- * 
+ *
  * You should have received a copy of the GNU General Public License
  * along with this program; if not, write to the Free Software
  * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
  */
 
 #include "btree.h"
+#include "../zonemap.h"
+#include "../bulk.h"
+#include "../filesort.h"
+#include "../vacuum.h"
+#include <limits.h>
+
+/// searches of B+tree indices share the lock, inserts, removes and changes of the segments hold it alone
+static pthread_rwlock_t AK_btree_lock = PTHREAD_RWLOCK_INITIALIZER;
+/// pages are copied from and to the cache, which only one thread can use at a time
+static pthread_mutex_t AK_btree_cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * @author Karlo Vuković
+ * @struct AK_btree_known
+ * @brief Structure that remembers where the first block of a B+tree index is
+ */
+typedef struct {
+    /// name of the index, empty if the structure is not used
+    char name[MAX_ATT_NAME];
+    /// address of the first block of the index
+    int address;
+} AK_btree_known;
+
+/// indices that were opened lately, they are found without searching the system catalog
+static AK_btree_known AK_btree_known_indexes[BTREE_KNOWN_INDEXES];
+/// next structure of AK_btree_known_indexes to be used
+static int AK_btree_known_next = 0;
+
+/**
+ * @author Karlo Vuković
+ * @struct AK_btree_index
+ * @brief Structure that holds an open B+tree index while it is searched or changed
+ */
+typedef struct {
+    /// name of the index
+    char *name;
+    /// address of the first block of the index
+    int address;
+    /// extents of the index segment, NULL until a page is added
+    table_addresses *addresses;
+    /// description of the index from its first block
+    AK_btree_meta meta;
+    /// 1 if the description has to be written back
+    int dirty;
+} AK_btree_index;
+
+/**
+ * @author Karlo Vuković
+ * @struct AK_btree_built
+ * @brief Structure that remembers a page written by a bulk build and its first entry, which separates the page from
+ *        the one before it in the parent
+ */
+typedef struct {
+    /// address of the page
+    int address;
+    /// size of the first entry
+    int size;
+    /// row and key of the first entry of the page, the smallest one in its subtree
+    char first[sizeof (AK_btree_rid) + MAX_VARCHAR_LENGTH];
+} AK_btree_built;
+
+/**
+ * @author Karlo Vuković
+ * @struct AK_btree_pending
+ * @brief Structure that holds a leaf entry of a bulk build sorted in memory
+ */
+typedef struct {
+    /// entry as a leaf keeps it, set when all entries are read
+    char *raw;
+    /// offset of the entry in the buffer of all entries
+    int offset;
+    /// size of the row and the key at the start of the entry
+    int key_size;
+    /// size of the entry with the values of the included attributes
+    int size;
+    /// type of the key
+    int type;
+} AK_btree_pending;
+
+/**
+ * @author Karlo Vuković
+ * @struct AK_btree_change
+ * @brief Structure that describes an entry to be added to or removed from a B+tree index
+ */
+typedef struct {
+    /// key
+    char *key;
+    /// size of the key
+    int size;
+    /// type of the key
+    int type;
+    /// row
+    AK_btree_rid rid;
+    /// 1 if the entry is added, 0 if it is removed
+    int insert;
+    /// changed row, for the values of included attributes
+    AK_index_delta *delta;
+} AK_btree_change;
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that returns the size of the part of an entry before its key
+ * @param level level of the page with the entry
+ * @return size in bytes
+ */
+static int AK_btree_fixed(int level) {
+    return level == 0 ? (int) sizeof (AK_btree_rid) : (int) (sizeof (AK_btree_rid) + sizeof (int));
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that returns the description of a page at the start of its data area
+ * @param block page
+ * @return description of the page
+ */
+static AK_btree_page *AK_btree_page_of(AK_block *block) {
+    return (AK_btree_page *) block->data;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that returns an entry of a page as it is stored
+ * @param block page
+ * @param i index of the entry
+ * @return entry
+ */
+static char *AK_btree_raw(AK_block *block, int i) {
+    return (char *) block->data + block->tuple_dict[i].address;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that returns the key of an entry
+ * @param block page
+ * @param i index of the entry
+ * @return key
+ */
+static char *AK_btree_key(AK_block *block, int i) {
+    return AK_btree_raw(block, i) + AK_btree_fixed(AK_btree_page_of(block)->level);
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that returns the size of the key of an entry as it is stored, without the values of included
+ *        attributes a leaf of a covering index keeps after the key
+ * @param raw entry
+ * @param size size of the entry
+ * @param level level of the page with the entry
+ * @param covering 1 if the page is a leaf with included values
+ * @return size of the key
+ */
+static int AK_btree_raw_key_size(char *raw, int size, int level, int covering) {
+    int included = 0;
+
+    //included values end with their size, together with the size itself
+    if (level == 0 && covering)
+        memcpy(&included, raw + size - sizeof (int), sizeof (int));
+    return size - AK_btree_fixed(level) - included;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that returns the size of the key of an entry
+ * @param block page
+ * @param i index of the entry
+ * @return size of the key
+ */
+static int AK_btree_key_size(AK_block *block, int i) {
+    AK_btree_page *page = AK_btree_page_of(block);
+
+    return AK_btree_raw_key_size(AK_btree_raw(block, i), block->tuple_dict[i].size, page->level, page->covering);
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that returns the child of an entry of an internal page
+ * @param block page
+ * @param i index of the entry, -1 for the child with entries smaller than the first entry
+ * @return address of the child
+ */
+static int AK_btree_child(AK_block *block, int i) {
+    int child;
+
+    if (i < 0)
+        return AK_btree_page_of(block)->child;
+    memcpy(&child, AK_btree_raw(block, i) + sizeof (AK_btree_rid), sizeof (int));
+    return child;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that writes an entry the way it is stored in a page
+ * @param raw buffer for the entry
+ * @param level level of the page for the entry
+ * @param key key
+ * @param size size of the key
+ * @param rid row of the entry
+ * @param child child of the entry, used only in internal pages
+ * @return size of the entry
+ */
+static int AK_btree_entry(char *raw, int level, char *key, int size, AK_btree_rid *rid, int child) {
+    memcpy(raw, rid, sizeof (AK_btree_rid));
+    if (level > 0)
+        memcpy(raw + sizeof (AK_btree_rid), &child, sizeof (int));
+    memcpy(raw + AK_btree_fixed(level), key, size);
+    return AK_btree_fixed(level) + size;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that writes the values of included attributes of a row the way a leaf keeps them after the key.
+ *        Each value is written with its type and size as they are in the row, followed by the size of all of them.
+ * @param raw buffer for the values
+ * @param meta description of the index
+ * @param entries entries of the row
+ * @param data data the addresses of the entries point into
+ * @param first index of the entry with the first included value, the others follow it, -1 if entries are numbered
+ *        like the attributes of the table
+ * @return size of the values, 0 if the index has no included attributes
+ */
+static int AK_btree_included(char *raw, AK_btree_meta *meta, AK_tuple_dict *entries, char *data, int first) {
+    AK_tuple_dict *dict;
+    int i, size, offset = 0;
+
+    if (meta->num_included == 0)
+        return 0;
+    for (i = 0; i < meta->num_included; i++) {
+        dict = &entries[first < 0 ? meta->included[i] : first + i];
+        size = dict->size > 0 && dict->size <= MAX_VARCHAR_LENGTH ? dict->size : 0;
+        memcpy(raw + offset, &dict->type, sizeof (int));
+        memcpy(raw + offset + sizeof (int), &size, sizeof (int));
+        memcpy(raw + offset + 2 * sizeof (int), data + dict->address, size);
+        offset += 2 * sizeof (int) + size;
+    }
+    offset += sizeof (int);
+    memcpy(raw + offset - sizeof (int), &offset, sizeof (int));
+    return offset;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that checks if a value is stored the way keys of the index are
+ * @param key_type type of the key
+ * @param type type of the value
+ * @param size size of the value
+ * @return 1 if the value can be indexed, 0 if it counts as a null
+ */
+static int AK_btree_indexed(int key_type, int type, int size) {
+    return type == key_type && size > 0 && size <= MAX_VARCHAR_LENGTH;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that compares two keys of an index. Keys of a composite index are compared value by value, and
+ *        when one of them has no more values they are equal, so a key made of the first values of another key
+ *        matches all keys that start with them.
+ * @param type type of the keys, BTREE_TYPE_COMPOSITE for keys on several attributes
+ * @param left first key
+ * @param left_size size of the first key
+ * @param right second key
+ * @param right_size size of the second key
+ * @return negative number if the first key comes before the second, 0 if they are equal, otherwise positive number
+ */
+static int AK_btree_compare_keys(int type, char *left, int left_size, char *right, int right_size) {
+    int left_type, right_type, left_value, right_value, result;
+
+    if (type != BTREE_TYPE_COMPOSITE)
+        return AK_compare_values(type, left, left_size, right, right_size);
+    while (left_size >= (int) (2 * sizeof (int)) && right_size >= (int) (2 * sizeof (int))) {
+        memcpy(&left_type, left, sizeof (int));
+        memcpy(&left_value, left + sizeof (int), sizeof (int));
+        memcpy(&right_type, right, sizeof (int));
+        memcpy(&right_value, right + sizeof (int), sizeof (int));
+        if (left_type != right_type)
+            return left_type < right_type ? -1 : 1;
+        result = AK_compare_values(left_type, left + 2 * sizeof (int), left_value, right + 2 * sizeof (int),
+                                   right_value);
+        if (result != 0)
+            return result;
+        left += 2 * sizeof (int) + left_value;
+        left_size -= 2 * sizeof (int) + left_value;
+        right += 2 * sizeof (int) + right_value;
+        right_size -= 2 * sizeof (int) + right_value;
+    }
+    return 0;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that appends one value to a key of a composite index, as its type, its size and its bytes
+ * @param key key
+ * @param size size of the key so far
+ * @param type type of the value
+ * @param value value
+ * @param value_size size of the value
+ * @return new size of the key, -1 if the value does not fit
+ */
+static int AK_btree_key_append(char *key, int size, int type, char *value, int value_size) {
+    if (size < 0 || size + 2 * sizeof (int) + value_size > MAX_VARCHAR_LENGTH)
+        return -1;
+    memcpy(key + size, &type, sizeof (int));
+    memcpy(key + size + sizeof (int), &value_size, sizeof (int));
+    memcpy(key + size + 2 * sizeof (int), value, value_size);
+    return size + 2 * sizeof (int) + value_size;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that makes the key of a row. The key of an index on one attribute is the value of the attribute,
+ *        the key of a composite index has all of its values one after another.
+ * @param meta description of the index
+ * @param entries entries of the row
+ * @param data data the addresses of the entries point into
+ * @param first index of the entry with the first value of the key, the others follow it, -1 if entries are numbered
+ *        like the attributes of the table
+ * @param key buffer of MAX_VARCHAR_LENGTH bytes for the key
+ * @return size of the key, -1 if the row is not indexed because a value is a null or the key is too long
+ */
+static int AK_btree_row_key(AK_btree_meta *meta, AK_tuple_dict *entries, char *data, int first, char *key) {
+    AK_tuple_dict *dict;
+    int i, size = 0;
+
+    for (i = 0; i < meta->num_keys && size >= 0; i++) {
+        dict = &entries[first < 0 ? meta->keys[i] : first + i];
+        if (!AK_btree_indexed(meta->key_types[i], dict->type, dict->size))
+            return -1;
+        if (meta->num_keys == 1) {
+            memcpy(key, data + dict->address, dict->size);
+            return dict->size;
+        }
+        size = AK_btree_key_append(key, size, dict->type, data + dict->address, dict->size);
+    }
+    return size;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that makes a key of a B+tree index on several attributes, with type BTREE_TYPE_COMPOSITE. Values
+ *        of fewer attributes than the key has make a prefix, which is equal to every key that starts with it, so a
+ *        search or a cursor with it finds all such entries.
+ * @param values values of the first attributes of the key, in order, varchar values may end with '\0'
+ * @param key buffer for the key, MAX_VARCHAR_LENGTH bytes
+ * @return size of the key, EXIT_ERROR if the values do not fit into a key
+ */
+int AK_btree_make_key(struct list_node *values, char *key) {
+    struct list_node *value;
+    int size = 0;
+    AK_PRO;
+
+    value = AK_First_L2(values);
+    if (value == NULL) {
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    for (; value != NULL && size >= 0; value = AK_Next_L2(value))
+        size = AK_btree_key_append(key, size, value->type, value->data,
+                                   value->type == TYPE_VARCHAR ? strnlen(value->data, value->size) : value->size);
+    AK_EPI;
+    return size < 0 ? EXIT_ERROR : size;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that compares a key and a row with an entry of a page
+ * @param block page
+ * @param i index of the entry
+ * @param type type of the key
+ * @param key key
+ * @param size size of the key
+ * @param rid row, NULL to come before all entries with an equal key
+ * @return negative number if the key comes before the entry, 0 if they are equal, otherwise positive number
+ */
+static int AK_btree_compare(AK_block *block, int i, int type, char *key, int size, AK_btree_rid *rid) {
+    AK_btree_rid entry;
+    int result = AK_btree_compare_keys(type, key, size, AK_btree_key(block, i), AK_btree_key_size(block, i));
+
+    if (result != 0)
+        return result;
+    if (rid == NULL)
+        return -1;
+    memcpy(&entry, AK_btree_raw(block, i), sizeof (AK_btree_rid));
+    if (rid->block != entry.block)
+        return rid->block < entry.block ? -1 : 1;
+    if (rid->tuple != entry.tuple)
+        return rid->tuple < entry.tuple ? -1 : 1;
+    return 0;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that finds the first entry of a page that does not come before a key and a row
+ * @param block page
+ * @param type type of the key
+ * @param key key
+ * @param size size of the key
+ * @param rid row, NULL for the first entry with the key
+ * @param equal 0 to find the first entry that is not smaller, 1 for the first entry that is larger
+ * @return index of the entry, number of entries if there is none
+ */
+static int AK_btree_bound(AK_block *block, int type, char *key, int size, AK_btree_rid *rid, int equal) {
+    int low = 0, high = AK_btree_page_of(block)->num_entries, middle, result;
+
+    while (low < high) {
+        middle = (low + high) / 2;
+        result = AK_btree_compare(block, middle, type, key, size, rid);
+        if (result > 0 || (equal && result == 0))
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    return low;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that returns how many bytes of the data area of a page the entries need
+ * @param block page
+ * @return number of bytes, together with the description of the page
+ */
+static int AK_btree_used(AK_block *block) {
+    int i, used = sizeof (AK_btree_page);
+
+    for (i = 0; i < AK_btree_page_of(block)->num_entries; i++)
+        used += block->tuple_dict[i].size;
+    return used;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that checks if an entry fits into a page
+ * @param block page
+ * @param size size of the entry
+ * @return 1 if it fits, otherwise 0
+ */
+static int AK_btree_fits(AK_block *block, int size) {
+    return AK_btree_page_of(block)->num_entries < DATA_BLOCK_SIZE &&
+           AK_btree_used(block) + size <= DATA_BLOCK_SIZE * DATA_ENTRY_SIZE;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that initializes an empty page
+ * @param block block for the page
+ * @param level level of the page
+ * @return No return value
+ */
+static void AK_btree_init_page(AK_block *block, int level) {
+    AK_btree_page page;
+    int i;
+
+    for (i = 0; i < DATA_BLOCK_SIZE; i++) {
+        block->tuple_dict[i].type = FREE_INT;
+        block->tuple_dict[i].address = FREE_INT;
+        block->tuple_dict[i].size = FREE_INT;
+    }
+    memset(&page, 0, sizeof (AK_btree_page));
+    page.level = level;
+    memcpy(block->data, &page, sizeof (AK_btree_page));
+    block->type = BLOCK_TYPE_BTREE;
+    block->chained_with = NOT_CHAINED;
+    block->AK_free_space = sizeof (AK_btree_page);
+    block->last_tuple_dict_id = 0;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that moves the entries of a page to the start of its data area, so space of removed entries can
+ *        be used again
+ * @param block page
+ * @return No return value
+ */
+static void AK_btree_compact(AK_block *block) {
+    char data[DATA_BLOCK_SIZE * DATA_ENTRY_SIZE];
+    int i, offset = sizeof (AK_btree_page);
+
+    memcpy(data, block->data, sizeof (AK_btree_page));
+    for (i = 0; i < AK_btree_page_of(block)->num_entries; i++) {
+        memcpy(data + offset, AK_btree_raw(block, i), block->tuple_dict[i].size);
+        block->tuple_dict[i].address = offset;
+        offset += block->tuple_dict[i].size;
+    }
+    memcpy(block->data, data, offset);
+    block->AK_free_space = offset;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that puts an entry into a page, the entry has to fit
+ * @param block page
+ * @param pos index of the entry in the page
+ * @param type type of the key
+ * @param raw entry as it is stored
+ * @param size size of the entry
+ * @return No return value
+ */
+static void AK_btree_put(AK_block *block, int pos, int type, char *raw, int size) {
+    AK_btree_page *page = AK_btree_page_of(block);
+
+    if (block->AK_free_space + size > DATA_BLOCK_SIZE * DATA_ENTRY_SIZE)
+        AK_btree_compact(block);
+    memmove(&block->tuple_dict[pos + 1], &block->tuple_dict[pos], (page->num_entries - pos) * sizeof (AK_tuple_dict));
+    memcpy(block->data + block->AK_free_space, raw, size);
+    block->tuple_dict[pos].type = type;
+    block->tuple_dict[pos].address = block->AK_free_space;
+    block->tuple_dict[pos].size = size;
+    block->AK_free_space += size;
+    page->num_entries++;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that removes an entry from a page, its space is used again after the page is compacted
+ * @param block page
+ * @param pos index of the entry
+ * @return No return value
+ */
+static void AK_btree_cut(AK_block *block, int pos) {
+    AK_btree_page *page = AK_btree_page_of(block);
+
+    memmove(&block->tuple_dict[pos], &block->tuple_dict[pos + 1], (page->num_entries - pos - 1) * sizeof (AK_tuple_dict));
+    page->num_entries--;
+    block->tuple_dict[page->num_entries].type = FREE_INT;
+    block->tuple_dict[page->num_entries].address = FREE_INT;
+    block->tuple_dict[page->num_entries].size = FREE_INT;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that copies a page from the cache, so that it stays the same while it is used
+ * @param address address of the page
+ * @return copy of the page
+ */
+static AK_block *AK_btree_read(int address) {
+    AK_block *block = (AK_block *) AK_malloc(sizeof (AK_block));
+
+    pthread_mutex_lock(&AK_btree_cache_mutex);
+    memcpy(block, ((AK_mem_block *) AK_get_block(address))->block, sizeof (AK_block));
+    pthread_mutex_unlock(&AK_btree_cache_mutex);
+    return block;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that copies a changed page to the cache, which writes it to the disk later
+ * @param block page
+ * @return No return value
+ */
+static void AK_btree_write(AK_block *block) {
+    AK_mem_block *mem_block;
+
+    pthread_mutex_lock(&AK_btree_cache_mutex);
+    mem_block = (AK_mem_block *) AK_get_block(block->address);
+    memcpy(mem_block->block, block, sizeof (AK_block));
+    AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+    pthread_mutex_unlock(&AK_btree_cache_mutex);
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that returns the extents of a segment, the system catalog is read through the cache
+ * @param name name of the segment
+ * @return extents of the segment
+ */
+static table_addresses *AK_btree_addresses(char *name) {
+    table_addresses *addresses;
+
+    pthread_mutex_lock(&AK_btree_cache_mutex);
+    addresses = AK_get_table_addresses(name);
+    pthread_mutex_unlock(&AK_btree_cache_mutex);
+    return addresses;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that forgets where the first block of a B+tree index is
+ * @param indexName name of the index
+ * @return No return value
+ */
+static void AK_btree_forget(char *indexName) {
+    int i;
+
+    pthread_mutex_lock(&AK_btree_cache_mutex);
+    for (i = 0; i < BTREE_KNOWN_INDEXES; i++) {
+        if (strcmp(AK_btree_known_indexes[i].name, indexName) == 0) {
+            AK_btree_known_indexes[i].name[0] = '\0';
+            AK_btree_known_indexes[i].address = 0;
+        }
+    }
+    pthread_mutex_unlock(&AK_btree_cache_mutex);
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that finds the first block of a B+tree index, among the indices that were opened lately or in the
+ *        system catalog
+ * @param indexName name of the index
+ * @param meta description of the index from the block
+ * @return address of the block, 0 if there is no such index
+ */
+static int AK_btree_find(char *indexName, AK_btree_meta *meta) {
+    AK_block *block;
+    table_addresses *addresses;
+    int i, address, known, valid;
+
+    for (;;) {
+        address = 0;
+        pthread_mutex_lock(&AK_btree_cache_mutex);
+        for (i = 0; i < BTREE_KNOWN_INDEXES && address == 0; i++) {
+            if (strcmp(AK_btree_known_indexes[i].name, indexName) == 0)
+                address = AK_btree_known_indexes[i].address;
+        }
+        known = address != 0;
+        if (!known) {
+            addresses = AK_get_table_addresses(indexName);
+            address = addresses->address_from[0];
+            AK_free(addresses);
+        }
+        pthread_mutex_unlock(&AK_btree_cache_mutex);
+        if (address == 0)
+            return 0;
+
+        block = AK_btree_read(address);
+        memcpy(meta, block->data, sizeof (AK_btree_meta));
+        valid = block->type == BLOCK_TYPE_BTREE && strcmp(meta->name, indexName) == 0;
+        AK_free(block);
+        if (valid && meta->num_keys == 0) {
+            //indexes built before keys on several attributes have the key on one attribute
+            meta->num_keys = 1;
+            meta->keys[0] = meta->position;
+            meta->key_types[0] = meta->type;
+        }
+        if (valid)
+            break;
+        //the block was given to another segment after the index was deleted
+        if (!known)
+            return 0;
+        AK_btree_forget(indexName);
+    }
+
+    if (!known) {
+        pthread_mutex_lock(&AK_btree_cache_mutex);
+        strncpy(AK_btree_known_indexes[AK_btree_known_next].name, indexName, MAX_ATT_NAME - 1);
+        AK_btree_known_indexes[AK_btree_known_next].address = address;
+        AK_btree_known_next = (AK_btree_known_next + 1) % BTREE_KNOWN_INDEXES;
+        pthread_mutex_unlock(&AK_btree_cache_mutex);
+    }
+    return address;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that finds the block of the segment with a page number
+ * @param addresses extents of the index segment
+ * @param number page number, 0 for the block with the description of the index
+ * @return block address, -1 if the segment has no such block
+ */
+static int AK_btree_block(table_addresses *addresses, int number) {
+    int i, blocks;
+
+    for (i = 0; i < MAX_EXTENTS_IN_SEGMENT && addresses->address_from[i] != 0; i++) {
+        blocks = addresses->address_to[i] - addresses->address_from[i];
+        if (number < blocks)
+            return addresses->address_from[i] + number;
+        number -= blocks;
+    }
+    return -1;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that opens a B+tree index
+ * @param indexName name of the index
+ * @param index open index
+ * @return EXIT_SUCCESS if there is such index, EXIT_ERROR otherwise
+ */
+static int AK_btree_open(char *indexName, AK_btree_index *index) {
+    index->name = indexName;
+    index->dirty = 0;
+    index->addresses = NULL;
+    index->address = AK_btree_find(indexName, &index->meta);
+    return index->address != 0 ? EXIT_SUCCESS : EXIT_ERROR;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that closes a B+tree index and writes its description if it was changed
+ * @param index open index
+ * @return No return value
+ */
+static void AK_btree_close(AK_btree_index *index) {
+    AK_block *block;
+
+    if (index->dirty) {
+        block = AK_btree_read(index->address);
+        block->type = BLOCK_TYPE_BTREE;
+        memcpy(block->data, &index->meta, sizeof (AK_btree_meta));
+        AK_btree_write(block);
+        AK_free(block);
+    }
+    if (index->addresses != NULL)
+        AK_free(index->addresses);
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that takes a page for the index, from the pages freed by merges or from the next block of the
+ *        segment. The segment gets a new extent when all of its blocks are used. Leaves of an index with included
+ *        attributes are marked as covering.
+ * @param index open index
+ * @param level level of the new page
+ * @return empty page, NULL if there is no space
+ */
+static AK_block *AK_btree_new_page(AK_btree_index *index, int level) {
+    AK_block *block;
+    int address;
+
+    if (index->meta.free_list != 0) {
+        block = AK_btree_read(index->meta.free_list);
+        index->meta.free_list = AK_btree_page_of(block)->next;
+    } else {
+        if (index->addresses == NULL)
+            index->addresses = AK_btree_addresses(index->name);
+        address = AK_btree_block(index->addresses, index->meta.num_pages);
+        if (address < 0) {
+            pthread_mutex_lock(&AK_btree_cache_mutex);
+            address = AK_init_new_extent(index->name, SEGMENT_TYPE_TABLE);
+            pthread_mutex_unlock(&AK_btree_cache_mutex);
+            if (address == EXIT_ERROR) {
+                printf("AK_btree_new_page: Could not extend index %s!\n", index->name);
+                return NULL;
+            }
+            AK_free(index->addresses);
+            index->addresses = AK_btree_addresses(index->name);
+            address = AK_btree_block(index->addresses, index->meta.num_pages);
+            if (address < 0)
+                return NULL;
+        }
+        index->meta.num_pages++;
+        block = AK_btree_read(address);
+    }
+    index->dirty = 1;
+    AK_btree_init_page(block, level);
+    AK_btree_page_of(block)->covering = level == 0 && index->meta.num_included > 0;
+    return block;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that writes a page that is no longer used to the list of free pages of the index
+ * @param index open index
+ * @param block page
+ * @return No return value
+ */
+static void AK_btree_free_page(AK_btree_index *index, AK_block *block) {
+    AK_btree_init_page(block, 0);
+    AK_btree_page_of(block)->next = index->meta.free_list;
+    index->meta.free_list = block->address;
+    index->dirty = 1;
+    AK_btree_write(block);
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that finds the leaf where a key and a row belong
+ * @param index open index
+ * @param key key
+ * @param size size of the key
+ * @param rid row, NULL for the leaf with the first entry with the key
+ * @param path addresses of pages from the root to the leaf
+ * @param slots entry of each page in its parent, -1 for the child with entries smaller than the first entry
+ * @param depth index of the leaf in the path
+ * @return leaf
+ */
+static AK_block *AK_btree_descend(AK_btree_index *index, char *key, int size, AK_btree_rid *rid, int *path, int *slots,
+                                  int *depth) {
+    AK_block *block = AK_btree_read(index->meta.root);
+    int slot;
+
+    *depth = 0;
+    path[0] = index->meta.root;
+    slots[0] = -1;
+    while (AK_btree_page_of(block)->level > 0 && *depth + 1 < BTREE_MAX_HEIGHT) {
+        slot = AK_btree_bound(block, index->meta.type, key, size, rid, 1) - 1;
+        (*depth)++;
+        path[*depth] = AK_btree_child(block, slot);
+        slots[*depth] = slot;
+        AK_free(block);
+        block = AK_btree_read(path[*depth]);
+    }
+    return block;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that splits a full page. The entries and the new entry are divided in half by size, the first half
+ *        stays in the page and the second goes to the sibling. A leaf sends a copy of the key and row of the first
+ *        entry of the sibling to the parent, an internal page sends the middle entry itself.
+ * @param index open index
+ * @param block full page
+ * @param sibling empty page on the same level
+ * @param pos index of the new entry
+ * @param raw new entry, it gets the entry for the parent
+ * @param raw_size size of the new entry, it gets the size of the entry for the parent
+ * @return No return value
+ */
+static void AK_btree_split(AK_btree_index *index, AK_block *block, AK_block *sibling, int pos, char *raw,
+                           int *raw_size) {
+    char separator[sizeof (AK_btree_rid) + sizeof (int) + MAX_VARCHAR_LENGTH];
+    AK_block *old = (AK_block *) AK_malloc(sizeof (AK_block));
+    AK_block *next;
+    AK_btree_page page;
+    AK_btree_rid rid;
+    char *item;
+    int total, size, middle, i, child, sum = 0, item_size, separator_size = 0;
+
+    memcpy(old, block, sizeof (AK_block));
+    memcpy(&page, old->data, sizeof (AK_btree_page));
+    total = page.num_entries + 1;
+    size = AK_btree_used(old) - sizeof (AK_btree_page) + *raw_size;
+
+    for (middle = 0; middle < total - 1; middle++) {
+        sum += middle < pos ? old->tuple_dict[middle].size : (middle == pos ? *raw_size : old->tuple_dict[middle - 1].size);
+        if (sum * 2 >= size)
+            break;
+    }
+    middle++;
+    if (page.level > 0 && middle > total - 2)
+        middle = total - 2;
+    if (middle < 1)
+        middle = 1;
+
+    AK_btree_init_page(block, page.level);
+    AK_btree_page_of(block)->covering = page.covering;
+    AK_btree_page_of(block)->prev = page.prev;
+    AK_btree_page_of(block)->child = page.child;
+    for (i = 0; i < total; i++) {
+        item = i < pos ? AK_btree_raw(old, i) : (i == pos ? raw : AK_btree_raw(old, i - 1));
+        item_size = i < pos ? old->tuple_dict[i].size : (i == pos ? *raw_size : old->tuple_dict[i - 1].size);
+        if (i < middle)
+            AK_btree_put(block, i, index->meta.type, item, item_size);
+        else if (i > middle || page.level == 0)
+            AK_btree_put(sibling, AK_btree_page_of(sibling)->num_entries, index->meta.type, item, item_size);
+        //the first entry of the sibling separates the pages in the parent
+        if (i == middle) {
+            memcpy(&rid, item, sizeof (AK_btree_rid));
+            memcpy(&child, item + sizeof (AK_btree_rid), sizeof (int));
+            if (page.level > 0)
+                AK_btree_page_of(sibling)->child = child;
+            separator_size = AK_btree_entry(separator, 1, item + AK_btree_fixed(page.level),
+                                            AK_btree_raw_key_size(item, item_size, page.level, page.covering), &rid,
+                                            sibling->address);
+        }
+    }
+    memcpy(raw, separator, separator_size);
+    *raw_size = separator_size;
+
+    if (page.level == 0) {
+        AK_btree_page_of(sibling)->prev = block->address;
+        AK_btree_page_of(sibling)->next = page.next;
+        AK_btree_page_of(block)->next = sibling->address;
+        if (page.next != 0) {
+            next = AK_btree_read(page.next);
+            AK_btree_page_of(next)->prev = sibling->address;
+            AK_btree_write(next);
+            AK_free(next);
+        }
+    }
+    AK_btree_write(block);
+    AK_btree_write(sibling);
+    AK_free(old);
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that adds an entry to an open index
+ * @param index open index
+ * @param key key
+ * @param size size of the key
+ * @param rid row
+ * @param included values of included attributes as AK_btree_included writes them, NULL if there are none
+ * @param included_size size of the values
+ * @return EXIT_SUCCESS if the entry is in the index, EXIT_ERROR otherwise
+ */
+static int AK_btree_insert_entry(AK_btree_index *index, char *key, int size, AK_btree_rid *rid, char *included,
+                                 int included_size) {
+    char raw[BTREE_MAX_ENTRY_SIZE];
+    int path[BTREE_MAX_HEIGHT], slots[BTREE_MAX_HEIGHT];
+    int depth, pos, raw_size;
+    AK_block *block, *sibling, *root;
+
+    block = AK_btree_descend(index, key, size, rid, path, slots, &depth);
+    pos = AK_btree_bound(block, index->meta.type, key, size, rid, 0);
+    if (pos < AK_btree_page_of(block)->num_entries &&
+        AK_btree_compare(block, pos, index->meta.type, key, size, rid) == 0) {
+        AK_free(block);
+        return EXIT_SUCCESS;
+    }
+    raw_size = AK_btree_entry(raw, 0, key, size, rid, 0);
+    if (included_size > 0) {
+        memcpy(raw + raw_size, included, included_size);
+        raw_size += included_size;
+    }
+
+    for (;;) {
+        if (AK_btree_fits(block, raw_size)) {
+            AK_btree_put(block, pos, index->meta.type, raw, raw_size);
+            AK_btree_write(block);
+            AK_free(block);
+            break;
+        }
+        if (depth == 0 && index->meta.height >= BTREE_MAX_HEIGHT) {
+            AK_free(block);
+            return EXIT_ERROR;
+        }
+        sibling = AK_btree_new_page(index, AK_btree_page_of(block)->level);
+        if (sibling == NULL) {
+            AK_free(block);
+            return EXIT_ERROR;
+        }
+        AK_btree_split(index, block, sibling, pos, raw, &raw_size);
+
+        //a split root gets a parent with both halves
+        if (depth == 0) {
+            root = AK_btree_new_page(index, AK_btree_page_of(block)->level + 1);
+            if (root == NULL) {
+                AK_free(block);
+                AK_free(sibling);
+                return EXIT_ERROR;
+            }
+            AK_btree_page_of(root)->child = block->address;
+            AK_btree_put(root, 0, index->meta.type, raw, raw_size);
+            AK_btree_write(root);
+            index->meta.root = root->address;
+            index->meta.height++;
+            AK_free(root);
+            AK_free(block);
+            AK_free(sibling);
+            break;
+        }
+        AK_free(block);
+        AK_free(sibling);
+        //the separator goes right after the entry that pointed to the split page
+        pos = slots[depth] + 1;
+        depth--;
+        block = AK_btree_read(path[depth]);
+    }
+    index->meta.num_entries++;
+    index->dirty = 1;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that merges a page with its right sibling if their entries fit into one page. Entries of an
+ *        internal page are joined by the entry of the parent that separates them.
+ * @param index open index
+ * @param left page
+ * @param right right sibling of the page
+ * @param parent parent of both pages
+ * @param separator index of the entry of the parent that points to the right sibling
+ * @return 1 if the pages were merged and the right one freed, otherwise 0
+ */
+static int AK_btree_merge(AK_btree_index *index, AK_block *left, AK_block *right, AK_block *parent, int separator) {
+    char raw[sizeof (AK_btree_rid) + sizeof (int) + MAX_VARCHAR_LENGTH];
+    AK_btree_page *page = AK_btree_page_of(left);
+    AK_btree_page *right_page = AK_btree_page_of(right);
+    AK_block *next;
+    int i, extra = 0, raw_size;
+
+    if (page->level > 0)
+        extra = parent->tuple_dict[separator].size;
+    if (AK_btree_used(left) + AK_btree_used(right) - (int) sizeof (AK_btree_page) + extra > DATA_BLOCK_SIZE * DATA_ENTRY_SIZE ||
+        page->num_entries + right_page->num_entries + (page->level > 0) > DATA_BLOCK_SIZE)
+        return 0;
+
+    if (page->level > 0) {
+        raw_size = parent->tuple_dict[separator].size;
+        memcpy(raw, AK_btree_raw(parent, separator), raw_size);
+        memcpy(raw + sizeof (AK_btree_rid), &right_page->child, sizeof (int));
+        AK_btree_put(left, page->num_entries, index->meta.type, raw, raw_size);
+    }
+    for (i = 0; i < right_page->num_entries; i++)
+        AK_btree_put(left, page->num_entries, index->meta.type, AK_btree_raw(right, i), right->tuple_dict[i].size);
+
+    if (page->level == 0) {
+        page->next = right_page->next;
+        if (right_page->next != 0) {
+            next = AK_btree_read(right_page->next);
+            AK_btree_page_of(next)->prev = left->address;
+            AK_btree_write(next);
+            AK_free(next);
+        }
+    }
+    AK_btree_write(left);
+    AK_btree_free_page(index, right);
+    return 1;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that removes an entry from an open index
+ * @param index open index
+ * @param key key
+ * @param size size of the key
+ * @param rid row
+ * @return EXIT_SUCCESS if the entry was removed, EXIT_ERROR if it is not in the index
+ */
+static int AK_btree_remove_entry(AK_btree_index *index, char *key, int size, AK_btree_rid *rid) {
+    int path[BTREE_MAX_HEIGHT], slots[BTREE_MAX_HEIGHT];
+    int depth, pos, slot, separator;
+    AK_block *block, *parent, *left, *right;
+    AK_btree_page *page;
+
+    block = AK_btree_descend(index, key, size, rid, path, slots, &depth);
+    pos = AK_btree_bound(block, index->meta.type, key, size, rid, 0);
+    if (pos >= AK_btree_page_of(block)->num_entries ||
+        AK_btree_compare(block, pos, index->meta.type, key, size, rid) != 0) {
+        AK_free(block);
+        return EXIT_ERROR;
+    }
+    AK_btree_cut(block, pos);
+    index->meta.num_entries--;
+    index->dirty = 1;
+
+    for (;;) {
+        page = AK_btree_page_of(block);
+        //a root with a single child is replaced by the child
+        if (depth == 0) {
+            if (page->level > 0 && page->num_entries == 0) {
+                index->meta.root = page->child;
+                index->meta.height--;
+                AK_btree_free_page(index, block);
+            } else
+                AK_btree_write(block);
+            AK_free(block);
+            break;
+        }
+        if (AK_btree_used(block) * 100 >= DATA_BLOCK_SIZE * DATA_ENTRY_SIZE * BTREE_MERGE_PERCENT) {
+            AK_btree_write(block);
+            AK_free(block);
+            break;
+        }
+
+        parent = AK_btree_read(path[depth - 1]);
+        slot = slots[depth];
+        if (slot + 1 < AK_btree_page_of(parent)->num_entries) {
+            left = block;
+            right = AK_btree_read(AK_btree_child(parent, slot + 1));
+            separator = slot + 1;
+        } else if (slot >= 0) {
+            left = AK_btree_read(AK_btree_child(parent, slot - 1));
+            right = block;
+            separator = slot;
+        } else {
+            AK_btree_write(block);
+            AK_free(block);
+            AK_free(parent);
+            break;
+        }
+
+        if (!AK_btree_merge(index, left, right, parent, separator)) {
+            AK_btree_write(block);
+            AK_free(left);
+            AK_free(right);
+            AK_free(parent);
+            break;
+        }
+        AK_free(left);
+        AK_free(right);
+        AK_btree_cut(parent, separator);
+        block = parent;
+        depth--;
+    }
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that appends a page to the pages of one level of a bulk build
+ * @param pages pages of the level, the array grows when it is full
+ * @param num_pages number of pages in the array
+ * @param address address of the page
+ * @param first row and key of the first entry of the page
+ * @param size size of the row and key
+ * @return No return value
+ */
+static void AK_btree_built_add(AK_btree_built **pages, int *num_pages, int address, char *first, int size) {
+    //the array is doubled each time the number of pages reaches a power of two
+    if ((*num_pages & (*num_pages - 1)) == 0)
+        *pages = (AK_btree_built *) AK_realloc(*pages, (*num_pages == 0 ? 1 : *num_pages * 2) * sizeof (AK_btree_built));
+    (*pages)[*num_pages].address = address;
+    (*pages)[*num_pages].size = size;
+    memcpy((*pages)[*num_pages].first, first, size);
+    (*num_pages)++;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that returns how many bytes of the data area of a page a bulk build fills, by BTREE_FILL_FACTOR
+ * @return number of bytes
+ */
+static int AK_btree_fill_target() {
+    int fill = BTREE_FILL_FACTOR;
+
+    //pages are left with some free space, the last entry of an internal page always fits into it
+    if (fill < 10)
+        fill = 10;
+    if (fill > 90)
+        fill = 90;
+    return DATA_BLOCK_SIZE * DATA_ENTRY_SIZE * fill / 100;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that checks if a bulk build has to close a page before it adds an entry
+ * @param block page
+ * @param size size of the entry
+ * @param target number of bytes of the data area the build fills
+ * @return 1 if the page is full, otherwise 0
+ */
+static int AK_btree_built_full(AK_block *block, int size, int target) {
+    return AK_btree_page_of(block)->num_entries > 0 && (AK_btree_used(block) + size > target || !AK_btree_fits(block, size));
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that copies the indexed values of a table into a temporary table with rows (key, block, tuple),
+ *        where the key is one column for each of its attributes, followed by the values of the included attributes
+ * @param tblName name of the indexed table
+ * @param meta description of the index with the types and the positions of the attributes
+ * @param num_attr number of attributes of the table
+ * @param build name of the temporary table, it has to exist
+ * @return number of copied values, EXIT_ERROR if a row could not be written
+ */
+static int AK_btree_build_rows(char *tblName, AK_btree_meta *meta, int num_attr, char *build) {
+    AK_bulk_writer writer;
+    AK_tuple_dict entries[BTREE_MAX_KEYS + 2 + BTREE_MAX_INCLUDED];
+    AK_tuple_dict *value;
+    AK_block *block;
+    table_addresses *addresses;
+    char data[(BTREE_MAX_KEYS + BTREE_MAX_INCLUDED) * MAX_VARCHAR_LENGTH + 2 * sizeof (int)];
+    char key[MAX_VARCHAR_LENGTH];
+    int i, j, k, offset, address, last = meta->num_keys + 2, result = EXIT_SUCCESS;
+
+    if (AK_bulk_writer_open(&writer, build) == EXIT_ERROR)
+        return EXIT_ERROR;
+    //rows are read from the cache, where the latest versions of the blocks are
+    addresses = AK_btree_addresses(tblName);
+    block = (AK_block *) AK_malloc(sizeof (AK_block));
+    for (i = 0; i < MAX_EXTENTS_IN_SEGMENT && addresses->address_from[i] != 0 && result == EXIT_SUCCESS; i++) {
+        for (address = addresses->address_from[i]; address < addresses->address_to[i] && result == EXIT_SUCCESS; address++) {
+            pthread_mutex_lock(&AK_btree_cache_mutex);
+            memcpy(block, ((AK_mem_block *) AK_get_block(address))->block, sizeof (AK_block));
+            pthread_mutex_unlock(&AK_btree_cache_mutex);
+            if (block->tuple_dict[0].type == FREE_INT ||
+                (block->type != BLOCK_TYPE_NORMAL && block->type != BLOCK_TYPE_CHAINED))
+                continue;
+            for (j = 0; j + num_attr <= DATA_BLOCK_SIZE && block->tuple_dict[j].type != FREE_INT; j += num_attr) {
+                //deleted rows and nulls
+                if (AK_btree_row_key(meta, block->tuple_dict + j, (char *) block->data, -1, key) < 0)
+                    continue;
+                offset = 0;
+                for (k = 0; k < last + meta->num_included; k++) {
+                    //the row follows the key
+                    if (k == meta->num_keys || k == meta->num_keys + 1) {
+                        entries[k].type = TYPE_INT;
+                        entries[k].address = offset;
+                        entries[k].size = sizeof (int);
+                        memcpy(data + offset, k == meta->num_keys ? &address : &j, sizeof (int));
+                        offset += sizeof (int);
+                        continue;
+                    }
+                    value = &block->tuple_dict[j + (k < last ? meta->keys[k] : meta->included[k - last])];
+                    entries[k].type = value->type;
+                    entries[k].address = offset;
+                    entries[k].size = value->size > 0 && value->size <= MAX_VARCHAR_LENGTH ? value->size : 0;
+                    memcpy(data + offset, block->data + value->address, entries[k].size);
+                    offset += entries[k].size;
+                }
+                if (AK_bulk_write_entries(&writer, entries, data, last + meta->num_included) == EXIT_ERROR)
+                    result = EXIT_ERROR;
+            }
+        }
+    }
+    if (result == EXIT_SUCCESS)
+        result = writer.num_rows;
+    AK_bulk_writer_close(&writer);
+    AK_free(block);
+    AK_free(addresses);
+    return result;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that compares two entries of a bulk build sorted in memory by key and then by row
+ * @param left first entry
+ * @param right second entry
+ * @return negative number if the first entry comes first, 0 if the entries are equal, otherwise positive number
+ */
+static int AK_btree_pending_compare(const void *left, const void *right) {
+    const AK_btree_pending *a = (const AK_btree_pending *) left, *b = (const AK_btree_pending *) right;
+    AK_btree_rid a_rid, b_rid;
+    int fixed = AK_btree_fixed(0);
+    int result = AK_btree_compare_keys(a->type, a->raw + fixed, a->key_size - fixed, b->raw + fixed,
+                                       b->key_size - fixed);
+
+    if (result != 0)
+        return result;
+    memcpy(&a_rid, a->raw, sizeof (AK_btree_rid));
+    memcpy(&b_rid, b->raw, sizeof (AK_btree_rid));
+    if (a_rid.block != b_rid.block)
+        return a_rid.block < b_rid.block ? -1 : 1;
+    if (a_rid.tuple != b_rid.tuple)
+        return a_rid.tuple < b_rid.tuple ? -1 : 1;
+    return 0;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that reads the indexed values of a table straight into leaf entries held in memory and sorts
+ *        them, for tables small enough that a temporary table and AK_external_sort would cost more than the sort
+ * @param tblName name of the indexed table
+ * @param meta description of the index with the types and the positions of the attributes
+ * @param num_attr number of attributes of the table
+ * @param pending sorted entries, they point into the buffer
+ * @param buffer buffer with all entries
+ * @return number of entries
+ */
+static int AK_btree_memory_rows(char *tblName, AK_btree_meta *meta, int num_attr, AK_btree_pending **pending,
+                                char **buffer) {
+    char raw[BTREE_MAX_ENTRY_SIZE], key[MAX_VARCHAR_LENGTH];
+    AK_block *block;
+    AK_btree_rid rid;
+    table_addresses *addresses;
+    int i, j, address, size, key_size, used = 0, capacity = 0, num_rows = 0;
+
+    *pending = NULL;
+    *buffer = NULL;
+    addresses = AK_btree_addresses(tblName);
+    block = (AK_block *) AK_malloc(sizeof (AK_block));
+    for (i = 0; i < MAX_EXTENTS_IN_SEGMENT && addresses->address_from[i] != 0; i++) {
+        for (address = addresses->address_from[i]; address < addresses->address_to[i]; address++) {
+            pthread_mutex_lock(&AK_btree_cache_mutex);
+            memcpy(block, ((AK_mem_block *) AK_get_block(address))->block, sizeof (AK_block));
+            pthread_mutex_unlock(&AK_btree_cache_mutex);
+            if (block->tuple_dict[0].type == FREE_INT ||
+                (block->type != BLOCK_TYPE_NORMAL && block->type != BLOCK_TYPE_CHAINED))
+                continue;
+            for (j = 0; j + num_attr <= DATA_BLOCK_SIZE && block->tuple_dict[j].type != FREE_INT; j += num_attr) {
+                size = AK_btree_row_key(meta, block->tuple_dict + j, (char *) block->data, -1, key);
+                if (size < 0)
+                    continue;
+                rid.block = address;
+                rid.tuple = j;
+                key_size = AK_btree_entry(raw, 0, key, size, &rid, 0);
+                size = key_size + AK_btree_included(raw + key_size, meta, block->tuple_dict + j, (char *) block->data,
+                                                    -1);
+                //both arrays are doubled when they are full
+                if ((num_rows & (num_rows - 1)) == 0)
+                    *pending = (AK_btree_pending *) AK_realloc(*pending, (num_rows == 0 ? 1 : num_rows * 2) *
+                                                               sizeof (AK_btree_pending));
+                while (used + size > capacity) {
+                    capacity = capacity == 0 ? BTREE_MAX_ENTRY_SIZE * 16 : capacity * 2;
+                    *buffer = (char *) AK_realloc(*buffer, capacity);
+                }
+                memcpy(*buffer + used, raw, size);
+                (*pending)[num_rows].offset = used;
+                (*pending)[num_rows].key_size = key_size;
+                (*pending)[num_rows].size = size;
+                (*pending)[num_rows].type = meta->type;
+                used += size;
+                num_rows++;
+            }
+        }
+    }
+    for (i = 0; i < num_rows; i++)
+        (*pending)[i].raw = *buffer + (*pending)[i].offset;
+    qsort(*pending, num_rows, sizeof (AK_btree_pending), AK_btree_pending_compare);
+    AK_free(block);
+    AK_free(addresses);
+    return num_rows;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that adds the next entry of a bulk build to the last leaf, or to a new leaf taken from the index
+ *        when the last one is full. A leaf is written once, when the next one is started.
+ * @param index open index
+ * @param leaf last leaf, NULL before the first entry
+ * @param raw entry
+ * @param key_size size of the row and the key at the start of the entry
+ * @param size size of the entry
+ * @param target number of bytes of the data area each leaf is filled with
+ * @param leaves written leaves, in order
+ * @param num_leaves number of written leaves
+ * @return EXIT_SUCCESS, EXIT_ERROR if the index could not be extended
+ */
+static int AK_btree_build_entry(AK_btree_index *index, AK_block **leaf, char *raw, int key_size, int size, int target,
+                                AK_btree_built **leaves, int *num_leaves) {
+    AK_block *next;
+
+    if (*leaf == NULL || AK_btree_built_full(*leaf, size, target)) {
+        next = AK_btree_new_page(index, 0);
+        if (next == NULL)
+            return EXIT_ERROR;
+        if (*leaf != NULL) {
+            AK_btree_page_of(*leaf)->next = next->address;
+            AK_btree_page_of(next)->prev = (*leaf)->address;
+            AK_btree_write(*leaf);
+            AK_free(*leaf);
+        }
+        *leaf = next;
+        AK_btree_built_add(leaves, num_leaves, next->address, raw, key_size);
+    }
+    AK_btree_put(*leaf, AK_btree_page_of(*leaf)->num_entries, index->meta.type, raw, size);
+    index->meta.num_entries++;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that packs the sorted entries of a bulk build into leaves. Leaves are taken from the index one
+ *        after another, each one is filled up to the target and written once, when the next one is started.
+ * @param index open index
+ * @param sorted name of the table with rows (key, block, tuple) and the included values in the order of the index,
+ *        NULL if the entries are sorted in memory
+ * @param pending entries sorted in memory
+ * @param num_pending number of entries sorted in memory
+ * @param target number of bytes of the data area each leaf is filled with
+ * @param leaves written leaves, in order
+ * @param num_leaves number of written leaves
+ * @return EXIT_SUCCESS, EXIT_ERROR if the index could not be extended
+ */
+static int AK_btree_build_leaves(AK_btree_index *index, char *sorted, AK_btree_pending *pending, int num_pending,
+                                 int target, AK_btree_built **leaves, int *num_leaves) {
+    char raw[BTREE_MAX_ENTRY_SIZE], key[MAX_VARCHAR_LENGTH];
+    AK_block *block, *leaf = NULL;
+    AK_btree_rid rid;
+    table_addresses *addresses;
+    int i, j, address, size, key_size, num_keys = index->meta.num_keys, result = EXIT_SUCCESS;
+    int stride = num_keys + 2 + index->meta.num_included;
+
+    for (i = 0; i < num_pending && result == EXIT_SUCCESS; i++)
+        result = AK_btree_build_entry(index, &leaf, pending[i].raw, pending[i].key_size, pending[i].size, target,
+                                      leaves, num_leaves);
+    addresses = sorted != NULL ? AK_btree_addresses(sorted) : NULL;
+    block = (AK_block *) AK_malloc(sizeof (AK_block));
+    for (i = 0; addresses != NULL && i < MAX_EXTENTS_IN_SEGMENT && addresses->address_from[i] != 0 &&
+         result == EXIT_SUCCESS; i++) {
+        for (address = addresses->address_from[i]; address < addresses->address_to[i] && result == EXIT_SUCCESS; address++) {
+            pthread_mutex_lock(&AK_btree_cache_mutex);
+            memcpy(block, ((AK_mem_block *) AK_get_block(address))->block, sizeof (AK_block));
+            pthread_mutex_unlock(&AK_btree_cache_mutex);
+            for (j = 0; j + stride <= DATA_BLOCK_SIZE && block->tuple_dict[j].type != FREE_INT && result == EXIT_SUCCESS;
+                 j += stride) {
+                memcpy(&rid.block, block->data + block->tuple_dict[j + num_keys].address, sizeof (int));
+                memcpy(&rid.tuple, block->data + block->tuple_dict[j + num_keys + 1].address, sizeof (int));
+                size = AK_btree_row_key(&index->meta, block->tuple_dict + j, (char *) block->data, 0, key);
+                key_size = AK_btree_entry(raw, 0, key, size, &rid, 0);
+                size = key_size + AK_btree_included(raw + key_size, &index->meta, block->tuple_dict,
+                                                    (char *) block->data, j + num_keys + 2);
+                result = AK_btree_build_entry(index, &leaf, raw, key_size, size, target, leaves, num_leaves);
+            }
+        }
+    }
+    if (leaf != NULL) {
+        AK_btree_write(leaf);
+        AK_free(leaf);
+    }
+    AK_free(block);
+    if (addresses != NULL)
+        AK_free(addresses);
+    return result;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that builds one level of internal pages above the pages of the level below. The first child of a
+ *        page is its leftmost child and every other child adds an entry with the first entry of the child. A page
+ *        is closed when it reaches the target, but the last child always joins the page before it, so no page is
+ *        left without entries.
+ * @param index open index
+ * @param children pages of the level below, in order
+ * @param num_children number of pages of the level below
+ * @param level level of the new pages
+ * @param target number of bytes of the data area each page is filled with
+ * @param parents written pages of the new level, in order
+ * @param num_parents number of written pages
+ * @return EXIT_SUCCESS, EXIT_ERROR if the index could not be extended
+ */
+static int AK_btree_build_level(AK_btree_index *index, AK_btree_built *children, int num_children, int level,
+                                int target, AK_btree_built **parents, int *num_parents) {
+    char raw[sizeof (AK_btree_rid) + sizeof (int) + MAX_VARCHAR_LENGTH];
+    AK_block *page = NULL;
+    AK_btree_rid rid;
+    int i, size;
+
+    for (i = 0; i < num_children; i++) {
+        memcpy(&rid, children[i].first, sizeof (AK_btree_rid));
+        size = AK_btree_entry(raw, level, children[i].first + sizeof (AK_btree_rid),
+                              children[i].size - sizeof (AK_btree_rid), &rid, children[i].address);
+        if (page != NULL && (i < num_children - 1 || !AK_btree_fits(page, size)) &&
+            AK_btree_built_full(page, size, target)) {
+            AK_btree_write(page);
+            AK_free(page);
+            page = NULL;
+        }
+        if (page == NULL) {
+            page = AK_btree_new_page(index, level);
+            if (page == NULL)
+                return EXIT_ERROR;
+            AK_btree_page_of(page)->child = children[i].address;
+            AK_btree_built_add(parents, num_parents, page->address, children[i].first, children[i].size);
+            continue;
+        }
+        AK_btree_put(page, AK_btree_page_of(page)->num_entries, index->meta.type, raw, size);
+    }
+    AK_btree_write(page);
+    AK_free(page);
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that builds a B+tree index from the bottom up. Sorted entries are packed into leaves and each
+ *        level of internal pages is built above the one below it, until a level has a single page, the root.
+ * @param index open index with the first block initialized
+ * @param sorted name of the table with rows (key, block, tuple) and the included values in the order of the index,
+ *        NULL if the entries are sorted in memory
+ * @param pending entries sorted in memory
+ * @param num_pending number of entries sorted in memory
+ * @return EXIT_SUCCESS, EXIT_ERROR if the index could not be extended
+ */
+static int AK_btree_build(AK_btree_index *index, char *sorted, AK_btree_pending *pending, int num_pending) {
+    AK_btree_built *pages = NULL, *parents;
+    AK_block *root;
+    int num_pages = 0, num_parents, fill, result;
+
+    fill = AK_btree_fill_target();
+    result = AK_btree_build_leaves(index, sorted, pending, num_pending, fill, &pages, &num_pages);
+    index->meta.height = 1;
+    if (result == EXIT_SUCCESS && num_pages == 0) {
+        //an index of a table without values is an empty leaf
+        root = AK_btree_new_page(index, 0);
+        if (root == NULL)
+            return EXIT_ERROR;
+        index->meta.root = root->address;
+        AK_btree_write(root);
+        AK_free(root);
+        return EXIT_SUCCESS;
+    }
+    while (result == EXIT_SUCCESS && num_pages > 1 && index->meta.height < BTREE_MAX_HEIGHT) {
+        parents = NULL;
+        num_parents = 0;
+        result = AK_btree_build_level(index, pages, num_pages, index->meta.height, fill, &parents, &num_parents);
+        AK_free(pages);
+        pages = parents;
+        num_pages = num_parents;
+        index->meta.height++;
+    }
+    if (result == EXIT_SUCCESS && num_pages == 1)
+        index->meta.root = pages[0].address;
+    else
+        result = EXIT_ERROR;
+    AK_free(pages);
+    return result;
+}
 
 /**
-  * @author Anđelko Spevec
-  * @brief Function that creates new btree index on integer attribute in table
-  * @param tblName - name of the table on which we are creating index
-  * @param attributes - attribute on which we are creating index
-  * @param indexName - name of the index
- */
-/* 
-NOTES: 1. For now we assume that table is sorted on attribute on which we are
-creating index. We should check that with filesort.c and include it in this function.
-That file had some errors, so I couldn't test it. 2.working with multiple blocks
-*/
-AK_block * AK_btree_create(char *tblName, struct list_node *attributes, char *indexName){
-	int i,n,exist;
-	table_addresses *addresses;
-	int num_attr;
-	AK_PRO;
-	
-	//get table address
-	addresses = (table_addresses*) AK_get_table_addresses(tblName);
-	num_attr = AK_num_attr(tblName);
-
-	while(addresses->address_from[ i ]){
-		printf("\nAddress of the TABLE is from %u to %u \n",(addresses->address_from[ i ]),(addresses->address_to[ i ]));
-		i++;
-	}
-	
-	//get table header
-	AK_header *table_header = (AK_header *)AK_get_header(tblName);
-    	struct list_node *attribute = (struct list_node *) AK_First_L2(attributes);
-	AK_header i_header[ MAX_ATTRIBUTES ];
-	AK_header* temp;
-    	n = 0;
-    	
-    	//get table attributes
-	while (attribute != 0) {
-		exist = 0;
-		for (i = 0; i < num_attr; i++) {
-		    if (strcmp((table_header + i)->att_name, attribute->data) == 0) {
-			printf("Attribute %s exist in table, found on position: %d\n", (table_header + i)->att_name, i);
-			AK_dbg_messg(HIGH, INDICES, "Attribute %s exist in table, found on position: %d\n", (table_header + i)->att_name, i);
-			exist = 1;
-			temp = (AK_header*) AK_create_header((table_header + i)->att_name, (table_header + i)->type, FREE_INT, FREE_CHAR, FREE_CHAR);
-			memcpy(i_header + n, temp, sizeof ( AK_header));
-			n++;
-			if ((table_header)->type != TYPE_INT) {
-			    printf("Unsupported data type for bree index! Only int!");
-			    AK_EPI;
-			    return NULL;
-			    //return EXIT_ERROR;
-			}
-		    }
-		}
-		if (!exist) {
-		    printf("Attribute %s does not exists in table", attribute->data);
-		    AK_EPI;
-		    return NULL;
-		    //return EXIT_ERROR;
-		}
-		attribute = attribute->next;
-	} 
-	memset(i_header + n, 0, MAX_ATTRIBUTES - n);
-
-	//creating index
-	int startAddress = AK_initialize_new_segment(indexName, SEGMENT_TYPE_INDEX, i_header);
-	if (startAddress != EXIT_ERROR)
-		printf("\nINDEX %s CREATED!\n", indexName);
-        int r;
-	table_addresses *addIndex = (table_addresses*) AK_get_index_addresses(indexName);
-	while(addIndex->address_from[ r ]){
-		printf("\nAddress of the INDEX is from %u to %u \n",(addIndex->address_from[ r ]),(addIndex->address_to[ r ]));
-		r++;
-	}
-	AK_block *block = (AK_block*) AK_read_block(startAddress);
-	int adr_to_write = (int) AK_find_AK_free_space(AK_get_index_addresses(indexName));
-	int number_el = AK_get_num_records(tblName);			
-	root_info *rootEl = (root_info*) AK_malloc(sizeof(root_info));
-
-	//number of LEAFS--------------------B=3---------------number_leaf
-	float x = (float) number_el;
-	float y = x/B;
-	int number_leaf = 0;
-	while(y > 0){
-		y = y - 1;
-		number_leaf = number_leaf + 1;
-	}//instead of ceil function
-	rootEl->level[0] = number_leaf;
-	
-	//number of NODES (level above leafs)--------(B+1)-----number_node
-	float m = (float) number_leaf;
-	float node = m/(B+1);
-	int number_node = 0;
-	while(node > 0){
-		node = node - 1;
-		number_node = number_node + 1;
-	}//instead of ceil function
-	rootEl->level[1] = number_node;
-
-	//number of NODES (remaining nodes)---------(B+1)------number_node
-	float temp_one = (float) number_node;
-	int temp_two = 0;
-	int lvl = 2;
-	int go = 1;
-	while(go == 1){
-		node = temp_one/(B+1);
-		temp_two = 0;
-		while(node > 0){
-			node = node - 1;
-			temp_two = temp_two + 1;
-		}
-		rootEl->level[lvl] = temp_two;
-		lvl++;
-		number_node = number_node + temp_two;
-		temp_one = (float) temp_two;
-		if(temp_two == 1)
-			go = 0;
-	}
-	
-	//writing root_info
-	rootEl->root = number_leaf + number_node;
-	memcpy(block->data, rootEl, sizeof(root_info));
-	block->tuple_dict[0].address = 0;
-	block->tuple_dict[0].type = BLOCK_TYPE_NORMAL;
-    	block->tuple_dict[0].size = sizeof (root_info);
-	block->AK_free_space += sizeof (root_info);
-	block->last_tuple_dict_id = 0;
-	AK_write_block(block);
-	
-	//writting leafs
-	int id,lf,b,help=0,elements=0;
-	int help_two[number_el];
-	for(lf=1;lf<=(rootEl->level[0]);lf++){
-		btree_node *leaf = (btree_node*) AK_malloc(sizeof(btree_node));
-		i=0;
-		AK_block *temp = (AK_block*) AK_read_block(addresses->address_from[ i ]);
-
-		for(b=0;b<B;b++){
-			if(elements<number_el){
-				leaf->pointers[b].addBlock = addresses->address_from[ i ];
-				leaf->pointers[b].indexTd = help;
-				void *tem = (void *) AK_calloc(MAX_VARCHAR_LENGTH, sizeof (void));
-	      		        memcpy(tem, &(temp->data[temp->tuple_dict[help].address]), sizeof (int));
-				leaf->values[b] = *((int *) tem);
-				help_two[elements] = leaf->values[b];
-				help += num_attr;
-				elements++;
-			}else{
-				leaf->values[b] = -1;
-				elements++;
-			}
-		}
-		if(lf<(rootEl->level[0])){
-			leaf->pointers[B].addBlock = addresses->address_from[ i ];
-			leaf->pointers[B].indexTd = lf+1;
-		}	
-		memcpy(&block->data[block->AK_free_space], leaf, sizeof(btree_node));    
-		id = block->last_tuple_dict_id + 1;
-		block->tuple_dict[id].address = block->AK_free_space;
-		block->tuple_dict[id].type = LEAF;
-		block->AK_free_space += sizeof(btree_node);
-		block->last_tuple_dict_id = id;
-		AK_write_block(block);
-	}
-	
-	//writting nodes
-	int no=1,v=1,d,e=0,f,h,offset,diff,skip=1,check;
-	while(no==1){
-		check=0;
-		offset=1;
-		for(h=0;h<e;h++)////instead of pow function
-			offset = offset*(B+1); 
-		diff = offset * B;//difference WITHIN node
-		offset = offset * B + 1;
-		for(d=0;d<(rootEl->level[v]);d++){
-			btree_node *nodes = (btree_node*) AK_malloc(sizeof(btree_node));
-			for(f=0;f<B;f++){
-				if((offset-1)<number_el){
-					nodes->values[f] = help_two[offset-1];
-				}else{
-					nodes->values[f] = -1;
-				}
-				offset += diff;//difference WITHIN node
-			}
-			offset += diff;//difference BETWEEN nodes is doubled
-			for(f=0;f<=B;f++){
-					if(check<(rootEl->level[v-1])){
-						nodes->pointers[f].indexTd = skip;
-						nodes->pointers[f].addBlock = adr_to_write;
-						skip++;
-						check++;
-					}	
-			}
-			memcpy(&block->data[block->AK_free_space], nodes, sizeof(btree_node)); 
-			id = block->last_tuple_dict_id + 1;
-			block->tuple_dict[id].address = block->AK_free_space;
-			block->tuple_dict[id].type = NODE;
-			block->AK_free_space += sizeof(btree_node);
-			block->last_tuple_dict_id = id;
-			AK_write_block(block);
-		}		
-		e++;
-		if(rootEl->level[v] == 1)
-			no = 0;
-		v++;
-	}
-	printf("B tree created succesfully.");
-	AK_EPI;
-	return block;
-	//return EXIT_SUCCESS;
-}
-
-/**
-  * @author unknown
-  * @brief Function that deletes index
-  * @param indexName - name of the index+
- */
-int AK_btree_delete(char *indexName){
+ * @author Karlo Vuković
+ * @brief Function that copies the indexed values of a table into a temporary table and sorts it by key and row
+ *        with AK_external_sort into another one, for tables too big to be sorted in memory
+ * @param tblName name of the indexed table
+ * @param meta description of the index
+ * @param header header of the table
+ * @param num_attr number of attributes of the table
+ * @param indexName name of the index, the temporary tables are named after it
+ * @param sorted buffer of MAX_ATT_NAME characters for the name of the sorted table, which exists if there were
+ *        values to sort
+ * @return number of sorted values, EXIT_ERROR if they could not be written or sorted
+ */
+static int AK_btree_sort_rows(char *tblName, AK_btree_meta *meta, AK_header *header, int num_attr, char *indexName,
+                              char *sorted) {
+    AK_header build_header[MAX_ATTRIBUTES];
+    struct list_node *sort_keys;
+    char build[MAX_ATT_NAME];
+    int i, num_keys = meta->num_keys, num_rows;
+
+    //(key, row) pairs are copied into a temporary table and sorted by the sort subsystem
+    snprintf(build, MAX_ATT_NAME, "%s__btree_build", indexName);
+    snprintf(sorted, MAX_ATT_NAME, "%s__btree_sorted", indexName);
+    memset(build_header, 0, sizeof (build_header));
+    for (i = 0; i < num_keys; i++)
+        memcpy(&build_header[i], &header[meta->keys[i]], sizeof (AK_header));
+    build_header[num_keys].type = TYPE_INT;
+    strcpy(build_header[num_keys].att_name, "block");
+    build_header[num_keys + 1].type = TYPE_INT;
+    strcpy(build_header[num_keys + 1].att_name, "tuple");
+    for (i = 0; i < meta->num_included; i++) {
+        memcpy(&build_header[num_keys + 2 + i], &header[meta->included[i]], sizeof (AK_header));
+        snprintf(build_header[num_keys + 2 + i].att_name, MAX_ATT_NAME, "included%d", i);
+    }
+    //tables left behind by a build that did not finish
+    if (AK_num_attr(build) > 0)
+        AK_delete_segment(build, SEGMENT_TYPE_TABLE);
+    if (AK_num_attr(sorted) > 0)
+        AK_delete_segment(sorted, SEGMENT_TYPE_TABLE);
+    AK_initialize_new_segment(build, SEGMENT_TYPE_TABLE, build_header);
+    num_rows = AK_btree_build_rows(tblName, meta, num_attr, build);
+    if (num_rows > 0) {
+        sort_keys = (struct list_node *) AK_malloc(sizeof (struct list_node));
+        AK_Init_L3(&sort_keys);
+        for (i = 0; i < num_keys; i++)
+            AK_InsertAtEnd_L3(TYPE_ATTRIBS, header[meta->keys[i]].att_name, strlen(header[meta->keys[i]].att_name) + 1,
+                              sort_keys);
+        AK_InsertAtEnd_L3(TYPE_ATTRIBS, "block", strlen("block") + 1, sort_keys);
+        AK_InsertAtEnd_L3(TYPE_ATTRIBS, "tuple", strlen("tuple") + 1, sort_keys);
+        if (AK_external_sort(build, sorted, sort_keys, SORT_MEMORY_BLOCKS, SORT_THREADS) == EXIT_ERROR)
+            num_rows = EXIT_ERROR;
+        AK_DeleteAll_L3(&sort_keys);
+        AK_free(sort_keys);
+    }
+    AK_delete_segment(build, SEGMENT_TYPE_TABLE);
+    return num_rows;
+}
+
+/**
+ * @author Anđelko Spevec, updated by Karlo Vuković (disk B+tree with typed keys, included attributes, builds of
+ *         small tables in memory)
+ * @brief Function that creates a new B+tree index on an attribute of a table. The index is a segment registered in
+ *        AK_relation, its first block holds AK_btree_meta and every other block one page of the tree. Values are
+ *        copied with their rows into a temporary table, sorted with AK_external_sort and packed into pages from
+ *        the bottom up, BTREE_FILL_FACTOR percent full. Values of a table that fits into SORT_MEMORY_BLOCKS blocks
+ *        are sorted in memory instead, without temporary tables. Values stored with another type than the
+ *        attribute, like nulls, are not indexed. Attributes after the first one are included attributes, up to
+ *        BTREE_MAX_INCLUDED of them, their values are kept in the leaves, so queries that need only them and the key
+ *        do not read the table. Tables with the PAX layout can not be indexed.
+ * @param tblName name of the table on which we are creating index
+ * @param attributes attribute on which we are creating index, followed by the included attributes
+ * @param indexName name of the index
+ * @return EXIT_SUCCESS if the index was created, EXIT_ERROR otherwise
+ */
+int AK_btree_create(char *tblName, struct list_node *attributes, char *indexName) {
+    int result;
     AK_PRO;
-    AK_delete_segment(indexName, SEGMENT_TYPE_INDEX);
-    printf("INDEX %s DELETED!\n", indexName);
+    result = AK_btree_create_composite(tblName, attributes, 1, indexName);
+    AK_EPI;
+    return result;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that finds the attributes of a new index in the header of its table. Every attribute can be in
+ *        the index only once.
+ * @param header header of the table
+ * @param num_attr number of attributes of the table
+ * @param attributes names of the attributes, first the ones of the key and then the included ones
+ * @param num_keys number of attributes of the key
+ * @param keys positions of the attributes of the key
+ * @param included positions of the included attributes
+ * @param indexName name of the index
+ * @return number of included attributes, EXIT_ERROR if an attribute does not exist, repeats or there are too many
+ */
+static int AK_btree_attributes(AK_header *header, int num_attr, struct list_node *attributes, int num_keys, int *keys,
+                               int *included, char *indexName) {
+    struct list_node *attribute = AK_First_L2(attributes);
+    int i, att, found = 0;
+
+    for (; attribute != NULL; attribute = AK_Next_L2(attribute), found++) {
+        for (att = 0; att < num_attr; att++) {
+            if (strcmp(header[att].att_name, attribute->data) == 0)
+                break;
+        }
+        for (i = 0; i < found && att < num_attr; i++) {
+            if ((i < num_keys ? keys[i] : included[i - num_keys]) == att)
+                att = num_attr;
+        }
+        if (att == num_attr || found == num_keys + BTREE_MAX_INCLUDED) {
+            printf("AK_btree_create: Attribute %s can not be in index %s!\n", attribute->data, indexName);
+            return EXIT_ERROR;
+        }
+        if (found < num_keys)
+            keys[found] = att;
+        else
+            included[found - num_keys] = att;
+    }
+    if (found < num_keys) {
+        printf("AK_btree_create: B+tree index %s needs %d attributes for its key!\n", indexName, num_keys);
+        return EXIT_ERROR;
+    }
+    return found - num_keys;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that creates a new B+tree index with a key on several attributes of a table. Keys are ordered by
+ *        the first attribute, then by the second one and so on, and a key made with AK_btree_make_key from values of
+ *        the first attributes finds all entries that start with them. Attributes after the key are included
+ *        attributes, as in AK_btree_create. Rows with a null in an attribute of the key are not indexed, and tables
+ *        with the PAX layout can not be indexed.
+ * @param tblName name of the table on which we are creating index
+ * @param attributes attributes of the key, followed by the included attributes
+ * @param num_keys number of attributes of the key, up to BTREE_MAX_KEYS
+ * @param indexName name of the index
+ * @return EXIT_SUCCESS if the index was created, EXIT_ERROR otherwise
+ */
+int AK_btree_create_composite(char *tblName, struct list_node *attributes, int num_keys, char *indexName) {
+    AK_header *header;
+    AK_header b_header[MAX_ATTRIBUTES];
+    AK_btree_index index;
+    AK_btree_pending *pending = NULL;
+    AK_block *block;
+    table_addresses *addresses;
+    char sorted[MAX_ATT_NAME], *buffer = NULL;
+    int keys[BTREE_MAX_KEYS], included[BTREE_MAX_INCLUDED];
+    int num_attr, num_rows, att, num_included, address, i, num_blocks = 0, in_memory, result = EXIT_SUCCESS;
+    AK_PRO;
+
+    num_attr = AK_num_attr(tblName);
+    header = (AK_header *) AK_get_header(tblName);
+    if (header == NULL || num_attr <= 0 || num_attr > MAX_ATTRIBUTES || num_keys < 1 || num_keys > BTREE_MAX_KEYS) {
+        printf("AK_btree_create: Table %s does not exist or the index has too many attributes!\n", tblName);
+        AK_free(header);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    //rows of PAX blocks are split into minipages, which readers of the index can not find
+    if (AK_get_storage_layout(tblName) != BLOCK_TYPE_NORMAL) {
+        printf("AK_btree_create: Table %s has the PAX layout, it can not be indexed!\n", tblName);
+        AK_free(header);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    num_included = AK_btree_attributes(header, num_attr, attributes, num_keys, keys, included, indexName);
+    if (num_included == EXIT_ERROR || num_keys + 2 + num_included > MAX_ATTRIBUTES) {
+        AK_free(header);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    att = keys[0];
+    addresses = AK_btree_addresses(indexName);
+    address = addresses->address_from[0];
+    AK_free(addresses);
+    if (address != 0) {
+        printf("AK_btree_create: Index %s already exists!\n", indexName);
+        AK_free(header);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+
+    memset(b_header, 0, sizeof (b_header));
+    for (i = 0; i < num_keys; i++)
+        memcpy(&b_header[i], &header[keys[i]], sizeof (AK_header));
+    if (AK_initialize_new_segment(indexName, SEGMENT_TYPE_INDEX, b_header) == EXIT_ERROR) {
+        AK_free(header);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+
+    memset(&index.meta, 0, sizeof (AK_btree_meta));
+    index.meta.type = num_keys > 1 ? BTREE_TYPE_COMPOSITE : header[att].type;
+    index.meta.position = att;
+    index.meta.num_keys = num_keys;
+    for (i = 0; i < num_keys; i++) {
+        index.meta.keys[i] = keys[i];
+        index.meta.key_types[i] = header[keys[i]].type;
+    }
+    index.meta.num_included = num_included;
+    memcpy(index.meta.included, included, num_included * sizeof (int));
+
+    //a table that fits into the memory of a sort is sorted right away, without temporary tables
+    addresses = AK_btree_addresses(tblName);
+    for (i = 0; i < MAX_EXTENTS_IN_SEGMENT && addresses->address_from[i] != 0; i++)
+        num_blocks += addresses->address_to[i] - addresses->address_from[i];
+    AK_free(addresses);
+    in_memory = num_blocks <= SORT_MEMORY_BLOCKS;
+    if (in_memory)
+        num_rows = AK_btree_memory_rows(tblName, &index.meta, num_attr, &pending, &buffer);
+    else
+        num_rows = AK_btree_sort_rows(tblName, &index.meta, header, num_attr, indexName, sorted);
+
+    pthread_rwlock_wrlock(&AK_btree_lock);
+    AK_btree_forget(indexName);
+    index.name = indexName;
+    index.addresses = AK_btree_addresses(indexName);
+    index.address = index.addresses->address_from[0];
+    index.dirty = 1;
+    index.meta.num_pages = 1;
+    strncpy(index.meta.name, indexName, MAX_ATT_NAME - 1);
+    strncpy(index.meta.table, tblName, MAX_ATT_NAME - 1);
+    strncpy(index.meta.attribute, header[att].att_name, MAX_ATT_NAME - 1);
+
+    block = AK_btree_read(index.address);
+    AK_btree_init_page(block, 0);
+    AK_btree_write(block);
+    AK_free(block);
+    //leaves and internal pages are written once each, in the order the blocks of the segment follow
+    if (num_rows == EXIT_ERROR || AK_btree_build(&index, in_memory || num_rows == 0 ? NULL : sorted, pending,
+                                                 in_memory ? num_rows : 0) == EXIT_ERROR) {
+        printf("AK_btree_create: Index %s could not be built!\n", indexName);
+        result = EXIT_ERROR;
+    }
+    AK_btree_close(&index);
+    pthread_rwlock_unlock(&AK_btree_lock);
+
+    if (num_rows > 0 && !in_memory)
+        AK_delete_segment(sorted, SEGMENT_TYPE_TABLE);
+    if (pending != NULL) {
+        AK_free(pending);
+        AK_free(buffer);
+    }
+    AK_free(header);
+    AK_index_catalog_changed();
+    AK_EPI;
+    return result;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that deletes a B+tree index
+ * @param indexName name of the index
+ * @return EXIT_SUCCESS if the index was deleted, EXIT_ERROR if there is no such index
+ */
+int AK_btree_delete(char *indexName) {
+    AK_btree_index index;
+    int result = EXIT_ERROR;
+    AK_PRO;
+
+    pthread_rwlock_wrlock(&AK_btree_lock);
+    if (AK_btree_open(indexName, &index) == EXIT_SUCCESS) {
+        AK_btree_close(&index);
+        AK_btree_forget(indexName);
+        pthread_mutex_lock(&AK_btree_cache_mutex);
+        result = AK_delete_segment(indexName, SEGMENT_TYPE_TABLE);
+        pthread_mutex_unlock(&AK_btree_cache_mutex);
+    }
+    pthread_rwlock_unlock(&AK_btree_lock);
+    AK_index_catalog_changed();
+    AK_EPI;
+    return result;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that reads the description of a B+tree index
+ * @param indexName name of the index
+ * @param meta description of the index
+ * @return EXIT_SUCCESS if the index exists, EXIT_ERROR otherwise
+ */
+int AK_btree_get_meta(char *indexName, AK_btree_meta *meta) {
+    AK_btree_index index;
+    int result;
+    AK_PRO;
+
+    pthread_rwlock_rdlock(&AK_btree_lock);
+    result = AK_btree_open(indexName, &index);
+    if (result == EXIT_SUCCESS) {
+        memcpy(meta, &index.meta, sizeof (AK_btree_meta));
+        AK_btree_close(&index);
+    }
+    pthread_rwlock_unlock(&AK_btree_lock);
     AK_EPI;
+    return result;
 }
 
 /**
-  * @author Anđelko Spevec
-  * @brief Function that searches or deletes a value in btree index
-  * @param indexName - name of the index
-  * @param searchValue - value that we are searching in the index
-  * @param endRange - if 0 search is for 0 value, else searching in range
-  * @param toDo - if 0 we just search else we delete the element if we find it
- */
-int AK_btree_search_delete(char *indexName,int *searchValue,int *endRange,int *toDo, AK_block * inputBlock){
-	int contin = 1;
-        AK_PRO;
-	if((searchValue == endRange) || (endRange <= 0)){
-		endRange = 0;
-		contin = 0;
-	}
-	if(searchValue > endRange){
-		int help = *searchValue;
-		searchValue = endRange;
-		endRange = &help;
-	}
-	
-	//finding correct block 
-	int adr_to_read = (int) AK_find_AK_free_space(AK_get_index_addresses(indexName));
-	//AK_block *block = (AK_block*) AK_read_block(adr_to_read);     functions AK_find_AK_free_space, AK_get_index_addresses and AK_read_block should be checked for mistakes
-	AK_block *block = inputBlock;
-	root_info *root = (root_info*) AK_malloc(sizeof (root_info));
-	memset(root, 0, sizeof (root_info));
-	memcpy(root,block->data,sizeof (root_info));
-	btree_node *temp = (btree_node*) AK_malloc(sizeof(btree_node));
-	
-	//navigating through the tree
-	int address= block->tuple_dict[root->root].address;
-	int type = block->tuple_dict[root->root].type; //node == 1, leaf == 0
-	while(type == 1){
-		memset(temp,0,sizeof(btree_node));
-		memcpy(temp,&block->data[address],sizeof(btree_node));
-		int b,goTo = B,done=0;
-		for(b=0;b<B;b++){
-			if((*searchValue<(temp->values[b])) && (done == 0)){
-				goTo=b;
-				done = 1;
-			}
-		
-		}
-		address = block->tuple_dict[temp->pointers[goTo].indexTd].address;
-		type = block->tuple_dict[temp->pointers[goTo].indexTd].type;
-	}
-	memset(temp,0,sizeof(btree_node));
-	memcpy(temp,&block->data[address],sizeof(btree_node));
-	int f,found = 0,idNext;
-	
-	//searching for value
-	for(f=0;f<B;f++){
-		if(*searchValue == (temp->values[f])){
-			found = 1;
-		}
-		if((found == 1) && (temp->values[f] <= *endRange) && (*endRange > 0)) {
-			//printing data after finding node
-			printf("\n Value %i found! Block %u - IDX_TBL = %u", temp->values[f], temp->pointers[f].addBlock, temp->pointers[f].indexTd);
-				
-			//deleting node
-			if(*toDo == 1){
-				btree_delete(temp,block,address,f);
-				AK_write_block(block);
-			}
-		}
-		idNext=temp->pointers[B].indexTd;
-	}
-	if(found == 0){
-		printf("\n Value not found!");
-	}
-	while(contin == 1){
-		memset(temp,0,sizeof(btree_node));
-		memcpy(temp,&block->data[block->tuple_dict[idNext].address],sizeof(btree_node));
-		
-		//searching for value
-		for(f=0;f<B;f++){
-			if((temp->values[f]) <= *endRange){
-				//printing data after finding node
-				printf("\n Value %i found! Block %u - IDX_TBL = %u", temp->values[f], temp->pointers[f].addBlock, temp->pointers[f].indexTd);
-				
-				//deleting node
-				if(*toDo == 1){
-					btree_delete(temp,block,idNext,f);
-				}
-			}else
-				contin = 0;
-		idNext=temp->pointers[B].indexTd;
-		AK_write_block(block);
-		}
-	}
-	AK_EPI;
-	return EXIT_SUCCESS;
-}
-
-
-/**
-  * @author Anđelko Spevec
-  * @brief Function that deletes a value in btree index
-  * @param temp - node for deletion
-  * @param block - block that contains binary tree
-  * @param idNext - index of the node that is to be deleted
- */
-void btree_delete(btree_node * temp, AK_block * block, int idNext, int i){
-	temp->values[i] = -1;
-	temp->pointers[i].addBlock = 0;
-	temp->pointers[i].indexTd = 0;
-	memcpy(&block->data[idNext],temp,sizeof(btree_node));
-	printf("\n Value deleted!");
-}
-
-/**
-  * @author unknown
-  * @brief Function that inserts a value in btree index
-  * @param indexName - name of the index
-  * @param insertValue - value for insert
-  * @param insertTd - index table destination
-  * @param insertBlock - block address
-  * @param inputBlock - block containing btree
-  * @param EXIT_SUCCESS if successful 
- */
-int AK_btree_insert(char *indexName,int *insertValue, int *insertTd, int *insertBlock, AK_block * inputBlock){
-	AK_PRO;
-	//finding correct block           !!!functions AK_find_AK_free_space, AK_get_index_addresses and AK_read_block should be checked for mistakes!!!
-	int adr_to_read = (int) AK_find_AK_free_space(AK_get_index_addresses(indexName));
-	//AK_block *block = (AK_block*) AK_read_block(adr_to_read);    
-	AK_block *block = inputBlock;
-	
-	//assign root node to root_info variable
-	root_info *root = (root_info*) AK_malloc(sizeof (root_info));
-	memset(root, 0, sizeof (root_info));
-	memcpy(root,block->data,sizeof (root_info));
-	
-	//assign values to properties of root node
-	btree_node *temp = (btree_node*) AK_malloc(sizeof(btree_node));
-	int insertPath[ORDER];//id of the selected node, iP[0] root
-	int insertIndexPath[ORDER];//index of a pointer selected in node, iIP[0] is index selected in root
-	int address = block->tuple_dict[root->root].address;
-	insertPath[0] = root->root;
-	int type = block->tuple_dict[root->root].type;
-	int inc=1;
-	
-	//navigating through the tree
-	while(type == 1){
-		memset(temp,0,sizeof(btree_node));
-		memcpy(temp,&block->data[address],sizeof(btree_node));
-		int b,goTo = B,done=0;
-		for(b=0;b<B;b++){
-			if((*insertValue<(temp->values[b])) && (done == 0)){
-				goTo=b;
-				done = 1;
-			}
-		}
-		insertIndexPath[inc-1] = goTo;
-		insertPath[inc] = temp->pointers[goTo].indexTd;
-		address = block->tuple_dict[temp->pointers[goTo].indexTd].address;
-		type = block->tuple_dict[temp->pointers[goTo].indexTd].type;
-		if(type == 1){
-			inc++;
-		}//node == 1, leaf == 0
-	}
-	
-	//assign values to properties of leaf node
-	int j;
-	int destinationAddress = block->tuple_dict[insertPath[inc]].address;
-	memset(temp,0,sizeof(btree_node));
-	memcpy(temp,&block->data[destinationAddress],sizeof(btree_node));
-	int AK_freeSpace = 0;
-	for(j=0;j<B;j++){
-		if(temp->values[j] == -1){
-			AK_freeSpace++;
-		}
-	}
-	int inserted = 0,increase=0;
-	btree_node *temp_help = (btree_node*) AK_malloc(sizeof(btree_node));
-	memset(temp_help,0,sizeof(btree_node));
-	//we have FREE space in LEAF
-	if(AK_freeSpace != 0){ 
-		temp_help = searchValue(inserted, *insertValue, temp, temp_help, *insertTd,*insertBlock,&increase,-1);
-		memset(&block->data[destinationAddress],0,sizeof(btree_node));
-		memcpy(&block->data[destinationAddress],temp_help,sizeof(btree_node));
-		AK_write_block(block);
-		printf("\nNew value is added in leaf with available space");	
-	}
-	//we have to SPLIT the LEAF
-	else{
-		btree_node *temp_help_two = (btree_node*) AK_malloc(sizeof(btree_node));
-		memset(temp_help_two,0,sizeof(btree_node));
-		
-		//assign values to temporary node
-		temp_help = searchValue(inserted, *insertValue, temp, temp_help, *insertTd,*insertBlock,&increase,findCorrectNumber(1));
-		temp_help->pointers[B].indexTd = block->last_tuple_dict_id + 1; //points to new leaf
-		temp_help->pointers[B].addBlock = adr_to_read; //update when fix multiple blocks
-		memset(&block->data[destinationAddress],0,sizeof(btree_node));
-		memcpy(&block->data[destinationAddress],temp_help,sizeof(btree_node)); 
-		
-		//assign values to temporary node
-		temp_help_two = searchValue(inserted, *insertValue, temp, temp_help_two, *insertTd,*insertBlock,&increase,findCorrectNumber(2));
-		temp_help_two->pointers[B].indexTd = temp->pointers[B].indexTd; //points to next leaf
-		temp_help_two->pointers[B].addBlock = temp->pointers[B].addBlock;
-		memcpy(&block->data[block->AK_free_space], temp_help_two, sizeof(btree_node));
-		 
-		//assign values to block
-		int id = block->last_tuple_dict_id + 1;
-		block->tuple_dict[id].address = block->AK_free_space;
-		block->tuple_dict[id].type = LEAF;
-		block->AK_free_space += sizeof(btree_node);
-		block->last_tuple_dict_id = id;
-		
-		//update root_info->level[0] number of leafs
-		root->level[0]++;
-		memcpy(&block->data[0],root,sizeof(root_info));
-		AK_write_block(block);
-		
-		//checking nodes above 
-		int pathIndex = inc - 1;
-		int nodeAddress = block->tuple_dict[insertPath[pathIndex]].address;
-		int pointerIndex = insertIndexPath[pathIndex];
-		memset(temp,0,sizeof(btree_node));
-		memcpy(temp,&block->data[nodeAddress],sizeof(btree_node));
-
-		memset(temp_help,0,sizeof(btree_node));
-		int AK_freePointer = 0;
-		for(j=0;j<B;j++){
-			if(temp->values[j] == -1)
-				AK_freePointer = 1;
-		}
-		
-		int startSecond = 0, copyNode = 1,skip = 1;
-		if(AK_freePointer == 1){//in node above we have FREE POINTER to insert NEW LEAF
-			//adding value
-			temp_help = setNodePointers(temp_help,temp,pointerIndex,temp_help_two->values[0],insertPath[inc],id);
-			memset(&block->data[nodeAddress],0,sizeof(btree_node));
-			memcpy(&block->data[nodeAddress],temp_help,sizeof(btree_node)); 
-			AK_write_block(block);
-			printf("\nNew value is added in new leaf. Node above had available space.");
-		}else{//spliting nodes
-			int nodeIncrease,nodeInserted,helpAddress,helpType,nodeAboveAddress;
-			int again = 1,newRoot=0,updateIdx = 1;
-			
-			btree_node *temp_node_one = (btree_node*) AK_malloc(sizeof(btree_node));
-			btree_node *temp_node_two = (btree_node*) AK_malloc(sizeof(btree_node));
-			btree_node *value_help = (btree_node*) AK_malloc(sizeof(btree_node));
-			
-			while(again == 1){
-				memset(temp_node_one,0,sizeof(btree_node));
-				memset(temp_node_two,0,sizeof(btree_node));
-				memset(value_help,0,sizeof(btree_node));
-
-				nodeIncrease = 0;
-				nodeInserted = 0;
-				helpType=NODE;
-				
-				//pointers for first node
-				temp_node_one = findPointers(temp_node_one, temp, id, &nodeInserted, &nodeIncrease, 3, pointerIndex);
-				
-				//values for first node
-				temp_node_one = findValues(temp_node_one, block, &helpAddress, &helpType, value_help);
-				
-				//pointers for second node
-				temp_node_two = findPointers(temp_node_two, temp, id, &nodeInserted, &nodeIncrease, 4, pointerIndex);
-				
-				//values for second node
-				temp_node_two = findValues(temp_node_two, block, &helpAddress, &helpType, value_help);
-				
-				//updating block with btree
-				memset(&block->data[block->tuple_dict[insertPath[pathIndex]].address],0,sizeof(btree_node));
-				memcpy(&block->data[block->tuple_dict[insertPath[pathIndex]].address],temp_node_one,sizeof(btree_node)); 
-				memcpy(&block->data[block->AK_free_space],temp_node_two,sizeof(btree_node)); 
-				id = block->last_tuple_dict_id + 1;
-				block->tuple_dict[id].address = block->AK_free_space;
-				block->tuple_dict[id].type = NODE;
-				block->AK_free_space += sizeof(btree_node);
-				block->last_tuple_dict_id = id;
-				root->level[updateIdx]++;
-				memcpy(&block->data[0],root,sizeof(root_info));
-				updateIdx++;
-				AK_write_block(block);
-
-				if(newRoot == 1){
-					again = 0;
-					memset(temp,0,sizeof(btree_node));
-					temp->pointers[0].indexTd = insertPath[pathIndex];
-					temp->pointers[1].indexTd = id;
-					helpAddress = block->tuple_dict[id].address;
-					helpType = block->tuple_dict[id].type;
-					memset(value_help,0,sizeof(btree_node));
-					memcpy(value_help,&block->data[helpAddress],sizeof(btree_node));			
-					while(helpType == NODE){
-						helpAddress = block->tuple_dict[value_help->pointers[0].indexTd].address;
-						helpType = block->tuple_dict[value_help->pointers[0].indexTd].type;
-						memset(value_help,0,sizeof(btree_node));
-						memcpy(value_help,&block->data[helpAddress],sizeof(btree_node));
-					}
-					temp->values[0] = value_help->values[0];
-					printf("\nNew value is added and tree is updated! New root added, so order of the tree increased!");
-					//updating block with btree
-					memcpy(&block->data[block->AK_free_space],temp,sizeof(btree_node)); 
-					id = block->last_tuple_dict_id + 1;
-					block->tuple_dict[id].address = block->AK_free_space;
-					block->tuple_dict[id].type = NODE;
-					block->AK_free_space += sizeof(btree_node);
-					block->last_tuple_dict_id = id;
-					root->level[updateIdx] = 1;
-					root->root = id;
-					memcpy(&block->data[0],root,sizeof(root_info));
-					AK_write_block(block);	
-				}else{
-					//get above node !
-					if(pathIndex != 0)
-						pathIndex = pathIndex - 1; //0, insertPath[0] = 13 (root)
-					nodeAboveAddress = block->tuple_dict[insertPath[pathIndex]].address;
-					memset(temp,0,sizeof(btree_node));
-					memcpy(temp,&block->data[nodeAboveAddress],sizeof(btree_node));
-					
-					for(j=0;j<B;j++){
-						if(temp->values[j] == -1)
-							AK_freePointer = 1;
-					}
-					if(AK_freePointer == 1){
-						again = 0;
-						increase = 0;
-						memset(temp_help,0,sizeof(btree_node));
-						for(j=0;j<=B;j++){
-							if(j == (insertIndexPath[pathIndex]+1)){
-								temp_help->pointers[j].indexTd = id;
-							}else{
-								temp_help->pointers[j].indexTd = temp->pointers[increase].indexTd;
-								increase++;
-							}	
-						}
-						//updating block with btree
-						temp_help = findValues(temp_help, block, &helpAddress, &helpType, value_help);
-						memcpy(&block->data[block->AK_free_space],temp,sizeof(btree_node)); 
-						id = block->last_tuple_dict_id + 1;
-						block->tuple_dict[id].address = block->AK_free_space;
-						block->tuple_dict[id].type = NODE;
-						block->AK_free_space += sizeof(btree_node);
-						block->last_tuple_dict_id = id;
-						AK_write_block(block);	
-					}else{//if root is full->new root...
-						if(root->root == insertPath[pathIndex])
-							newRoot = 1;
-						else
-							again = 1;
-					}
-				}
-			}
-			if(newRoot != 1)
-				printf("\nNew value is added and tree is updated!");
-		}
-	}
-	AK_EPI;
-	return EXIT_SUCCESS;
-}
-
-
-/**
-  * @author unknown
-  * @brief Function that sets values for node
-  * @param temp_help - node that has it's values set
-  * @param insertValue - value for insert
-  * @param insertTd - index table destination
-  * @param insertBlock - block address
-  * @param i - determins the index of element of node
-  * @return  node that has it's values set 
- */
-btree_node * makevalues(btree_node * temp_help, int insertValue, int insertTd, int insertBlock, int i){
-	temp_help->values[i] = insertValue;
-	temp_help->pointers[i].indexTd = insertTd;
-	temp_help->pointers[i].addBlock = insertBlock;
-	return temp_help;
-}
-
-/**
-  * @author unknown
-  * @brief returns data about a leaf
-  * @return required value
- */
-int findCorrectNumber(int number){
-	int amount = B % 2;
-	if(amount == 0){//uneven number of pointers (B+1)%2 = 1
-		//we need to insert B+1 elements in two leafs -> 4+1=3+2
-		if(number == 1)
-			return (B/2) + 1; //B=4,(4/2)+1=3 elements in first leaf
-		if(number == 2)
-			return B/2; //B=4,(4/2)=2 elements in second leaf
-		if(number == 3)
-			return (B + 2)/2;  //B=4, (B+1+1)/2 = 3 pointers in first LEAF
-		if(number == 4)
-			return (B + 2)/2; //B=4, (B+1+1)/2 = 3 pointers in second LEAF
-	}else{//even number of pointers (B+1)%2 = 0
-		//we need to insert B+1 elements in two leafs -> 3+1=2+2
-		if(number == 1)
-			return (B + 1)/2; //B=3,(3+1)/2=2 elements in first leaf
-		if(number == 2)
-			return (B + 1)/2; //B=3,(3+1)/2=2 elements in second leaf 
-		if(number == 3)
-			return ((B + 1)/2) + 1; //B=3, ((3+1)/2)+1= 3 pointers in first leaf
-		if(number == 4)
-			return (B + 1)/2; //B=3 (3+1)/2=2 pointers in second leaf			
-	}
-}
-
-/**
-  * @author unknown
-  * @brief Function that sets values for node
-  * @param inserted - determins if a value in a tree smaller then the value for insert has been found
-  * @param insertValue - value for insert
-  * @param temp - node with data about existing node
-  * @param temp_help - node that has it's values set
-  * @param insertTd - index table destination
-  * @param insertBlock - block address
-  * @param increase - determins the index of element of a node
-  * @param number - gives information about the number of elements in a leaf
-  * @return  node that has it's values set 
- */
-btree_node * searchValue(int inserted, int insertValue, btree_node * temp, btree_node * temp_help, int *insertTd, int *insertBlock,int* increase, int number){
-	int stop = 0;
-	for(int j=0;j<B;j++){
-		if(stop == 0){
-			if(inserted == 0){
-				if(insertValue < temp->values[*increase]){
-					temp_help = makevalues(temp_help,insertValue,*insertTd,*insertBlock,j);
-					inserted = 1;
-				}else{
-					temp_help = makevalues(temp_help,temp->values[*increase],temp->pointers[*increase].indexTd,temp->pointers[*increase].addBlock,j);
-					*increase++;
-				}
-			}else{
-				if(temp->values[*increase] == -1 && number == -1){
-					temp_help = makevalues(temp_help,insertValue,*insertTd,*insertBlock,j);
-					inserted = 1;
-				}else{
-					temp_help = makevalues(temp_help,temp->values[*increase],temp->pointers[*increase].indexTd,temp->pointers[*increase].addBlock,j);
-					*increase++;
-				}	
-			}
-			if((j+1) == number)
-				stop = 1;
-		}else{	
-			if(number != -1) 
-				temp_help = makevalues(temp_help,-1,0,0,j);
-			else{
-				temp_help->values[j] = temp->values[*increase];
-				temp_help->pointers[j] = temp->pointers[*increase];
-				*increase++;
-			}
-		}		
-	}
-	return temp_help;
-}
-
-/**
-  * @author unknown
-  * @brief Function that sets values for node
-  * @param temp - node with data about existing node
-  * @param temp_help - node that has it's values set
-  * @param pointerIndex - indicates what pointer is used
-  * @param secondValue - value of a node
-  * @param firstPointer - value to which a pointer of a node is to be set
-  * @param secondPointer - value to which a pointer of a node is to be set
-  * @return  node that has it's values set 
- */
-btree_node * setNodePointers(btree_node * temp, btree_node * temp_help,int pointerIndex,int secondValue,int firstPointer,int secondPointer){
-	int firstValue = temp_help->values[0];
-	int AK_freePointer = 0;
-	for(int j=0;j<B;j++){
-		if(temp->values[j] == -1)
-			AK_freePointer = 1;
-	}
-	int startSecond = 0, copyNode = 1,skip = 1;
-	int increase = 0;
-	temp_help->pointers[0].indexTd = temp->pointers[0].indexTd;
-	if(pointerIndex == 0){
-		startSecond = 1;
-		copyNode = 0;
-		skip = 0;
-	}
-	for(int j=1;j<=B;j++){
-		if((copyNode == 1) && (j != pointerIndex)){
-			temp_help->values[j-1] = temp->values[increase];
-			temp_help->pointers[j].indexTd = temp->pointers[increase+1].indexTd;
-			increase++;
-		}
-		if(startSecond == 1){
-			temp_help->values[j-1] = secondValue;
-			temp_help->pointers[j].indexTd = secondPointer;
-			if(skip == 1){
-				increase++;
-			}
-			startSecond = 0;
-			copyNode = 1;
-		}
-		if(j == pointerIndex){
-			temp_help->values[j-1] = firstValue;
-			temp_help->pointers[j].indexTd = firstPointer;
-			startSecond = 1;
-			copyNode = 0;
-		}
-	}
-	return temp_help;
-}
-
-/**
-  * @author unknown
-  * @brief Function that sets values for node
-  * @param temp_node_one - node that has it's values set
-  * @param temp - node with data about existing node
-  * @param id - value to which a pointer of a node is to be set
-  * @param nodeInserted - determins if a node has value
-  * @param nodeIncrease - shows node that is currently watched
-  * @param number - determins the way node values are checked
-  * @param pointerIndex - indicates what pointer is used
-  * @return  node that has it's values set 
- */
-btree_node * findPointers(btree_node * temp_node_one, btree_node * temp, int id, int* nodeInserted,int* nodeIncrease, int number, int pointerIndex){
-	for(int j=0;j<findCorrectNumber(number);j++){
-		int compare;
-		if(number == 3)
-			compare = j;
-		else
-			compare = *nodeIncrease;
-		if((compare==(pointerIndex+1)) && (*nodeInserted == 0)){
-			temp_node_one->pointers[j].indexTd = id;
-			temp_node_one->pointers[j].addBlock = 0;//update when fixing blocks
-			if(number == 3)
-				*nodeInserted = 1;
-		}
-		else{
-			temp_node_one->pointers[j].indexTd = temp->pointers[*nodeIncrease].indexTd;
-			temp_node_one->pointers[j].addBlock = temp->pointers[*nodeIncrease].addBlock;
-			*nodeIncrease++;
-		}
-	}
-	return temp_node_one;
-}
-
-/**
-  * @author unknown
-  * @brief Function that sets values for node
-  * @param temp_node_one - node that has it's values set
-   * @param block - block containing btree
-  * @param helpAddress - address of current node
-  * @param helpType - type of current node
-  * @param value_help - node in helpAddress
-  * @return  node that has it's values set 
- */
-btree_node * findValues(btree_node * temp_node_one, AK_block * block, int* helpAddress,int* helpType, btree_node *value_help){
-	for(int j=0;j<B;j++){
-		if(temp_node_one->pointers[j+1].indexTd != 0){
-			*helpAddress = block->tuple_dict[temp_node_one->pointers[j+1].indexTd].address;
-			*helpType = block->tuple_dict[temp_node_one->pointers[j+1].indexTd].type;
-			memset(value_help,0,sizeof(btree_node));
-			memcpy(value_help,&block->data[*helpAddress],sizeof(btree_node));			
-			while(*helpType == NODE){
-				*helpAddress = block->tuple_dict[value_help->pointers[0].indexTd].address;
-				*helpType = block->tuple_dict[value_help->pointers[0].indexTd].type;
-				memset(value_help,0,sizeof(btree_node));
-				memcpy(value_help,&block->data[*helpAddress],sizeof(btree_node));
-			}
-			temp_node_one->values[j] = value_help->values[0];
-		}
-	}
-	return temp_node_one;
-}
-
-/**
- * @author unknown
- * @brief Returns the amount of successful and failed tests.
+ * @author Karlo Vuković
+ * @brief Function that adds an entry to a B+tree index. Pages that get full are split, a split of the root adds a
+ *        level to the tree, and the index segment gets a new extent when it runs out of blocks. Values of included
+ *        attributes are read from the row.
+ * @param indexName name of the index
+ * @param type type of the value, values of another type than the key are not indexed
+ * @param key value
+ * @param size size of the value
+ * @param rid row with the value
+ * @return EXIT_SUCCESS if the entry is in the index, EXIT_ERROR otherwise
+ */
+int AK_btree_insert(char *indexName, int type, char *key, int size, AK_btree_rid *rid) {
+    char included[BTREE_MAX_ENTRY_SIZE];
+    AK_btree_index index;
+    AK_block *row;
+    int included_size = 0, result;
+    AK_PRO;
+
+    pthread_rwlock_wrlock(&AK_btree_lock);
+    result = AK_btree_open(indexName, &index);
+    if (result == EXIT_SUCCESS) {
+        if (index.meta.num_included > 0) {
+            row = AK_btree_read(rid->block);
+            included_size = AK_btree_included(included, &index.meta, row->tuple_dict + rid->tuple, (char *) row->data, -1);
+            AK_free(row);
+        }
+        if (AK_btree_indexed(index.meta.type, type, size))
+            result = AK_btree_insert_entry(&index, key, size, rid, included, included_size);
+        AK_btree_close(&index);
+    }
+    pthread_rwlock_unlock(&AK_btree_lock);
+    AK_EPI;
+    return result;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that removes an entry from a B+tree index. A page that is left less than BTREE_MERGE_PERCENT full
+ *        is merged with its sibling if they fit into one page, and the root is removed when it has a single child.
+ * @param indexName name of the index
+ * @param type type of the value
+ * @param key value
+ * @param size size of the value
+ * @param rid row with the value
+ * @return EXIT_SUCCESS if the entry was removed, EXIT_ERROR if it is not in the index
+ */
+int AK_btree_remove(char *indexName, int type, char *key, int size, AK_btree_rid *rid) {
+    AK_btree_index index;
+    int result;
+    AK_PRO;
+
+    pthread_rwlock_wrlock(&AK_btree_lock);
+    result = AK_btree_open(indexName, &index);
+    if (result == EXIT_SUCCESS) {
+        if (AK_btree_indexed(index.meta.type, type, size))
+            result = AK_btree_remove_entry(&index, key, size, rid);
+        else
+            result = EXIT_ERROR;
+        AK_btree_close(&index);
+    }
+    pthread_rwlock_unlock(&AK_btree_lock);
+    AK_EPI;
+    return result;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that compares the entries of two changes of a B+tree index by key and then by row
+ * @param a first change
+ * @param b second change
+ * @return negative number if the first entry comes first, 0 if the entries are equal, otherwise positive number
+ */
+static int AK_btree_change_entry(const AK_btree_change *a, const AK_btree_change *b) {
+    int result = AK_btree_compare_keys(a->type, a->key, a->size, b->key, b->size);
+
+    if (result != 0)
+        return result;
+    if (a->rid.block != b->rid.block)
+        return a->rid.block < b->rid.block ? -1 : 1;
+    if (a->rid.tuple != b->rid.tuple)
+        return a->rid.tuple < b->rid.tuple ? -1 : 1;
+    return 0;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that orders changes of a B+tree index by their entries, a removal before an insert of the same
+ *        entry
+ * @param left first change
+ * @param right second change
+ * @return negative number if the first change comes first, 0 if they are equal, otherwise positive number
+ */
+static int AK_btree_change_compare(const void *left, const void *right) {
+    const AK_btree_change *a = (const AK_btree_change *) left, *b = (const AK_btree_change *) right;
+    int result = AK_btree_change_entry(a, b);
+
+    return result != 0 ? result : a->insert - b->insert;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that applies changes of rows of the indexed table to a B+tree index. Keys of the changes are
+ *        sorted first, so pages are visited in the order of the index, and a removal and an insert of the same entry,
+ *        made by an update that did not change the key or included values, cancel each other out. Rows with a null
+ *        in an attribute of the key are not indexed.
+ * @param indexName name of the index
+ * @param deltas changes of rows of the table
+ * @param num_deltas number of changes
+ * @return EXIT_SUCCESS, EXIT_ERROR if there is no such index or it could not be extended
+ */
+int AK_btree_apply(char *indexName, AK_index_delta *deltas, int num_deltas) {
+    char included[BTREE_MAX_ENTRY_SIZE], other[BTREE_MAX_ENTRY_SIZE];
+    AK_btree_index index;
+    AK_btree_meta meta;
+    AK_btree_change *changes;
+    char *keys;
+    int i, included_size, num_changes = 0, result = EXIT_SUCCESS;
+    AK_PRO;
+
+    if (AK_btree_get_meta(indexName, &meta) == EXIT_ERROR) {
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    changes = (AK_btree_change *) AK_malloc((num_deltas > 0 ? num_deltas : 1) * sizeof (AK_btree_change));
+    keys = (char *) AK_malloc((num_deltas > 0 ? num_deltas : 1) * MAX_VARCHAR_LENGTH);
+    for (i = 0; i < num_deltas; i++) {
+        changes[num_changes].key = keys + num_changes * MAX_VARCHAR_LENGTH;
+        changes[num_changes].size = AK_btree_row_key(&meta, deltas[i].entries, deltas[i].data, -1,
+                                                     changes[num_changes].key);
+        if (changes[num_changes].size < 0)
+            continue;
+        changes[num_changes].type = meta.type;
+        changes[num_changes].rid.block = deltas[i].add.addBlock;
+        changes[num_changes].rid.tuple = deltas[i].add.indexTd;
+        changes[num_changes].insert = deltas[i].insert;
+        changes[num_changes].delta = &deltas[i];
+        num_changes++;
+    }
+    qsort(changes, num_changes, sizeof (AK_btree_change), AK_btree_change_compare);
+
+    pthread_rwlock_wrlock(&AK_btree_lock);
+    if (AK_btree_open(indexName, &index) == EXIT_SUCCESS) {
+        for (i = 0; i < num_changes && result == EXIT_SUCCESS; i++) {
+            included_size = AK_btree_included(included, &meta, changes[i].delta->entries, changes[i].delta->data, -1);
+            if (i + 1 < num_changes && !changes[i].insert && changes[i + 1].insert &&
+                AK_btree_change_entry(&changes[i], &changes[i + 1]) == 0 &&
+                AK_btree_included(other, &meta, changes[i + 1].delta->entries, changes[i + 1].delta->data, -1) ==
+                included_size && memcmp(included, other, included_size) == 0) {
+                i++;
+                continue;
+            }
+            if (changes[i].insert)
+                result = AK_btree_insert_entry(&index, changes[i].key, changes[i].size, &changes[i].rid, included,
+                                               included_size);
+            else
+                AK_btree_remove_entry(&index, changes[i].key, changes[i].size, &changes[i].rid);
+        }
+        AK_btree_close(&index);
+    } else
+        result = EXIT_ERROR;
+    pthread_rwlock_unlock(&AK_btree_lock);
+    AK_free(changes);
+    AK_free(keys);
+    AK_EPI;
+    return result;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that prepares a cursor on an index, without an upper bound and before the first entry
+ * @param cursor cursor
+ * @param indexName name of the index
+ * @return EXIT_SUCCESS, EXIT_ERROR if there is no such index
+ */
+static int AK_btree_cursor_start(AK_btree_cursor *cursor, char *indexName) {
+    AK_btree_meta meta;
+    int address;
+
+    memset(cursor, 0, sizeof (AK_btree_cursor));
+    pthread_rwlock_rdlock(&AK_btree_lock);
+    address = AK_btree_find(indexName, &meta);
+    pthread_rwlock_unlock(&AK_btree_lock);
+    if (address == 0) {
+        cursor->done = 1;
+        return EXIT_ERROR;
+    }
+    strncpy(cursor->name, indexName, MAX_ATT_NAME - 1);
+    cursor->type = meta.type;
+    cursor->position = meta.position;
+    cursor->num_keys = meta.num_keys;
+    memcpy(cursor->keys, meta.keys, sizeof (meta.keys));
+    cursor->num_included = meta.num_included;
+    memcpy(cursor->included, meta.included, sizeof (meta.included));
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that moves a cursor before the first entry with a key, or after the last one
+ * @param cursor cursor
+ * @param key key, NULL for the first entry of the index
+ * @param size size of the key
+ * @param inclusive 1 to move before the entries with the key, 0 to move after them
+ * @return No return value
+ */
+static void AK_btree_cursor_move(AK_btree_cursor *cursor, char *key, int size, int inclusive) {
+    if (cursor->leaf != NULL)
+        AK_free(cursor->leaf);
+    cursor->leaf = NULL;
+    cursor->pos = 0;
+    cursor->key_size = 0;
+    cursor->done = cursor->name[0] == '\0';
+    if (key != NULL) {
+        //a key of another type can not be in the index
+        if (!AK_btree_indexed(cursor->type, cursor->type, size))
+            cursor->done = 1;
+        else {
+            memcpy(cursor->key, key, size);
+            cursor->key_size = size;
+        }
+    }
+    //entries come after the place of the cursor, so it is put before or after all rows with the key
+    cursor->rid.block = inclusive ? -1 : INT_MAX;
+    cursor->rid.tuple = inclusive ? -1 : INT_MAX;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that sets the upper bound of a cursor
+ * @param cursor cursor
+ * @param high upper bound, NULL if entries go to the last one
+ * @param high_size size of the upper bound
+ * @param high_inclusive 1 if entries equal to the upper bound are returned
+ * @return No return value
+ */
+static void AK_btree_cursor_limit(AK_btree_cursor *cursor, char *high, int high_size, int high_inclusive) {
+    cursor->high_size = 0;
+    cursor->high_inclusive = high_inclusive;
+    if (high != NULL) {
+        if (!AK_btree_indexed(cursor->type, cursor->type, high_size))
+            cursor->done = 1;
+        else {
+            memcpy(cursor->high, high, high_size);
+            cursor->high_size = high_size;
+        }
+    }
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that opens a cursor on a B+tree index. The cursor starts from the first entry and has no upper
+ *        bound.
+ * @param cursor cursor
+ * @param indexName name of the index
+ * @return EXIT_SUCCESS, EXIT_ERROR if there is no such index
+ */
+int AK_btree_cursor_open(AK_btree_cursor *cursor, char *indexName) {
+    int result;
+    AK_PRO;
+    result = AK_btree_cursor_start(cursor, indexName);
+    AK_EPI;
+    return result;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that moves a cursor to the first entry with a key larger than or equal to the given one, or only
+ *        larger if the key is excluded. The upper bound stays as it is.
+ * @param cursor open cursor
+ * @param key key, NULL for the first entry of the index
+ * @param size size of the key
+ * @param inclusive 1 if entries with the key are returned, 0 if they are skipped
+ * @return No return value
+ */
+void AK_btree_cursor_seek(AK_btree_cursor *cursor, char *key, int size, int inclusive) {
+    AK_PRO;
+    AK_btree_cursor_move(cursor, key, size, inclusive);
+    AK_EPI;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that limits a cursor to the entries between two keys and moves it to the first of them
+ * @param cursor open cursor
+ * @param low lower bound, NULL if entries start from the first one
+ * @param low_size size of the lower bound
+ * @param low_inclusive 1 if entries equal to the lower bound are returned
+ * @param high upper bound, NULL if entries go to the last one
+ * @param high_size size of the upper bound
+ * @param high_inclusive 1 if entries equal to the upper bound are returned
+ * @return No return value
+ */
+void AK_btree_cursor_range(AK_btree_cursor *cursor, char *low, int low_size, int low_inclusive, char *high,
+                           int high_size, int high_inclusive) {
+    AK_PRO;
+    AK_btree_cursor_move(cursor, low, low_size, low_inclusive);
+    AK_btree_cursor_limit(cursor, high, high_size, high_inclusive);
+    AK_EPI;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that finds the leaf with the next entry of a cursor, the first entry after the place of the
+ *        cursor. The tree is searched from the root, because the leaf that was read before can be changed.
+ * @param cursor open cursor
+ * @return No return value
+ */
+static void AK_btree_cursor_find(AK_btree_cursor *cursor) {
+    int path[BTREE_MAX_HEIGHT], slots[BTREE_MAX_HEIGHT];
+    AK_btree_index index;
+    AK_block *block;
+    int depth, next;
+
+    pthread_rwlock_rdlock(&AK_btree_lock);
+    if (AK_btree_open(cursor->name, &index) == EXIT_ERROR) {
+        pthread_rwlock_unlock(&AK_btree_lock);
+        cursor->done = 1;
+        return;
+    }
+    if (cursor->key_size == 0) {
+        block = AK_btree_read(index.meta.root);
+        while (AK_btree_page_of(block)->level > 0) {
+            next = AK_btree_child(block, -1);
+            AK_free(block);
+            block = AK_btree_read(next);
+        }
+        cursor->pos = 0;
+    } else {
+        block = AK_btree_descend(&index, cursor->key, cursor->key_size, &cursor->rid, path, slots, &depth);
+        cursor->pos = AK_btree_bound(block, index.meta.type, cursor->key, cursor->key_size, &cursor->rid, 1);
+    }
+    //the next entry can be the first one of the next leaf
+    while (block != NULL && cursor->pos >= AK_btree_page_of(block)->num_entries) {
+        next = AK_btree_page_of(block)->next;
+        AK_free(block);
+        block = next != 0 ? AK_btree_read(next) : NULL;
+        cursor->pos = 0;
+    }
+    AK_btree_close(&index);
+    pthread_rwlock_unlock(&AK_btree_lock);
+    cursor->leaf = block;
+    if (block == NULL)
+        cursor->done = 1;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that returns the next entry of a cursor and leaves its key and row in the cursor
+ * @param cursor open cursor
+ * @param rid row of the entry
+ * @return EXIT_SUCCESS, EXIT_ERROR if there are no more entries up to the upper bound
+ */
+static int AK_btree_cursor_step(AK_btree_cursor *cursor, AK_btree_rid *rid) {
+    char *key;
+    int size, result;
+
+    if (!cursor->done && (cursor->leaf == NULL || cursor->pos >= AK_btree_page_of(cursor->leaf)->num_entries)) {
+        if (cursor->leaf != NULL)
+            AK_free(cursor->leaf);
+        cursor->leaf = NULL;
+        AK_btree_cursor_find(cursor);
+    }
+    if (cursor->done)
+        return EXIT_ERROR;
+
+    key = AK_btree_key(cursor->leaf, cursor->pos);
+    size = AK_btree_key_size(cursor->leaf, cursor->pos);
+    if (cursor->high_size > 0) {
+        result = AK_btree_compare_keys(cursor->type, key, size, cursor->high, cursor->high_size);
+        if (result > 0 || (result == 0 && !cursor->high_inclusive)) {
+            cursor->done = 1;
+            return EXIT_ERROR;
+        }
+    }
+    memcpy(cursor->key, key, size);
+    cursor->key_size = size;
+    memcpy(&cursor->rid, AK_btree_raw(cursor->leaf, cursor->pos), sizeof (AK_btree_rid));
+    memcpy(rid, &cursor->rid, sizeof (AK_btree_rid));
+    cursor->pos++;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that returns the next entry of a cursor. Entries come in the order of the index, by key and then
+ *        by row. The key of the entry is left in the key of the cursor.
+ * @param cursor open cursor
+ * @param rid row of the entry
+ * @return EXIT_SUCCESS, EXIT_ERROR if there are no more entries up to the upper bound
+ */
+int AK_btree_cursor_next(AK_btree_cursor *cursor, AK_btree_rid *rid) {
+    int result;
+    AK_PRO;
+    result = AK_btree_cursor_step(cursor, rid);
+    AK_EPI;
+    return result;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that copies the key and the included values of the entry a cursor returned last into a row, so a
+ *        query that needs only them does not read the table. Entries of the row are numbered like the attributes of
+ *        the table, entries of attributes the index does not hold are left as they are.
+ * @param cursor open cursor, after AK_btree_cursor_next returned an entry
+ * @param entries entries of the row, MAX_ATTRIBUTES of them
+ * @param data buffer for the values, the addresses of the entries point into it
+ * @return number of copied values
+ */
+int AK_btree_cursor_row(AK_btree_cursor *cursor, AK_tuple_dict *entries, char *data) {
+    char *raw, *value;
+    int i, pos, key_size, offset, result = 0;
+    AK_PRO;
+
+    pos = cursor->pos - 1;
+    if (cursor->leaf == NULL || pos < 0 || pos >= AK_btree_page_of(cursor->leaf)->num_entries) {
+        AK_EPI;
+        return 0;
+    }
+    raw = AK_btree_raw(cursor->leaf, pos);
+    key_size = AK_btree_key_size(cursor->leaf, pos);
+    if (cursor->num_keys > 1) {
+        //values of a composite key are stored like included values
+        value = AK_btree_key(cursor->leaf, pos);
+        for (i = 0, offset = 0; i < cursor->num_keys; i++, result++) {
+            memcpy(&entries[cursor->keys[i]].type, value, sizeof (int));
+            memcpy(&entries[cursor->keys[i]].size, value + sizeof (int), sizeof (int));
+            entries[cursor->keys[i]].address = offset;
+            memcpy(data + offset, value + 2 * sizeof (int), entries[cursor->keys[i]].size);
+            offset += entries[cursor->keys[i]].size;
+            value += 2 * sizeof (int) + entries[cursor->keys[i]].size;
+        }
+    } else {
+        memcpy(data, AK_btree_key(cursor->leaf, pos), key_size);
+        entries[cursor->position].type = cursor->type;
+        entries[cursor->position].address = 0;
+        entries[cursor->position].size = key_size;
+        offset = key_size;
+        result++;
+    }
+
+    if (AK_btree_page_of(cursor->leaf)->covering) {
+        value = raw + AK_btree_fixed(0) + key_size;
+        for (i = 0; i < cursor->num_included; i++, result++) {
+            memcpy(&entries[cursor->included[i]].type, value, sizeof (int));
+            memcpy(&entries[cursor->included[i]].size, value + sizeof (int), sizeof (int));
+            entries[cursor->included[i]].address = offset;
+            memcpy(data + offset, value + 2 * sizeof (int), entries[cursor->included[i]].size);
+            offset += entries[cursor->included[i]].size;
+            value += 2 * sizeof (int) + entries[cursor->included[i]].size;
+        }
+    }
+    AK_EPI;
+    return result;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that closes a cursor
+ * @param cursor open cursor
+ * @return No return value
+ */
+void AK_btree_cursor_close(AK_btree_cursor *cursor) {
+    AK_PRO;
+    if (cursor->leaf != NULL)
+        AK_free(cursor->leaf);
+    cursor->leaf = NULL;
+    cursor->done = 1;
+    AK_EPI;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that finds rows with a value in a B+tree index with a cursor. Searches can run in several threads
+ *        at the same time, while inserts and removes wait for them.
+ * @param indexName name of the index
+ * @param type type of the value
+ * @param key value
+ * @param size size of the value
+ * @param rids array for the rows in the order of the index, may be NULL
+ * @param max_rids size of the array
+ * @return number of rows with the value, it can be larger than max_rids, EXIT_ERROR if there is no such index
+ */
+int AK_btree_search(char *indexName, int type, char *key, int size, AK_btree_rid *rids, int max_rids) {
+    AK_btree_cursor cursor;
+    AK_btree_rid rid;
+    int count = 0;
+    AK_PRO;
+
+    if (AK_btree_cursor_start(&cursor, indexName) == EXIT_ERROR) {
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    if (type == cursor.type) {
+        AK_btree_cursor_move(&cursor, key, size, 1);
+        AK_btree_cursor_limit(&cursor, key, size, 1);
+        while (AK_btree_cursor_step(&cursor, &rid) == EXIT_SUCCESS) {
+            if (rids != NULL && count < max_rids)
+                memcpy(&rids[count], &rid, sizeof (AK_btree_rid));
+            count++;
+        }
+    }
+    if (cursor.leaf != NULL)
+        AK_free(cursor.leaf);
+    AK_EPI;
+    return count;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that finds a B+tree index of a table whose key starts with the given attributes, in any order,
+ *        so it finds rows by values of these attributes. Of several such indices the one with the shortest key is
+ *        taken.
+ * @param tblName name of the table
+ * @param positions positions of the attributes in the table
+ * @param num_positions number of attributes
+ * @param indexName buffer of MAX_ATT_NAME characters for the name of the index
+ * @return number of attributes of the key of the index, EXIT_ERROR if the table has no such index
+ */
+int AK_btree_find_index(char *tblName, int *positions, int num_positions, char *indexName) {
+    AK_index_description indexes[INDEX_MAX_PER_TABLE];
+    int i, j, k, num_indexes, best = EXIT_ERROR;
+    AK_PRO;
+
+    if (num_positions < 1) {
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    num_indexes = AK_index_get_descriptions(tblName, indexes, INDEX_MAX_PER_TABLE);
+    for (i = 0; i < num_indexes; i++) {
+        if (indexes[i].kind != BLOCK_TYPE_BTREE || indexes[i].num_attr < num_positions ||
+            (best != EXIT_ERROR && indexes[i].num_attr >= best))
+            continue;
+        for (j = 0, k = 0; j < num_positions && k < num_positions; j++)
+            for (k = 0; k < num_positions && indexes[i].attribute[j] != positions[k]; k++)
+                ;
+        if (k < num_positions) {
+            best = indexes[i].num_attr;
+            strncpy(indexName, indexes[i].name, MAX_ATT_NAME - 1);
+            indexName[MAX_ATT_NAME - 1] = '\0';
+        }
+    }
+    AK_EPI;
+    return best;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that finds the rows of a table with the given values of some attributes in a B+tree index found
+ *        with AK_btree_find_index, without reading the table
+ * @param tblName name of the table
+ * @param positions positions of the attributes in the table
+ * @param values list of num_values values of the attributes in the same order, varchar values may end with '\0',
+ *        they are put in the order of the key of the index for the search
+ * @param num_values number of values
+ * @param rids array for the rows in the order of the index, may be NULL
+ * @param max_rids size of the array
+ * @return number of rows with the values, it can be larger than max_rids, EXIT_ERROR if there is no such index or
+ *         a value is not stored with the type of its attribute
+ */
+int AK_btree_lookup(char *tblName, int *positions, struct list_node *values, int num_values, AK_btree_rid *rids,
+                    int max_rids) {
+    AK_btree_meta meta;
+    struct list_node *value, *ordered;
+    char indexName[MAX_ATT_NAME], key[MAX_VARCHAR_LENGTH];
+    int i, j, size = EXIT_ERROR, result = EXIT_ERROR;
+    AK_PRO;
+
+    if (AK_btree_find_index(tblName, positions, num_values, indexName) == EXIT_ERROR ||
+        AK_btree_get_meta(indexName, &meta) == EXIT_ERROR) {
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    //values are put in the order of the attributes of the key
+    ordered = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    AK_Init_L3(&ordered);
+    for (i = 0; i < num_values; i++) {
+        for (j = 0; j < num_values && positions[j] != meta.keys[i]; j++)
+            ;
+        value = AK_First_L2(values);
+        while (value != NULL && j-- > 0)
+            value = AK_Next_L2(value);
+        if (value == NULL || value->type != meta.key_types[i])
+            break;
+        AK_InsertAtEnd_L3(value->type, value->data, value->size, ordered);
+    }
+    if (i == num_values && meta.num_keys == 1) {
+        //the key of an index on one attribute is the value itself
+        value = AK_First_L2(ordered);
+        size = value->type == TYPE_VARCHAR ? (int) strnlen(value->data, value->size) : value->size;
+        memcpy(key, value->data, size);
+    } else if (i == num_values)
+        size = AK_btree_make_key(ordered, key);
+    if (size != EXIT_ERROR)
+        result = AK_btree_search(indexName, meta.type, key, size, rids, max_rids);
+    AK_DeleteAll_L3(&ordered);
+    AK_free(ordered);
+    AK_EPI;
+    return result;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that checks the structure of a B+tree index for the test. Leaves are followed from the first one,
+ *        entries have to be in order, links between leaves have to match and the number of entries has to agree
+ *        with the description of the index.
+ * @param indexName name of the index
+ * @param meta description of the index
+ * @return number of entries, -1 if the structure is broken
+ */
+static int AK_btree_test_check(char *indexName, AK_btree_meta *meta) {
+    AK_block *block, *last = NULL;
+    int address, prev = 0, count = 0, i, level, broken = 0;
+    AK_btree_rid rid;
+
+    if (AK_btree_get_meta(indexName, meta) == EXIT_ERROR)
+        return -1;
+    block = AK_btree_read(meta->root);
+    for (level = meta->height - 1; level > 0; level--) {
+        if (AK_btree_page_of(block)->level != level)
+            broken = 1;
+        address = AK_btree_page_of(block)->child;
+        AK_free(block);
+        block = AK_btree_read(address);
+    }
+    while (block != NULL && !broken) {
+        if (block->type != BLOCK_TYPE_BTREE || AK_btree_page_of(block)->level != 0 || AK_btree_page_of(block)->prev != prev)
+            broken = 1;
+        for (i = 0; i < AK_btree_page_of(block)->num_entries && !broken; i++) {
+            memcpy(&rid, AK_btree_raw(block, i), sizeof (AK_btree_rid));
+            if (i > 0 && AK_btree_compare(block, i - 1, meta->type, AK_btree_key(block, i), AK_btree_key_size(block, i), &rid) <= 0)
+                broken = 1;
+            if (i == 0 && last != NULL && AK_btree_compare(last, AK_btree_page_of(last)->num_entries - 1, meta->type,
+                                                           AK_btree_key(block, 0), AK_btree_key_size(block, 0), &rid) <= 0)
+                broken = 1;
+        }
+        count += AK_btree_page_of(block)->num_entries;
+        prev = block->address;
+        address = AK_btree_page_of(block)->next;
+        if (last != NULL)
+            AK_free(last);
+        last = AK_btree_page_of(block)->num_entries > 0 ? block : NULL;
+        if (last == NULL)
+            AK_free(block);
+        block = address != 0 ? AK_btree_read(address) : NULL;
+    }
+    if (last != NULL)
+        AK_free(last);
+    if (block != NULL)
+        AK_free(block);
+    if (broken || count != meta->num_entries) {
+        printf("Index %s is broken after %d entries, it should have %d\n", indexName, count, meta->num_entries);
+        return -1;
+    }
+    return count;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that returns the number of pages on the list of free pages of a B+tree index for the test
+ * @param meta description of the index
+ * @return number of free pages
+ */
+static int AK_btree_test_free_pages(AK_btree_meta *meta) {
+    AK_block *block;
+    int address = meta->free_list, count = 0;
+
+    while (address != 0) {
+        block = AK_btree_read(address);
+        address = AK_btree_page_of(block)->next;
+        AK_free(block);
+        count++;
+    }
+    return count;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that reads an int value of an indexed row for the test
+ * @param rid row
+ * @param attribute index of the attribute
+ * @return value
+ */
+static int AK_btree_test_value(AK_btree_rid *rid, int attribute) {
+    AK_block *block = ((AK_mem_block *) AK_get_block(rid->block))->block;
+    int value;
+
+    memcpy(&value, block->data + block->tuple_dict[rid->tuple + attribute].address, sizeof (int));
+    return value;
+}
+
+/**
+ * @author Karlo Vuković
+ * @struct AK_btree_test_reader
+ * @brief Structure with the work of one thread that searches an index in the test
+ */
+typedef struct {
+    /// first row whose name is searched
+    int first;
+    /// number of names
+    int count;
+    /// number of names that were found once
+    int found;
+} AK_btree_test_reader;
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that checks how full the leaves of a bulk built index are
+ * @param meta description of the index
+ * @param entry_size size of the entries of the index
+ * @return number of leaves, except the last one, that are not filled to the target of the build
+ */
+static int AK_btree_test_fill(AK_btree_meta *meta, int entry_size) {
+    AK_block *block;
+    int address, used, target = AK_btree_fill_target(), wrong = 0;
+
+    block = AK_btree_read(meta->root);
+    while (AK_btree_page_of(block)->level > 0) {
+        address = AK_btree_child(block, -1);
+        AK_free(block);
+        block = AK_btree_read(address);
+    }
+    while (AK_btree_page_of(block)->next != 0) {
+        used = AK_btree_used(block);
+        if (used > target || used + entry_size <= target)
+            wrong++;
+        address = AK_btree_page_of(block)->next;
+        AK_free(block);
+        block = AK_btree_read(address);
+    }
+    AK_free(block);
+    return wrong;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that gives a test row its name
+ * @param name buffer for the name
+ * @param i row
+ * @return No return value
+ */
+static void AK_btree_test_name(char *name, int i) {
+    sprintf(name, "name %05d abcdefghijklmnopqrstuvwxyzabcdefghijklmnopqrstuvwxyz", i);
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that searches names of test rows in a thread
+ * @param work AK_btree_test_reader
+ * @return NULL
+ */
+static void *AK_btree_test_read(void *work) {
+    AK_btree_test_reader *reader = (AK_btree_test_reader *) work;
+    char name[MAX_VARCHAR_LENGTH];
+    int i;
+
+    for (i = reader->first; i < reader->first + reader->count; i++) {
+        AK_btree_test_name(name, i);
+        if (AK_btree_search("btree_test_name", TYPE_VARCHAR, name, strlen(name), NULL, 0) == 1)
+            reader->found++;
+    }
+    return NULL;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that checks the name and the group a covering index of the test carries for a row
+ * @param entries entries of the row from AK_btree_cursor_row
+ * @param data values of the row
+ * @return 1 if the values are right, otherwise 0
+ */
+static int AK_btree_test_covered(AK_tuple_dict *entries, char *data) {
+    char name[MAX_VARCHAR_LENGTH];
+    int id, grp;
+
+    memcpy(&id, data + entries[0].address, sizeof (int));
+    memcpy(&grp, data + entries[2].address, sizeof (int));
+    if (id == 3)
+        strcpy(name, "dmlx");
+    else if (id == 8)
+        strcpy(name, "dml8 with a longer name");
+    else
+        snprintf(name, MAX_VARCHAR_LENGTH, "dml%d", id == 1007 ? 7 : id);
+    return entries[1].size == (int) strlen(name) && memcmp(data + entries[1].address, name, entries[1].size) == 0 &&
+           entries[2].size == sizeof (int) && grp == (id == 1007 ? 7 : id) % 5;
+}
+
+/**
+ * @author Anđelko Spevec, updated by Karlo Vuković (disk B+tree with typed keys)
+ * @brief Function for testing B+tree indices
  * @return TestResult
- */ 
+ */
 TestResult AK_btree_test() {
-	int passed_tests=0;
-    	int failed_tests=0;
-    	
-	char *tblName = "student";
-	char *indexName = "student_btree_index";
-	AK_PRO;
-	struct list_node *att_list = (struct list_node *) AK_malloc(sizeof (struct list_node));
-	AK_Init_L3(&att_list);
-	AK_InsertAtEnd_L3(TYPE_ATTRIBS, "mbr\0", 4, att_list);
-
-	AK_block * block = AK_btree_create(tblName, att_list, indexName);
-	if(block == NULL){
-		failed_tests++;
-	}
-	else{
-		passed_tests++;
-	}
-	printf("\n\n---------------------------");
-	printf("\nInserting new value...\n");
-	int iv=39123;
-	int ii=101;
-	int ib=301;
-	int *insertValue = &iv; //insert in leaf with available space
-	//int *insertValue = 35901; //insert in full leaf -> new leaf, full node above - split
-	int *insertTd = &ii;
-	int *insertBlock = &ib;
-	if(AK_btree_insert(indexName,insertValue,insertTd,insertBlock,block) == EXIT_SUCCESS){
-		passed_tests++;
-	}
-	else{
-		failed_tests++;
-	}
-	//use insert function for 39123 and again for 39000 to test spliting leaf with AK_free space above
-	iv=39000;
-	insertValue = &iv; //insert in full leaf -> new leaf, AK_free space in node above
-	if(AK_btree_insert(indexName,insertValue,insertTd,insertBlock,block) == EXIT_SUCCESS){
-		passed_tests++;
-	}
-	else{
-		failed_tests++;
-	}
-	printf("\n\n---------------------------");
-	printf("\nSearching value...\n");
-	int sv=35906;
-	int er=35916;
-	int td=1;
-	int *searchValue = &sv;
-	int *endRange = &er;
-	//int *endRange = 0;
-	int *toDo = &td;//0 search, 1 delete
-	if(AK_btree_search_delete(indexName, searchValue, endRange, toDo, block) == EXIT_SUCCESS){
-		passed_tests++;
-	}
-	else{
-		failed_tests++;
-	}
-	printf("\n");
-	AK_EPI;
-	return TEST_result(passed_tests,failed_tests);
-}
+    char *tblName = "btree_test";
+    char *indexes[4] = {"btree_test_id", "btree_test_name", "btree_test_score", "btree_test_group"};
+    char *atts[4] = {"id", "name", "score", "grp"};
+    char *dml_indexes[2] = {"btree_dml_test_id", "btree_dml_test_name"};
+    char *cover_atts[3] = {"grp", "name", "id"};
+    int num_rows = 4000, num_dml_rows = 50;
+    int passed_tests = 0, failed_tests = 0;
+    int i, id, grp, count, wrong, pages, free_pages, students, mbr, found, low, high;
+    float score;
+    char name[MAX_VARCHAR_LENGTH], data[BTREE_MAX_ENTRY_SIZE];
+    AK_tuple_dict entries[MAX_ATTRIBUTES];
+    struct list_node **rows;
+    struct list_node *att_list, *row, *element;
+    AK_btree_rid rids[8];
+    AK_btree_rid rid, *removed;
+    AK_btree_cursor cursor;
+    AK_btree_meta meta, meta_removed;
+    AK_btree_test_reader readers[4];
+    pthread_t threads[4];
+    AK_PRO;
+
+    printf("\n********** B+TREE INDEX TEST **********\n\n");
+
+    //index on the student table finds every row by its number
+    AK_btree_delete("student_btree_index");
+    att_list = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    AK_Init_L3(&att_list);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "mbr", 4, att_list);
+    wrong = 0;
+    students = 0;
+    if (AK_btree_create("student", att_list, "student_btree_index") == EXIT_SUCCESS &&
+        AK_btree_create("student", att_list, "student_btree_index") == EXIT_ERROR) {
+        while ((row = (struct list_node *) AK_get_row(students, "student")) != NULL) {
+            element = AK_First_L2(row);
+            memcpy(&mbr, element->data, sizeof (int));
+            if (AK_btree_search("student_btree_index", TYPE_INT, (char *) &mbr, sizeof (int), rids, 8) != 1 ||
+                AK_btree_test_value(&rids[0], 0) != mbr)
+                wrong++;
+            AK_DeleteAll_L3(&row);
+            AK_free(row);
+            students++;
+        }
+        //zone maps and the index agree on values the table does not have
+        mbr = 1;
+        if (!AK_zone_map_table_may_match("student", "mbr", mbr, mbr) &&
+            AK_btree_search("student_btree_index", TYPE_INT, (char *) &mbr, sizeof (int), NULL, 0) != 0)
+            wrong++;
+    } else
+        wrong++;
+    AK_DeleteAll_L3(&att_list);
+    AK_free(att_list);
+    if (wrong == 0 && students > 0 && AK_btree_test_check("student_btree_index", &meta) == students) {
+        printf("Index on student.mbr finds all %d students\n", students);
+        passed_tests++;
+    } else {
+        printf("Index on student.mbr does not find %d of %d students\n", wrong, students);
+        failed_tests++;
+    }
+
+    AK_header t_header[5] = {
+        {TYPE_INT, "id", {0}, {{'\0'}}, {{'\0'}}},
+        {TYPE_VARCHAR, "name", {0}, {{'\0'}}, {{'\0'}}},
+        {TYPE_FLOAT, "score", {0}, {{'\0'}}, {{'\0'}}},
+        {TYPE_INT, "grp", {0}, {{'\0'}}, {{'\0'}}},
+        {0, {'\0'}, {0}, {{'\0'}}, {{'\0'}}}};
+
+    for (i = 0; i < 4; i++)
+        AK_btree_delete(indexes[i]);
+    if (AK_num_attr(tblName) > 0)
+        AK_delete_segment(tblName, SEGMENT_TYPE_TABLE);
+    if (AK_initialize_new_segment(tblName, SEGMENT_TYPE_TABLE, t_header) == EXIT_ERROR) {
+        printf("Could not create table %s\n", tblName);
+        AK_EPI;
+        return TEST_result(passed_tests, failed_tests + 1);
+    }
+    rows = (struct list_node **) AK_calloc(num_rows, sizeof (struct list_node *));
+    for (i = 0; i < num_rows; i++) {
+        id = i;
+        score = (i % 10) * 0.5f;
+        grp = i % 7;
+        AK_btree_test_name(name, i);
+        rows[i] = (struct list_node *) AK_malloc(sizeof (struct list_node));
+        AK_Init_L3(&rows[i]);
+        AK_Insert_New_Element(TYPE_INT, &id, tblName, "id", rows[i]);
+        AK_Insert_New_Element(TYPE_VARCHAR, name, tblName, "name", rows[i]);
+        AK_Insert_New_Element(TYPE_FLOAT, &score, tblName, "score", rows[i]);
+        AK_Insert_New_Element(TYPE_INT, &grp, tblName, "grp", rows[i]);
+    }
+    AK_bulk_insert(tblName, rows, num_rows);
+    for (i = 0; i < num_rows; i++) {
+        AK_DeleteAll_L3(&rows[i]);
+        AK_free(rows[i]);
+    }
+    AK_free(rows);
+
+    //int, varchar and float keys, pages hold hundreds of short keys and the long names need three levels
+    wrong = 0;
+    for (i = 0; i < 4; i++) {
+        att_list = (struct list_node *) AK_malloc(sizeof (struct list_node));
+        AK_Init_L3(&att_list);
+        AK_InsertAtEnd_L3(TYPE_ATTRIBS, atts[i], strlen(atts[i]), att_list);
+        if (AK_btree_create(tblName, att_list, indexes[i]) == EXIT_ERROR || AK_btree_test_check(indexes[i], &meta) != num_rows)
+            wrong++;
+        else
+            printf("Index %s has %d entries in %d pages and %d levels\n", indexes[i], meta.num_entries, meta.num_pages - 1,
+                   meta.height);
+        if (i == 0 && meta.height != 2)
+            wrong++;
+        if (i == 1 && meta.height < 3)
+            wrong++;
+        AK_DeleteAll_L3(&att_list);
+        AK_free(att_list);
+    }
+    if (wrong == 0) {
+        printf("Indices are ordered and their leaves are linked\n");
+        passed_tests++;
+    } else {
+        printf("Indices were not built correctly\n");
+        failed_tests++;
+    }
 
+    //a bulk build fills every leaf but the last one up to the fill factor
+    wrong = AK_btree_get_meta(indexes[0], &meta) == EXIT_SUCCESS ?
+            AK_btree_test_fill(&meta, sizeof (AK_btree_rid) + sizeof (int)) : 1;
+    if (wrong == 0) {
+        printf("Leaves of index %s are filled to %d bytes\n", indexes[0], AK_btree_fill_target());
+        passed_tests++;
+    } else {
+        printf("%d leaves of index %s are not filled to %d bytes\n", wrong, indexes[0], AK_btree_fill_target());
+        failed_tests++;
+    }
+
+    //every key is found with the row that has it, equal keys are found across leaves
+    wrong = 0;
+    for (i = 0; i < num_rows; i++) {
+        id = i;
+        if (AK_btree_search(indexes[0], TYPE_INT, (char *) &id, sizeof (int), rids, 8) != 1 ||
+            AK_btree_test_value(&rids[0], 0) != id)
+            wrong++;
+    }
+    AK_btree_test_name(name, 1234);
+    if (AK_btree_search(indexes[1], TYPE_VARCHAR, name, strlen(name), rids, 8) != 1 || AK_btree_test_value(&rids[0], 0) != 1234)
+        wrong++;
+    score = 2.5f;
+    if (AK_btree_search(indexes[2], TYPE_FLOAT, (char *) &score, sizeof (float), NULL, 0) != num_rows / 10)
+        wrong++;
+    grp = 3;
+    count = AK_btree_search(indexes[3], TYPE_INT, (char *) &grp, sizeof (int), rids, 8);
+    if (count != (num_rows - grp + 6) / 7 || AK_btree_test_value(&rids[7], 3) != grp)
+        wrong++;
+    id = num_rows;
+    if (AK_btree_search(indexes[0], TYPE_INT, (char *) &id, sizeof (int), NULL, 0) != 0 ||
+        AK_btree_search(indexes[0], TYPE_VARCHAR, name, strlen(name), NULL, 0) != 0)
+        wrong++;
+    if (wrong == 0) {
+        printf("Searches find the rows with int, varchar and float keys, %d rows share a group\n", count);
+        passed_tests++;
+    } else {
+        printf("Searches failed for %d keys\n", wrong);
+        failed_tests++;
+    }
+
+    //cursors return ranges in the order of the index, across leaves and with a bound excluded
+    wrong = AK_btree_cursor_open(&cursor, indexes[0]) == EXIT_ERROR;
+    low = 100;
+    high = 1200;
+    AK_btree_cursor_range(&cursor, (char *) &low, sizeof (int), 0, (char *) &high, sizeof (int), 1);
+    for (id = low + 1; AK_btree_cursor_next(&cursor, &rid) == EXIT_SUCCESS; id++)
+        if (AK_btree_test_value(&rid, 0) != id || memcmp(cursor.key, &id, sizeof (int)) != 0)
+            wrong++;
+    if (id != high + 1)
+        wrong++;
+    //a seek keeps the upper bound and moves the cursor forward, as a merge join does
+    AK_btree_cursor_range(&cursor, NULL, 0, 1, (char *) &high, sizeof (int), 0);
+    AK_btree_cursor_next(&cursor, &rid);
+    AK_btree_cursor_seek(&cursor, (char *) &low, sizeof (int), 1);
+    for (count = 0; AK_btree_cursor_next(&cursor, &rid) == EXIT_SUCCESS; count++);
+    if (count != high - low)
+        wrong++;
+    AK_btree_cursor_close(&cursor);
+    //equal keys come in the order of their rows
+    grp = 3;
+    AK_btree_cursor_open(&cursor, indexes[3]);
+    AK_btree_cursor_range(&cursor, (char *) &grp, sizeof (int), 1, (char *) &grp, sizeof (int), 1);
+    memset(&rids[0], 0, sizeof (AK_btree_rid));
+    for (count = 0; AK_btree_cursor_next(&cursor, &rid) == EXIT_SUCCESS; count++) {
+        if (rid.block < rids[0].block || (rid.block == rids[0].block && rid.tuple <= rids[0].tuple && count > 0))
+            wrong++;
+        memcpy(&rids[0], &rid, sizeof (AK_btree_rid));
+    }
+    if (count != (num_rows - grp + 6) / 7)
+        wrong++;
+    AK_btree_cursor_close(&cursor);
+    if (wrong == 0) {
+        printf("Cursors return %d ids in a range and %d rows of a group in order\n", high - low, count);
+        passed_tests++;
+    } else {
+        printf("Cursors returned %d wrong entries\n", wrong);
+        failed_tests++;
+    }
+
+    //removing three quarters of the entries merges pages
+    AK_btree_get_meta(indexes[0], &meta);
+    removed = (AK_btree_rid *) AK_calloc(num_rows, sizeof (AK_btree_rid));
+    wrong = 0;
+    for (i = 0; i < num_rows; i++) {
+        if (i % 4 == 0)
+            continue;
+        id = i;
+        if (AK_btree_search(indexes[0], TYPE_INT, (char *) &id, sizeof (int), &removed[i], 1) != 1 ||
+            AK_btree_remove(indexes[0], TYPE_INT, (char *) &id, sizeof (int), &removed[i]) == EXIT_ERROR)
+            wrong++;
+    }
+    id = 1;
+    if (AK_btree_remove(indexes[0], TYPE_INT, (char *) &id, sizeof (int), &removed[1]) != EXIT_ERROR)
+        wrong++;
+    for (i = 0; i < num_rows && wrong == 0; i++) {
+        id = i;
+        if (AK_btree_search(indexes[0], TYPE_INT, (char *) &id, sizeof (int), NULL, 0) != (i % 4 == 0))
+            wrong++;
+    }
+    free_pages = AK_btree_test_check(indexes[0], &meta_removed) == num_rows / 4 ? AK_btree_test_free_pages(&meta_removed) : 0;
+    if (wrong == 0 && free_pages > 0 && meta_removed.num_pages == meta.num_pages) {
+        printf("Removes left %d entries and %d free pages\n", meta_removed.num_entries, free_pages);
+        passed_tests++;
+    } else {
+        printf("Removes failed for %d keys, %d pages were freed\n", wrong, free_pages);
+        failed_tests++;
+    }
+
+    //entries that are added again use the free pages
+    wrong = 0;
+    for (i = 0; i < num_rows; i++) {
+        if (i % 4 == 0)
+            continue;
+        id = i;
+        if (AK_btree_insert(indexes[0], TYPE_INT, (char *) &id, sizeof (int), &removed[i]) == EXIT_ERROR)
+            wrong++;
+    }
+    AK_free(removed);
+    pages = AK_btree_test_check(indexes[0], &meta);
+    if (wrong == 0 && pages == num_rows && AK_btree_test_free_pages(&meta) < free_pages) {
+        printf("Inserts used %d free pages\n", free_pages - AK_btree_test_free_pages(&meta));
+        passed_tests++;
+    } else {
+        printf("Inserts after removes failed\n");
+        failed_tests++;
+    }
+
+    //removing every entry leaves an empty leaf as the root
+    wrong = 0;
+    for (i = 0; i < num_rows; i++) {
+        id = i;
+        if (AK_btree_search(indexes[0], TYPE_INT, (char *) &id, sizeof (int), rids, 8) != 1 ||
+            AK_btree_remove(indexes[0], TYPE_INT, (char *) &id, sizeof (int), &rids[0]) == EXIT_ERROR)
+            wrong++;
+    }
+    if (wrong == 0 && AK_btree_test_check(indexes[0], &meta) == 0 && meta.height == 1) {
+        printf("Index is empty and has one level\n");
+        passed_tests++;
+    } else {
+        printf("Removing all entries failed for %d keys\n", wrong);
+        failed_tests++;
+    }
+
+    //several threads search the same index at the same time
+    for (i = 0; i < 4; i++) {
+        readers[i].first = i * num_rows / 4;
+        readers[i].count = num_rows / 4;
+        readers[i].found = 0;
+        pthread_create(&threads[i], NULL, AK_btree_test_read, &readers[i]);
+    }
+    found = 0;
+    for (i = 0; i < 4; i++) {
+        pthread_join(threads[i], NULL);
+        found += readers[i].found;
+    }
+    if (found == num_rows) {
+        printf("Four threads found all %d names\n", found);
+        passed_tests++;
+    } else {
+        printf("Threads found %d of %d names\n", found, num_rows);
+        failed_tests++;
+    }
+
+    //inserts, updates, deletes and the vacuum keep indices of a table up to date
+    AK_header d_header[4] = {
+        {TYPE_INT, "id", {0}, {{'\0'}}, {{'\0'}}},
+        {TYPE_VARCHAR, "name", {0}, {{'\0'}}, {{'\0'}}},
+        {TYPE_INT, "grp", {0}, {{'\0'}}, {{'\0'}}},
+        {0, {'\0'}, {0}, {{'\0'}}, {{'\0'}}}};
+    for (i = 0; i < 2; i++)
+        AK_btree_delete(dml_indexes[i]);
+    if (AK_num_attr("btree_dml_test") > 0)
+        AK_delete_segment("btree_dml_test", SEGMENT_TYPE_TABLE);
+    wrong = AK_initialize_new_segment("btree_dml_test", SEGMENT_TYPE_TABLE, d_header) == EXIT_ERROR;
+    for (i = 0; i < 2 && wrong == 0; i++) {
+        att_list = (struct list_node *) AK_malloc(sizeof (struct list_node));
+        AK_Init_L3(&att_list);
+        AK_InsertAtEnd_L3(TYPE_ATTRIBS, atts[i], strlen(atts[i]), att_list);
+        wrong += AK_btree_create("btree_dml_test", att_list, dml_indexes[i]) == EXIT_ERROR;
+        AK_DeleteAll_L3(&att_list);
+        AK_free(att_list);
+    }
+    row = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    AK_Init_L3(&row);
+    for (i = 0; i < num_dml_rows && wrong == 0; i++) {
+        id = i;
+        grp = i % 5;
+        snprintf(name, MAX_VARCHAR_LENGTH, "dml%d", i);
+        AK_DeleteAll_L3(&row);
+        AK_Insert_New_Element(TYPE_INT, &id, "btree_dml_test", "id", row);
+        AK_Insert_New_Element(TYPE_VARCHAR, name, "btree_dml_test", "name", row);
+        AK_Insert_New_Element(TYPE_INT, &grp, "btree_dml_test", "grp", row);
+        wrong += AK_insert_row(row) == EXIT_ERROR;
+    }
+    //a new id is written in place, a longer name moves the row to the end of the table
+    AK_DeleteAll_L3(&row);
+    id = 1007;
+    AK_Update_Existing_Element(TYPE_VARCHAR, "dml7", "btree_dml_test", "name", row);
+    AK_Insert_New_Element(TYPE_INT, &id, "btree_dml_test", "id", row);
+    AK_update_row(row);
+    AK_DeleteAll_L3(&row);
+    AK_Update_Existing_Element(TYPE_VARCHAR, "dml8", "btree_dml_test", "name", row);
+    AK_Insert_New_Element(TYPE_VARCHAR, "dml8 with a longer name", "btree_dml_test", "name", row);
+    AK_update_row(row);
+    AK_DeleteAll_L3(&row);
+    AK_Update_Existing_Element(TYPE_VARCHAR, "dml9", "btree_dml_test", "name", row);
+    AK_delete_row(row);
+    AK_DeleteAll_L3(&row);
+    AK_free(row);
+    //rows behind the deleted one are moved back
+    AK_vacuum_table("btree_dml_test");
+    for (i = 0; i < num_dml_rows && wrong == 0; i++) {
+        id = i == 7 ? 1007 : i;
+        count = AK_btree_search(dml_indexes[0], TYPE_INT, (char *) &id, sizeof (int), rids, 8);
+        if (count != (i != 9) || (count == 1 && AK_btree_test_value(&rids[0], 0) != id))
+            wrong++;
+    }
+    id = 7;
+    if (AK_btree_search(dml_indexes[0], TYPE_INT, (char *) &id, sizeof (int), NULL, 0) != 0 ||
+        AK_btree_search(dml_indexes[1], TYPE_VARCHAR, "dml8", 4, NULL, 0) != 0 ||
+        AK_btree_search(dml_indexes[1], TYPE_VARCHAR, "dml9", 4, NULL, 0) != 0 ||
+        AK_btree_search(dml_indexes[1], TYPE_VARCHAR, "dml8 with a longer name", 23, rids, 8) != 1 ||
+        AK_btree_test_value(&rids[0], 0) != 8)
+        wrong++;
+    if (wrong == 0 && AK_btree_test_check(dml_indexes[0], &meta) == num_dml_rows - 1 &&
+        AK_btree_test_check(dml_indexes[1], &meta) == num_dml_rows - 1) {
+        printf("Indices follow %d inserted rows, an update in place, a moved row, a delete and the vacuum\n", num_dml_rows);
+        passed_tests++;
+    } else {
+        printf("Indices do not follow changes of the table, %d rows are wrong\n", wrong);
+        failed_tests++;
+    }
+
+    //a covering index with a key on groups and names carries ids in its leaves and follows changes of them
+    AK_btree_delete("btree_dml_test_cover");
+    att_list = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    AK_Init_L3(&att_list);
+    for (i = 0; i < 3; i++)
+        AK_InsertAtEnd_L3(TYPE_ATTRIBS, cover_atts[i], strlen(cover_atts[i]), att_list);
+    wrong = AK_btree_create_composite("btree_dml_test", att_list, 2, "btree_dml_test_cover") == EXIT_ERROR;
+    AK_DeleteAll_L3(&att_list);
+    AK_free(att_list);
+    row = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    AK_Init_L3(&row);
+    AK_Update_Existing_Element(TYPE_VARCHAR, "dml3", "btree_dml_test", "name", row);
+    AK_Insert_New_Element(TYPE_VARCHAR, "dmlx", "btree_dml_test", "name", row);
+    AK_update_row(row);
+    //inserts split the leaves
+    for (i = 0; i < 4 * num_dml_rows && wrong == 0; i++) {
+        id = num_dml_rows + 10 + i;
+        grp = id % 5;
+        snprintf(name, MAX_VARCHAR_LENGTH, "dml%d", id);
+        AK_DeleteAll_L3(&row);
+        AK_Insert_New_Element(TYPE_INT, &id, "btree_dml_test", "id", row);
+        AK_Insert_New_Element(TYPE_VARCHAR, name, "btree_dml_test", "name", row);
+        AK_Insert_New_Element(TYPE_INT, &grp, "btree_dml_test", "grp", row);
+        wrong += AK_insert_row(row) == EXIT_ERROR;
+    }
+    AK_DeleteAll_L3(&row);
+    AK_free(row);
+    count = 0;
+    if (wrong == 0 && AK_btree_cursor_open(&cursor, "btree_dml_test_cover") == EXIT_SUCCESS) {
+        while (AK_btree_cursor_next(&cursor, &rid) == EXIT_SUCCESS) {
+            if (AK_btree_cursor_row(&cursor, entries, data) != 3 || !AK_btree_test_covered(entries, data))
+                wrong++;
+            count++;
+        }
+        AK_btree_cursor_close(&cursor);
+    }
+    if (wrong == 0 && count == 5 * num_dml_rows - 1 && AK_btree_test_check("btree_dml_test_cover", &meta) == count &&
+        meta.num_keys == 2 && meta.num_included == 1 && meta.height > 1) {
+        printf("Covering index holds groups, names and ids of %d rows after an update and inserts\n", count);
+        passed_tests++;
+    } else {
+        printf("Covering index holds %d rows, %d of them are wrong\n", count, wrong);
+        failed_tests++;
+    }
+
+    //a group and a name find one row, a group alone finds every fifth row
+    att_list = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    AK_Init_L3(&att_list);
+    grp = 3;
+    AK_InsertAtEnd_L3(TYPE_INT, (char *) &grp, sizeof (int), att_list);
+    low = AK_btree_make_key(att_list, name);
+    AK_InsertAtEnd_L3(TYPE_VARCHAR, "dmlx", strlen("dmlx"), att_list);
+    high = AK_btree_make_key(att_list, name + low);
+    AK_DeleteAll_L3(&att_list);
+    AK_InsertAtEnd_L3(TYPE_INT, (char *) &grp, sizeof (int), att_list);
+    AK_InsertAtEnd_L3(TYPE_VARCHAR, "dml3", strlen("dml3"), att_list);
+    wrong = low == EXIT_ERROR || high == EXIT_ERROR ||
+            AK_btree_search("btree_dml_test_cover", BTREE_TYPE_COMPOSITE, name, low, NULL, 0) != num_dml_rows ||
+            AK_btree_make_key(att_list, data) == EXIT_ERROR ||
+            AK_btree_search("btree_dml_test_cover", BTREE_TYPE_COMPOSITE, data, AK_btree_make_key(att_list, data),
+                            NULL, 0) != 0;
+    AK_DeleteAll_L3(&att_list);
+    AK_free(att_list);
+    //the values of the key are read back from the leaf
+    count = 0;
+    if (wrong == 0 && AK_btree_cursor_open(&cursor, "btree_dml_test_cover") == EXIT_SUCCESS) {
+        AK_btree_cursor_range(&cursor, name + low, high, 1, name + low, high, 1);
+        while (AK_btree_cursor_next(&cursor, &rid) == EXIT_SUCCESS) {
+            memset(entries, 0, sizeof (entries));
+            if (AK_btree_cursor_row(&cursor, entries, data) != 3 || entries[1].size != 4 ||
+                memcmp(data + entries[1].address, "dmlx", 4) != 0 || entries[2].type != TYPE_INT ||
+                memcmp(data + entries[2].address, &grp, sizeof (int)) != 0 || AK_btree_test_value(&rid, 0) != 3)
+                wrong++;
+            count++;
+        }
+        AK_btree_cursor_close(&cursor);
+    }
+    if (wrong == 0 && count == 1) {
+        printf("Composite index finds a row by its group and name and %d rows by the group\n", num_dml_rows);
+        passed_tests++;
+    } else {
+        printf("Composite index found %d rows, %d of them are wrong\n", count, wrong);
+        failed_tests++;
+    }
+    AK_btree_delete("btree_dml_test_cover");
+    for (i = 0; i < 2; i++)
+        AK_btree_delete(dml_indexes[i]);
+    AK_delete_segment("btree_dml_test", SEGMENT_TYPE_TABLE);
+
+    //rows of a PAX table are not in the tuple dictionary one after another, so it gets no index and a table with
+    //an index can not get the PAX layout
+    wrong = 0;
+    att_list = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    AK_Init_L3(&att_list);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "id", 3, att_list);
+    if (AK_num_attr("btree_pax_test") > 0)
+        AK_delete_segment("btree_pax_test", SEGMENT_TYPE_TABLE);
+    if (AK_initialize_new_segment("btree_pax_test", SEGMENT_TYPE_TABLE, t_header) == EXIT_ERROR ||
+        AK_btree_create("btree_pax_test", att_list, "btree_pax_test_id") == EXIT_ERROR ||
+        AK_set_storage_layout("btree_pax_test", BLOCK_TYPE_PAX) == EXIT_SUCCESS ||
+        AK_btree_delete("btree_pax_test_id") == EXIT_ERROR ||
+        AK_set_storage_layout("btree_pax_test", BLOCK_TYPE_PAX) == EXIT_ERROR)
+        wrong++;
+    row = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    AK_Init_L3(&row);
+    for (i = 0; i < 20 && wrong == 0; i++) {
+        id = i;
+        score = 1.5f;
+        AK_btree_test_name(name, i);
+        AK_Insert_New_Element(TYPE_INT, &id, "btree_pax_test", "id", row);
+        AK_Insert_New_Element(TYPE_VARCHAR, name, "btree_pax_test", "name", row);
+        AK_Insert_New_Element(TYPE_FLOAT, &score, "btree_pax_test", "score", row);
+        AK_Insert_New_Element(TYPE_INT, &id, "btree_pax_test", "grp", row);
+        if (AK_insert_row(row) == EXIT_ERROR)
+            wrong++;
+        AK_DeleteAll_L3(&row);
+    }
+    AK_free(row);
+    if (wrong == 0 && AK_btree_create("btree_pax_test", att_list, "btree_pax_test_id") == EXIT_ERROR &&
+        AK_btree_get_meta("btree_pax_test_id", &meta) == EXIT_ERROR) {
+        printf("Table with the PAX layout gets no index, and a table with an index keeps its layout\n");
+        passed_tests++;
+    } else {
+        printf("Table with the PAX layout got an index, or a table with an index got the PAX layout\n");
+        failed_tests++;
+    }
+    AK_DeleteAll_L3(&att_list);
+    AK_free(att_list);
+    AK_btree_delete("btree_pax_test_id");
+    AK_delete_segment("btree_pax_test", SEGMENT_TYPE_TABLE);
+
+    //deleted indices are gone
+    wrong = 0;
+    for (i = 0; i < 4; i++) {
+        if (AK_btree_delete(indexes[i]) == EXIT_ERROR || AK_btree_get_meta(indexes[i], &meta) != EXIT_ERROR)
+            wrong++;
+    }
+    if (wrong == 0 && AK_btree_delete(indexes[0]) == EXIT_ERROR) {
+        printf("Indices were deleted\n");
+        passed_tests++;
+    } else {
+        printf("Indices were not deleted\n");
+        failed_tests++;
+    }
+
+    AK_EPI;
+    return TEST_result(passed_tests, failed_tests);
+}
@@ -6,12 +6,12 @@
  * it under the terms of the GNU General Public License as published by
  * the Free Software Foundation; either version 2 of the License, or
  * (at your option) any later version.
- * 
+ *
  * This program is distributed in the hope that it will be useful,
  * but WITHOUT ANY WARRANTY; without even the implied warranty of
  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
  * GNU Library General Public License for more details.
- * 
+ *
  * You should have received a copy of the GNU General Public License
  * along with this program; if not, write to the Free Software
  * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
@@ -20,82 +20,357 @@
 #ifndef BTREE
 #define BTREE
 
-#define B 3
-//order of the tree 6 - it can be lowered to usual 4-5 IF the B is increased!
-#define ORDER 6
-//now we have place for ((B+1)^(0RDER-1))*B = ((3+1)^(6-1))*3 = (4^5)*3 = 1024*3 = 3072 elements
-
-//types for tuple_dict
-#define LEAF 0
-#define NODE 1
-
 #include "../../auxi/test.h"
 #include "index.h"
 #include "../../file/table.h"
 #include "../../auxi/constants.h"
 #include "../../auxi/configuration.h"
+#include "../../auxi/compare.h"
 #include "../../auxi/mempro.h"
+#include <pthread.h>
 
-typedef struct{
-	//B values
-	int values[B];
-	/*
-	B + 1 pointers
-	IF type == 1 -> it points to other B+1 nodes/leafs
-	IF type == 0 -> first B points to addresses in tblName
-	and last pointer points to the next leaf (rangeSearch)
-	*/
-	struct_add pointers[B+1];
-}btree_node;
+/**
+ * @author Karlo Vuković
+ * @struct AK_btree_rid
+ * @brief Structure that tells where a row of the indexed table is
+ */
+typedef struct {
+    /// address of the block with the row
+    int block;
+    /// first entry of the row in the tuple dictionary of the block
+    int tuple;
+} AK_btree_rid;
 
-/*
-root_info->level[index] represents the number of nodes in 
-that level from leafs to root, where root is always 1 (root doesn't
-have to be on index 5 - if order of the tree is 3 it can be on 2 so we
-distinct root lvl by value == 1). This is just theoretical representation
-of the full usage of the array for B=3 and 0=6.
-
-index|	     0 |       1 |       2 |       3 |       4 |       5 |
-value| (B+1)^5 | (B+1)^4 | (B+1)^3 | (B+1)^2 | (B+1)^1 | (B+1)^0 |
-level|   leaf  |         |         |         |         |   root  |
-*/
-typedef struct{
-	//tuple_dic[ID] of the root node in the block
-	int root;
-	//array size of the 0RDER
-	int level[ORDER]; 
-}root_info;
-
-
-/**
-  * @author Anđelko Spevec
-  * @brief Function that creates new btree index on integer attribute in table
-  * @param tblName - name of the table on which we are creating index
-  * @param attributes - attribute on which we are creating index
-  * @param indexName - name of the index
- */
-AK_block * AK_btree_create(char *tblName, struct list_node *attributes, char *indexName);
+/**
+ * @def BTREE_MAX_ENTRY_SIZE
+ * @brief Size of the largest entry of a B+tree page, an entry of an internal page or a leaf entry with the largest
+ * key and included values
+ */
+#define BTREE_MAX_ENTRY_SIZE ((int) (sizeof (AK_btree_rid) + sizeof (int)) + MAX_VARCHAR_LENGTH + \
+                              BTREE_MAX_INCLUDED * (2 * (int) sizeof (int) + MAX_VARCHAR_LENGTH) + (int) sizeof (int))
+
+/**
+ * @author Karlo Vuković
+ * @struct AK_btree_meta
+ * @brief Structure at the start of the first block of a B+tree index. Other blocks of the index segment are pages,
+ *        numbered in the order of the extents, and the first num_pages blocks are in use.
+ */
+typedef struct {
+    /// address of the root page
+    int root;
+    /// number of levels, 1 while the root is a leaf
+    int height;
+    /// type of the key, BTREE_TYPE_COMPOSITE for a key on several attributes
+    int type;
+    /// number of entries in leaves
+    int num_entries;
+    /// number of blocks of the segment in use, together with this one
+    int num_pages;
+    /// first page freed by a merge, free pages are chained through AK_btree_page.next, 0 if there are none
+    int free_list;
+    /// name of the index
+    char name[MAX_ATT_NAME];
+    /// name of the indexed table
+    char table[MAX_ATT_NAME];
+    /// name of the indexed attribute, the first attribute of the key
+    char attribute[MAX_ATT_NAME];
+    /// position of the indexed attribute in the header of the table
+    int position;
+    /// number of included attributes, whose values leaves carry after the key
+    int num_included;
+    /// positions of the included attributes in the header of the table
+    int included[BTREE_MAX_INCLUDED];
+    /// number of attributes of the key
+    int num_keys;
+    /// positions of the attributes of the key in the header of the table
+    int keys[BTREE_MAX_KEYS];
+    /// types of the attributes of the key
+    int key_types[BTREE_MAX_KEYS];
+} AK_btree_meta;
+
+/**
+ * @author Karlo Vuković
+ * @struct AK_btree_page
+ * @brief Structure at the start of the data area of a B+tree page. Entries follow in the tuple dictionary, ordered by
+ *        key and then by row, so equal keys of different rows can be kept. An entry of a leaf holds AK_btree_rid and
+ *        the key. An entry of an internal page holds AK_btree_rid, the address of the child with entries that are
+ *        not smaller than the entry and the key. Leaves of an index with included attributes add the type, size and
+ *        value of each included attribute after the key, followed by the size of all of them.
+ */
+typedef struct {
+    /// level of the page, 0 for leaves
+    int level;
+    /// number of entries in the tuple dictionary
+    int num_entries;
+    /// previous leaf, 0 for the first one
+    int prev;
+    /// next leaf, 0 for the last one
+    int next;
+    /// child with entries smaller than the first entry, only in internal pages
+    int child;
+    /// 1 if entries of the leaf carry values of included attributes
+    int covering;
+} AK_btree_page;
+
+/**
+ * @author Karlo Vuković
+ * @struct AK_btree_cursor
+ * @brief Structure that walks the entries of a B+tree index in the order of the index, up to an upper bound. The
+ *        cursor holds a copy of one leaf and finds its place in the tree again when it moves to the next leaf, so
+ *        the index can be changed between two steps.
+ */
+typedef struct {
+    /// name of the index
+    char name[MAX_ATT_NAME];
+    /// type of the key
+    int type;
+    /// position of the indexed attribute in the header of the table
+    int position;
+    /// number of included attributes
+    int num_included;
+    /// positions of the included attributes in the header of the table
+    int included[BTREE_MAX_INCLUDED];
+    /// number of attributes of the key
+    int num_keys;
+    /// positions of the attributes of the key in the header of the table
+    int keys[BTREE_MAX_KEYS];
+    /// upper bound
+    char high[MAX_VARCHAR_LENGTH];
+    /// size of the upper bound, 0 if there is none
+    int high_size;
+    /// 1 if entries equal to the upper bound are returned
+    int high_inclusive;
+    /// key of the last entry returned, or the key the cursor was moved to
+    char key[MAX_VARCHAR_LENGTH];
+    /// size of the key, 0 if the cursor starts from the first entry
+    int key_size;
+    /// row of the last entry returned, before or after all rows if the cursor was moved to a key
+    AK_btree_rid rid;
+    /// copy of the leaf with the next entry, NULL if it has to be found in the tree
+    AK_block *leaf;
+    /// position of the next entry in the leaf
+    int pos;
+    /// 1 if there are no more entries
+    int done;
+} AK_btree_cursor;
+
+/**
+ * @author Anđelko Spevec, updated by Karlo Vuković (disk B+tree with typed keys, included attributes, builds of
+ *         small tables in memory)
+ * @brief Function that creates a new B+tree index on an attribute of a table. The index is a segment registered in
+ *        AK_relation, its first block holds AK_btree_meta and every other block one page of the tree. Values are
+ *        copied with their rows into a temporary table, sorted with AK_external_sort and packed into pages from
+ *        the bottom up, BTREE_FILL_FACTOR percent full. Values of a table that fits into SORT_MEMORY_BLOCKS blocks
+ *        are sorted in memory instead, without temporary tables. Values stored with another type than the
+ *        attribute, like nulls, are not indexed. Attributes after the first one are included attributes, up to
+ *        BTREE_MAX_INCLUDED of them, their values are kept in the leaves, so queries that need only them and the key
+ *        do not read the table. Tables with the PAX layout can not be indexed.
+ * @param tblName name of the table on which we are creating index
+ * @param attributes attribute on which we are creating index, followed by the included attributes
+ * @param indexName name of the index
+ * @return EXIT_SUCCESS if the index was created, EXIT_ERROR otherwise
+ */
+int AK_btree_create(char *tblName, struct list_node *attributes, char *indexName);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that creates a new B+tree index with a key on several attributes of a table. Keys are ordered by
+ *        the first attribute, then by the second one and so on, and a key made with AK_btree_make_key from values of
+ *        the first attributes finds all entries that start with them. Attributes after the key are included
+ *        attributes, as in AK_btree_create. Rows with a null in an attribute of the key are not indexed, and tables
+ *        with the PAX layout can not be indexed.
+ * @param tblName name of the table on which we are creating index
+ * @param attributes attributes of the key, followed by the included attributes
+ * @param num_keys number of attributes of the key, up to BTREE_MAX_KEYS
+ * @param indexName name of the index
+ * @return EXIT_SUCCESS if the index was created, EXIT_ERROR otherwise
+ */
+int AK_btree_create_composite(char *tblName, struct list_node *attributes, int num_keys, char *indexName);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that makes a key of a B+tree index on several attributes, with type BTREE_TYPE_COMPOSITE. Values
+ *        of fewer attributes than the key has make a prefix, which is equal to every key that starts with it, so a
+ *        search or a cursor with it finds all such entries.
+ * @param values values of the first attributes of the key, in order, varchar values may end with '\0'
+ * @param key buffer for the key, MAX_VARCHAR_LENGTH bytes
+ * @return size of the key, EXIT_ERROR if the values do not fit into a key
+ */
+int AK_btree_make_key(struct list_node *values, char *key);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that deletes a B+tree index
+ * @param indexName name of the index
+ * @return EXIT_SUCCESS if the index was deleted, EXIT_ERROR if there is no such index
+ */
 int AK_btree_delete(char *indexName);
 
-btree_node * makevalues(btree_node * temp_help, int insertValue, int insertTd, int insertBlock, int i);
-btree_node * searchValue(int inserted, int insertValue, btree_node * temp, btree_node * temp_help, int *insertTd, int *insertBlock,int* increase, int number);
-btree_node * setNodePointers(btree_node * temp, btree_node * temp_help,int pointerIndex,int secondValue,int firstPointer,int secondPointer);
-int findCorrectNumber(int number);
-btree_node * findPointers(btree_node * temp_node_one, btree_node * temp, int id, int* nodeInserted,int* nodeIncrease, int number, int pointerIndex);
-btree_node * findValues(btree_node * temp_node_one, AK_block * block, int* helpAddress,int* helpType, btree_node *value_help);
-void btree_delete(btree_node * temp, AK_block * block, int idNext, int i);
+/**
+ * @author Karlo Vuković
+ * @brief Function that reads the description of a B+tree index
+ * @param indexName name of the index
+ * @param meta description of the index
+ * @return EXIT_SUCCESS if the index exists, EXIT_ERROR otherwise
+ */
+int AK_btree_get_meta(char *indexName, AK_btree_meta *meta);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that adds an entry to a B+tree index. Pages that get full are split, a split of the root adds a
+ *        level to the tree, and the index segment gets a new extent when it runs out of blocks. Values of included
+ *        attributes are read from the row.
+ * @param indexName name of the index
+ * @param type type of the value, values of another type than the key are not indexed
+ * @param key value
+ * @param size size of the value
+ * @param rid row with the value
+ * @return EXIT_SUCCESS if the entry is in the index, EXIT_ERROR otherwise
+ */
+int AK_btree_insert(char *indexName, int type, char *key, int size, AK_btree_rid *rid);
 
+/**
+ * @author Karlo Vuković
+ * @brief Function that removes an entry from a B+tree index. A page that is left less than BTREE_MERGE_PERCENT full
+ *        is merged with its sibling if they fit into one page, and the root is removed when it has a single child.
+ * @param indexName name of the index
+ * @param type type of the value
+ * @param key value
+ * @param size size of the value
+ * @param rid row with the value
+ * @return EXIT_SUCCESS if the entry was removed, EXIT_ERROR if it is not in the index
+ */
+int AK_btree_remove(char *indexName, int type, char *key, int size, AK_btree_rid *rid);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that applies changes of rows of the indexed table to a B+tree index. Keys of the changes are
+ *        sorted first, so pages are visited in the order of the index, and a removal and an insert of the same entry,
+ *        made by an update that did not change the key or included values, cancel each other out. Rows with a null
+ *        in an attribute of the key are not indexed.
+ * @param indexName name of the index
+ * @param deltas changes of rows of the table
+ * @param num_deltas number of changes
+ * @return EXIT_SUCCESS, EXIT_ERROR if there is no such index or it could not be extended
+ */
+int AK_btree_apply(char *indexName, AK_index_delta *deltas, int num_deltas);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that finds rows with a value in a B+tree index with a cursor. Searches can run in several threads
+ *        at the same time, while inserts and removes wait for them.
+ * @param indexName name of the index
+ * @param type type of the value
+ * @param key value
+ * @param size size of the value
+ * @param rids array for the rows in the order of the index, may be NULL
+ * @param max_rids size of the array
+ * @return number of rows with the value, it can be larger than max_rids, EXIT_ERROR if there is no such index
+ */
+int AK_btree_search(char *indexName, int type, char *key, int size, AK_btree_rid *rids, int max_rids);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that finds a B+tree index of a table whose key starts with the given attributes, in any order,
+ *        so it finds rows by values of these attributes. Of several such indices the one with the shortest key is
+ *        taken.
+ * @param tblName name of the table
+ * @param positions positions of the attributes in the table
+ * @param num_positions number of attributes
+ * @param indexName buffer of MAX_ATT_NAME characters for the name of the index
+ * @return number of attributes of the key of the index, EXIT_ERROR if the table has no such index
+ */
+int AK_btree_find_index(char *tblName, int *positions, int num_positions, char *indexName);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that finds the rows of a table with the given values of some attributes in a B+tree index found
+ *        with AK_btree_find_index, without reading the table
+ * @param tblName name of the table
+ * @param positions positions of the attributes in the table
+ * @param values list of num_values values of the attributes in the same order, varchar values may end with '\0',
+ *        they are put in the order of the key of the index for the search
+ * @param num_values number of values
+ * @param rids array for the rows in the order of the index, may be NULL
+ * @param max_rids size of the array
+ * @return number of rows with the values, it can be larger than max_rids, EXIT_ERROR if there is no such index or
+ *         a value is not stored with the type of its attribute
+ */
+int AK_btree_lookup(char *tblName, int *positions, struct list_node *values, int num_values, AK_btree_rid *rids,
+                    int max_rids);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that opens a cursor on a B+tree index. The cursor starts from the first entry and has no upper
+ *        bound.
+ * @param cursor cursor
+ * @param indexName name of the index
+ * @return EXIT_SUCCESS, EXIT_ERROR if there is no such index
+ */
+int AK_btree_cursor_open(AK_btree_cursor *cursor, char *indexName);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that moves a cursor to the first entry with a key larger than or equal to the given one, or only
+ *        larger if the key is excluded. The upper bound stays as it is.
+ * @param cursor open cursor
+ * @param key key, NULL for the first entry of the index
+ * @param size size of the key
+ * @param inclusive 1 if entries with the key are returned, 0 if they are skipped
+ * @return No return value
+ */
+void AK_btree_cursor_seek(AK_btree_cursor *cursor, char *key, int size, int inclusive);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that limits a cursor to the entries between two keys and moves it to the first of them
+ * @param cursor open cursor
+ * @param low lower bound, NULL if entries start from the first one
+ * @param low_size size of the lower bound
+ * @param low_inclusive 1 if entries equal to the lower bound are returned
+ * @param high upper bound, NULL if entries go to the last one
+ * @param high_size size of the upper bound
+ * @param high_inclusive 1 if entries equal to the upper bound are returned
+ * @return No return value
+ */
+void AK_btree_cursor_range(AK_btree_cursor *cursor, char *low, int low_size, int low_inclusive, char *high,
+                           int high_size, int high_inclusive);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that returns the next entry of a cursor. Entries come in the order of the index, by key and then
+ *        by row. The key of the entry is left in the key of the cursor.
+ * @param cursor open cursor
+ * @param rid row of the entry
+ * @return EXIT_SUCCESS, EXIT_ERROR if there are no more entries up to the upper bound
+ */
+int AK_btree_cursor_next(AK_btree_cursor *cursor, AK_btree_rid *rid);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that copies the key and the included values of the entry a cursor returned last into a row, so a
+ *        query that needs only them does not read the table. Entries of the row are numbered like the attributes of
+ *        the table, entries of attributes the index does not hold are left as they are.
+ * @param cursor open cursor, after AK_btree_cursor_next returned an entry
+ * @param entries entries of the row, MAX_ATTRIBUTES of them
+ * @param data buffer for the values, the addresses of the entries point into it
+ * @return number of copied values
+ */
+int AK_btree_cursor_row(AK_btree_cursor *cursor, AK_tuple_dict *entries, char *data);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that closes a cursor
+ * @param cursor open cursor
+ * @return No return value
+ */
+void AK_btree_cursor_close(AK_btree_cursor *cursor);
 
 /**
-  * @author Anđelko Spevec
-  * @brief Function that searches or deletes a value in btree index
-  * @param indexName - name of the index
-  * @param searchValue - value that we are searching in the index
-  * @param endRange - if 0 search is for 0 value, else searching in range
-  * @param toDo - if 0 we just search else we delete the element if we find it
+ * @author Anđelko Spevec, updated by Karlo Vuković (disk B+tree with typed keys)
+ * @brief Function for testing B+tree indices
+ * @return TestResult
  */
-int AK_btree_search_delete(char *indexName,int *searchValue,int *endRange,int *toDo,AK_block * inputBlock);
-int AK_btree_insert(char *indexName,int *insertValue, int *insertTd, int *insertBlock,AK_block * inputBlock);
 TestResult AK_btree_test();
 
 #endif
@@ -19,422 +19,832 @@
 
 
 #include "hash.h"
+#include "../bulk.h"
+
+/// hash indices are searched and changed by one thread at a time, which also guards the cache while pages are copied
+static pthread_mutex_t AK_hash_mutex = PTHREAD_MUTEX_INITIALIZER;
 
 /**
-  * @author Mislav Čakarić
-  * @brief Function that computes a hash value from varchar or integer
+ * @author Karlo Vuković
+ * @struct AK_hash_known
+ * @brief Structure that keeps the info of a hash index in memory
+ */
+typedef struct {
+    /// address of the first block of the index, 0 if the structure is not used
+    int address;
+    /// info of the index, the same as in its first block
+    hash_info info;
+} AK_hash_known;
+
+/// indices that were opened lately, they are found without searching the system catalog or reading their info
+static AK_hash_known AK_hash_known_indexes[HASH_KNOWN_INDEXES];
+/// next structure of AK_hash_known_indexes to be used
+static int AK_hash_known_next = 0;
+
+/**
+ * @author Karlo Vuković
+ * @struct AK_hash_index
+ * @brief Structure that holds an open hash index while it is searched or changed
+ */
+typedef struct {
+    /// name of the index
+    char *name;
+    /// address of the first block of the index
+    int address;
+    /// extents of the index segment, NULL until a page is added
+    table_addresses *addresses;
+    /// info of the index, kept in AK_hash_known_indexes
+    hash_info *info;
+    /// 1 if the info has to be written to the first block
+    int dirty;
+} AK_hash_index;
+
+/**
+ * @author Karlo Vuković
+ * @struct AK_hash_change
+ * @brief Structure that describes an element to be added to or removed from a hash index
+ */
+typedef struct {
+    /// bucket of the element when the changes were sorted
+    int bucket;
+    /// hash value
+    unsigned int value;
+    /// address of the record in the table
+    struct_add add;
+    /// 1 if the element is added, 0 if it is removed
+    int insert;
+} AK_hash_change;
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that folds a 64-bit hash into the hash value kept in bucket elements
+ * @param hash 64-bit hash
+ * @return hash value
+ */
+static unsigned int AK_hash_fold(unsigned long long hash) {
+    return (unsigned int) (hash ^ (hash >> 32));
+}
+
+/**
+  * @author Mislav Čakarić, updated by Karlo Vuković (64-bit hash)
+  * @brief Function that computes a hash value of a value of any type, the lower half of AK_hash_value64 folded
+  *        with its upper half
   * @param elem element of row for wich value is to be computed
   * @return hash value
- 
  */
-int AK_elem_hash_value(struct list_node *elem) {
-    int type = elem->type, value = 0, i = 0;
-    char temp_char[MAX_VARCHAR_LENGTH];
+unsigned int AK_elem_hash_value(struct list_node *elem) {
+    unsigned int value;
     AK_PRO;
-    switch (type) {
-        case TYPE_INT:
-            memcpy(&value, elem->data, elem->size);
-            break;
-        case TYPE_VARCHAR:
-            memcpy(temp_char, elem->data, elem->size);
-            temp_char[ elem->size ] = '\0';
-            do {
-                value += (int) temp_char[i++];
-            } while (temp_char[i]);
-            break;
-    }
+    value = AK_hash_fold(AK_hash_value64(elem->type, elem->data, elem->size, 0));
     AK_EPI;
     return value;
 }
 
 /**
-  * @author Mislav Čakarić
-  * @brief Function that inserts a bucket to block
-  * @param indexName name of index
-  * @param data content of bucket stored in char array
-  * @param type type of bucket (MAIN_BUCKET or HASH_BUCKET)
-  * @return address structure with data where the bucket is stored 
+ * @author Karlo Vuković
+ * @brief Function that computes a hash value of a list of values without going through the list functions
+ * @param value first value
+ * @return hash value
+ */
+static unsigned int AK_hash_values(struct list_node *value) {
+    unsigned long long hash = 0;
+
+    for (; value != NULL; value = value->next)
+        hash = AK_hash_value64(value->type, value->data, value->size, hash);
+    return AK_hash_fold(hash);
+}
+
+/**
+  * @author Karlo Vuković
+  * @brief Function that computes a hash value of a list of values, each value is hashed with the hash of the values
+  *        before it as the seed
+  * @param values list of values in the order of the indexed attributes
+  * @return hash value
  */
-struct_add* AK_insert_bucket_to_block(char *indexName, char *data, int type) {
-    int size, id;
+unsigned int AK_values_hash_value(struct list_node *values) {
+    unsigned int value;
     AK_PRO;
-    struct_add *add = (struct_add*) AK_malloc(sizeof (struct_add));
-    add->addBlock = 0;
-    add->indexTd = 0;
+    value = AK_hash_values(AK_First_L2(values));
+    AK_EPI;
+    return value;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that computes the hash value of a row as it is stored in a block or in a copy of a row
+ * @param info info of the index
+ * @param entries entries of the row
+ * @param data bytes the addresses of the entries point into
+ * @param value hash value of the indexed attributes
+ * @return 1 if the row can be indexed, 0 if it is deleted or one of the attributes is a null
+ */
+static int AK_hash_entry_value(hash_info *info, AK_tuple_dict *entries, char *data, unsigned int *value) {
+    AK_tuple_dict *dict;
+    unsigned long long hash = 0;
+    int i;
+
+    for (i = 0; i < info->num_attr; i++) {
+        dict = &entries[info->attribute[i]];
+        if (dict->type != info->type[i] || dict->size <= 0 || dict->size > MAX_VARCHAR_LENGTH)
+            return 0;
+        hash = AK_hash_value64(dict->type, data + dict->address, dict->size, hash);
+    }
+    *value = AK_hash_fold(hash);
+    return 1;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that returns the header of a bucket page
+ * @param block page
+ * @return header of the page
+ */
+static hash_bucket *AK_hash_page_of(AK_block *block) {
+    return (hash_bucket *) block->data;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that returns the elements of a bucket page
+ * @param block page
+ * @return elements of the page
+ */
+static bucket_elem *AK_hash_elements(AK_block *block) {
+    return (bucket_elem *) (block->data + sizeof (hash_bucket));
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that copies a page from the cache, so that it stays the same while it is used
+ * @param address address of the page
+ * @return copy of the page
+ */
+static AK_block *AK_hash_read(int address) {
+    AK_block *block = (AK_block *) AK_malloc(sizeof (AK_block));
+
+    memcpy(block, ((AK_mem_block *) AK_get_block(address))->block, sizeof (AK_block));
+    return block;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that copies a changed page to the cache, which writes it to the disk later
+ * @param block page
+ * @return No return value
+ */
+static void AK_hash_write(AK_block *block) {
+    AK_mem_block *mem_block = (AK_mem_block *) AK_get_block(block->address);
+
+    memcpy(mem_block->block, block, sizeof (AK_block));
+    AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that forgets the info of a hash index
+ * @param indexName name of the index
+ * @return No return value
+ */
+static void AK_hash_forget(char *indexName) {
+    int i;
+
+    for (i = 0; i < HASH_KNOWN_INDEXES; i++) {
+        if (AK_hash_known_indexes[i].address != 0 && strcmp(AK_hash_known_indexes[i].info.name, indexName) == 0)
+            AK_hash_known_indexes[i].address = 0;
+    }
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that keeps the info of a hash index in memory, in place of the index that was opened the longest
+ *        time ago
+ * @param address address of the first block of the index
+ * @param info info of the index
+ * @return info kept in memory
+ */
+static hash_info *AK_hash_remember(int address, hash_info *info) {
+    AK_hash_known *known = &AK_hash_known_indexes[AK_hash_known_next];
+
+    AK_hash_known_next = (AK_hash_known_next + 1) % HASH_KNOWN_INDEXES;
+    known->address = address;
+    memcpy(&known->info, info, sizeof (hash_info));
+    return &known->info;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that opens a hash index. The info of an index that was opened lately is used if its first block
+ *        still belongs to it, otherwise the index is found in the system catalog.
+ * @param indexName name of the index
+ * @param index open index
+ * @return EXIT_SUCCESS if there is such index, EXIT_ERROR otherwise
+ */
+static int AK_hash_open(char *indexName, AK_hash_index *index) {
+    AK_block *block;
+    table_addresses *addresses;
+    int i;
+
+    index->name = indexName;
+    index->addresses = NULL;
+    index->dirty = 0;
+    for (i = 0; i < HASH_KNOWN_INDEXES; i++) {
+        if (AK_hash_known_indexes[i].address == 0 || strcmp(AK_hash_known_indexes[i].info.name, indexName) != 0)
+            continue;
+        block = ((AK_mem_block *) AK_get_block(AK_hash_known_indexes[i].address))->block;
+        if (block->type == BLOCK_TYPE_HASH && strcmp(((hash_info *) block->data)->name, indexName) == 0) {
+            index->address = AK_hash_known_indexes[i].address;
+            index->info = &AK_hash_known_indexes[i].info;
+            return EXIT_SUCCESS;
+        }
+        //the block was given to another segment after the index was deleted
+        AK_hash_known_indexes[i].address = 0;
+    }
+
+    addresses = AK_get_table_addresses(indexName);
+    index->address = addresses->address_from[0];
+    AK_free(addresses);
+    if (index->address == 0)
+        return EXIT_ERROR;
+    block = ((AK_mem_block *) AK_get_block(index->address))->block;
+    if (block->type != BLOCK_TYPE_HASH || strcmp(((hash_info *) block->data)->name, indexName) != 0)
+        return EXIT_ERROR;
+    index->info = AK_hash_remember(index->address, (hash_info *) block->data);
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that closes a hash index and writes its info if it was changed
+ * @param index open index
+ * @return No return value
+ */
+static void AK_hash_close(AK_hash_index *index) {
+    AK_block *block;
+
+    if (index->dirty) {
+        block = AK_hash_read(index->address);
+        block->type = BLOCK_TYPE_HASH;
+        memcpy(block->data, index->info, sizeof (hash_info));
+        AK_hash_write(block);
+        AK_free(block);
+    }
+    if (index->addresses != NULL)
+        AK_free(index->addresses);
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that finds the block of the segment with a page number
+ * @param addresses extents of the index segment
+ * @param number page number, 0 for the block with the info of the index
+ * @return block address, -1 if the segment has no such block
+ */
+static int AK_hash_block(table_addresses *addresses, int number) {
+    int i, blocks;
+
+    for (i = 0; i < MAX_EXTENTS_IN_SEGMENT && addresses->address_from[i] != 0; i++) {
+        blocks = addresses->address_to[i] - addresses->address_from[i];
+        if (number < blocks)
+            return addresses->address_from[i] + number;
+        number -= blocks;
+    }
+    return -1;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that takes an empty page for the index, from the pages freed by splits or from the next block of
+ *        the segment. The segment gets a new extent when all of its blocks are used.
+ * @param index open index
+ * @return empty page, NULL if there is no space
+ */
+static AK_block *AK_hash_new_page(AK_hash_index *index) {
+    AK_block *block;
+    int address;
+
+    if (index->info->free_list != 0) {
+        block = AK_hash_read(index->info->free_list);
+        index->info->free_list = AK_hash_page_of(block)->next;
+    } else {
+        if (index->addresses == NULL)
+            index->addresses = AK_get_table_addresses(index->name);
+        address = AK_hash_block(index->addresses, index->info->num_pages);
+        if (address < 0) {
+            if (AK_init_new_extent(index->name, SEGMENT_TYPE_TABLE) == EXIT_ERROR) {
+                printf("AK_hash_new_page: Could not extend index %s!\n", index->name);
+                return NULL;
+            }
+            AK_free(index->addresses);
+            index->addresses = AK_get_table_addresses(index->name);
+            address = AK_hash_block(index->addresses, index->info->num_pages);
+            if (address < 0)
+                return NULL;
+        }
+        index->info->num_pages++;
+        block = AK_hash_read(address);
+    }
+    index->dirty = 1;
+    block->type = BLOCK_TYPE_HASH;
+    memset(block->data, 0, sizeof (block->data));
+    return block;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that writes a page that is no longer used to the list of free pages of the index
+ * @param index open index
+ * @param block page
+ * @return No return value
+ */
+static void AK_hash_free_page(AK_hash_index *index, AK_block *block) {
+    memset(block->data, 0, sizeof (block->data));
+    AK_hash_page_of(block)->next = index->info->free_list;
+    index->info->free_list = block->address;
+    index->dirty = 1;
+    AK_hash_write(block);
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that returns the bucket of a hash value. Buckets before the next one to be split use one bit more
+ *        of the value than the others, because they were already split on this level.
+ * @param info info of the index
+ * @param value hash value
+ * @return bucket number
+ */
+static int AK_hash_bucket_of(hash_info *info, unsigned int value) {
+    unsigned int bucket = value & ((HASH_INITIAL_BUCKETS << info->level) - 1);
+
+    if (bucket < (unsigned int) info->split)
+        bucket = value & ((HASH_INITIAL_BUCKETS << (info->level + 1)) - 1);
+    return (int) bucket;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that finds the first page of a bucket in the directory
+ * @param index open index
+ * @param bucket bucket number
+ * @return address of the page
+ */
+static int AK_hash_directory_get(AK_hash_index *index, int bucket) {
+    AK_block *block = ((AK_mem_block *) AK_get_block(index->info->directory[bucket / HASH_DIRECTORY_ENTRIES]))->block;
+    int address;
+
+    memcpy(&address, block->data + (bucket % HASH_DIRECTORY_ENTRIES) * sizeof (int), sizeof (int));
+    return address;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that writes the first page of a bucket to the directory, the directory gets a new page when the
+ *        bucket is the first one of it
+ * @param index open index
+ * @param bucket bucket number
+ * @param address address of the page
+ * @return EXIT_SUCCESS, EXIT_ERROR if the index could not be extended
+ */
+static int AK_hash_directory_set(AK_hash_index *index, int bucket, int address) {
+    AK_block *block;
+    int page = bucket / HASH_DIRECTORY_ENTRIES;
+
+    if (index->info->directory[page] == 0) {
+        block = AK_hash_new_page(index);
+        if (block == NULL)
+            return EXIT_ERROR;
+        index->info->directory[page] = block->address;
+    } else
+        block = AK_hash_read(index->info->directory[page]);
+    memcpy(block->data + (bucket % HASH_DIRECTORY_ENTRIES) * sizeof (int), &address, sizeof (int));
+    AK_hash_write(block);
+    AK_free(block);
+    return EXIT_SUCCESS;
+}
 
-    int adr_to_write = (int) AK_find_AK_free_space(AK_get_index_addresses(indexName));
-    if (adr_to_write == -1)
-        adr_to_write = (int) AK_init_new_extent(indexName, SEGMENT_TYPE_INDEX);
-    if (adr_to_write == 0){
-	AK_EPI;
-        return add;
+/**
+ * @author Karlo Vuković
+ * @brief Function that writes elements into an empty bucket, page after page
+ * @param index open index
+ * @param block first page of the bucket, it is written and freed
+ * @param elements elements of the bucket
+ * @param num_elements number of elements
+ * @return EXIT_SUCCESS, EXIT_ERROR if the index could not be extended
+ */
+static int AK_hash_fill(AK_hash_index *index, AK_block *block, bucket_elem *elements, int num_elements) {
+    AK_block *next;
+    int count;
+
+    for (;;) {
+        count = num_elements < HASH_BUCKET_ELEMENTS ? num_elements : HASH_BUCKET_ELEMENTS;
+        memcpy(AK_hash_elements(block), elements, count * sizeof (bucket_elem));
+        AK_hash_page_of(block)->num_elements = count;
+        elements += count;
+        num_elements -= count;
+        next = num_elements > 0 ? AK_hash_new_page(index) : NULL;
+        AK_hash_page_of(block)->next = next != NULL ? next->address : 0;
+        AK_hash_write(block);
+        AK_free(block);
+        if (next == NULL)
+            return num_elements > 0 ? EXIT_ERROR : EXIT_SUCCESS;
+        block = next;
     }
+}
 
-    AK_block *block = (AK_block*) AK_read_block(adr_to_write);
+/**
+ * @author Karlo Vuković
+ * @brief Function that splits the next bucket. Its elements are divided between it and a new bucket at the end by one
+ *        more bit of their hash values, and its overflow pages are freed. After the last bucket of a level is split,
+ *        the number of buckets has doubled and splitting starts again from the first bucket.
+ * @param index open index
+ * @return EXIT_SUCCESS, EXIT_ERROR if the index could not be extended
+ */
+static int AK_hash_split(AK_hash_index *index) {
+    hash_info *info = index->info;
+    AK_block *block, *sibling;
+    bucket_elem *elements, *moved, *element;
+    unsigned int mask = (HASH_INITIAL_BUCKETS << (info->level + 1)) - 1;
+    int address, first, i, num_elements = 0, num_moved = 0, max_elements = HASH_BUCKET_ELEMENTS, result;
 
-    AK_dbg_messg(HIGH, INDICES, "insert_bucket_to_block: Position to write (tuple_dict_index) %d\n", adr_to_write);
+    elements = (bucket_elem *) AK_malloc(max_elements * sizeof (bucket_elem));
+    moved = (bucket_elem *) AK_malloc(max_elements * sizeof (bucket_elem));
+    first = AK_hash_directory_get(index, info->split);
+    for (address = first; address != 0;) {
+        block = AK_hash_read(address);
+        for (i = 0; i < AK_hash_page_of(block)->num_elements; i++) {
+            element = &AK_hash_elements(block)[i];
+            if (num_elements == max_elements || num_moved == max_elements) {
+                max_elements *= 2;
+                elements = (bucket_elem *) AK_realloc(elements, max_elements * sizeof (bucket_elem));
+                moved = (bucket_elem *) AK_realloc(moved, max_elements * sizeof (bucket_elem));
+            }
+            if ((int) (element->value & mask) == info->num_buckets)
+                memcpy(&moved[num_moved++], element, sizeof (bucket_elem));
+            else
+                memcpy(&elements[num_elements++], element, sizeof (bucket_elem));
+        }
+        address = AK_hash_page_of(block)->next;
+        if (block->address != first)
+            AK_hash_free_page(index, block);
+        AK_free(block);
+    }
 
-    switch (type) {
-        case MAIN_BUCKET:
-            size = sizeof (main_bucket);
+    sibling = AK_hash_new_page(index);
+    if (sibling == NULL || AK_hash_directory_set(index, info->num_buckets, sibling->address) == EXIT_ERROR) {
+        AK_free(sibling);
+        AK_free(elements);
+        AK_free(moved);
+        return EXIT_ERROR;
+    }
+    info->num_buckets++;
+    info->split++;
+    if (info->split == HASH_INITIAL_BUCKETS << info->level) {
+        info->level++;
+        info->split = 0;
+    }
+    index->dirty = 1;
+
+    block = AK_hash_read(first);
+    result = AK_hash_fill(index, block, elements, num_elements);
+    if (AK_hash_fill(index, sibling, moved, num_moved) == EXIT_ERROR)
+        result = EXIT_ERROR;
+    AK_free(elements);
+    AK_free(moved);
+    return result;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that adds an element to its bucket, into the first page with space or into a new overflow page,
+ *        and splits the next bucket if the buckets got too full
+ * @param index open index
+ * @param value hash value
+ * @param add address of the record in the table
+ * @return EXIT_SUCCESS, EXIT_ERROR if the index could not be extended
+ */
+static int AK_hash_insert_entry(AK_hash_index *index, unsigned int value, struct_add *add) {
+    hash_info *info = index->info;
+    AK_block *block, *next;
+    bucket_elem *element;
+    int address = AK_hash_directory_get(index, AK_hash_bucket_of(info, value));
+
+    for (;;) {
+        block = AK_hash_read(address);
+        if (AK_hash_page_of(block)->num_elements < HASH_BUCKET_ELEMENTS)
             break;
-        case HASH_BUCKET:
-            size = sizeof (hash_bucket);
+        address = AK_hash_page_of(block)->next;
+        if (address == 0) {
+            next = AK_hash_new_page(index);
+            if (next == NULL) {
+                AK_free(block);
+                return EXIT_ERROR;
+            }
+            AK_hash_page_of(block)->next = next->address;
+            AK_hash_write(block);
+            AK_free(block);
+            block = next;
             break;
+        }
+        AK_free(block);
     }
-    id = block->last_tuple_dict_id + 1;
-    memcpy(&block->data[block->AK_free_space], data, size);
-    block->tuple_dict[id].address = block->AK_free_space;
-    block->AK_free_space += size;
-    block->tuple_dict[id].type = type;
-    block->tuple_dict[id].size = size;
-    block->last_tuple_dict_id = id;
-    AK_write_block(block);
-
-    add->addBlock = adr_to_write;
-    add->indexTd = id;
-    AK_EPI;
-    return add;
+    element = &AK_hash_elements(block)[AK_hash_page_of(block)->num_elements++];
+    element->value = value;
+    memcpy(&element->add, add, sizeof (struct_add));
+    AK_hash_write(block);
+    AK_free(block);
+    info->num_entries++;
+    index->dirty = 1;
+
+    while ((long long) info->num_entries * 100 > (long long) info->num_buckets * HASH_BUCKET_ELEMENTS * HASH_SPLIT_PERCENT &&
+           info->num_buckets < HASH_DIRECTORY_PAGES * HASH_DIRECTORY_ENTRIES) {
+        if (AK_hash_split(index) == EXIT_ERROR)
+            return EXIT_ERROR;
+    }
+    return EXIT_SUCCESS;
 }
 
 /**
-  *  @author Mislav Čakarić
-  *  @brief Function that updates a bucket in block
-  *  @param add address of where the bucket is stored
-  *  @param data content of bucket stored in char array
-  *  @return No return value
+ * @author Karlo Vuković
+ * @brief Function that removes an element from its bucket. The last element of the page takes its place, and an
+ *        overflow page that is left empty is unlinked from the bucket.
+ * @param index open index
+ * @param value hash value
+ * @param add address of the record in the table
+ * @return EXIT_SUCCESS if the element was removed, EXIT_ERROR if it is not in the index
  */
-void AK_update_bucket_in_block(struct_add *add, char *data) {
-    AK_PRO;
-    AK_block *block = (AK_block*) AK_read_block(add->addBlock);
-    int address = block->tuple_dict[add->indexTd].address;
-    int size = block->tuple_dict[add->indexTd].size;
-    memcpy(&block->data[address], data, size);
-    AK_write_block(block);
-    AK_EPI;
+static int AK_hash_remove_entry(AK_hash_index *index, unsigned int value, struct_add *add) {
+    AK_block *block, *previous = NULL;
+    bucket_elem *elements;
+    hash_bucket *page;
+    int i, address = AK_hash_directory_get(index, AK_hash_bucket_of(index->info, value));
+
+    while (address != 0) {
+        block = AK_hash_read(address);
+        page = AK_hash_page_of(block);
+        elements = AK_hash_elements(block);
+        for (i = 0; i < page->num_elements; i++) {
+            if (elements[i].value == value && elements[i].add.addBlock == add->addBlock &&
+                elements[i].add.indexTd == add->indexTd)
+                break;
+        }
+        if (i < page->num_elements) {
+            memcpy(&elements[i], &elements[page->num_elements - 1], sizeof (bucket_elem));
+            page->num_elements--;
+            if (page->num_elements == 0 && previous != NULL) {
+                AK_hash_page_of(previous)->next = page->next;
+                AK_hash_write(previous);
+                AK_hash_free_page(index, block);
+            } else
+                AK_hash_write(block);
+            AK_free(block);
+            AK_free(previous);
+            index->info->num_entries--;
+            index->dirty = 1;
+            return EXIT_SUCCESS;
+        }
+        AK_free(previous);
+        previous = block;
+        address = page->next;
+    }
+    AK_free(previous);
+    return EXIT_ERROR;
 }
 
 /**
-  * @author Mislav Čakarić
-  * @brief Function that changes a info of hash index
-  * @param indexName name of index
-  * @param modulo value for modulo hash function
-  * @param main_bucket_num number of main buckets
-  * @param hash_bucket_num number of hash buckets
-  * @return No return value
+ * @author Karlo Vuković
+ * @brief Function that checks if a record of the table has the values
+ * @param info info of the index
+ * @param add address of the record in the table
+ * @param value first value
+ * @return 1 if the record has the values, 0 otherwise
  */
-void AK_change_hash_info(char *indexName, int modulo, int main_bucket_num, int hash_bucket_num) {
-    AK_PRO;
-    table_addresses *hash_addresses = (table_addresses*) AK_get_index_addresses(indexName);
-    int block_add = hash_addresses->address_from[ 0 ];
-    if (block_add == 0) {
-        printf("Hash index does not exist!\n");
-    }
-    AK_block *block = (AK_block*) AK_read_block(block_add);
-    hash_info *info = (hash_info*) AK_malloc(sizeof (hash_info));
-    info->modulo = modulo;
-    info->main_bucket_num = main_bucket_num;
-    info->hash_bucket_num = hash_bucket_num;
-
-    memcpy(block->data, info, sizeof (hash_info));
-    block->tuple_dict[0].address = 0;
-    block->tuple_dict[0].type = INFO_BUCKET;
-    block->tuple_dict[0].size = sizeof (hash_info);
-    AK_write_block(block);
-    AK_EPI;
+static int AK_hash_matches(hash_info *info, struct_add *add, struct list_node *value) {
+    AK_block *block = ((AK_mem_block *) AK_get_block(add->addBlock))->block;
+    AK_tuple_dict *dict;
+    int i;
+
+    for (i = 0; i < info->num_attr; i++, value = value->next) {
+        if (value == NULL || add->indexTd + info->attribute[i] >= DATA_BLOCK_SIZE)
+            return 0;
+        dict = &block->tuple_dict[add->indexTd + info->attribute[i]];
+        if (dict->type != info->type[i] || value->type != dict->type ||
+            AK_compare_values(dict->type, (char *) block->data + dict->address, dict->size, value->data, value->size) != 0)
+            return 0;
+    }
+    return value == NULL;
 }
 
 /**
-  * @author Mislav Čakarić
-  * @brief Function that fetches the info for hash index
+ * @author Karlo Vuković
+ * @brief Function that finds records with values in the bucket of their hash value
+ * @param index open index
+ * @param value first value
+ * @param hash hash value of the values
+ * @param adds array for the addresses of the records, may be NULL
+ * @param max_adds size of the array, the search stops after that many records if stop is set
+ * @param stop 1 to stop after max_adds records
+ * @return number of records with the values
+ */
+static int AK_hash_lookup(AK_hash_index *index, struct list_node *value, unsigned int hash, struct_add *adds,
+                          int max_adds, int stop) {
+    AK_block *block;
+    bucket_elem *elements;
+    int i, count = 0, address = AK_hash_directory_get(index, AK_hash_bucket_of(index->info, hash));
+
+    while (address != 0 && !(stop && count >= max_adds)) {
+        block = AK_hash_read(address);
+        elements = AK_hash_elements(block);
+        for (i = 0; i < AK_hash_page_of(block)->num_elements && !(stop && count >= max_adds); i++) {
+            if (elements[i].value != hash || !AK_hash_matches(index->info, &elements[i].add, value))
+                continue;
+            if (adds != NULL && count < max_adds)
+                memcpy(&adds[count], &elements[i].add, sizeof (struct_add));
+            count++;
+        }
+        address = AK_hash_page_of(block)->next;
+        AK_free(block);
+    }
+    return count;
+}
+
+/**
+  * @author Mislav Čakarić, updated by Karlo Vuković (cached hash_info)
+  * @brief Function that fetches the info for hash index. Indices that were opened lately keep their info in memory,
+  *        others are found in the system catalog.
   * @param indexName name of index
-  * @return info bucket with info data for hash index
+  * @return copy of the info of the index, NULL if there is no such index
  */
 hash_info* AK_get_hash_info(char *indexName) {
+    AK_hash_index index;
+    hash_info *info = NULL;
     AK_PRO;
-    table_addresses *hash_addresses = (table_addresses*) AK_get_index_addresses(indexName);
-    int block_add = hash_addresses->address_from[ 0 ];
-    hash_info *info = (hash_info*) AK_malloc(sizeof (hash_info));
-    memset(info, 0, sizeof (hash_info));
-    if (block_add == 0) {
-        printf("Hash index does not exist!\n");
-	AK_EPI;
-        return info;
-    }
-    AK_block *block = (AK_block*) AK_read_block(block_add);
-    memcpy(info, block->data, sizeof (hash_info));
+    pthread_mutex_lock(&AK_hash_mutex);
+    if (AK_hash_open(indexName, &index) == EXIT_SUCCESS) {
+        info = (hash_info *) AK_malloc(sizeof (hash_info));
+        memcpy(info, index.info, sizeof (hash_info));
+        AK_hash_close(&index);
+    }
+    pthread_mutex_unlock(&AK_hash_mutex);
     AK_EPI;
     return info;
 }
 
 /**
-  * @author Mislav Čakarić
-  * @brief Function that fetches nth main bucket
+  *  @author Mislav Čakarić, updated by Karlo Vuković (linear hashing)
+  *  @brief Function that inserts a record in hash index. When the buckets get more than HASH_SPLIT_PERCENT full
+  *         on average, the next bucket is split in two and its elements are moved between them.
+  *  @param indexName name of index
+  *  @param hashValue hash value of record that is being inserted
+  *  @param add address of the record in the table
+  *  @return EXIT_SUCCESS if the record is in the index, EXIT_ERROR otherwise
+ */
+int AK_insert_in_hash_index(char *indexName, unsigned int hashValue, struct_add *add) {
+    AK_hash_index index;
+    int result = EXIT_ERROR;
+    AK_PRO;
+    pthread_mutex_lock(&AK_hash_mutex);
+    if (AK_hash_open(indexName, &index) == EXIT_SUCCESS) {
+        result = AK_hash_insert_entry(&index, hashValue, add);
+        AK_hash_close(&index);
+    } else
+        printf("Hash index %s does not exist!\n", indexName);
+    pthread_mutex_unlock(&AK_hash_mutex);
+    AK_EPI;
+    return result;
+}
+
+/**
+  * @author Karlo Vuković
+  * @brief Function that removes a record from hash index by its hash value and address, without reading the record
   * @param indexName name of index
-  * @param n number of main bucket
-  * @return address structure with data where the bucket is stored
+  * @param hashValue hash value of the record
+  * @param add address of the record in the table
+  * @return EXIT_SUCCESS if the record was removed, EXIT_ERROR if it is not in the index
  */
-struct_add* AK_get_nth_main_bucket_add(char *indexName, int n) {
-    int i = 0, j = 0, k = 0, counter = 0, end = 0;
+int AK_remove_from_hash_index(char *indexName, unsigned int hashValue, struct_add *add) {
+    AK_hash_index index;
+    int result = EXIT_ERROR;
     AK_PRO;
-    struct_add *add = (struct_add*) AK_malloc(sizeof (struct_add));
-    add->addBlock = 301;
-    add->indexTd = 2;
-    table_addresses *addresses = (table_addresses*) AK_get_index_addresses(indexName);
-    while (addresses->address_from[i]) {
-        for (j = addresses->address_from[i]; j < addresses->address_to[i]; j++) {
-            AK_block *temp = (AK_block*) AK_read_block(j);
-            for (k = 0; k < DATA_BLOCK_SIZE; k++) {
-                if (temp->tuple_dict[k].type == FREE_INT)
-                    break;
-                if (temp->tuple_dict[k].type == MAIN_BUCKET) {
-                    if (n == counter) {
-                        add->addBlock = j;
-                        add->indexTd = k;
-                        end = 1;
-                        break;
-                    }
-                    counter++;
-                }
-            }
-            if (end) break;
-        }
-        i++;
+    pthread_mutex_lock(&AK_hash_mutex);
+    if (AK_hash_open(indexName, &index) == EXIT_SUCCESS) {
+        result = AK_hash_remove_entry(&index, hashValue, add);
+        AK_hash_close(&index);
     }
+    pthread_mutex_unlock(&AK_hash_mutex);
     AK_EPI;
-    return add;
-    AK_free(add);
+    return result;
 }
 
 /**
-  *  @author Mislav Čakarić
-  *  @brief Function that inserts a record in hash bucket
-  *  @param indexName name of index
-  *  @param hashValue hash value of record that is being inserted
-  *  @param add address structure with data where the hash bucket is stored
-  *  @return No return value
+ * @author Karlo Vuković
+ * @brief Function that compares the elements of two changes of a hash index by bucket, hash value and address
+ * @param a first change
+ * @param b second change
+ * @return negative number if the first element comes first, 0 if the elements are equal, otherwise positive number
  */
-void AK_insert_in_hash_index(char *indexName, int hashValue, struct_add *add) {
-    int i, address, size, hash_AK_free_space = 0;
-    AK_PRO;
-    struct_add *main_add = (struct_add*) AK_malloc(sizeof (struct_add));
-    struct_add *hash_add = (struct_add*) AK_malloc(sizeof (struct_add));
-    main_bucket *temp_main_bucket = (main_bucket*) AK_malloc(sizeof (main_bucket));
-    hash_bucket *temp_hash_bucket = (hash_bucket*) AK_malloc(sizeof (hash_bucket));
-
-    table_addresses *addresses = (table_addresses*) AK_get_index_addresses(indexName);
-    if (addresses->address_from[0] == 0)
-        printf("Hash index does not exist!\n");
-    else {
-        char data[255];
-        memset(data, 0, 255);
-        hash_info *info = (hash_info*) AK_malloc(sizeof (hash_info));
-        info = AK_get_hash_info(indexName);
-        if (info->main_bucket_num == 0) {
-            for (i = 0; i < MAIN_BUCKET_SIZE; i++) {
-                temp_main_bucket->element[i].value = i;
-                memset(&temp_main_bucket->element[i].add, 0, sizeof (struct_add));
-            }
-            memcpy(&data, temp_main_bucket, sizeof (main_bucket));
-            main_add = AK_insert_bucket_to_block(indexName, data, MAIN_BUCKET);
+static int AK_hash_change_element(const AK_hash_change *a, const AK_hash_change *b) {
+    if (a->bucket != b->bucket)
+        return a->bucket < b->bucket ? -1 : 1;
+    if (a->value != b->value)
+        return a->value < b->value ? -1 : 1;
+    if (a->add.addBlock != b->add.addBlock)
+        return a->add.addBlock < b->add.addBlock ? -1 : 1;
+    if (a->add.indexTd != b->add.indexTd)
+        return a->add.indexTd < b->add.indexTd ? -1 : 1;
+    return 0;
+}
 
-            temp_hash_bucket->bucket_level = MAIN_BUCKET_SIZE;
-            for (i = 0; i < HASH_BUCKET_SIZE; i++) {
-                temp_hash_bucket->element[i].value = -1;
-            }
-            memcpy(&data, temp_hash_bucket, sizeof (hash_bucket));
-            for (i = 0; i < MAIN_BUCKET_SIZE; i++) {
-                hash_add = AK_insert_bucket_to_block(indexName, data, HASH_BUCKET);
+/**
+ * @author Karlo Vuković
+ * @brief Function that orders changes of a hash index by their elements, a removal before an insert of the same
+ *        element
+ * @param left first change
+ * @param right second change
+ * @return negative number if the first change comes first, 0 if they are equal, otherwise positive number
+ */
+static int AK_hash_change_compare(const void *left, const void *right) {
+    const AK_hash_change *a = (const AK_hash_change *) left, *b = (const AK_hash_change *) right;
+    int result = AK_hash_change_element(a, b);
 
-                memcpy(&temp_main_bucket->element[i].add, hash_add, sizeof (struct_add));
-            }
-            memcpy(&data, temp_main_bucket, sizeof (main_bucket));
-            AK_update_bucket_in_block(main_add, data);
-            AK_change_hash_info(indexName, MAIN_BUCKET_SIZE, 1, MAIN_BUCKET_SIZE);
-        }
-        int hash_bucket_id = hashValue % info->modulo;
-        int main_bucket_id = (int) (hash_bucket_id / MAIN_BUCKET_SIZE);
-
-        main_add = AK_get_nth_main_bucket_add(indexName, main_bucket_id);
-
-        AK_block *temp_block = (AK_block*) AK_read_block(main_add->addBlock);
-        address = temp_block->tuple_dict[main_add->indexTd].address;
-        size = temp_block->tuple_dict[main_add->indexTd].size;
-        memcpy(temp_main_bucket, &temp_block->data[address], size);
-
-        memcpy(hash_add, &temp_main_bucket->element[hash_bucket_id % MAIN_BUCKET_SIZE].add, sizeof (struct_add));
-
-
-        temp_block = (AK_block*) AK_read_block(hash_add->addBlock);
-        address = temp_block->tuple_dict[hash_add->indexTd].address;
-        size = temp_block->tuple_dict[hash_add->indexTd].size;
-        memcpy(temp_hash_bucket, &temp_block->data[address], size);
-        for (i = 0; i < HASH_BUCKET_SIZE; i++) {
-            if (temp_hash_bucket->element[i].value == -1) {
-                hash_AK_free_space = 1;
-                temp_hash_bucket->element[i].value = hashValue;
-                memcpy(&temp_hash_bucket->element[i].add, add, sizeof (struct_add));
-                memcpy(&data, temp_hash_bucket, sizeof (hash_bucket));
-                AK_update_bucket_in_block(hash_add, data);
-                break;
-            }
-        }
-        if (hash_AK_free_space == 0) {
-
-            if (temp_hash_bucket->bucket_level == info->modulo) {
-                //adding new main buckets
-                for (i = 0; i < info->main_bucket_num; i++) {
-                    main_add = AK_get_nth_main_bucket_add(indexName, i);
-                    AK_block *temp_block = (AK_block*) AK_read_block(main_add->addBlock);
-                    address = temp_block->tuple_dict[main_add->indexTd].address;
-                    size = temp_block->tuple_dict[main_add->indexTd].size;
-                    memcpy(data, &temp_block->data[address], size);
-                    AK_insert_bucket_to_block(indexName, data, MAIN_BUCKET);
-                }
-                AK_change_hash_info(indexName, info->modulo * 2, info->main_bucket_num * 2, info->hash_bucket_num);
-                info = AK_get_hash_info(indexName);
-            }
-            int hash_bucket_id2 = (hash_bucket_id + info->modulo / 2) % info->modulo;
-            int main_bucket_id2 = (int) (hash_bucket_id2 / MAIN_BUCKET_SIZE);
-
-            //swapping hash bucket id's
-            if (hash_bucket_id2 < hash_bucket_id) {
-                int temp = hash_bucket_id;
-                hash_bucket_id = hash_bucket_id2;
-                hash_bucket_id2 = temp;
-                temp = main_bucket_id;
-                main_bucket_id = main_bucket_id2;
-                main_bucket_id2 = temp;
-            }
+    return result != 0 ? result : a->insert - b->insert;
+}
 
-            hash_bucket *temp_hash_bucket2 = (hash_bucket*) AK_malloc(sizeof (hash_bucket));
-            temp_hash_bucket2->bucket_level = temp_hash_bucket->bucket_level * 2;
-            for (i = 0; i < HASH_BUCKET_SIZE; i++) {
-                temp_hash_bucket2->element[i].value = -1;
-                memset(&temp_hash_bucket2->element[i].add, 0, sizeof (struct_add));
-            }
-            memcpy(data, temp_hash_bucket2, sizeof (hash_bucket));
-            AK_update_bucket_in_block(hash_add, data);
-
-            main_add = AK_get_nth_main_bucket_add(indexName, main_bucket_id2);
-            temp_block = (AK_block*) AK_read_block(main_add->addBlock);
-            address = temp_block->tuple_dict[main_add->indexTd].address;
-            size = temp_block->tuple_dict[main_add->indexTd].size;
-            memcpy(temp_main_bucket, &temp_block->data[address], size);
-
-            hash_add = AK_insert_bucket_to_block(indexName, data, HASH_BUCKET);
-            memcpy(&temp_main_bucket->element[hash_bucket_id2 % MAIN_BUCKET_SIZE].add, hash_add, sizeof (struct_add));
-            memcpy(data, temp_main_bucket, sizeof (main_bucket));
-            AK_update_bucket_in_block(main_add, data);
-
-            AK_change_hash_info(indexName, info->modulo, info->main_bucket_num, info->hash_bucket_num + 1);
-            for (i = 0; i < HASH_BUCKET_SIZE; i++) {
-                int value = temp_hash_bucket->element[i].value;
-                memcpy(main_add, &temp_hash_bucket->element[i].add, sizeof (struct_add));
-                AK_insert_in_hash_index(indexName, value, main_add);
+/**
+  * @author Karlo Vuković
+  * @brief Function that applies changes of rows of the indexed table to a hash index. Changes are sorted by their
+  *        buckets first, so changes of a bucket are made one after another, and a removal and an insert of the same
+  *        element, made by an update that did not change the indexed values, cancel each other out. Rows with a null
+  *        are not indexed.
+  * @param indexName name of index
+  * @param deltas changes of rows of the table
+  * @param num_deltas number of changes
+  * @return EXIT_SUCCESS, EXIT_ERROR if there is no such index or it could not be extended
+ */
+int AK_hash_apply(char *indexName, AK_index_delta *deltas, int num_deltas) {
+    AK_hash_index index;
+    AK_hash_change *changes;
+    int i, num_changes = 0, result = EXIT_SUCCESS;
+    AK_PRO;
+    changes = (AK_hash_change *) AK_malloc((num_deltas > 0 ? num_deltas : 1) * sizeof (AK_hash_change));
+    pthread_mutex_lock(&AK_hash_mutex);
+    if (AK_hash_open(indexName, &index) == EXIT_SUCCESS) {
+        for (i = 0; i < num_deltas; i++) {
+            if (!AK_hash_entry_value(index.info, deltas[i].entries, deltas[i].data, &changes[num_changes].value))
+                continue;
+            changes[num_changes].bucket = AK_hash_bucket_of(index.info, changes[num_changes].value);
+            memcpy(&changes[num_changes].add, &deltas[i].add, sizeof (struct_add));
+            changes[num_changes].insert = deltas[i].insert;
+            num_changes++;
+        }
+        qsort(changes, num_changes, sizeof (AK_hash_change), AK_hash_change_compare);
+        for (i = 0; i < num_changes && result == EXIT_SUCCESS; i++) {
+            if (i + 1 < num_changes && !changes[i].insert && changes[i + 1].insert &&
+                AK_hash_change_element(&changes[i], &changes[i + 1]) == 0) {
+                i++;
+                continue;
             }
-            AK_insert_in_hash_index(indexName, hashValue, add);
+            if (changes[i].insert)
+                result = AK_hash_insert_entry(&index, changes[i].value, &changes[i].add);
+            else
+                AK_hash_remove_entry(&index, changes[i].value, &changes[i].add);
         }
-    }
+        AK_hash_close(&index);
+    } else
+        result = EXIT_ERROR;
+    pthread_mutex_unlock(&AK_hash_mutex);
+    AK_free(changes);
     AK_EPI;
+    return result;
 }
 
 /**
-  * @author Mislav Čakarić
-  * @brief Function that fetches or deletes a record from hash index
+  * @author Mislav Čakarić, updated by Karlo Vuković (linear hashing)
+  * @brief Function that fetches or deletes a record from hash index. Records with the hash value of the values are
+  *        read from the table and compared with the values.
   * @param indexName name of index
   * @param values list of values (one row) to search in hash index
   * @param delete if delete is 0 then record is only read otherwise it's deleted from hash index
-  * @return address structure with data where the record is in table
- 
+  * @return address structure with data where the record is in table, with zeros if there is no such record
  */
-//Error: expected a ')'
 struct_add *AK_find_delete_in_hash_index(char *indexName, struct list_node *values, int delete) {
+    AK_hash_index index;
+    struct list_node *value;
+    unsigned int hash;
     AK_PRO;
-    struct_add *add = (struct_add*) AK_malloc(sizeof (struct_add));
-    memset(add, 0, sizeof (struct_add));
-    table_addresses *addresses = (table_addresses*) AK_get_index_addresses(indexName);
-    if (addresses->address_from[0] == 0) {
-        printf("Hash index does not exist!\n");
-        AK_EPI;
-        return add;
-    } else {
-        int hashValue = 0, address, size, i, j, k, found, match;
-        struct list_node *temp_elem;
-        temp_elem = AK_First_L2(values);
-        while (temp_elem) {
-            hashValue += AK_elem_hash_value(temp_elem);
-            temp_elem = AK_Next_L2(temp_elem);
+    struct_add *add = (struct_add*) AK_calloc(1, sizeof (struct_add));
+    value = AK_First_L2(values);
+    hash = AK_hash_values(value);
+    pthread_mutex_lock(&AK_hash_mutex);
+    if (AK_hash_open(indexName, &index) == EXIT_SUCCESS) {
+        if (AK_hash_lookup(&index, value, hash, add, 1, 1) == 1) {
+            if (delete == DELETE)
+                AK_hash_remove_entry(&index, hash, add);
+            else
+                AK_dbg_messg(HIGH, INDICES, "Record found in table block %d and TupleDict ID %d\n", add->addBlock, add->indexTd);
         }
-        struct_add *main_add = (struct_add*) AK_malloc(sizeof (struct_add));
-        struct_add *hash_add = (struct_add*) AK_malloc(sizeof (struct_add));
-        main_bucket *temp_main_bucket = (main_bucket*) AK_malloc(sizeof (main_bucket));
-        hash_bucket *temp_hash_bucket = (hash_bucket*) AK_malloc(sizeof (hash_bucket));
-        char data[255];
-        memset(data, 0, 255);
-        hash_info *info = (hash_info*) AK_malloc(sizeof (hash_info));
-        info = AK_get_hash_info(indexName);
-        int hash_bucket_id = hashValue % info->modulo;
-        int main_bucket_id = (int) (hash_bucket_id / MAIN_BUCKET_SIZE);
-
-        main_add = AK_get_nth_main_bucket_add(indexName, main_bucket_id);
-        AK_block *temp_block = (AK_block*) AK_read_block(main_add->addBlock);
-        address = temp_block->tuple_dict[main_add->indexTd].address;
-        size = temp_block->tuple_dict[main_add->indexTd].size;
-        memcpy(temp_main_bucket, &temp_block->data[address], size);
-
-        memcpy(hash_add, &temp_main_bucket->element[hash_bucket_id % MAIN_BUCKET_SIZE].add, sizeof (struct_add));
-
-        temp_block = (AK_block*) AK_read_block(hash_add->addBlock);
-        address = temp_block->tuple_dict[hash_add->indexTd].address;
-        size = temp_block->tuple_dict[hash_add->indexTd].size;
-        memcpy(temp_hash_bucket, &temp_block->data[address], size);
-        for (i = 0; i < HASH_BUCKET_SIZE; i++) {
-            if (temp_hash_bucket->element[i].value == hashValue) {
-                AK_block *temp_table_block = (AK_block*) AK_read_block(temp_hash_bucket->element[i].add.addBlock);
-                j = 0;
-                while (strcmp(temp_block->header[j].att_name, "\0")) {
-                    k = 0;
-                    found = 0;
-                    while (strcmp(temp_table_block->header[k].att_name, "\0")) {
-                        if (strcmp(temp_block->header[j].att_name, temp_table_block->header[k].att_name) == 0) {
-                            found = 1;
-                            match = 0;
-                            int indexTd = temp_hash_bucket->element[i].add.indexTd + k;
-                            int record_address = temp_table_block->tuple_dict[indexTd].address;
-                            int record_size = temp_table_block->tuple_dict[indexTd].size;
-                            int record_type = temp_table_block->tuple_dict[indexTd].type;
-                            memcpy(data, &temp_table_block->data[record_address], record_size);
-                            temp_elem = (struct list_node *)AK_First_L2(values);
-                            while (temp_elem) {
-                                if (temp_elem->type == record_type && memcmp(data, &temp_elem->data, record_size) == 0)
-                                    match = 1;
-                                temp_elem = temp_elem->next;
-                            }
-                            break;
-                        }
-                        k++;
-                    }
-                    if (found == 0 || match == 0) break;
-                    j++;
-                }
-                if (match) {
-                    int addBlock = temp_hash_bucket->element[i].add.addBlock;
-                    int indexTd = temp_hash_bucket->element[i].add.indexTd;
-                    //Error: expected an expression
-                    if (delete==1) {
-                        temp_hash_bucket->element[i].value = -1;
-                        memcpy(data, temp_hash_bucket, sizeof (hash_bucket));
-                        AK_update_bucket_in_block(hash_add, data);
-                    } else
-                        AK_dbg_messg(HIGH, INDICES, "Record found in table block %d and TupleDict ID %d\n", addBlock, indexTd);
-                    add->addBlock = addBlock;
-                    add->indexTd = indexTd;
-                    break;
-                }
-            }
-        }
-    }
+        AK_hash_close(&index);
+    } else
+        printf("Hash index %s does not exist!\n", indexName);
+    pthread_mutex_unlock(&AK_hash_mutex);
     AK_EPI;
     return add;
 }
@@ -464,195 +874,429 @@ struct_add * AK_find_in_hash_index(char *indexName, struct list_node *values) {
  */
 void AK_delete_in_hash_index(char *indexName, struct list_node *values) {
     AK_PRO;
-    AK_find_delete_in_hash_index(indexName, values, DELETE);
+    AK_free(AK_find_delete_in_hash_index(indexName, values, DELETE));
     AK_EPI;
 }
 
 /**
-  * @author Mislav Čakarić
-  * @brief Function that creates a hash index
-  * @param tblName name of table for which the index is being created
+  * @author Karlo Vuković
+  * @brief Function that finds all records with values in hash index
   * @param indexName name of index
+  * @param values list of values in the order of the indexed attributes
+  * @param adds array for the addresses of the records in the table, may be NULL
+  * @param max_adds size of the array
+  * @return number of records with the values, it can be larger than max_adds, EXIT_ERROR if there is no such index
+ */
+int AK_search_hash_index(char *indexName, struct list_node *values, struct_add *adds, int max_adds) {
+    AK_hash_index index;
+    struct list_node *value;
+    unsigned int hash;
+    int count = EXIT_ERROR;
+    AK_PRO;
+    value = AK_First_L2(values);
+    hash = AK_hash_values(value);
+    pthread_mutex_lock(&AK_hash_mutex);
+    if (AK_hash_open(indexName, &index) == EXIT_SUCCESS) {
+        count = AK_hash_lookup(&index, value, hash, adds, max_adds, 0);
+        AK_hash_close(&index);
+    }
+    pthread_mutex_unlock(&AK_hash_mutex);
+    AK_EPI;
+    return count;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that adds every row of the table to a new hash index. Blocks are copied from the cache, where the
+ *        latest versions of them are, and the info of the index is written once at the end.
+ * @param index open index
+ * @param tblName name of the table
+ * @return EXIT_SUCCESS, EXIT_ERROR if the index could not be extended
+ */
+static int AK_hash_build(AK_hash_index *index, char *tblName) {
+    hash_info *info = index->info;
+    table_addresses *addresses = AK_get_table_addresses(tblName);
+    AK_block *block = (AK_block *) AK_malloc(sizeof (AK_block));
+    struct_add add;
+    unsigned int value;
+    int i, j, address, last = info->table_num_attr - 1, result = EXIT_SUCCESS;
+
+    for (i = 0; i < MAX_EXTENTS_IN_SEGMENT && addresses->address_from[i] != 0 && result == EXIT_SUCCESS; i++) {
+        for (address = addresses->address_from[i]; address < addresses->address_to[i] && result == EXIT_SUCCESS; address++) {
+            memcpy(block, ((AK_mem_block *) AK_get_block(address))->block, sizeof (AK_block));
+            if (block->type != BLOCK_TYPE_NORMAL && block->type != BLOCK_TYPE_CHAINED)
+                continue;
+            for (j = 0; j + last < DATA_BLOCK_SIZE && block->tuple_dict[j].type != FREE_INT && result == EXIT_SUCCESS;
+                 j += info->table_num_attr) {
+                if (!AK_hash_entry_value(info, &block->tuple_dict[j], (char *) block->data, &value))
+                    continue;
+                add.addBlock = address;
+                add.indexTd = j;
+                result = AK_hash_insert_entry(index, value, &add);
+            }
+        }
+    }
+    AK_free(block);
+    AK_free(addresses);
+    return result;
+}
+
+/**
+  * @author Mislav Čakarić, updated by Karlo Vuković (linear hashing)
+  * @brief Function that creates a hash index. Attributes can be of any type, rows with a null or a value of another
+  *        type than the attribute are not indexed. Tables with the PAX layout can not be indexed.
+  * @param tblName name of table for which the index is being created
   * @param attributes list of attributes over which the index is being created
-  * @return success or error
- 
+  * @param indexName name of index
+  * @return EXIT_SUCCESS if the index was created, EXIT_ERROR otherwise
  */
 int AK_create_hash_index(char *tblName, struct list_node *attributes, char *indexName) {
-    int i, j, k, l, n, exist, hashValue;
+    AK_header *table_header;
+    AK_header i_header[MAX_ATTRIBUTES];
+    AK_hash_index index;
+    hash_info *info;
+    table_addresses *addresses;
+    AK_block *block;
+    struct list_node *attribute;
+    int i, n, num_attr, address, result = EXIT_SUCCESS;
     AK_PRO;
-    table_addresses *addresses = (table_addresses*) AK_get_table_addresses(tblName);
-    int num_attr = AK_num_attr(tblName);
-    AK_header *table_header = (AK_header *)AK_get_header(tblName);
-
-    AK_header i_header[ MAX_ATTRIBUTES ];
-    AK_header* temp;
 
-    struct list_node *attribute = (struct list_node *) AK_First_L2(attributes);
+    num_attr = AK_num_attr(tblName);
+    table_header = (AK_header *) AK_get_header(tblName);
+    if (table_header == NULL || num_attr <= 0 || num_attr > MAX_ATTRIBUTES) {
+        printf("AK_create_hash_index: Table %s does not exist or has too many attributes!\n", tblName);
+        AK_free(table_header);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    if (AK_get_storage_layout(tblName) != BLOCK_TYPE_NORMAL) {
+        printf("AK_create_hash_index: Table %s has the PAX layout, it can not be indexed!\n", tblName);
+        AK_free(table_header);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    info = (hash_info *) AK_calloc(1, sizeof (hash_info));
+    memset(i_header, 0, sizeof (i_header));
     n = 0;
-    while (attribute != 0) {
-        exist = 0;
+    for (attribute = AK_First_L2(attributes); attribute != NULL; attribute = attribute->next) {
         for (i = 0; i < num_attr; i++) {
-            if (strcmp((table_header + i)->att_name, attribute->data) == 0) {
-				AK_dbg_messg(HIGH, INDICES, "Attribute %s exist in table, found on position: %d\n", (table_header + i)->att_name, i);
-                exist = 1;
-                temp = (AK_header*) AK_create_header((table_header + i)->att_name, (table_header + i)->type, FREE_INT, FREE_CHAR, FREE_CHAR);
-                memcpy(i_header + n, temp, sizeof ( AK_header));
-                n++;
-                if ((table_header + 1)->type != TYPE_VARCHAR && (table_header + 1)->type != TYPE_INT) {
-                    printf("Unsupported data type for hash index! Only int and varchar!");
-                    AK_EPI;
-                    return EXIT_ERROR;
-                }
-            }
+            if (strcmp(table_header[i].att_name, attribute->data) == 0)
+                break;
         }
-        if (!exist) {
-            printf("Atribut %s ne postoji u tablici", attribute->data);
+        if (i == num_attr || n == MAX_ATTRIBUTES) {
+            printf("AK_create_hash_index: Attribute %s does not exist in table %s!\n", attribute->data, tblName);
+            AK_free(info);
+            AK_free(table_header);
             AK_EPI;
             return EXIT_ERROR;
         }
-        attribute = attribute->next;
-    }
-    memset(i_header + n, 0, MAX_ATTRIBUTES - n);
-
-    int startAddress = AK_initialize_new_segment(indexName, SEGMENT_TYPE_INDEX, i_header);
-    if (startAddress != EXIT_ERROR)
-        printf("\nINDEX %s CREATED!\n", indexName);
-
-    AK_block *block = (AK_block*) AK_read_block(startAddress);
-    hash_info *info = (hash_info*) AK_malloc(sizeof (hash_info));
-    info->modulo = 4;
-    info->main_bucket_num = 0;
-    info->hash_bucket_num = 0;
-    memcpy(block->data, info, sizeof (hash_info));
-    block->tuple_dict[0].address = 0;
-    block->tuple_dict[0].type = INFO_BUCKET;
-    block->tuple_dict[0].size = sizeof (hash_info);
-    block->AK_free_space += sizeof (hash_info);
-    block->last_tuple_dict_id = 0;
-    AK_write_block(block);
-
-    struct list_node *temp_elem;
-
-    char data[ MAX_VARCHAR_LENGTH ];
-    struct list_node *row = (struct list_node *) AK_malloc(sizeof (struct list_node));
-    AK_Init_L3(&row);
-    i = 0;
-    n = 0;
-    while (addresses->address_from[ i ]) {
-        for (j = addresses->address_from[ i ]; j < addresses->address_to[ i ]; j++) {
-            AK_block *temp = (AK_block*) AK_read_block(j);
-            for (k = 0; k < DATA_BLOCK_SIZE; k += num_attr) {
-                n++;
-                if (temp->tuple_dict[k].type == FREE_INT)
-                    break;
-                for (l = 0; l < num_attr; l++) {
-                    int type = temp->tuple_dict[ k + l ].type;
-                    int size = temp->tuple_dict[ k + l ].size;
-                    int address = temp->tuple_dict[ k + l ].address;
-                    memcpy(data, &(temp->data[address]), size);
-                    data[ size ] = '\0';
-                    AK_InsertAtEnd_L3(type, data, size, row);
-                }
-                /* *************** */
-                hashValue = 0;
-                attribute = (struct list_node *) AK_First_L2(attributes);
-                while (attribute) {
-
-                    for (l = 0; l < num_attr; l++) {
-                        if (strcmp((table_header + l)->att_name, attribute->data) == 0)
-                            break;
-                    }
-                    temp_elem = AK_GetNth_L2(l, row);
-                    hashValue += AK_elem_hash_value(temp_elem);
-
-                    attribute = attribute->next;
-                }
-                AK_dbg_messg(HIGH, INDICES, "Insert in hash index %d. record\n", n);
-                struct_add *add = (struct_add*) AK_malloc(sizeof (struct_add));
-                add->addBlock = j;
-                add->indexTd = k;
-                AK_insert_in_hash_index(indexName, hashValue, add);
-                AK_DeleteAll_L3(&row);
-                /* *************** */
-            }
-        }
-        i++;
+        memcpy(&i_header[n], &table_header[i], sizeof (AK_header));
+        info->attribute[n] = i;
+        info->type[n] = table_header[i].type;
+        n++;
+    }
+    AK_free(table_header);
+    addresses = AK_get_table_addresses(indexName);
+    address = addresses->address_from[0];
+    AK_free(addresses);
+    if (n == 0 || address != 0) {
+        printf("AK_create_hash_index: Index %s %s!\n", indexName, n == 0 ? "has no attributes" : "already exists");
+        AK_free(info);
+        AK_EPI;
+        return EXIT_ERROR;
     }
+    if (AK_initialize_new_segment(indexName, SEGMENT_TYPE_INDEX, i_header) == EXIT_ERROR) {
+        AK_free(info);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+
+    strncpy(info->name, indexName, MAX_ATT_NAME - 1);
+    strncpy(info->table, tblName, MAX_ATT_NAME - 1);
+    info->num_attr = n;
+    info->table_num_attr = num_attr;
+    info->num_buckets = HASH_INITIAL_BUCKETS;
+    info->num_pages = 1;
+
+    pthread_mutex_lock(&AK_hash_mutex);
+    AK_hash_forget(indexName);
+    addresses = AK_get_table_addresses(indexName);
+    index.name = indexName;
+    index.address = addresses->address_from[0];
+    index.addresses = addresses;
+    index.info = AK_hash_remember(index.address, info);
+    index.dirty = 1;
+    AK_free(info);
+    for (i = 0; i < HASH_INITIAL_BUCKETS && result == EXIT_SUCCESS; i++) {
+        block = AK_hash_new_page(&index);
+        if (block == NULL || AK_hash_directory_set(&index, i, block->address) == EXIT_ERROR)
+            result = EXIT_ERROR;
+        else
+            AK_hash_write(block);
+        AK_free(block);
+    }
+    if (result == EXIT_SUCCESS)
+        result = AK_hash_build(&index, tblName);
+    if (result == EXIT_ERROR)
+        printf("AK_create_hash_index: Index %s could not be built!\n", indexName);
+    AK_hash_close(&index);
+    pthread_mutex_unlock(&AK_hash_mutex);
+    AK_index_catalog_changed();
     AK_EPI;
-    return EXIT_SUCCESS;
+    return result;
 }
 
-void AK_delete_hash_index(char *indexName) {
+/**
+  * @author Mislav Čakarić, updated by Karlo Vuković (linear hashing)
+  * @brief Function that deletes a hash index
+  * @param indexName name of index
+  * @return EXIT_SUCCESS if the index was deleted, EXIT_ERROR if there is no such index
+ */
+int AK_delete_hash_index(char *indexName) {
+    AK_hash_index index;
+    int result = EXIT_ERROR;
     AK_PRO;
-    AK_delete_segment(indexName, SEGMENT_TYPE_INDEX);
-    printf("INDEX %s DELETED!\n", indexName);
+    pthread_mutex_lock(&AK_hash_mutex);
+    if (AK_hash_open(indexName, &index) == EXIT_SUCCESS) {
+        AK_hash_close(&index);
+        AK_hash_forget(indexName);
+        result = AK_delete_segment(indexName, SEGMENT_TYPE_TABLE);
+    }
+    pthread_mutex_unlock(&AK_hash_mutex);
+    AK_index_catalog_changed();
     AK_EPI;
+    return result;
 }
 
 /**
-  * @author Mislav Čakarić
+ * @author Karlo Vuković
+ * @brief Function that reads an integer attribute of a record for the hash index test
+ * @param add address of the record in the table
+ * @param attribute position of the attribute in the table
+ * @return value of the attribute
+ */
+static int AK_hash_test_value(struct_add *add, int attribute) {
+    AK_block *block = ((AK_mem_block *) AK_get_block(add->addBlock))->block;
+    int value;
+
+    memcpy(&value, block->data + block->tuple_dict[add->indexTd + attribute].address, sizeof (int));
+    return value;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that finds a record of the hash index test table by its id
+ * @param indexName name of the index on the id
+ * @param id id
+ * @return 1 if the record with the id was found, 0 otherwise
+ */
+static int AK_hash_test_find(char *indexName, int id) {
+    struct list_node *values = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    struct_add *add;
+    int found;
+
+    AK_Init_L3(&values);
+    AK_InsertAtEnd_L3(TYPE_INT, (char *) &id, sizeof (int), values);
+    add = AK_find_in_hash_index(indexName, values);
+    found = add->addBlock != 0 && AK_hash_test_value(add, 0) == id;
+    AK_free(add);
+    AK_DeleteAll_L3(&values);
+    AK_free(values);
+    return found;
+}
+
+/**
+  * @author Mislav Čakarić, updated by Karlo Vuković (linear hashing)
   * @brief Function that tests hash index
-  * @return No return value 
+  * @return TestResult
  */
 TestResult AK_hash_test() {
-    int passedTest = 0;
-    int failedTest = 0;
-    char *tblName = "student";
-    char *indexName = "student_hash_index";
-    //AK_print_table("AK_relation");
+    char *tblName = "hash_test";
+    char *indexes[2] = {"hash_test_id", "hash_test_group"};
+    int num_rows = 5000, num_groups = 50;
+    int passed_tests = 0, failed_tests = 0;
+    int i, id, grp, students, wrong, count, buckets;
+    char name[MAX_VARCHAR_LENGTH];
+    struct list_node **rows;
+    struct list_node *att_list, *row, *values, *element;
+    struct_add *add, adds[128];
+    hash_info *info;
     AK_PRO;
-    struct list_node *att_list = (struct list_node *) AK_malloc(sizeof (struct list_node));
+
+    printf("\n********** HASH INDEX TEST **********\n\n");
+
+    //index on (mbr, firstname) of the student table finds every student
+    AK_delete_hash_index("student_hash_index");
+    att_list = (struct list_node *) AK_malloc(sizeof (struct list_node));
     AK_Init_L3(&att_list);
-    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "mbr\0", 4, att_list);
-    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "firstname\0", 10, att_list);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "mbr", 4, att_list);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "firstname", 10, att_list);
+    values = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    AK_Init_L3(&values);
+    wrong = 0;
+    students = 0;
+    if (AK_create_hash_index("student", att_list, "student_hash_index") == EXIT_SUCCESS &&
+        AK_create_hash_index("student", att_list, "student_hash_index") == EXIT_ERROR) {
+        while ((row = (struct list_node *) AK_get_row(students, "student")) != NULL) {
+            element = AK_First_L2(row);
+            AK_InsertAtEnd_L3(element->type, element->data, element->size, values);
+            element = AK_Next_L2(element);
+            AK_InsertAtEnd_L3(element->type, element->data, element->size, values);
+            add = AK_find_in_hash_index("student_hash_index", values);
+            if (add->addBlock == 0 || AK_hash_test_value(add, 0) != *(int *) AK_First_L2(values)->data)
+                wrong++;
+            AK_free(add);
+            AK_DeleteAll_L3(&values);
+            AK_DeleteAll_L3(&row);
+            AK_free(row);
+            students++;
+        }
+    } else
+        wrong++;
+    AK_DeleteAll_L3(&att_list);
+    info = AK_get_hash_info("student_hash_index");
+    if (wrong == 0 && students > 0 && info != NULL && info->num_entries == students) {
+        printf("Index on student (mbr, firstname) finds all %d students\n", students);
+        passed_tests++;
+    } else {
+        printf("Index on student (mbr, firstname) does not find %d of %d students\n", wrong, students);
+        failed_tests++;
+    }
+    AK_free(info);
+
+    AK_header t_header[4] = {
+        {TYPE_INT, "id", {0}, {{'\0'}}, {{'\0'}}},
+        {TYPE_VARCHAR, "name", {0}, {{'\0'}}, {{'\0'}}},
+        {TYPE_INT, "grp", {0}, {{'\0'}}, {{'\0'}}},
+        {0, {'\0'}, {0}, {{'\0'}}, {{'\0'}}}};
 
-    if(AK_create_hash_index(tblName, att_list, indexName) == EXIT_ERROR){
-    	failedTest++;
+    for (i = 0; i < 2; i++)
+        AK_delete_hash_index(indexes[i]);
+    if (AK_num_attr(tblName) > 0)
+        AK_delete_segment(tblName, SEGMENT_TYPE_TABLE);
+    if (AK_initialize_new_segment(tblName, SEGMENT_TYPE_TABLE, t_header) == EXIT_ERROR) {
+        printf("Could not create table %s\n", tblName);
+        AK_free(att_list);
+        AK_free(values);
+        AK_EPI;
+        return TEST_result(passed_tests, failed_tests + 1);
     }
-    else{
-    	passedTest++;
+    rows = (struct list_node **) AK_calloc(2 * num_rows, sizeof (struct list_node *));
+    for (i = 0; i < 2 * num_rows; i++) {
+        id = i;
+        grp = i % num_groups;
+        snprintf(name, MAX_VARCHAR_LENGTH, "name%d", i);
+        rows[i] = (struct list_node *) AK_malloc(sizeof (struct list_node));
+        AK_Init_L3(&rows[i]);
+        AK_Insert_New_Element(TYPE_INT, &id, tblName, "id", rows[i]);
+        AK_Insert_New_Element(TYPE_VARCHAR, name, tblName, "name", rows[i]);
+        AK_Insert_New_Element(TYPE_INT, &grp, tblName, "grp", rows[i]);
     }
+    AK_bulk_insert(tblName, rows, num_rows);
 
-    struct list_node *values = (struct list_node *) AK_malloc(sizeof (struct list_node));
-    struct list_node *row = (struct list_node *) AK_malloc(sizeof (struct list_node));
-    AK_Init_L3(&values);
+    //the index grows past its first buckets while it is built and finds every id
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "id", 3, att_list);
+    AK_create_hash_index(tblName, att_list, indexes[0]);
+    AK_DeleteAll_L3(&att_list);
+    info = AK_get_hash_info(indexes[0]);
+    wrong = 0;
+    for (id = 0; id < num_rows; id++) {
+        if (!AK_hash_test_find(indexes[0], id))
+            wrong++;
+    }
+    if (info != NULL && info->num_entries == num_rows && info->level > 0 && info->num_buckets > HASH_INITIAL_BUCKETS &&
+        wrong == 0 && !AK_hash_test_find(indexes[0], 2 * num_rows)) {
+        printf("Index on id has %d buckets on level %d and finds all %d ids\n", info->num_buckets, info->level, num_rows);
+        passed_tests++;
+    } else {
+        printf("Index on id does not find %d of %d ids\n", wrong, num_rows);
+        failed_tests++;
+    }
+    buckets = info != NULL ? info->num_buckets : 0;
+    AK_free(info);
 
-    //AK_delete_hash_index(indexName);
-
-    hash_info *info = (hash_info*) AK_malloc(sizeof (hash_info));
-    info = AK_get_hash_info(indexName);
-    if(info == NULL){
-    	failedTest++;
-    }
-    else{
-    	passedTest++;
-    }
-    printf("Main buckets:%d, Hash buckets:%d, Modulo:%d\n", info->main_bucket_num, info->hash_bucket_num, info->modulo);
-
-    //AK_delete_hash_index(indexName);
-    AK_print_table("AK_relation");
-    AK_print_table("AK_index");
-
-    printf("Hash index search test:\n");
-    int i, num_rec = AK_get_num_records(tblName);
-    for (i = 0; i < num_rec; i++) {
-        row = AK_get_row(i, tblName);
-        struct list_node *value = AK_GetNth_L2(1, row);
-        AK_InsertAtEnd_L3(value->type, value->data, value->size, values);
-        value = AK_GetNth_L2(1, row);
-        AK_InsertAtEnd_L3(value->type, value->data, value->size, values);
-        struct_add *add = AK_find_in_hash_index(indexName, values);
-        if(add->addBlock == NULL){
-    		failedTest++;
-    	}
-    	else{
-    		passedTest++;
-    	}
+    //an index on a value shared by many rows finds all of them
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "grp", 4, att_list);
+    AK_create_hash_index(tblName, att_list, indexes[1]);
+    AK_DeleteAll_L3(&att_list);
+    grp = 7;
+    AK_InsertAtEnd_L3(TYPE_INT, (char *) &grp, sizeof (int), values);
+    count = AK_search_hash_index(indexes[1], values, adds, 128);
+    AK_DeleteAll_L3(&values);
+    wrong = 0;
+    for (i = 0; i < count && i < 128; i++) {
+        if (AK_hash_test_value(&adds[i], 2) != grp)
+            wrong++;
+    }
+    if (count == num_rows / num_groups && wrong == 0) {
+        printf("Index on grp finds all %d rows of a group\n", count);
+        passed_tests++;
+    } else {
+        printf("Index on grp finds %d rows of a group, %d of them from another group\n", count, wrong);
+        failed_tests++;
+    }
+
+    //deleted records are no longer found
+    for (id = 0; id < 100; id++) {
+        AK_InsertAtEnd_L3(TYPE_INT, (char *) &id, sizeof (int), values);
+        AK_delete_in_hash_index(indexes[0], values);
         AK_DeleteAll_L3(&values);
-        if (add->addBlock && add->indexTd)
-            printf("Record found in table block %d and TupleDict ID %d\n", add->addBlock, add->indexTd);
     }
-    printf("hash_test: Present!\n");
+    info = AK_get_hash_info(indexes[0]);
+    wrong = 0;
+    for (id = 0; id < 200; id++) {
+        if (AK_hash_test_find(indexes[0], id) != (id >= 100))
+            wrong++;
+    }
+    if (info != NULL && info->num_entries == num_rows - 100 && wrong == 0) {
+        printf("Index on id no longer finds 100 deleted ids\n");
+        passed_tests++;
+    } else {
+        printf("Index on id finds %d ids wrong after deletes\n", wrong);
+        failed_tests++;
+    }
+    AK_free(info);
+
+    //rows loaded later are added to the index by the load and make it grow without rebuilding it
+    AK_bulk_insert(tblName, rows + num_rows, num_rows);
+    info = AK_get_hash_info(indexes[0]);
+    count = info != NULL ? info->num_entries - (num_rows - 100) : 0;
+    wrong = 0;
+    for (id = num_rows; id < 2 * num_rows; id += 7) {
+        if (!AK_hash_test_find(indexes[0], id))
+            wrong++;
+    }
+    if (count == num_rows && info != NULL && info->num_entries == 2 * num_rows - 100 && info->num_buckets > buckets &&
+        wrong == 0 && AK_hash_test_find(indexes[0], num_rows - 1)) {
+        printf("Index on id grows from %d to %d buckets with %d new rows\n", buckets, info->num_buckets, count);
+        passed_tests++;
+    } else {
+        printf("Index on id does not find %d new rows\n", wrong);
+        failed_tests++;
+    }
+    AK_free(info);
+
+    //deleted indices are gone
+    for (i = 0; i < 2; i++)
+        AK_delete_hash_index(indexes[i]);
+    info = AK_get_hash_info(indexes[0]);
+    if (info == NULL && AK_search_hash_index(indexes[1], values, NULL, 0) == EXIT_ERROR) {
+        printf("Deleted indices are not found\n");
+        passed_tests++;
+    } else {
+        printf("Deleted index is still found\n");
+        failed_tests++;
+    }
+    AK_free(info);
+
+    for (i = 0; i < 2 * num_rows; i++) {
+        AK_DeleteAll_L3(&rows[i]);
+        AK_free(rows[i]);
+    }
+    AK_free(rows);
+    AK_delete_segment(tblName, SEGMENT_TYPE_TABLE);
+    AK_free(att_list);
+    AK_free(values);
     AK_EPI;
-    return TEST_result(passedTest,failedTest);
+    return TEST_result(passed_tests, failed_tests);
 }
@@ -27,19 +27,44 @@
 #include "../../auxi/configuration.h"
 #include "../files.h"
 #include "../../auxi/mempro.h"
+#include "../../auxi/compare.h"
+#include <pthread.h>
 
 /**
- * @author Unknown
+ * @author Unknown, updated by Karlo Vuković (linear hashing)
  * @struct hash_info
- * @brief Structure for defining a hash info element
-*/
+ * @brief Structure at the start of the first block of a hash index. The index uses linear hashing: the bucket of a
+ *        hash value is given by its lowest bits, and buckets are split one at a time, in the order of their numbers,
+ *        whenever the index gets too full, so it grows without being rebuilt. Other blocks of the index segment are
+ *        pages, numbered in the order of the extents, and the first num_pages blocks are in use.
+ */
 typedef struct {
-	/// modulo value for hash function
-    int modulo;
-    /// bucket number
-    int main_bucket_num;
-    /// hash bucket number
-    int hash_bucket_num;
+    /// name of the index
+    char name[MAX_ATT_NAME];
+    /// name of the indexed table
+    char table[MAX_ATT_NAME];
+    /// number of indexed attributes
+    int num_attr;
+    /// number of attributes of the table
+    int table_num_attr;
+    /// positions of the indexed attributes in the table
+    int attribute[MAX_ATTRIBUTES];
+    /// types of the indexed attributes
+    int type[MAX_ATTRIBUTES];
+    /// number of times the number of buckets was doubled
+    int level;
+    /// next bucket to be split
+    int split;
+    /// number of buckets
+    int num_buckets;
+    /// number of entries in buckets
+    int num_entries;
+    /// number of blocks of the segment in use, together with this one
+    int num_pages;
+    /// first page freed by a split, free pages are chained through hash_bucket.next, 0 if there are none
+    int free_list;
+    /// addresses of the directory pages, which hold the addresses of the first pages of buckets
+    int directory[HASH_DIRECTORY_PAGES];
 } hash_info;
 
 /**
@@ -55,101 +80,93 @@ typedef struct {
 } bucket_elem;
 
 /**
- * @author Unknown
- * @struct main_bucket
- * @brief Structure for defining main bucket for table hashing
- */
-typedef struct {
-	/// main bucket array of bucket_elem elements
-    bucket_elem element[MAIN_BUCKET_SIZE];
-} main_bucket;
-
-/**
- * @author Unknown
+ * @author Unknown, updated by Karlo Vuković (linear hashing)
  * @struct hash_bucket
- * @brief Structure for hash bucket for table hashing
+ * @brief Structure at the start of the data area of a bucket page, HASH_BUCKET_ELEMENTS bucket elements follow it.
+ *        A bucket with more elements than fit into one page continues in overflow pages.
  */
 typedef struct {
-	/// hash bucket level
-    int bucket_level;
-    /// hash bucket array of bucket_elem elements
-    bucket_elem element[HASH_BUCKET_SIZE];
+    /// next page of the bucket, 0 for the last one
+    int next;
+    /// number of elements in the page
+    int num_elements;
 } hash_bucket;
 
 /**
-  * @author Mislav Čakarić
-  * @brief Function that computes a hash value from varchar or integer
-  * @param elem element of row for wich value is to be computed
-  * @return hash value
- 
+ * @def HASH_BUCKET_ELEMENTS
+ * @brief Constant declaring how many bucket elements fit into one bucket page
  */
-int AK_elem_hash_value(struct list_node *elem);
+#define HASH_BUCKET_ELEMENTS ((DATA_BLOCK_SIZE * DATA_ENTRY_SIZE - (int) sizeof (hash_bucket)) / (int) sizeof (bucket_elem))
 
 /**
-  * @author Mislav Čakarić
-  * @brief Function that inserts a bucket to block
-  * @param indexName name of index
-  * @param data content of bucket stored in char array
-  * @param type type of bucket (MAIN_BUCKET or HASH_BUCKET)
-  * @return address structure with data where the bucket is stored 
+  * @author Mislav Čakarić, updated by Karlo Vuković (64-bit hash)
+  * @brief Function that computes a hash value of a value of any type, the lower half of AK_hash_value64 folded
+  *        with its upper half
+  * @param elem element of row for wich value is to be computed
+  * @return hash value
  */
-struct_add* AK_insert_bucket_to_block(char *indexName, char *data, int type);
+unsigned int AK_elem_hash_value(struct list_node *elem);
 
 /**
-  *  @author Mislav Čakarić
-  *  @brief Function that updates a bucket in block
-  *  @param add address of where the bucket is stored
-  *  @param data content of bucket stored in char array
-  *  @return No return value
+  * @author Karlo Vuković
+  * @brief Function that computes a hash value of a list of values, each value is hashed with the hash of the values
+  *        before it as the seed
+  * @param values list of values in the order of the indexed attributes
+  * @return hash value
  */
-void AK_update_bucket_in_block(struct_add *add, char *data);
+unsigned int AK_values_hash_value(struct list_node *values);
 
 /**
-  * @author Mislav Čakarić
-  * @brief Function that changes a info of hash index
+  * @author Mislav Čakarić, updated by Karlo Vuković (cached hash_info)
+  * @brief Function that fetches the info for hash index. Indices that were opened lately keep their info in memory,
+  *        others are found in the system catalog.
   * @param indexName name of index
-  * @param modulo value for modulo hash function
-  * @param main_bucket_num number of main buckets
-  * @param hash_bucket_num number of hash buckets
-  * @return No return value
+  * @return copy of the info of the index, NULL if there is no such index
  */
-void AK_change_hash_info(char *indexName, int modulo, int main_bucket_num, int hash_bucket_num);
+hash_info* AK_get_hash_info(char *indexName);
 
 /**
-  * @author Mislav Čakarić
-  * @brief Function that fetches the info for hash index
-  * @param indexName name of index
-  * @return info bucket with info data for hash index
+  *  @author Mislav Čakarić, updated by Karlo Vuković (linear hashing)
+  *  @brief Function that inserts a record in hash index. When the buckets get more than HASH_SPLIT_PERCENT full
+  *         on average, the next bucket is split in two and its elements are moved between them.
+  *  @param indexName name of index
+  *  @param hashValue hash value of record that is being inserted
+  *  @param add address of the record in the table
+  *  @return EXIT_SUCCESS if the record is in the index, EXIT_ERROR otherwise
  */
-hash_info* AK_get_hash_info(char *indexName);
+int AK_insert_in_hash_index(char *indexName, unsigned int hashValue, struct_add *add);
 
 /**
-  * @author Mislav Čakarić
-  * @brief Function that fetches nth main bucket
+  * @author Karlo Vuković
+  * @brief Function that removes a record from hash index by its hash value and address, without reading the record
   * @param indexName name of index
-  * @param n number of main bucket
-  * @return address structure with data where the bucket is stored
+  * @param hashValue hash value of the record
+  * @param add address of the record in the table
+  * @return EXIT_SUCCESS if the record was removed, EXIT_ERROR if it is not in the index
  */
-struct_add* AK_get_nth_main_bucket_add(char *indexName, int n);
+int AK_remove_from_hash_index(char *indexName, unsigned int hashValue, struct_add *add);
 
 /**
-  *  @author Mislav Čakarić
-  *  @brief Function that inserts a record in hash bucket
-  *  @param indexName name of index
-  *  @param hashValue hash value of record that is being inserted
-  *  @param add address structure with data where the hash bucket is stored
-  *  @return No return value
+  * @author Karlo Vuković
+  * @brief Function that applies changes of rows of the indexed table to a hash index. Changes are sorted by their
+  *        buckets first, so changes of a bucket are made one after another, and a removal and an insert of the same
+  *        element, made by an update that did not change the indexed values, cancel each other out. Rows with a null
+  *        are not indexed.
+  * @param indexName name of index
+  * @param deltas changes of rows of the table
+  * @param num_deltas number of changes
+  * @return EXIT_SUCCESS, EXIT_ERROR if there is no such index or it could not be extended
  */
-void AK_insert_in_hash_index(char *indexName, int hashValue, struct_add *add);
+int AK_hash_apply(char *indexName, AK_index_delta *deltas, int num_deltas);
 
 /**
-  * @author Mislav Čakarić
-  * @brief Function that fetches or deletes a record from hash index
+  * @author Mislav Čakarić, updated by Karlo Vuković (linear hashing)
+  * @brief Function that fetches or deletes a record from hash index. Records with the hash value of the values are
+  *        read from the table and compared with the values.
   * @param indexName name of index
   * @param values list of values (one row) to search in hash index
   * @param delete if delete is 0 then record is only read otherwise it's deleted from hash index
-  * @return address structure with data where the record is in table
- 
+  * @return address structure with data where the record is in table, with zeros if there is no such record
  */
 struct_add *AK_find_delete_in_hash_index(char *indexName, struct list_node *values, int delete);
 
@@ -174,21 +191,39 @@ struct_add * AK_find_in_hash_index(char *indexName, struct list_node *values);
 void AK_delete_in_hash_index(char *indexName, struct list_node *values);
 
 /**
-  * @author Mislav Čakarić
-  * @brief Function that creates a hash index
-  * @param tblName name of table for which the index is being created
+  * @author Karlo Vuković
+  * @brief Function that finds all records with values in hash index
   * @param indexName name of index
+  * @param values list of values in the order of the indexed attributes
+  * @param adds array for the addresses of the records in the table, may be NULL
+  * @param max_adds size of the array
+  * @return number of records with the values, it can be larger than max_adds, EXIT_ERROR if there is no such index
+ */
+int AK_search_hash_index(char *indexName, struct list_node *values, struct_add *adds, int max_adds);
+
+/**
+  * @author Mislav Čakarić, updated by Karlo Vuković (linear hashing)
+  * @brief Function that creates a hash index. Attributes can be of any type, rows with a null or a value of another
+  *        type than the attribute are not indexed. Tables with the PAX layout can not be indexed.
+  * @param tblName name of table for which the index is being created
   * @param attributes list of attributes over which the index is being created
-  * @return success or error
- 
+  * @param indexName name of index
+  * @return EXIT_SUCCESS if the index was created, EXIT_ERROR otherwise
  */
 int AK_create_hash_index(char *tblName, struct list_node *attributes, char *indexName);
-void AK_delete_hash_index(char *indexName) ;
 
 /**
-  * @author Mislav Čakarić
+  * @author Mislav Čakarić, updated by Karlo Vuković (linear hashing)
+  * @brief Function that deletes a hash index
+  * @param indexName name of index
+  * @return EXIT_SUCCESS if the index was deleted, EXIT_ERROR if there is no such index
+ */
+int AK_delete_hash_index(char *indexName);
+
+/**
+  * @author Mislav Čakarić, updated by Karlo Vuković (linear hashing)
   * @brief Function that tests hash index
-  * @return No return value 
+  * @return TestResult
  */
 TestResult AK_hash_test();
 
@@ -24,6 +24,10 @@
 #include "../../file/table.h"
 #include "../../file/fileio.h"
 #include "../../file/files.h"
+#include "btree.h"
+#include "hash.h"
+#include "bitmap.h"
+#include "trigram.h"
 
 /**
  * @author Unknown
@@ -558,6 +562,414 @@ void AK_print_index_table(char *indexTblName) {
 }
 
 
+/**
+ * @author Karlo Vuković
+ * @struct AK_index_known
+ * @brief Structure that describes an index segment found in AK_relation
+ */
+typedef struct {
+    /// name of the indexed table
+    char table[MAX_ATT_NAME];
+    /// description of the index, without the number of rows
+    AK_index_description index;
+} AK_index_known;
+
+/// the catalog of indices is read and rebuilt by one thread at a time
+static pthread_mutex_t AK_index_mutex = PTHREAD_MUTEX_INITIALIZER;
+/// index segments of all tables, found in AK_relation
+static AK_index_known *AK_index_catalog = NULL;
+/// number of index segments in the catalog
+static int AK_index_catalog_size = 0;
+/// 1 if the catalog was built and no index was created or deleted since
+static int AK_index_catalog_valid = 0;
+/// tuple dictionary of AK_relation when the catalog was built, segments added or removed since change it
+static AK_tuple_dict AK_index_catalog_relation[DATA_BLOCK_SIZE];
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that tells the index catalog that an index was created or deleted, so indices of tables are
+ *        found again in AK_relation
+ * @return No return value
+ */
+void AK_index_catalog_changed() {
+    AK_PRO;
+    pthread_mutex_lock(&AK_index_mutex);
+    AK_index_catalog_valid = 0;
+    pthread_mutex_unlock(&AK_index_mutex);
+    AK_EPI;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that reads the description of an index segment from its first block. The description is read
+ *        from the block itself, without the locks of the index, because the catalog can be rebuilt while an index
+ *        is being extended.
+ * @param block first block of the segment
+ * @param known description of the index
+ * @return 1 if the segment is a B+tree, hash, bitmap or trigram index, 0 otherwise
+ */
+static int AK_index_read_known(AK_block *block, AK_index_known *known) {
+    AK_btree_meta *meta;
+    hash_info *hash;
+    AK_bitmap_info *bitmap;
+    AK_trigram_info *trigram;
+    int i;
+
+    memset(known, 0, sizeof (AK_index_known));
+    known->index.kind = block->type;
+    if (block->type == BLOCK_TYPE_BTREE) {
+        meta = (AK_btree_meta *) block->data;
+        strncpy(known->table, meta->table, MAX_ATT_NAME - 1);
+        strncpy(known->index.name, meta->name, MAX_ATT_NAME - 1);
+        known->index.num_attr = meta->num_keys > 1 ? meta->num_keys : 1;
+        known->index.attribute[0] = meta->position;
+        for (i = 1; i < meta->num_keys && i < BTREE_MAX_KEYS; i++)
+            known->index.attribute[i] = meta->keys[i];
+        known->index.num_included = meta->num_included;
+        for (i = 0; i < meta->num_included && i < BTREE_MAX_INCLUDED; i++)
+            known->index.included[i] = meta->included[i];
+        return 1;
+    }
+    if (block->type == BLOCK_TYPE_HASH) {
+        hash = (hash_info *) block->data;
+        strncpy(known->table, hash->table, MAX_ATT_NAME - 1);
+        strncpy(known->index.name, hash->name, MAX_ATT_NAME - 1);
+        known->index.num_attr = hash->num_attr;
+        for (i = 0; i < hash->num_attr && i < MAX_ATTRIBUTES; i++)
+            known->index.attribute[i] = hash->attribute[i];
+        return hash->num_attr > 0;
+    }
+    if (block->type == BLOCK_TYPE_BITMAP) {
+        bitmap = (AK_bitmap_info *) block->data;
+        strncpy(known->table, bitmap->table, MAX_ATT_NAME - 1);
+        strncpy(known->index.name, bitmap->name, MAX_ATT_NAME - 1);
+        known->index.num_attr = 1;
+        known->index.attribute[0] = bitmap->position;
+        return 1;
+    }
+    if (block->type == BLOCK_TYPE_TRIGRAM) {
+        trigram = (AK_trigram_info *) block->data;
+        strncpy(known->table, trigram->table, MAX_ATT_NAME - 1);
+        strncpy(known->index.name, trigram->name, MAX_ATT_NAME - 1);
+        known->index.num_attr = 1;
+        known->index.attribute[0] = trigram->position;
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that builds the catalog of index segments from AK_relation. Rows of AK_relation are (obj_id,
+ *        name, start_address, end_address), one for every extent, and the first block of every segment tells if
+ *        it is an index.
+ * @param relation copy of the block of AK_relation
+ * @return No return value
+ */
+static void AK_index_catalog_build(AK_block *relation) {
+    AK_tuple_dict *dict;
+    AK_index_known known;
+    char name[MAX_ATT_NAME];
+    int i, j, address, max_size = 0;
+
+    AK_index_catalog_size = 0;
+    for (i = 0; i + 3 < DATA_BLOCK_SIZE && relation->tuple_dict[i].type != FREE_INT; i += 4) {
+        dict = &relation->tuple_dict[i + 1];
+        if (dict->size <= 0 || dict->size >= MAX_ATT_NAME || relation->tuple_dict[i + 2].size != sizeof (int))
+            continue;
+        memcpy(name, relation->data + dict->address, dict->size);
+        name[dict->size] = '\0';
+        memcpy(&address, relation->data + relation->tuple_dict[i + 2].address, sizeof (int));
+        for (j = 0; j < AK_index_catalog_size && strcmp(AK_index_catalog[j].index.name, name) != 0; j++)
+            ;
+        if (j < AK_index_catalog_size || address <= 0 ||
+            !AK_index_read_known(((AK_mem_block *) AK_get_block(address))->block, &known) ||
+            strcmp(known.index.name, name) != 0)
+            continue;
+        if (AK_index_catalog_size == max_size) {
+            max_size = max_size > 0 ? 2 * max_size : 16;
+            AK_index_catalog = (AK_index_known *) AK_realloc(AK_index_catalog, max_size * sizeof (AK_index_known));
+        }
+        memcpy(&AK_index_catalog[AK_index_catalog_size++], &known, sizeof (AK_index_known));
+    }
+    memcpy(AK_index_catalog_relation, relation->tuple_dict, sizeof (AK_index_catalog_relation));
+    AK_index_catalog_valid = 1;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that finds the indices of a table in the catalog of index segments. The catalog is rebuilt when
+ *        an index was created or deleted, or when segments were added to AK_relation or removed from it.
+ * @param tblName table name
+ * @param indexes array for the descriptions of the indices, without the numbers of rows
+ * @param max_indexes size of the array
+ * @return number of indices of the table, at most max_indexes
+ */
+static int AK_index_find(char *tblName, AK_index_description *indexes, int max_indexes) {
+    AK_block *relation = (AK_block *) AK_malloc(sizeof (AK_block));
+    int i, count = 0;
+
+    memcpy(relation, ((AK_mem_block *) AK_get_block(AK_get_system_table_address("AK_relation")))->block, sizeof (AK_block));
+    pthread_mutex_lock(&AK_index_mutex);
+    if (!AK_index_catalog_valid || memcmp(AK_index_catalog_relation, relation->tuple_dict, sizeof (AK_index_catalog_relation)) != 0)
+        AK_index_catalog_build(relation);
+    for (i = 0; i < AK_index_catalog_size && count < max_indexes; i++) {
+        if (strcmp(AK_index_catalog[i].table, tblName) == 0)
+            memcpy(&indexes[count++], &AK_index_catalog[i].index, sizeof (AK_index_description));
+    }
+    pthread_mutex_unlock(&AK_index_mutex);
+    AK_free(relation);
+    return count;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that finds the B+tree, hash, bitmap and trigram indices of a table. Index segments are registered in
+ *        AK_relation like tables, so the first block of every segment tells if it is an index, and the description
+ *        in that block tells which table it belongs to. Segments are looked at once and kept in a catalog until
+ *        AK_relation or the indices change.
+ * @param tblName table name
+ * @param indexes array for the descriptions of the indices
+ * @param max_indexes size of the array
+ * @return number of indices of the table, at most max_indexes
+ */
+int AK_index_get_descriptions(char *tblName, AK_index_description *indexes, int max_indexes) {
+    AK_btree_meta meta;
+    AK_bitmap_info bitmap;
+    AK_trigram_info trigram;
+    hash_info *hash;
+    int i, count;
+    AK_PRO;
+
+    count = AK_index_find(tblName, indexes, max_indexes);
+    for (i = 0; i < count; i++) {
+        if (indexes[i].kind == BLOCK_TYPE_BTREE && AK_btree_get_meta(indexes[i].name, &meta) == EXIT_SUCCESS)
+            indexes[i].num_rows = meta.num_entries;
+        else if (indexes[i].kind == BLOCK_TYPE_HASH && (hash = AK_get_hash_info(indexes[i].name)) != NULL) {
+            indexes[i].num_rows = hash->num_entries;
+            AK_free(hash);
+        } else if (indexes[i].kind == BLOCK_TYPE_BITMAP && AK_bitmap_get_info(indexes[i].name, &bitmap) == EXIT_SUCCESS)
+            indexes[i].num_rows = bitmap.num_rows;
+        else if (indexes[i].kind == BLOCK_TYPE_TRIGRAM && AK_trigram_get_info(indexes[i].name, &trigram) == EXIT_SUCCESS)
+            indexes[i].num_rows = trigram.num_rows;
+    }
+    AK_EPI;
+    return count;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that starts a batch of changes of rows of a table. A table without indices gets an empty batch,
+ *        which ignores rows added to it.
+ * @param batch batch
+ * @param tblName table name
+ * @return number of indices of the table
+ */
+int AK_index_batch_begin(AK_index_batch *batch, char *tblName) {
+    AK_PRO;
+    memset(batch->table, '\0', MAX_ATT_NAME);
+    strncpy(batch->table, tblName, MAX_ATT_NAME - 1);
+    batch->num_attr = 0;
+    batch->deltas = NULL;
+    batch->num_deltas = 0;
+    batch->max_deltas = 0;
+    batch->images = NULL;
+    batch->images_size = 0;
+    batch->max_images = 0;
+    batch->num_indexes = AK_index_find(tblName, batch->indexes, INDEX_MAX_PER_TABLE);
+    if (batch->num_indexes > 0)
+        batch->num_attr = AK_num_attr(tblName);
+    if (batch->num_attr <= 0 || batch->num_attr > MAX_ATTRIBUTES)
+        batch->num_indexes = 0;
+    AK_EPI;
+    return batch->num_indexes;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that checks if a row of a block is there and not deleted
+ * @param block block
+ * @param row first entry of the row in the tuple dictionary
+ * @param num_attr number of attributes of the table
+ * @return 1 if the row is there, 0 otherwise
+ */
+static int AK_index_row_exists(AK_block *block, int row, int num_attr) {
+    int i;
+
+    if (row < 0 || row + num_attr > DATA_BLOCK_SIZE || block->tuple_dict[row].type == FREE_INT)
+        return 0;
+    for (i = 0; i < num_attr; i++) {
+        if (block->tuple_dict[row + i].size > 0 || block->tuple_dict[row + i].type != TYPE_INTERNAL)
+            return 1;
+    }
+    return 0;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that adds a copy of a row to the batch without the profiler, for loops over many rows
+ * @param batch batch
+ * @param block block with the row
+ * @param address address of the block
+ * @param row first entry of the row in the tuple dictionary
+ * @param insert 1 if the row was added to the table, 0 if it was removed
+ * @return No return value
+ */
+static void AK_index_batch_copy(AK_index_batch *batch, AK_block *block, int address, int row, int insert) {
+    AK_tuple_dict *entries;
+    AK_index_delta *delta;
+    char *data;
+    int i, size = 0, needed, offset = 0;
+
+    for (i = 0; i < batch->num_attr; i++) {
+        if (block->tuple_dict[row + i].size > 0 && block->tuple_dict[row + i].size <= MAX_VARCHAR_LENGTH)
+            size += block->tuple_dict[row + i].size;
+    }
+    //copies are aligned, so their entries can be read in place
+    needed = (batch->num_attr * (int) sizeof (AK_tuple_dict) + size + 7) / 8 * 8;
+    if (batch->images_size + needed > batch->max_images) {
+        batch->max_images = 2 * batch->max_images > batch->images_size + needed ? 2 * batch->max_images :
+                            batch->images_size + needed + DATA_BLOCK_SIZE * DATA_ENTRY_SIZE;
+        batch->images = (char *) AK_realloc(batch->images, batch->max_images);
+    }
+    if (batch->num_deltas == batch->max_deltas) {
+        batch->max_deltas = batch->max_deltas > 0 ? 2 * batch->max_deltas : 64;
+        batch->deltas = (AK_index_delta *) AK_realloc(batch->deltas, batch->max_deltas * sizeof (AK_index_delta));
+    }
+    delta = &batch->deltas[batch->num_deltas++];
+    delta->insert = insert;
+    delta->add.addBlock = address;
+    delta->add.indexTd = row;
+    delta->image = batch->images_size;
+    delta->entries = NULL;
+    delta->data = NULL;
+
+    entries = (AK_tuple_dict *) (batch->images + batch->images_size);
+    data = (char *) (entries + batch->num_attr);
+    for (i = 0; i < batch->num_attr; i++) {
+        memcpy(&entries[i], &block->tuple_dict[row + i], sizeof (AK_tuple_dict));
+        entries[i].address = offset;
+        if (entries[i].size > 0 && entries[i].size <= MAX_VARCHAR_LENGTH) {
+            memcpy(data + offset, block->data + block->tuple_dict[row + i].address, entries[i].size);
+            offset += entries[i].size;
+        }
+    }
+    batch->images_size += needed;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that adds a copy of a row to the batch. Only rows of blocks that indices cover, with the normal
+ *        layout, are added.
+ * @param batch batch
+ * @param block block with the row
+ * @param address address of the block
+ * @param row first entry of the row in the tuple dictionary
+ * @param insert 1 if the row was added to the table, 0 if it was removed
+ * @return No return value
+ */
+void AK_index_batch_add(AK_index_batch *batch, AK_block *block, int address, int row, int insert) {
+    AK_PRO;
+    if (batch->num_indexes > 0 && (block->type == BLOCK_TYPE_NORMAL || block->type == BLOCK_TYPE_CHAINED) &&
+        row % batch->num_attr == 0 && AK_index_row_exists(block, row, batch->num_attr))
+        AK_index_batch_copy(batch, block, address, row, insert);
+    AK_EPI;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that checks if a row has the same entries and values in two versions of a block
+ * @param before first version of the block
+ * @param after second version of the block
+ * @param row first entry of the row in the tuple dictionary
+ * @param num_attr number of attributes of the table
+ * @return 1 if the row is the same, 0 otherwise
+ */
+static int AK_index_row_same(AK_block *before, AK_block *after, int row, int num_attr) {
+    AK_tuple_dict *old, *new;
+    int i;
+
+    for (i = row; i < row + num_attr; i++) {
+        old = &before->tuple_dict[i];
+        new = &after->tuple_dict[i];
+        if (old->type != new->type || old->size != new->size)
+            return 0;
+        if (old->size > 0 && old->size <= MAX_VARCHAR_LENGTH &&
+            memcmp(before->data + old->address, after->data + new->address, old->size) != 0)
+            return 0;
+    }
+    return 1;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that compares two versions of a block and adds rows that were deleted or changed between them to
+ *        the batch. A changed row is removed with its old values and added with its new ones. Rows that are only in
+ *        the new version were added by AK_insert_row, which keeps indices up to date itself.
+ * @param batch batch
+ * @param before copy of the block before the change
+ * @param after block after the change
+ * @return No return value
+ */
+void AK_index_batch_add_changes(AK_index_batch *batch, AK_block *before, AK_block *after) {
+    int row;
+    AK_PRO;
+    if (batch->num_indexes == 0 || (before->type != BLOCK_TYPE_NORMAL && before->type != BLOCK_TYPE_CHAINED)) {
+        AK_EPI;
+        return;
+    }
+    for (row = 0; row + batch->num_attr <= DATA_BLOCK_SIZE && before->tuple_dict[row].type != FREE_INT; row += batch->num_attr) {
+        if (!AK_index_row_exists(before, row, batch->num_attr) || AK_index_row_same(before, after, row, batch->num_attr))
+            continue;
+        AK_index_batch_copy(batch, before, after->address, row, 0);
+        if (AK_index_row_exists(after, row, batch->num_attr))
+            AK_index_batch_copy(batch, after, after->address, row, 1);
+    }
+    AK_EPI;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that applies the batch to every index of the table and frees it. Each index sorts the changes
+ *        in its own order and goes through them once.
+ * @param batch batch
+ * @return EXIT_SUCCESS, EXIT_ERROR if an index could not be updated
+ */
+int AK_index_batch_apply(AK_index_batch *batch) {
+    int i, applied, result = EXIT_SUCCESS;
+    AK_PRO;
+
+    for (i = 0; i < batch->num_deltas; i++) {
+        batch->deltas[i].entries = (AK_tuple_dict *) (batch->images + batch->deltas[i].image);
+        batch->deltas[i].data = (char *) (batch->deltas[i].entries + batch->num_attr);
+    }
+    for (i = 0; i < batch->num_indexes && batch->num_deltas > 0; i++) {
+        if (batch->indexes[i].kind == BLOCK_TYPE_BTREE)
+            applied = AK_btree_apply(batch->indexes[i].name, batch->deltas, batch->num_deltas);
+        else if (batch->indexes[i].kind == BLOCK_TYPE_HASH)
+            applied = AK_hash_apply(batch->indexes[i].name, batch->deltas, batch->num_deltas);
+        else if (batch->indexes[i].kind == BLOCK_TYPE_TRIGRAM)
+            applied = AK_trigram_apply(batch->indexes[i].name, batch->deltas, batch->num_deltas);
+        else
+            applied = AK_bitmap_apply(batch->indexes[i].name, batch->deltas, batch->num_deltas);
+        if (applied == EXIT_ERROR) {
+            printf("AK_index_batch_apply: Index %s of table %s could not be updated!\n", batch->indexes[i].name, batch->table);
+            result = EXIT_ERROR;
+        }
+    }
+    if (batch->deltas != NULL)
+        AK_free(batch->deltas);
+    if (batch->images != NULL)
+        AK_free(batch->images);
+    batch->deltas = NULL;
+    batch->images = NULL;
+    batch->num_deltas = 0;
+    batch->max_deltas = 0;
+    batch->images_size = 0;
+    batch->max_images = 0;
+    AK_EPI;
+    return result;
+}
 
 /**
  * @author Lovro Predovan
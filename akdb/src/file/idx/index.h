@@ -53,6 +53,77 @@ typedef struct list_structure_ad {
 typedef list_structure_ad *element_ad;
 typedef list_structure_ad list_ad;
 
+/**
+  * @author Karlo Vuković
+  * @struct AK_index_description
+  * @brief Structure that describes an index of a table, B+tree, hash, bitmap or trigram
+ */
+typedef struct {
+    /// name of the index
+    char name[MAX_ATT_NAME];
+    /// kind of the index, the type of its blocks: BLOCK_TYPE_BTREE, BLOCK_TYPE_HASH, BLOCK_TYPE_BITMAP or
+    /// BLOCK_TYPE_TRIGRAM
+    int kind;
+    /// number of indexed attributes
+    int num_attr;
+    /// positions of the indexed attributes in the table
+    int attribute[MAX_ATTRIBUTES];
+    /// number of attributes a B+tree index carries in its leaves besides the key
+    int num_included;
+    /// positions of the included attributes in the table
+    int included[MAX_ATTRIBUTES];
+    /// number of rows in the index
+    int num_rows;
+} AK_index_description;
+
+
+/**
+  * @author Karlo Vuković
+  * @struct AK_index_delta
+  * @brief Structure that describes a change of a row of a table that its indices have to follow
+ */
+typedef struct {
+    /// 1 if the row is added to the indices, 0 if it is removed from them
+    int insert;
+    /// row of the table
+    struct_add add;
+    /// position of the copy of the row in the images of the batch
+    int image;
+    /// entries of the copy of the row, set when the batch is applied
+    AK_tuple_dict *entries;
+    /// bytes the addresses of the entries point into, set when the batch is applied
+    char *data;
+} AK_index_delta;
+
+/**
+  * @author Karlo Vuković
+  * @struct AK_index_batch
+  * @brief Structure that collects the rows of a table changed by one statement. Copies of the rows are kept until
+  *        the statement ends, and then every index of the table gets all of its changes at once.
+ */
+typedef struct {
+    /// name of the table
+    char table[MAX_ATT_NAME];
+    /// number of attributes of the table
+    int num_attr;
+    /// number of indices of the table
+    int num_indexes;
+    /// indices of the table
+    AK_index_description indexes[INDEX_MAX_PER_TABLE];
+    /// changes of rows
+    AK_index_delta *deltas;
+    /// number of changes
+    int num_deltas;
+    /// number of changes there is space for
+    int max_deltas;
+    /// copies of the changed rows, entries of each row followed by its values
+    char *images;
+    /// number of bytes of the copies
+    int images_size;
+    /// number of bytes there is space for
+    int max_images;
+} AK_index_batch;
+
 
 /**
  * @author Matija Šestak, modified for indexes by Lovro Predovan
@@ -187,6 +258,70 @@ void AK_Delete_All_elementsAd(list_ad *L) ;
  * */
 void AK_Insert_NewelementAd(int addBlock, int indexTd, char *attName, element_ad elementBefore);
 
+/**
+ * @author Karlo Vuković
+ * @brief Function that finds the B+tree, hash, bitmap and trigram indices of a table. Index segments are registered in
+ *        AK_relation like tables, so the first block of every segment tells if it is an index, and the description
+ *        in that block tells which table it belongs to.
+ * @param tblName table name
+ * @param indexes array for the descriptions of the indices
+ * @param max_indexes size of the array
+ * @return number of indices of the table, at most max_indexes
+ */
+int AK_index_get_descriptions(char *tblName, AK_index_description *indexes, int max_indexes);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that tells the index catalog that an index was created or deleted, so indices of tables are
+ *        found again in AK_relation
+ * @return No return value
+ */
+void AK_index_catalog_changed();
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that starts a batch of changes of rows of a table. A table without indices gets an empty batch,
+ *        which ignores rows added to it.
+ * @param batch batch
+ * @param tblName table name
+ * @return number of indices of the table
+ */
+int AK_index_batch_begin(AK_index_batch *batch, char *tblName);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that adds a copy of a row to the batch. Only rows of blocks that indices cover, with the normal
+ *        layout, are added.
+ * @param batch batch
+ * @param block block with the row
+ * @param address address of the block
+ * @param row first entry of the row in the tuple dictionary
+ * @param insert 1 if the row was added to the table, 0 if it was removed
+ * @return No return value
+ */
+void AK_index_batch_add(AK_index_batch *batch, AK_block *block, int address, int row, int insert);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that compares two versions of a block and adds rows that were deleted or changed between them to
+ *        the batch. A changed row is removed with its old values and added with its new ones. Rows that are only in
+ *        the new version were added by AK_insert_row, which keeps indices up to date itself.
+ * @param batch batch
+ * @param before copy of the block before the change
+ * @param after block after the change
+ * @return No return value
+ */
+void AK_index_batch_add_changes(AK_index_batch *batch, AK_block *before, AK_block *after);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that applies the batch to every index of the table and frees it. Each index sorts the changes
+ *        in its own order and goes through them once.
+ * @param batch batch
+ * @return EXIT_SUCCESS, EXIT_ERROR if an index could not be updated
+ */
+int AK_index_batch_apply(AK_index_batch *batch);
+
 void AK_index_test();
 
 
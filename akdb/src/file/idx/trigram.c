@@ -0,0 +1,1105 @@
+/**
+@file trigram.c Provides functions for trigram indices
+ */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#include "trigram.h"
+#include "../bulk.h"
+#include "../../rel/selection.h"
+#include "../../rel/expression_check.h"
+
+/// pages of trigram indices are copied from and to the cache by one thread at a time
+static pthread_mutex_t AK_trigram_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * @author Karlo Vuković
+ * @struct AK_trigram_index
+ * @brief Structure that holds an open trigram index while it is read or changed
+ */
+typedef struct {
+    /// name of the index
+    char *name;
+    /// extents of the index segment, NULL until a page is added
+    table_addresses *addresses;
+    /// copy of the first block with the description and the posting lists of the index
+    AK_block *first;
+    /// description of the index in the copy of the first block
+    AK_trigram_info *info;
+    /// posting lists in the copy of the first block
+    AK_trigram_list *lists;
+    /// 1 if the first block has to be written back
+    int dirty;
+} AK_trigram_index;
+
+/**
+ * @author Karlo Vuković
+ * @struct AK_trigram_change
+ * @brief Structure that describes a bit to be set or cleared in a posting list of a trigram index
+ */
+typedef struct {
+    /// number of the posting list
+    int list;
+    /// bit of the row
+    int position;
+    /// 1 if the bit is set, 0 if it is cleared
+    int insert;
+} AK_trigram_change;
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that hashes a trigram to its posting list. Letters are taken in lower case, so the index serves
+ *        patterns with and without case.
+ * @param text first character of the trigram
+ * @return number of the posting list
+ */
+static int AK_trigram_hash(char *text) {
+    unsigned int hash = 2166136261u;
+    int i;
+
+    for (i = 0; i < 3; i++)
+        hash = (hash ^ (unsigned int) tolower((unsigned char) text[i])) * 16777619u;
+    return (int) (hash % TRIGRAM_LISTS);
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that marks the posting lists of the trigrams of a text
+ * @param text text
+ * @param size size of the text
+ * @param seen 1 for each posting list of a trigram of the text
+ * @return No return value
+ */
+static void AK_trigram_mark(char *text, int size, char *seen) {
+    int i;
+
+    for (i = 0; i + 2 < size; i++)
+        seen[AK_trigram_hash(text + i)] = 1;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that lists the marked posting lists
+ * @param seen 1 for each marked posting list
+ * @param lists array of TRIGRAM_LISTS elements for the numbers of the lists
+ * @return number of lists, in increasing order
+ */
+static int AK_trigram_marked(char *seen, int *lists) {
+    int i, count = 0;
+
+    for (i = 0; i < TRIGRAM_LISTS; i++) {
+        if (seen[i])
+            lists[count++] = i;
+    }
+    return count;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that copies a page from the cache, so that it stays the same while it is used
+ * @param address address of the page
+ * @return copy of the page
+ */
+static AK_block *AK_trigram_read(int address) {
+    AK_block *block = (AK_block *) AK_malloc(sizeof (AK_block));
+
+    memcpy(block, ((AK_mem_block *) AK_get_block(address))->block, sizeof (AK_block));
+    return block;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that copies a changed page to the cache, which writes it to the disk later
+ * @param block page
+ * @return No return value
+ */
+static void AK_trigram_write(AK_block *block) {
+    AK_mem_block *mem_block = (AK_mem_block *) AK_get_block(block->address);
+
+    memcpy(mem_block->block, block, sizeof (AK_block));
+    AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that finds the block of a segment with a number
+ * @param addresses extents of the segment
+ * @param number number of the block in the order of the extents
+ * @return block address, -1 if the segment has no such block
+ */
+static int AK_trigram_block(table_addresses *addresses, int number) {
+    int i, blocks;
+
+    for (i = 0; i < MAX_EXTENTS_IN_SEGMENT && addresses->address_from[i] != 0; i++) {
+        blocks = addresses->address_to[i] - addresses->address_from[i];
+        if (number < blocks)
+            return addresses->address_from[i] + number;
+        number -= blocks;
+    }
+    return -1;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that finds the number of a block of a segment in the order of the extents
+ * @param addresses extents of the segment
+ * @param address block address
+ * @return number of the block, -1 if it does not belong to the segment
+ */
+static int AK_trigram_block_number(table_addresses *addresses, int address) {
+    int i, number = 0;
+
+    for (i = 0; i < MAX_EXTENTS_IN_SEGMENT && addresses->address_from[i] != 0; i++) {
+        if (address >= addresses->address_from[i] && address < addresses->address_to[i])
+            return number + address - addresses->address_from[i];
+        number += addresses->address_to[i] - addresses->address_from[i];
+    }
+    return -1;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that opens a trigram index
+ * @param indexName name of the index
+ * @param index open index
+ * @return EXIT_SUCCESS if there is such index, EXIT_ERROR otherwise
+ */
+static int AK_trigram_open(char *indexName, AK_trigram_index *index) {
+    table_addresses *addresses = AK_get_table_addresses(indexName);
+    int address = addresses->address_from[0];
+
+    AK_free(addresses);
+    index->name = indexName;
+    index->addresses = NULL;
+    index->dirty = 0;
+    if (address == 0)
+        return EXIT_ERROR;
+    index->first = AK_trigram_read(address);
+    index->info = (AK_trigram_info *) index->first->data;
+    index->lists = (AK_trigram_list *) (index->first->data + sizeof (AK_trigram_info));
+    if (index->first->type != BLOCK_TYPE_TRIGRAM || strcmp(index->info->name, indexName) != 0) {
+        AK_free(index->first);
+        return EXIT_ERROR;
+    }
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that closes a trigram index and writes its first block if it was changed
+ * @param index open index
+ * @return No return value
+ */
+static void AK_trigram_close(AK_trigram_index *index) {
+    if (index->dirty)
+        AK_trigram_write(index->first);
+    AK_free(index->first);
+    if (index->addresses != NULL)
+        AK_free(index->addresses);
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that takes an empty page for the index, from the pages that are no longer used or from the next
+ *        block of the segment. The segment gets a new extent when all of its blocks are used.
+ * @param index open index
+ * @return empty page, NULL if there is no space
+ */
+static AK_block *AK_trigram_new_page(AK_trigram_index *index) {
+    AK_block *block;
+    int address;
+
+    if (index->info->free_list != 0) {
+        block = AK_trigram_read(index->info->free_list);
+        index->info->free_list = ((AK_bitmap_page *) block->data)->next;
+    } else {
+        if (index->addresses == NULL)
+            index->addresses = AK_get_table_addresses(index->name);
+        address = AK_trigram_block(index->addresses, index->info->num_pages);
+        if (address < 0) {
+            if (AK_init_new_extent(index->name, SEGMENT_TYPE_TABLE) == EXIT_ERROR) {
+                printf("AK_trigram_new_page: Could not extend index %s!\n", index->name);
+                return NULL;
+            }
+            AK_free(index->addresses);
+            index->addresses = AK_get_table_addresses(index->name);
+            address = AK_trigram_block(index->addresses, index->info->num_pages);
+            if (address < 0)
+                return NULL;
+        }
+        index->info->num_pages++;
+        block = AK_trigram_read(address);
+    }
+    index->dirty = 1;
+    block->type = BLOCK_TYPE_TRIGRAM;
+    memset(block->data, 0, sizeof (block->data));
+    return block;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that writes the pages of a posting list to the list of pages that are no longer used
+ * @param index open index
+ * @param page first page of the posting list, 0 if it has none
+ * @return No return value
+ */
+static void AK_trigram_free_pages(AK_trigram_index *index, int page) {
+    AK_block *block;
+
+    while (page != 0) {
+        block = AK_trigram_read(page);
+        page = ((AK_bitmap_page *) block->data)->next;
+        memset(block->data, 0, sizeof (block->data));
+        ((AK_bitmap_page *) block->data)->next = index->info->free_list;
+        index->info->free_list = block->address;
+        AK_trigram_write(block);
+        AK_free(block);
+    }
+    index->dirty = 1;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that writes the words of a bitmap into a chain of new pages
+ * @param index open index
+ * @param bitmap bitmap
+ * @return first page, 0 if the bitmap has no words, EXIT_ERROR if the index could not be extended
+ */
+static int AK_trigram_store(AK_trigram_index *index, AK_bitmap *bitmap) {
+    AK_block *block, *next;
+    AK_bitmap_page *page;
+    int count, first, per_page = (DATA_BLOCK_SIZE * DATA_ENTRY_SIZE - (int) sizeof (AK_bitmap_page)) / (int) sizeof (unsigned int);
+    int done = 0;
+
+    if (bitmap->num_words == 0)
+        return 0;
+    block = AK_trigram_new_page(index);
+    if (block == NULL)
+        return EXIT_ERROR;
+    first = block->address;
+    for (;;) {
+        page = (AK_bitmap_page *) block->data;
+        count = bitmap->num_words - done < per_page ? bitmap->num_words - done : per_page;
+        memcpy(block->data + sizeof (AK_bitmap_page), bitmap->words + done, count * sizeof (unsigned int));
+        page->num_words = count;
+        done += count;
+        next = done < bitmap->num_words ? AK_trigram_new_page(index) : NULL;
+        page->next = next != NULL ? next->address : 0;
+        AK_trigram_write(block);
+        AK_free(block);
+        if (next == NULL)
+            return done < bitmap->num_words ? EXIT_ERROR : first;
+        block = next;
+    }
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that reads a posting list from its chain of pages
+ * @param list posting list
+ * @param bitmap bitmap of the rows of the list, it is initialized by the function
+ * @return No return value
+ */
+static void AK_trigram_load(AK_trigram_list *list, AK_bitmap *bitmap) {
+    AK_block *block;
+    AK_bitmap_page *header;
+    int page = list->page;
+
+    AK_bitmap_init(bitmap);
+    bitmap->num_bits = list->num_bits;
+    while (page != 0) {
+        block = ((AK_mem_block *) AK_get_block(page))->block;
+        header = (AK_bitmap_page *) block->data;
+        bitmap->max_words += header->num_words;
+        bitmap->words = (unsigned int *) AK_realloc(bitmap->words, bitmap->max_words * sizeof (unsigned int));
+        memcpy(bitmap->words + bitmap->num_words, block->data + sizeof (AK_bitmap_page), header->num_words * sizeof (unsigned int));
+        bitmap->num_words += header->num_words;
+        page = header->next;
+    }
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that replaces the bitmap of a posting list, the pages of the old bitmap are freed
+ * @param index open index
+ * @param list number of the posting list
+ * @param bitmap new bitmap
+ * @return EXIT_SUCCESS, EXIT_ERROR if the index could not be extended
+ */
+static int AK_trigram_replace(AK_trigram_index *index, int list, AK_bitmap *bitmap) {
+    AK_trigram_list *description = &index->lists[list];
+    int page;
+
+    AK_trigram_free_pages(index, description->page);
+    memset(description, 0, sizeof (AK_trigram_list));
+    page = AK_trigram_store(index, bitmap);
+    if (page == EXIT_ERROR)
+        return EXIT_ERROR;
+    description->page = page;
+    description->num_words = bitmap->num_words;
+    description->num_bits = bitmap->num_bits;
+    description->num_set = AK_bitmap_count(bitmap);
+    index->dirty = 1;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that checks if any entry of a row is still there, deleted rows have none
+ * @param block block of the table
+ * @param row first entry of the row in the tuple dictionary
+ * @param num_attr number of attributes of the table
+ * @return 1 if the row is not deleted, 0 otherwise
+ */
+static int AK_trigram_row_exists(AK_block *block, int row, int num_attr) {
+    int i;
+
+    for (i = 0; i < num_attr; i++) {
+        if (block->tuple_dict[row + i].size > 0 || block->tuple_dict[row + i].type != TYPE_INTERNAL)
+            return 1;
+    }
+    return 0;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that fills a new trigram index from the rows of the table. Blocks are copied from the cache,
+ *        where the latest versions of them are, all posting lists are built in memory while the table is read once
+ *        and written to pages at the end.
+ * @param index open index
+ * @param tblName name of the table
+ * @return EXIT_SUCCESS, EXIT_ERROR if the index could not be extended
+ */
+static int AK_trigram_build(AK_trigram_index *index, char *tblName) {
+    AK_trigram_info *info = index->info;
+    table_addresses *addresses = AK_get_table_addresses(tblName);
+    AK_block *block = (AK_block *) AK_malloc(sizeof (AK_block));
+    AK_bitmap *bitmaps = (AK_bitmap *) AK_calloc(TRIGRAM_LISTS, sizeof (AK_bitmap));
+    AK_tuple_dict *dict;
+    char seen[TRIGRAM_LISTS];
+    int lists[TRIGRAM_LISTS];
+    int i, j, k, count, address, number = 0, result = EXIT_SUCCESS;
+    int num_attr = info->table_num_attr, per_block = DATA_BLOCK_SIZE / info->table_num_attr;
+
+    for (i = 0; i < MAX_EXTENTS_IN_SEGMENT && addresses->address_from[i] != 0; i++) {
+        for (address = addresses->address_from[i]; address < addresses->address_to[i]; address++, number++) {
+            memcpy(block, ((AK_mem_block *) AK_get_block(address))->block, sizeof (AK_block));
+            if (block->type != BLOCK_TYPE_NORMAL && block->type != BLOCK_TYPE_CHAINED)
+                continue;
+            for (j = 0; j + num_attr <= DATA_BLOCK_SIZE && block->tuple_dict[j].type != FREE_INT; j += num_attr) {
+                dict = &block->tuple_dict[j + info->position];
+                if (!AK_trigram_row_exists(block, j, num_attr) || dict->type != TYPE_VARCHAR || dict->size <= 0 ||
+                    dict->size > MAX_VARCHAR_LENGTH)
+                    continue;
+                info->num_rows++;
+                memset(seen, 0, sizeof (seen));
+                AK_trigram_mark((char *) block->data + dict->address, dict->size, seen);
+                count = AK_trigram_marked(seen, lists);
+                for (k = 0; k < count; k++)
+                    AK_bitmap_set(&bitmaps[lists[k]], number * per_block + j / num_attr);
+            }
+        }
+    }
+
+    for (i = 0; i < TRIGRAM_LISTS; i++) {
+        if (result == EXIT_SUCCESS)
+            result = AK_trigram_replace(index, i, &bitmaps[i]);
+        AK_bitmap_free(&bitmaps[i]);
+    }
+    AK_free(bitmaps);
+    AK_free(block);
+    AK_free(addresses);
+    return result;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that creates a trigram index on a varchar attribute of a table. Every value is split into its
+ *        trigrams, three characters that follow each other, taken in lower case, and the row is added to the
+ *        posting list of each of them. Trigrams are hashed to TRIGRAM_LISTS lists, so a list can hold rows of
+ *        several trigrams. The index finds candidates for LIKE, ILIKE, SIMILAR TO and regular expressions. Tables
+ *        with the PAX layout can not be indexed.
+ * @param tblName name of the table
+ * @param attribute name of the attribute
+ * @param indexName name of the index
+ * @return EXIT_SUCCESS if the index was created, EXIT_ERROR otherwise
+ */
+int AK_trigram_create(char *tblName, char *attribute, char *indexName) {
+    AK_header *table_header;
+    AK_header i_header[MAX_ATTRIBUTES];
+    AK_trigram_index index;
+    table_addresses *addresses;
+    int i, num_attr, address, result;
+    AK_PRO;
+
+    num_attr = AK_num_attr(tblName);
+    table_header = (AK_header *) AK_get_header(tblName);
+    if (table_header == NULL || num_attr <= 0 || num_attr > MAX_ATTRIBUTES) {
+        printf("AK_trigram_create: Table %s does not exist or has too many attributes!\n", tblName);
+        if (table_header != NULL)
+            AK_free(table_header);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    if (AK_get_storage_layout(tblName) != BLOCK_TYPE_NORMAL) {
+        printf("AK_trigram_create: Table %s has the PAX layout, it can not be indexed!\n", tblName);
+        AK_free(table_header);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    for (i = 0; i < num_attr && strcmp(table_header[i].att_name, attribute) != 0; i++)
+        ;
+    addresses = AK_get_table_addresses(indexName);
+    address = addresses->address_from[0];
+    AK_free(addresses);
+    if (i == num_attr || table_header[i].type != TYPE_VARCHAR || address != 0) {
+        printf("AK_trigram_create: %s %s!\n", i == num_attr ? "There is no attribute" : address != 0 ?
+               "Index already exists on" : "Trigram index needs a varchar attribute, not", attribute);
+        AK_free(table_header);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    memset(i_header, 0, sizeof (i_header));
+    memcpy(&i_header[0], &table_header[i], sizeof (AK_header));
+    if (AK_initialize_new_segment(indexName, SEGMENT_TYPE_INDEX, i_header) == EXIT_ERROR) {
+        AK_free(table_header);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+
+    pthread_mutex_lock(&AK_trigram_mutex);
+    addresses = AK_get_table_addresses(indexName);
+    index.name = indexName;
+    index.addresses = addresses;
+    index.first = AK_trigram_read(addresses->address_from[0]);
+    index.first->type = BLOCK_TYPE_TRIGRAM;
+    index.first->AK_free_space = ((int) (sizeof (AK_trigram_info) + TRIGRAM_LISTS * sizeof (AK_trigram_list)) + 3) / 4 * 4;
+    memset(index.first->data, 0, sizeof (index.first->data));
+    index.info = (AK_trigram_info *) index.first->data;
+    index.lists = (AK_trigram_list *) (index.first->data + sizeof (AK_trigram_info));
+    strncpy(index.info->name, indexName, MAX_ATT_NAME - 1);
+    strncpy(index.info->table, tblName, MAX_ATT_NAME - 1);
+    strncpy(index.info->attribute, attribute, MAX_ATT_NAME - 1);
+    index.info->position = i;
+    index.info->table_num_attr = num_attr;
+    index.info->num_pages = 1;
+    index.dirty = 1;
+    result = AK_trigram_build(&index, tblName);
+    AK_trigram_close(&index);
+    pthread_mutex_unlock(&AK_trigram_mutex);
+    AK_free(table_header);
+
+    if (result == EXIT_ERROR)
+        AK_delete_segment(indexName, SEGMENT_TYPE_TABLE);
+    AK_index_catalog_changed();
+    AK_EPI;
+    return result;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that deletes a trigram index
+ * @param indexName name of the index
+ * @return EXIT_SUCCESS if the index was deleted, EXIT_ERROR if there is no such index
+ */
+int AK_trigram_delete(char *indexName) {
+    AK_trigram_index index;
+    int result;
+    AK_PRO;
+
+    pthread_mutex_lock(&AK_trigram_mutex);
+    result = AK_trigram_open(indexName, &index);
+    if (result == EXIT_SUCCESS) {
+        AK_trigram_close(&index);
+        AK_delete_segment(indexName, SEGMENT_TYPE_TABLE);
+    }
+    pthread_mutex_unlock(&AK_trigram_mutex);
+    AK_index_catalog_changed();
+    AK_EPI;
+    return result;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that reads the description of a trigram index
+ * @param indexName name of the index
+ * @param info description of the index
+ * @return EXIT_SUCCESS if the index exists, EXIT_ERROR otherwise
+ */
+int AK_trigram_get_info(char *indexName, AK_trigram_info *info) {
+    AK_trigram_index index;
+    int result;
+    AK_PRO;
+
+    pthread_mutex_lock(&AK_trigram_mutex);
+    result = AK_trigram_open(indexName, &index);
+    if (result == EXIT_SUCCESS) {
+        memcpy(info, index.info, sizeof (AK_trigram_info));
+        AK_trigram_close(&index);
+    }
+    pthread_mutex_unlock(&AK_trigram_mutex);
+    AK_EPI;
+    return result;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that skips a bracket expression of a pattern, classes like [:alpha:] inside it end with their own
+ *        bracket
+ * @param pattern pattern
+ * @param i position of the opening bracket
+ * @return position after the closing bracket, or the end of the pattern
+ */
+static int AK_trigram_skip_bracket(char *pattern, int i) {
+    char close;
+
+    i++;
+    if (pattern[i] == '^')
+        i++;
+    if (pattern[i] == ']')
+        i++;
+    while (pattern[i] != '\0' && pattern[i] != ']') {
+        if (pattern[i] == '[' && (pattern[i + 1] == ':' || pattern[i + 1] == '.' || pattern[i + 1] == '=')) {
+            close = pattern[i + 1];
+            for (i += 2; pattern[i] != '\0' && !(pattern[i] == close && pattern[i + 1] == ']'); i++)
+                ;
+            if (pattern[i] != '\0')
+                i += 2;
+        } else
+            i++;
+    }
+    return pattern[i] == ']' ? i + 1 : i;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that skips a group of a pattern with the groups inside it, ( and ) of extended expressions and
+ *        \( and \) of basic ones
+ * @param pattern pattern
+ * @param i position of the opening parenthesis or of its backslash
+ * @return position after the group, or the end of the pattern
+ */
+static int AK_trigram_skip_group(char *pattern, int i) {
+    int depth = 0;
+
+    do {
+        if (pattern[i] == '\\' && pattern[i + 1] != '\0') {
+            depth += pattern[i + 1] == '(' ? 1 : pattern[i + 1] == ')' ? -1 : 0;
+            i += 2;
+        } else if (pattern[i] == '[')
+            i = AK_trigram_skip_bracket(pattern, i);
+        else {
+            depth += pattern[i] == '(' ? 1 : pattern[i] == ')' ? -1 : 0;
+            i++;
+        }
+    } while (depth > 0 && pattern[i] != '\0');
+    return i;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that finds the trigrams every value matching a pattern has. They come from runs of characters
+ *        the pattern matches literally, and characters that may be left out or repeated, classes, groups and escapes
+ *        end a run. A pattern with alternatives outside groups requires no trigram.
+ * @param pattern pattern, a POSIX regular expression
+ * @param wildcards 1 if % and _ of the pattern are SQL wildcards, as in LIKE, ILIKE and SIMILAR TO
+ * @param lists array of TRIGRAM_LISTS elements for the posting lists of the trigrams
+ * @return number of posting lists, 0 if the pattern requires no trigram
+ */
+int AK_trigram_pattern(char *pattern, int wildcards, int *lists) {
+    char seen[TRIGRAM_LISTS], run[MAX_VARCHAR_LENGTH];
+    unsigned char c;
+    char next;
+    int i = 0, length = 0, count;
+    AK_PRO;
+
+    memset(seen, 0, sizeof (seen));
+    while (pattern[i] != '\0') {
+        c = (unsigned char) pattern[i];
+        next = pattern[i + 1];
+        if (c == '|' || (c == '\\' && next == '|')) {
+            //a value can match any of the alternatives
+            AK_EPI;
+            return 0;
+        }
+        if (c == '(' || (c == '\\' && next == '(')) {
+            AK_trigram_mark(run, length, seen);
+            length = 0;
+            i = AK_trigram_skip_group(pattern, i);
+        } else if (c == '[') {
+            AK_trigram_mark(run, length, seen);
+            length = 0;
+            i = AK_trigram_skip_bracket(pattern, i);
+        } else if (c == '{' || (c == '\\' && next == '{')) {
+            //bounds of a repetition are not characters of values
+            AK_trigram_mark(run, length, seen);
+            length = 0;
+            for (i++; pattern[i] != '\0' && pattern[i] != '}'; i++)
+                ;
+            if (pattern[i] != '\0')
+                i++;
+        } else if (c == '\\') {
+            AK_trigram_mark(run, length, seen);
+            length = 0;
+            i += next != '\0' ? 2 : 1;
+        } else if (c >= 0x80 || strchr("^$.*+?)]}", c) != NULL || (wildcards && (c == '%' || c == '_'))) {
+            AK_trigram_mark(run, length, seen);
+            length = 0;
+            i++;
+        } else if (next == '*' || next == '?' || next == '{' || (next == '\\' && pattern[i + 2] == '{')) {
+            //the character may be left out
+            AK_trigram_mark(run, length, seen);
+            length = 0;
+            i++;
+        } else {
+            if (length < MAX_VARCHAR_LENGTH)
+                run[length++] = (char) c;
+            //the character may repeat, so it is the last one of its run
+            if (next == '+') {
+                AK_trigram_mark(run, length, seen);
+                length = 0;
+            }
+            i++;
+        }
+    }
+    AK_trigram_mark(run, length, seen);
+    count = AK_trigram_marked(seen, lists);
+    AK_EPI;
+    return count;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that finds the rows that can match a pattern in a trigram index, the rows in all posting lists of
+ *        the trigrams of the pattern. Lists hold rows of every trigram hashed to them, so not every candidate
+ *        matches and the pattern has to be checked on each of them.
+ * @param indexName name of the index
+ * @param pattern pattern
+ * @param wildcards 1 if % and _ of the pattern are SQL wildcards
+ * @param bitmap bitmap of the candidate rows, it is initialized by the function
+ * @return number of posting lists that were used, 0 if the pattern requires no trigram, EXIT_ERROR if there is no
+ *         such index
+ */
+int AK_trigram_candidates(char *indexName, char *pattern, int wildcards, AK_bitmap *bitmap) {
+    AK_trigram_index index;
+    AK_bitmap list, result;
+    int lists[TRIGRAM_LISTS];
+    int i, count;
+    AK_PRO;
+
+    AK_bitmap_init(bitmap);
+    count = AK_trigram_pattern(pattern, wildcards, lists);
+    pthread_mutex_lock(&AK_trigram_mutex);
+    if (AK_trigram_open(indexName, &index) == EXIT_ERROR) {
+        pthread_mutex_unlock(&AK_trigram_mutex);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    for (i = 0; i < count; i++) {
+        AK_trigram_load(&index.lists[lists[i]], &list);
+        if (i == 0) {
+            *bitmap = list;
+            continue;
+        }
+        AK_bitmap_and(bitmap, &list, &result);
+        AK_bitmap_free(bitmap);
+        AK_bitmap_free(&list);
+        *bitmap = result;
+    }
+    AK_trigram_close(&index);
+    pthread_mutex_unlock(&AK_trigram_mutex);
+    AK_EPI;
+    return count;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that orders changes of a trigram index by posting list and bit
+ * @param left first change
+ * @param right second change
+ * @return negative number if the first change comes first, 0 if they are equal, otherwise positive number
+ */
+static int AK_trigram_change_compare(const void *left, const void *right) {
+    const AK_trigram_change *a = (const AK_trigram_change *) left, *b = (const AK_trigram_change *) right;
+
+    if (a->list != b->list)
+        return a->list < b->list ? -1 : 1;
+    if (a->position != b->position)
+        return a->position < b->position ? -1 : 1;
+    return a->insert - b->insert;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that applies changes of rows of the indexed table to a trigram index. Changes are split into the
+ *        posting lists of the trigrams of the rows, grouped by list and sorted by row, so every list that changed is
+ *        combined with the changed bits and written once.
+ * @param indexName name of the index
+ * @param deltas changes of rows of the table
+ * @param num_deltas number of changes
+ * @return EXIT_SUCCESS, EXIT_ERROR if there is no such index or it could not be extended
+ */
+int AK_trigram_apply(char *indexName, AK_index_delta *deltas, int num_deltas) {
+    AK_trigram_index index;
+    AK_trigram_change *changes = NULL;
+    AK_bitmap bitmap, cleared, set, rest;
+    AK_tuple_dict *dict;
+    table_addresses *addresses;
+    char seen[TRIGRAM_LISTS];
+    int lists[TRIGRAM_LISTS];
+    int i, j, last, count, number, position, per_block, num_changes = 0, max_changes = 0, result = EXIT_SUCCESS;
+    AK_PRO;
+
+    pthread_mutex_lock(&AK_trigram_mutex);
+    if (AK_trigram_open(indexName, &index) == EXIT_ERROR) {
+        pthread_mutex_unlock(&AK_trigram_mutex);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    addresses = AK_get_table_addresses(index.info->table);
+    per_block = DATA_BLOCK_SIZE / index.info->table_num_attr;
+    for (i = 0; i < num_deltas; i++) {
+        number = AK_trigram_block_number(addresses, deltas[i].add.addBlock);
+        dict = &deltas[i].entries[index.info->position];
+        if (number < 0 || dict->type != TYPE_VARCHAR || dict->size <= 0 || dict->size > MAX_VARCHAR_LENGTH)
+            continue;
+        position = number * per_block + deltas[i].add.indexTd / index.info->table_num_attr;
+        index.info->num_rows += deltas[i].insert ? 1 : -1;
+        memset(seen, 0, sizeof (seen));
+        AK_trigram_mark(deltas[i].data + dict->address, dict->size, seen);
+        count = AK_trigram_marked(seen, lists);
+        if (num_changes + count > max_changes) {
+            max_changes = 2 * (num_changes + count);
+            changes = (AK_trigram_change *) AK_realloc(changes, max_changes * sizeof (AK_trigram_change));
+        }
+        for (j = 0; j < count; j++) {
+            changes[num_changes].list = lists[j];
+            changes[num_changes].position = position;
+            changes[num_changes++].insert = deltas[i].insert;
+        }
+    }
+    AK_free(addresses);
+    index.dirty = 1;
+
+    //changes of every list follow each other in the order of their bits, bits are cleared before they are set
+    if (num_changes > 0)
+        qsort(changes, num_changes, sizeof (AK_trigram_change), AK_trigram_change_compare);
+    for (i = 0; i < num_changes && result == EXIT_SUCCESS; i = last) {
+        AK_bitmap_init(&cleared);
+        AK_bitmap_init(&set);
+        for (last = i; last < num_changes && changes[last].list == changes[i].list; last++)
+            AK_bitmap_set(changes[last].insert ? &set : &cleared, changes[last].position);
+        AK_trigram_load(&index.lists[changes[i].list], &bitmap);
+        AK_bitmap_and_not(&bitmap, &cleared, &rest);
+        AK_bitmap_free(&bitmap);
+        AK_bitmap_or(&rest, &set, &bitmap);
+        result = AK_trigram_replace(&index, changes[i].list, &bitmap);
+        AK_bitmap_free(&bitmap);
+        AK_bitmap_free(&rest);
+        AK_bitmap_free(&cleared);
+        AK_bitmap_free(&set);
+    }
+    if (result == EXIT_ERROR)
+        printf("AK_trigram_apply: Could not extend index %s!\n", indexName);
+    if (changes != NULL)
+        AK_free(changes);
+    AK_trigram_close(&index);
+    pthread_mutex_unlock(&AK_trigram_mutex);
+    AK_EPI;
+    return result;
+}
+
+/**
+ * @author Karlo Vuković
+ * @struct AK_trigram_expr_facts
+ * @brief Structure that keeps patterns of every attribute for AK_trigram_expr_patterns
+ */
+typedef struct {
+    /// pattern of each attribute, NULL if there is none
+    struct list_node *patterns[MAX_ATTRIBUTES];
+    /// 1 for each attribute whose pattern has SQL wildcards
+    int wildcards[MAX_ATTRIBUTES];
+} AK_trigram_expr_facts;
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that gives patterns implied by AND of two results for AK_trigram_expr_patterns
+ * @param result patterns of the AND
+ * @param first patterns of the first operand
+ * @param second patterns of the second operand
+ * @return No return value
+ */
+static void AK_trigram_expr_and(void *result, void *first, void *second) {
+    AK_trigram_expr_facts *facts = (AK_trigram_expr_facts *) result;
+    AK_trigram_expr_facts *left = (AK_trigram_expr_facts *) first, *right = (AK_trigram_expr_facts *) second;
+    int i;
+
+    for (i = 0; i < MAX_ATTRIBUTES; i++) {
+        facts->patterns[i] = left->patterns[i] != NULL ? left->patterns[i] : right->patterns[i];
+        facts->wildcards[i] = left->patterns[i] != NULL ? left->wildcards[i] : right->wildcards[i];
+    }
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that gives the pattern of an attribute implied by a pattern matching operator for
+ *        AK_trigram_expr_patterns
+ * @param op operator
+ * @param operands operands read so far
+ * @param num_operands number of operands
+ * @param header table header
+ * @param result patterns of the operator
+ * @return No return value
+ */
+static void AK_trigram_expr_match(char *op, AK_expression_operand *operands, int num_operands, AK_header *header,
+                                  void *result) {
+    AK_trigram_expr_facts *facts = (AK_trigram_expr_facts *) result;
+    int left, like;
+
+    like = strcmp(op, "LIKE") == 0 || strcmp(op, "~~") == 0 || strcmp(op, "ILIKE") == 0 ||
+           strcmp(op, "~~*") == 0 || strcmp(op, "SIMILAR TO") == 0;
+    if ((!like && strcmp(op, "~") != 0 && strcmp(op, "~*") != 0) || num_operands < 2)
+        return;
+    //the attribute is matched against the pattern after it
+    left = operands[num_operands - 2].attribute;
+    if (left >= 0 && header[left].type == TYPE_VARCHAR && operands[num_operands - 1].el->type == TYPE_VARCHAR) {
+        facts->patterns[left] = operands[num_operands - 1].el;
+        facts->wildcards[left] = like;
+    }
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that finds patterns that varchar attributes have to match in every row satisfying the postfix
+ *        expression. The expression is followed with AK_expression_walk, and only LIKE, ILIKE, SIMILAR TO, ~ and ~*
+ *        of an attribute with a constant and AND give patterns.
+ * @param expr postfix expression, may be NULL
+ * @param header table header
+ * @param num_attr number of attributes
+ * @param patterns pattern of each attribute, NULL if there is none
+ * @param wildcards 1 for each attribute whose pattern has SQL wildcards, 0 otherwise
+ * @return number of attributes with a pattern
+ */
+int AK_trigram_expr_patterns(struct list_node *expr, AK_header *header, int num_attr, struct list_node **patterns,
+                             int *wildcards) {
+    AK_trigram_expr_facts facts;
+    AK_expression_walker walker = {sizeof (AK_trigram_expr_facts), NULL, AK_trigram_expr_and, AK_trigram_expr_match};
+    int i, found = 0;
+    AK_PRO;
+
+    memset(&facts, 0, sizeof (facts));
+    AK_expression_walk(expr, header, num_attr, &walker, &facts);
+    for (i = 0; i < num_attr; i++) {
+        patterns[i] = facts.patterns[i];
+        wildcards[i] = facts.wildcards[i];
+        if (patterns[i] != NULL)
+            found++;
+    }
+    AK_EPI;
+    return found;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that counts the candidates of a pattern in a trigram index
+ * @param indexName name of the index
+ * @param pattern pattern
+ * @param wildcards 1 if % and _ of the pattern are SQL wildcards
+ * @return number of candidate rows, -1 if the pattern requires no trigram
+ */
+static int AK_trigram_test_count(char *indexName, char *pattern, int wildcards) {
+    AK_bitmap bitmap;
+    int count = -1;
+
+    if (AK_trigram_candidates(indexName, pattern, wildcards, &bitmap) > 0)
+        count = AK_bitmap_count(&bitmap);
+    AK_bitmap_free(&bitmap);
+    return count;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that checks the access path and the result of a selection with one pattern on the test table
+ * @param tblName name of the table
+ * @param dstTable name of the destination table
+ * @param op operator
+ * @param pattern pattern
+ * @param expected expected number of selected rows
+ * @return 1 if the selection went through the trigram index and selected the expected rows, 0 otherwise
+ */
+static int AK_trigram_test_selection(char *tblName, char *dstTable, char *op, char *pattern, int expected) {
+    struct list_node *expr = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    AK_selection_path path;
+    int selected;
+
+    AK_Init_L3(&expr);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "name", sizeof ("name"), expr);
+    AK_InsertAtEnd_L3(TYPE_VARCHAR, pattern, strlen(pattern) + 1, expr);
+    AK_InsertAtEnd_L3(TYPE_OPERATOR, op, strlen(op) + 1, expr);
+    AK_selection_choose_path(tblName, expr, &path);
+    if (path.rows != NULL)
+        AK_free(path.rows);
+    strcpy(expr->table, dstTable);
+    AK_selection(tblName, dstTable, expr);
+    selected = AK_get_num_records(dstTable);
+    AK_delete_segment(dstTable, SEGMENT_TYPE_TABLE);
+    printf("name %s '%s' reads %d candidates through %s and selects %d rows, expected %d\n", op, pattern,
+           path.num_rows, path.kind == BLOCK_TYPE_TRIGRAM ? path.index : "no index", selected, expected);
+    AK_DeleteAll_L3(&expr);
+    AK_free(expr);
+    return path.kind == BLOCK_TYPE_TRIGRAM && selected == expected;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function for testing trigram indices
+ * @return TestResult
+ */
+TestResult AK_trigram_test() {
+    char *tblName = "trigram_test", *indexName = "trigram_test_name";
+    char *words[8] = {"alpha", "bravo", "charlie", "delta", "echo", "foxtrot", "golf", "hotel"};
+    char *no_trigrams[6] = {"%in%", "%(d|i)%", "alpha|bravo", "(charlie)*", "al[pq]ha", "alp?ha"};
+    int num_rows = 512, passed_tests = 0, failed_tests = 0;
+    int i, id, count, wrong, expected, before;
+    int lists[TRIGRAM_LISTS], other[TRIGRAM_LISTS];
+    char name[MAX_VARCHAR_LENGTH], dstTable[MAX_ATT_NAME];
+    struct list_node **rows, *row_root;
+    AK_trigram_info info;
+    AK_PRO;
+
+    printf("\n********** TRIGRAM INDEX TEST **********\n\n");
+
+    //wildcards and characters that may be left out end runs, alternatives require nothing
+    count = AK_trigram_pattern("%charlie%", 1, lists);
+    wrong = count != AK_trigram_pattern("charlie", 0, other) || count == 0 || memcmp(lists, other, count * sizeof (int)) != 0;
+    wrong += AK_trigram_pattern("[[:alpha:]]+ch[a-z]*", 0, lists) != 0;
+    wrong += AK_trigram_pattern("del\\{1,2\\}", 0, lists) != 0;
+    for (i = 0; i < 6; i++)
+        wrong += AK_trigram_pattern(no_trigrams[i], 1, lists) != 0;
+    if (wrong == 0) {
+        printf("Patterns give %d posting lists for charlie and none for patterns without a required trigram\n", count);
+        passed_tests++;
+    } else {
+        printf("%d patterns give wrong posting lists\n", wrong);
+        failed_tests++;
+    }
+
+    AK_header t_header[3] = {
+        {TYPE_INT, "id", {0}, {{'\0'}}, {{'\0'}}},
+        {TYPE_VARCHAR, "name", {0}, {{'\0'}}, {{'\0'}}},
+        {0, {'\0'}, {0}, {{'\0'}}, {{'\0'}}}};
+
+    AK_trigram_delete(indexName);
+    if (AK_num_attr(tblName) > 0)
+        AK_delete_segment(tblName, SEGMENT_TYPE_TABLE);
+    if (AK_initialize_new_segment(tblName, SEGMENT_TYPE_TABLE, t_header) == EXIT_ERROR) {
+        printf("Could not create table %s\n", tblName);
+        AK_EPI;
+        return TEST_result(passed_tests, failed_tests + 1);
+    }
+    rows = (struct list_node **) AK_calloc(num_rows, sizeof (struct list_node *));
+    for (i = 0; i < num_rows; i++) {
+        id = i;
+        snprintf(name, MAX_VARCHAR_LENGTH, "%s %s %s", words[i % 8], words[i / 8 % 8], words[i / 64 % 8]);
+        rows[i] = (struct list_node *) AK_malloc(sizeof (struct list_node));
+        AK_Init_L3(&rows[i]);
+        AK_Insert_New_Element(TYPE_INT, &id, tblName, "id", rows[i]);
+        AK_Insert_New_Element(TYPE_VARCHAR, name, tblName, "name", rows[i]);
+    }
+    AK_bulk_insert(tblName, rows, num_rows);
+    for (i = 0; i < num_rows; i++) {
+        AK_DeleteAll_L3(&rows[i]);
+        AK_free(rows[i]);
+    }
+    AK_free(rows);
+
+    //every row is a candidate of the words it has
+    AK_trigram_create(tblName, "name", indexName);
+    count = AK_trigram_test_count(indexName, "%charlie%", 1);
+    expected = num_rows - num_rows * 7 / 8 * 7 / 8 * 7 / 8;
+    if (AK_trigram_get_info(indexName, &info) == EXIT_SUCCESS && info.num_rows == num_rows && count >= expected &&
+        count < num_rows && AK_trigram_create(tblName, "id", "trigram_test_id") == EXIT_ERROR) {
+        printf("Index of %d rows gives %d candidates for %d rows with charlie\n", info.num_rows, count, expected);
+        passed_tests++;
+    } else {
+        printf("Index gives %d candidates for %d rows with charlie\n", count, expected);
+        failed_tests++;
+    }
+
+    //selections read only the candidates and check the pattern on each of them
+    wrong = 0;
+    snprintf(dstTable, MAX_ATT_NAME, "%s_like", tblName);
+    wrong += !AK_trigram_test_selection(tblName, dstTable, "LIKE", "alpha bravo%", num_rows / 64);
+    snprintf(dstTable, MAX_ATT_NAME, "%s_ilike", tblName);
+    wrong += !AK_trigram_test_selection(tblName, dstTable, "ILIKE", "CHARLIE golf%", num_rows / 64);
+    snprintf(dstTable, MAX_ATT_NAME, "%s_similar", tblName);
+    wrong += !AK_trigram_test_selection(tblName, dstTable, "SIMILAR TO", "(echo|golf) hotel charlie", 2);
+    snprintf(dstTable, MAX_ATT_NAME, "%s_regex", tblName);
+    wrong += !AK_trigram_test_selection(tblName, dstTable, "~", "^delta golf [a-z]+$", num_rows / 64);
+    if (wrong == 0) {
+        printf("LIKE, ILIKE, SIMILAR TO and ~ select the right rows through the index\n");
+        passed_tests++;
+    } else {
+        printf("%d of 4 selections through the index went wrong\n", wrong);
+        failed_tests++;
+    }
+
+    //the index follows rows that are added, changed and deleted
+    before = AK_trigram_test_count(indexName, "%zulu%", 1);
+    expected = AK_trigram_test_count(indexName, "%yank%", 1);
+    wrong = 0;
+    row_root = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    AK_Init_L3(&row_root);
+    //updates and deletes compare values as strings, so the id must not start with a zero byte
+    id = num_rows + 1;
+    AK_Insert_New_Element(TYPE_INT, &id, tblName, "id", row_root);
+    AK_Insert_New_Element(TYPE_VARCHAR, "zulu charlie", tblName, "name", row_root);
+    AK_insert_row(row_root);
+    wrong += AK_trigram_test_count(indexName, "%zulu%", 1) != before + 1;
+    AK_DeleteAll_L3(&row_root);
+    AK_Update_Existing_Element(TYPE_INT, &id, tblName, "id", row_root);
+    AK_Insert_New_Element(TYPE_VARCHAR, "yank charlie", tblName, "name", row_root);
+    AK_update_row(row_root);
+    wrong += AK_trigram_test_count(indexName, "%zulu%", 1) != before;
+    wrong += AK_trigram_test_count(indexName, "%yank%", 1) != expected + 1;
+    AK_DeleteAll_L3(&row_root);
+    AK_Update_Existing_Element(TYPE_INT, &id, tblName, "id", row_root);
+    AK_delete_row(row_root);
+    wrong += AK_trigram_test_count(indexName, "%yank%", 1) != expected;
+    AK_DeleteAll_L3(&row_root);
+    AK_free(row_root);
+    if (wrong == 0 && AK_trigram_get_info(indexName, &info) == EXIT_SUCCESS && info.num_rows == num_rows) {
+        printf("Index follows a row that is added, changed and deleted\n");
+        passed_tests++;
+    } else {
+        printf("Index does not follow %d changes of a row\n", wrong);
+        failed_tests++;
+    }
+
+    //deleted indices are gone
+    if (AK_trigram_delete(indexName) == EXIT_SUCCESS && AK_trigram_get_info(indexName, &info) == EXIT_ERROR &&
+        AK_trigram_delete(indexName) == EXIT_ERROR) {
+        printf("Deleted index is gone\n");
+        passed_tests++;
+    } else {
+        printf("Deleted index is still there\n");
+        failed_tests++;
+    }
+    AK_delete_segment(tblName, SEGMENT_TYPE_TABLE);
+
+    AK_EPI;
+    return TEST_result(passed_tests, failed_tests);
+}
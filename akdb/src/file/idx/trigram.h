@@ -0,0 +1,169 @@
+/**
+@file trigram.h Header file that provides data structures, functions and defines for trigram indices
+ */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#ifndef TRIGRAM
+#define TRIGRAM
+
+#include "../../auxi/test.h"
+#include "../../mm/memoman.h"
+#include "index.h"
+#include "bitmap.h"
+#include "../../file/table.h"
+#include "../../file/fileio.h"
+#include "../../file/files.h"
+#include "../../auxi/mempro.h"
+#include "../../auxi/constants.h"
+#include <ctype.h>
+#include <pthread.h>
+
+/**
+ * @author Karlo Vuković
+ * @struct AK_trigram_info
+ * @brief Structure at the start of the first block of a trigram index. It is followed by TRIGRAM_LISTS descriptions
+ *        of posting lists, AK_trigram_list, and the lists are kept in the other blocks of the index segment as
+ *        chains of pages of compressed bitmaps, like the bitmaps of a bitmap index.
+ */
+typedef struct {
+    /// name of the index
+    char name[MAX_ATT_NAME];
+    /// name of the indexed table
+    char table[MAX_ATT_NAME];
+    /// name of the indexed attribute
+    char attribute[MAX_ATT_NAME];
+    /// position of the attribute in the table
+    int position;
+    /// number of attributes of the table
+    int table_num_attr;
+    /// number of rows with a value of the attribute
+    int num_rows;
+    /// number of blocks of the segment in use, together with this one
+    int num_pages;
+    /// first page that is no longer used, free pages are chained through AK_bitmap_page.next, 0 if there are none
+    int free_list;
+} AK_trigram_info;
+
+/**
+ * @author Karlo Vuković
+ * @struct AK_trigram_list
+ * @brief Structure that describes a posting list of a trigram index, the bitmap of the rows whose values have a
+ *        trigram hashed to the list
+ */
+typedef struct {
+    /// first page of the bitmap, 0 if it has no words
+    int page;
+    /// number of words of the bitmap
+    int num_words;
+    /// number of bits of the bitmap
+    int num_bits;
+    /// number of rows in the list
+    int num_set;
+} AK_trigram_list;
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that creates a trigram index on a varchar attribute of a table. Every value is split into its
+ *        trigrams, three characters that follow each other, taken in lower case, and the row is added to the
+ *        posting list of each of them. Trigrams are hashed to TRIGRAM_LISTS lists, so a list can hold rows of
+ *        several trigrams. The index finds candidates for LIKE, ILIKE, SIMILAR TO and regular expressions. Tables
+ *        with the PAX layout can not be indexed.
+ * @param tblName name of the table
+ * @param attribute name of the attribute
+ * @param indexName name of the index
+ * @return EXIT_SUCCESS if the index was created, EXIT_ERROR otherwise
+ */
+int AK_trigram_create(char *tblName, char *attribute, char *indexName);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that deletes a trigram index
+ * @param indexName name of the index
+ * @return EXIT_SUCCESS if the index was deleted, EXIT_ERROR if there is no such index
+ */
+int AK_trigram_delete(char *indexName);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that reads the description of a trigram index
+ * @param indexName name of the index
+ * @param info description of the index
+ * @return EXIT_SUCCESS if the index exists, EXIT_ERROR otherwise
+ */
+int AK_trigram_get_info(char *indexName, AK_trigram_info *info);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that finds the trigrams every value matching a pattern has. They come from runs of characters
+ *        the pattern matches literally, and characters that may be left out or repeated, classes, groups and escapes
+ *        end a run. A pattern with alternatives outside groups requires no trigram.
+ * @param pattern pattern, a POSIX regular expression
+ * @param wildcards 1 if % and _ of the pattern are SQL wildcards, as in LIKE, ILIKE and SIMILAR TO
+ * @param lists array of TRIGRAM_LISTS elements for the posting lists of the trigrams
+ * @return number of posting lists, 0 if the pattern requires no trigram
+ */
+int AK_trigram_pattern(char *pattern, int wildcards, int *lists);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that finds the rows that can match a pattern in a trigram index, the rows in all posting lists of
+ *        the trigrams of the pattern. Lists hold rows of every trigram hashed to them, so not every candidate
+ *        matches and the pattern has to be checked on each of them.
+ * @param indexName name of the index
+ * @param pattern pattern
+ * @param wildcards 1 if % and _ of the pattern are SQL wildcards
+ * @param bitmap bitmap of the candidate rows, it is initialized by the function
+ * @return number of posting lists that were used, 0 if the pattern requires no trigram, EXIT_ERROR if there is no
+ *         such index
+ */
+int AK_trigram_candidates(char *indexName, char *pattern, int wildcards, AK_bitmap *bitmap);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that applies changes of rows of the indexed table to a trigram index. Changes are split into the
+ *        posting lists of the trigrams of the rows, grouped by list and sorted by row, so every list that changed is
+ *        combined with the changed bits and written once.
+ * @param indexName name of the index
+ * @param deltas changes of rows of the table
+ * @param num_deltas number of changes
+ * @return EXIT_SUCCESS, EXIT_ERROR if there is no such index or it could not be extended
+ */
+int AK_trigram_apply(char *indexName, AK_index_delta *deltas, int num_deltas);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that finds patterns that varchar attributes have to match in every row satisfying the postfix
+ *        expression. The expression is followed with AK_expression_walk, and only LIKE, ILIKE, SIMILAR TO, ~ and ~*
+ *        of an attribute with a constant and AND give patterns.
+ * @param expr postfix expression, may be NULL
+ * @param header table header
+ * @param num_attr number of attributes
+ * @param patterns pattern of each attribute, NULL if there is none
+ * @param wildcards 1 for each attribute whose pattern has SQL wildcards, 0 otherwise
+ * @return number of attributes with a pattern
+ */
+int AK_trigram_expr_patterns(struct list_node *expr, AK_header *header, int num_attr, struct list_node **patterns,
+                             int *wildcards);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function for testing trigram indices
+ * @return TestResult
+ */
+TestResult AK_trigram_test();
+
+#endif
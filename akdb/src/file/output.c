@@ -0,0 +1,728 @@
+/**
+@file output.c Provides functions for streaming output of tables
+ */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#include <stdarg.h>
+#include "output.h"
+#include "table.h"
+#include "bulk.h"
+
+/**
+ * @author Karlo Vuković
+ * @struct AK_output_buffer
+ * @brief Structure that collects the output, so it is written to the stream in large parts
+ */
+typedef struct {
+    /// stream the output is written to
+    FILE *fp;
+    /// number of bytes in the buffer
+    int used;
+    /// bytes that were not written yet
+    char data[OUTPUT_BUFFER_SIZE];
+} AK_output_buffer;
+
+/**
+ * @author Karlo Vuković
+ * @struct AK_output_cursor
+ * @brief Structure that holds the position of a pass over the rows in the blocks of a table
+ */
+typedef struct {
+    /// addresses of the table extents
+    table_addresses *addresses;
+    /// current extent
+    int extent;
+    /// address of the current block
+    int block;
+    /// entry of the tuple dictionary where the next row starts
+    int tuple;
+    /// current block, NULL if the next block has to be read
+    AK_block *current;
+} AK_output_cursor;
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that writes the collected output to the stream
+ * @param out output buffer
+ * @return No return value
+ */
+static void AK_output_flush(AK_output_buffer *out) {
+    if (out->used > 0)
+        fwrite(out->data, 1, out->used, out->fp);
+    out->used = 0;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that appends bytes to the output
+ * @param out output buffer
+ * @param data bytes to write
+ * @param size number of bytes
+ * @return No return value
+ */
+static void AK_output_write(AK_output_buffer *out, const void *data, int size) {
+    if (out->used + size > OUTPUT_BUFFER_SIZE)
+        AK_output_flush(out);
+    if (size > OUTPUT_BUFFER_SIZE) {
+        fwrite(data, 1, size, out->fp);
+        return;
+    }
+    memcpy(out->data + out->used, data, size);
+    out->used += size;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that appends formatted text to the output
+ * @param out output buffer
+ * @param format format like in printf
+ * @return No return value
+ */
+static void AK_output_printf(AK_output_buffer *out, const char *format, ...) {
+    va_list args;
+    int size;
+
+    va_start(args, format);
+    size = vsnprintf(out->data + out->used, OUTPUT_BUFFER_SIZE - out->used, format, args);
+    va_end(args);
+    if (size >= OUTPUT_BUFFER_SIZE - out->used) {
+        AK_output_flush(out);
+        va_start(args, format);
+        size = vsnprintf(out->data, OUTPUT_BUFFER_SIZE, format, args);
+        va_end(args);
+        //text longer than the whole buffer goes straight to the stream
+        if (size >= OUTPUT_BUFFER_SIZE) {
+            va_start(args, format);
+            vfprintf(out->fp, format, args);
+            va_end(args);
+            size = 0;
+        }
+    }
+    out->used += size;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that moves the cursor to the first block of the next extent
+ * @param cursor cursor
+ * @return No return value
+ */
+static void AK_output_next_extent(AK_output_cursor *cursor) {
+    cursor->extent++;
+    cursor->current = NULL;
+    if (cursor->extent < MAX_EXTENTS_IN_SEGMENT)
+        cursor->block = cursor->addresses->address_from[cursor->extent];
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that returns the next row of the table. Rows are visited in the order of the blocks, like in
+ *        AK_print_table, and entries with size 0 are deleted rows.
+ * @param cursor cursor
+ * @param num_attr number of attributes
+ * @param block block that holds the returned row
+ * @return first entry of the row in the tuple dictionary, NULL after the last row
+ */
+static AK_tuple_dict *AK_output_next_row(AK_output_cursor *cursor, int num_attr, AK_block **block) {
+    int k;
+
+    while (cursor->extent < MAX_EXTENTS_IN_SEGMENT && cursor->addresses->address_from[cursor->extent] != 0) {
+        if (cursor->current == NULL) {
+            if (cursor->block >= cursor->addresses->address_to[cursor->extent]) {
+                AK_output_next_extent(cursor);
+                continue;
+            }
+            cursor->current = AK_get_block(cursor->block)->block;
+            cursor->tuple = 0;
+            //rows are kept at the beginning of the extent
+            if (cursor->current->last_tuple_dict_id == 0) {
+                AK_output_next_extent(cursor);
+                continue;
+            }
+        }
+        while (cursor->tuple + num_attr <= DATA_BLOCK_SIZE) {
+            k = cursor->tuple;
+            cursor->tuple += num_attr;
+            if (cursor->current->tuple_dict[k].size > 0) {
+                *block = cursor->current;
+                return &cursor->current->tuple_dict[k];
+            }
+        }
+        cursor->current = NULL;
+        cursor->block++;
+    }
+    return NULL;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that returns the number of characters the value takes in the printed table
+ * @param block block that holds the value
+ * @param tuple entry of the value in the tuple dictionary
+ * @return width of the value
+ */
+static int AK_output_value_width(AK_block *block, AK_tuple_dict *tuple) {
+    int int_value;
+    float float_value;
+
+    switch (tuple->type) {
+        case FREE_CHAR:
+            return strlen("null");
+        case TYPE_INT:
+            memcpy(&int_value, block->data + tuple->address, sizeof (int));
+            return snprintf(NULL, 0, "%i", int_value);
+        case TYPE_FLOAT:
+            memcpy(&float_value, block->data + tuple->address, sizeof (float));
+            return snprintf(NULL, 0, "%.3f", float_value);
+        case TYPE_VARCHAR:
+        default:
+            return tuple->size;
+    }
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that writes the rows of the table in boxes. The first pass over the blocks finds the width of
+ *        each column and the second one writes the rows, so only the widths are kept in memory.
+ * @param out output buffer
+ * @param tblName table name
+ * @param header table header
+ * @param num_attr number of attributes
+ * @return number of written rows
+ */
+static int AK_output_boxes(AK_output_buffer *out, char *tblName, AK_header *header, int num_attr) {
+    AK_output_cursor cursor;
+    AK_tuple_dict *tuple;
+    AK_block *block;
+    int len[num_attr];
+    int num_rows = 0, length = 0, width, i, j, k, col, temp;
+    int int_value;
+    float float_value;
+    char *spacer;
+
+    cursor.addresses = AK_get_table_addresses(tblName);
+
+    for (i = 0; i < num_attr; i++)
+        len[i] = strlen(header[i].att_name);
+
+    cursor.extent = -1;
+    AK_output_next_extent(&cursor);
+    while ((tuple = AK_output_next_row(&cursor, num_attr, &block)) != NULL) {
+        for (i = 0; i < num_attr; i++) {
+            width = AK_output_value_width(block, &tuple[i]);
+            if (len[i] < width)
+                len[i] = width;
+        }
+        num_rows++;
+    }
+
+    AK_output_printf(out, "Table: %s\n", tblName);
+    if (num_attr <= 0 || num_rows <= 0) {
+        AK_output_printf(out, "Table is empty.\n");
+        AK_free(cursor.addresses);
+        return 0;
+    }
+
+    //the spacer is the same for every row, so it is made only once, like in AK_print_row_spacer
+    for (i = 0; i < num_attr; length += len[i++]);
+    length += num_attr * TBL_BOX_OFFSET + 2 * num_attr + 1;
+    spacer = (char *) AK_malloc(length);
+    j = col = temp = 0;
+    for (i = 0; i < length; i++) {
+        if (!i || i == temp + j) {
+            j += TBL_BOX_OFFSET + 1;
+            //the last '+' closes the row and has no column after it
+            temp += (col < num_attr ? len[col] : 0) + 1;
+            col++;
+            spacer[i] = '+';
+        } else {
+            spacer[i] = '-';
+        }
+    }
+
+    AK_output_write(out, spacer, length);
+    AK_output_printf(out, "\n|");
+    for (i = 0; i < num_attr; i++) {
+        //attributes are center aligned inside box
+        width = strlen(header[i].att_name);
+        k = len[i] - width + TBL_BOX_OFFSET + 1;
+        if (k % 2 == 0) {
+            k /= 2;
+            AK_output_printf(out, "%-*s%-*s|", k, " ", k + width, header[i].att_name);
+        } else {
+            k /= 2;
+            AK_output_printf(out, "%-*s%-*s|", k, " ", k + width + 1, header[i].att_name);
+        }
+    }
+    AK_output_printf(out, "\n");
+    AK_output_write(out, spacer, length);
+
+    cursor.extent = -1;
+    AK_output_next_extent(&cursor);
+    while ((tuple = AK_output_next_row(&cursor, num_attr, &block)) != NULL) {
+        AK_output_printf(out, "\n|");
+        for (i = 0; i < num_attr; i++) {
+            switch (tuple[i].type) {
+                case FREE_CHAR:
+                    AK_output_printf(out, " %-*s|", len[i] + TBL_BOX_OFFSET, "null");
+                    break;
+                case TYPE_INT:
+                    memcpy(&int_value, block->data + tuple[i].address, sizeof (int));
+                    AK_output_printf(out, "%*i |", len[i] + TBL_BOX_OFFSET, int_value);
+                    break;
+                case TYPE_FLOAT:
+                    memcpy(&float_value, block->data + tuple[i].address, sizeof (float));
+                    AK_output_printf(out, "%*.3f |", len[i] + TBL_BOX_OFFSET, float_value);
+                    break;
+                case TYPE_VARCHAR:
+                default:
+                    AK_output_printf(out, " %-*.*s|", len[i] + TBL_BOX_OFFSET, tuple[i].size, block->data + tuple[i].address);
+                    break;
+            }
+        }
+        AK_output_printf(out, "\n");
+        AK_output_write(out, spacer, length);
+    }
+    AK_output_printf(out, "\n");
+
+    AK_free(spacer);
+    AK_free(cursor.addresses);
+    return num_rows;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that writes one CSV value, enclosed in double quotes if it has to be
+ * @param out output buffer
+ * @param value value
+ * @param size size of the value
+ * @param delimiter character that separates values
+ * @return No return value
+ */
+static void AK_output_csv_value(AK_output_buffer *out, char *value, int size, char delimiter) {
+    int quote = (size == 0);
+    int i;
+
+    for (i = 0; i < size && !quote; i++) {
+        if (value[i] == delimiter || value[i] == '"' || value[i] == '\n' || value[i] == '\r')
+            quote = 1;
+    }
+    if (!quote) {
+        AK_output_write(out, value, size);
+        return;
+    }
+    AK_output_write(out, "\"", 1);
+    for (i = 0; i < size; i++) {
+        if (value[i] == '"')
+            AK_output_write(out, "\"", 1);
+        AK_output_write(out, &value[i], 1);
+    }
+    AK_output_write(out, "\"", 1);
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that writes the rows of the table as CSV in one pass over the blocks. Null values are written as
+ *        empty values and floats with enough digits to be read back unchanged.
+ * @param out output buffer
+ * @param tblName table name
+ * @param header table header
+ * @param num_attr number of attributes
+ * @param delimiter character that separates values
+ * @param has_header 1 if the first line should hold attribute names
+ * @return number of written rows
+ */
+static int AK_output_csv(AK_output_buffer *out, char *tblName, AK_header *header, int num_attr, char delimiter, int has_header) {
+    AK_output_cursor cursor;
+    AK_tuple_dict *tuple;
+    AK_block *block;
+    int num_rows = 0, i;
+    int int_value;
+    float float_value;
+
+    if (has_header) {
+        for (i = 0; i < num_attr; i++) {
+            if (i > 0)
+                AK_output_write(out, &delimiter, 1);
+            AK_output_csv_value(out, header[i].att_name, strlen(header[i].att_name), delimiter);
+        }
+        AK_output_write(out, "\n", 1);
+    }
+
+    cursor.addresses = AK_get_table_addresses(tblName);
+    cursor.extent = -1;
+    AK_output_next_extent(&cursor);
+    while ((tuple = AK_output_next_row(&cursor, num_attr, &block)) != NULL) {
+        for (i = 0; i < num_attr; i++) {
+            if (i > 0)
+                AK_output_write(out, &delimiter, 1);
+            switch (tuple[i].type) {
+                case FREE_CHAR:
+                    break;
+                case TYPE_INT:
+                    memcpy(&int_value, block->data + tuple[i].address, sizeof (int));
+                    AK_output_printf(out, "%i", int_value);
+                    break;
+                case TYPE_FLOAT:
+                    memcpy(&float_value, block->data + tuple[i].address, sizeof (float));
+                    AK_output_printf(out, "%.9g", float_value);
+                    break;
+                case TYPE_VARCHAR:
+                default:
+                    AK_output_csv_value(out, block->data + tuple[i].address, tuple[i].size, delimiter);
+                    break;
+            }
+        }
+        AK_output_write(out, "\n", 1);
+        num_rows++;
+    }
+
+    AK_free(cursor.addresses);
+    return num_rows;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that writes the rows of the table in the binary format described in AK_output_table, in one pass
+ *        over the blocks
+ * @param out output buffer
+ * @param tblName table name
+ * @param header table header
+ * @param num_attr number of attributes
+ * @return number of written rows
+ */
+static int AK_output_binary(AK_output_buffer *out, char *tblName, AK_header *header, int num_attr) {
+    AK_output_cursor cursor;
+    AK_tuple_dict *tuple;
+    AK_block *block;
+    char name[MAX_ATT_NAME];
+    int num_rows = 0, end = OUTPUT_BINARY_END, size, i;
+
+    AK_output_write(out, OUTPUT_BINARY_MAGIC, strlen(OUTPUT_BINARY_MAGIC));
+    AK_output_write(out, &num_attr, sizeof (int));
+    for (i = 0; i < num_attr; i++) {
+        memset(name, 0, MAX_ATT_NAME);
+        strncpy(name, header[i].att_name, MAX_ATT_NAME - 1);
+        AK_output_write(out, &header[i].type, sizeof (int));
+        AK_output_write(out, name, MAX_ATT_NAME);
+    }
+
+    cursor.addresses = AK_get_table_addresses(tblName);
+    cursor.extent = -1;
+    AK_output_next_extent(&cursor);
+    while ((tuple = AK_output_next_row(&cursor, num_attr, &block)) != NULL) {
+        for (i = 0; i < num_attr; i++) {
+            //entries of numbers can be larger than the number, only the number is written
+            switch (tuple[i].type) {
+                case TYPE_INT:
+                    size = sizeof (int);
+                    break;
+                case TYPE_FLOAT:
+                    size = sizeof (float);
+                    break;
+                default:
+                    size = tuple[i].size;
+                    break;
+            }
+            AK_output_write(out, &size, sizeof (int));
+            AK_output_write(out, block->data + tuple[i].address, size);
+        }
+        num_rows++;
+    }
+    AK_output_write(out, &end, sizeof (int));
+
+    AK_free(cursor.addresses);
+    return num_rows;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that writes the table to the stream in the given format
+ * @param tblName table name
+ * @param fp stream
+ * @param format OUTPUT_FORMAT_TABLE, OUTPUT_FORMAT_CSV or OUTPUT_FORMAT_BINARY
+ * @param delimiter character that separates CSV values
+ * @param has_header 1 if CSV output should start with attribute names
+ * @return number of written rows, EXIT_ERROR if the table does not exist or the format is unknown
+ */
+static int AK_output_stream(char *tblName, FILE *fp, int format, char delimiter, int has_header) {
+    AK_output_buffer *out;
+    AK_header *header;
+    table_addresses *addresses;
+    int num_attr, num_rows;
+
+    addresses = AK_get_table_addresses(tblName);
+    num_attr = AK_num_attr(tblName);
+    if (addresses->address_from[0] == 0 || num_attr <= 0) {
+        AK_free(addresses);
+        return EXIT_ERROR;
+    }
+    AK_free(addresses);
+
+    header = AK_get_header(tblName);
+    out = (AK_output_buffer *) AK_malloc(sizeof (AK_output_buffer));
+    out->fp = fp;
+    out->used = 0;
+
+    switch (format) {
+        case OUTPUT_FORMAT_TABLE:
+            num_rows = AK_output_boxes(out, tblName, header, num_attr);
+            break;
+        case OUTPUT_FORMAT_CSV:
+            num_rows = AK_output_csv(out, tblName, header, num_attr, delimiter, has_header);
+            break;
+        case OUTPUT_FORMAT_BINARY:
+            num_rows = AK_output_binary(out, tblName, header, num_attr);
+            break;
+        default:
+            num_rows = EXIT_ERROR;
+            break;
+    }
+
+    AK_output_flush(out);
+    AK_free(out);
+    AK_free(header);
+    return num_rows;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that writes all rows of the table to the stream in one of the output formats
+ * @param tblName table name
+ * @param fp stream the table is written to
+ * @param format OUTPUT_FORMAT_TABLE, OUTPUT_FORMAT_CSV or OUTPUT_FORMAT_BINARY
+ * @return number of written rows, EXIT_ERROR if the table does not exist or the format is unknown
+ */
+int AK_output_table(char *tblName, FILE *fp, int format) {
+    int num_rows;
+    AK_PRO;
+    num_rows = AK_output_stream(tblName, fp, format, ',', 1);
+    AK_EPI;
+    return num_rows;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that writes the contents of the table into a CSV file, like COPY ... TO in SQL
+ * @param tblName table name
+ * @param fileName path to the CSV file, the file is overwritten
+ * @param delimiter character that separates values
+ * @param has_header 1 if the first line should hold attribute names, otherwise 0
+ * @return number of written rows, EXIT_ERROR if the table does not exist or the file can not be opened
+ */
+int AK_copy_to_csv(char *tblName, char *fileName, char delimiter, int has_header) {
+    FILE *fp;
+    int num_rows;
+    AK_PRO;
+
+    if ((fp = fopen(fileName, "w")) == NULL) {
+        printf("AK_copy_to_csv: Could not open file %s\n", fileName);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    num_rows = AK_output_stream(tblName, fp, OUTPUT_FORMAT_CSV, delimiter, has_header);
+    fclose(fp);
+    if (num_rows == EXIT_ERROR)
+        printf("AK_copy_to_csv: Table %s does not exist!\n", tblName);
+
+    AK_EPI;
+    return num_rows;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that reads the whole stream into memory
+ * @param fp stream
+ * @param size number of read bytes
+ * @return contents of the stream terminated with '\0', has to be freed with AK_free
+ */
+static char *AK_output_test_read(FILE *fp, long *size) {
+    char *data;
+
+    fseek(fp, 0, SEEK_END);
+    *size = ftell(fp);
+    rewind(fp);
+    data = (char *) AK_malloc(*size + 1);
+    *size = fread(data, 1, *size, fp);
+    data[*size] = '\0';
+    return data;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that creates an empty test table, deleting the old one
+ * @param tblName table name
+ * @param t_header table header
+ * @return EXIT_SUCCESS if the table was created, otherwise EXIT_ERROR
+ */
+static int AK_output_test_table(char *tblName, AK_header *t_header) {
+    if (AK_num_attr(tblName) > 0)
+        AK_delete_segment(tblName, SEGMENT_TYPE_TABLE);
+    return AK_initialize_new_segment(tblName, SEGMENT_TYPE_TABLE, t_header);
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function for testing streaming output of tables
+ * @return TestResult
+ */
+TestResult AK_output_test() {
+    char *tblName = "output_test";
+    char *copyName = "output_copy";
+    char *fileName = "output_test.csv";
+    int num_rows = 600;
+    int ok = 0, fail = 0;
+    int i, id, rows, lines, boxes, spacers, width, num_attr, size = 0;
+    float score;
+    char name[MAX_VARCHAR_LENGTH];
+    char *data, *copy_data, *line, *next, *p;
+    long data_size, copy_size;
+    struct list_node **row_list;
+    FILE *fp;
+    clock_t t;
+    AK_PRO;
+
+    printf("\n********** OUTPUT TEST **********\n\n");
+
+    AK_header t_header[4] = {
+        {TYPE_INT, "id", {0}, {{'\0'}}, {{'\0'}}},
+        {TYPE_VARCHAR, "name", {0}, {{'\0'}}, {{'\0'}}},
+        {TYPE_FLOAT, "score", {0}, {{'\0'}}, {{'\0'}}},
+        {0, {'\0'}, {0}, {{'\0'}}, {{'\0'}}}};
+
+    if (AK_output_test_table(tblName, t_header) == EXIT_ERROR || AK_output_test_table(copyName, t_header) == EXIT_ERROR) {
+        printf("Could not create test tables\n");
+        AK_EPI;
+        return TEST_result(0, 1);
+    }
+
+    //some names need quotes in CSV
+    row_list = (struct list_node **) AK_calloc(num_rows, sizeof (struct list_node *));
+    for (i = 0; i < num_rows; i++) {
+        id = i;
+        score = i * 0.25f - 20;
+        if (i % 5 == 0)
+            sprintf(name, "name, \"%d\"", i);
+        else
+            sprintf(name, "name %d", i);
+        row_list[i] = (struct list_node *) AK_malloc(sizeof (struct list_node));
+        AK_Init_L3(&row_list[i]);
+        AK_Insert_New_Element(TYPE_INT, &id, tblName, "id", row_list[i]);
+        AK_Insert_New_Element(TYPE_VARCHAR, name, tblName, "name", row_list[i]);
+        AK_Insert_New_Element(TYPE_FLOAT, &score, tblName, "score", row_list[i]);
+    }
+    AK_bulk_insert(tblName, row_list, num_rows);
+    for (i = 0; i < num_rows; i++) {
+        AK_DeleteAll_L3(&row_list[i]);
+        AK_free(row_list[i]);
+    }
+    AK_free(row_list);
+
+    //boxes: every line of the table has the same width
+    fp = tmpfile();
+    t = clock();
+    rows = AK_output_table(tblName, fp, OUTPUT_FORMAT_TABLE);
+    t = clock() - t;
+    printf("Table with %d rows written in %f s\n", rows, ((double) t) / CLOCKS_PER_SEC);
+    data = AK_output_test_read(fp, &data_size);
+    fclose(fp);
+    lines = boxes = spacers = 0;
+    width = -1;
+    for (line = data; *line != '\0'; line = next) {
+        next = strchr(line, '\n');
+        if (next == NULL)
+            next = line + strlen(line);
+        else
+            *next++ = '\0';
+        if (lines++ == 0 && strcmp(line, "Table: output_test") != 0)
+            width = -2;
+        if (line[0] != '|' && line[0] != '+')
+            continue;
+        if (line[0] == '|')
+            boxes++;
+        else
+            spacers++;
+        if (width == -1)
+            width = strlen(line);
+        else if (width != (int) strlen(line))
+            width = -2;
+    }
+    AK_free(data);
+    printf("Boxes: %d rows, %d spacers, width %d\n", boxes, spacers, width);
+    if (rows == num_rows && boxes == num_rows + 1 && spacers == num_rows + 2 && width > 0)
+        ok++;
+    else
+        fail++;
+
+    //CSV: the file is loaded into another table
+    rows = AK_copy_to_csv(tblName, fileName, ',', 1);
+    if (rows == num_rows && AK_copy_from_csv(copyName, fileName, ',', 1) == EXIT_SUCCESS && AK_get_num_records(copyName) == num_rows)
+        ok++;
+    else
+        fail++;
+    remove(fileName);
+
+    //binary: both tables give the same output
+    fp = tmpfile();
+    rows = AK_output_table(tblName, fp, OUTPUT_FORMAT_BINARY);
+    data = AK_output_test_read(fp, &data_size);
+    fclose(fp);
+    fp = tmpfile();
+    AK_output_table(copyName, fp, OUTPUT_FORMAT_BINARY);
+    copy_data = AK_output_test_read(fp, &copy_size);
+    fclose(fp);
+    if (rows == num_rows && data_size == copy_size && memcmp(data, copy_data, data_size) == 0)
+        ok++;
+    else
+        fail++;
+
+    //binary: rows can be read back in order
+    p = data + strlen(OUTPUT_BINARY_MAGIC);
+    memcpy(&num_attr, p, sizeof (int));
+    p += sizeof (int) + num_attr * (sizeof (int) + MAX_ATT_NAME);
+    rows = 0;
+    if (memcmp(data, OUTPUT_BINARY_MAGIC, strlen(OUTPUT_BINARY_MAGIC)) == 0 && num_attr == 3) {
+        while (p < data + data_size) {
+            memcpy(&size, p, sizeof (int));
+            if (size == OUTPUT_BINARY_END)
+                break;
+            memcpy(&id, p + sizeof (int), sizeof (int));
+            if (id != rows)
+                break;
+            for (i = 0; i < num_attr; i++) {
+                memcpy(&size, p, sizeof (int));
+                p += sizeof (int) + size;
+            }
+            rows++;
+        }
+    }
+    printf("Binary output: %ld bytes, %d rows read back\n", data_size, rows);
+    if (rows == num_rows && size == OUTPUT_BINARY_END)
+        ok++;
+    else
+        fail++;
+    AK_free(data);
+    AK_free(copy_data);
+
+    if (AK_output_table("output_missing", stdout, OUTPUT_FORMAT_CSV) == EXIT_ERROR && AK_output_table(tblName, stdout, -1) == EXIT_ERROR)
+        ok++;
+    else
+        fail++;
+
+    AK_EPI;
+    return TEST_result(ok, fail);
+}
@@ -0,0 +1,66 @@
+/**
+@file output.h Header file that provides functions and defines for streaming output of tables
+ */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#ifndef OUTPUT
+#define OUTPUT
+
+#include "../auxi/test.h"
+#include "../auxi/constants.h"
+#include "../auxi/configuration.h"
+#include "../mm/memoman.h"
+#include "../auxi/mempro.h"
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that writes all rows of the table to the stream. Rows are read straight from the blocks of the
+ *        table and the output is collected in a buffer of OUTPUT_BUFFER_SIZE bytes before it is written.
+ *        OUTPUT_FORMAT_TABLE prints the table in boxes, like AK_print_table, and needs one more pass over the blocks
+ *        to find the width of each column. OUTPUT_FORMAT_CSV writes the attribute names and then one line per row.
+ *        OUTPUT_FORMAT_BINARY writes OUTPUT_BINARY_MAGIC, the number of attributes, the type and the name
+ *        (MAX_ATT_NAME bytes) of each attribute, and then the size and the bytes of every value, with
+ *        OUTPUT_BINARY_END in place of the size after the last row. Numbers are written in the byte order of the
+ *        machine, an int or a float value takes 4 bytes.
+ * @param tblName table name
+ * @param fp stream the table is written to
+ * @param format OUTPUT_FORMAT_TABLE, OUTPUT_FORMAT_CSV or OUTPUT_FORMAT_BINARY
+ * @return number of written rows, EXIT_ERROR if the table does not exist or the format is unknown
+ */
+int AK_output_table(char *tblName, FILE *fp, int format);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that writes the contents of the table into a CSV file, like COPY ... TO in SQL. Values that
+ *        contain the delimiter, a double quote or a line terminator are enclosed in double quotes, so the file can
+ *        be loaded again with AK_copy_from_csv.
+ * @param tblName table name
+ * @param fileName path to the CSV file, the file is overwritten
+ * @param delimiter character that separates values
+ * @param has_header 1 if the first line should hold attribute names, otherwise 0
+ * @return number of written rows, EXIT_ERROR if the table does not exist or the file can not be opened
+ */
+int AK_copy_to_csv(char *tblName, char *fileName, char delimiter, int has_header);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function for testing streaming output of tables
+ * @return TestResult
+ */
+TestResult AK_output_test();
+
+#endif
@@ -0,0 +1,662 @@
+/**
+@file overflow.c Provides functions for overflow pages of long values
+ */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#include "overflow.h"
+#include "table.h"
+#include "fileio.h"
+#include <time.h>
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that returns the length of the part stored in the overflow page
+ * @param block overflow page
+ * @return length of the part, FREE_INT if the page is free
+ */
+static int AK_overflow_page_length(AK_block *block) {
+    int length;
+    memcpy(&length, block->data, sizeof(int));
+    return length;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that allocates a new extent of the table and turns all of its blocks into free overflow pages.
+ *        Overflow pages keep last_tuple_dict_id at 0, so functions that read rows stop at the first block of the
+ *        extent, and their AK_free_space is set to MAX_FREE_SPACE_SIZE, so rows are never written into them.
+ * @param tblName table name
+ * @return address of the first page, EXIT_ERROR if the extent could not be allocated
+ */
+int AK_overflow_new_extent(char *tblName) {
+    table_addresses *addresses;
+    AK_mem_block *mem_block;
+    int start, end = 0, free_length = FREE_INT;
+    int i;
+    AK_PRO;
+
+    start = AK_init_new_extent(tblName, SEGMENT_TYPE_TABLE);
+    if (start <= 0) {
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+
+    addresses = AK_get_table_addresses(tblName);
+    for (i = 0; i < MAX_EXTENTS_IN_SEGMENT && addresses->address_from[i] != 0; i++) {
+        if (addresses->address_from[i] == start)
+            end = addresses->address_to[i];
+    }
+    AK_free(addresses);
+
+    for (i = start; i < end; i++) {
+        mem_block = AK_get_block(i);
+        mem_block->block->type = BLOCK_TYPE_OVERFLOW;
+        mem_block->block->chained_with = NOT_CHAINED;
+        mem_block->block->AK_free_space = MAX_FREE_SPACE_SIZE;
+        mem_block->block->last_tuple_dict_id = 0;
+        memcpy(mem_block->block->data, &free_length, sizeof(int));
+        AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+    }
+
+    AK_dbg_messg(HIGH, FILE_MAN, "AK_overflow_new_extent: table %s, pages %d - %d\n", tblName, start, end - 1);
+    AK_EPI;
+    return end > start ? start : EXIT_ERROR;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that collects free overflow pages of the table. Only extents whose first block is an overflow
+ *        page are searched, and new extents are allocated until there are enough pages.
+ * @param tblName table name
+ * @param pages array the page addresses are written to
+ * @param num_pages number of pages needed
+ * @return EXIT_SUCCESS if all pages were found, otherwise EXIT_ERROR
+ */
+static int AK_overflow_find_pages(char *tblName, int *pages, int num_pages) {
+    table_addresses *addresses;
+    AK_block *block;
+    int found;
+    int i, j;
+    AK_PRO;
+
+    while (1) {
+        found = 0;
+        addresses = AK_get_table_addresses(tblName);
+        for (i = 0; i < MAX_EXTENTS_IN_SEGMENT && addresses->address_from[i] != 0 && found < num_pages; i++) {
+            if (AK_get_block(addresses->address_from[i])->block->type != BLOCK_TYPE_OVERFLOW)
+                continue;
+            for (j = addresses->address_from[i]; j < addresses->address_to[i] && found < num_pages; j++) {
+                block = AK_get_block(j)->block;
+                if (AK_overflow_page_length(block) == FREE_INT)
+                    pages[found++] = j;
+            }
+        }
+        AK_free(addresses);
+
+        if (found == num_pages)
+            break;
+        if (AK_overflow_new_extent(tblName) == EXIT_ERROR) {
+            AK_EPI;
+            return EXIT_ERROR;
+        }
+    }
+
+    AK_EPI;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that stores a long value into overflow pages of the table. The value is split into parts of
+ *        OVERFLOW_PAGE_SIZE bytes and each page is chained with the page holding the next part. Free pages are
+ *        reused before new extents are allocated. The returned address is stored in the row instead of the value.
+ * @param tblName table name
+ * @param value value to store
+ * @param length length of the value in bytes
+ * @return address of the first page, EXIT_ERROR if the value could not be stored
+ */
+int AK_overflow_write(char *tblName, char *value, int length) {
+    AK_mem_block *mem_block;
+    int *pages;
+    int num_pages, part, i;
+    AK_PRO;
+
+    if (value == NULL || length < 0 || AK_num_attr(tblName) <= 0) {
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+
+    num_pages = length > 0 ? (length - 1) / OVERFLOW_PAGE_SIZE + 1 : 1;
+    pages = (int *) AK_malloc(sizeof(int) * num_pages);
+    if (AK_overflow_find_pages(tblName, pages, num_pages) == EXIT_ERROR) {
+        printf("AK_overflow_write: Could not allocate %d overflow pages for table %s\n", num_pages, tblName);
+        AK_free(pages);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+
+    for (i = 0; i < num_pages; i++) {
+        part = length - i * OVERFLOW_PAGE_SIZE;
+        if (part > OVERFLOW_PAGE_SIZE)
+            part = OVERFLOW_PAGE_SIZE;
+        mem_block = AK_get_block(pages[i]);
+        memcpy(mem_block->block->data, &part, sizeof(int));
+        memcpy(mem_block->block->data + sizeof(int), value + i * OVERFLOW_PAGE_SIZE, part);
+        mem_block->block->chained_with = i + 1 < num_pages ? pages[i + 1] : NOT_CHAINED;
+        AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+    }
+
+    i = pages[0];
+    AK_free(pages);
+    AK_dbg_messg(HIGH, FILE_MAN, "AK_overflow_write: %d bytes in %d pages from %d\n", length, num_pages, i);
+    AK_EPI;
+    return i;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that returns an overflow page without caching it. A page in the cache is returned as it is, other
+ *        pages are read from the disk, so reading a long value never evicts a block the caller is working with.
+ * @param address address of the page
+ * @param copy set to 1 if the page was read from the disk and has to be freed with AK_free, otherwise 0
+ * @return page
+ */
+static AK_block *AK_overflow_get_page(int address, int *copy) {
+    AK_db_cache *cache = db_cache.ptr;
+    int i;
+
+    *copy = 0;
+    for (i = 0; i < MAX_CACHE_MEMORY; i++) {
+        if (cache->cache[i]->block->address == address)
+            return cache->cache[i]->block;
+    }
+    *copy = 1;
+    return AK_read_block(address);
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that reads a long value from overflow pages. Pages are not brought into the cache, so the value can
+ *        be read while a block of the table is in use.
+ * @param address address of the first page, as returned by AK_overflow_write
+ * @param length length of the value in bytes
+ * @return value terminated with '\0' that has to be freed with AK_free, NULL if there is no value on the address
+ */
+char *AK_overflow_read(int address, int *length) {
+    AK_block *block;
+    char *value = NULL;
+    int page, part, copy, total = 0;
+    AK_PRO;
+
+    *length = 0;
+    for (page = address; page != NOT_CHAINED;) {
+        block = AK_overflow_get_page(page, &copy);
+        part = AK_overflow_page_length(block);
+        if (block->type != BLOCK_TYPE_OVERFLOW || part < 0 || part > OVERFLOW_PAGE_SIZE) {
+            if (copy)
+                AK_free(block);
+            if (value != NULL)
+                AK_free(value);
+            AK_EPI;
+            return NULL;
+        }
+        value = (char *) AK_realloc(value, total + part + 1);
+        memcpy(value + total, block->data + sizeof(int), part);
+        total += part;
+        page = block->chained_with;
+        if (copy)
+            AK_free(block);
+    }
+    value[total] = '\0';
+    *length = total;
+
+    AK_EPI;
+    return value;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that copies the value of an entry of the tuple dictionary. A value stored in overflow pages is read
+ *        from them and given as a varchar, cut to MAX_VARCHAR_LENGTH - 1 characters like any value of a list.
+ * @param block block
+ * @param id index of the entry
+ * @param data buffer of MAX_VARCHAR_LENGTH characters the value is copied to, it is terminated with '\0'
+ * @param type type of the value
+ * @return size of the value
+ */
+int AK_overflow_entry_value(AK_block *block, int id, char *data, int *type) {
+    char *value;
+    int page, size = block->tuple_dict[id].size;
+
+    *type = block->tuple_dict[id].type;
+    memset(data, '\0', MAX_VARCHAR_LENGTH);
+    if (*type == TYPE_OVERFLOW) {
+        *type = TYPE_VARCHAR;
+        //tombstones keep the address of their pages, but they have no value
+        if (size != sizeof(int))
+            return 0;
+        memcpy(&page, block->data + block->tuple_dict[id].address, sizeof(int));
+        value = AK_overflow_read(page, &size);
+        if (value == NULL)
+            return 0;
+        if (size >= MAX_VARCHAR_LENGTH)
+            size = MAX_VARCHAR_LENGTH - 1;
+        memcpy(data, value, size);
+        AK_free(value);
+        return size;
+    }
+    if (size <= 0)
+        return size;
+    if (size >= MAX_VARCHAR_LENGTH)
+        size = MAX_VARCHAR_LENGTH - 1;
+    memcpy(data, block->data + block->tuple_dict[id].address, size);
+    return size;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that prepares a row of a wide table for its block. Elements of the row are copied to stored, and
+ *        while new values of the row take more than OVERFLOW_ROW_SIZE bytes, the longest varchar value is written to
+ *        overflow pages and replaced with a value of type TYPE_OVERFLOW that holds the address of its first page.
+ *        Values that are already of type TYPE_OVERFLOW are copied as they are.
+ * @param row_root list of elements of the row
+ * @param stored list the elements are copied to
+ * @return number of values moved to overflow pages, EXIT_ERROR if pages could not be allocated
+ */
+int AK_overflow_store_row(struct list_node *row_root, struct list_node *stored) {
+    struct list_node *el, *longest;
+    int row_size = 0, size, address, moved = 0;
+    AK_PRO;
+
+    for (el = row_root->next; el != NULL; el = el->next) {
+        AK_Insert_New_Element_For_Update(el->type, el->data, el->table, el->attribute_name, stored, el->constraint);
+        if (el->constraint == NEW_VALUE)
+            row_size += AK_type_size(el->type, el->data);
+    }
+
+    while (row_size > OVERFLOW_ROW_SIZE) {
+        longest = NULL;
+        for (el = stored->next; el != NULL; el = el->next) {
+            if (el->constraint == NEW_VALUE && el->type == TYPE_VARCHAR &&
+                (longest == NULL || strlen(el->data) > strlen(longest->data)))
+                longest = el;
+        }
+        if (longest == NULL || strlen(longest->data) <= sizeof(int))
+            break;
+
+        size = strlen(longest->data);
+        address = AK_overflow_write(longest->table, longest->data, size);
+        if (address == EXIT_ERROR) {
+            AK_overflow_discard_row(row_root, stored);
+            AK_EPI;
+            return EXIT_ERROR;
+        }
+        longest->type = TYPE_OVERFLOW;
+        memset(longest->data, '\0', MAX_VARCHAR_LENGTH);
+        memcpy(longest->data, &address, sizeof(int));
+        row_size -= size - sizeof(int);
+        moved++;
+    }
+
+    AK_EPI;
+    return moved;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that frees overflow pages of values AK_overflow_store_row moved out of a row that was not written
+ * @param row_root list of elements of the row
+ * @param stored elements of the row as prepared by AK_overflow_store_row
+ * @return No return value
+ */
+void AK_overflow_discard_row(struct list_node *row_root, struct list_node *stored) {
+    struct list_node *el, *original;
+    int address;
+    AK_PRO;
+
+    for (el = stored->next; el != NULL; el = el->next) {
+        if (el->type != TYPE_OVERFLOW)
+            continue;
+        //values that were given as overflow values belong to the caller
+        for (original = row_root->next; original != NULL; original = original->next) {
+            if (strcmp(original->attribute_name, el->attribute_name) == 0 && original->constraint == el->constraint)
+                break;
+        }
+        if (original != NULL && original->type == TYPE_OVERFLOW)
+            continue;
+        memcpy(&address, el->data, sizeof(int));
+        AK_overflow_delete(address);
+    }
+    AK_EPI;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that frees overflow pages of a long value, so they can hold other values of the table
+ * @param address address of the first page, as returned by AK_overflow_write
+ * @return EXIT_SUCCESS if the pages were freed, EXIT_ERROR if there is no value on the address
+ */
+int AK_overflow_delete(int address) {
+    AK_mem_block *mem_block;
+    int page, next, free_length = FREE_INT;
+    AK_PRO;
+
+    mem_block = AK_get_block(address);
+    if (mem_block->block->type != BLOCK_TYPE_OVERFLOW || AK_overflow_page_length(mem_block->block) == FREE_INT) {
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+
+    for (page = address; page != NOT_CHAINED; page = next) {
+        mem_block = AK_get_block(page);
+        next = mem_block->block->chained_with;
+        memcpy(mem_block->block->data, &free_length, sizeof(int));
+        mem_block->block->chained_with = NOT_CHAINED;
+        AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+    }
+
+    AK_EPI;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that makes a long value of a row of the overflow test
+ * @param value buffer of MAX_VARCHAR_LENGTH characters
+ * @param id id of the row
+ * @param k index of the attribute
+ * @return No return value
+ */
+static void AK_overflow_test_value(char *value, int id, int k) {
+    int length = sprintf(value, "%d_%d_", id, k);
+
+    memset(value + length, 'a' + (id + k) % 26, 150 - length);
+    value[150] = '\0';
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that finds the index of the row of the overflow test with the given id
+ * @param tblName table name
+ * @param id id of the row
+ * @return zero-based row index, -1 if there is no such row
+ */
+static int AK_overflow_test_find(char *tblName, int id) {
+    struct list_node *el;
+    int row;
+
+    for (row = AK_get_num_records(tblName) - 1; row >= 0; row--) {
+        el = AK_get_tuple(row, 0, tblName);
+        if (el != NULL && *((int *) el->data) == id)
+            return row;
+    }
+    return -1;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that finds values of the row of the overflow test with the given id that are stored in overflow pages
+ * @param tblName table name
+ * @param id id of the row
+ * @param num_attr number of attributes of the table
+ * @param pages array of num_attr addresses, address of the first page of each value or 0
+ * @return number of values in overflow pages
+ */
+static int AK_overflow_test_pages(char *tblName, int id, int num_attr, int *pages) {
+    table_addresses *addresses = AK_get_table_addresses(tblName);
+    AK_block *block;
+    int i, j, k, l, count = 0;
+
+    memset(pages, 0, sizeof(int) * num_attr);
+    for (i = 0; i < MAX_EXTENTS_IN_SEGMENT && addresses->address_from[i] != 0; i++) {
+        for (j = addresses->address_from[i]; j < addresses->address_to[i]; j++) {
+            block = AK_get_block(j)->block;
+            if (block->type != BLOCK_TYPE_WIDE)
+                continue;
+            for (k = 0; k + num_attr <= DATA_BLOCK_SIZE; k += num_attr) {
+                if (block->tuple_dict[k].type != TYPE_INT || block->tuple_dict[k].size != sizeof(int) ||
+                    memcmp(block->data + block->tuple_dict[k].address, &id, sizeof(int)) != 0)
+                    continue;
+                for (l = 0; l < num_attr; l++) {
+                    if (block->tuple_dict[k + l].type == TYPE_OVERFLOW && block->tuple_dict[k + l].size > 0) {
+                        memcpy(&pages[l], block->data + block->tuple_dict[k + l].address, sizeof(int));
+                        count++;
+                    }
+                }
+            }
+        }
+    }
+    AK_free(addresses);
+    return count;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function for testing tables with many attributes and overflow pages
+ * @return TestResult
+ */
+TestResult AK_overflow_test() {
+    char *tblName = "overflow_test";
+    int num_attr = 25, num_rows = 300;
+    int ok = 0, fail = 0;
+    int i, k, id, doc, length, address, count, row;
+    int pages[num_attr], old_pages[num_attr];
+    char value[MAX_VARCHAR_LENGTH];
+    char *long_value, *read_value;
+    AK_header t_header[num_attr + 1];
+    struct list_node *row_root, *column, *el;
+    clock_t t;
+    AK_PRO;
+
+    //id, 23 varchar attributes and the address of a long value
+    memset(t_header, 0, sizeof(t_header));
+    t_header[0].type = TYPE_INT;
+    strcpy(t_header[0].att_name, "id");
+    for (k = 1; k < num_attr - 1; k++) {
+        t_header[k].type = TYPE_VARCHAR;
+        sprintf(t_header[k].att_name, "c%d", k);
+    }
+    t_header[num_attr - 1].type = TYPE_INT;
+    strcpy(t_header[num_attr - 1].att_name, "doc");
+
+    if (AK_num_attr(tblName) > 0)
+        AK_delete_segment(tblName, SEGMENT_TYPE_TABLE);
+    if (AK_initialize_new_segment(tblName, SEGMENT_TYPE_TABLE, t_header) == EXIT_ERROR) {
+        printf("Could not create table %s\n", tblName);
+        AK_EPI;
+        return TEST_result(0, 1);
+    }
+
+    if (AK_num_attr(tblName) == num_attr && AK_get_storage_layout(tblName) == BLOCK_TYPE_WIDE)
+        ok++;
+    else
+        fail++;
+
+    //long value over several pages
+    length = 3 * OVERFLOW_PAGE_SIZE / 2 + 4500;
+    long_value = (char *) AK_malloc(length + 1);
+    for (i = 0; i < length; i++)
+        long_value[i] = 'a' + i % 26;
+    long_value[length] = '\0';
+    doc = AK_overflow_write(tblName, long_value, length);
+
+    row_root = (struct list_node *) AK_malloc(sizeof(struct list_node));
+    AK_Init_L3(&row_root);
+    for (i = 0; i < num_rows; i++) {
+        AK_DeleteAll_L3(&row_root);
+        id = i;
+        AK_Insert_New_Element(TYPE_INT, &id, tblName, "id", row_root);
+        for (k = 1; k < num_attr - 1; k++) {
+            sprintf(value, "v%d_%d", i, k);
+            AK_Insert_New_Element(TYPE_VARCHAR, value, tblName, t_header[k].att_name, row_root);
+        }
+        address = i == 0 ? doc : 0;
+        AK_Insert_New_Element(TYPE_INT, &address, tblName, "doc", row_root);
+        AK_insert_row(row_root);
+    }
+
+    count = AK_get_num_records(tblName);
+    printf("Table %s has %d rows, expected %d\n", tblName, count, num_rows);
+    if (count == num_rows)
+        ok++;
+    else
+        fail++;
+
+    sprintf(value, "v%d_%d", 123, 13);
+    el = AK_get_tuple(123, 13, tblName);
+    if (el != NULL && el->size == strlen(value) && memcmp(el->data, value, el->size) == 0)
+        ok++;
+    else
+        fail++;
+
+    el = AK_get_tuple(num_rows - 1, 0, tblName);
+    if (el != NULL && *((int *) el->data) == num_rows - 1)
+        ok++;
+    else
+        fail++;
+
+    //every block holds whole rows, so a column is read by visiting each block once
+    t = clock();
+    column = AK_get_column(num_attr - 2, tblName);
+    t = clock() - t;
+    count = 0;
+    for (el = AK_First_L2(column); el != NULL; el = AK_Next_L2(el))
+        count++;
+    printf("Column %s has %d values, read in %f s\n", t_header[num_attr - 2].att_name, count, (double) t / CLOCKS_PER_SEC);
+    if (count == num_rows)
+        ok++;
+    else
+        fail++;
+    AK_DeleteAll_L3(&column);
+    AK_free(column);
+
+    //long value is read back through the address in the row
+    el = AK_get_tuple(0, num_attr - 1, tblName);
+    read_value = el != NULL ? AK_overflow_read(*((int *) el->data), &i) : NULL;
+    printf("Long value of %d bytes read back with %d bytes\n", length, read_value != NULL ? i : -1);
+    if (read_value != NULL && i == length && memcmp(read_value, long_value, length) == 0)
+        ok++;
+    else
+        fail++;
+    AK_free(read_value);
+
+    //update and delete work on whole rows
+    AK_DeleteAll_L3(&row_root);
+    id = 5;
+    AK_Update_Existing_Element(TYPE_INT, &id, tblName, "id", row_root);
+    AK_Insert_New_Element(TYPE_VARCHAR, "u5_20", tblName, "c20", row_root);
+    AK_update_row(row_root);
+    el = AK_get_tuple(5, 20, tblName);
+    if (el != NULL && el->size == strlen("u5_20") && memcmp(el->data, "u5_20", el->size) == 0)
+        ok++;
+    else
+        fail++;
+
+    AK_delete_row_by_id(7, tblName);
+    el = AK_get_tuple(7, 0, tblName);
+    if (AK_get_num_records(tblName) == num_rows - 1 && el != NULL && *((int *) el->data) == 8)
+        ok++;
+    else
+        fail++;
+
+    //freed pages are reused by the next long value
+    if (AK_overflow_delete(doc) == EXIT_SUCCESS && AK_overflow_read(doc, &i) == NULL &&
+        AK_overflow_write(tblName, long_value, OVERFLOW_PAGE_SIZE + 1) == doc)
+        ok++;
+    else
+        fail++;
+
+    //rows with long values keep the longest of them in overflow pages
+    for (i = 0; i < 3; i++) {
+        AK_DeleteAll_L3(&row_root);
+        id = num_rows + i;
+        AK_Insert_New_Element(TYPE_INT, &id, tblName, "id", row_root);
+        for (k = 1; k < num_attr - 1; k++) {
+            AK_overflow_test_value(value, id, k);
+            AK_Insert_New_Element(TYPE_VARCHAR, value, tblName, t_header[k].att_name, row_root);
+        }
+        address = 0;
+        AK_Insert_New_Element(TYPE_INT, &address, tblName, "doc", row_root);
+        AK_insert_row(row_root);
+    }
+    count = AK_overflow_test_pages(tblName, num_rows + 1, num_attr, pages);
+    row = AK_overflow_test_find(tblName, num_rows + 1);
+    printf("Row %d has %d values in overflow pages\n", num_rows + 1, count);
+    for (k = 1; count > 0 && row >= 0 && k < num_attr - 1; k++) {
+        AK_overflow_test_value(value, num_rows + 1, k);
+        el = AK_get_tuple(row, k, tblName);
+        if (el == NULL || el->type != TYPE_VARCHAR || el->size != strlen(value) || memcmp(el->data, value, el->size) != 0)
+            break;
+    }
+    if (count > 0 && row >= 0 && k == num_attr - 1)
+        ok++;
+    else
+        fail++;
+
+    //updated value leaves its old pages to the vacuum, other values keep theirs
+    memcpy(old_pages, pages, sizeof(pages));
+    for (k = 1; k < num_attr - 1 && pages[k] == 0; k++)
+        ;
+    AK_DeleteAll_L3(&row_root);
+    id = num_rows + 1;
+    AK_Update_Existing_Element(TYPE_INT, &id, tblName, "id", row_root);
+    AK_Insert_New_Element(TYPE_VARCHAR, "short", tblName, t_header[k].att_name, row_root);
+    AK_update_row(row_root);
+    row = AK_overflow_test_find(tblName, num_rows + 1);
+    el = row >= 0 ? AK_get_tuple(row, k, tblName) : NULL;
+    count = AK_overflow_test_pages(tblName, num_rows + 1, num_attr, pages);
+    if (k < num_attr - 1 && el != NULL && el->size == strlen("short") && memcmp(el->data, "short", el->size) == 0 &&
+        pages[k] == 0 && count > 0)
+        ok++;
+    else
+        fail++;
+
+    //vacuum frees pages of deleted rows and of updated values
+    AK_overflow_test_pages(tblName, num_rows, num_attr, pages);
+    AK_DeleteAll_L3(&row_root);
+    id = num_rows;
+    AK_Update_Existing_Element(TYPE_INT, &id, tblName, "id", row_root);
+    AK_delete_row(row_root);
+    AK_vacuum_table(tblName);
+    count = 0;
+    for (i = 1; i < num_attr - 1; i++) {
+        if (pages[i] != 0 && (read_value = AK_overflow_read(pages[i], &length)) != NULL) {
+            AK_free(read_value);
+            count++;
+        }
+    }
+    if (old_pages[k] != 0 && (read_value = AK_overflow_read(old_pages[k], &length)) != NULL) {
+        AK_free(read_value);
+        count++;
+    }
+    row = AK_overflow_test_find(tblName, num_rows + 2);
+    AK_overflow_test_value(value, num_rows + 2, num_attr - 2);
+    el = row >= 0 ? AK_get_tuple(row, num_attr - 2, tblName) : NULL;
+    printf("%d pages of deleted values are still used after the vacuum\n", count);
+    if (count == 0 && AK_overflow_test_find(tblName, num_rows) == -1 && el != NULL && el->size == strlen(value) &&
+        memcmp(el->data, value, el->size) == 0)
+        ok++;
+    else
+        fail++;
+
+    AK_DeleteAll_L3(&row_root);
+    AK_free(row_root);
+    AK_free(long_value);
+
+    AK_EPI;
+    return TEST_result(ok, fail);
+}
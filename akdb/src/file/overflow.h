@@ -0,0 +1,109 @@
+/**
+@file overflow.h Header file that provides functions and defines for overflow pages of long values
+ */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#ifndef OVERFLOW
+#define OVERFLOW
+
+#include "../auxi/test.h"
+#include "../auxi/constants.h"
+#include "../auxi/configuration.h"
+#include "../mm/memoman.h"
+#include "../auxi/mempro.h"
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that allocates a new extent of the table and turns all of its blocks into free overflow pages.
+ *        Overflow pages keep last_tuple_dict_id at 0, so functions that read rows stop at the first block of the
+ *        extent, and their AK_free_space is set to MAX_FREE_SPACE_SIZE, so rows are never written into them.
+ * @param tblName table name
+ * @return address of the first page, EXIT_ERROR if the extent could not be allocated
+ */
+int AK_overflow_new_extent(char *tblName);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that stores a long value into overflow pages of the table. The value is split into parts of
+ *        OVERFLOW_PAGE_SIZE bytes and each page is chained with the page holding the next part. Free pages are
+ *        reused before new extents are allocated. The returned address is stored in the row instead of the value.
+ * @param tblName table name
+ * @param value value to store
+ * @param length length of the value in bytes
+ * @return address of the first page, EXIT_ERROR if the value could not be stored
+ */
+int AK_overflow_write(char *tblName, char *value, int length);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that reads a long value from overflow pages. Pages are not brought into the cache, so the value can
+ *        be read while a block of the table is in use.
+ * @param address address of the first page, as returned by AK_overflow_write
+ * @param length length of the value in bytes
+ * @return value terminated with '\0' that has to be freed with AK_free, NULL if there is no value on the address
+ */
+char *AK_overflow_read(int address, int *length);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that copies the value of an entry of the tuple dictionary. A value stored in overflow pages is read
+ *        from them and given as a varchar, cut to MAX_VARCHAR_LENGTH - 1 characters like any value of a list.
+ * @param block block
+ * @param id index of the entry
+ * @param data buffer of MAX_VARCHAR_LENGTH characters the value is copied to, it is terminated with '\0'
+ * @param type type of the value
+ * @return size of the value
+ */
+int AK_overflow_entry_value(AK_block *block, int id, char *data, int *type);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that prepares a row of a wide table for its block. Elements of the row are copied to stored, and
+ *        while new values of the row take more than OVERFLOW_ROW_SIZE bytes, the longest varchar value is written to
+ *        overflow pages and replaced with a value of type TYPE_OVERFLOW that holds the address of its first page.
+ *        Values that are already of type TYPE_OVERFLOW are copied as they are.
+ * @param row_root list of elements of the row
+ * @param stored list the elements are copied to
+ * @return number of values moved to overflow pages, EXIT_ERROR if pages could not be allocated
+ */
+int AK_overflow_store_row(struct list_node *row_root, struct list_node *stored);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that frees overflow pages of values AK_overflow_store_row moved out of a row that was not written
+ * @param row_root list of elements of the row
+ * @param stored elements of the row as prepared by AK_overflow_store_row
+ * @return No return value
+ */
+void AK_overflow_discard_row(struct list_node *row_root, struct list_node *stored);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that frees overflow pages of a long value, so they can hold other values of the table
+ * @param address address of the first page, as returned by AK_overflow_write
+ * @return EXIT_SUCCESS if the pages were freed, EXIT_ERROR if there is no value on the address
+ */
+int AK_overflow_delete(int address);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function for testing tables with many attributes and overflow pages
+ * @return TestResult
+ */
+TestResult AK_overflow_test();
+
+#endif
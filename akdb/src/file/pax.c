@@ -0,0 +1,571 @@
+/**
+@file pax.c Provides functions for tables with PAX block layout
+ */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#include "pax.h"
+#include "table.h"
+#include "fileio.h"
+#include "bulk.h"
+#include "idx/index.h"
+#include "../rel/aggregation.h"
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that computes minipages for the given header. Layout depends only on the header, so it is the
+ *        same for every block of the table and does not have to be stored.
+ * @param header table header
+ * @param layout layout to fill
+ * @return number of rows in one block, 0 if the header can not be stored in PAX layout
+ */
+int AK_pax_get_layout(AK_header *header, AK_pax_layout *layout) {
+    int i, num_attr = 0, num_varchar = 0, row_width = 0;
+    int budget, offset, varchar_space;
+    AK_PRO;
+
+    memset(layout, 0, sizeof(AK_pax_layout));
+    while (num_attr < MAX_ATTRIBUTES && header[num_attr].att_name[0] != '\0')
+        num_attr++;
+
+    if (num_attr == 0) {
+        AK_EPI;
+        return 0;
+    }
+
+    for (i = 0; i < num_attr; i++) {
+        layout->type[i] = header[i].type;
+        if (header[i].type == TYPE_VARCHAR) {
+            num_varchar++;
+            row_width += PAX_VARCHAR_WIDTH;
+        } else {
+            layout->size[i] = AK_type_size(header[i].type, NULL);
+            //slot has to hold "null" as well
+            layout->slot[i] = layout->size[i] > strlen("null") ? layout->size[i] : strlen("null");
+            row_width += layout->slot[i];
+        }
+    }
+
+    budget = MAX_FREE_SPACE_SIZE;
+    if (budget > DATA_BLOCK_SIZE * DATA_ENTRY_SIZE)
+        budget = DATA_BLOCK_SIZE * DATA_ENTRY_SIZE;
+
+    layout->num_attr = num_attr;
+    layout->rows = MAX_LAST_TUPLE_DICT_SIZE_TO_USE / num_attr;
+    if (layout->rows > budget / row_width)
+        layout->rows = budget / row_width;
+    if (layout->rows <= 0) {
+        layout->rows = 0;
+        AK_EPI;
+        return 0;
+    }
+
+    offset = 0;
+    for (i = 0; i < num_attr; i++) {
+        if (layout->slot[i] > 0) {
+            layout->start[i] = offset;
+            offset += layout->rows * layout->slot[i];
+            layout->end[i] = offset;
+        }
+    }
+
+    //varchar minipages share the rest of the budget
+    if (num_varchar > 0) {
+        varchar_space = (budget - offset) / num_varchar;
+        for (i = 0; i < num_attr; i++) {
+            if (layout->slot[i] == 0) {
+                layout->start[i] = offset;
+                offset += varchar_space;
+                layout->end[i] = offset;
+            }
+        }
+    }
+
+    AK_EPI;
+    return layout->rows;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that returns the number of row positions used in a PAX block, including deleted rows
+ * @param block PAX block
+ * @param num_attr number of attributes in the header
+ * @return number of rows
+ */
+int AK_pax_num_rows(AK_block *block, int num_attr) {
+    if (num_attr <= 0 || (block->last_tuple_dict_id == 0 && block->tuple_dict[0].size == FREE_INT))
+        return 0;
+    return (block->last_tuple_dict_id + 1) / num_attr;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that writes one row into the next free row position of a PAX block. Missing values are written
+ *        as "null" like in AK_insert_row_to_block. If the row does not fit, the block is marked as full by setting
+ *        its AK_free_space to MAX_FREE_SPACE_SIZE so that AK_find_AK_free_space skips it. It is called once for
+ *        every loaded row, so it walks the row list directly.
+ * @param block PAX block
+ * @param layout layout of the block
+ * @param row_root list of elements of the row
+ * @return EXIT_SUCCESS if the row was written, EXIT_ERROR if it does not fit into the block
+ */
+int AK_pax_pack_row(AK_block *block, AK_pax_layout *layout, struct list_node *row_root) {
+    struct list_node *values[MAX_ATTRIBUTES];
+    struct list_node *el;
+    int sizes[MAX_ATTRIBUTES], addresses[MAX_ATTRIBUTES];
+    int num_attr = layout->num_attr;
+    int i, k, id, row, end;
+
+    row = AK_pax_num_rows(block, num_attr);
+    if (row >= layout->rows) {
+        block->AK_free_space = MAX_FREE_SPACE_SIZE;
+        return EXIT_ERROR;
+    }
+
+    for (i = 0; i < num_attr; i++) {
+        values[i] = NULL;
+        for (el = row_root->next; el != NULL; el = el->next) {
+            if (el->constraint == NEW_VALUE && strcmp(el->attribute_name, block->header[i].att_name) == 0) {
+                values[i] = el;
+                break;
+            }
+        }
+
+        if (values[i] == NULL)
+            sizes[i] = strlen("null");
+        else if (values[i]->type == TYPE_VARCHAR)
+            sizes[i] = strlen(values[i]->data);
+        else if (values[i]->type == layout->type[i])
+            sizes[i] = layout->size[i];
+        else
+            sizes[i] = AK_type_size(values[i]->type, values[i]->data);
+
+        if (layout->slot[i] > 0) {
+            //values that are not of the attribute type must still fit into the slot
+            if (sizes[i] > layout->slot[i]) {
+                printf("AK_pax_pack_row: Value of %s does not fit into its minipage.\n", block->header[i].att_name);
+                return EXIT_ERROR;
+            }
+            addresses[i] = layout->start[i] + row * layout->slot[i];
+        } else {
+            //varchar values are appended after the last value that is still in the block
+            addresses[i] = layout->start[i];
+            for (k = row - 1; k >= 0; k--) {
+                id = k * num_attr + i;
+                if (block->tuple_dict[id].size > 0) {
+                    addresses[i] = block->tuple_dict[id].address + block->tuple_dict[id].size;
+                    break;
+                }
+            }
+            if (addresses[i] + sizes[i] > layout->end[i]) {
+                //an empty block can not take the row either, so it is not marked as full
+                if (row > 0)
+                    block->AK_free_space = MAX_FREE_SPACE_SIZE;
+                else
+                    printf("AK_pax_pack_row: Value of %s does not fit into its minipage.\n", block->header[i].att_name);
+                return EXIT_ERROR;
+            }
+        }
+    }
+
+    end = block->AK_free_space;
+    for (i = 0, id = row * num_attr; i < num_attr; i++, id++) {
+        memcpy(block->data + addresses[i], values[i] != NULL ? values[i]->data : "null", sizes[i]);
+        block->tuple_dict[id].address = addresses[i];
+        block->tuple_dict[id].type = values[i] != NULL ? values[i]->type : TYPE_VARCHAR;
+        block->tuple_dict[id].size = sizes[i];
+        if (addresses[i] + sizes[i] > end)
+            end = addresses[i] + sizes[i];
+    }
+    block->last_tuple_dict_id = id - 1;
+
+    //AK_free_space stays behind the end of every value, as update and delete expect
+    block->AK_free_space = row + 1 == layout->rows ? MAX_FREE_SPACE_SIZE : end;
+
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that inserts one row into a PAX block. It is called from AK_insert_row_to_block for blocks of
+ *        type BLOCK_TYPE_PAX.
+ * @param row_root list of elements of the row
+ * @param block PAX block
+ * @return EXIT_SUCCESS if the row was written, EXIT_ERROR if it does not fit into the block
+ */
+int AK_pax_insert_row_to_block(struct list_node *row_root, AK_block *block) {
+    AK_pax_layout layout;
+    int result;
+    AK_PRO;
+
+    if (AK_pax_get_layout(block->header, &layout) == 0) {
+        printf("AK_pax_insert_row_to_block: Header can not be stored in PAX layout.\n");
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+
+    result = AK_pax_pack_row(block, &layout, row_root);
+    AK_dbg_messg(HIGH, FILE_MAN, "AK_pax_insert_row_to_block: row %d, result %d\n", AK_pax_num_rows(block, layout.num_attr) - 1, result);
+    AK_EPI;
+    return result;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that returns the minipage of a fixed size attribute. Value of row i is at offset
+ *        i * layout->slot[attr]. Row i is deleted if its tuple dictionary entries are cleared, and the value is
+ *        null if the type of its entry differs from the type in the header.
+ * @param block PAX block
+ * @param layout layout of the block
+ * @param attr index of the attribute in the header
+ * @param num_rows number of row positions in the minipage
+ * @return pointer to the first value, NULL if the attribute is a varchar or the block is not a PAX block
+ */
+unsigned char *AK_pax_get_minipage(AK_block *block, AK_pax_layout *layout, int attr, int *num_rows) {
+    *num_rows = 0;
+    if (block->type != BLOCK_TYPE_PAX || attr < 0 || attr >= layout->num_attr || layout->slot[attr] == 0)
+        return NULL;
+
+    *num_rows = AK_pax_num_rows(block, layout->num_attr);
+    return (unsigned char *) block->data + layout->start[attr];
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that sets the block layout of the table. Layout can be changed only while the table is empty.
+ *        New extents of the table get the layout of its first block. Indices do not cover PAX blocks, so a table
+ *        with an index keeps the normal layout.
+ * @param tblName table name
+ * @param block_type BLOCK_TYPE_NORMAL for rows stored one after another, BLOCK_TYPE_PAX for minipages
+ * @return EXIT_SUCCESS if the layout was set, otherwise EXIT_ERROR
+ */
+int AK_set_storage_layout(char *tblName, int block_type) {
+    table_addresses *addresses;
+    AK_mem_block *mem_block;
+    AK_header *header;
+    AK_pax_layout layout;
+    AK_index_description index;
+    int i, j;
+    AK_PRO;
+
+    if (block_type != BLOCK_TYPE_NORMAL && block_type != BLOCK_TYPE_PAX) {
+        printf("AK_set_storage_layout: Unknown block layout %d.\n", block_type);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+
+    addresses = AK_get_table_addresses(tblName);
+    if (addresses->address_from[0] == 0) {
+        printf("AK_set_storage_layout: Table %s does not exist!\n", tblName);
+        AK_free(addresses);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+
+    if (AK_get_num_records(tblName) > 0) {
+        printf("AK_set_storage_layout: Table %s is not empty, layout can not be changed.\n", tblName);
+        AK_free(addresses);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+
+    if (block_type == BLOCK_TYPE_PAX) {
+        if (AK_index_get_descriptions(tblName, &index, 1) > 0) {
+            printf("AK_set_storage_layout: Table %s has index %s, it can not have PAX layout.\n", tblName, index.name);
+            AK_free(addresses);
+            AK_EPI;
+            return EXIT_ERROR;
+        }
+        if (AK_num_attr(tblName) > MAX_ATTRIBUTES) {
+            printf("AK_set_storage_layout: Table %s has too many attributes for PAX layout.\n", tblName);
+            AK_free(addresses);
+            AK_EPI;
+            return EXIT_ERROR;
+        }
+        header = AK_get_header(tblName);
+        i = AK_pax_get_layout(header, &layout);
+        AK_free(header);
+        if (i == 0) {
+            printf("AK_set_storage_layout: Rows of table %s are too wide for PAX layout.\n", tblName);
+            AK_free(addresses);
+            AK_EPI;
+            return EXIT_ERROR;
+        }
+    }
+
+    for (i = 0; i < MAX_EXTENTS_IN_SEGMENT && addresses->address_from[i] != 0; i++) {
+        for (j = addresses->address_from[i]; j < addresses->address_to[i]; j++) {
+            mem_block = AK_get_block(j);
+            mem_block->block->type = block_type;
+            AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+        }
+    }
+
+    AK_free(addresses);
+    AK_EPI;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that returns the block layout of the table
+ * @param tblName table name
+ * @return BLOCK_TYPE_NORMAL, BLOCK_TYPE_PAX or BLOCK_TYPE_WIDE for tables with more than MAX_ATTRIBUTES attributes,
+ *         EXIT_ERROR if the table does not exist
+ */
+int AK_get_storage_layout(char *tblName) {
+    table_addresses *addresses;
+    int block_type;
+    AK_PRO;
+
+    addresses = AK_get_table_addresses(tblName);
+    if (addresses->address_from[0] == 0) {
+        AK_free(addresses);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+
+    block_type = AK_get_block(addresses->address_from[0])->block->type;
+    AK_free(addresses);
+    AK_EPI;
+    return (block_type == BLOCK_TYPE_PAX || block_type == BLOCK_TYPE_WIDE) ? block_type : BLOCK_TYPE_NORMAL;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that creates an empty table for the PAX test
+ * @param tblName table name
+ * @param block_type block layout of the table
+ * @return EXIT_SUCCESS if the table was created, otherwise EXIT_ERROR
+ */
+static int AK_pax_test_table(char *tblName, int block_type) {
+    AK_PRO;
+
+    AK_header t_header[4] = {
+        {TYPE_INT, "id", {0}, {{'\0'}}, {{'\0'}}},
+        {TYPE_VARCHAR, "name", {0}, {{'\0'}}, {{'\0'}}},
+        {TYPE_FLOAT, "weight", {0}, {{'\0'}}, {{'\0'}}},
+        {0, {'\0'}, {0}, {{'\0'}}, {{'\0'}}}};
+
+    if (AK_num_attr(tblName) > 0)
+        AK_delete_segment(tblName, SEGMENT_TYPE_TABLE);
+
+    if (AK_initialize_new_segment(tblName, SEGMENT_TYPE_TABLE, t_header) == EXIT_ERROR ||
+        AK_set_storage_layout(tblName, block_type) == EXIT_ERROR) {
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+
+    AK_EPI;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that aggregates the weight column of the table and returns the sum
+ * @param tblName table name
+ * @param aggName name of the table with results
+ * @param elapsed time spent in AK_aggregation
+ * @return sum of weights, -1 if the aggregation failed
+ */
+static double AK_pax_test_sum(char *tblName, char *aggName, double *elapsed) {
+    AK_agg_input aggregation;
+    AK_header *t_header;
+    struct list_node *el;
+    char tmpName[MAX_ATT_NAME];
+    double sum = -1;
+    clock_t t;
+    AK_PRO;
+
+    sprintf(tmpName, "_%s", aggName);
+    if (AK_num_attr(aggName) > 0)
+        AK_delete_segment(aggName, SEGMENT_TYPE_TABLE);
+    if (AK_num_attr(tmpName) > 0)
+        AK_delete_segment(tmpName, SEGMENT_TYPE_TABLE);
+
+    t_header = AK_get_header(tblName);
+    AK_agg_input_init(&aggregation);
+    AK_agg_input_add(t_header[2], AGG_TASK_SUM, &aggregation);
+    AK_agg_input_add(t_header[0], AGG_TASK_COUNT, &aggregation);
+    AK_free(t_header);
+
+    t = clock();
+    AK_aggregation(&aggregation, tblName, aggName);
+    *elapsed = (double) (clock() - t) / CLOCKS_PER_SEC;
+
+    el = AK_get_tuple(0, 0, aggName);
+    if (el != NULL)
+        sum = *((float *) el->data);
+
+    AK_EPI;
+    return sum;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function for testing tables with PAX block layout
+ * @return TestResult
+ */
+TestResult AK_pax_test() {
+    char *tblName = "pax_test";
+    char *rowTblName = "pax_test_rows";
+    int num_rows = 2000, num_single = 20;
+    int ok = 0, fail = 0;
+    int i, id, count;
+    float weight;
+    double sum, row_sum, expected_sum = 0, pax_time, row_time;
+    char name[MAX_VARCHAR_LENGTH];
+    struct list_node **rows;
+    struct list_node *el;
+    table_addresses *addresses;
+    AK_mem_block *mem_block;
+    AK_header *header;
+    AK_pax_layout layout;
+    unsigned char *minipage;
+    AK_PRO;
+
+    printf("\n********** PAX BLOCK LAYOUT TEST **********\n\n");
+
+    rows = (struct list_node **) AK_calloc(num_rows, sizeof(struct list_node *));
+    for (i = 0; i < num_rows; i++) {
+        rows[i] = (struct list_node *) AK_malloc(sizeof(struct list_node));
+        AK_Init_L3(&rows[i]);
+    }
+
+    if (AK_pax_test_table(tblName, BLOCK_TYPE_PAX) == EXIT_ERROR) {
+        printf("Could not create table %s\n", tblName);
+        fail++;
+    }
+
+    if (AK_get_storage_layout(tblName) == BLOCK_TYPE_PAX)
+        ok++;
+    else
+        fail++;
+
+    for (i = 0; i < num_rows; i++) {
+        id = i;
+        weight = 50 + i % 40;
+        expected_sum += weight;
+        sprintf(name, "name%d", i);
+        AK_Insert_New_Element(TYPE_INT, &id, tblName, "id", rows[i]);
+        //one row without a name, stored as null
+        if (i != 7)
+            AK_Insert_New_Element(TYPE_VARCHAR, name, tblName, "name", rows[i]);
+        AK_Insert_New_Element(TYPE_FLOAT, &weight, tblName, "weight", rows[i]);
+    }
+
+    //first rows go through AK_insert_row, the rest through the bulk loader
+    for (i = 0; i < num_single; i++)
+        AK_insert_row(rows[i]);
+    if (AK_bulk_insert(tblName, rows + num_single, num_rows - num_single) == EXIT_SUCCESS)
+        ok++;
+    else
+        fail++;
+
+    count = AK_get_num_records(tblName);
+    printf("Table %s has %d rows, expected %d\n", tblName, count, num_rows);
+    if (count == num_rows)
+        ok++;
+    else
+        fail++;
+
+    el = AK_get_tuple(num_rows - 1, 0, tblName);
+    if (el != NULL && *((int *) el->data) == num_rows - 1)
+        ok++;
+    else
+        fail++;
+
+    sprintf(name, "name%d", num_single + 1);
+    el = AK_get_tuple(num_single + 1, 1, tblName);
+    if (el != NULL && el->size == strlen(name) && memcmp(el->data, name, el->size) == 0)
+        ok++;
+    else
+        fail++;
+
+    //values of the first attribute are stored one after another in the first block
+    header = AK_get_header(tblName);
+    AK_pax_get_layout(header, &layout);
+    AK_free(header);
+    addresses = AK_get_table_addresses(tblName);
+    mem_block = AK_get_block(addresses->address_from[0]);
+    minipage = AK_pax_get_minipage(mem_block->block, &layout, 0, &count);
+    printf("PAX block holds %d rows, first block has %d\n", layout.rows, count);
+    for (i = 0; minipage != NULL && i < count; i++) {
+        memcpy(&id, minipage + i * layout.slot[0], sizeof(int));
+        if (id != i)
+            break;
+    }
+    if (minipage != NULL && count == layout.rows && i == count && mem_block->block->tuple_dict[7 * layout.num_attr + 1].type == TYPE_VARCHAR)
+        ok++;
+    else
+        fail++;
+    AK_free(addresses);
+
+    //layout of a table with rows can not be changed
+    if (AK_set_storage_layout(tblName, BLOCK_TYPE_NORMAL) == EXIT_ERROR)
+        ok++;
+    else
+        fail++;
+
+    //the same rows in a table with normal blocks, to compare aggregation
+    if (AK_pax_test_table(rowTblName, BLOCK_TYPE_NORMAL) == EXIT_ERROR) {
+        printf("Could not create table %s\n", rowTblName);
+        fail++;
+    }
+    for (i = 0; i < num_rows; i++) {
+        AK_DeleteAll_L3(&rows[i]);
+        id = i;
+        weight = 50 + i % 40;
+        sprintf(name, "name%d", i);
+        AK_Insert_New_Element(TYPE_INT, &id, rowTblName, "id", rows[i]);
+        AK_Insert_New_Element(TYPE_VARCHAR, name, rowTblName, "name", rows[i]);
+        AK_Insert_New_Element(TYPE_FLOAT, &weight, rowTblName, "weight", rows[i]);
+    }
+    AK_bulk_insert(rowTblName, rows, num_rows);
+
+    //rows of normal blocks are aggregated from the disk
+    AK_flush_cache();
+    sum = AK_pax_test_sum(tblName, "pax_test_agg", &pax_time);
+    row_sum = AK_pax_test_sum(rowTblName, "pax_test_rows_agg", &row_time);
+    printf("\nSum of weights: %.1f from PAX blocks in %.3f s, %.1f from normal blocks in %.3f s, expected %.1f\n",
+           sum, pax_time, row_sum, row_time, expected_sum);
+    if (sum == expected_sum && row_sum == expected_sum)
+        ok++;
+    else
+        fail++;
+
+    el = AK_get_tuple(0, 1, "pax_test_agg");
+    if (el != NULL && *((int *) el->data) == num_rows)
+        ok++;
+    else
+        fail++;
+
+    //deleted rows are left out
+    AK_delete_row_by_id(3, tblName);
+    if (AK_get_num_records(tblName) == num_rows - 1)
+        ok++;
+    else
+        fail++;
+
+    for (i = 0; i < num_rows; i++) {
+        AK_DeleteAll_L3(&rows[i]);
+        AK_free(rows[i]);
+    }
+    AK_free(rows);
+
+    AK_EPI;
+    return TEST_result(ok, fail);
+}
@@ -0,0 +1,136 @@
+/**
+@file pax.h Header file that provides functions and defines for tables with PAX block layout
+ */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#ifndef PAX
+#define PAX
+
+#include "../auxi/test.h"
+#include "../auxi/constants.h"
+#include "../auxi/configuration.h"
+#include "../mm/memoman.h"
+#include "../auxi/mempro.h"
+
+/**
+ * @author Karlo Vuković
+ * @struct AK_pax_layout
+ * @brief Structure that describes minipages of a PAX block. Each attribute gets its own part of the data area.
+ *        Values of fixed size types are kept in slots, so the minipage is an array indexed by row number. Varchar
+ *        values are appended to their minipage one after another. The tuple dictionary still holds one entry per
+ *        value in row order, so functions that read rows through it work with both layouts.
+ */
+typedef struct {
+    /// number of attributes in the header
+    int num_attr;
+    /// maximum number of rows in one block
+    int rows;
+    /// type of each attribute
+    int type[MAX_ATTRIBUTES];
+    /// size of values of each attribute, 0 for varchar
+    int size[MAX_ATTRIBUTES];
+    /// offset of the minipage in the data area
+    int start[MAX_ATTRIBUTES];
+    /// offset where the minipage ends
+    int end[MAX_ATTRIBUTES];
+    /// width of one slot in the minipage, 0 for varchar minipages
+    int slot[MAX_ATTRIBUTES];
+} AK_pax_layout;
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that computes minipages for the given header. Layout depends only on the header, so it is the
+ *        same for every block of the table and does not have to be stored.
+ * @param header table header
+ * @param layout layout to fill
+ * @return number of rows in one block, 0 if the header can not be stored in PAX layout
+ */
+int AK_pax_get_layout(AK_header *header, AK_pax_layout *layout);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that returns the number of row positions used in a PAX block, including deleted rows
+ * @param block PAX block
+ * @param num_attr number of attributes in the header
+ * @return number of rows
+ */
+int AK_pax_num_rows(AK_block *block, int num_attr);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that writes one row into the next free row position of a PAX block. Missing values are written
+ *        as "null" like in AK_insert_row_to_block. If the row does not fit, the block is marked as full by setting
+ *        its AK_free_space to MAX_FREE_SPACE_SIZE so that AK_find_AK_free_space skips it. It is called once for
+ *        every loaded row, so it walks the row list directly.
+ * @param block PAX block
+ * @param layout layout of the block
+ * @param row_root list of elements of the row
+ * @return EXIT_SUCCESS if the row was written, EXIT_ERROR if it does not fit into the block
+ */
+int AK_pax_pack_row(AK_block *block, AK_pax_layout *layout, struct list_node *row_root);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that inserts one row into a PAX block. It is called from AK_insert_row_to_block for blocks of
+ *        type BLOCK_TYPE_PAX.
+ * @param row_root list of elements of the row
+ * @param block PAX block
+ * @return EXIT_SUCCESS if the row was written, EXIT_ERROR if it does not fit into the block
+ */
+int AK_pax_insert_row_to_block(struct list_node *row_root, AK_block *block);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that returns the minipage of a fixed size attribute. Value of row i is at offset
+ *        i * layout->slot[attr]. Row i is deleted if its tuple dictionary entries are cleared, and the value is
+ *        null if the type of its entry differs from the type in the header.
+ * @param block PAX block
+ * @param layout layout of the block
+ * @param attr index of the attribute in the header
+ * @param num_rows number of row positions in the minipage
+ * @return pointer to the first value, NULL if the attribute is a varchar or the block is not a PAX block
+ */
+unsigned char *AK_pax_get_minipage(AK_block *block, AK_pax_layout *layout, int attr, int *num_rows);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that sets the block layout of the table. Layout can be changed only while the table is empty.
+ *        New extents of the table get the layout of its first block. Indices do not cover PAX blocks, so a table
+ *        with an index keeps the normal layout.
+ * @param tblName table name
+ * @param block_type BLOCK_TYPE_NORMAL for rows stored one after another, BLOCK_TYPE_PAX for minipages
+ * @return EXIT_SUCCESS if the layout was set, otherwise EXIT_ERROR
+ */
+int AK_set_storage_layout(char *tblName, int block_type);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that returns the block layout of the table
+ * @param tblName table name
+ * @return BLOCK_TYPE_NORMAL, BLOCK_TYPE_PAX or BLOCK_TYPE_WIDE for tables with more than MAX_ATTRIBUTES attributes,
+ *         EXIT_ERROR if the table does not exist
+ */
+int AK_get_storage_layout(char *tblName);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function for testing tables with PAX block layout
+ * @return TestResult
+ */
+TestResult AK_pax_test();
+
+#endif
@@ -18,6 +18,8 @@
  */
 
 #include "../file/table.h"
+#include "../file/output.h"
+#include "../file/overflow.h"
 
 
 /**
@@ -119,7 +121,7 @@ void AK_temp_create_table(char *table, AK_header *header, int type_segment) {
 }
 
 /**
- * @author Matija Šestak, updated by Josip Šušnjara (chained blocks support)
+ * @author Matija Šestak, updated by Josip Šušnjara (chained blocks support), updated by Karlo Vuković (headers with MAX_ATTRIBUTES attributes)
  * @brief  Functions that determines the number of attributes in the table
  * <ol>
  * <li>Read addresses of extents</li>
@@ -142,7 +144,7 @@ int AK_num_attr(char * tblName) {
 		
 		while(1){
 			i = 0;
-			while (strcmp(temp_block->block->header[i++].att_name, "\0") != 0) {
+			while (i < MAX_ATTRIBUTES && strcmp(temp_block->block->header[i++].att_name, "\0") != 0) {
             	num_attr++;
         	}
         	if(temp_block->block->chained_with != NOT_CHAINED){
@@ -159,7 +161,7 @@ int AK_num_attr(char * tblName) {
 }
 
 /**
- * @author Matija Šestak, updated by Josip Šušnjara (chained blocks support)
+ * @author Matija Šestak, updated by Josip Šušnjara (chained blocks support), updated by Karlo Vuković (wide blocks)
  * @brief  Function that determines the number of rows in the table
  * <ol>
  * <li>Read addresses of extents</li>
@@ -176,12 +178,10 @@ int AK_num_attr(char * tblName) {
  */
 int AK_get_num_records(char *tblName) {
     int num_rec = 0;
-    int blocks_per_row; //how many chained blocks are needed to store one entry of the table
     int i = 0, j, k;
     int num_head;
     AK_PRO;
     table_addresses *addresses = AK_get_table_addresses(tblName);
-    blocks_per_row = (AK_num_attr(tblName) - 1) / MAX_ATTRIBUTES + 1;
     if (addresses->address_from[0] == 0){
         AK_EPI;
         return EXIT_WARNING;
@@ -189,7 +189,7 @@ int AK_get_num_records(char *tblName) {
     AK_mem_block *temp = AK_get_block(addresses->address_from[0]);
     
     while (addresses->address_from[i] != 0) {
-        for (j = addresses->address_from[i]; j < addresses->address_to[i]; j += blocks_per_row) {
+        for (j = addresses->address_from[i]; j < addresses->address_to[i]; j++) {
             temp = AK_get_block(j);
             if (temp->block->last_tuple_dict_id == 0)
                 break;
@@ -204,9 +204,6 @@ int AK_get_num_records(char *tblName) {
 
     AK_free(addresses);
     num_head = AK_num_attr(tblName);
-    if(num_head > MAX_ATTRIBUTES){
-    	num_head = MAX_ATTRIBUTES;
-    }
     AK_EPI;
     return num_rec / num_head;
 }
@@ -312,15 +309,13 @@ int AK_get_attr_index(char *tblName, char *attrName) {
 }
 
 /**
- * @author Matija Šestak, updated by Josip Šušnjara (chained blocks support)
+ * @author Matija Šestak, updated by Josip Šušnjara (chained blocks support), updated by Karlo Vuković (wide blocks, overflow values)
  * @brief  Function that fetches all values in some column and put on the list
  * @param num zero-based column index
  * @param  *tblName table name
  * @return column values list
  */
 struct list_node *AK_get_column(int num, char *tblName) {
-	int blocks_per_row;
-	int increment;
     AK_PRO;
     int num_attr = AK_num_attr(tblName);
     if (num >= num_attr || num < 0){
@@ -334,33 +329,17 @@ struct list_node *AK_get_column(int num, char *tblName) {
     table_addresses *addresses = (table_addresses*) AK_get_table_addresses(tblName);
     int i, j, k;
     char data[ MAX_VARCHAR_LENGTH ];
-    
-    blocks_per_row = (num_attr - 1) / MAX_ATTRIBUTES + 1;
-    if (blocks_per_row > 1 && (num / MAX_ATTRIBUTES) < blocks_per_row - 1)
-    	increment = MAX_ATTRIBUTES;
-    else if (blocks_per_row > 1)
-    	increment = num_attr % MAX_ATTRIBUTES;
-    else
-    	increment = num_attr;
 
     i = 0;
     while (addresses->address_from[i] != 0) {
-        for (j = addresses->address_from[i]; j < addresses->address_to[i]; j += blocks_per_row) {
+        for (j = addresses->address_from[i]; j < addresses->address_to[i]; j++) {
             AK_mem_block *temp = (AK_mem_block*) AK_get_block(j);
             if (temp->block->last_tuple_dict_id == 0) break;
-            
-            while(num >= MAX_ATTRIBUTES){
-                temp = (AK_mem_block*) AK_get_block(++j);
-                num -= MAX_ATTRIBUTES;
-            }
-            
-            for (k = num; k < DATA_BLOCK_SIZE; k += increment) {
+
+            for (k = num; k < DATA_BLOCK_SIZE; k += num_attr) {
                 if (temp->block->tuple_dict[k].type != FREE_INT) {
-                    int type = temp->block->tuple_dict[k].type;
-                    int size = temp->block->tuple_dict[k].size;
-                    int address = temp->block->tuple_dict[k].address;
-                    memcpy(data, &(temp->block->data[address]), size);
-                    data[ size ] = '\0';
+                    int type;
+                    int size = AK_overflow_entry_value(temp->block, k, data, &type);
                     AK_InsertAtEnd_L3(type, data, size, row_root);
                 }
             }
@@ -372,8 +351,9 @@ struct list_node *AK_get_column(int num, char *tblName) {
 }
 
 /**
- * @author Markus Schatten, Matija Šestak.
- * @brief  Function that fetches all values in some row and put on the list
+ * @author Markus Schatten, Matija Šestak, updated by Karlo Vuković (overflow values)
+ * @brief  Function that fetches all values in some row and put on the list. Values stored in overflow pages are read
+ *         from them.
  * @param num zero-based row index
  * @param  * tblName table name
  * @return row values list
@@ -400,11 +380,8 @@ struct list_node *AK_get_row(int num, char * tblName) {
                     counter++;
                 if (counter == num) {
                     for (l = 0; l < num_attr; l++) {
-                        int type = temp->block->tuple_dict[k + l].type;
-                        int size = temp->block->tuple_dict[k + l].size;
-                        int address = temp->block->tuple_dict[k + l].address;
-                        memcpy(data, &(temp->block->data[address]), size);
-                        data[size] = '\0';
+                        int type;
+                        int size = AK_overflow_entry_value(temp->block, k + l, data, &type);
                         AK_InsertAtEnd_L3(type, data, size, row_root);
                     }
                     AK_free(addresses);
@@ -423,7 +400,7 @@ struct list_node *AK_get_row(int num, char * tblName) {
 }
 
 /**
- * @author Barbara Tatai, updated by Josip Šušnjara (chained blocks support)
+ * @author Barbara Tatai, updated by Josip Šušnjara (chained blocks support), updated by Karlo Vuković (wide blocks, overflow values)
  * @brief Function that finds the tuple in memory
  * @param row zero-based row index
  * @param column zero-based column index
@@ -435,41 +412,24 @@ struct list_node *AK_get_row(int num, char * tblName) {
 struct list_node *AK_find_tuple(int row, int column, int num_attr, table_addresses *addresses, struct list_node *row_root) {
     int i, j, k;
     int counter;
-    int blocks_per_row;
-    int increment; //if there are e.g. 23 attributes, and MAX_ATTRIBUTES is 10, then 1st block takes 10 atts, 2nd also 10, and 3rd takes 3 atts
     char data[MAX_VARCHAR_LENGTH];
 	AK_PRO;
 
     i = 0;
     counter = -1;
-    blocks_per_row = (num_attr - 1) / MAX_ATTRIBUTES + 1;
-    
-    if (blocks_per_row > 1 && (column / MAX_ATTRIBUTES) < blocks_per_row - 1)
-    	increment = MAX_ATTRIBUTES;
-    else if (blocks_per_row > 1)
-    	increment = num_attr % MAX_ATTRIBUTES;
-    else
-    	increment = num_attr;
-    	
+
     while (addresses->address_from[ i ] != 0) {
-        for (j = addresses->address_from[ i ]; j < addresses->address_to[ i ]; j += blocks_per_row) {
+        for (j = addresses->address_from[ i ]; j < addresses->address_to[ i ]; j++) {
             AK_mem_block *temp = (AK_mem_block*) AK_get_block(j);
             if (temp->block->last_tuple_dict_id == 0) break;
-            while(column >= MAX_ATTRIBUTES){//e.g. 13th column in table is 3rd column in 2nd block of the table
-                temp = (AK_mem_block*) AK_get_block(++j);
-                column -= MAX_ATTRIBUTES;
-            }
-            for (k = 0; k < DATA_BLOCK_SIZE; k += increment) {
+            for (k = 0; k < DATA_BLOCK_SIZE; k += num_attr) {
                 if (temp->block->tuple_dict[k].size > 0)
                     counter++;
                 if (counter == row) {
                 	
 					struct list_node *next;
-                    int type = temp->block->tuple_dict[ k + column ].type;
-                    int size = temp->block->tuple_dict[ k + column ].size;
-                    int address = temp->block->tuple_dict[ k + column ].address;
-                    memcpy(data, &(temp->block->data[address]), size);
-                    data[ size ] = '\0';
+                    int type;
+                    int size = AK_overflow_entry_value(temp->block, k + column, data, &type);
                     AK_InsertAtEnd_L3(type, data, size, row_root);
                     AK_free(addresses);
 					next = AK_First_L2(row_root); //store next
@@ -662,171 +622,34 @@ int AK_table_exist(char *tblName) {
 }
 
 /**
- * @author Dino Laktašić and Mislav Čakarić (replaced old print table function by new one), updated by Josip Šušnjara (chained blocks support)
- * @brief  Function for printing table
+ * @author Dino Laktašić and Mislav Čakarić (replaced old print table function by new one), updated by Josip Šušnjara (chained blocks support), updated by Karlo Vuković (wide blocks, streaming output)
+ * @brief  Function for printing table. Rows are written by AK_output_table, which reads them straight from the blocks
  * @param *tblName table name
  * @return No return value
  */
 void AK_print_table(char *tblName) {
-	int i, j, k, l;
-    int blocks_per_row;
-    
+    int num_rows;
+    clock_t t;
+
     AK_PRO;
-    table_addresses *addresses = (table_addresses*) AK_get_table_addresses(tblName);
-    //  || (AK_table_exist(tblName) == 0)
-    if ((addresses->address_from[0] == 0) || (AK_table_exist(tblName) == 0)) {
+    if (AK_table_exist(tblName) == 0) {
         printf("Table %s does not exist!\n", tblName);
-        AK_free(addresses);
-    } else {
-        AK_header *head = AK_get_header(tblName);
-
-        int num_attr = AK_num_attr(tblName);
-        int num_rows = AK_get_num_records(tblName);
-        int len[num_attr]; //max length for each attribute in row
-        int length = 0; //length of spacer
-        clock_t t;
-
-        //store lengths of header attributes
-        for (i = 0; i < num_attr; i++) {
-            len[i] = strlen((head + i)->att_name);
-        }
-		
-        //for each header attribute iterate through all table rows and check if
-        //there is longer element than previously longest and store it in array
-        for (i = 0; i < num_attr; i++) {
-            for (j = 0; j < num_rows; j++) 
-			{
-                struct list_node *el = AK_get_tuple(j, i, tblName);
-                switch (el->type) 
-				{
-                    case TYPE_INT:
-                        length = AK_chars_num_from_number(*((int *) (el)->data), 10);
-                        if (len[i] < length) 
-						{
-                            len[i] = length;
-                        }
-                        break;
-                    case TYPE_FLOAT:
-                        length = AK_chars_num_from_number(*((float *) (el)->data), 10);
-                        if (len[i] < length) 
-						{
-                            len[i] = length;
-                        }
-                        break;
-                    case TYPE_VARCHAR:
-                    default:
-                        if (len[i] < el->size) 
-						{
-                            len[i] = el->size;
-                        }
-                        break;
-                }
-				//we don't need this linked list anymore (starting from tupple first to the end
-				//see comment above in function AK_get_tuple - Elvis Popovic
-				AK_DeleteAll_L3(&el);
-				AK_free(el);
-            }
-        }
-        //num_attr is number of char | + space in printf
-        //set offset to change the box size
-        length = 0;
-        for (i = 0; i < num_attr; length += len[i++]);
-        length += num_attr * TBL_BOX_OFFSET + 2 * num_attr + 1;
-
-        //start measuring time
-        t = clock();
-
-        printf("Table: %s\n", tblName);
+        AK_EPI;
+        return;
+    }
 
-        if (num_attr <= 0 || num_rows <= 0) {
-            printf("Table is empty.\n");
+    //start measuring time
+    t = clock();
+    num_rows = AK_output_table(tblName, stdout, OUTPUT_FORMAT_TABLE);
+    if (num_rows == EXIT_ERROR) {
+        printf("Table %s does not exist!\n", tblName);
+    } else if (num_rows > 0) {
+        t = clock() - t;
+        if ((((double) t) / CLOCKS_PER_SEC) < 0.1) {
+            printf("%i rows found, duration: %f μs\n", num_rows, ((double) t) / CLOCKS_PER_SEC * 1000);
         } else {
-            //print table header
-            AK_print_row_spacer(len, length);
-            printf("\n|");
-
-            for (i = 0; i < num_attr; i++) {
-                //print attributes center aligned inside box
-                k = (len[i] - (int) strlen((head + i)->att_name) + TBL_BOX_OFFSET + 1);
-                if (k % 2 == 0) {
-                    k /= 2;
-                    printf("%-*s%-*s|", k, " ", k + (int) strlen((head + i)->att_name), (head + i)->att_name);
-                } else {
-                    k /= 2;
-                    printf("%-*s%-*s|", k, " ", k + (int) strlen((head + i)->att_name) + 1, (head + i)->att_name);
-                }
-
-                //print attributes left aligned inside box
-                //printf(" %-*s|", len[i] + MAX_TABLE_BOX_OFFSET, (head + i)->att_name);
-            }
-			AK_free(head);
-            printf("\n");
-            AK_print_row_spacer(len, length);
-
-            struct list_node *row_root = (struct list_node *) AK_malloc(sizeof (struct list_node));
-            AK_Init_L3(&row_root);
-
-            i = 0;
-            int type, size, address;
-            
-            int blocks_per_row = (num_attr - 1) / MAX_ATTRIBUTES + 1;
-
-            while (addresses->address_from[i] != 0) {
-                for (j = addresses->address_from[i]; j < addresses->address_to[i]; j += blocks_per_row) {
-                	AK_mem_block *temp[blocks_per_row];
-                    temp[0] = (AK_mem_block*) AK_get_block(j);
-                    
-                    for(int m = 1; temp[m - 1]->block->chained_with != NOT_CHAINED; m++){
-                    	temp[m] = (AK_mem_block*) AK_get_block(temp[m - 1]->block->chained_with);
-                    }
-                    if (temp[0]->block->last_tuple_dict_id == 0)
-                        break;
-                    int increment = num_attr;
-                    if(num_attr > MAX_ATTRIBUTES)
-                    	increment = MAX_ATTRIBUTES;
-                    for (k = 0; k * increment < DATA_BLOCK_SIZE; k++) {
-                    	
-		                if(num_attr > MAX_ATTRIBUTES)
-		                	increment = MAX_ATTRIBUTES;
-		                else
-		                	increment = num_attr;
-                        if (temp[0]->block->tuple_dict[k * increment].size > 0) {
-                            for (l = 0; l < num_attr; l++) {
-                            	int block_index = 0; //defines in which block of chained blocks is a cell we are looking for
-                            	block_index = l / MAX_ATTRIBUTES;
-                            	if (blocks_per_row > 1 && block_index < blocks_per_row - 1)
-									increment = MAX_ATTRIBUTES;
-								else if (blocks_per_row > 1)
-									increment = num_attr % MAX_ATTRIBUTES;
-								else
-									increment = num_attr;
-                                type = temp[block_index]->block->tuple_dict[k * increment + (l % MAX_ATTRIBUTES)].type;
-                                size = temp[block_index]->block->tuple_dict[k * increment + (l % MAX_ATTRIBUTES)].size;
-                                address = temp[block_index]->block->tuple_dict[k * increment + (l % MAX_ATTRIBUTES)].address;
-                                AK_InsertAtEnd_L3(type, &temp[block_index]->block->data[address], size, row_root);
-                            }
-                            AK_print_row(len, row_root);
-                            AK_print_row_spacer(len, length);
-                            AK_DeleteAll_L3(&row_root);
-                        }
-                    }
-                }
-                i++;
-            }
-
-            printf("\n");
-            t = clock() - t;
-
-            if ((((double) t) / CLOCKS_PER_SEC) < 0.1) {
-                printf("%i rows found, duration: %f μs\n", num_rows, ((double) t) / CLOCKS_PER_SEC * 1000);
-            } else {
-                printf("%i rows found, duration: %f s\n", num_rows, ((double) t) / CLOCKS_PER_SEC);
-            }
-        AK_free(row_root);
+            printf("%i rows found, duration: %f s\n", num_rows, ((double) t) / CLOCKS_PER_SEC);
         }
-
-AK_free(addresses);
-
     }
     AK_EPI;
 }
@@ -938,9 +761,9 @@ void AK_print_row_to_file(int col_len[], struct list_node * row) {
 }
 
 /**
- * @author Dino Laktašić and Mislav Čakarić (replaced old print table function by new one), updated by Josip Šušnjara (chained blocks support)
+ * @author Dino Laktašić and Mislav Čakarić (replaced old print table function by new one), updated by Josip Šušnjara (chained blocks support), updated by Karlo Vuković (wide blocks, streaming output)
  * update by Luka Rajcevic
- * @brief  Function that prints a table
+ * @brief  Function that prints a table. Rows are written by AK_output_table, which reads them straight from the blocks
  * @param *tblName table name
  * @return No return value
  * update by Anto Tomaš (corrected the AK_DeleteAll_L3 function)
@@ -949,140 +772,11 @@ void AK_print_table_to_file(char *tblName) {
 
 	char* FILEPATH = "table_test.txt";
 	FILE *fp;
-	int blocks_per_row;
     
 	AK_PRO;
     fp = fopen(FILEPATH, "a");
-    table_addresses *addresses = (table_addresses*) AK_get_table_addresses(tblName);
-    if (addresses->address_from[0] == 0) {
+    if (AK_output_table(tblName, fp, OUTPUT_FORMAT_TABLE) == EXIT_ERROR) {
         fprintf(fp, "Table %s does not exist!\n", tblName);
-
-    } else {
-        AK_header *head = AK_get_header(tblName);
-
-        int i, j, k, l;
-        int num_attr = AK_num_attr(tblName);
-        int num_rows = AK_get_num_records(tblName);
-        int len[num_attr]; //max length for each attribute in row
-        int length = 0; //length of spacer
-
-        //store lengths of header attributes
-        for (i = 0; i < num_attr; i++) {
-            len[i] = strlen((head + i)->att_name);
-        }
-
-        //for each header attribute iterate through all table rows and check if
-        //there is longer element than previously longest and store it in array
-        for (i = 0; i < num_attr; i++) {
-            for (j = 0; j < num_rows; j++) {
-                struct list_node *el = AK_get_tuple(j, i, tblName);
-                switch (el->type) {
-                    case TYPE_INT:
-                        length = AK_chars_num_from_number(*((int *) (el)->data), 10);
-                        if (len[i] < length) {
-                            len[i] = length;
-                        }
-                        break;
-                    case TYPE_FLOAT:
-                        length = AK_chars_num_from_number(*((float *) (el)->data), 10);
-                        if (len[i] < length) {
-                            len[i] = length;
-                        }
-                        break;
-                    case TYPE_VARCHAR:
-                    default:
-                        if (len[i] < el->size) {
-                            len[i] = el->size;
-                        }
-                        break;
-                }
-            }
-        }
-        //num_attr is number of char | + space in printf
-        //set offset to change the box size
-        length = 0;
-        for (i = 0; i < num_attr; length += len[i++]);
-        length += num_attr * TBL_BOX_OFFSET + 2 * num_attr + 1;
-
-        fprintf(fp, "Table: %s\n", tblName);
-
-        if (num_attr <= 0 || num_rows <= 0) {
-            fprintf(fp, "Table is empty.\n");
-        } else {
-            //print table header
-            fclose(fp);
-            AK_print_row_spacer_to_file(len, length);
-            fp = fopen(FILEPATH, "a");
-            fprintf(fp, "\n|");
-
-            for (i = 0; i < num_attr; i++) {
-                //print attributes center aligned inside box
-                k = (len[i] - (int) strlen((head + i)->att_name) + TBL_BOX_OFFSET + 1);
-                if (k % 2 == 0) {
-                    k /= 2;
-                    fprintf(fp, "%-*s%-*s|", k, " ", k + (int) strlen((head + i)->att_name), (head + i)->att_name);
-                } else {
-                    k /= 2;
-                    fprintf(fp, "%-*s%-*s|", k, " ", k + (int) strlen((head + i)->att_name) + 1, (head + i)->att_name);
-                }
-
-                //print attributes left aligned inside box
-                //printf(" %-*s|", len[i] + MAX_TABLE_BOX_OFFSET, (head + i)->att_name);
-            }
-            fprintf(fp, "\n");
-            fclose(fp);
-            AK_print_row_spacer_to_file(len, length);
-            struct list_node *row_root = (struct list_node *) AK_malloc(sizeof (struct list_node));
-            AK_Init_L3(&row_root);
-
-            i = 0;
-            int type, size, address;
-            
-            blocks_per_row = (num_attr - 1) / MAX_ATTRIBUTES + 1;
-
-            while (addresses->address_from[i] != 0) {
-                for (j = addresses->address_from[i]; j < addresses->address_to[i]; j += blocks_per_row) {
-                    AK_mem_block *temp[blocks_per_row];
-                    temp[0] = (AK_mem_block*) AK_get_block(j);
-                    for(int m = 1; temp[m - 1]->block->chained_with != NOT_CHAINED; m++){
-                    	temp[m] = (AK_mem_block*) AK_get_block(temp[m - 1]->block->chained_with);
-                    }
-                    if (temp[0]->block->last_tuple_dict_id == 0)
-                        break;
-                    int increment = num_attr;
-                    if(num_attr > MAX_ATTRIBUTES)
-                    	increment = MAX_ATTRIBUTES;
-                    for (k = 0; k * increment < DATA_BLOCK_SIZE; k++) {
-                    	if(num_attr > MAX_ATTRIBUTES)
-		                	increment = MAX_ATTRIBUTES;
-		                else
-		                	increment = num_attr;
-                        if (temp[0]->block->tuple_dict[k * increment].size > 0) {
-                            for (l = 0; l < num_attr; l++) {
-                            	int block_index = 0; //defines in which block of chained blocks is a cell we are looking for
-                            	block_index = l / MAX_ATTRIBUTES;
-                            	if (blocks_per_row > 1 && block_index < blocks_per_row - 1)
-									increment = MAX_ATTRIBUTES;
-								else if (blocks_per_row > 1)
-									increment = num_attr % MAX_ATTRIBUTES;
-								else
-									increment = num_attr;
-                                type = temp[block_index]->block->tuple_dict[k * increment + (l % MAX_ATTRIBUTES)].type;
-                                size = temp[block_index]->block->tuple_dict[k * increment + (l % MAX_ATTRIBUTES)].size;
-                                address = temp[block_index]->block->tuple_dict[k * increment + (l % MAX_ATTRIBUTES)].address;
-                                AK_InsertAtEnd_L3(type, &(temp[block_index]->block->data[address]), size, row_root);
-                            }
-                            AK_print_row_to_file(len, row_root);
-                            AK_print_row_spacer_to_file(len, length);
-                            AK_DeleteAll_L3(&row_root);
-                        }
-                    }
-                }
-                i++;
-            }
-            fp = fopen(FILEPATH, "a");
-            fprintf(fp, "\n");
-        }
     }
     fclose(fp);
     AK_EPI;
@@ -1495,7 +1189,7 @@ TestResult AK_table_test() {
 
     printf("\nTable \"%s\":AK_create_table\n", table_name);
 
-    AK_create_table_parameter *params = (AK_create_table_parameter *) AK_malloc(2 * sizeof(AK_create_table_parameter*));
+    AK_create_table_parameter *params = (AK_create_table_parameter *) AK_malloc(2 * sizeof(AK_create_table_parameter));
 
     params[0] = *(AK_create_create_table_parameter(TYPE_INT, "ID"));
     params[1] = *(AK_create_create_table_parameter(TYPE_VARCHAR, "Name"));
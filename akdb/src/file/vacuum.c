@@ -0,0 +1,493 @@
+/**
+@file vacuum.c Provides functions for compaction of table blocks
+ */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#include "vacuum.h"
+#include "table.h"
+#include "fileio.h"
+#include "bulk.h"
+#include "idx/bitmap.h"
+#include "idx/index.h"
+#include "idx/bloom.h"
+
+/// tables waiting for the vacuum
+static char AK_vacuum_queue[VACUUM_QUEUE_SIZE][MAX_ATT_NAME];
+/// number of tables in AK_vacuum_queue
+static int AK_vacuum_queue_size = 0;
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that puts the table into the vacuum queue. It is called after rows of the table were deleted or
+ *        moved by an update, so deletes only leave tombstones in the tuple dictionary and the blocks are compacted
+ *        later by AK_vacuum_run. System tables are not queued.
+ * @param tblName table name
+ * @return EXIT_SUCCESS if the table is in the queue, EXIT_ERROR if it can not be queued
+ */
+int AK_vacuum_request(char *tblName) {
+    int i;
+
+    //system catalog is read by position, so its rows are never moved
+    if (tblName == NULL || strncmp(tblName, "AK_", 3) == 0 || strlen(tblName) >= MAX_ATT_NAME)
+        return EXIT_ERROR;
+
+    for (i = 0; i < AK_vacuum_queue_size; i++) {
+        if (strcmp(AK_vacuum_queue[i], tblName) == 0)
+            return EXIT_SUCCESS;
+    }
+    if (AK_vacuum_queue_size == VACUUM_QUEUE_SIZE) {
+        AK_dbg_messg(HIGH, FILE_MAN, "AK_vacuum_request: queue is full, %s is not queued\n", tblName);
+        return EXIT_ERROR;
+    }
+
+    strcpy(AK_vacuum_queue[AK_vacuum_queue_size++], tblName);
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that returns the number of tables waiting for the vacuum
+ * @return number of tables in the queue
+ */
+int AK_vacuum_pending() {
+    return AK_vacuum_queue_size;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that returns the number of row positions used in a block. Rows of normal, wide and PAX blocks all
+ *        take num_attr consecutive entries of the tuple dictionary.
+ * @param block block
+ * @param num_attr number of attributes of the table
+ * @return number of rows, including deleted ones
+ */
+static int AK_vacuum_num_rows(AK_block *block, int num_attr) {
+    if (block->last_tuple_dict_id == 0 && block->tuple_dict[0].size == FREE_INT)
+        return 0;
+    return (block->last_tuple_dict_id + 1) / num_attr;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that empties the tuple dictionary and the data area of a block. Header, type and chaining of the
+ *        block are kept.
+ * @param block block
+ * @return No return value
+ */
+static void AK_vacuum_reset_block(AK_block *block) {
+    int i;
+
+    for (i = 0; i < DATA_BLOCK_SIZE; i++) {
+        block->tuple_dict[i].type = FREE_INT;
+        block->tuple_dict[i].address = FREE_INT;
+        block->tuple_dict[i].size = FREE_INT;
+    }
+    memset(block->data, FREE_CHAR, DATA_BLOCK_SIZE * DATA_ENTRY_SIZE);
+    block->AK_free_space = 0;
+    block->last_tuple_dict_id = 0;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that gives an empty extent of the table back to the allocator. Cached copies of its blocks are
+ *        read again from the disk, and the row of the extent in AK_relation becomes a tombstone, so the extent is no
+ *        longer returned by AK_get_table_addresses.
+ * @param tblName table name
+ * @param from address of the first block of the extent
+ * @param to address after the last block of the extent
+ * @return EXIT_SUCCESS if the extent was released, otherwise EXIT_ERROR
+ */
+static int AK_vacuum_release_extent(char *tblName, int from, int to) {
+    AK_mem_block *mem_block;
+    AK_block *block;
+    char name[MAX_VARCHAR_LENGTH];
+    int start, i, j;
+    AK_PRO;
+
+    if (AK_delete_extent(from, to - 1) == EXIT_ERROR) {
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    for (i = from; i < to; i++) {
+        mem_block = AK_get_block(i);
+        AK_cache_block(i, mem_block);
+    }
+
+    //rows of AK_relation are obj_id, name, start_address and end_address
+    mem_block = AK_get_block(AK_get_system_table_address("AK_relation"));
+    block = mem_block->block;
+    for (i = 0; i + 3 < DATA_BLOCK_SIZE && i < block->last_tuple_dict_id; i += 4) {
+        if (block->tuple_dict[i].type == FREE_INT)
+            break;
+        if (block->tuple_dict[i + 1].size <= 0 || block->tuple_dict[i + 1].size >= MAX_VARCHAR_LENGTH)
+            continue;
+        memcpy(name, block->data + block->tuple_dict[i + 1].address, block->tuple_dict[i + 1].size);
+        name[block->tuple_dict[i + 1].size] = '\0';
+        memcpy(&start, block->data + block->tuple_dict[i + 2].address, sizeof(int));
+        if (strcmp(name, tblName) == 0 && start == from) {
+            for (j = i; j < i + 4; j++) {
+                block->tuple_dict[j].type = 0;
+                block->tuple_dict[j].size = 0;
+            }
+            AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+            AK_EPI;
+            return EXIT_SUCCESS;
+        }
+    }
+
+    AK_EPI;
+    return EXIT_ERROR;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that brings indexes of the table up to date with rows moved by the vacuum, because they point to
+ *        rows by their place, and rebuilds Bloom filters of the table, because rows moved to other extents
+ * @param tblName table name
+ * @param batch rows moved by the vacuum, each one removed from its old place and added to the new one
+ * @return No return value
+ */
+static void AK_vacuum_refresh_indexes(char *tblName, AK_index_batch *batch) {
+    AK_PRO;
+    AK_bloom_filter_rebuild(tblName);
+    AK_index_batch_apply(batch);
+    AK_EPI;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that compacts blocks of the table. Rows that are not deleted are moved to the front of the table
+ *        in the same order, so free space of the table ends up in whole blocks at its end. Extents that are left
+ *        empty, except the first one, are given back to the allocator and removed from AK_relation. Overflow pages
+ *        stay where they are, pages of long values of deleted rows are freed, and rows that were moved are moved in
+ *        indexes of the table too.
+ * @param tblName table name
+ * @return number of removed tombstone rows, EXIT_ERROR if the table does not exist
+ */
+int AK_vacuum_table(char *tblName) {
+    table_addresses *addresses;
+    AK_mem_block *mem_block, *write_block;
+    AK_block *copy;
+    AK_header *header;
+    struct list_node *row_root;
+    char entry_data[MAX_VARCHAR_LENGTH];
+    int *blocks, *first;
+    int num_attr, num_blocks = 0, write = 0, removed = 0, moved = 0;
+    int i, j, r, l, id, rows, live, size, page;
+    AK_index_batch batch;
+    AK_PRO;
+
+    num_attr = AK_num_attr(tblName);
+    if (num_attr <= 0) {
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+
+    //data blocks of the table in the order readers visit them
+    addresses = AK_get_table_addresses(tblName);
+    for (i = 0; i < MAX_EXTENTS_IN_SEGMENT && addresses->address_from[i] != 0; i++)
+        num_blocks += addresses->address_to[i] - addresses->address_from[i];
+    blocks = (int *) AK_malloc(sizeof(int) * (num_blocks + 1));
+    first = (int *) AK_malloc(sizeof(int) * MAX_EXTENTS_IN_SEGMENT);
+    num_blocks = 0;
+    for (i = 0; i < MAX_EXTENTS_IN_SEGMENT && addresses->address_from[i] != 0; i++) {
+        //position of the first block of the extent in blocks, -1 for extents of overflow pages
+        first[i] = -1;
+        if (AK_get_block(addresses->address_from[i])->block->type == BLOCK_TYPE_OVERFLOW)
+            continue;
+        first[i] = num_blocks;
+        for (j = addresses->address_from[i]; j < addresses->address_to[i]; j++)
+            blocks[num_blocks++] = j;
+    }
+
+    header = AK_get_header(tblName);
+    AK_index_batch_begin(&batch, tblName);
+    copy = (AK_block *) AK_malloc(sizeof(AK_block));
+    row_root = (struct list_node *) AK_malloc(sizeof(struct list_node));
+    AK_Init_L3(&row_root);
+
+    for (r = 0; r < num_blocks; r++) {
+        mem_block = AK_get_block(blocks[r]);
+        rows = AK_vacuum_num_rows(mem_block->block, num_attr);
+        if (rows == 0)
+            continue;
+
+        //the block is read from its copy, so rows can be written back into it
+        memcpy(copy, mem_block->block, sizeof(AK_block));
+        AK_vacuum_reset_block(mem_block->block);
+        AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+
+        for (j = 0; j < rows; j++) {
+            live = 0;
+            for (l = 0; l < num_attr; l++) {
+                if (copy->tuple_dict[j * num_attr + l].size > 0)
+                    live = 1;
+            }
+            if (!live) {
+                //overflow pages of long values of the deleted row can hold other values
+                for (l = 0; l < num_attr; l++) {
+                    id = j * num_attr + l;
+                    if (copy->tuple_dict[id].type == TYPE_OVERFLOW) {
+                        memcpy(&page, copy->data + copy->tuple_dict[id].address, sizeof(int));
+                        AK_overflow_delete(page);
+                    }
+                }
+                removed++;
+                continue;
+            }
+
+            AK_DeleteAll_L3(&row_root);
+            for (l = 0; l < num_attr; l++) {
+                id = j * num_attr + l;
+                size = copy->tuple_dict[id].size;
+                memset(entry_data, '\0', MAX_VARCHAR_LENGTH);
+                if (size > 0 && size < MAX_VARCHAR_LENGTH)
+                    memcpy(entry_data, copy->data + copy->tuple_dict[id].address, size);
+                AK_Insert_New_Element(copy->tuple_dict[id].type, entry_data, tblName, header[l].att_name, row_root);
+            }
+
+            //rows are written from the front, a block that is full or refuses the row is left behind
+            while (write < num_blocks) {
+                write_block = AK_get_block(blocks[write]);
+                if (write_block->block->AK_free_space < MAX_FREE_SPACE_SIZE &&
+                    write_block->block->last_tuple_dict_id < MAX_LAST_TUPLE_DICT_SIZE_TO_USE &&
+                    AK_insert_row_to_block(row_root, write_block->block) == EXIT_SUCCESS) {
+                    AK_mem_block_modify(write_block, BLOCK_DIRTY);
+                    break;
+                }
+                write++;
+            }
+            if (write == num_blocks) {
+                //never happens for rows of the same table, but the row must not get lost, AK_insert_row indexes it
+                AK_index_batch_add(&batch, copy, copy->address, j * num_attr, 0);
+                AK_insert_row(row_root);
+                write = num_blocks - 1;
+                moved++;
+            }
+            else if (blocks[write] != copy->address || AK_vacuum_num_rows(write_block->block, num_attr) - 1 != j) {
+                AK_index_batch_add(&batch, copy, copy->address, j * num_attr, 0);
+                AK_index_batch_add(&batch, write_block->block, blocks[write], write_block->block->last_tuple_dict_id + 1 - num_attr, 1);
+                moved++;
+            }
+        }
+    }
+
+    //extents behind the last written block hold no rows
+    for (i = 1; i < MAX_EXTENTS_IN_SEGMENT && addresses->address_from[i] != 0; i++) {
+        if (first[i] == -1 || first[i] <= write)
+            continue;
+        if (AK_vacuum_release_extent(tblName, addresses->address_from[i], addresses->address_to[i]) == EXIT_SUCCESS)
+            AK_dbg_messg(HIGH, FILE_MAN, "AK_vacuum_table: released extent %d - %d of %s\n", addresses->address_from[i], addresses->address_to[i] - 1, tblName);
+    }
+
+    if (moved > 0)
+        AK_vacuum_refresh_indexes(tblName, &batch);
+    else
+        AK_index_batch_apply(&batch);
+
+    AK_dbg_messg(HIGH, FILE_MAN, "AK_vacuum_table: %s, %d tombstones removed, %d rows moved\n", tblName, removed, moved);
+
+    AK_DeleteAll_L3(&row_root);
+    AK_free(row_root);
+    AK_free(copy);
+    AK_free(header);
+    AK_free(first);
+    AK_free(blocks);
+    AK_free(addresses);
+    AK_EPI;
+    return removed;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that vacuums all tables in the queue. It is meant to be called when the database is idle.
+ * @return number of vacuumed tables
+ */
+int AK_vacuum_run() {
+    char tblName[MAX_ATT_NAME];
+    int done = 0;
+    AK_PRO;
+
+    while (AK_vacuum_queue_size > 0) {
+        strcpy(tblName, AK_vacuum_queue[0]);
+        AK_vacuum_queue_size--;
+        memmove(AK_vacuum_queue[0], AK_vacuum_queue[1], sizeof(AK_vacuum_queue[0]) * AK_vacuum_queue_size);
+        if (AK_vacuum_table(tblName) != EXIT_ERROR)
+            done++;
+    }
+
+    AK_EPI;
+    return done;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that counts extents and used blocks of the table
+ * @param tblName table name
+ * @param used number of blocks that hold rows
+ * @return number of extents
+ */
+static int AK_vacuum_test_extents(char *tblName, int *used) {
+    table_addresses *addresses = AK_get_table_addresses(tblName);
+    int i, j;
+
+    *used = 0;
+    for (i = 0; i < MAX_EXTENTS_IN_SEGMENT && addresses->address_from[i] != 0; i++) {
+        for (j = addresses->address_from[i]; j < addresses->address_to[i]; j++) {
+            if (AK_get_block(j)->block->last_tuple_dict_id > 0)
+                (*used)++;
+        }
+    }
+    AK_free(addresses);
+    return i;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that checks the id of the row on the given position
+ * @param tblName table name
+ * @param row position of the row
+ * @param id expected id
+ * @return 1 if the row has the id, otherwise 0
+ */
+static int AK_vacuum_test_id(char *tblName, int row, int id) {
+    struct list_node *el = AK_get_tuple(row, 0, tblName);
+    return el != NULL && *((int *) el->data) == id;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function for testing tombstone deletes and the vacuum
+ * @return TestResult
+ */
+TestResult AK_vacuum_test() {
+    char *tblName = "vacuum_test";
+    int num_rows = 1200, num_kept = 200;
+    int ok = 0, fail = 0;
+    int i, id, grp, extents, used, used_before, removed;
+    char text[MAX_VARCHAR_LENGTH];
+    struct list_node **rows;
+    struct list_node *row_root;
+    AK_PRO;
+
+    printf("\n********** VACUUM TEST **********\n\n");
+
+    AK_header t_header[4] = {
+        {TYPE_INT, "id", {0}, {{'\0'}}, {{'\0'}}},
+        {TYPE_INT, "grp", {0}, {{'\0'}}, {{'\0'}}},
+        {TYPE_VARCHAR, "text", {0}, {{'\0'}}, {{'\0'}}},
+        {0, {'\0'}, {0}, {{'\0'}}, {{'\0'}}}};
+
+    if (AK_num_attr(tblName) > 0)
+        AK_delete_segment(tblName, SEGMENT_TYPE_TABLE);
+    if (AK_initialize_new_segment(tblName, SEGMENT_TYPE_TABLE, t_header) == EXIT_ERROR) {
+        printf("Could not create table %s\n", tblName);
+        AK_EPI;
+        return TEST_result(0, 1);
+    }
+
+    //long rows, so the table needs a second extent; rows behind num_kept are in group 2, the others alternate
+    memset(text, 'x', 60);
+    text[60] = '\0';
+    rows = (struct list_node **) AK_calloc(num_rows, sizeof(struct list_node *));
+    for (i = 0; i < num_rows; i++) {
+        id = i;
+        grp = i < num_kept ? i % 2 : 2;
+        rows[i] = (struct list_node *) AK_malloc(sizeof(struct list_node));
+        AK_Init_L3(&rows[i]);
+        AK_Insert_New_Element(TYPE_INT, &id, tblName, "id", rows[i]);
+        AK_Insert_New_Element(TYPE_INT, &grp, tblName, "grp", rows[i]);
+        AK_Insert_New_Element(TYPE_VARCHAR, text, tblName, "text", rows[i]);
+    }
+    AK_bulk_insert(tblName, rows, num_rows);
+    for (i = 0; i < num_rows; i++) {
+        AK_DeleteAll_L3(&rows[i]);
+        AK_free(rows[i]);
+    }
+    AK_free(rows);
+
+    extents = AK_vacuum_test_extents(tblName, &used_before);
+    printf("Table %s has %d rows in %d blocks of %d extents\n", tblName, AK_get_num_records(tblName), used_before, extents);
+    if (AK_get_num_records(tblName) == num_rows && extents > 1)
+        ok++;
+    else
+        fail++;
+
+    //delete only leaves tombstones and queues the table
+    row_root = (struct list_node *) AK_malloc(sizeof(struct list_node));
+    AK_Init_L3(&row_root);
+    grp = 2;
+    AK_Update_Existing_Element(TYPE_INT, &grp, tblName, "grp", row_root);
+    AK_delete_row(row_root);
+    AK_vacuum_test_extents(tblName, &used);
+    if (AK_get_num_records(tblName) == num_kept && used == used_before && AK_vacuum_pending() > 0)
+        ok++;
+    else
+        fail++;
+
+    //vacuum gives the empty extent back
+    if (AK_vacuum_run() > 0 && AK_vacuum_pending() == 0)
+        ok++;
+    else
+        fail++;
+    extents = AK_vacuum_test_extents(tblName, &used);
+    printf("After vacuum table %s has %d rows in %d blocks of %d extents\n", tblName, AK_get_num_records(tblName), used, extents);
+    if (extents == 1 && AK_get_num_records(tblName) == num_kept &&
+        AK_vacuum_test_id(tblName, 0, 0) && AK_vacuum_test_id(tblName, num_kept - 1, num_kept - 1))
+        ok++;
+    else
+        fail++;
+
+    //every other row is deleted, the rest is moved together
+    used_before = used;
+    AK_DeleteAll_L3(&row_root);
+    grp = 1;
+    AK_Update_Existing_Element(TYPE_INT, &grp, tblName, "grp", row_root);
+    AK_delete_row(row_root);
+    removed = AK_vacuum_table(tblName);
+    AK_vacuum_run();
+    AK_vacuum_test_extents(tblName, &used);
+    printf("Vacuum removed %d tombstones, table %s is in %d blocks instead of %d\n", removed, tblName, used, used_before);
+    if (removed == num_kept / 2 && used < used_before)
+        ok++;
+    else
+        fail++;
+    if (AK_get_num_records(tblName) == num_kept / 2 && AK_vacuum_test_id(tblName, 1, 2) &&
+        AK_vacuum_test_id(tblName, num_kept / 2 - 1, num_kept - 2))
+        ok++;
+    else
+        fail++;
+
+    //freed space is used by new rows
+    AK_DeleteAll_L3(&row_root);
+    id = num_rows;
+    grp = 0;
+    AK_Insert_New_Element(TYPE_INT, &id, tblName, "id", row_root);
+    AK_Insert_New_Element(TYPE_INT, &grp, tblName, "grp", row_root);
+    AK_Insert_New_Element(TYPE_VARCHAR, text, tblName, "text", row_root);
+    AK_insert_row(row_root);
+    if (AK_get_num_records(tblName) == num_kept / 2 + 1 && AK_vacuum_test_id(tblName, num_kept / 2, num_rows))
+        ok++;
+    else
+        fail++;
+
+    AK_DeleteAll_L3(&row_root);
+    AK_free(row_root);
+
+    AK_EPI;
+    return TEST_result(ok, fail);
+}
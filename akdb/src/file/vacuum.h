@@ -0,0 +1,72 @@
+/**
+@file vacuum.h Header file that provides functions and defines for compaction of table blocks
+ */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#ifndef VACUUM
+#define VACUUM
+
+#include "../auxi/test.h"
+#include "../auxi/constants.h"
+#include "../auxi/configuration.h"
+#include "../mm/memoman.h"
+#include "../auxi/mempro.h"
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that puts the table into the vacuum queue. It is called after rows of the table were deleted or
+ *        moved by an update, so deletes only leave tombstones in the tuple dictionary and the blocks are compacted
+ *        later by AK_vacuum_run. System tables are not queued.
+ * @param tblName table name
+ * @return EXIT_SUCCESS if the table is in the queue, EXIT_ERROR if it can not be queued
+ */
+int AK_vacuum_request(char *tblName);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that returns the number of tables waiting for the vacuum
+ * @return number of tables in the queue
+ */
+int AK_vacuum_pending();
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that compacts blocks of the table. Rows that are not deleted are moved to the front of the table
+ *        in the same order, so free space of the table ends up in whole blocks at its end. Extents that are left
+ *        empty, except the first one, are given back to the allocator and removed from AK_relation. Overflow pages
+ *        stay where they are, pages of long values of deleted rows are freed, and rows that were moved are moved in
+ *        indexes of the table too.
+ * @param tblName table name
+ * @return number of removed tombstone rows, EXIT_ERROR if the table does not exist
+ */
+int AK_vacuum_table(char *tblName);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that vacuums all tables in the queue. It is meant to be called when the database is idle.
+ * @return number of vacuumed tables
+ */
+int AK_vacuum_run();
+
+/**
+ * @author Karlo Vuković
+ * @brief Function for testing tombstone deletes and the vacuum
+ * @return TestResult
+ */
+TestResult AK_vacuum_test();
+
+#endif
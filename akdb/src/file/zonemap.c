@@ -0,0 +1,856 @@
+/**
+@file zonemap.c Provides functions for per-block zone maps
+ */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#include "zonemap.h"
+#include "table.h"
+#include "bulk.h"
+#include "filesearch.h"
+#include "../rel/selection.h"
+#include "../rel/expression_check.h"
+#include "../rel/projection.h"
+
+/// zone maps by block address, NULL for blocks that were not read or written since the start
+static AK_zone_map **AK_zone_maps = NULL;
+/// number of addresses in AK_zone_maps
+static int AK_zone_maps_size = 0;
+/// zone maps are refreshed by every thread that writes a block
+static pthread_mutex_t AK_zone_map_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that checks if values of the type are summarized by min and max
+ * @param type data type
+ * @return 1 for int, date, datetime, time, interval, period, float and number, otherwise 0
+ */
+int AK_zone_map_supported(int type) {
+    switch (type) {
+        case TYPE_INT:
+        case TYPE_DATE:
+        case TYPE_DATETIME:
+        case TYPE_TIME:
+        case TYPE_INTERVAL:
+        case TYPE_PERIOD:
+        case TYPE_FLOAT:
+        case TYPE_NUMBER:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that reads a value of a supported type as a double
+ * @param type data type
+ * @param data value as it is stored in the block
+ * @param size size of the value
+ * @param value value as a double
+ * @return 1 if the value was read, 0 if it is too short for the type
+ */
+static int AK_zone_map_value(int type, const unsigned char *data, int size, double *value) {
+    int int_value;
+    float float_value;
+
+    switch (type) {
+        case TYPE_FLOAT:
+            //float entries hold a float, the rest of the entry is padding
+            if (size < (int) sizeof (float))
+                return 0;
+            memcpy(&float_value, data, sizeof (float));
+            *value = float_value;
+            return 1;
+        case TYPE_NUMBER:
+            if (size < (int) sizeof (double))
+                return 0;
+            memcpy(value, data, sizeof (double));
+            return 1;
+        default:
+            if (size < (int) sizeof (int))
+                return 0;
+            memcpy(&int_value, data, sizeof (int));
+            *value = int_value;
+            return 1;
+    }
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that returns the slot of a block address, allocating the directory the first time
+ * @param address block address
+ * @return pointer to the slot, NULL if the address is out of range
+ */
+static AK_zone_map **AK_zone_map_slot(int address) {
+    if (AK_zone_maps == NULL) {
+        AK_zone_maps_size = DB_FILE_BLOCKS_NUM + 1;
+        AK_zone_maps = (AK_zone_map **) AK_calloc(AK_zone_maps_size, sizeof (AK_zone_map *));
+    }
+    if (address < 0 || address >= AK_zone_maps_size)
+        return NULL;
+    return &AK_zone_maps[address];
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that computes the zone map of a block from its tuple dictionary and keeps it under the address of
+ *        the block. It is called by AK_write_block and AK_read_block, so blocks of an existing database get their
+ *        zone maps the first time they are read. AK_mem_block_modify forgets the zone map of a block changed in the
+ *        cache, and it is computed again when the block is written or checked by AK_zone_map_table_may_match.
+ * @param block block
+ * @return No return value
+ */
+void AK_zone_map_update(AK_block *block) {
+    AK_zone_map zone_map;
+    AK_zone_map **slot;
+    AK_zone *zone;
+    AK_tuple_dict *dict;
+    int i, j, type;
+    double value;
+
+    if (block->type != BLOCK_TYPE_NORMAL && block->type != BLOCK_TYPE_PAX && block->type != BLOCK_TYPE_WIDE &&
+        block->type != BLOCK_TYPE_FREE) {
+        AK_zone_map_invalidate(block->address);
+        return;
+    }
+
+    memset(&zone_map, 0, sizeof (AK_zone_map));
+    while (zone_map.num_attr < MAX_ATTRIBUTES && block->header[zone_map.num_attr].att_name[0] != FREE_CHAR)
+        zone_map.num_attr++;
+    for (j = 0; j < zone_map.num_attr; j++)
+        zone_map.zone[j].bounded = AK_zone_map_supported(block->header[j].type);
+
+    if (zone_map.num_attr == 0) {
+        //only a block without rows can be described without a header
+        if (block->tuple_dict[0].type != FREE_INT) {
+            AK_zone_map_invalidate(block->address);
+            return;
+        }
+    } else {
+        for (i = 0; i < DATA_BLOCK_SIZE && block->tuple_dict[i].type != FREE_INT; i += zone_map.num_attr) {
+            zone_map.num_rows++;
+            for (j = 0; j < zone_map.num_attr && i + j < DATA_BLOCK_SIZE; j++) {
+                zone = &zone_map.zone[j];
+                dict = &block->tuple_dict[i + j];
+                type = block->header[j].type;
+                if (dict->size <= 0 || dict->type != type) {
+                    zone->null_count++;
+                    continue;
+                }
+                zone->num_values++;
+                if (!zone->bounded)
+                    continue;
+                if (!AK_zone_map_value(type, block->data + dict->address, dict->size, &value) || isnan(value)) {
+                    //such values are not ordered, so the block can not be skipped by value
+                    zone->bounded = 0;
+                    continue;
+                }
+                if (zone->num_values == 1 || value < zone->min)
+                    zone->min = value;
+                if (zone->num_values == 1 || value > zone->max)
+                    zone->max = value;
+            }
+        }
+    }
+
+    pthread_mutex_lock(&AK_zone_map_mutex);
+    slot = AK_zone_map_slot(block->address);
+    if (slot != NULL) {
+        if (*slot == NULL)
+            *slot = (AK_zone_map *) AK_malloc(sizeof (AK_zone_map));
+        if (*slot != NULL)
+            memcpy(*slot, &zone_map, sizeof (AK_zone_map));
+    }
+    pthread_mutex_unlock(&AK_zone_map_mutex);
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that forgets the zone map of a block, used when a block is written without AK_write_block
+ * @param address block address
+ * @return No return value
+ */
+void AK_zone_map_invalidate(int address) {
+    AK_zone_map **slot;
+
+    pthread_mutex_lock(&AK_zone_map_mutex);
+    slot = AK_zone_map_slot(address);
+    if (slot != NULL && *slot != NULL) {
+        AK_free(*slot);
+        *slot = NULL;
+    }
+    pthread_mutex_unlock(&AK_zone_map_mutex);
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that copies the zone map of a block
+ * @param address block address
+ * @param zone_map zone map to fill
+ * @return EXIT_SUCCESS if the zone map is known, EXIT_ERROR otherwise
+ */
+int AK_zone_map_get(int address, AK_zone_map *zone_map) {
+    AK_zone_map **slot;
+    int result = EXIT_ERROR;
+
+    pthread_mutex_lock(&AK_zone_map_mutex);
+    slot = AK_zone_map_slot(address);
+    if (slot != NULL && *slot != NULL) {
+        memcpy(zone_map, *slot, sizeof (AK_zone_map));
+        result = EXIT_SUCCESS;
+    }
+    pthread_mutex_unlock(&AK_zone_map_mutex);
+    return result;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that copies the zone map of a block, computing it from the cached block when the block was changed
+ *        after its zone map was made
+ * @param address block address
+ * @param zone_map zone map to fill
+ * @return EXIT_SUCCESS if the zone map is known, EXIT_ERROR otherwise
+ */
+static int AK_zone_map_fetch(int address, AK_zone_map *zone_map) {
+    AK_mem_block *mem_block;
+
+    if (AK_zone_map_get(address, zone_map) == EXIT_SUCCESS)
+        return EXIT_SUCCESS;
+    mem_block = AK_get_block(address);
+    if (mem_block == NULL)
+        return EXIT_ERROR;
+    AK_zone_map_update(mem_block->block);
+    return AK_zone_map_get(address, zone_map);
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that checks one zone against a range
+ * @param zone zone of the attribute
+ * @param lower lower bound
+ * @param upper upper bound
+ * @param nulls_match 1 if rows with a null value have to be read anyway, otherwise 0
+ * @return 0 if no value of the zone can be in the range, otherwise 1
+ */
+static int AK_zone_map_zone_matches(AK_zone *zone, double lower, double upper, int nulls_match) {
+    if (nulls_match && zone->null_count > 0)
+        return 1;
+    if (zone->num_values == 0)
+        return 0;
+    if (!zone->bounded)
+        return 1;
+    return !(zone->max < lower || zone->min > upper);
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that checks if a block can hold a value of the attribute in the inclusive range [lower, upper].
+ *        Blocks without a known zone map always can.
+ * @param address block address
+ * @param attribute index of the attribute in the header
+ * @param lower lower bound, -INFINITY if there is none
+ * @param upper upper bound, INFINITY if there is none
+ * @param nulls_match 1 if rows with a null value have to be read anyway, otherwise 0
+ * @return 0 if the block can be skipped, otherwise 1
+ */
+int AK_zone_map_may_match(int address, int attribute, double lower, double upper, int nulls_match) {
+    AK_zone_map zone_map;
+
+    if (AK_zone_map_get(address, &zone_map) == EXIT_ERROR)
+        return 1;
+    if (zone_map.num_rows == 0)
+        return 0;
+    if (attribute < 0 || attribute >= zone_map.num_attr)
+        return 1;
+    return AK_zone_map_zone_matches(&zone_map.zone[attribute], lower, upper, nulls_match);
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that checks a block against bounds of all attributes, like the ones from AK_zone_map_expr_bounds.
+ *        Empty blocks never match.
+ * @param address block address
+ * @param num_attr number of attributes
+ * @param lower lower bound of each attribute
+ * @param upper upper bound of each attribute
+ * @param nulls_match 1 if rows with a null value have to be read anyway, otherwise 0
+ * @return 0 if the block can be skipped, otherwise 1
+ */
+int AK_zone_map_may_match_bounds(int address, int num_attr, double *lower, double *upper, int nulls_match) {
+    AK_zone_map zone_map;
+    int i;
+
+    if (AK_zone_map_get(address, &zone_map) == EXIT_ERROR)
+        return 1;
+    if (zone_map.num_rows == 0)
+        return 0;
+    if (zone_map.num_attr != num_attr)
+        return 1;
+    for (i = 0; i < num_attr; i++) {
+        if (lower[i] == -INFINITY && upper[i] == INFINITY)
+            continue;
+        if (!AK_zone_map_zone_matches(&zone_map.zone[i], lower[i], upper[i], nulls_match))
+            return 0;
+    }
+    return 1;
+}
+
+/**
+ * @author Karlo Vuković
+ * @struct AK_zone_map_bounds
+ * @brief Structure that keeps bounds of every attribute for AK_zone_map_expr_bounds
+ */
+typedef struct {
+    /// lower bound of each attribute
+    double lower[MAX_ATTRIBUTES];
+    /// upper bound of each attribute
+    double upper[MAX_ATTRIBUTES];
+} AK_zone_map_bounds;
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that sets bounds that are implied by a comparison of two operands
+ * @param op comparison operator
+ * @param left left operand
+ * @param right right operand
+ * @param header table header
+ * @param bounds bounds to narrow
+ * @return No return value
+ */
+static void AK_zone_map_compare_bounds(char *op, AK_expression_operand *left, AK_expression_operand *right,
+                                       AK_header *header, AK_zone_map_bounds *bounds) {
+    AK_expression_operand *attribute, *constant;
+    int less, greater;
+    double value;
+
+    //attribute on the right flips the comparison
+    if (left->attribute >= 0 && right->el->type != TYPE_ATTRIBS) {
+        attribute = left;
+        constant = right;
+        less = op[0] == '<';
+        greater = op[0] == '>';
+    } else if (left->el->type != TYPE_ATTRIBS && right->attribute >= 0) {
+        attribute = right;
+        constant = left;
+        less = op[0] == '>';
+        greater = op[0] == '<';
+    } else
+        return;
+    if (constant->el->type != header[attribute->attribute].type || !AK_zone_map_supported(constant->el->type) ||
+        !AK_zone_map_value(constant->el->type, (unsigned char *) constant->el->data, constant->el->size, &value) ||
+        isnan(value))
+        return;
+
+    if (strcmp(op, "=") == 0 || less) {
+        if (value < bounds->upper[attribute->attribute])
+            bounds->upper[attribute->attribute] = value;
+    }
+    if (strcmp(op, "=") == 0 || greater) {
+        if (value > bounds->lower[attribute->attribute])
+            bounds->lower[attribute->attribute] = value;
+    }
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that sets the bounds of a new result of AK_zone_map_expr_bounds, none of the attributes is bounded
+ * @param result bounds of the result
+ * @return No return value
+ */
+static void AK_zone_map_expr_init(void *result) {
+    AK_zone_map_bounds *bounds = (AK_zone_map_bounds *) result;
+    int i;
+
+    for (i = 0; i < MAX_ATTRIBUTES; i++) {
+        bounds->lower[i] = -INFINITY;
+        bounds->upper[i] = INFINITY;
+    }
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that gives bounds implied by AND of two results for AK_zone_map_expr_bounds
+ * @param result bounds of the AND
+ * @param first bounds of the first operand
+ * @param second bounds of the second operand
+ * @return No return value
+ */
+static void AK_zone_map_expr_and(void *result, void *first, void *second) {
+    AK_zone_map_bounds *bounds = (AK_zone_map_bounds *) result;
+    AK_zone_map_bounds *left = (AK_zone_map_bounds *) first, *right = (AK_zone_map_bounds *) second;
+    int i;
+
+    for (i = 0; i < MAX_ATTRIBUTES; i++) {
+        bounds->lower[i] = left->lower[i] > right->lower[i] ? left->lower[i] : right->lower[i];
+        bounds->upper[i] = left->upper[i] < right->upper[i] ? left->upper[i] : right->upper[i];
+    }
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that gives bounds implied by a comparison or BETWEEN for AK_zone_map_expr_bounds
+ * @param op operator
+ * @param operands operands read so far
+ * @param num_operands number of operands
+ * @param header table header
+ * @param result bounds of the operator
+ * @return No return value
+ */
+static void AK_zone_map_expr_compare(char *op, AK_expression_operand *operands, int num_operands, AK_header *header,
+                                     void *result) {
+    AK_zone_map_bounds *bounds = (AK_zone_map_bounds *) result;
+
+    if (strcmp(op, "BETWEEN") == 0 && num_operands >= 3) {
+        AK_zone_map_compare_bounds(">=", &operands[num_operands - 3], &operands[num_operands - 2], header, bounds);
+        AK_zone_map_compare_bounds("<=", &operands[num_operands - 3], &operands[num_operands - 1], header, bounds);
+    } else if ((strcmp(op, "=") == 0 || strcmp(op, "<") == 0 || strcmp(op, ">") == 0 ||
+                strcmp(op, "<=") == 0 || strcmp(op, ">=") == 0) && num_operands >= 2) {
+        AK_zone_map_compare_bounds(op, &operands[num_operands - 2], &operands[num_operands - 1], header, bounds);
+    }
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that finds bounds of attributes that every row satisfying the postfix expression has to be within.
+ *        The expression is followed with AK_expression_walk, and only comparisons of an attribute with a constant of
+ *        the same type, BETWEEN and AND give bounds. Strict comparisons give the inclusive bound.
+ * @param expr postfix expression, may be NULL
+ * @param header table header
+ * @param num_attr number of attributes
+ * @param lower lower bound of each attribute, -INFINITY if there is none
+ * @param upper upper bound of each attribute, INFINITY if there is none
+ * @return number of attributes with bounds
+ */
+int AK_zone_map_expr_bounds(struct list_node *expr, AK_header *header, int num_attr, double *lower, double *upper) {
+    AK_zone_map_bounds bounds;
+    AK_expression_walker walker = {sizeof (AK_zone_map_bounds), AK_zone_map_expr_init, AK_zone_map_expr_and,
+                                   AK_zone_map_expr_compare};
+    int i, bounded = 0;
+    AK_PRO;
+
+    AK_zone_map_expr_init(&bounds);
+    AK_expression_walk(expr, header, num_attr, &walker, &bounds);
+    for (i = 0; i < num_attr; i++) {
+        lower[i] = bounds.lower[i];
+        upper[i] = bounds.upper[i];
+        if (lower[i] != -INFINITY || upper[i] != INFINITY)
+            bounded++;
+    }
+    AK_EPI;
+    return bounded;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that checks if any block of the table can hold a value of the attribute in the inclusive range
+ *        [lower, upper], so callers of index range searches can tell that a range is empty without the index.
+ *        Blocks changed in the cache get their zone maps again from the cached block.
+ * @param tblName table name
+ * @param attribute attribute name
+ * @param lower lower bound
+ * @param upper upper bound
+ * @return 0 if no block of the table can hold such a value, otherwise 1
+ */
+int AK_zone_map_table_may_match(char *tblName, char *attribute, double lower, double upper) {
+    AK_zone_map zone_map;
+    table_addresses *addresses;
+    AK_header *header;
+    int num_attr, index = -1;
+    int i, j, result = 0;
+    AK_PRO;
+
+    num_attr = AK_num_attr(tblName);
+    header = (AK_header *) AK_get_header(tblName);
+    if (header == NULL || num_attr <= 0) {
+        AK_free(header);
+        AK_EPI;
+        return 1;
+    }
+    for (i = 0; i < num_attr; i++) {
+        if (strcmp(header[i].att_name, attribute) == 0)
+            index = i;
+    }
+    AK_free(header);
+    if (index < 0) {
+        AK_EPI;
+        return 1;
+    }
+
+    addresses = AK_get_table_addresses(tblName);
+    for (i = 0; i < MAX_EXTENTS_IN_SEGMENT && addresses->address_from[i] != 0 && !result; i++) {
+        for (j = addresses->address_from[i]; j < addresses->address_to[i] && !result; j++) {
+            if (AK_zone_map_fetch(j, &zone_map) == EXIT_ERROR)
+                result = 1;
+            else if (zone_map.num_rows > 0)
+                result = index >= zone_map.num_attr ||
+                         AK_zone_map_zone_matches(&zone_map.zone[index], lower, upper, 0);
+        }
+    }
+    AK_free(addresses);
+    AK_EPI;
+    return result;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that counts row positions of a table from the zone maps of its blocks, deleted rows included, so
+ *        it tells how many rows a scan of the table reads. Blocks without a zone map are read once to get one.
+ * @param tblName table name
+ * @return number of row positions of the table
+ */
+int AK_zone_map_table_rows(char *tblName) {
+    AK_zone_map zone_map;
+    table_addresses *addresses;
+    int i, j, num_rows = 0;
+    AK_PRO;
+
+    addresses = AK_get_table_addresses(tblName);
+    for (i = 0; i < MAX_EXTENTS_IN_SEGMENT && addresses->address_from[i] != 0; i++) {
+        for (j = addresses->address_from[i]; j < addresses->address_to[i]; j++) {
+            if (AK_zone_map_fetch(j, &zone_map) == EXIT_SUCCESS)
+                num_rows += zone_map.num_rows;
+        }
+    }
+    AK_free(addresses);
+    AK_EPI;
+    return num_rows;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that counts blocks of the table that have to be read for a range of the first attribute
+ * @param tblName table name
+ * @param lower lower bound
+ * @param upper upper bound
+ * @param blocks number of blocks of the table with rows
+ * @return number of blocks that can hold a matching row
+ */
+static int AK_zone_map_test_blocks(char *tblName, double lower, double upper, int *blocks) {
+    table_addresses *addresses = AK_get_table_addresses(tblName);
+    AK_zone_map zone_map;
+    int i, j, read = 0;
+
+    *blocks = 0;
+    for (i = 0; i < MAX_EXTENTS_IN_SEGMENT && addresses->address_from[i] != 0; i++) {
+        for (j = addresses->address_from[i]; j < addresses->address_to[i]; j++) {
+            if (AK_zone_map_get(j, &zone_map) == EXIT_SUCCESS && zone_map.num_rows > 0)
+                (*blocks)++;
+            if (AK_zone_map_may_match(j, 0, lower, upper, 0))
+                read++;
+        }
+    }
+    AK_free(addresses);
+    return read;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that checks that zone maps of the table agree with the values in its blocks
+ * @param tblName table name
+ * @param num_attr number of attributes
+ * @return 1 if every block with rows has a correct zone map, otherwise 0
+ */
+static int AK_zone_map_test_check(char *tblName, int num_attr) {
+    table_addresses *addresses = AK_get_table_addresses(tblName);
+    AK_zone_map zone_map;
+    AK_block *block;
+    int i, j, k, a, ok = 1;
+    double value, min, max;
+    int num_values;
+
+    for (i = 0; i < MAX_EXTENTS_IN_SEGMENT && addresses->address_from[i] != 0; i++) {
+        for (j = addresses->address_from[i]; j < addresses->address_to[i]; j++) {
+            if (AK_zone_map_get(j, &zone_map) == EXIT_ERROR)
+                continue;
+            block = AK_get_block(j)->block;
+            for (a = 0; a < num_attr && zone_map.num_rows > 0; a++) {
+                if (!AK_zone_map_supported(block->header[a].type))
+                    continue;
+                num_values = 0;
+                min = max = 0;
+                for (k = a; k < DATA_BLOCK_SIZE && block->tuple_dict[k - a].type != FREE_INT; k += num_attr) {
+                    if (block->tuple_dict[k].size <= 0 || block->tuple_dict[k].type != block->header[a].type)
+                        continue;
+                    AK_zone_map_value(block->header[a].type, block->data + block->tuple_dict[k].address,
+                                      block->tuple_dict[k].size, &value);
+                    if (num_values == 0 || value < min)
+                        min = value;
+                    if (num_values == 0 || value > max)
+                        max = value;
+                    num_values++;
+                }
+                if (zone_map.zone[a].num_values != num_values ||
+                    (num_values > 0 && (zone_map.zone[a].min != min || zone_map.zone[a].max != max)))
+                    ok = 0;
+            }
+        }
+    }
+    AK_free(addresses);
+    return ok;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that inserts a row with two int values into the table
+ * @param tblName table name
+ * @param id value of id
+ * @param v value of v
+ * @return No return value
+ */
+static void AK_zone_map_test_insert(char *tblName, int id, int v) {
+    struct list_node *row_root = (struct list_node *) AK_malloc(sizeof (struct list_node));
+
+    AK_Init_L3(&row_root);
+    AK_Insert_New_Element(TYPE_INT, &id, tblName, "id", row_root);
+    AK_Insert_New_Element(TYPE_INT, &v, tblName, "v", row_root);
+    AK_insert_row(row_root);
+    AK_DeleteAll_L3(&row_root);
+    AK_free(row_root);
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that checks that a block changed in the cache does not get its zone map from the copy on disk
+ *        when another operator reads the table, so a selection still finds a row inserted after the last flush
+ * @return 1 if the selection finds the row, otherwise 0
+ */
+static int AK_zone_map_test_stale(void) {
+    char *tblName = "zone_map_test_stale";
+    char *projTable = "zone_map_test_stale_projection";
+    char *dstTable = "zone_map_test_stale_selection";
+    struct list_node *att, *expr;
+    int bound = 50, selected;
+
+    AK_header t_header[3] = {
+        {TYPE_INT, "id", {0}, {{'\0'}}, {{'\0'}}},
+        {TYPE_INT, "v", {0}, {{'\0'}}, {{'\0'}}},
+        {0, {'\0'}, {0}, {{'\0'}}, {{'\0'}}}};
+
+    if (AK_num_attr(tblName) > 0)
+        AK_delete_segment(tblName, SEGMENT_TYPE_TABLE);
+    if (AK_initialize_new_segment(tblName, SEGMENT_TYPE_TABLE, t_header) == EXIT_ERROR)
+        return 0;
+    AK_zone_map_test_insert(tblName, 1, 1);
+    AK_zone_map_test_insert(tblName, 2, 2);
+    AK_flush_cache();
+    AK_zone_map_test_insert(tblName, 100, 3);
+
+    att = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    AK_Init_L3(&att);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "id", sizeof ("id"), att);
+    AK_projection(tblName, projTable, att, NULL);
+    AK_DeleteAll_L3(&att);
+    AK_free(att);
+
+    expr = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    AK_Init_L3(&expr);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "id", sizeof ("id"), expr);
+    AK_InsertAtEnd_L3(TYPE_INT, (char *) &bound, sizeof (int), expr);
+    AK_InsertAtEnd_L3(TYPE_OPERATOR, ">", sizeof (">"), expr);
+    strcpy(expr->table, dstTable);
+    AK_selection(tblName, dstTable, expr);
+    selected = AK_get_num_records(dstTable);
+    AK_DeleteAll_L3(&expr);
+    AK_free(expr);
+    printf("Selection of id > 50 after a projection returned %d rows, expected 1\n", selected);
+
+    AK_delete_segment(dstTable, SEGMENT_TYPE_TABLE);
+    AK_delete_segment(projTable, SEGMENT_TYPE_TABLE);
+    AK_delete_segment(tblName, SEGMENT_TYPE_TABLE);
+    return selected == 1;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function for testing zone maps
+ * @return TestResult
+ */
+TestResult AK_zone_map_test() {
+    char *tblName = "zone_map_test";
+    char *dstTable = "zone_map_test_selection";
+    int num_rows = 3000;
+    int ok = 0, fail = 0;
+    int i, id, blocks, read, num_bounds;
+    float score;
+    char name[MAX_VARCHAR_LENGTH];
+    double lower[MAX_ATTRIBUTES], upper[MAX_ATTRIBUTES];
+    struct list_node **rows;
+    struct list_node *row_root, *expr;
+    search_params sp[1];
+    search_result sr;
+    table_addresses *addresses;
+    int iLower, iUpper;
+    AK_PRO;
+
+    printf("\n********** ZONE MAP TEST **********\n\n");
+
+    AK_header t_header[4] = {
+        {TYPE_INT, "id", {0}, {{'\0'}}, {{'\0'}}},
+        {TYPE_FLOAT, "score", {0}, {{'\0'}}, {{'\0'}}},
+        {TYPE_VARCHAR, "name", {0}, {{'\0'}}, {{'\0'}}},
+        {0, {'\0'}, {0}, {{'\0'}}, {{'\0'}}}};
+
+    if (AK_num_attr(tblName) > 0)
+        AK_delete_segment(tblName, SEGMENT_TYPE_TABLE);
+    if (AK_num_attr(dstTable) > 0)
+        AK_delete_segment(dstTable, SEGMENT_TYPE_TABLE);
+    if (AK_initialize_new_segment(tblName, SEGMENT_TYPE_TABLE, t_header) == EXIT_ERROR) {
+        printf("Could not create table %s\n", tblName);
+        AK_EPI;
+        return TEST_result(0, 1);
+    }
+
+    //ids grow with the position, like in a table that is filled in time order
+    rows = (struct list_node **) AK_calloc(num_rows, sizeof (struct list_node *));
+    for (i = 0; i < num_rows; i++) {
+        id = i;
+        score = (i % 100) * 0.5f;
+        sprintf(name, "name %d", i % 7);
+        rows[i] = (struct list_node *) AK_malloc(sizeof (struct list_node));
+        AK_Init_L3(&rows[i]);
+        AK_Insert_New_Element(TYPE_INT, &id, tblName, "id", rows[i]);
+        AK_Insert_New_Element(TYPE_FLOAT, &score, tblName, "score", rows[i]);
+        AK_Insert_New_Element(TYPE_VARCHAR, name, tblName, "name", rows[i]);
+    }
+    AK_bulk_insert(tblName, rows, num_rows);
+    for (i = 0; i < num_rows; i++) {
+        AK_DeleteAll_L3(&rows[i]);
+        AK_free(rows[i]);
+    }
+    AK_free(rows);
+
+    //blocks changed in the cache get their zone maps when the table is checked, and they agree with the values
+    if (!AK_zone_map_table_may_match(tblName, "id", -10, -1) && AK_zone_map_test_check(tblName, 3))
+        ok++;
+    else {
+        printf("Zone maps do not agree with the blocks\n");
+        fail++;
+    }
+
+    //a scan without bounds reads every block, so blocks that were only allocated get their zone maps too
+    sp[0].szAttribute = "name";
+    sp[0].iSearchType = SEARCH_ALL;
+    sr = AK_search_unsorted(tblName, sp, 1);
+    AK_deallocate_search_result(sr);
+
+    //a narrow range of ids needs one or two blocks, a range outside the table none
+    read = AK_zone_map_test_blocks(tblName, 100, 120, &blocks);
+    printf("Range of ids [100, 120] reads %d of %d blocks with rows\n", read, blocks);
+    if (blocks > 2 && read >= 1 && read <= 2 && AK_zone_map_test_blocks(tblName, num_rows, 2 * num_rows, &blocks) == 0)
+        ok++;
+    else
+        fail++;
+
+    //search skips blocks and still finds every row
+    sp[0].szAttribute = "id";
+    sp[0].iSearchType = SEARCH_RANGE;
+    iLower = 100;
+    iUpper = 120;
+    sp[0].pData_lower = &iLower;
+    sp[0].pData_upper = &iUpper;
+    sr = AK_search_unsorted(tblName, sp, 1);
+    if (sr.iNum_tuple_addresses == 21)
+        ok++;
+    else {
+        printf("Search found %d rows instead of 21\n", sr.iNum_tuple_addresses);
+        fail++;
+    }
+    AK_deallocate_search_result(sr);
+
+    //an inserted row widens the zone map of its block
+    row_root = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    AK_Init_L3(&row_root);
+    id = 1000000;
+    score = 1;
+    AK_Insert_New_Element(TYPE_INT, &id, tblName, "id", row_root);
+    AK_Insert_New_Element(TYPE_FLOAT, &score, tblName, "score", row_root);
+    AK_Insert_New_Element(TYPE_VARCHAR, "inserted", tblName, "name", row_root);
+    AK_insert_row(row_root);
+    AK_DeleteAll_L3(&row_root);
+    AK_free(row_root);
+    if (AK_zone_map_table_may_match(tblName, "id", id, id) && !AK_zone_map_table_may_match(tblName, "id", -10, -1) &&
+        AK_zone_map_test_blocks(tblName, id, id, &blocks) == 1 && AK_zone_map_test_check(tblName, 3))
+        ok++;
+    else {
+        printf("Inserted row is not in the zone maps\n");
+        fail++;
+    }
+
+    //bounds follow AND and BETWEEN, other operators give none
+    expr = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    AK_Init_L3(&expr);
+    iLower = 100;
+    iUpper = 120;
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "id", sizeof ("id"), expr);
+    AK_InsertAtEnd_L3(TYPE_INT, (char *) &iLower, sizeof (int), expr);
+    AK_InsertAtEnd_L3(TYPE_OPERATOR, ">=", sizeof (">="), expr);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "id", sizeof ("id"), expr);
+    AK_InsertAtEnd_L3(TYPE_INT, (char *) &iUpper, sizeof (int), expr);
+    AK_InsertAtEnd_L3(TYPE_OPERATOR, "<=", sizeof ("<="), expr);
+    AK_InsertAtEnd_L3(TYPE_OPERATOR, "AND", sizeof ("AND"), expr);
+    num_bounds = AK_zone_map_expr_bounds(expr, t_header, 3, lower, upper);
+    if (num_bounds == 1 && lower[0] == 100 && upper[0] == 120 && lower[1] == -INFINITY && upper[2] == INFINITY)
+        ok++;
+    else
+        fail++;
+
+    //selection reads only the blocks the bounds allow and returns the same rows
+    strcpy(expr->table, dstTable);
+    AK_selection(tblName, dstTable, expr);
+    if (AK_get_num_records(dstTable) == 21)
+        ok++;
+    else {
+        printf("Selection returned %d rows instead of 21\n", AK_get_num_records(dstTable));
+        fail++;
+    }
+    AK_DeleteAll_L3(&expr);
+
+    score = 10;
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "score", sizeof ("score"), expr);
+    AK_InsertAtEnd_L3(TYPE_FLOAT, (char *) &score, sizeof (float), expr);
+    AK_InsertAtEnd_L3(TYPE_FLOAT, (char *) &score, sizeof (float), expr);
+    AK_InsertAtEnd_L3(TYPE_OPERATOR, "BETWEEN", sizeof ("BETWEEN"), expr);
+    num_bounds = AK_zone_map_expr_bounds(expr, t_header, 3, lower, upper);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "id", sizeof ("id"), expr);
+    AK_InsertAtEnd_L3(TYPE_INT, (char *) &iLower, sizeof (int), expr);
+    AK_InsertAtEnd_L3(TYPE_OPERATOR, "<", sizeof ("<"), expr);
+    AK_InsertAtEnd_L3(TYPE_OPERATOR, "OR", sizeof ("OR"), expr);
+    if (num_bounds == 1 && lower[1] == 10 && upper[1] == 10 && AK_zone_map_expr_bounds(expr, t_header, 3, lower, upper) == 0)
+        ok++;
+    else
+        fail++;
+    AK_DeleteAll_L3(&expr);
+    AK_free(expr);
+
+    //blocks without a zone map are always read
+    addresses = AK_get_table_addresses(tblName);
+    AK_zone_map_invalidate(addresses->address_from[0]);
+    AK_free(addresses);
+    if (AK_zone_map_test_blocks(tblName, -10, -1, &blocks) == 1)
+        ok++;
+    else
+        fail++;
+
+    //reads of other operators do not hide rows that are only in the cache
+    if (AK_zone_map_test_stale())
+        ok++;
+    else
+        fail++;
+
+    AK_EPI;
+    return TEST_result(ok, fail);
+}
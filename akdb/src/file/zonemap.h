@@ -0,0 +1,169 @@
+/**
+@file zonemap.h Header file that provides data structures and functions for per-block zone maps
+ */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor Boston, MA 02110-1301,  USA
+ */
+
+#ifndef ZONEMAP
+#define ZONEMAP
+
+#include "../auxi/test.h"
+#include "../auxi/constants.h"
+#include "../auxi/configuration.h"
+#include "../mm/memoman.h"
+#include "../auxi/mempro.h"
+#include <math.h>
+
+/**
+ * @author Karlo Vuković
+ * @struct AK_zone
+ * @brief Structure that summarizes the values of one attribute in one block. Int, date, time, float and number
+ *        values are kept as doubles, which holds all of them exactly.
+ */
+typedef struct {
+    /// 1 if min and max are known, 0 for other types and for float or number attributes holding NaN
+    int bounded;
+    /// number of values that are not null
+    int num_values;
+    /// number of null values, values with size 0 or less or of another type than the attribute
+    int null_count;
+    /// smallest value that is not null
+    double min;
+    /// largest value that is not null
+    double max;
+} AK_zone;
+
+/**
+ * @author Karlo Vuković
+ * @struct AK_zone_map
+ * @brief Structure that summarizes a block, so scans can skip blocks that can not hold a matching row without
+ *        reading them
+ */
+typedef struct {
+    /// number of row positions in the block, including deleted rows
+    int num_rows;
+    /// number of attributes in the header of the block
+    int num_attr;
+    /// zone of each attribute
+    AK_zone zone[MAX_ATTRIBUTES];
+} AK_zone_map;
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that checks if values of the type are summarized by min and max
+ * @param type data type
+ * @return 1 for int, date, datetime, time, interval, period, float and number, otherwise 0
+ */
+int AK_zone_map_supported(int type);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that computes the zone map of a block from its tuple dictionary and keeps it under the address of
+ *        the block. It is called by AK_write_block and AK_read_block, so blocks of an existing database get their
+ *        zone maps the first time they are read. AK_mem_block_modify forgets the zone map of a block changed in the
+ *        cache, and it is computed again when the block is written or checked by AK_zone_map_table_may_match.
+ * @param block block
+ * @return No return value
+ */
+void AK_zone_map_update(AK_block *block);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that forgets the zone map of a block, used when a block is written without AK_write_block
+ * @param address block address
+ * @return No return value
+ */
+void AK_zone_map_invalidate(int address);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that copies the zone map of a block
+ * @param address block address
+ * @param zone_map zone map to fill
+ * @return EXIT_SUCCESS if the zone map is known, EXIT_ERROR otherwise
+ */
+int AK_zone_map_get(int address, AK_zone_map *zone_map);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that checks if a block can hold a value of the attribute in the inclusive range [lower, upper].
+ *        Blocks without a known zone map always can.
+ * @param address block address
+ * @param attribute index of the attribute in the header
+ * @param lower lower bound, -INFINITY if there is none
+ * @param upper upper bound, INFINITY if there is none
+ * @param nulls_match 1 if rows with a null value have to be read anyway, otherwise 0
+ * @return 0 if the block can be skipped, otherwise 1
+ */
+int AK_zone_map_may_match(int address, int attribute, double lower, double upper, int nulls_match);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that checks a block against bounds of all attributes, like the ones from AK_zone_map_expr_bounds.
+ *        Empty blocks never match.
+ * @param address block address
+ * @param num_attr number of attributes
+ * @param lower lower bound of each attribute
+ * @param upper upper bound of each attribute
+ * @param nulls_match 1 if rows with a null value have to be read anyway, otherwise 0
+ * @return 0 if the block can be skipped, otherwise 1
+ */
+int AK_zone_map_may_match_bounds(int address, int num_attr, double *lower, double *upper, int nulls_match);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that finds bounds of attributes that every row satisfying the postfix expression has to be within.
+ *        The expression is followed with AK_expression_walk, and only comparisons of an attribute with a constant of
+ *        the same type, BETWEEN and AND give bounds. Strict comparisons give the inclusive bound.
+ * @param expr postfix expression, may be NULL
+ * @param header table header
+ * @param num_attr number of attributes
+ * @param lower lower bound of each attribute, -INFINITY if there is none
+ * @param upper upper bound of each attribute, INFINITY if there is none
+ * @return number of attributes with bounds
+ */
+int AK_zone_map_expr_bounds(struct list_node *expr, AK_header *header, int num_attr, double *lower, double *upper);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that checks if any block of the table can hold a value of the attribute in the inclusive range
+ *        [lower, upper], so callers of index range searches can tell that a range is empty without the index.
+ *        Blocks changed in the cache get their zone maps again from the cached block.
+ * @param tblName table name
+ * @param attribute attribute name
+ * @param lower lower bound
+ * @param upper upper bound
+ * @return 0 if no block of the table can hold such a value, otherwise 1
+ */
+int AK_zone_map_table_may_match(char *tblName, char *attribute, double lower, double upper);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that counts row positions of a table from the zone maps of its blocks, deleted rows included, so
+ *        it tells how many rows a scan of the table reads. Blocks without a zone map are read once to get one.
+ * @param tblName table name
+ * @return number of row positions of the table
+ */
+int AK_zone_map_table_rows(char *tblName);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function for testing zone maps
+ * @return TestResult
+ */
+TestResult AK_zone_map_test();
+
+#endif
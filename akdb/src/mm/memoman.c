@@ -23,14 +23,16 @@
 
 #include "memoman.h"
 #include "../dm/dbman.h"
+#include "../file/zonemap.h"
 
 PtrContainer db_cache;
 PtrContainer redo_log;
 PtrContainer query_mem;
 
 /**
-  * @author Nikola Bakoš, Matija Šestak(revised)
-  * @brief Function that caches a block into the memory.
+  * @author Nikola Bakoš, Matija Šestak(revised), updated by Karlo Vuković (zone maps)
+  * @brief Function that caches a block into the memory. The zone map of the block is refreshed from the block read
+  *        into the cache, so blocks of an existing database get their zone maps when they are first cached.
   * @param num block number (address)
   * @param mem_block address of memmory block
   * @return EXIT_SUCCESS if the block has been successfully read into memory, EXIT_ERROR otherwise
@@ -44,6 +46,7 @@ int AK_cache_block(int num, AK_mem_block *mem_block)
 	AK_PRO;
 	/// read the block from the given address
 	block_cache = AK_read_block(num);
+	AK_zone_map_update(block_cache);
 	block_cache_old = mem_block->block;
 	mem_block->block = block_cache;
 	mem_block->dirty = BLOCK_CLEAN; /// set dirty bit in mem_block struct
@@ -490,14 +493,17 @@ int AK_release_oldest_cache_block() {
 }
 
 /**
- * @author Alen Novosel.
- * @brief  Function that modifies the "dirty" bit of a block, and update the timestamps accordingly.
+ * @author Alen Novosel, updated by Karlo Vuković (zone maps)
+ * @brief  Function that modifies the "dirty" bit of a block, and update the timestamps accordingly. A block marked
+ *         as dirty loses its zone map, which is computed again when the block is written or checked.
  */
 int AK_mem_block_modify(AK_mem_block* mem_block, int dirty)
 {
 	unsigned long timestamp;
 	AK_PRO;
 	mem_block->dirty = dirty;
+	if (dirty == BLOCK_DIRTY)
+		AK_zone_map_invalidate(mem_block->block->address);
 
 	timestamp = clock();
 	mem_block->timestamp_last_change = timestamp;
@@ -772,8 +778,8 @@ int AK_find_AK_free_space(table_addresses * addresses)
 }
 
 /**
- * @author Nikola Bakoš, updated by Matija Šestak (function now uses caching), updated by Mislav Čakarić, updated by Dino Laktašić
- * @brief Function that extends the segment
+ * @author Nikola Bakoš, updated by Matija Šestak (function now uses caching), updated by Mislav Čakarić, updated by Dino Laktašić, updated by Karlo Vuković (wide tables)
+ * @brief Function that extends the segment. Blocks of the new extent get the header and the layout of the segment.
  * @param table_name name of segment to extent
  * @param extent_type type of extent (can be one of:
         SEGMENT_TYPE_SYSTEM_TABLE,
@@ -800,14 +806,9 @@ int AK_init_new_extent(char *table_name, int extent_type)
 	int end_address;
 	struct list_node *row_root;
 	int obj_id = 0;
+	int block_type = mem_block->block->type;
 
 
-	//!!! to correct header BUG iterate through header from 0 to N-th block while there is
-	//header attributes. Than create header and pass it to function for extent creation below.
-	//Current implementation works only with tables with max MAX_ATTRIBUTES.
-
-	// What header bug? This function is never invoked. 
-
 	int i = 0;
 	AK_PRO;
 
@@ -822,7 +823,28 @@ int AK_init_new_extent(char *table_name, int extent_type)
 
 	old_size++;
 
-	if ((start_address = AK_new_extent(1, old_size, extent_type, mem_block->block->header)) == EXIT_ERROR)
+	//header of a wide table continues in the blocks chained with the first one, the new extent needs all of it
+	AK_header *header = mem_block->block->header;
+	int num_parts = 0;
+	if (block_type == BLOCK_TYPE_WIDE)
+	{
+		AK_mem_block *part = mem_block;
+		for (num_parts = 1; part->block->chained_with != NOT_CHAINED; num_parts++)
+			part = AK_get_block(part->block->chained_with);
+		header = (AK_header *) AK_calloc(num_parts * MAX_ATTRIBUTES + 1, sizeof (AK_header));
+		part = mem_block;
+		for (i = 0; i < num_parts; i++)
+		{
+			memcpy(header + i * MAX_ATTRIBUTES, part->block->header, sizeof (AK_header) * MAX_ATTRIBUTES);
+			if (part->block->chained_with != NOT_CHAINED)
+				part = AK_get_block(part->block->chained_with);
+		}
+	}
+
+	start_address = AK_new_extent(1, old_size, extent_type, header);
+	if (header != mem_block->block->header)
+		AK_free(header);
+	if (start_address == EXIT_ERROR)
 	{
 		printf("AK_init_new_extent: Could not allocate the new extent\n");
 		AK_EPI;
@@ -853,6 +875,17 @@ int AK_init_new_extent(char *table_name, int extent_type)
 	end_address = start_address + (old_size + old_size * RESIZE_FACTOR);
 	//mem_block = (AK_mem_block *) AK_get_block(0);
 
+	//blocks of the new extent get the layout of the segment, wide blocks already got it from the header
+	if (block_type == BLOCK_TYPE_PAX)
+	{
+		for (i = start_address; i < end_address; i++)
+		{
+			mem_block = AK_get_block(i);
+			mem_block->block->type = BLOCK_TYPE_PAX;
+			AK_mem_block_modify(mem_block, BLOCK_DIRTY);
+		}
+	}
+
 	row_root = (struct list_node *) AK_malloc(sizeof (struct list_node));
 	AK_Init_L3(&row_root);
 	//DeleteAllElements(row_root);
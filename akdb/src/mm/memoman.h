@@ -190,8 +190,9 @@ int AK_find_available_result_block();
 unsigned long AK_generate_result_id(unsigned char *str);
 
 /**
-  * @author Nikola Bakoš, Matija Šestak(revised)
-  * @brief Function that caches a block into the memory.
+  * @author Nikola Bakoš, Matija Šestak(revised), updated by Karlo Vuković (zone maps)
+  * @brief Function that caches a block into the memory. The zone map of the block is refreshed from the block read
+  *        into the cache, so blocks of an existing database get their zone maps when they are first cached.
   * @param num block number (address)
   * @param mem_block address of memmory block
   * @return EXIT_SUCCESS if the block has been successfully read into memory, EXIT_ERROR otherwise
@@ -248,8 +249,9 @@ AK_mem_block *AK_get_block(int num);
  */
 int AK_release_oldest_cache_block();
 /**
- * @author Alen Novosel.
- * @brief  Function that modifies the "dirty" bit of a block, and update the timestamps accordingly.
+ * @author Alen Novosel, updated by Karlo Vuković (zone maps)
+ * @brief  Function that modifies the "dirty" bit of a block, and update the timestamps accordingly. A block marked
+ *         as dirty loses its zone map, which is computed again when the block is written or checked.
  */
 int AK_mem_block_modify(AK_mem_block* mem_block, int dirty);
 /**
@@ -293,6 +295,14 @@ table_addresses *AK_get_table_addresses(char *table);
  */
 table_addresses *AK_get_index_addresses(char * index);
 
+/**
+ * @author Matija Novak, updated by Matija Šestak, Mislav Čakarić, Antonio Martinović
+ * @brief Function that gets the address of a system table by name
+ * @param name of system table
+ * @return table address
+ */
+int AK_get_system_table_address(const char *name);
+
 /**
   * @author Matija Novak, updated by Matija Šestak( function now uses caching)
   * @brief Function that finds AK_free space in some block betwen block addresses. It's made for insert_row()
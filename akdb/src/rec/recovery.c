@@ -87,6 +87,14 @@
 void AK_recovery_insert_row(char* table, int commandNumber){
     AK_PRO;
     
+    AK_redo_log* const redoLog = redo_log.ptr;
+    if(redoLog->command_recovery[commandNumber].operation == BULK_INSERT){
+        printf("AK_recovery: bulk load of %s rows into %s did not finish, load the batch again\n",
+               redoLog->command_recovery[commandNumber].arguments[0], table);
+        AK_EPI;
+        return;
+    }
+
     printf("AK_recovery: found unfinished archived data commands for %s, executing...\n", table);
     int i;
 
@@ -114,7 +122,6 @@ void AK_recovery_insert_row(char* table, int commandNumber){
     int n = i;
     
     // insert data to table
-    AK_redo_log* const redoLog = redo_log.ptr;
     for(i=0;i<n;i++){
 	attributes[i]=redoLog->command_recovery[commandNumber].arguments[i];
     }
@@ -21,8 +21,8 @@
 #include "redo_log.h"
 
 /**
- * @author @author Krunoslav Bilić updated by Dražen Bandić, second update by Tomislav Turek
- * @brief Function that adds a new element to redolog
+ * @author @author Krunoslav Bilić updated by Dražen Bandić, second update by Tomislav Turek, updated by Karlo Vuković (rows of wide tables)
+ * @brief Function that adds a new element to redolog. Only the first MAX_ATTRIBUTES values of a row are kept in the entry.
  * @return EXIT_FAILURE if not allocated memory for ispis, otherwise EXIT_SUCCESS
  */
 int AK_add_to_redolog(int command, struct list_node *row_root){
@@ -40,12 +40,6 @@ int AK_add_to_redolog(int command, struct list_node *row_root){
     }
 
     struct list_node * el = (struct list_node *) AK_First_L2(row_root);
-    
-    char* record;
-    if((record = (char*) AK_calloc(MAX_VARCHAR_LENGTH, sizeof(char))) == NULL){
-        AK_EPI;
-    	return EXIT_FAILURE;
-    }
 
     char table[MAX_ATT_NAME];
     memset(table, '\0', MAX_ATT_NAME);
@@ -56,6 +50,12 @@ int AK_add_to_redolog(int command, struct list_node *row_root){
 	int attrs_length = MAX_ATTRIBUTES;
 	if(AK_Size_L2(row_root) > MAX_ATTRIBUTES)
 		attrs_length = AK_Size_L2(row_root);
+    //every value of the row and its separator fit into the record
+    char* record;
+    if((record = (char*) AK_calloc(attrs_length * (MAX_VARCHAR_LENGTH + 1) + 1, sizeof(char))) == NULL){
+        AK_EPI;
+    	return EXIT_FAILURE;
+    }
     char** attrs = AK_calloc(attrs_length, sizeof(char*));
     int i = 0;
     while (el != NULL) {
@@ -91,7 +91,8 @@ int AK_add_to_redolog(int command, struct list_node *row_root){
     
     printf("AK_add_to_redolog: redolog new entry -- %s, %s\n", table, record);
     memcpy(redoLog->command_recovery[n].table_name, table, strlen(table));
-	for(i=0; i<numAttr-1; i++)
+	//rows of wide tables have more values than an entry can hold
+	for(i=0; i<numAttr-1 && i<MAX_ATTRIBUTES; i++)
 		strcpy(redoLog->command_recovery[n].arguments[i], attrs[i]);
     redoLog->command_recovery[n].operation = command;
     redoLog->command_recovery[n].finished = 0;
@@ -105,6 +106,68 @@ int AK_add_to_redolog(int command, struct list_node *row_root){
     return EXIT_SUCCESS;
 }
 
+/**
+ * @author Karlo Vuković
+ * @brief Function that adds one entry for a whole batch of rows loaded by the bulk loader. Rows of the batch
+ *        are not copied into the log, only the table and the number of rows, so a batch costs one entry
+ *        instead of one entry per row. An unfinished batch can not be replayed and has to be loaded again.
+ * @param table name of the table the batch is loaded into
+ * @param num_rows number of rows in the batch
+ * @return EXIT_FAILURE if redolog is not allocated, otherwise EXIT_SUCCESS
+ */
+int AK_add_to_redolog_bulk(char *table, int num_rows){
+    AK_PRO;
+
+    AK_redo_log* const redoLog = redo_log.ptr;
+    if (redoLog == NULL){
+        AK_EPI;
+        return EXIT_FAILURE;
+    }
+    int n = redoLog->number;
+
+    if(n == MAX_REDO_LOG_ENTRIES){
+        AK_archive_log(-10);
+        n = 0;
+    }
+
+    memset(&redoLog->command_recovery[n], 0, sizeof(redoLog->command_recovery[n]));
+    strncpy(redoLog->command_recovery[n].table_name, table, MAX_VARCHAR_LENGTH - 1);
+    sprintf(redoLog->command_recovery[n].arguments[0], "%d", num_rows);
+    redoLog->command_recovery[n].operation = BULK_INSERT;
+    redoLog->command_recovery[n].finished = 0;
+    redoLog->number = n+1;
+    AK_EPI;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that removes the entry of a batch that was undone by the bulk loader. The last unfinished
+ *        entry of the batch is removed and the entries after it are moved one place down.
+ * @param table name of the table the batch was loaded into
+ * @return No return value
+ */
+void AK_redolog_remove_bulk(char *table){
+    int i, j;
+    AK_PRO;
+    AK_redo_log* const redoLog = redo_log.ptr;
+    if (redoLog == NULL){
+        AK_EPI;
+        return;
+    }
+
+    for(i = redoLog->number - 1; i >= 0; i--){
+        if(redoLog->command_recovery[i].operation == BULK_INSERT && !redoLog->command_recovery[i].finished
+           && strcmp(redoLog->command_recovery[i].table_name, table) == 0){
+            for(j = i; j < redoLog->number - 1; j++)
+                redoLog->command_recovery[j] = redoLog->command_recovery[j+1];
+            redoLog->number--;
+            break;
+        }
+    }
+    AK_EPI;
+}
+
 void AK_redolog_commit() {
     int i;
     AK_redo_log* const redoLog = redo_log.ptr;
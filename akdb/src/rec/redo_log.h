@@ -25,12 +25,29 @@
 
 
 /**
- * @author @author Krunoslav Bilić updated by Dražen Bandić, second update by Tomislav Turek
- * @brief Function that adds a new element to redolog
+ * @author @author Krunoslav Bilić updated by Dražen Bandić, second update by Tomislav Turek, updated by Karlo Vuković (rows of wide tables)
+ * @brief Function that adds a new element to redolog. Only the first MAX_ATTRIBUTES values of a row are kept in the entry.
  * @return EXIT_FAILURE if not allocated memory for ispis, otherwise EXIT_SUCCESS
  */
 int AK_add_to_redolog(int command, struct list_node *row_root);
 
+/**
+ * @author Karlo Vuković
+ * @brief Function that adds one entry for a whole batch of rows loaded by the bulk loader
+ * @param table name of the table the batch is loaded into
+ * @param num_rows number of rows in the batch
+ * @return EXIT_FAILURE if redolog is not allocated, otherwise EXIT_SUCCESS
+ */
+int AK_add_to_redolog_bulk(char *table, int num_rows);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that removes the entry of a batch that was undone by the bulk loader
+ * @param table name of the table the batch was loaded into
+ * @return No return value
+ */
+void AK_redolog_remove_bulk(char *table);
+
 /**
  * @author Danko Bukovac
  * @brief Function that adds a new select to redolog, commented code with the new select from select.c,
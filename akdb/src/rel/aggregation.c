@@ -131,6 +131,85 @@ void AK_agg_input_fix(AK_agg_input *input) {
     AK_EPI;
 }
 
+/**
+  @author Karlo Vuković
+  @brief  Function that aggregates one PAX block when there is no grouping. Values of each aggregated attribute
+          are read straight from its minipage, deleted rows and nulls are skipped.
+  @param  block PAX block
+  @param  layout layout of the block
+  @param  needed_values values that are being aggregated
+  @param  attr index of the attribute in the header for each aggregation, -1 if the header does not have it
+  @param  num_aggregations number of aggregations
+  @param  counter number of rows aggregated before this block
+  @param  seen flags of aggregations that already hold a value
+  @return number of rows of the block that were aggregated
+ */
+static int AK_agg_pax_block(AK_block *block, AK_pax_layout *layout, AK_agg_value *needed_values, int *attr, int num_aggregations, int counter, int *seen) {
+    int m, r, num_rows, live = 0, task, slot, n = layout->num_attr;
+    unsigned char *minipage;
+    int intacc, intvalue;
+    float floatacc, floatvalue;
+    double doubleacc, doublevalue;
+    AK_PRO;
+
+    num_rows = AK_pax_num_rows(block, n);
+    for (r = 0; r < num_rows; r++) {
+        if (block->tuple_dict[r * n].type != 0 || block->tuple_dict[r * n].size != 0)
+            live++;
+    }
+
+//folds the minipage of aggregation m into acc, values of other types than type_id are nulls or deleted rows
+#define AK_AGG_PAX_FOLD(ctype, type_id, acc, value) \
+    memcpy(&acc, needed_values[m].data, sizeof(ctype)); \
+    for (r = 0; r < num_rows; r++) { \
+        if (block->tuple_dict[r * n + attr[m]].type != type_id) \
+            continue; \
+        memcpy(&value, minipage + r * slot, sizeof(ctype)); \
+        if (task == AGG_TASK_SUM || task == AGG_TASK_AVG_SUM) \
+            acc += value; \
+        else if (!seen[m] || (task == AGG_TASK_MAX ? value > acc : value < acc)) \
+            acc = value; \
+        seen[m] = 1; \
+    } \
+    memcpy(needed_values[m].data, &acc, sizeof(ctype)); \
+    needed_values[m].data[sizeof(ctype)] = '\0';
+
+    for (m = 0; m < num_aggregations; m++) {
+        if (attr[m] < 0)
+            continue;
+
+        task = needed_values[m].agg_task;
+        if (task == AGG_TASK_COUNT || task == AGG_TASK_AVG_COUNT) {
+            *((int*) needed_values[m].data) = counter + live;
+            needed_values[m].data[sizeof(int)] = '\0';
+            continue;
+        }
+        if (task != AGG_TASK_SUM && task != AGG_TASK_AVG_SUM && task != AGG_TASK_MAX && task != AGG_TASK_MIN)
+            continue;
+
+        minipage = AK_pax_get_minipage(block, layout, attr[m], &num_rows);
+        if (minipage == NULL)
+            continue;
+        slot = layout->slot[attr[m]];
+
+        switch (layout->type[attr[m]]) {
+            case TYPE_INT:
+                AK_AGG_PAX_FOLD(int, TYPE_INT, intacc, intvalue);
+                break;
+            case TYPE_FLOAT:
+                AK_AGG_PAX_FOLD(float, TYPE_FLOAT, floatacc, floatvalue);
+                break;
+            case TYPE_NUMBER:
+                AK_AGG_PAX_FOLD(double, TYPE_NUMBER, doubleacc, doublevalue);
+                break;
+        }
+    }
+#undef AK_AGG_PAX_FOLD
+
+    AK_EPI;
+    return live;
+}
+
 /**
    @author Dejan Frankovic
    @brief Function that aggregates a given table by given attributes. Firstly, AGG_TASK_AVG_COUNT and
@@ -164,6 +243,8 @@ int AK_aggregation(AK_agg_input *input, char *source_table, char *agg_table) {
     char group_h_name[MAX_ATT_NAME];
 
     AK_agg_value *needed_values = AK_malloc(sizeof (AK_agg_value) * num_aggregations);
+    //sums are accumulated on top of the initial value
+    memset(needed_values, 0, sizeof (AK_agg_value) * num_aggregations);
 
     char new_table[MAX_ATT_NAME];
     sprintf(new_table, "_%s", agg_table);
@@ -248,6 +329,35 @@ int AK_aggregation(AK_agg_input *input, char *source_table, char *agg_table) {
 
 	rowroot_struct rowroot_table = {.row_root = (struct list_node*) AK_malloc(sizeof(struct list_node))};
 
+    //without grouping, tables with PAX blocks are aggregated one minipage at a time
+    AK_pax_layout pax_layout;
+    AK_header *source_header;
+    int pax_attr[MAX_ATTRIBUTES], pax_seen[MAX_ATTRIBUTES];
+    int pax_scan = 0;
+
+    if (agg_group_number == 0 && AK_get_storage_layout(source_table) == BLOCK_TYPE_PAX) {
+        source_header = AK_get_header(source_table);
+        pax_scan = AK_pax_get_layout(source_header, &pax_layout) > 0;
+        for (m = 0; m < num_aggregations; m++) {
+            pax_seen[m] = 0;
+            pax_attr[m] = -1;
+            for (l = 0; l < pax_layout.num_attr; l++) {
+                if (strcmp(needed_values[m].att_name, source_header[l].att_name) == 0) {
+                    pax_attr[m] = l;
+                    break;
+                }
+            }
+            if (pax_attr[m] == -1 || (needed_values[m].agg_task != AGG_TASK_SUM && needed_values[m].agg_task != AGG_TASK_AVG_SUM &&
+                needed_values[m].agg_task != AGG_TASK_MAX && needed_values[m].agg_task != AGG_TASK_MIN))
+                continue;
+            //minipages are read as the type of the result
+            if (source_header[l].type != agg_head[m].type ||
+                (agg_head[m].type != TYPE_INT && agg_head[m].type != TYPE_FLOAT && agg_head[m].type != TYPE_NUMBER))
+                pax_scan = 0;
+        }
+        AK_free(source_header);
+    }
+
     AK_Init_L3(&rowroot_table);
 
 
@@ -256,6 +366,13 @@ int AK_aggregation(AK_agg_input *input, char *source_table, char *agg_table) {
 
     while (addresses->address_from[ i ] != 0) {
         for (j = addresses->address_from[ i ]; j < addresses->address_to[ i ]; j++) {
+            if (pax_scan) {
+                temp = AK_get_block(j)->block;
+                if (temp->last_tuple_dict_id == 0)
+                    break;
+                counter += AK_agg_pax_block(temp, &pax_layout, needed_values, pax_attr, num_aggregations, counter, pax_seen);
+                continue;
+            }
             temp = (AK_block*) AK_read_block(j);
             if ( temp->last_tuple_dict_id == 0 )
             	break;
@@ -24,6 +24,7 @@
 #include "selection.h"
 #include "projection.h"
 #include "../file/filesearch.h"
+#include "../file/pax.h"
 #include "../auxi/mempro.h"
 #include "../sql/drop.h"
 
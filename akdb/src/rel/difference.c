@@ -53,12 +53,12 @@ void AK_difference_Print_By_Type(char* data, int address, int size, int type, AK
 }
 
 /**
- * @author Dino Laktašić; updated by Elena Kržina
+ * @author Dino Laktašić; updated by Elena Kržina; updated by Karlo Vuković (typed comparison, row set)
  * @brief  Function that produces a difference of two tables. Table addresses are gotten by providing names of the tables.
  *         Specifically start addresses are taken from them. They are used to allocate blocks for them. It is checked whether
            the tables have same table schemas. If not, it returns EXIT_ERROR. New segment for result of difference operation is
-           initialized. Function compares every block in extent of the first table with every block in extent of second table. If there 
-	   is a difference between their rows, they are put in dstTable.
+           initialized. Rows of the second table are put in a row set and every row of the first table that has no equal
+           row in the set is put in dstTable. Values are compared by their types straight in the blocks.
  * @param srcTable1 name of the first table
  * @param srcTable2 name of the second table
  * @param dstTable name of the new table
@@ -76,8 +76,8 @@ int AK_difference(char *srcTable1, char *srcTable2, char *dstTable) {
     if ((startAddress1 != 0) && (startAddress2 != 0)) {
 	
 		//for greater speed, integers are put into CPU registers
-        register int i, j, k, l, m, n, o;
-        i = j = k = l = 0;
+        register int i, j, m, o;
+        i = j = 0;
 
         AK_mem_block *tbl1_temp_block = (AK_mem_block *) AK_get_block(startAddress1);
         AK_mem_block *tbl2_temp_block = (AK_mem_block *) AK_get_block(startAddress2);
@@ -88,8 +88,6 @@ int AK_difference(char *srcTable1, char *srcTable2, char *dstTable) {
 
 			AK_free(src_addr1);
        		AK_free(src_addr2);
-			AK_free(tbl1_temp_block);
-			AK_free(tbl2_temp_block);
 			
 			AK_EPI;
 			return EXIT_ERROR;
@@ -97,11 +95,8 @@ int AK_difference(char *srcTable1, char *srcTable2, char *dstTable) {
 
 		//initializing variables for table difference
 		int address, type, size;
-		int different, num_rows, summ;
-		different = num_rows = summ = 0;
 		
         char data1[MAX_VARCHAR_LENGTH];
-		char data2[MAX_VARCHAR_LENGTH];
 
 		//initializing new segment
 		AK_header *header = (AK_header *) AK_malloc(num_att * sizeof (AK_header));
@@ -112,6 +107,9 @@ int AK_difference(char *srcTable1, char *srcTable2, char *dstTable) {
 		struct list_node *row_root = (struct list_node *) AK_malloc(sizeof(struct list_node));
 		memset(row_root, 0, sizeof(struct list_node));
 		AK_Init_L3(&row_root);
+
+		//TABLE2: all rows of table2 are hashed once
+		AK_row_set *rows2 = AK_row_set_build(srcTable2, num_att);
 		
 		//START ADDRESS: for each bit in the address
 		for (i = 0; src_addr1->address_from[i] != 0; i++) {
@@ -125,85 +123,40 @@ int AK_difference(char *srcTable1, char *srcTable2, char *dstTable) {
 
 				//if there is data in the block, continue
 				if (tbl1_temp_block->block->AK_free_space != 0) {
-							
-					//TABLE2: for each extent in table2
-						for (k = 0; k < (src_addr2->address_from[k] != 0); k++) {
-							startAddress2 = src_addr2->address_from[k];
-							
-							if (startAddress2 != 0) {
-								//BLOCK: for each block in table2 extent
-								for (l = startAddress2; l < src_addr2->address_to[k]; l++) {
-									tbl2_temp_block = (AK_mem_block *) AK_get_block(l);
-
-									//if there is data in the block, continue
-									if (tbl2_temp_block->block->AK_free_space != 0) {
-									
-									//check whether the next block is free for m and n
-									//TUPLE_DICTS: for each tuple_dict in the block
-										for (m = 0; m < DATA_BLOCK_SIZE; m += num_att) {
-											if (tbl1_temp_block->block->tuple_dict[m + 1].type == FREE_INT)
-												break;
-											
-										for (n = 0; n < DATA_BLOCK_SIZE; n += num_att) {
-											if (tbl2_temp_block->block->tuple_dict[n + 1].type == FREE_INT)
-													break;
-											
-											//for each element in row
-											for (o = 0; o < num_att; o++) {
-												address = tbl1_temp_block->block->tuple_dict[m + o].address;
-												size = tbl1_temp_block->block->tuple_dict[m + o].size;
-												type = tbl1_temp_block->block->tuple_dict[m + o].type;
-												AK_difference_Print_By_Type(data1,address, size, type, tbl1_temp_block);
-
-												address = tbl2_temp_block->block->tuple_dict[n + o].address;
-												size = tbl2_temp_block->block->tuple_dict[n + o].size;
-												type = tbl2_temp_block->block->tuple_dict[n + o].type;
-												AK_difference_Print_By_Type(data2,address, size, type, tbl2_temp_block);
-
-												//if they are the same
-												if(strcmp(data1,data2)==0){
-													different++;
-												}
-												if(different==(num_att-1)) 
-													summ=1;
-											}
-											
-											//if same rows are found don't keep searching
-												if(summ==1)
-													break;
-										}
-										//if there is a difference between tuple_dicts
-										if (summ == 0) {
-											AK_DeleteAll_L3(&row_root);	
-											for (o = 0; o < num_att; o++) {
-												address = tbl1_temp_block->block->tuple_dict[m + o].address;
-												size = tbl1_temp_block->block->tuple_dict[m + o].size;
-												type = tbl1_temp_block->block->tuple_dict[m + o].type;
-														
-												memset(data1, '\0', MAX_VARCHAR_LENGTH);
-												memcpy(data1, tbl1_temp_block->block->data + address, size);
-
-												AK_Insert_New_Element(type, data1, dstTable, tbl1_temp_block->block->header[o].att_name, row_root);
-											}
 
-											AK_insert_row(row_root);
-										}
-										num_rows = different = summ = 0;
-									}
-								}
+					//TUPLE_DICTS: for each tuple_dict in the block
+					for (m = 0; m + num_att <= DATA_BLOCK_SIZE; m += num_att) {
+						if (tbl1_temp_block->block->tuple_dict[m].type == FREE_INT)
+							break;
+						//deleted row
+						if (tbl1_temp_block->block->tuple_dict[m].size <= 0)
+							continue;
+
+						//if there is no equal row in table2
+						if (AK_row_set_find(rows2, tbl1_temp_block->block, m, -1) == -1) {
+							AK_DeleteAll_L3(&row_root);	
+							for (o = 0; o < num_att; o++) {
+								address = tbl1_temp_block->block->tuple_dict[m + o].address;
+								size = tbl1_temp_block->block->tuple_dict[m + o].size;
+								type = tbl1_temp_block->block->tuple_dict[m + o].type;
+										
+								memset(data1, '\0', MAX_VARCHAR_LENGTH);
+								memcpy(data1, tbl1_temp_block->block->data + address, size);
+
+								AK_Insert_New_Element(type, data1, dstTable, tbl1_temp_block->block->header[o].att_name, row_root);
 							}
-						} else break;
+
+							AK_insert_row(row_root);
+						}
 					}
 				}
 			}
 		}
 			
+		AK_row_set_free(rows2);
 		AK_free(src_addr1);
 		AK_free(src_addr2);
 		
-		AK_free(tbl1_temp_block);
-		AK_free(tbl2_temp_block);
-		
 		AK_DeleteAll_L3(&row_root);
 		AK_free(row_root);
 		AK_dbg_messg(LOW, REL_OP, "DIFFERENCE_TEST_SUCCESS\n\n");
@@ -211,7 +164,7 @@ int AK_difference(char *srcTable1, char *srcTable2, char *dstTable) {
 		
 		return EXIT_SUCCESS;
 	} 
-	
+
 	else {
 		AK_dbg_messg(LOW, REL_OP, "\nAK_difference: Table/s doesn't exist!");
 		
@@ -24,6 +24,7 @@
 #include "../file/fileio.h"
 #include "../auxi/mempro.h"
 #include "../sql/drop.h"
+#include "../auxi/compare.h"
 
 /**
  * @author Dino Laktašić
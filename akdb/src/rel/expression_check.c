@@ -849,7 +849,7 @@ void evaluate_similar_to_operator(struct list_node *a, struct list_node *b, stru
 
 	if(AK_check_regex_operator_expression(b->data,similar_regex)){
 		rs = AK_check_regex_expression(a->data,b->data,1,1);
-		AK_InsertAtEnd_L3(TYPE_INT, &true, sizeof (int), temp_result);
+		AK_InsertAtEnd_L3(TYPE_INT, rs ? &true : &false, sizeof (int), temp_result);
 	}else{
 		AK_InsertAtEnd_L3(TYPE_INT, &false, sizeof (int), temp_result);
 	}
@@ -1014,6 +1014,73 @@ int AK_check_if_row_satisfies_expression(struct list_node *row_root, struct list
     return result;
 }
 
+/**
+ * @author Karlo Vuković
+ * @brief Function that follows a postfix expression the way AK_check_if_row_satisfies_expression evaluates it and
+ *        collects facts that hold in every row satisfying it. Values and results are never taken off their lists,
+ *        operators use the last ones. Each operator gives one result: AND combines the last two results with the
+ *        combine callback of the walker, every other operator gets its result from the apply callback.
+ * @param expr postfix expression, may be NULL
+ * @param header table header
+ * @param num_attr number of attributes
+ * @param walker size of the facts of one result and the callbacks of their kind
+ * @param facts facts of the last result are copied here, it is left as it is if the expression has no operator
+ * @return 1 if the expression has a result, otherwise 0
+ */
+int AK_expression_walk(struct list_node *expr, AK_header *header, int num_attr, AK_expression_walker *walker,
+                       void *facts) {
+    struct list_node *el;
+    AK_expression_operand *operands;
+    char *results, *result;
+    int num_operands = 0, num_results = 0, size = 0;
+    int i;
+    AK_PRO;
+
+    if (expr == NULL) {
+        AK_EPI;
+        return 0;
+    }
+
+    for (el = (struct list_node *) AK_First_L2(expr); el != NULL; el = el->next)
+        size++;
+    operands = (AK_expression_operand *) AK_calloc(size + 1, sizeof (AK_expression_operand));
+    results = (char *) AK_calloc(size + 1, walker->result_size);
+
+    for (el = (struct list_node *) AK_First_L2(expr); el != NULL; el = el->next) {
+        if (el->type == TYPE_ATTRIBS) {
+            operands[num_operands].attribute = -1;
+            for (i = 0; i < num_attr; i++) {
+                if (strcmp(el->data, header[i].att_name) == 0) {
+                    operands[num_operands].attribute = i;
+                    break;
+                }
+            }
+            operands[num_operands++].el = el;
+        } else if (el->type != TYPE_OPERATOR) {
+            operands[num_operands].attribute = -1;
+            operands[num_operands++].el = el;
+        } else {
+            result = results + num_results * walker->result_size;
+            if (walker->init != NULL)
+                walker->init(result);
+            if (strcmp(el->data, "AND") == 0) {
+                if (num_results >= 2)
+                    walker->combine(result, result - 2 * walker->result_size, result - walker->result_size);
+            } else
+                walker->apply(el->data, operands, num_operands, header, result);
+            num_results++;
+        }
+    }
+
+    if (num_results > 0)
+        memcpy(facts, results + (num_results - 1) * walker->result_size, walker->result_size);
+
+    AK_free(operands);
+    AK_free(results);
+    AK_EPI;
+    return num_results > 0;
+}
+
 /**
  * @brief Function for testing expression checks.
  *
@@ -25,6 +25,34 @@
 #include "../file/fileio.h"
 #include "../auxi/mempro.h"
 #include <regex.h>
+/**
+ * @author Karlo Vuković
+ * @struct AK_expression_operand
+ * @brief Structure that describes an operand of a postfix expression followed by AK_expression_walk
+ */
+typedef struct {
+    /// element of the expression, an attribute name or a constant
+    struct list_node *el;
+    /// index of the attribute in the header, -1 for constants and unknown attributes
+    int attribute;
+} AK_expression_operand;
+
+/**
+ * @author Karlo Vuković
+ * @struct AK_expression_walker
+ * @brief Structure that describes one kind of facts collected by AK_expression_walk
+ */
+typedef struct {
+    /// number of bytes of the facts of one result
+    int result_size;
+    /// sets the facts of a new result, results are zeroed if it is NULL
+    void (*init)(void *result);
+    /// sets the facts of AND from the facts of its two operands
+    void (*combine)(void *result, void *first, void *second);
+    /// sets the facts of any other operator from the operands read so far, the last one is its right operand
+    void (*apply)(char *op, AK_expression_operand *operands, int num_operands, AK_header *header, void *result);
+} AK_expression_walker;
+
 /*
 int AK_check_arithmetic_statement(AK_list_elem el, const char *op, const char *a, const char *b);
 int AK_check_if_row_satisfies_expression(AK_list_elem row_root, AK_list *expr);
@@ -70,6 +98,20 @@ int AK_check_regex_expression(const char *value,const char *expression,int sensi
 			  1 if string matches coresponding regex expression
 */
 int AK_check_regex_operator_expression(const char *value,const char *expression);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that follows a postfix expression the way AK_check_if_row_satisfies_expression evaluates it and
+ *        collects facts that hold in every row satisfying it
+ * @param expr postfix expression, may be NULL
+ * @param header table header
+ * @param num_attr number of attributes
+ * @param walker size of the facts of one result and the callbacks of their kind
+ * @param facts facts of the last result are copied here, it is left as it is if the expression has no operator
+ * @return 1 if the expression has a result, otherwise 0
+ */
+int AK_expression_walk(struct list_node *expr, AK_header *header, int num_attr, AK_expression_walker *walker,
+                       void *facts);
 TestResult AK_expression_check_test();
 
 #endif /* CONSTRAINT_CHECKER_H_ */
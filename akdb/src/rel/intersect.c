@@ -21,9 +21,11 @@
 #include "intersect.h"
 
 /**
- * @author Dino Laktašić; updated by Elena Kržina
+ * @author Dino Laktašić; updated by Elena Kržina; updated by Karlo Vuković (typed comparison, row set)
  * @brief  Function that makes an intersect of two tables. Intersect is implemented for working with multiple sets of data, i.e. duplicate 
-          tuples can be written in same table (intersect)
+          tuples can be written in same table (intersect). Rows of the second table are put in a row set, so each row of the
+          first table is compared only with the rows that have the same hash, and values are compared by their types
+          straight in the blocks.
  * @param srcTable1 name of the first table
  * @param srcTable2 name of the second table
  * @param dstTable name of the new table
@@ -41,8 +43,8 @@ int AK_intersect(char *srcTable1, char *srcTable2, char *dstTable) {
     if ((startAddress1 != 0) && (startAddress2 != 0)) 
 	{
 		//register int used for faster processing
-        register int extend1, blockExtend1, extend2, blockExtend2;
-        extend1 = blockExtend1 = extend2 = blockExtend2 = 0;
+        register int extend1, blockExtend1;
+        extend1 = blockExtend1 = 0;
 
         AK_mem_block *tbl1_temp_block = (AK_mem_block *) AK_get_block(startAddress1);
         AK_mem_block *tbl2_temp_block = (AK_mem_block *) AK_get_block(startAddress2);
@@ -58,12 +60,10 @@ int AK_intersect(char *srcTable1, char *srcTable2, char *dstTable) {
 			return EXIT_ERROR;
 		}
 
-        int touple1, touple2, column;
-		int address, type, size,thesame;
-		thesame = 0;
+        int touple1, column, match;
+		int address, type, size;
 		
         char data1[MAX_VARCHAR_LENGTH];
-        char data2[MAX_VARCHAR_LENGTH];
 
         //initialize new segment
         AK_header *header = (AK_header *) AK_malloc(num_att * sizeof (AK_header));
@@ -74,6 +74,9 @@ int AK_intersect(char *srcTable1, char *srcTable2, char *dstTable) {
 		struct list_node *row_root = (struct list_node * ) AK_malloc(sizeof(struct list_node));
         AK_Init_L3(&row_root);
 
+        //TABLE2: all rows of table2 are hashed once
+        AK_row_set *rows2 = AK_row_set_build(srcTable2, num_att);
+
         //TABLE1: for each extent in table1
         for (extend1 = 0; src_addr1->address_from[extend1] != 0; extend1++) 
 		{
@@ -87,82 +90,40 @@ int AK_intersect(char *srcTable1, char *srcTable2, char *dstTable) {
                     //if there is data in the block
                     if (tbl1_temp_block->block->AK_free_space != 0) 
 					{
-
-                        //TABLE2: for each extent in table2
-                        for (extend2 = 0; extend2 < (src_addr2->address_from[extend2] != 0); extend2++) 
+                        //TUPLE_DICTS: for each tuple_dict in the block
+                        for (touple1 = 0; touple1 + num_att <= DATA_BLOCK_SIZE; touple1 += num_att) 
 						{
-                            startAddress2 = src_addr2->address_from[extend2];
-
-                            if (startAddress2 != 0) 
+                            if (tbl1_temp_block->block->tuple_dict[touple1].type == FREE_INT)
+                                break;
+                            //deleted row
+                            if (tbl1_temp_block->block->tuple_dict[touple1].size <= 0)
+                                continue;
+
+                            //one row of the result for each equal row of table2
+                            for (match = AK_row_set_find(rows2, tbl1_temp_block->block, touple1, -1); match != -1;
+                                 match = AK_row_set_find(rows2, tbl1_temp_block->block, touple1, match)) 
 							{
-                                //BLOCK: for each block in table2 extent
-                                for (blockExtend2 = startAddress2; blockExtend2 < src_addr2->address_to[extend2]; blockExtend2++) 
+                                for (column = 0; column < num_att; column++) 
 								{
-                                    tbl2_temp_block = (AK_mem_block *) AK_get_block(blockExtend2);
-
-                                    //if there is data in the block
-                                    if (tbl2_temp_block->block->AK_free_space != 0) 
-									{
-                                        //TUPLE_DICTS: for each tuple_dict in the block
-                                        for (touple1 = 0; touple1 < DATA_BLOCK_SIZE; touple1 += num_att) 
-										{
-                                            if (tbl1_temp_block->block->tuple_dict[touple1 + 1].type == FREE_INT)
-                                                break;
-
-                                            for (touple2 = 0; touple2 < DATA_BLOCK_SIZE; touple2 += num_att) 
-											{
-                                                if (tbl2_temp_block->block->tuple_dict[touple2 + 1].type == FREE_INT)
-                                                    break;
-
-                                                for (column = 0; column < num_att; column++) 
-												{
-                                                    type = tbl1_temp_block->block->tuple_dict[touple1 + column].type;
-                                                    size = tbl1_temp_block->block->tuple_dict[touple1 + column].size;
-                                                    address = tbl1_temp_block->block->tuple_dict[touple1 + column].address;
-													
-                                                    memcpy(data1, &(tbl1_temp_block->block->data[address]), size);
-                                                    data1[size] = '\0';
-
-                                                    type = tbl2_temp_block->block->tuple_dict[touple2 + column].type;
-                                                    size = tbl2_temp_block->block->tuple_dict[touple2 + column].size;
-                                                    address = tbl2_temp_block->block->tuple_dict[touple2 + column].address;
-													
-                                                    memcpy(data2, &(tbl2_temp_block->block->data[address]), size);
-                                                    data2[size] = '\0';
-
-                                                    //if two attributes are different, stop searching that row
-													if(strcmp(data1,data2)!=0)break;
-													else if(strcmp(data1, data2) == 0 && column ==(num_att-1)) thesame=1;
-                                                }
-
-                                                if (thesame == 1) 
-												{
-                                                    for (column = 0; column < num_att; column++) 
-													{
-                                                        type = tbl1_temp_block->block->tuple_dict[touple1 + column].type;
-                                                        size = tbl1_temp_block->block->tuple_dict[touple1 + column].size;
-                                                        address = tbl1_temp_block->block->tuple_dict[touple1 + column].address;
-														
-                                                        memcpy(data1, &(tbl1_temp_block->block->data[address]), size);
-                                                        data1[size] = '\0';
-														
-                                                        AK_Insert_New_Element(type, data1, dstTable, tbl1_temp_block->block->header[column].att_name, row_root);
-                                                    }
-                                                    AK_insert_row(row_root);
-
-                                                    AK_DeleteAll_L3(&row_root);
-                                                    thesame=0;
-                                                }
-                                            }
-                                        }
-                                    }
+                                    type = tbl1_temp_block->block->tuple_dict[touple1 + column].type;
+                                    size = tbl1_temp_block->block->tuple_dict[touple1 + column].size;
+                                    address = tbl1_temp_block->block->tuple_dict[touple1 + column].address;
+									
+                                    memcpy(data1, &(tbl1_temp_block->block->data[address]), size);
+                                    data1[size] = '\0';
+									
+                                    AK_Insert_New_Element(type, data1, dstTable, tbl1_temp_block->block->header[column].att_name, row_root);
                                 }
-                            } else break;
+                                AK_insert_row(row_root);
+
+                                AK_DeleteAll_L3(&row_root);
+                            }
                         }
                     }
                 }
         }
 
+        AK_row_set_free(rows2);
         AK_free(src_addr1);
         AK_free(src_addr2);
 		AK_free(row_root);
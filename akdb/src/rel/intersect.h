@@ -25,6 +25,7 @@
 #include "../rec/archive_log.h"
 #include "../auxi/mempro.h"
 #include "../sql/drop.h"
+#include "../auxi/compare.h"
 
 /**
  * @author Dino Laktašić
@@ -90,7 +90,7 @@ void AK_create_join_block_header(int table_address1, int table_address2, char *n
 }
 
 /**
- * @author Matija Novak, updated by Dino Laktašić
+ * @author Matija Novak, updated by Dino Laktašić, updated by Karlo Vuković (typed comparison)
  * @brief  Function that searches the second block and when found matches with the first one makes a join and writes a row to join the tables
  * @param row_root - list of values from the first table to be marged with table2
  * @param row_root_insert - list of values from the first table to be inserted into nat_join table
@@ -137,11 +137,9 @@ void AK_merge_block_join(struct list_node *row_root, struct list_node *row_root_
                 if ((strcmp(some_element->attribute_name, temp_block->header[head].att_name) == 0) && (size != 0)
                         && (overflow < (temp_block->AK_free_space + 1)) && (overflow > -1)) {
                     
-                    memset(data, '\0', MAX_VARCHAR_LENGTH);
-                    memcpy(data, temp_block->data + temp_block->tuple_dict[i].address, temp_block->tuple_dict[i].size);
-
                     //if merge data is not equal
-                    if (strcmp(some_element->data, data) != 0) {
+                    if (AK_compare_values(temp_block->tuple_dict[i].type, some_element->data, some_element->size,
+                                          (char *) temp_block->data + temp_block->tuple_dict[i].address, size) != 0) {
                         //dont copy these set of tuple_dicts
                         something_to_copy = 0;
 			break;
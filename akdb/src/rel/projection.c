@@ -18,6 +18,7 @@
  17 */
 
 #include "projection.h"
+#include "selection.h"
 
 /**
  * @author Matija Novak, rewritten and optimized by Dino Laktašić to support AK_list  
@@ -437,8 +438,10 @@ char *AK_perform_operation(char *op,struct AK_operand *firstOperand, struct AK_o
 }
 
 /**
- * @author Matija Novak, rewritten and optimized by Dino Laktašić, now support cacheing
- * @brief  Function that makes a projection of some table on given attributes
+ * @author Matija Novak, rewritten and optimized by Dino Laktašić, now support cacheing, updated by Karlo Vuković
+ *         (index-only scans)
+ * @brief  Function that makes a projection of some table on given attributes. A projection with an expression is
+ *         answered from a covering B+tree index with AK_selection_index_only when there is one.
  * @param srcTable source table - table on which projection is made
  * @param expr given expression to check while doing projection
  * @param att list of atributes on which we make projection
@@ -451,6 +454,10 @@ int AK_projection(char *srcTable, char *dstTable, struct list_node *att, struct
 
     //geting the table addresses from table on which we make projection
     AK_PRO;
+    if (expr != NULL && AK_selection_index_only(srcTable, dstTable, att, expr) == EXIT_SUCCESS) {
+        AK_EPI;
+        return EXIT_SUCCESS;
+    }
     table_addresses *src_addr = (table_addresses *) AK_get_table_addresses(srcTable);
 
     if (src_addr->address_from[0] != 0) {
@@ -116,8 +116,10 @@ char *AK_perform_operation(char *op,struct AK_operand *firstOperand, struct AK_o
 
 
 /**
- * @author Matija Novak, rewritten and optimized by Dino Laktašić, now support cacheing
- * @brief  Function that makes a projection of some table on given attributes
+ * @author Matija Novak, rewritten and optimized by Dino Laktašić, now support cacheing, updated by Karlo Vuković
+ *         (index-only scans)
+ * @brief  Function that makes a projection of some table on given attributes. A projection with an expression is
+ *         answered from a covering B+tree index with AK_selection_index_only when there is one.
  * @param srcTable source table - table on which projection is made
  * @param expr given expression to check while doing projection
  * @param att list of atributes on which we make projection
@@ -19,10 +19,497 @@
 
 #include "selection.h"
 #include "aggregation.h"
+#include "projection.h"
+#include "../file/zonemap.h"
+#include "../file/idx/bloom.h"
+#include "../file/idx/btree.h"
+#include "../file/idx/hash.h"
+#include "../file/idx/bitmap.h"
+#include "../file/idx/trigram.h"
+#include "../file/bulk.h"
+#include <limits.h>
+#include <math.h>
 
 /**
- * @author Matija Šestak, updated by Elena Kržina
- * @brief  Function that which implements selection
+ * @author Karlo Vuković
+ * @brief Function that returns the size of a constant of the expression as values are stored in tables, varchar
+ *        constants are stored without the null character at their end
+ * @param key constant
+ * @return size of the constant
+ */
+static int AK_selection_key_size(struct list_node *key) {
+    return key->type == TYPE_VARCHAR ? (int) strnlen(key->data, key->size) : key->size;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that finds the rows with constants of the expression in the bitmap indices of the table. Bitmaps
+ *        of all attributes with a constant are combined with AND, so the rows satisfy all of them.
+ * @param srcTable table name
+ * @param indexes indices of the table
+ * @param num_indexes number of indices
+ * @param keys constant of each attribute, NULL if there is none
+ * @param cap largest number of rows that is worth reading through the index
+ * @param rows addresses of the rows
+ * @param name name of the first index that was used
+ * @return number of rows, -1 if no index can be used or the rows are more than cap
+ */
+static int AK_selection_bitmap_rows(char *srcTable, AK_index_description *indexes, int num_indexes,
+                                    struct list_node **keys, int cap, struct_add **rows, char *name) {
+    AK_bitmap combined, bitmap, result;
+    struct list_node *key;
+    int i, count, used = 0;
+
+    for (i = 0; i < num_indexes; i++) {
+        key = keys[indexes[i].attribute[0]];
+        if (indexes[i].kind != BLOCK_TYPE_BITMAP || key == NULL)
+            continue;
+        AK_bitmap_get(indexes[i].name, key->type, key->data, AK_selection_key_size(key), &bitmap);
+        if (used++ == 0) {
+            combined = bitmap;
+            strcpy(name, indexes[i].name);
+            continue;
+        }
+        AK_bitmap_and(&combined, &bitmap, &result);
+        AK_bitmap_free(&combined);
+        AK_bitmap_free(&bitmap);
+        combined = result;
+    }
+    if (used == 0)
+        return -1;
+    count = AK_bitmap_count(&combined);
+    if (count <= cap) {
+        *rows = (struct_add *) AK_malloc((count > 0 ? count : 1) * sizeof (struct_add));
+        count = AK_bitmap_to_rids(srcTable, &combined, *rows, count);
+    } else
+        count = -1;
+    AK_bitmap_free(&combined);
+    return count;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that finds the candidate rows of the pattern of an attribute in a trigram index. Candidates have
+ *        all trigrams of the pattern, and the expression is checked on each of them when they are read.
+ * @param srcTable table name
+ * @param index trigram index
+ * @param patterns pattern of each attribute, NULL if there is none
+ * @param wildcards 1 for each attribute whose pattern has SQL wildcards
+ * @param cap largest number of rows that is worth reading through the index
+ * @param rows addresses of the rows
+ * @return number of rows, -1 if the index can not be used or the rows are more than cap
+ */
+static int AK_selection_trigram_rows(char *srcTable, AK_index_description *index, struct list_node **patterns,
+                                     int *wildcards, int cap, struct_add **rows) {
+    struct list_node *pattern = patterns[index->attribute[0]];
+    AK_bitmap bitmap;
+    int count = -1;
+
+    if (pattern == NULL)
+        return -1;
+    if (AK_trigram_candidates(index->name, pattern->data, wildcards[index->attribute[0]], &bitmap) > 0 &&
+        (count = AK_bitmap_count(&bitmap)) <= cap) {
+        *rows = (struct_add *) AK_malloc((count > 0 ? count : 1) * sizeof (struct_add));
+        count = AK_bitmap_to_rids(srcTable, &bitmap, *rows, count);
+    } else
+        count = -1;
+    AK_bitmap_free(&bitmap);
+    return count;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that finds the rows with constants of the expression in a hash index. The index can be used when
+ *        all of its attributes have a constant.
+ * @param index hash index
+ * @param keys constant of each attribute, NULL if there is none
+ * @param cap largest number of rows that is worth reading through the index
+ * @param rows addresses of the rows
+ * @return number of rows, -1 if the index can not be used or the rows are more than cap
+ */
+static int AK_selection_hash_rows(AK_index_description *index, struct list_node **keys, int cap, struct_add **rows) {
+    struct list_node *values, *key;
+    int i, count;
+
+    for (i = 0; i < index->num_attr && keys[index->attribute[i]] != NULL; i++)
+        ;
+    if (i < index->num_attr)
+        return -1;
+    values = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    AK_Init_L3(&values);
+    for (i = 0; i < index->num_attr; i++) {
+        key = keys[index->attribute[i]];
+        AK_InsertAtEnd_L3(key->type, key->data, AK_selection_key_size(key), values);
+    }
+    *rows = (struct_add *) AK_malloc((cap + 1) * sizeof (struct_add));
+    count = AK_search_hash_index(index->name, values, *rows, cap + 1);
+    AK_DeleteAll_L3(&values);
+    AK_free(values);
+    if (count < 0 || count > cap) {
+        AK_free(*rows);
+        return -1;
+    }
+    return count;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that turns a bound of the expression into a key of a B+tree index. Bounds are widened to the
+ *        nearest key, the expression is checked on every row anyway.
+ * @param type type of the attribute
+ * @param bound bound
+ * @param upper 1 for an upper bound, 0 for a lower one
+ * @param key key
+ * @return size of the key, 0 if the bound does not limit the keys, -1 if no key is within it
+ */
+static int AK_selection_btree_bound(int type, double bound, int upper, char *key) {
+    int integer;
+    float real;
+
+    if (isinf(bound))
+        return 0;
+    switch (type) {
+        case TYPE_INT:
+            if (bound > INT_MAX)
+                return upper ? 0 : -1;
+            if (bound < INT_MIN)
+                return upper ? -1 : 0;
+            integer = (int) bound;
+            if (upper && integer > bound)
+                integer--;
+            else if (!upper && integer < bound)
+                integer++;
+            memcpy(key, &integer, sizeof (int));
+            return sizeof (int);
+        case TYPE_FLOAT:
+            //the nearest float, no float lies between it and the bound
+            real = (float) bound;
+            memcpy(key, &real, sizeof (float));
+            return sizeof (float);
+        case TYPE_NUMBER:
+            memcpy(key, &bound, sizeof (double));
+            return sizeof (double);
+        default:
+            return 0;
+    }
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that makes the bounds of a B+tree index on several attributes from the expression. The bounds are
+ *        prefixes of its key, with the constants of its first attributes, followed by the bounds of the attribute
+ *        after them.
+ * @param index B+tree index on several attributes
+ * @param header table header
+ * @param keys constant of each attribute, NULL if there is none
+ * @param lower lower bound of each attribute
+ * @param upper upper bound of each attribute
+ * @param low lower bound of the keys
+ * @param low_size size of the lower bound, 0 if it does not limit the keys, -1 if no key is within it
+ * @param high upper bound of the keys
+ * @param high_size size of the upper bound, 0 if it does not limit the keys, -1 if no key is within it
+ * @return EXIT_SUCCESS, EXIT_ERROR if the bounds do not fit into a key
+ */
+static int AK_selection_btree_prefix(AK_index_description *index, AK_header *header, struct list_node **keys,
+                                     double *lower, double *upper, char *low, int *low_size, char *high,
+                                     int *high_size) {
+    struct list_node *low_values, *high_values;
+    char bound[sizeof (double)];
+    int i, a, size, result = EXIT_SUCCESS;
+
+    low_values = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    high_values = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    AK_Init_L3(&low_values);
+    AK_Init_L3(&high_values);
+    *low_size = 0;
+    *high_size = 0;
+    for (i = 0; i < index->num_attr && keys[index->attribute[i]] != NULL; i++) {
+        a = index->attribute[i];
+        AK_InsertAtEnd_L3(keys[a]->type, keys[a]->data, keys[a]->size, low_values);
+        AK_InsertAtEnd_L3(keys[a]->type, keys[a]->data, keys[a]->size, high_values);
+    }
+    if (i < index->num_attr) {
+        a = index->attribute[i];
+        size = AK_selection_btree_bound(header[a].type, lower[a], 0, bound);
+        if (size > 0)
+            AK_InsertAtEnd_L3(header[a].type, bound, size, low_values);
+        *low_size = size < 0 ? -1 : 0;
+        size = AK_selection_btree_bound(header[a].type, upper[a], 1, bound);
+        if (size > 0)
+            AK_InsertAtEnd_L3(header[a].type, bound, size, high_values);
+        *high_size = size < 0 ? -1 : 0;
+    }
+    if (*low_size == 0 && AK_First_L2(low_values) != NULL) {
+        *low_size = AK_btree_make_key(low_values, low);
+        result = *low_size == EXIT_ERROR ? EXIT_ERROR : result;
+    }
+    if (*high_size == 0 && AK_First_L2(high_values) != NULL) {
+        *high_size = AK_btree_make_key(high_values, high);
+        result = *high_size == EXIT_ERROR ? EXIT_ERROR : result;
+    }
+    AK_DeleteAll_L3(&low_values);
+    AK_DeleteAll_L3(&high_values);
+    AK_free(low_values);
+    AK_free(high_values);
+    return result;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that opens a cursor of a B+tree index over the keys with the constants or in the bounds of the
+ *        expression. An index on several attributes is limited by the constants of its first attributes and the
+ *        bounds of the attribute after them.
+ * @param index B+tree index
+ * @param header table header
+ * @param keys constant of each attribute, NULL if there is none
+ * @param lower lower bound of each attribute
+ * @param upper upper bound of each attribute
+ * @param cursor cursor
+ * @return 1 if the cursor is open, 0 if no key is within the bounds, -1 if the expression does not limit the keys
+ */
+static int AK_selection_btree_cursor(AK_index_description *index, AK_header *header, struct list_node **keys,
+                                     double *lower, double *upper, AK_btree_cursor *cursor) {
+    char low[MAX_VARCHAR_LENGTH], high[MAX_VARCHAR_LENGTH];
+    int a = index->attribute[0], low_size, high_size;
+
+    if (index->num_attr > 1) {
+        if (AK_selection_btree_prefix(index, header, keys, lower, upper, low, &low_size, high, &high_size) ==
+            EXIT_ERROR)
+            return -1;
+    } else if (keys[a] != NULL) {
+        low_size = high_size = AK_selection_key_size(keys[a]);
+        memcpy(low, keys[a]->data, low_size);
+        memcpy(high, keys[a]->data, high_size);
+    } else {
+        low_size = AK_selection_btree_bound(header[a].type, lower[a], 0, low);
+        high_size = AK_selection_btree_bound(header[a].type, upper[a], 1, high);
+    }
+    if (low_size == 0 && high_size == 0)
+        return -1;
+    //a bound no key can reach leaves no rows
+    if (low_size < 0 || high_size < 0)
+        return 0;
+    if (AK_btree_cursor_open(cursor, index->name) == EXIT_ERROR)
+        return -1;
+    AK_btree_cursor_range(cursor, low_size > 0 ? low : NULL, low_size, 1, high_size > 0 ? high : NULL, high_size, 1);
+    return 1;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that finds the rows with a constant or in the bounds of the expression in a B+tree index. A
+ *        cursor over the bounds stops as soon as it finds more rows than cap.
+ * @param index B+tree index
+ * @param header table header
+ * @param keys constant of each attribute, NULL if there is none
+ * @param lower lower bound of each attribute
+ * @param upper upper bound of each attribute
+ * @param cap largest number of rows that is worth reading through the index
+ * @param rows addresses of the rows
+ * @return number of rows, -1 if the index can not be used or the rows are more than cap
+ */
+static int AK_selection_btree_rows(AK_index_description *index, AK_header *header, struct list_node **keys,
+                                   double *lower, double *upper, int cap, struct_add **rows) {
+    AK_btree_cursor cursor;
+    AK_btree_rid *rids;
+    int i, count = 0, open;
+
+    rids = (AK_btree_rid *) AK_malloc((cap + 1) * sizeof (AK_btree_rid));
+    open = AK_selection_btree_cursor(index, header, keys, lower, upper, &cursor);
+    if (open < 0)
+        count = -1;
+    else if (open > 0) {
+        while (count <= cap && AK_btree_cursor_next(&cursor, &rids[count]) == EXIT_SUCCESS)
+            count++;
+        AK_btree_cursor_close(&cursor);
+    }
+    if (count < 0 || count > cap) {
+        AK_free(rids);
+        return -1;
+    }
+    *rows = (struct_add *) AK_malloc((count > 0 ? count : 1) * sizeof (struct_add));
+    for (i = 0; i < count; i++) {
+        (*rows)[i].addBlock = rids[i].block;
+        (*rows)[i].indexTd = rids[i].tuple;
+    }
+    AK_free(rids);
+    return count;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that compares positions of rows in a table
+ * @param first first position
+ * @param second second position
+ * @return negative, zero or positive, like strcmp
+ */
+static int AK_selection_compare_positions(const void *first, const void *second) {
+    int a = *(const int *) first, b = *(const int *) second;
+
+    return (a > b) - (a < b);
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that puts rows found with an index in the order of the table, the order in which a full scan reads
+ *        them, and leaves out repeated rows and rows that are not in the table
+ * @param srcTable table name
+ * @param rows addresses of the rows
+ * @param num_rows number of rows
+ * @return number of rows that are left
+ */
+static int AK_selection_order_rows(char *srcTable, struct_add *rows, int num_rows) {
+    table_addresses *addresses = AK_get_table_addresses(srcTable);
+    int *positions = (int *) AK_malloc((num_rows > 0 ? num_rows : 1) * sizeof (int));
+    int i, j, number, count = 0;
+
+    for (i = 0; i < num_rows; i++) {
+        for (j = 0, number = 0; j < MAX_EXTENTS_IN_SEGMENT && addresses->address_from[j] != 0; j++) {
+            if (rows[i].addBlock >= addresses->address_from[j] && rows[i].addBlock < addresses->address_to[j])
+                break;
+            number += addresses->address_to[j] - addresses->address_from[j];
+        }
+        if (j < MAX_EXTENTS_IN_SEGMENT && addresses->address_from[j] != 0 && rows[i].indexTd >= 0 &&
+            rows[i].indexTd < DATA_BLOCK_SIZE)
+            positions[count++] = (number + rows[i].addBlock - addresses->address_from[j]) * DATA_BLOCK_SIZE + rows[i].indexTd;
+    }
+    qsort(positions, count, sizeof (int), AK_selection_compare_positions);
+
+    for (i = 0, num_rows = 0; i < count; i++) {
+        if (i > 0 && positions[i] == positions[i - 1])
+            continue;
+        number = positions[i] / DATA_BLOCK_SIZE;
+        for (j = 0; number >= addresses->address_to[j] - addresses->address_from[j]; j++)
+            number -= addresses->address_to[j] - addresses->address_from[j];
+        rows[num_rows].addBlock = addresses->address_from[j] + number;
+        rows[num_rows++].indexTd = positions[i] % DATA_BLOCK_SIZE;
+    }
+    AK_free(positions);
+    AK_free(addresses);
+    return num_rows;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that chooses how AK_selection reads the source table. Equalities of attributes with constants and
+ *        bounds of attributes joined with AND are looked up in the B+tree, hash and bitmap indices of the table,
+ *        patterns of LIKE, ILIKE, SIMILAR TO and regular expressions in its trigram indices, and the index that
+ *        finds the fewest rows is used if they are at most INDEX_SCAN_SELECTIVITY of the rows of the table, as
+ *        AK_zone_map_table_rows counts them. Otherwise the table is scanned, and so are tables with the PAX layout,
+ *        which have no indices.
+ * @param srcTable source table name
+ * @param expr list with postfix notation of the logical expression
+ * @param path access path, the caller frees its rows
+ * @return EXIT_SUCCESS, EXIT_ERROR if the table does not exist
+ */
+int AK_selection_choose_path(char *srcTable, struct list_node *expr, AK_selection_path *path) {
+    AK_index_description indexes[INDEX_MAX_PER_TABLE];
+    AK_header *header;
+    struct list_node *keys[MAX_ATTRIBUTES], *patterns[MAX_ATTRIBUTES];
+    double lower[MAX_ATTRIBUTES], upper[MAX_ATTRIBUTES];
+    int wildcards[MAX_ATTRIBUTES];
+    struct_add *rows;
+    char name[MAX_ATT_NAME];
+    int i, count, num_indexes, num_attr, cap = 0, kind = BLOCK_TYPE_NORMAL;
+    AK_PRO;
+
+    memset(path, 0, sizeof (AK_selection_path));
+    path->kind = BLOCK_TYPE_NORMAL;
+    num_attr = AK_num_attr(srcTable);
+    if (num_attr <= 0) {
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    num_indexes = AK_index_get_descriptions(srcTable, indexes, INDEX_MAX_PER_TABLE);
+    if (num_indexes == 0 || expr == NULL || AK_get_storage_layout(srcTable) != BLOCK_TYPE_NORMAL) {
+        AK_EPI;
+        return EXIT_SUCCESS;
+    }
+
+    header = (AK_header *) AK_get_header(srcTable);
+    AK_bloom_filter_expr_keys(expr, header, num_attr, keys);
+    AK_zone_map_expr_bounds(expr, header, num_attr, lower, upper);
+    AK_trigram_expr_patterns(expr, header, num_attr, patterns, wildcards);
+    //indices do not hold rows with nulls, so rows a scan would read are counted in the table
+    cap = (int) (INDEX_SCAN_SELECTIVITY * AK_zone_map_table_rows(srcTable));
+    cap = cap > 0 ? cap : 1;
+
+    count = AK_selection_bitmap_rows(srcTable, indexes, num_indexes, keys, cap, &rows, name);
+    if (count >= 0) {
+        path->rows = rows;
+        path->num_rows = count;
+        kind = BLOCK_TYPE_BITMAP;
+        strcpy(path->index, name);
+        cap = count;
+    }
+    //the next index is used only if it finds fewer rows
+    for (i = 0; i < num_indexes && cap > 0; i++) {
+        if (indexes[i].kind == BLOCK_TYPE_HASH)
+            count = AK_selection_hash_rows(&indexes[i], keys, kind == BLOCK_TYPE_NORMAL ? cap : cap - 1, &rows);
+        else if (indexes[i].kind == BLOCK_TYPE_BTREE)
+            count = AK_selection_btree_rows(&indexes[i], header, keys, lower, upper,
+                                            kind == BLOCK_TYPE_NORMAL ? cap : cap - 1, &rows);
+        else if (indexes[i].kind == BLOCK_TYPE_TRIGRAM)
+            count = AK_selection_trigram_rows(srcTable, &indexes[i], patterns, wildcards,
+                                              kind == BLOCK_TYPE_NORMAL ? cap : cap - 1, &rows);
+        else
+            continue;
+        if (count < 0)
+            continue;
+        if (path->rows != NULL)
+            AK_free(path->rows);
+        path->rows = rows;
+        path->num_rows = count;
+        kind = indexes[i].kind;
+        strcpy(path->index, indexes[i].name);
+        cap = count;
+    }
+    path->kind = kind;
+    if (kind != BLOCK_TYPE_NORMAL)
+        path->num_rows = AK_selection_order_rows(srcTable, path->rows, path->num_rows);
+
+    AK_free(header);
+    AK_EPI;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that copies a row of the source table into the destination table if it satisfies the expression
+ * @param block block of the source table
+ * @param row first entry of the row in the tuple dictionary
+ * @param num_attr number of attributes
+ * @param header table header
+ * @param dstTable destination table name
+ * @param row_root empty list for the row
+ * @param expr list with postfix notation of the logical expression
+ * @return No return value
+ */
+static void AK_selection_row(AK_block *block, int row, int num_attr, AK_header *header, char *dstTable,
+                             struct list_node *row_root, struct list_node *expr) {
+    char data[MAX_VARCHAR_LENGTH];
+    int l, type, size, address;
+
+    for (l = 0; l < num_attr; l++) {
+        type = block->tuple_dict[row + l].type;
+        size = block->tuple_dict[row + l].size;
+        address = block->tuple_dict[row + l].address;
+        memcpy(data, &(block->data[address]), size);
+        data[size] = '\0';
+        AK_Insert_New_Element(type, data, dstTable, header[l].att_name, row_root);
+    }
+    if (AK_check_if_row_satisfies_expression(row_root, expr)) {
+        AK_insert_row(row_root);
+    }
+    AK_DeleteAll_L3(&row_root);
+}
+
+/**
+ * @author Matija Šestak, updated by Elena Kržina, updated by Karlo Vuković (zone maps, Bloom filters, indices)
+ * @brief  Function that which implements selection. If AK_selection_choose_path finds an index that narrows the
+ *         expression down to few rows, only those rows are read. Otherwise blocks that are empty or whose zone maps
+ *         show that no row can satisfy the bounds implied by the expression are not read, and neither are extents
+ *         whose Bloom filters show that they do not hold a value the expression requires.
  * @param *srcTable source table name
  * @param *dstTable destination table name
  * @param *expr list with posfix notation of the logical expression
@@ -52,31 +539,51 @@
 	struct list_node * row_root = (struct list_node *) AK_malloc(sizeof(struct list_node));
 	AK_Init_L3(&row_root);
 		
-	int type, size, address;
-	char data[MAX_VARCHAR_LENGTH];
+	double lower[MAX_ATTRIBUTES], upper[MAX_ATTRIBUTES];
+	struct list_node *keys[MAX_ATTRIBUTES];
+	int num_keys, a, r;
+	AK_selection_path path;
+
+	AK_selection_choose_path(srcTable, expr, &path);
+	if (path.kind != BLOCK_TYPE_NORMAL) {
+		AK_dbg_messg(LOW, REL_OP, "\nSelection reads %d rows of %s through index %s.\n", path.num_rows, srcTable, path.index);
+		//rows come in the order of the table, the block is fetched again because inserts can take its place in the cache
+		for (r = 0; r < path.num_rows; r++) {
+			AK_mem_block *temp = (AK_mem_block *) AK_get_block(path.rows[r].addBlock);
+			if (path.rows[r].indexTd + num_attr <= DATA_BLOCK_SIZE && temp->block->tuple_dict[path.rows[r].indexTd].type != FREE_INT)
+				AK_selection_row(temp->block, path.rows[r].indexTd, num_attr, t_header, dstTable, row_root, expr);
+		}
+		AK_free(path.rows);
+	} else {
+		AK_zone_map_expr_bounds(expr, t_header, num_attr, lower, upper);
+		num_keys = AK_bloom_filter_expr_keys(expr, t_header, num_attr, keys);
+		for (a = 0; a < num_attr && num_keys > 0; a++)
+			if (keys[a] != NULL && !AK_bloom_filter_exists(srcTable, t_header[a].att_name))
+				keys[a] = NULL;
+
+		/* code steps through all addresses of table, gets the block of each current address, counts the number of attributes, 
+		fetches values for each attribute and inserts data into the destination table if row satisfies given expression */ 
+		for (int i = 0; src_addr->address_from[i] != 0; i++) {
+
+				//an extent without a required value has no rows for the destination table
+				for (a = 0; a < num_attr && num_keys > 0; a++)
+					if (keys[a] != NULL && !AK_bloom_filter_may_contain(srcTable, t_header[a].att_name, i, keys[a]->type, keys[a]->data, keys[a]->size))
+						break;
+				if (a < num_attr && num_keys > 0)
+					continue;
 
-	/* code steps through all addresses of table, gets the block of each current address, counts the number of attributes, 
-	fetches values for each attribute and inserts data into the destination table if row satisfies given expression */ 
-	for (int i = 0; src_addr->address_from[i] != 0; i++) {
+			for (int j = src_addr->address_from[i]; j < src_addr->address_to[i]; j++) {
 
-		for (int j = src_addr->address_from[i]; j < src_addr->address_to[i]; j++) {
+				//rows with nulls are still read, the expression decides about them
+				if (!AK_zone_map_may_match_bounds(j, num_attr, lower, upper, 1))
+					continue;
 
-			AK_mem_block *temp = (AK_mem_block *) AK_get_block(j);
+				AK_mem_block *temp = (AK_mem_block *) AK_get_block(j);
 
-			if (temp->block->last_tuple_dict_id != 0){
-				for (int k = 0; k < DATA_BLOCK_SIZE && !(temp->block->tuple_dict[k].type == FREE_INT); k += num_attr) {
-					for (int l = 0; l < num_attr; l++) {
-						type = temp->block->tuple_dict[k + l].type;
-						size = temp->block->tuple_dict[k + l].size;
-						address = temp->block->tuple_dict[k + l].address;
-						memcpy(data, &(temp->block->data[address]), size);
-						data[size] = '\0';
-						AK_Insert_New_Element(type, data, dstTable, t_header[l].att_name, row_root);
-					}
-					if (AK_check_if_row_satisfies_expression(row_root, expr)){
-						AK_insert_row(row_root);
+				if (temp->block->last_tuple_dict_id != 0){
+					for (int k = 0; k < DATA_BLOCK_SIZE && !(temp->block->tuple_dict[k].type == FREE_INT); k += num_attr) {
+						AK_selection_row(temp->block, k, num_attr, t_header, dstTable, row_root, expr);
 					}
-					AK_DeleteAll_L3(&row_root);
 				}
 			}
 		}
@@ -93,12 +600,184 @@
 	return EXIT_SUCCESS;
 }
 
+/**
+ * @author Karlo Vuković
+ * @brief Function that finds the position of an attribute in the header of a table
+ * @param header table header
+ * @param num_attr number of attributes
+ * @param name name of the attribute
+ * @return position of the attribute, -1 if the table has no such attribute
+ */
+static int AK_selection_position(AK_header *header, int num_attr, char *name) {
+    int i;
+
+    for (i = 0; i < num_attr; i++) {
+        if (strcmp(header[i].att_name, name) == 0)
+            return i;
+    }
+    return -1;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that finds a B+tree index that holds all attributes of a projection in its key and included
+ *        attributes, and whose key the expression limits with a constant or with bounds
+ * @param indexes indices of the table
+ * @param num_indexes number of indices
+ * @param wanted 1 for each attribute the projection needs
+ * @param num_attr number of attributes
+ * @param keys constant of each attribute, NULL if there is none
+ * @param lower lower bound of each attribute
+ * @param upper upper bound of each attribute
+ * @return index of the index in the array, -1 if there is none
+ */
+static int AK_selection_covering(AK_index_description *indexes, int num_indexes, int *wanted, int num_attr,
+                                 struct list_node **keys, double *lower, double *upper) {
+    int held[MAX_ATTRIBUTES];
+    int i, j, key;
+
+    for (i = 0; i < num_indexes; i++) {
+        if (indexes[i].kind != BLOCK_TYPE_BTREE)
+            continue;
+        key = indexes[i].attribute[0];
+        if (keys[key] == NULL && isinf(lower[key]) && isinf(upper[key]))
+            continue;
+        memset(held, 0, sizeof (held));
+        for (j = 0; j < indexes[i].num_attr; j++)
+            held[indexes[i].attribute[j]] = 1;
+        for (j = 0; j < indexes[i].num_included; j++)
+            held[indexes[i].included[j]] = 1;
+        for (j = 0; j < num_attr && (!wanted[j] || held[j]); j++)
+            ;
+        if (j == num_attr)
+            return i;
+    }
+    return -1;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that answers a projection with a selection from a covering B+tree index, without reading blocks
+ *        of the table. The index has to hold every projected attribute as its key or an included attribute, the
+ *        expression may use only projected attributes and it has to limit the key with a constant or bounds. Rows
+ *        come from the leaves in the order of the index and each one is checked against the expression.
+ * @param srcTable source table name
+ * @param dstTable destination table name
+ * @param att list of the projected attributes
+ * @param expr list with postfix notation of the logical expression
+ * @return EXIT_SUCCESS if the destination table was filled from an index, EXIT_ERROR if no index covers the query
+ */
+int AK_selection_index_only(char *srcTable, char *dstTable, struct list_node *att, struct list_node *expr) {
+    AK_index_description indexes[INDEX_MAX_PER_TABLE];
+    AK_tuple_dict entries[MAX_ATTRIBUTES];
+    AK_btree_cursor cursor;
+    AK_btree_rid rid;
+    AK_header *header;
+    table_addresses *addresses;
+    struct list_node *keys[MAX_ATTRIBUTES], *element, *row_root;
+    double lower[MAX_ATTRIBUTES], upper[MAX_ATTRIBUTES];
+    char data[BTREE_MAX_ENTRY_SIZE], value[MAX_VARCHAR_LENGTH + 1];
+    int wanted[MAX_ATTRIBUTES];
+    int i, a, num_attr, num_indexes, open = -1, covered = 1;
+    AK_PRO;
+
+    num_attr = AK_num_attr(srcTable);
+    num_indexes = num_attr > 0 && num_attr <= MAX_ATTRIBUTES && expr != NULL ?
+                  AK_index_get_descriptions(srcTable, indexes, INDEX_MAX_PER_TABLE) : 0;
+    if (num_indexes == 0) {
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+    header = (AK_header *) AK_get_header(srcTable);
+    memset(wanted, 0, sizeof (wanted));
+    for (element = AK_First_L2(att); element != NULL && covered; element = AK_Next_L2(element)) {
+        a = AK_selection_position(header, num_attr, element->data);
+        if (a < 0)
+            covered = 0;
+        else
+            wanted[a] = 1;
+    }
+    //rows are checked with projected values only, as AK_projection checks them
+    for (element = AK_First_L2(expr); element != NULL && covered; element = AK_Next_L2(element)) {
+        if (element->type != TYPE_ATTRIBS)
+            continue;
+        a = AK_selection_position(header, num_attr, element->data);
+        if (a < 0 || !wanted[a])
+            covered = 0;
+    }
+    AK_bloom_filter_expr_keys(expr, header, num_attr, keys);
+    AK_zone_map_expr_bounds(expr, header, num_attr, lower, upper);
+    i = covered ? AK_selection_covering(indexes, num_indexes, wanted, num_attr, keys, lower, upper) : -1;
+    if (i >= 0)
+        open = AK_selection_btree_cursor(&indexes[i], header, keys, lower, upper, &cursor);
+    if (open < 0) {
+        AK_free(header);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
+
+    AK_dbg_messg(LOW, REL_OP, "\nProjection of %s reads only index %s.\n", srcTable, indexes[i].name);
+    addresses = AK_get_table_addresses(srcTable);
+    AK_create_block_header(addresses->address_from[0], dstTable, att);
+    AK_free(addresses);
+
+    row_root = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    AK_Init_L3(&row_root);
+    //a bound no key can reach leaves no rows
+    while (open > 0 && AK_btree_cursor_next(&cursor, &rid) == EXIT_SUCCESS) {
+        AK_btree_cursor_row(&cursor, entries, data);
+        for (a = 0; a < num_attr; a++) {
+            //nulls are left out of the row, as AK_copy_block_projection leaves them out
+            if (!wanted[a] || entries[a].size <= 0)
+                continue;
+            memcpy(value, data + entries[a].address, entries[a].size);
+            value[entries[a].size] = '\0';
+            AK_Insert_New_Element(entries[a].type, value, dstTable, header[a].att_name, row_root);
+        }
+        if (AK_First_L2(row_root) != NULL && AK_check_if_row_satisfies_expression(row_root, expr))
+            AK_insert_row(row_root);
+        AK_DeleteAll_L3(&row_root);
+    }
+    if (open > 0)
+        AK_btree_cursor_close(&cursor);
+    AK_free(row_root);
+    AK_free(header);
+    AK_EPI;
+    return EXIT_SUCCESS;
+}
+
 //------------------------------------------------------------------------------------------------------test 36
 
 /**
- * @author Matija Šestak, updated by Dino Laktašić, Nikola Miljancic, Tea Jelavić
+ * @author Karlo Vuković
+ * @brief Function that checks the access path a selection chooses and the number of rows it selects
+ * @param srcTable source table name
+ * @param dstTable destination table name
+ * @param expr list with postfix notation of the logical expression
+ * @param kind expected kind of the index, BLOCK_TYPE_NORMAL for a full scan
+ * @param num_rows expected number of selected rows
+ * @return 1 if the selection went as expected, 0 otherwise
+ */
+static int AK_selection_test_path(char *srcTable, char *dstTable, struct list_node *expr, int kind, int num_rows) {
+    AK_selection_path path;
+    int selected;
+
+    AK_selection_choose_path(srcTable, expr, &path);
+    if (path.rows != NULL)
+        AK_free(path.rows);
+    strcpy(expr->table, dstTable);
+    if (AK_selection(srcTable, dstTable, expr) == EXIT_ERROR)
+        return 0;
+    selected = AK_get_num_records(dstTable);
+    printf("\nSelection read %s and selected %d rows, expected %d.\n", path.kind == BLOCK_TYPE_NORMAL ? "the whole table" : path.index,
+           selected, num_rows);
+    return path.kind == kind && selected == num_rows;
+}
+
+/**
+ * @author Matija Šestak, updated by Dino Laktašić, Nikola Miljancic, Tea Jelavić, updated by Karlo Vuković (indices)
  * @brief  Function for selection operator testing
- * using WHERE clause and operators BETWEEN, AND
+ * using WHERE clause and operators BETWEEN, AND, through indices and without them
  *
  */
 
@@ -221,6 +900,186 @@ TestResult AK_op_selection_test() { //test 36
     } 
 
     AK_DeleteAll_L3(&expr);
+
+    //selections on a table with indices read the rows the index that finds fewest of them finds, or the whole table
+    char *idxTable = "selection_index_test";
+    AK_header i_header[4] = {
+        {TYPE_INT, "id", {0}, {{'\0'}}, {{'\0'}}},
+        {TYPE_INT, "grp", {0}, {{'\0'}}, {{'\0'}}},
+        {TYPE_VARCHAR, "status", {0}, {{'\0'}}, {{'\0'}}},
+        {0, {'\0'}, {0}, {{'\0'}}, {{'\0'}}}};
+    int num_index_rows = 400, id, grp, i;
+    char destTable3[256];
+    struct list_node **rows, *att_list;
+
+    AK_btree_delete("selection_index_test_id");
+    AK_btree_delete("selection_index_test_cover");
+    AK_btree_delete("selection_index_test_grp_id");
+    AK_delete_hash_index("selection_index_test_grp");
+    AK_delete_bitmap_index("selection_index_teststatus_bmapIndex");
+    if (AK_num_attr(idxTable) > 0)
+        AK_delete_segment(idxTable, SEGMENT_TYPE_TABLE);
+    AK_initialize_new_segment(idxTable, SEGMENT_TYPE_TABLE, i_header);
+    rows = (struct list_node **) AK_calloc(num_index_rows, sizeof (struct list_node *));
+    for (i = 0; i < num_index_rows; i++) {
+        id = i;
+        grp = i % 40;
+        rows[i] = (struct list_node *) AK_malloc(sizeof (struct list_node));
+        AK_Init_L3(&rows[i]);
+        AK_Insert_New_Element(TYPE_INT, &id, idxTable, "id", rows[i]);
+        AK_Insert_New_Element(TYPE_INT, &grp, idxTable, "grp", rows[i]);
+        AK_Insert_New_Element(TYPE_VARCHAR, i % 100 == 0 ? "rare" : "common", idxTable, "status", rows[i]);
+    }
+    AK_bulk_insert(idxTable, rows, num_index_rows);
+    for (i = 0; i < num_index_rows; i++) {
+        AK_DeleteAll_L3(&rows[i]);
+        AK_free(rows[i]);
+    }
+    AK_free(rows);
+    att_list = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    AK_Init_L3(&att_list);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "id", sizeof ("id"), att_list);
+    AK_btree_create(idxTable, att_list, "selection_index_test_id");
+    AK_DeleteAll_L3(&att_list);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "grp", sizeof ("grp"), att_list);
+    AK_create_hash_index(idxTable, att_list, "selection_index_test_grp");
+    AK_DeleteAll_L3(&att_list);
+    AK_free(att_list);
+    AK_create_bitmap_index(idxTable, "status");
+
+    int local_fail = 0;
+    a = 100;
+    b = 119;
+    printf("\nQUERY: SELECT * FROM selection_index_test WHERE id BETWEEN 100 AND 119;\n\n");
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "id", sizeof ("id"), expr);
+    AK_InsertAtEnd_L3(TYPE_INT, &a, sizeof (int), expr);
+    AK_InsertAtEnd_L3(TYPE_INT, &b, sizeof (int), expr);
+    AK_InsertAtEnd_L3(TYPE_OPERATOR, "BETWEEN", sizeof ("BETWEEN"), expr);
+    sprintf(destTable3, "selection_test_index1_%d", test_run_count);
+    if (!AK_selection_test_path(idxTable, destTable3, expr, BLOCK_TYPE_BTREE, 20))
+        local_fail++;
+    AK_DeleteAll_L3(&expr);
+
+    grp = 7;
+    printf("\nQUERY: SELECT * FROM selection_index_test WHERE grp = 7;\n\n");
+    //constants come first, equality compares values by the size of its first operand
+    AK_InsertAtEnd_L3(TYPE_INT, &grp, sizeof (int), expr);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "grp", sizeof ("grp"), expr);
+    AK_InsertAtEnd_L3(TYPE_OPERATOR, "=", sizeof ("="), expr);
+    sprintf(destTable3, "selection_test_index2_%d", test_run_count);
+    if (!AK_selection_test_path(idxTable, destTable3, expr, BLOCK_TYPE_HASH, num_index_rows / 40))
+        local_fail++;
+    AK_DeleteAll_L3(&expr);
+
+    //the B+tree finds 300 rows, too many, so the bitmap is used
+    a = 300;
+    printf("\nQUERY: SELECT * FROM selection_index_test WHERE status = 'rare' AND id < 300;\n\n");
+    AK_InsertAtEnd_L3(TYPE_VARCHAR, "rare", sizeof ("rare"), expr);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "status", sizeof ("status"), expr);
+    AK_InsertAtEnd_L3(TYPE_OPERATOR, "=", sizeof ("="), expr);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "id", sizeof ("id"), expr);
+    AK_InsertAtEnd_L3(TYPE_INT, &a, sizeof (int), expr);
+    AK_InsertAtEnd_L3(TYPE_OPERATOR, "<", sizeof ("<"), expr);
+    AK_InsertAtEnd_L3(TYPE_OPERATOR, "AND", sizeof ("AND"), expr);
+    sprintf(destTable3, "selection_test_index3_%d", test_run_count);
+    if (!AK_selection_test_path(idxTable, destTable3, expr, BLOCK_TYPE_BITMAP, 3))
+        local_fail++;
+    AK_DeleteAll_L3(&expr);
+
+    printf("\nQUERY: SELECT * FROM selection_index_test WHERE id > 300;\n\n");
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "id", sizeof ("id"), expr);
+    AK_InsertAtEnd_L3(TYPE_INT, &a, sizeof (int), expr);
+    AK_InsertAtEnd_L3(TYPE_OPERATOR, ">", sizeof (">"), expr);
+    sprintf(destTable3, "selection_test_index4_%d", test_run_count);
+    if (!AK_selection_test_path(idxTable, destTable3, expr, BLOCK_TYPE_NORMAL, num_index_rows - a - 1))
+        local_fail++;
+    AK_DeleteAll_L3(&expr);
+
+    if (local_fail == 0) {
+        printf("\nSelection test 3 succeeded.\n");
+        successful++;
+    } else {
+        printf("\nSelection test 3 failed: %d of 4 selections through indices went wrong.\n", local_fail);
+        failed++;
+    }
+
+    //a projection whose attributes a B+tree index holds reads only the index
+    att_list = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    AK_Init_L3(&att_list);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "id", sizeof ("id"), att_list);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "status", sizeof ("status"), att_list);
+    AK_btree_create(idxTable, att_list, "selection_index_test_cover");
+    local_fail = 0;
+    a = 100;
+    b = 119;
+    printf("\nQUERY: SELECT id, status FROM selection_index_test WHERE id BETWEEN 100 AND 119;\n\n");
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "id", sizeof ("id"), expr);
+    AK_InsertAtEnd_L3(TYPE_INT, &a, sizeof (int), expr);
+    AK_InsertAtEnd_L3(TYPE_INT, &b, sizeof (int), expr);
+    AK_InsertAtEnd_L3(TYPE_OPERATOR, "BETWEEN", sizeof ("BETWEEN"), expr);
+    sprintf(destTable3, "selection_test_cover1_%d", test_run_count);
+    if (AK_selection_index_only(idxTable, destTable3, att_list, expr) == EXIT_ERROR ||
+        AK_get_num_records(destTable3) != 20 || AK_num_attr(destTable3) != 2)
+        local_fail++;
+    sprintf(destTable3, "selection_test_cover2_%d", test_run_count);
+    if (AK_projection(idxTable, destTable3, att_list, expr) == EXIT_ERROR || AK_get_num_records(destTable3) != 20)
+        local_fail++;
+    AK_DeleteAll_L3(&expr);
+    AK_DeleteAll_L3(&att_list);
+
+    //the index does not hold grp
+    grp = 7;
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "grp", sizeof ("grp"), att_list);
+    AK_InsertAtEnd_L3(TYPE_INT, &grp, sizeof (int), expr);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "grp", sizeof ("grp"), expr);
+    AK_InsertAtEnd_L3(TYPE_OPERATOR, "=", sizeof ("="), expr);
+    sprintf(destTable3, "selection_test_cover3_%d", test_run_count);
+    if (AK_selection_index_only(idxTable, destTable3, att_list, expr) != EXIT_ERROR)
+        local_fail++;
+    AK_DeleteAll_L3(&expr);
+    AK_DeleteAll_L3(&att_list);
+    AK_free(att_list);
+
+    if (local_fail == 0) {
+        printf("\nSelection test 4 succeeded.\n");
+        successful++;
+    } else {
+        printf("\nSelection test 4 failed: %d of 3 index-only scans went wrong.\n", local_fail);
+        failed++;
+    }
+
+    //a B+tree index on grp and id finds fewer rows than the hash index on grp alone
+    att_list = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    AK_Init_L3(&att_list);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "grp", sizeof ("grp"), att_list);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "id", sizeof ("id"), att_list);
+    AK_btree_create_composite(idxTable, att_list, 2, "selection_index_test_grp_id");
+    AK_DeleteAll_L3(&att_list);
+    AK_free(att_list);
+    local_fail = 0;
+    grp = 7;
+    a = 300;
+    printf("\nQUERY: SELECT * FROM selection_index_test WHERE grp = 7 AND id < 300;\n\n");
+    AK_InsertAtEnd_L3(TYPE_INT, &grp, sizeof (int), expr);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "grp", sizeof ("grp"), expr);
+    AK_InsertAtEnd_L3(TYPE_OPERATOR, "=", sizeof ("="), expr);
+    AK_InsertAtEnd_L3(TYPE_ATTRIBS, "id", sizeof ("id"), expr);
+    AK_InsertAtEnd_L3(TYPE_INT, &a, sizeof (int), expr);
+    AK_InsertAtEnd_L3(TYPE_OPERATOR, "<", sizeof ("<"), expr);
+    AK_InsertAtEnd_L3(TYPE_OPERATOR, "AND", sizeof ("AND"), expr);
+    sprintf(destTable3, "selection_test_composite1_%d", test_run_count);
+    if (!AK_selection_test_path(idxTable, destTable3, expr, BLOCK_TYPE_BTREE, (a - grp + 39) / 40))
+        local_fail++;
+    AK_DeleteAll_L3(&expr);
+
+    if (local_fail == 0) {
+        printf("\nSelection test 5 succeeded.\n");
+        successful++;
+    } else {
+        printf("\nSelection test 5 failed: the composite index was not used.\n");
+        failed++;
+    }
+
     AK_free(expr);
 	test_run_count++;
 
@@ -350,46 +1209,7 @@ TestResult AK_op_selection_test_pattern() { //test 37
     printf("\nQUERY: SELECT * FROM student WHERE firstname SIMILAR TO .*(d|i).*;\n\n");
 	int sel5 = AK_selection(srcTable, destTable5, expr);
 
-	// IMPORTANT! Down below are 2 types of Selection pattern match test 3. One is real test and one is fake test. Real test is implemented correcly and fake test is adapted to the current implementation of SIMILAR TO operator so it can pass when called. Real one is commented because SIMILAR TO operator isnt implemented corectly (check the rows, its obvious -> new issue?) in other part of program. After fixing SIMILAR TO uncomment part of code between //real-test-real-test and delete code inside //fake-test-fake-test. If SIMILAR TO is implemented corectly Selection pattern match test 3 will pass as it is supposed to.
-
-	//real-test-real-test-real-test-real-test-real-test-real-test-real-test-real-test
-	/*
-	if (sel5 == EXIT_ERROR) {
-		printf("\nSelection pattern match test 3 failed.\n");
-		failed++;	
-	}
-	else { //checking exact row data
-		num_rows = AK_get_num_records(destTable5);
-		
-		if (num_rows == 16) {
-			int i=0;
-			int local_fail = 0;
-			while ((row = (struct list_node*)AK_get_row(i,destTable5)) != NULL) {
-				memcpy(&mbr, get_row_attr_data(0,row), sizeof(int));
-
-				if (mbr != 35891 && mbr != 35893 && mbr != 35894 && mbr != 35895 && mbr != 35897 && mbr != 35898 && mbr != 35899 && mbr != 35900 && mbr != 35901 && mbr != 35902 && mbr != 35903 && mbr != 35905 && mbr != 35906 && mbr != 35911 && mbr != 35912 && mbr != 35913) {
-					failed++;
-					local_fail = 1;
-					break;
-				}
-				i++;
-			} 
-			if (!local_fail) {
-				printf("\nSelection pattern match test 3 succeded.\n");
-				successful++;
-			}
-			else {
-				printf("\nSelection pattern match test 3 failed: Wrong data. \n");
-			}
-		}
-		else {
-			printf("\nSelection pattern match test 3 failed: Wrong number of rows.\n");
-			failed++;
-		}
-	}*/
-	//real-test-real-test-real-test-real-test-real-test-real-test-real-test-real-test
-
-	//fake-test-fake-test-fake-test-fake-test-fake-test-fake-test-fake-test-fake-test
+	//SIMILAR TO is case sensitive, so first names with a capital I do not match
 	if (sel5 == EXIT_ERROR) {
 		printf("\nSelection pattern match test 3 failed.\n");
 		failed++;	
@@ -397,13 +1217,13 @@ TestResult AK_op_selection_test_pattern() { //test 37
 	else { //checking exact row data
 		num_rows = AK_get_num_records(destTable5);
 		
-		if (num_rows == 26) {
+		if (num_rows == 11) {
 			int i=0;
 			int local_fail = 0;
 			while ((row = (struct list_node*)AK_get_row(i,destTable5)) != NULL) {
 				memcpy(&mbr, get_row_attr_data(0,row), sizeof(int));
 
-				if (mbr != 35891 && mbr != 35892 && mbr != 35893 && mbr != 35894 && mbr != 35895 && mbr != 35896 && mbr != 35897 && mbr != 35898 && mbr != 35899 && mbr != 35900 && mbr != 35901 && mbr != 35902 && mbr != 35903 && mbr != 35904 && mbr != 35905 && mbr != 35906 && mbr != 35907 && mbr != 35908 && mbr != 35909 && mbr != 35910 && mbr != 35911 && mbr != 35912 && mbr != 35913 && mbr != 35914 && mbr != 35915 && mbr != 35916) {
+				if (mbr != 35891 && mbr != 35893 && mbr != 35898 && mbr != 35900 && mbr != 35901 && mbr != 35902 && mbr != 35905 && mbr != 35906 && mbr != 35911 && mbr != 35912 && mbr != 35913) {
 					failed++;
 					local_fail = 1;
 					break;
@@ -423,7 +1243,6 @@ TestResult AK_op_selection_test_pattern() { //test 37
 			failed++;
 		}
 	}
-	//fake-test-fake-test-fake-test-fake-test-fake-test-fake-test-fake-test-fake-test
 
 	AK_DeleteAll_L3(&expr);
 
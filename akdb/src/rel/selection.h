@@ -27,17 +27,62 @@
 #include "../auxi/configuration.h"
 #include "../file/files.h"
 #include "../auxi/mempro.h"
+#include "../file/idx/index.h"
 
+/**
+ * @author Karlo Vuković
+ * @struct AK_selection_path
+ * @brief Structure that describes how a selection reads the source table
+ */
+typedef struct {
+    /// name of the index the rows are found with, empty for a full scan
+    char index[MAX_ATT_NAME];
+    /// kind of the index, BLOCK_TYPE_BTREE, BLOCK_TYPE_HASH, BLOCK_TYPE_BITMAP or BLOCK_TYPE_TRIGRAM, BLOCK_TYPE_NORMAL
+    /// for a full scan
+    int kind;
+    /// number of rows found with the index
+    int num_rows;
+    /// addresses of the rows in the order of the table, NULL for a full scan
+    struct_add *rows;
+} AK_selection_path;
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that chooses how AK_selection reads the source table. Equalities of attributes with constants and
+ *        bounds of attributes joined with AND are looked up in the B+tree, hash and bitmap indices of the table,
+ *        patterns of LIKE, ILIKE, SIMILAR TO and regular expressions in its trigram indices, and the index that
+ *        finds the fewest rows is used if they are at most INDEX_SCAN_SELECTIVITY of the rows of the table, as
+ *        AK_zone_map_table_rows counts them. Otherwise the table is scanned, and so are tables with the PAX layout,
+ *        which have no indices.
+ * @param srcTable source table name
+ * @param expr list with postfix notation of the logical expression
+ * @param path access path, the caller frees its rows
+ * @return EXIT_SUCCESS, EXIT_ERROR if the table does not exist
+ */
+int AK_selection_choose_path(char *srcTable, struct list_node *expr, AK_selection_path *path);
 
 /**
- * @author Matija Šestak.
- * @brief  Function that which implements selection
+ * @author Matija Šestak, updated by Karlo Vuković (indices)
+ * @brief  Function that which implements selection, through an index if AK_selection_choose_path finds one
  * @param *srcTable source table name
  * @param *dstTable destination table name
  * @param *expr list with posfix notation of the logical expression
  * @return EXIT_SUCCESS
  */
 int AK_selection(char *srcTable, char *dstTable, struct list_node *expr);
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that answers a projection with a selection from a covering B+tree index, without reading blocks
+ *        of the table. The index has to hold every projected attribute as its key or an included attribute, the
+ *        expression may use only projected attributes and it has to limit the key with a constant or bounds.
+ * @param srcTable source table name
+ * @param dstTable destination table name
+ * @param att list of the projected attributes
+ * @param expr list with postfix notation of the logical expression
+ * @return EXIT_SUCCESS if the destination table was filled from an index, EXIT_ERROR if no index covers the query
+ */
+int AK_selection_index_only(char *srcTable, char *dstTable, struct list_node *att, struct list_node *expr);
 TestResult AK_op_selection_test();
 TestResult AK_op_selection_test_pattern();
 
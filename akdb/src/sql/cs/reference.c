@@ -18,10 +18,158 @@
  17 */
 
 #include "reference.h"
+#include "../../file/idx/bloom.h"
+#include "../../file/idx/btree.h"
 
 /**
- * @author Dejan Frankovic
+ * @author Karlo Vuković
+ * @struct AK_reference_key
+ * @brief Structure that holds the values of a foreign key of a row in a batch, so rows with the same values are
+ *        checked once
+ */
+typedef struct {
+    /// values of the foreign key, made with AK_btree_make_key
+    char key[MAX_VARCHAR_LENGTH];
+    /// size of the values
+    int size;
+    /// number of the row in the batch
+    int row;
+} AK_reference_key;
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that creates a B+tree index on attributes of a table that a reference uses, unless the table
+ *        already has an index whose key starts with them. Tables of the system catalog, tables with the PAX layout
+ *        and references on more than BTREE_MAX_KEYS attributes get no index.
+ * @param tableName name of the table
+ * @param attNames names of the attributes
+ * @param attNum number of attributes
+ * @param constraintName name of the reference
+ * @param role "parent" or "child", it is a part of the name of the index
+ * @return EXIT_SUCCESS if the table has such an index or does not need one, EXIT_ERROR if it could not be created
+ */
+static int AK_reference_create_index(char *tableName, char *attNames[], int attNum, char *constraintName, char *role) {
+    struct list_node *attributes;
+    char indexName[MAX_ATT_NAME];
+    int positions[BTREE_MAX_KEYS];
+    int i, result;
+
+    if (strncmp(tableName, "AK_", 3) == 0 || attNum < 1 || attNum > BTREE_MAX_KEYS ||
+        AK_get_storage_layout(tableName) != BLOCK_TYPE_NORMAL)
+        return EXIT_SUCCESS;
+    for (i = 0; i < attNum; i++) {
+        positions[i] = AK_get_attr_index(tableName, attNames[i]);
+        if (positions[i] < 0)
+            return EXIT_ERROR;
+    }
+    if (AK_btree_find_index(tableName, positions, attNum, indexName) != EXIT_ERROR)
+        return EXIT_SUCCESS;
+
+    //the name of the index becomes the name of its segment
+    snprintf(indexName, MAX_ATT_NAME, "%s_%s_%s_index", tableName, constraintName, role);
+    for (i = 0; indexName[i] != '\0'; i++) {
+        if (!isalnum((unsigned char) indexName[i]))
+            indexName[i] = '_';
+    }
+    attributes = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    AK_Init_L3(&attributes);
+    for (i = 0; i < attNum; i++)
+        AK_InsertAtEnd_L3(TYPE_ATTRIBS, attNames[i], strlen(attNames[i]), attributes);
+    result = AK_btree_create_composite(tableName, attributes, attNum, indexName);
+    AK_DeleteAll_L3(&attributes);
+    AK_free(attributes);
+    return result;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that takes the values of the foreign key of a reference from a new row
+ * @param lista list of elements of the row
+ * @param reference reference
+ * @param values list for the values, in the order of the attributes of the reference
+ * @return EXIT_SUCCESS, EXIT_ERROR if the row has no value or a null for an attribute of the reference
+ */
+static int AK_reference_values(struct list_node *lista, AK_ref_item *reference, struct list_node *values) {
+    struct list_node *temp;
+    int j;
+
+    for (j = 0; j < reference->attributes_number; j++) {
+        for (temp = lista->next; temp != NULL; temp = temp->next) {
+            if (temp->constraint == NEW_VALUE && strcmp(temp->attribute_name, reference->attributes[j]) == 0)
+                break;
+        }
+        //a null is not a value of the parent table
+        if (temp == NULL || temp->type == 0 || AK_type_size(temp->type, temp->data) <= 0)
+            return EXIT_ERROR;
+        AK_InsertAtEnd_L3(temp->type, temp->data, AK_type_size(temp->type, temp->data), values);
+    }
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that looks for the values of the foreign key of a new row in a B+tree index on the attributes of
+ *        the parent table
+ * @param lista list of elements of the row
+ * @param reference reference
+ * @return 1 if the parent table has the values, 0 if it does not, -1 if there is no such index or the row has a null
+ *         in the foreign key
+ */
+static int AK_reference_index_check(struct list_node *lista, AK_ref_item *reference) {
+    struct list_node *values;
+    int positions[BTREE_MAX_KEYS];
+    int j, found = -1;
+
+    if (reference->attributes_number < 1 || reference->attributes_number > BTREE_MAX_KEYS)
+        return -1;
+    for (j = 0; j < reference->attributes_number; j++) {
+        positions[j] = AK_get_attr_index(reference->parent, reference->parent_attributes[j]);
+        if (positions[j] < 0)
+            return -1;
+    }
+    values = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    AK_Init_L3(&values);
+    if (AK_reference_values(lista, reference, values) == EXIT_SUCCESS)
+        found = AK_btree_lookup(reference->parent, positions, values, reference->attributes_number, NULL, 0);
+    AK_DeleteAll_L3(&values);
+    AK_free(values);
+    return found < 0 ? -1 : found > 0;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that finds the names of the references of a child table in AK_reference
+ * @param tableName name of the child table
+ * @param constraints array for the names
+ * @return number of references
+ */
+static int AK_reference_constraints(char *tableName, char constraints[][MAX_VARCHAR_LENGTH]) {
+    struct list_node *row;
+    int i = 0, j, con_num = 0;
+
+    while ((row = AK_get_row(i, "AK_reference")) != NULL) {
+        if (strcmp(row->next->data, tableName) == 0) {
+            for (j = 0; j < con_num; j++) {
+                if (strcmp(constraints[j], row->next->next->data) == 0)
+                    break;
+            }
+            if (j == con_num && con_num < MAX_CHILD_CONSTRAINTS) {
+                strcpy(constraints[con_num], row->next->next->data);
+                con_num++;
+            }
+        }
+        i++;
+        AK_DeleteAll_L3(&row);
+        AK_free(row);
+    }
+    return con_num;
+}
+
+/**
+ * @author Dejan Frankovic, updated by Karlo Vuković (indices of the reference)
  * @brief Function that adds a reference for a group of attributes over a given table to a group of attributes over another table with a given constraint name.
+ *        B+tree indices on the attributes of both tables are created with the reference, unless the tables already have them,
+ *        so new rows of the child table find their parent rows and changes of the parent table find their child rows without reading the tables.
  * @param name of the child table
  * @param array of child table attribute names (foreign key attributes)
  * @param name of the parent table
@@ -29,7 +177,7 @@
  * @param number of attributes in foreign key
  * @param name of the constraint
  * @param type of the constraint, constants defined in 'reference.h'
- * @return EXIT_SUCCESS
+ * @return EXIT_SUCCESS, EXIT_ERROR if the child table already has a reference with the name
  */
 int AK_add_reference(char *childTable, char *childAttNames[], char *parentTable, char *parentAttNames[], int attNum, char *constraintName, int type) {
     int i;
@@ -38,6 +186,11 @@ int AK_add_reference(char *childTable, char *childAttNames[], char *parentTable,
 	AK_EPI;
 	return 0;
     }
+    if (AK_get_reference(childTable, constraintName).attributes_number > 0) {
+        printf("\nReference %s already exists on table %s\n", constraintName, childTable);
+        AK_EPI;
+        return EXIT_ERROR;
+    }
 
     struct list_node *row_root = (struct list_node *) AK_malloc(sizeof (struct list_node));
     AK_Init_L3(&row_root);
@@ -54,7 +207,12 @@ int AK_add_reference(char *childTable, char *childAttNames[], char *parentTable,
         AK_insert_row(row_root);
     }
 
+    AK_DeleteAll_L3(&row_root);
     AK_free(row_root);
+    //without the indices the tables are read
+    if (AK_reference_create_index(parentTable, parentAttNames, attNum, constraintName, "parent") == EXIT_ERROR ||
+        AK_reference_create_index(childTable, childAttNames, attNum, constraintName, "child") == EXIT_ERROR)
+        printf("\nReference %s has no index, its checks read tables %s and %s\n", constraintName, parentTable, childTable);
     AK_EPI;
     return EXIT_SUCCESS;
 }
@@ -92,15 +250,16 @@ AK_ref_item AK_get_reference(char *tableName, char *constraintName) {
 }
 
 /**
- * @author Dejan Frankovic
- * @brief Function that checks referential integrity for one attribute
+ * @author Dejan Frankovic, updated by Karlo Vuković (Bloom filters)
+ * @brief Function that checks referential integrity for one attribute. A value that Bloom filters of the parent
+ *        attribute do not hold fails without reading the parent table.
  * @param child table name
  * @param attribute name (foreign key attribute)
  * @param value of the attribute we're checking
  * @return EXIT ERROR if check failed, EXIT_SUCCESS if referential integrity is ok
  */
 int AK_reference_check_attribute(char *tableName, char *attribute, char *value) {
-    int i;
+    int i = 0;
     int att_index;
 
     struct list_node *list_row, *list_col;
@@ -108,6 +267,10 @@ int AK_reference_check_attribute(char *tableName, char *attribute, char *value)
     while ((list_row = AK_get_row(i, "AK_reference")) != NULL) {
         if (strcmp(list_row->next->data, tableName) == 0 &&
                 strcmp(list_row->next->next->next->data, attribute) == 0) {
+            if (!AK_bloom_filter_may_contain(list_row->next->next->next->next->data, list_row->next->next->next->next->next->data, -1, TYPE_VARCHAR, value, strlen(value))) {
+                AK_EPI;
+                return EXIT_ERROR;
+            }
             att_index = AK_get_attr_index(list_row->next->next->next->next->data, list_row->next->next->next->next->next->data);
             list_col = AK_get_column(att_index, list_row->next->next->next->next->data);
             while (strcmp(list_col->data, value) != 0) {
@@ -198,15 +361,17 @@ int AK_reference_check_restricion(struct list_node *lista, int action) {
 }
 
 /**
- * @author Dejan Franković
- * @brief Function that updates child table entries according to ongoing update of parent table entries.
+ * @author Dejan Franković, updated by Karlo Vuković (indices)
+ * @brief Function that updates child table entries according to ongoing update of parent table entries. Child rows of
+ *        each parent row are updated or deleted with AK_update_row and AK_delete_row, which find them through the
+ *        index on the attributes of the child table that AK_add_reference creates.
  * @param list of elements for update
  * @param is action UPDATE or DELETE ?
  * @return EXIT_SUCCESS
  */
 
 int AK_reference_update(struct list_node *lista, int action) {
-    int parent_i, i, j, ref_i, con_num = 0;
+    int parent_i = 0, i, j, ref_i = 0, con_num = 0;
 
     struct list_node *parent_row;
     struct list_node *ref_row;
@@ -342,19 +507,83 @@ int AK_reference_update(struct list_node *lista, int action) {
 }
 
 /**
- * @author Dejan Franković
- * @brief Function that checks a new entry for referential integrity.
- * @param list of elements for insert row
- * @return EXIT_SUCCESS if referential integrity is ok, EXIT_ERROR if it is compromised
+ * @author Dejan Franković, updated by Karlo Vuković (Bloom filters, indices)
+ * @brief Function that checks one reference of a new entry. The values are searched in a B+tree index on the parent
+ *        attributes if the parent table has one. Otherwise rows of the parent table are not read for values that
+ *        Bloom filters of the parent attributes do not hold.
+ * @param lista list of elements for insert row
+ * @param reference reference of the table of the row
+ * @return EXIT_SUCCESS if the parent table has the values, EXIT_ERROR otherwise
  */
-int AK_reference_check_entry(struct list_node *lista) {
-    
+static int AK_reference_check_one(struct list_node *lista, AK_ref_item *reference) {
     struct list_node *temp, *row, *temp1;
-    int i = 0, j, k, con_num = 0, success;
-    char constraints[10][MAX_VARCHAR_LENGTH]; // this 10 should probably be a constant... how many foreign keys can one table have..
+    int j, k, success, found;
     char attributes[MAX_REFERENCE_ATTRIBUTES][MAX_ATT_NAME];
     int is_att_null[MAX_REFERENCE_ATTRIBUTES]; //this is a workaround... when proper null value implementation is in place, this should be solved differently
+
+    //the index finds the values without reading the parent table
+    found = AK_reference_index_check(lista, reference);
+    if (found >= 0)
+        return found == 1 ? EXIT_SUCCESS : EXIT_ERROR;
+
+    // fetching relevant attributes from entry list...
+    for (j = 0; j < reference->attributes_number; j++) {
+        attributes[j][0] = '\0';
+        is_att_null[j] = 0;
+        temp = lista->next;
+        while (temp != NULL) {
+
+            if (temp->constraint == 0 && strcmp(temp->attribute_name, reference->attributes[j]) == 0) {
+                strcpy(attributes[j], temp->data);
+                if (reference->type == REF_TYPE_SET_NULL && strcmp(temp->data, "\0") == 0) //if type is 0, the value is PROBABLY null
+                    is_att_null[j] = 1;
+                break;
+            }
+            temp = AK_Next_L2(temp);
+        }
+    }
+
+    if (reference->attributes_number == 1)
+        return AK_reference_check_attribute(reference->table, reference->attributes[0], attributes[0]);
+
+    for (k = 0; k < reference->attributes_number; k++)
+        if (!is_att_null[k] && !AK_bloom_filter_may_contain(reference->parent, reference->parent_attributes[k], -1, TYPE_VARCHAR, attributes[k], strlen(attributes[k])))
+            return EXIT_ERROR;
+
+    j = 0;
+    while ((row = AK_get_row(j, reference->parent)) != NULL) { // rows in parent table
+        success = 1;
+        for (k = 0; k < reference->attributes_number; k++) { // attributes in reference
+            temp1 = AK_GetNth_L2(AK_get_attr_index(reference->parent, reference->parent_attributes[k]), row);
+            if (temp1 != 0x0) {
+                if (is_att_null[k] || strcmp(temp1->data, attributes[k]) != 0) {
+                    success = 0;
+                    break;
+                }
+            }
+        }
+        AK_DeleteAll_L3(&row);
+        AK_free(row);
+        if (success == 1)
+            return EXIT_SUCCESS;
+        j++;
+    }
+    return EXIT_ERROR;
+}
+
+/**
+ * @author Dejan Franković, updated by Karlo Vuković (Bloom filters, indices)
+ * @brief Function that checks a new entry for referential integrity. Values of each reference of the table are
+ *        searched in a B+tree index on the parent attributes when there is one. Otherwise rows of the parent table are
+ *        not read for a reference whose values Bloom filters of the parent attributes do not hold.
+ * @param list of elements for insert row
+ * @return EXIT_SUCCESS if referential integrity is ok, EXIT_ERROR if it is compromised
+ */
+int AK_reference_check_entry(struct list_node *lista) {
     
+    struct list_node *temp;
+    int i, con_num;
+    char constraints[MAX_CHILD_CONSTRAINTS][MAX_VARCHAR_LENGTH];
     AK_ref_item reference;
 
     AK_PRO;
@@ -369,83 +598,94 @@ int AK_reference_check_entry(struct list_node *lista) {
 	temp = AK_Next_L2(temp);
     }
 
-    while ((row = AK_get_row(i, "AK_reference")) != NULL) 
-	{
-        if (strcmp(row->next->data, lista->next->table) == 0) 
-		{
-            for (j = 0; j < con_num; j++) 
-			{
-                if (strcmp(constraints[j], row->next->next->data) == 0) 
-				{
-                    break;
-                }
-            }
-            if (j == con_num) 
-			{
-                strcpy(constraints[con_num], row->next->next->data);
-                con_num++;
-            }
-        }
-        i++;
-		AK_free(row);
-    }
-
-    if (con_num == 0){
-	AK_EPI;
-        return EXIT_SUCCESS;
-    }
-
+    con_num = AK_reference_constraints(lista->next->table, constraints);
     for (i = 0; i < con_num; i++) { // reference
         reference = AK_get_reference(lista->next->table, constraints[i]);
-
-        // fetching relevant attributes from entry list...
-        // attributes = AK_malloc(sizeof(char)*MAX_VARCHAR_LENGHT*reference.attributes_number);
-        for (j = 0; j < reference.attributes_number; j++) {
-            temp = lista->next;
-            while (temp != NULL) {
-
-                if (temp->constraint == 0 && strcmp(temp->attribute_name, reference.attributes[j]) == 0) {
-                    strcpy(attributes[j], temp->data);
-                    if (reference.type == REF_TYPE_SET_NULL && strcmp(temp->data, "\0") == 0) //if type is 0, the value is PROBABLY null
-                        is_att_null[j] = 1;
-                    else
-                        is_att_null[j] = 0;
-                    break;
-                }
-//                temp = AK_Next_L2(temp);
-		temp = AK_Next_L2(temp);
-            }
+        if (AK_reference_check_one(lista, &reference) == EXIT_ERROR) {
+            AK_EPI;
+            return EXIT_ERROR;
         }
+    }
+    AK_EPI;
+    return EXIT_SUCCESS;
+}
 
-        if (reference.attributes_number == 1) {
-            if (AK_reference_check_attribute(reference.table, reference.attributes[0], attributes[0]) == EXIT_ERROR) {
-		AK_EPI;
-                return EXIT_ERROR;
-            } else continue;
-        }
+/**
+ * @author Karlo Vuković
+ * @brief Function that compares values of foreign keys of two rows of a batch, and then the numbers of the rows
+ * @param left first values
+ * @param right second values
+ * @return negative number if the first values come first, 0 if they are equal, otherwise positive number
+ */
+static int AK_reference_key_compare(const void *left, const void *right) {
+    const AK_reference_key *a = (const AK_reference_key *) left, *b = (const AK_reference_key *) right;
+    int result;
+
+    if (a->size != b->size)
+        return a->size < b->size ? -1 : 1;
+    result = memcmp(a->key, b->key, a->size);
+    if (result != 0)
+        return result;
+    return a->row - b->row;
+}
 
+/**
+ * @author Karlo Vuković
+ * @brief Function that checks a batch of new rows of one table for referential integrity. AK_reference is read once
+ *        for the batch, and for each reference rows with the same values of the foreign key are checked together,
+ *        so a value that many rows of a bulk load share is looked up in the parent table once.
+ * @param rows array of rows, each one a list of elements
+ * @param num_rows number of rows in the array
+ * @param violation number of the first row that compromises referential integrity, -1 if there is none
+ * @return EXIT_SUCCESS if referential integrity of all rows is ok, EXIT_ERROR otherwise
+ */
+int AK_reference_check_entries(struct list_node **rows, int num_rows, int *violation) {
+    char constraints[MAX_CHILD_CONSTRAINTS][MAX_VARCHAR_LENGTH];
+    AK_reference_key *keys;
+    struct list_node *values;
+    AK_ref_item reference;
+    int i, j, c, num_keys, con_num;
+    AK_PRO;
 
-        j = 0;
-        while ((row = AK_get_row(j, reference.parent)) != NULL) { // rows in parent table
-            success = 1;
-            for (k = 0; k < reference.attributes_number; k++) { // attributes in reference
-		temp1 = AK_GetNth_L2(AK_get_attr_index(reference.parent, reference.parent_attributes[k]), row);
-                if (temp1 != 0x0) {
-                  if (is_att_null[k] || strcmp(temp1->data, attributes[k]) != 0) {
-                      success = 0;
-                      break;
-                  }
-                }
-            }
-            if (success == 1) {
-		AK_EPI;
-                return EXIT_SUCCESS;
-            }
-            j++;
+    *violation = -1;
+    if (num_rows <= 0) {
+        AK_EPI;
+        return EXIT_SUCCESS;
+    }
+    con_num = AK_reference_constraints(rows[0]->next->table, constraints);
+    keys = (AK_reference_key *) AK_malloc((con_num > 0 ? num_rows : 1) * sizeof (AK_reference_key));
+    values = (struct list_node *) AK_malloc(sizeof (struct list_node));
+    AK_Init_L3(&values);
+    for (c = 0; c < con_num; c++) {
+        reference = AK_get_reference(rows[0]->next->table, constraints[c]);
+        num_keys = 0;
+        for (i = 0; i < num_rows; i++) {
+            AK_DeleteAll_L3(&values);
+            keys[num_keys].size = AK_reference_values(rows[i], &reference, values) == EXIT_SUCCESS ?
+                AK_btree_make_key(values, keys[num_keys].key) : EXIT_ERROR;
+            keys[num_keys].row = i;
+            if (keys[num_keys].size != EXIT_ERROR)
+                num_keys++;
+            //rows with a null in the foreign key are checked one by one
+            else if ((*violation < 0 || i < *violation) && AK_reference_check_one(rows[i], &reference) == EXIT_ERROR)
+                *violation = i;
+        }
+        qsort(keys, num_keys, sizeof (AK_reference_key), AK_reference_key_compare);
+        for (i = 0; i < num_keys; i = j) {
+            //the first row of a group has the smallest number
+            for (j = i + 1; j < num_keys && keys[j].size == keys[i].size &&
+                 memcmp(keys[j].key, keys[i].key, keys[i].size) == 0; j++)
+                ;
+            if ((*violation < 0 || keys[i].row < *violation) &&
+                AK_reference_check_one(rows[keys[i].row], &reference) == EXIT_ERROR)
+                *violation = keys[i].row;
         }
     }
+    AK_DeleteAll_L3(&values);
+    AK_free(values);
+    AK_free(keys);
     AK_EPI;
-    return EXIT_ERROR;
+    return *violation < 0 ? EXIT_SUCCESS : EXIT_ERROR;
 }
 
 /**
@@ -488,6 +728,25 @@ TestResult AK_reference_test() {
     AK_print_table("AK_reference");
     AK_print_table("student");
 
+    int passed = 0, failed = 0;
+    int positions[2], violation;
+    char indexName[MAX_ATT_NAME];
+
+    //both tables got an index on the attributes of the reference
+    positions[0] = AK_get_attr_index("student", "mbr");
+    positions[1] = AK_get_attr_index("student", "firstname");
+    if (AK_btree_find_index("student", positions, 2, indexName) >= 2) {
+        positions[0] = AK_get_attr_index("ref_test", "FK");
+        positions[1] = AK_get_attr_index("ref_test", "Value");
+    }
+    if (AK_btree_find_index("ref_test", positions, 2, indexName) >= 2) {
+        passed++;
+        printf("\nIndices of the reference were created\n");
+    } else {
+        failed++;
+        printf("\nIndices of the reference are missing\n");
+    }
+
     a = 35891;
     
     struct list_node *row_root = (struct list_node *) AK_malloc(sizeof (struct list_node));
@@ -496,30 +755,78 @@ TestResult AK_reference_test() {
     AK_Insert_New_Element(TYPE_INT, &a, "ref_test", "FK", row_root);
     AK_Insert_New_Element(TYPE_VARCHAR, "Dude", "ref_test", "Value", row_root);
     AK_Insert_New_Element(TYPE_VARCHAR, "TheRippah", "ref_test", "Rnd", row_root);
-    AK_insert_row(row_root);
+    if (AK_insert_row(row_root) == EXIT_ERROR)
+        passed++;
+    else
+        failed++;
 
     a = 35891;
     
       
-    AK_DeleteAll_L3(row_root);
+    AK_DeleteAll_L3(&row_root);
     AK_Insert_New_Element(TYPE_INT, &a, "ref_test", "FK", row_root);
     AK_Insert_New_Element(TYPE_VARCHAR, "Mislav", "ref_test", "Value", row_root);
     AK_Insert_New_Element(TYPE_VARCHAR, "TheMutilator", "ref_test", "Rnd", row_root);
-    AK_insert_row(row_root);
+    if (AK_insert_row(row_root) == EXIT_ERROR)
+        passed++;
+    else
+        failed++;
 
     a = 35893;
       
-    AK_DeleteAll_L3(row_root);
+    AK_DeleteAll_L3(&row_root);
     AK_Insert_New_Element(TYPE_INT, &a, "ref_test", "FK", row_root);
     AK_Insert_New_Element(TYPE_VARCHAR, "Mislav", "ref_test", "Value", row_root);
     AK_Insert_New_Element(TYPE_VARCHAR, "TheMutilator", "ref_test", "Rnd", row_root);
-    AK_insert_row(row_root);
+    if (AK_insert_row(row_root) == EXIT_SUCCESS)
+        passed++;
+    else
+        failed++;
 
     AK_print_table("ref_test");
 
+    //a batch where rows 0 and 2 share their parent and row 3 has none
+    struct list_node *batch[4];
+    int batch_fk[4] = {35891, 35893, 35891, 35892};
+    char *batch_value[4] = {"Dino", "Mislav", "Dino", "Nobody"};
+    for (a = 0; a < 4; a++) {
+        batch[a] = (struct list_node *) AK_malloc(sizeof (struct list_node));
+        AK_Init_L3(&batch[a]);
+        AK_Insert_New_Element(TYPE_INT, &batch_fk[a], "ref_test", "FK", batch[a]);
+        AK_Insert_New_Element(TYPE_VARCHAR, batch_value[a], "ref_test", "Value", batch[a]);
+    }
+    if (AK_reference_check_entries(batch, 3, &violation) == EXIT_SUCCESS && violation == -1 &&
+        AK_reference_check_entries(batch, 4, &violation) == EXIT_ERROR && violation == 3) {
+        passed++;
+        printf("\nBatch check found the row without a parent\n");
+    } else {
+        failed++;
+        printf("\nBatch check failed, violation %d\n", violation);
+    }
+    for (a = 0; a < 4; a++) {
+        AK_DeleteAll_L3(&batch[a]);
+        AK_free(batch[a]);
+    }
+
+    //the delete finds the child row through the index of the reference
+    a = 35893;
+    AK_DeleteAll_L3(&row_root);
+    AK_Update_Existing_Element(TYPE_INT, &a, "ref_test", "FK", row_root);
+    AK_Update_Existing_Element(TYPE_VARCHAR, "Mislav", "ref_test", "Value", row_root);
+    AK_delete_row(row_root);
+    AK_DeleteAll_L3(&row_root);
+    AK_free(row_root);
+    if (AK_get_num_records("ref_test") == 0) {
+        passed++;
+        printf("\nChild row was deleted\n");
+    } else {
+        failed++;
+        printf("\nChild row was not deleted\n");
+    }
+
     AK_print_table("student");
     AK_print_table("ref_test");
     AK_EPI;
 
-    return TEST_result(0,1);
+    return TEST_result(passed, failed);
 }
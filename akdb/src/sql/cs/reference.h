@@ -24,6 +24,7 @@
 #include "../../dm/dbman.h"
 #include "../../file/table.h"
 #include "../../auxi/mempro.h"
+#include <ctype.h>
 /**
  * @def REF_TYPE_NONE
  * @brief Constant declaring none reference type 
@@ -81,8 +82,10 @@ typedef struct {
 } AK_ref_item;
 
 /**
- * @author Dejan Frankovic
+ * @author Dejan Frankovic, updated by Karlo Vuković (indices of the reference)
  * @brief Function that adds a reference for a group of attributes over a given table to a group of attributes over another table with a given constraint name.
+ *        B+tree indices on the attributes of both tables are created with the reference, unless the tables already have them,
+ *        so new rows of the child table find their parent rows and changes of the parent table find their child rows without reading the tables.
  * @param name of the child table
  * @param array of child table attribute names (foreign key attributes)
  * @param name of the parent table
@@ -90,7 +93,7 @@ typedef struct {
  * @param number of attributes in foreign key
  * @param name of the constraint
  * @param type of the constraint, constants defined in 'reference.h'
- * @return EXIT_SUCCESS
+ * @return EXIT_SUCCESS, EXIT_ERROR if the child table already has a reference with the name
  */
 int AK_add_reference(char *childTable, char *childAttNames[], char *parentTable, char *parentAttNames[], int attNum, char *constraintName, int type) ;
 
@@ -103,8 +106,9 @@ int AK_add_reference(char *childTable, char *childAttNames[], char *parentTable,
  */
 AK_ref_item AK_get_reference(char *tableName, char *constraintName) ;
 /**
- * @author Dejan Frankovic
- * @brief Function that checks referential integrity for one attribute
+ * @author Dejan Frankovic, updated by Karlo Vuković (Bloom filters)
+ * @brief Function that checks referential integrity for one attribute. A value that Bloom filters of the parent
+ *        attribute do not hold fails without reading the parent table.
  * @param child table name
  * @param attribute name (foreign key attribute)
  * @param value of the attribute we're checking
@@ -137,8 +141,10 @@ int AK_reference_check_if_update_needed(struct list_node *lista, int action) ;
 int AK_reference_check_restricion(struct list_node *lista, int action) ;
 
 /**
- * @author Dejan Franković
- * @brief Function that updates child table entries according to ongoing update of parent table entries.
+ * @author Dejan Franković, updated by Karlo Vuković (indices)
+ * @brief Function that updates child table entries according to ongoing update of parent table entries. Child rows of
+ *        each parent row are updated or deleted with AK_update_row and AK_delete_row, which find them through the
+ *        index on the attributes of the child table that AK_add_reference creates.
  * @param list of elements for update
  * @param is action UPDATE or DELETE ?
  * @return EXIT_SUCCESS
@@ -146,13 +152,27 @@ int AK_reference_check_restricion(struct list_node *lista, int action) ;
 int AK_reference_update(struct list_node *lista, int action) ;
 
 /**
- * @author Dejan Franković
- * @brief Function that checks a new entry for referential integrity.
+ * @author Dejan Franković, updated by Karlo Vuković (Bloom filters, indices)
+ * @brief Function that checks a new entry for referential integrity. Values of each reference of the table are
+ *        searched in a B+tree index on the parent attributes when there is one. Otherwise rows of the parent table are
+ *        not read for a reference whose values Bloom filters of the parent attributes do not hold.
  * @param list of elements for insert row
  * @return EXIT_SUCCESS if referential integrity is ok, EXIT_ERROR if it is compromised
  */
 int AK_reference_check_entry(struct list_node *lista) ;
 
+/**
+ * @author Karlo Vuković
+ * @brief Function that checks a batch of new rows of one table for referential integrity. AK_reference is read once
+ *        for the batch, and for each reference rows with the same values of the foreign key are checked together,
+ *        so a value that many rows of a bulk load share is looked up in the parent table once.
+ * @param rows array of rows, each one a list of elements
+ * @param num_rows number of rows in the array
+ * @param violation number of the first row that compromises referential integrity, -1 if there is none
+ * @return EXIT_SUCCESS if referential integrity of all rows is ok, EXIT_ERROR otherwise
+ */
+int AK_reference_check_entries(struct list_node **rows, int num_rows, int *violation);
+
 TestResult AK_reference_test();
 /*
 void AK_Insert_New_Element(int newtype, void * data, char * table, char * attribute_name, AK_list_elem ElementBefore);
@@ -20,8 +20,152 @@
 #include "unique.h"
 
 /**
- * @author Domagoj Tuličić, updated by Nenad Makar 
- * @brief Function that sets unique constraint on attribute(s)
+ * @author Karlo Vuković
+ * @brief Function that makes the name of the B+tree index behind a UNIQUE constraint
+ * @param constraintName name of the constraint
+ * @param indexName name of the index, MAX_ATT_NAME characters
+ * @return No return value
+ */
+static void AK_unique_index_name(char *constraintName, char *indexName) {
+	int i;
+
+	//the name of the index becomes the name of its segment and of the tables its build uses
+	for (i = 0; constraintName[i] != '\0' && i < MAX_ATT_NAME / 2; i++)
+		indexName[i] = isalnum((unsigned char) constraintName[i]) ? constraintName[i] : '_';
+	strcpy(indexName + i, "_unique_index");
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that creates the B+tree index behind a UNIQUE constraint, with a key on the attributes of the
+ *        constraint in their order. Tables of the system catalog, tables with the PAX layout and constraints on more
+ *        than BTREE_MAX_KEYS attributes get no index, they are checked by reading the table.
+ * @param tableName name of table
+ * @param attName name(s) of attribute(s) separated with SEPARATOR
+ * @param constraintName name of constraint
+ * @return EXIT_SUCCESS if the index was created or is not needed, EXIT_ERROR otherwise
+ */
+static int AK_unique_create_index(char *tableName, char attName[], char constraintName[]) {
+	char attNameCopy[MAX_VARCHAR_LENGTH], indexName[MAX_ATT_NAME];
+	char *nameOfOneAtt;
+	struct list_node *attributes;
+	int numOfAtts = 0, result = EXIT_SUCCESS;
+
+	if (strncmp(tableName, "AK_", 3) == 0 || AK_get_storage_layout(tableName) != BLOCK_TYPE_NORMAL)
+		return EXIT_SUCCESS;
+	attributes = (struct list_node *) AK_malloc(sizeof (struct list_node));
+	AK_Init_L3(&attributes);
+	strncpy(attNameCopy, attName, sizeof(attNameCopy) - 1);
+	attNameCopy[sizeof(attNameCopy) - 1] = '\0';
+	for (nameOfOneAtt = strtok(attNameCopy, SEPARATOR); nameOfOneAtt != NULL; nameOfOneAtt = strtok(NULL, SEPARATOR), numOfAtts++)
+		AK_InsertAtEnd_L3(TYPE_ATTRIBS, nameOfOneAtt, strlen(nameOfOneAtt), attributes);
+	if (numOfAtts > 0 && numOfAtts <= BTREE_MAX_KEYS) {
+		AK_unique_index_name(constraintName, indexName);
+		//an index left behind by a constraint with the same name
+		AK_btree_delete(indexName);
+		result = AK_btree_create_composite(tableName, attributes, numOfAtts, indexName);
+	}
+	AK_DeleteAll_L3(&attributes);
+	AK_free(attributes);
+	return result;
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that converts a value of a UNIQUE check, written as AK_tuple_to_string writes it, into the
+ *        way the attribute is stored
+ * @param type type of the attribute
+ * @param text value as a string
+ * @param value buffer for the value, MAX_VARCHAR_LENGTH bytes
+ * @return size of the value, -1 if the type is not supported or the string is not a value of the type
+ */
+static int AK_unique_parse(int type, char *text, char *value) {
+	char *end;
+	long integer;
+	int number;
+	float real;
+	double big;
+
+	errno = 0;
+	switch (type) {
+		case TYPE_INT:
+			integer = strtol(text, &end, 10);
+			if (end == text || *end != '\0' || errno != 0 || integer < INT_MIN || integer > INT_MAX)
+				return -1;
+			number = (int) integer;
+			memcpy(value, &number, sizeof (int));
+			return sizeof (int);
+		case TYPE_FLOAT:
+			real = strtof(text, &end);
+			if (end == text || *end != '\0' || errno != 0)
+				return -1;
+			memcpy(value, &real, sizeof (float));
+			return sizeof (float);
+		case TYPE_NUMBER:
+			big = strtod(text, &end);
+			if (end == text || *end != '\0' || errno != 0)
+				return -1;
+			memcpy(value, &big, sizeof (double));
+			return sizeof (double);
+		case TYPE_VARCHAR:
+			number = strnlen(text, MAX_VARCHAR_LENGTH - 1);
+			memcpy(value, text, number);
+			return number;
+		default:
+			return -1;
+	}
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that looks for values of attributes in a B+tree index whose key starts with these attributes, in
+ *        their order, so a check of a UNIQUE constraint reads a few pages instead of the whole table
+ * @param tableName name of table
+ * @param names names of the attributes
+ * @param values values of the attributes, as strings
+ * @param numOfAtts number of attributes
+ * @return 1 if a row has the values, 0 if no row has them, -1 if there is no such index or a value can not be
+ *         looked up in it. Strings of float and number values are rounded, so a value that is not found is looked
+ *         for by the scan that compares the strings.
+ */
+static int AK_unique_index_probe(char *tableName, char names[][MAX_VARCHAR_LENGTH], char values[][MAX_VARCHAR_LENGTH], int numOfAtts) {
+	AK_header *header;
+	struct list_node *keyValues;
+	char value[MAX_VARCHAR_LENGTH];
+	int positions[BTREE_MAX_KEYS];
+	int j, size, rounded = 0, found = -1;
+
+	if (numOfAtts < 1 || numOfAtts > BTREE_MAX_KEYS)
+		return -1;
+	for (j = 0; j < numOfAtts; j++) {
+		positions[j] = AK_get_attr_index(tableName, names[j]);
+		if (positions[j] < 0)
+			return -1;
+	}
+
+	header = (AK_header *) AK_get_header(tableName);
+	keyValues = (struct list_node *) AK_malloc(sizeof (struct list_node));
+	AK_Init_L3(&keyValues);
+	for (j = 0; j < numOfAtts; j++) {
+		size = AK_unique_parse(header[positions[j]].type, values[j], value);
+		if (size < 0)
+			break;
+		AK_InsertAtEnd_L3(header[positions[j]].type, value, size, keyValues);
+		if (header[positions[j]].type == TYPE_FLOAT || header[positions[j]].type == TYPE_NUMBER)
+			rounded = 1;
+	}
+	if (j == numOfAtts)
+		found = AK_btree_lookup(tableName, positions, keyValues, numOfAtts, NULL, 0);
+	AK_DeleteAll_L3(&keyValues);
+	AK_free(keyValues);
+	AK_free(header);
+	return found < 0 || (found == 0 && rounded) ? -1 : found > 0;
+}
+
+/**
+ * @author Domagoj Tuličić, updated by Nenad Makar, updated by Karlo Vuković (index of the constraint)
+ * @brief Function that sets unique constraint on attribute(s). A B+tree index with a key on the attribute(s) is
+	created with the constraint, so checks of new values search it instead of reading the table.
  * @param char* tableName name of table
  * @param char attName[] name(s) of attribute(s), if you want to set UNIQUE constraint on combination of attributes seperate their names with constant SEPARATOR (see test)
  * @param char constraintName[] name of constraint
@@ -160,14 +304,19 @@ int AK_set_constraint_unique(char* tableName, char attName[], char constraintNam
 	AK_insert_row(row_root);
 	AK_DeleteAll_L3(&row_root);
 	AK_free(row_root);
+	//without the index values are checked by reading the table
+	if (AK_unique_create_index(tableName, attName, constraintName) == EXIT_ERROR)
+		printf("\nUNIQUE constraint %s has no index, its values are checked by reading table %s\n", constraintName, tableName);
 	printf("\nUNIQUE constraint is set on (combination of) attribute(s): %s\nof table: %s\n\n", attName, tableName);
 	AK_EPI;
 	return EXIT_SUCCESS;
 }
 
 /**
- * @author Domagoj Tuličić, updated by Nenad Makar 
- * @brief Function that checks if the insertion of some value(s) would violate the UNIQUE constraint
+ * @author Domagoj Tuličić, updated by Nenad Makar, updated by Karlo Vuković (Bloom filters, index of the constraint)
+ * @brief Function that checks if the insertion of some value(s) would violate the UNIQUE constraint. Rows are not read
+	when Bloom filters of an attribute show that its new value is not in the table, and the values are searched in
+	the index of the constraint when the table has one.
  * @param char* tableName name of table
  * @param char attName[] name(s) of attribute(s), if you want to check combination of values of more attributes seperate names of attributes with constant SEPARATOR (see test)
  * @param char newValue[] new value(s), if you want to check combination of values of more attributes seperate their values with constant SEPARATOR (see test),
@@ -286,6 +435,23 @@ int AK_read_constraint_unique(char* tableName, char attName[], char newValue[]){
 						value2 = strtok(NULL, SEPARATOR);
 					}
 
+					//a value that Bloom filters of its attribute do not hold can not be repeated
+					for(impoIndexInArray=0; (impoIndexInArray<numOfImpAttPos)&&(impoIndexInArray<index); impoIndexInArray++)
+					{
+						if(!AK_bloom_filter_may_contain_text(table->data, namesOfAtts[impoIndexInArray], values[impoIndexInArray]))
+						{
+							AK_EPI;
+							return EXIT_SUCCESS;
+						}
+					}
+
+					//the index of the constraint finds the values with one search
+					match = index >= numOfImpAttPos ? AK_unique_index_probe(table->data, namesOfAtts, values, numOfImpAttPos) : -1;
+					if(match >= 0)
+					{
+						AK_EPI;
+						return match == 1 ? EXIT_ERROR : EXIT_SUCCESS;
+					}
 					
 					for(h=0; h<numRows; h++)
 					{
@@ -410,8 +576,103 @@ int AK_read_constraint_unique(char* tableName, char attName[], char newValue[]){
 }
  
 /**
- * @author Blaž Rajič, updated by Bruno Pilošta
- * @brief Function for deleting specific unique constraint
+ * @author Karlo Vuković
+ * @brief Function that writes the value of an element of a row as AK_read_constraint_unique expects it
+ * @param el element of the row
+ * @param value buffer for the value, MAX_VARCHAR_LENGTH characters
+ * @return No return value
+ */
+static void AK_unique_element_value(struct list_node *el, char *value) {
+	int integer;
+	float real;
+	double big;
+
+	switch (el->type) {
+		case TYPE_INT:
+			memcpy(&integer, el->data, sizeof (int));
+			snprintf(value, MAX_VARCHAR_LENGTH, "%d", integer);
+			break;
+		case TYPE_FLOAT:
+			memcpy(&real, el->data, sizeof (float));
+			snprintf(value, MAX_VARCHAR_LENGTH, "%f", real);
+			break;
+		case TYPE_NUMBER:
+			memcpy(&big, el->data, sizeof (double));
+			snprintf(value, MAX_VARCHAR_LENGTH, "%f", big);
+			break;
+		default:
+			snprintf(value, MAX_VARCHAR_LENGTH, "%s", el->data);
+			break;
+	}
+}
+
+/**
+ * @author Karlo Vuković
+ * @brief Function that checks a new row, or new values of an update, against UNIQUE constraints of its table. Values
+	of attributes of a constraint are taken from new values of the row, or from search constraints of an update for
+	attributes it does not change, and an attribute without a value is NULL. The values are checked with
+	AK_read_constraint_unique, which searches the index of the constraint. Constraints none of whose attributes get
+	a new value and tables of the system catalog are not checked.
+ * @param row_root elements of one row
+ * @return EXIT_SUCCESS if no UNIQUE constraint is violated, EXIT_ERROR otherwise
+ */
+int AK_unique_check_entry(struct list_node *row_root) {
+	struct list_node *first, *el, *row, *table, *attribute, *found;
+	char attNameCopy[MAX_VARCHAR_LENGTH], values[MAX_VARCHAR_LENGTH], value[MAX_VARCHAR_LENGTH];
+	char *nameOfOneAtt;
+	int i, numRecords, numOfValues, numNew, result = EXIT_SUCCESS;
+	AK_PRO;
+
+	first = (struct list_node *) AK_First_L2(row_root);
+	if (first == NULL || strncmp(first->table, "AK_", 3) == 0) {
+		AK_EPI;
+		return EXIT_SUCCESS;
+	}
+
+	numRecords = AK_get_num_records("AK_constraints_unique");
+	for (i = 0; i < numRecords && result == EXIT_SUCCESS; i++) {
+		row = AK_get_row(i, "AK_constraints_unique");
+		table = AK_GetNth_L2(2, row);
+		attribute = AK_GetNth_L2(4, row);
+		if (table != NULL && attribute != NULL && strcmp(table->data, first->table) == 0) {
+			memset(values, 0, MAX_VARCHAR_LENGTH);
+			strncpy(attNameCopy, attribute->data, MAX_VARCHAR_LENGTH - 1);
+			attNameCopy[MAX_VARCHAR_LENGTH - 1] = '\0';
+			numOfValues = 0;
+			numNew = 0;
+			for (nameOfOneAtt = strtok(attNameCopy, SEPARATOR); nameOfOneAtt != NULL; nameOfOneAtt = strtok(NULL, SEPARATOR)) {
+				//a new value of the attribute, otherwise the value its rows are searched by
+				found = NULL;
+				for (el = first; el != NULL; el = el->next) {
+					if (strcmp(el->attribute_name, nameOfOneAtt) == 0 && (found == NULL || el->constraint == NEW_VALUE))
+						found = el;
+				}
+				if (found != NULL && found->constraint == NEW_VALUE)
+					numNew++;
+				if (found != NULL)
+					AK_unique_element_value(found, value);
+				else
+					strcpy(value, " ");
+				if (numOfValues++ > 0)
+					strncat(values, SEPARATOR, MAX_VARCHAR_LENGTH - strlen(values) - 1);
+				strncat(values, value, MAX_VARCHAR_LENGTH - strlen(values) - 1);
+			}
+			if (numNew > 0 && AK_read_constraint_unique(first->table, attribute->data, values) == EXIT_ERROR) {
+				printf("Values %s of attribute(s) %s of table %s violate UNIQUE constraint %s\n", values, attribute->data, first->table, (char *) AK_GetNth_L2(3, row)->data);
+				result = EXIT_ERROR;
+			}
+		}
+		AK_DeleteAll_L3(&row);
+		AK_free(row);
+	}
+
+	AK_EPI;
+	return result;
+}
+
+/**
+ * @author Blaž Rajič, updated by Bruno Pilošta, updated by Karlo Vuković (index of the constraint)
+ * @brief Function for deleting specific unique constraint and its index
  * @param tableName name of table on which constraint refers
  * @param constraintName name of constraint 
  * @return EXIT_SUCCESS when constraint is deleted, else EXIT_ERROR
@@ -420,6 +681,7 @@ int AK_delete_constraint_unique(char* tableName, char* constraintName){
     AK_PRO;
 
     char* constraint_attr = "constraintName";
+    char indexName[MAX_ATT_NAME];
 
     if(AK_check_constraint_name(constraintName, AK_CONSTRAINTS_UNIQUE) == EXIT_SUCCESS){
         printf("FAILURE! -- CONSTRAINT with name %s doesn't exist in TABLE %s", constraintName, tableName);
@@ -435,6 +697,10 @@ int AK_delete_constraint_unique(char* tableName, char* constraintName){
     AK_DeleteAll_L3(&row_root);
 	AK_free(row_root);    
 
+    //constraints on tables of the system catalog have no index
+    AK_unique_index_name(constraintName, indexName);
+    AK_btree_delete(indexName);
+
     AK_EPI;
 
     return result;
@@ -795,6 +1061,130 @@ TestResult AK_unique_test() {
 	
 	
 
+	printf("\n============== Running Test #15 ==============\n");
+	printf("\nChecking values of the first row of table %s through the indices of constraints %s and %s...\n\n", tableName, constraintMbr, constraintName1);
+	struct list_node *firstRow = AK_get_row(0, tableName);
+	char *firstMbr = AK_tuple_to_string(AK_GetNth_L2(AK_get_attr_index(tableName, "mbr") + 1, firstRow));
+	char *firstLastname = AK_tuple_to_string(AK_GetNth_L2(AK_get_attr_index(tableName, "lastname") + 1, firstRow));
+	char indexName[MAX_ATT_NAME];
+	AK_btree_meta meta;
+	AK_unique_index_name(constraintMbr, indexName);
+	result = AK_btree_get_meta(indexName, &meta) == EXIT_SUCCESS && meta.num_keys == 1 &&
+		AK_read_constraint_unique(tableName, attNames3, firstMbr) == EXIT_ERROR &&
+		AK_read_constraint_unique(tableName, attNames3, "99999999") == EXIT_SUCCESS;
+	AK_unique_index_name(constraintName1, indexName);
+	memset(newValue11, 0, MAX_VARCHAR_LENGTH);
+	snprintf(newValue11, MAX_VARCHAR_LENGTH, "%s%s%s", firstMbr, SEPARATOR, firstLastname);
+	result = result && AK_btree_get_meta(indexName, &meta) == EXIT_SUCCESS && meta.num_keys == 2 &&
+		AK_read_constraint_unique(tableName, attNames1, newValue11) == EXIT_ERROR;
+	snprintf(newValue11, MAX_VARCHAR_LENGTH, "%s%s%s", firstMbr, SEPARATOR, "Nobody");
+	result = result && AK_read_constraint_unique(tableName, attNames1, newValue11) == EXIT_SUCCESS;
+	AK_free(firstMbr);
+	AK_free(firstLastname);
+	AK_DeleteAll_L3(&firstRow);
+	AK_free(firstRow);
+	if(result)
+	{
+		success++;
+		printf("\nSUCCESS\n\n");
+	}
+	else
+	{
+		failed++;
+		printf("\nFAILED\n\n");
+	}
+
+	printf("\n============== Running Test #16 ==============\n");
+	printf("\nChecking a float value that its string rounds through the index of a constraint...\n\n");
+	char *floatTable = "unique_float_test";
+	char floatConstraint[] = "uniqueFloatValue";
+	AK_header floatHeader[3] = {
+		{TYPE_INT, "id", {0}, {{'\0'}}, {{'\0'}}},
+		{TYPE_FLOAT, "value", {0}, {{'\0'}}, {{'\0'}}},
+		{0, {'\0'}, {0}, {{'\0'}}, {{'\0'}}}};
+	struct list_node *floatRow = (struct list_node *) AK_malloc(sizeof (struct list_node));
+	//float entries are as large as a double, which AK_tuple_to_string prints with six decimals
+	double floats[2] = {1.2345678, 2.5};
+	int floatId;
+	if (AK_num_attr(floatTable) > 0)
+		AK_delete_segment(floatTable, SEGMENT_TYPE_TABLE);
+	AK_initialize_new_segment(floatTable, SEGMENT_TYPE_TABLE, floatHeader);
+	AK_Init_L3(&floatRow);
+	for (floatId = 0; floatId < 2; floatId++)
+	{
+		AK_DeleteAll_L3(&floatRow);
+		AK_Insert_New_Element(TYPE_INT, &floatId, floatTable, "id", floatRow);
+		AK_Insert_New_Element(TYPE_FLOAT, &floats[floatId], floatTable, "value", floatRow);
+		AK_insert_row(floatRow);
+	}
+	AK_DeleteAll_L3(&floatRow);
+	AK_free(floatRow);
+	result = AK_set_constraint_unique(floatTable, "value", floatConstraint) == EXIT_SUCCESS;
+	firstRow = AK_get_row(0, floatTable);
+	char *firstFloat = AK_tuple_to_string(AK_GetNth_L2(2, firstRow));
+	result = result && AK_read_constraint_unique(floatTable, "value", firstFloat) == EXIT_ERROR &&
+		AK_read_constraint_unique(floatTable, "value", "3.250000") == EXIT_SUCCESS;
+	printf("\nValue %s is found as a duplicate: %s\n", firstFloat, result ? "yes" : "no");
+	AK_free(firstFloat);
+	AK_DeleteAll_L3(&firstRow);
+	AK_free(firstRow);
+	AK_delete_constraint_unique("AK_constraints_unique", floatConstraint);
+	AK_delete_segment(floatTable, SEGMENT_TYPE_TABLE);
+	if(result)
+	{
+		success++;
+		printf("\nSUCCESS\n\n");
+	}
+	else
+	{
+		failed++;
+		printf("\nFAILED\n\n");
+	}
+
+	printf("\n============== Running Test #17 ==============\n");
+	printf("\nTrying to insert and update rows of table %s that would repeat a value of UNIQUE attribute mbr...\n\n", tableName);
+	struct list_node *row_root = (struct list_node *) AK_malloc(sizeof (struct list_node));
+	AK_Init_L3(&row_root);
+	int numRows = AK_get_num_records(tableName);
+	int uniqueMbr = 99999999, uniqueYear = 9999;
+	float uniqueWeight = 1.0;
+	firstRow = AK_get_row(0, tableName);
+	int repeatedMbr = *((int *) AK_GetNth_L2(AK_get_attr_index(tableName, "mbr") + 1, firstRow)->data);
+	AK_DeleteAll_L3(&firstRow);
+	AK_free(firstRow);
+	AK_Insert_New_Element(TYPE_INT, &repeatedMbr, tableName, "mbr", row_root);
+	AK_Insert_New_Element(TYPE_VARCHAR, "Unique", tableName, "firstname", row_root);
+	AK_Insert_New_Element(TYPE_VARCHAR, "Tester", tableName, "lastname", row_root);
+	AK_Insert_New_Element(TYPE_INT, &uniqueYear, tableName, "year", row_root);
+	AK_Insert_New_Element(TYPE_FLOAT, &uniqueWeight, tableName, "weight", row_root);
+	result = AK_insert_row(row_root) == EXIT_ERROR && AK_get_num_records(tableName) == numRows;
+	AK_DeleteAll_L3(&row_root);
+	AK_Insert_New_Element(TYPE_INT, &uniqueMbr, tableName, "mbr", row_root);
+	AK_Insert_New_Element(TYPE_VARCHAR, "Unique", tableName, "firstname", row_root);
+	AK_Insert_New_Element(TYPE_VARCHAR, "Tester", tableName, "lastname", row_root);
+	AK_Insert_New_Element(TYPE_INT, &uniqueYear, tableName, "year", row_root);
+	AK_Insert_New_Element(TYPE_FLOAT, &uniqueWeight, tableName, "weight", row_root);
+	result = result && AK_insert_row(row_root) == EXIT_SUCCESS && AK_get_num_records(tableName) == numRows + 1;
+	AK_DeleteAll_L3(&row_root);
+	AK_Update_Existing_Element(TYPE_INT, &uniqueMbr, tableName, "mbr", row_root);
+	AK_Insert_New_Element(TYPE_INT, &repeatedMbr, tableName, "mbr", row_root);
+	result = result && AK_update_row(row_root) == EXIT_ERROR && AK_read_constraint_unique(tableName, attNames3, "99999999") == EXIT_ERROR;
+	AK_DeleteAll_L3(&row_root);
+	AK_Update_Existing_Element(TYPE_INT, &uniqueMbr, tableName, "mbr", row_root);
+	AK_delete_row(row_root);
+	AK_DeleteAll_L3(&row_root);
+	AK_free(row_root);
+	if(result)
+	{
+		success++;
+		printf("\nSUCCESS\n\n");
+	}
+	else
+	{
+		failed++;
+		printf("\nFAILED\n\n");
+	}
+
 	printf("\n============== Running Test DELETE ==============\n");
 	printf("\nTrying to set delete all existing UNIQUE constraints ...\n\n");
 	int delete1 = AK_delete_constraint_unique("AK_constraints_unique", constraintMbr);
@@ -819,6 +1209,19 @@ TestResult AK_unique_test() {
 		printf("\nFAILED\n\n");
 		printf("One or two UNIQUE constraints not deleted successfully\n");
 	}
+
+	//indices of deleted constraints are gone
+	AK_unique_index_name(constraintMbr, indexName);
+	if (AK_btree_get_meta(indexName, &meta) == EXIT_ERROR)
+	{
+		success++;
+		printf("\nIndex of constraint %s was deleted with it\n\n", constraintMbr);
+	}
+	else
+	{
+		failed++;
+		printf("\nIndex of constraint %s was not deleted\n\n", constraintMbr);
+	}
 	
 	AK_print_table("AK_constraints_unique");
 	AK_EPI;
@@ -26,10 +26,16 @@
 #include "../../auxi/mempro.h"
 #include "../../auxi/dictionary.h"
 #include "constraint_names.h"
+#include "../../file/idx/bloom.h"
+#include "../../file/idx/btree.h"
+#include <ctype.h>
+#include <errno.h>
+#include <limits.h>
 
 /**
- * @author Domagoj Tuličić, updated by Nenad Makar 
- * @brief Function that sets unique constraint on attribute(s)
+ * @author Domagoj Tuličić, updated by Nenad Makar, updated by Karlo Vuković (index of the constraint)
+ * @brief Function that sets unique constraint on attribute(s). A B+tree index with a key on the attribute(s) is
+	created with the constraint, so checks of new values search it instead of reading the table.
  * @param char* tableName name of table
  * @param char attName[] name(s) of attribute(s), if you want to set UNIQUE constraint on combination of attributes seperate their names with constant SEPARATOR (see test)
  * @param char constraintName[] name of constraint
@@ -38,8 +44,10 @@
 int AK_set_constraint_unique(char* tableName, char attName[], char constraintName[]);
 
 /**
- * @author Domagoj Tuličić, updated by Nenad Makar 
- * @brief Function that checks if the insertion of some value(s) would violate the UNIQUE constraint
+ * @author Domagoj Tuličić, updated by Nenad Makar, updated by Karlo Vuković (Bloom filters, index of the constraint)
+ * @brief Function that checks if the insertion of some value(s) would violate the UNIQUE constraint. Rows are not read
+	when Bloom filters of an attribute show that its new value is not in the table, and the values are searched in
+	the index of the constraint when the table has one.
  * @param char* tableName name of table
  * @param char attName[] name(s) of attribute(s), if you want to check combination of values of more attributes seperate names of attributes with constant SEPARATOR (see test)
  * @param char newValue[] new value(s)
@@ -48,8 +56,20 @@ int AK_set_constraint_unique(char* tableName, char attName[], char constraintNam
 int AK_read_constraint_unique(char* tableName, char attName[], char newValue[]);
 
 /**
- * @author Maja Vračan, updated by Blaž Rajič
- * @brief Function for deleting specific unique constraint
+ * @author Karlo Vuković
+ * @brief Function that checks a new row, or new values of an update, against UNIQUE constraints of its table. Values
+	of attributes of a constraint are taken from new values of the row, or from search constraints of an update for
+	attributes it does not change, and an attribute without a value is NULL. The values are checked with
+	AK_read_constraint_unique, which searches the index of the constraint. Constraints none of whose attributes get
+	a new value and tables of the system catalog are not checked.
+ * @param row_root elements of one row
+ * @return EXIT_SUCCESS if no UNIQUE constraint is violated, EXIT_ERROR otherwise
+ */
+int AK_unique_check_entry(struct list_node *row_root);
+
+/**
+ * @author Maja Vračan, updated by Blaž Rajič, updated by Karlo Vuković (index of the constraint)
+ * @brief Function for deleting specific unique constraint and its index
  * @param tableName name of table on which constraint refers
  * @param constraintName name of constraint 
  * @return EXIT_SUCCESS when constraint is deleted, else EXIT_ERROR
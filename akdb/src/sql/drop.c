@@ -96,8 +96,8 @@ int AK_drop(int type, AK_drop_arguments *drop_arguments) {
 }
 
 /**
- * @author Fran Turković, updated by Andrej Hrebak Pajk
- * @brief Drop function that deletes specific table
+ * @author Fran Turković, updated by Andrej Hrebak Pajk, updated by Karlo Vuković (Bloom filters)
+ * @brief Drop function that deletes specific table and its Bloom filters
  * @param drop_arguments arguments of DROP command
  */
 int AK_drop_table(AK_drop_arguments *drop_arguments){
@@ -115,6 +115,7 @@ int AK_drop_table(AK_drop_arguments *drop_arguments){
             }
         }
         
+        AK_bloom_filter_drop_table(name);
         AK_drop_help_function(name, sys_table);
         printf("Table %s dropped!\n", name);
         return EXIT_SUCCESS;    
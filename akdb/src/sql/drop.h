@@ -25,6 +25,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include "../file/table.h"
 #include "../file/fileio.h"
 #include "../file/sequence.h"
+#include "../file/idx/bloom.h"
 #include "view.h"
 #include "trigger.h"
 #include "function.h"
@@ -52,8 +53,8 @@ typedef struct drop_arguments AK_drop_arguments;
 int AK_drop(int type, AK_drop_arguments *drop_arguments);
 
 /**
- * @author Fran Turković
- * @brief Drop function that deletes specific table
+ * @author Fran Turković, updated by Karlo Vuković (Bloom filters)
+ * @brief Drop function that deletes specific table and its Bloom filters
  * @param drop_arguments arguments of DROP command 
  */
 int AK_drop_table(AK_drop_arguments *drop_arguments);
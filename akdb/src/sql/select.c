@@ -39,15 +39,23 @@ int AK_apply_select_by_condition(char *src_table, char *selection_table, struct
 }
 
 /**
- * @author Filip Žmuk, Edited by: Marko Belusic
- * @brief Helper function in SELECT clause which does the ordering
+ * @author Filip Žmuk, Edited by: Marko Belusic, updated by Karlo Vuković (Top-N for LIMIT)
+ * @brief Helper function in SELECT clause which does the ordering. With a limit only the first rows are kept
+ *        with AK_top_n, in a single scan, instead of sorting the whole selection.
  * @param ordering - condition on which to order
  * @param sorted_table - table in which result of applied ordering is stored
  * @param selection_table - table in which result of applied condition is stored
+ * @param limit - largest number of rows in the result, -1 for all rows
+ * @param offset - number of rows skipped before the result
  * @return EXIT_SUCCESS if there was no error ordering
  */
-int AK_apply_select_by_sorting(char *sorted_table, char *selection_table, struct list_node *ordering){
+int AK_apply_select_by_sorting(char *sorted_table, char *selection_table, struct list_node *ordering, int limit, int offset){
     strcat(sorted_table, selection_table);
+    if (limit >= 0)
+    {
+        strcat(sorted_table, "__sorted");
+        return AK_top_n(selection_table, sorted_table, ordering, limit, offset) == EXIT_ERROR ? EXIT_ERROR : EXIT_SUCCESS;
+    }
     //sort required rows
     if (ordering != NULL)
     {
@@ -119,9 +127,11 @@ void AK_clear_projection_attributes(struct list_node *projection_attributes){
  * @param projection_attributes - projected attributes
  * @param sorted_table - temp table for sorting
  * @param ordering - atributes for result sorting
+ * @param limit - largest number of rows in the result, -1 for all rows
+ * @param offset - number of rows skipped before the result
  * @return EXIT_SUCCESS or EXIT_ERROR
  */
-int AK_apply_select(char *srcTable, char *selection_table, struct list_node *condition, struct list_node *attributes, struct list_node *projection_attributes, char *sorted_table, struct list_node *ordering){
+int AK_apply_select(char *srcTable, char *selection_table, struct list_node *condition, struct list_node *attributes, struct list_node *projection_attributes, char *sorted_table, struct list_node *ordering, int limit, int offset){
     if (AK_apply_select_by_condition(srcTable, selection_table, condition) != EXIT_SUCCESS){
         return EXIT_ERROR;
     }
@@ -130,23 +140,25 @@ int AK_apply_select(char *srcTable, char *selection_table, struct list_node *con
     AK_create_copy_of_attributes(attributes, projection_attributes);
 
     //create help table name for sorting
-    if (AK_apply_select_by_sorting(sorted_table, selection_table, ordering) != EXIT_SUCCESS){
+    if (AK_apply_select_by_sorting(sorted_table, selection_table, ordering, limit, offset) != EXIT_SUCCESS){
         return EXIT_ERROR;
     }
     return EXIT_SUCCESS;
 }
 
 /**
- * @author Filip Žmuk, Edited by: Marko Belusic
- * @brief Function that implements SELECT relational operator
+ * @author Filip Žmuk, Edited by: Marko Belusic, updated by Karlo Vuković (LIMIT and OFFSET)
+ * @brief Function that implements SELECT relational operator with LIMIT and OFFSET
  * @param src_table - original table that is used for selection
  * @param dest_table - table that contains the result
  * @param condition - condition for selection
  * @param attributes - atributes to be selected
  * @param ordering - atributes for result sorting
+ * @param limit - largest number of rows in the result, -1 for all rows
+ * @param offset - number of rows skipped before the result, used with a limit
  * @return EXIT_SUCCESS if cache result in memory and print table else break 
  */
-int AK_select(char *src_table, char *dest_table, struct list_node *attributes, struct list_node *condition, struct list_node *ordering)
+int AK_select_limit(char *src_table, char *dest_table, struct list_node *attributes, struct list_node *condition, struct list_node *ordering, int limit, int offset)
 {
     AK_PRO;
     //create help table name for selection
@@ -154,7 +166,7 @@ int AK_select(char *src_table, char *dest_table, struct list_node *attributes, s
     struct list_node *projectionAttributes = (struct list_node *)AK_malloc(sizeof(struct list_node));
     char sorted_table[ MAX_ATT_NAME ] = "";
 
-    if(AK_apply_select(src_table, selection_table, condition, attributes, projectionAttributes, sorted_table, ordering) != EXIT_SUCCESS){
+    if(AK_apply_select(src_table, selection_table, condition, attributes, projectionAttributes, sorted_table, ordering, limit, offset) != EXIT_SUCCESS){
         AK_clear_projection_attributes(projectionAttributes);
         AK_EPI;
         return EXIT_ERROR;
@@ -176,6 +188,25 @@ int AK_select(char *src_table, char *dest_table, struct list_node *attributes, s
     return EXIT_SUCCESS;
 }
 
+/**
+ * @author Filip Žmuk, Edited by: Marko Belusic
+ * @brief Function that implements SELECT relational operator
+ * @param src_table - original table that is used for selection
+ * @param dest_table - table that contains the result
+ * @param condition - condition for selection
+ * @param attributes - atributes to be selected
+ * @param ordering - atributes for result sorting
+ * @return EXIT_SUCCESS if cache result in memory and print table else break 
+ */
+int AK_select(char *src_table, char *dest_table, struct list_node *attributes, struct list_node *condition, struct list_node *ordering)
+{
+    int result;
+    AK_PRO;
+    result = AK_select_limit(src_table, dest_table, attributes, condition, ordering, -1, 0);
+    AK_EPI;
+    return result;
+}
+
 /**
  * @author Renata Mesaros, updated by Filip Žmuk and Josip Susnjara
  * @brief Function for testing the implementation
@@ -242,6 +273,29 @@ TestResult AK_select_test(){
     }
     
     AK_DeleteAll_L3(&attributes);
+
+    //only the first page of sorted rows is kept
+    char *dest_table3 = "select_result3";
+    AK_Init_L3(&attributes);
+	AK_InsertAtEnd_L3(TYPE_ATTRIBS, "firstname", sizeof("firstname"), attributes);
+	AK_InsertAtEnd_L3(TYPE_ATTRIBS, "year", sizeof("year"), attributes);
+    AK_Init_L3(&ordering);
+	AK_InsertAtEnd_L3(TYPE_ATTRIBS, "firstname", sizeof("firstname"), ordering);
+	AK_InsertAtEnd_L3(TYPE_OPERATOR, SORT_DESC, sizeof(SORT_DESC), ordering);
+
+    if (AK_select_limit(src_table, dest_table3, attributes, NULL, ordering, 3, 1) == EXIT_SUCCESS && AK_get_num_records(dest_table3) == 3)
+    {
+        succesful_tests++;
+    }
+    else
+    {
+        failed_tests++;
+    }
+    printf("\n SELECT firstname, year FROM student ORDER BY firstname DESC LIMIT 3 OFFSET 1;\n\n");
+    AK_print_table(dest_table3);
+
+    AK_DeleteAll_L3(&attributes);
+    AK_DeleteAll_L3(&ordering);
 	
     AK_print_table(src_table);
 	printf("\n SELECT firstname, year, weight, weight+year FROM student WHERE year < 2008 ORDER BY firstname;\n\n");
@@ -257,6 +311,7 @@ TestResult AK_select_test(){
     // reset all the tables
     AK_delete_segment(dest_table1, SEGMENT_TYPE_TABLE);
     AK_delete_segment(dest_table2, SEGMENT_TYPE_TABLE);
+    AK_delete_segment(dest_table3, SEGMENT_TYPE_TABLE);
 	AK_EPI;
 
 	return TEST_result(succesful_tests, failed_tests);
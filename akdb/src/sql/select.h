@@ -38,4 +38,19 @@
  * @return EXIT_SUCCESS if cache result in memory and print table else break 
  */
 int AK_select(char *srcTable,char *destTable,struct list_node *attributes,struct list_node *condition, struct list_node *ordering);
+
+/**
+ * @author Filip Žmuk, updated by Karlo Vuković (LIMIT and OFFSET)
+ * @brief Function that implements SELECT relational operator with LIMIT and OFFSET. Sorted rows are taken with
+ *        AK_top_n, which keeps only offset + limit rows while the selection is read.
+ * @param srcTable - original table that is used for selection
+ * @param destTable - table that contains the result
+ * @param attributes - atributes to be selected
+ * @param condition - condition for selection
+ * @param ordering - atributes for result sorting
+ * @param limit - largest number of rows in the result, -1 for all rows
+ * @param offset - number of rows skipped before the result, used with a limit
+ * @return EXIT_SUCCESS if the result was made, otherwise EXIT_ERROR
+ */
+int AK_select_limit(char *srcTable, char *destTable, struct list_node *attributes, struct list_node *condition, struct list_node *ordering, int limit, int offset);
 TestResult AK_select_test();
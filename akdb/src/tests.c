@@ -14,8 +14,14 @@
 #include "mm/memoman.h"
 // File management
 #include "file/fileio.h"
+#include "file/bulk.h"
+#include "file/pax.h"
+#include "file/overflow.h"
+#include "file/vacuum.h"
+#include "file/output.h"
 #include "file/files.h"
 #include "file/filesearch.h"
+#include "file/zonemap.h"
 #include "file/filesort.h"
 #include "file/table.h"
 #include "file/test.h"
@@ -24,6 +30,8 @@
 #include "file/idx/hash.h"
 #include "file/idx/btree.h"
 #include "file/idx/bitmap.h"
+#include "file/idx/bloom.h"
+#include "file/idx/trigram.h"
 // Query processing
 #include "opti/query_optimization.h"
 // Relational operators
@@ -52,6 +60,7 @@
 //Other
 #include "auxi/observable.h"
 #include "auxi/iniparser.h"
+#include "auxi/compare.h"
 #include "file/blobs.h"
 #include "sql/trigger.h"
 #include "sql/privileges.h"
@@ -70,36 +79,45 @@ Test tests[] = {
 {"auxi: AK_mempro", &AK_mempro_test},//auxi/mempro.c
 {"auxi: AK_dictionary", &AK_dictionary_test},//auxi/dictionary.c
 {"auxi: AK_iniparser", &AK_iniparser_test},//auxi/iniparser.c
-//6 total
+{"auxi: AK_compare", &AK_compare_test}, //auxi/compare.c
+//7 total
 //dm:
 //-------
 {"dm: AK_allocationbit", &AK_allocationbit_test}, //dm/dbman.c
 {"dm: AK_allocationtable", &AK_allocationtable_test}, //dm/dbman.c
 {"dm: AK_thread_safe_block_access", &AK_thread_safe_block_access_test}, //dm/dbman.c
-//3+6=9 total
+//3+7=10 total
 //file:
 //---------
 {"file: AK_id", &AK_id_test}, //file/id.c
 {"file: AK_lo", &AK_lo_test}, //file/blobs.c
 {"file: AK_files_test", &AK_files_test}, //file/files.c
 {"file: AK_fileio_test", &AK_fileio_test}, //file/fileio.c //old 10, new 13
+{"file: AK_bulk", &AK_bulk_test}, //file/bulk.c
+{"file: AK_pax", &AK_pax_test}, //file/pax.c
+{"file: AK_overflow", &AK_overflow_test}, //file/overflow.c
+{"file: AK_vacuum", &AK_vacuum_test}, //file/vacuum.c
+{"file: AK_output", &AK_output_test}, //file/output.c
 {"file: AK_op_rename", &AK_op_rename_test}, //file/table.c  //old 11, new 14
 {"file: AK_filesort", &AK_filesort_test}, //file/filesort.c
 {"file: AK_filesearch", &AK_filesearch_test}, //file/filesearch.c
+{"file: AK_zone_map", &AK_zone_map_test}, //file/zonemap.c
 {"file: AK_sequence", &AK_sequence_test}, //file/sequence.c  //old 14, new 17, old user  rinkovec  named this as btree which is not 14=btree??
 {"file: AK_table_test", &AK_table_test}, //file/table.c //old 15, new 18
-//9+9=18 total
+//14+10=24 total
 //file/idx:
 //-------------
 {"idx: AK_bitmap", &AK_bitmap_test}, //file/idx/bitmap.c
+{"idx: AK_bloom_filter", &AK_bloom_filter_test}, //file/idx/bloom.c
 {"idx: AK_btree", &AK_btree_test}, //file/idx/btree.c
 {"idx: AK_hash", &AK_hash_test}, //file/idx/hash.c
-//3+18=21 total
+{"idx: AK_trigram", &AK_trigram_test}, //file/idx/trigram.c
+//3+24=27 total
 //mm:
 //-------
 {"mm: AK_memoman", &AK_memoman_test}, //mm/memoman.c
 {"mm: AK_block", &AK_memoman_test2}, //mm/memoman.c
-//2+21=23 total
+//2+27=29 total
 //opti:
 //---------
 {"opti: AK_rel_eq_assoc", &AK_rel_eq_assoc_test}, //opti/rel_eq_assoc.c
@@ -107,7 +125,7 @@ Test tests[] = {
 {"opti: AK_rel_eq_selection", &AK_rel_eq_selection_test}, //opti/rel_eq_selection.c
 {"opti: AK_rel_eq_projection", &AK_rel_eq_projection_test}, //opti/rel_eq_projection.c
 {"opti: AK_query_optimization", &AK_query_optimization_test}, //opti/query_optimization.c //old 25, new 28
-//5+23=28 total
+//5+29=34 total
 //rel:
 //--------
 {"rel: AK_op_union", &AK_op_union_test}, //rel/union.c
@@ -124,7 +142,7 @@ Test tests[] = {
 {"rel: AK_op_difference", &AK_op_difference_test}, //rel/difference.c
 {"rel: AK_op_projection", &AK_op_projection_test}, //rel/projection.c
 {"rel: AK_op_theta_join", &AK_op_theta_join_test}, //rel/theta_join.c //old 37, new 39
-//11+28=39 total
+//11+34=45 total
 //sql:
 //--------
 {"sql: AK_command", &AK_test_command}, //sql/command.c
@@ -141,15 +159,15 @@ Test tests[] = {
 {"sql: AK_check_constraint", &AK_check_constraint_test}, //sql/cs/check_constraint.c //old 49, new 51
 {"sql: AK_constraint_names", &AK_constraint_names_test}, //sql/cs/constraint_names.c
 {"sql: AK_insert", &AK_insert_test}, //sql/insert.c
-//14+39=53 total
+//14+45=59 total
 //trans:
 //----------
 {"trans: AK_transaction", &AK_test_Transaction}, //src/trans/transaction.c
-//54
+//60
 //rec:
 //----------
 {"rec: AK_recovery", &AK_recovery_test} //rec/recovery.c
-//55
+//61
 };
 //here are all tests in a order like in the folders from the github
 void help()
@@ -207,6 +225,7 @@ void choose_test()
 {
     AK_PRO;
     int pickedTest=-1;
+    int allTests=sizeof(tests)/sizeof(tests[0]);
     AK_create_test_tables();
     set_catalog_constraints();
     while(pickedTest)
@@ -216,7 +235,7 @@ void choose_test()
         printf("Test: ");
         scanf("%d", &pickedTest);
         if(!pickedTest) exit( EXIT_SUCCESS );
-        while(pickedTest<0 || pickedTest>55)
+        while(pickedTest<0 || pickedTest>allTests)
         {
             printf("\nTest: ");
             scanf("%d", &pickedTest);
@@ -307,16 +326,16 @@ UPDATED OLD TO NEW BASED ON NEW TESTS ADDED, BUT IT SEEMS IT DOESNT EVEN HAVE AN
 if (ans==14||ans==25||ans==34||ans==37||ans==42||ans==44||ans==45||ans==47||ans==49) -OLD
 if (ans==17|ans==28||ans==36||ans==39||ans==44||ans==46||ans==47||ans==49||ans==51) -NEW
 */
-        if (pickedTest==14||pickedTest==13)
+        if (pickedTest==20||pickedTest==19)
             {
                 AK_create_test_tables();
                 set_catalog_constraints();
             
             } 
-          if (pickedTest==18)
+          if (pickedTest==25)
             {
               for ( i; i < 1; i++ ) {
-                  failedTests[i] = 18; 
+                  failedTests[i] = 25; 
                }
                i++;
                 pickedTest++; //number of function
@@ -324,7 +343,7 @@ if (ans==17|ans==28||ans==36||ans==39||ans==44||ans==46||ans==47||ans==49||ans==
                 continue;
             }  
 
-             if (pickedTest==17||pickedTest==28||pickedTest==36||pickedTest==39||pickedTest==44||pickedTest==46||pickedTest==47||pickedTest==49||pickedTest==51)
+             if (pickedTest==24||pickedTest==37||pickedTest==45||pickedTest==48||pickedTest==53||pickedTest==55||pickedTest==56||pickedTest==58||pickedTest==60)
             {
                 //14 AK_btree_create -SIGSEGV // IS THIS MISTAKE BCS RINKOVEC WROTE THEM IDK WHY
                 //25 AK_update_row_from_block -SIGSEGV